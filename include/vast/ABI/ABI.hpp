@@ -270,11 +270,11 @@ namespace vast::abi
     template< typename Op >
     func_info( Op ) -> func_info< Op >;
 
-    template< typename Fn, typename Classifier, typename DL >
-    func_info< Fn > make( Fn fn, const DL &dl )
+    template< typename Fn, typename Classifier, typename DL, typename Layouts >
+    func_info< Fn > make( Fn fn, const DL &dl, Layouts &layouts )
     {
         auto info = func_info( fn );
-        return Classifier( info, dl ).compute_abi().take();
+        return Classifier( info, dl, layouts ).compute_abi().take();
     }
 
 } // namespace vast::abi
@@ -11,6 +11,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/ABI/ABI.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+#include "vast/Util/TargetLayouts.hpp"
 
 namespace vast::abi
 {
@@ -114,15 +115,6 @@ namespace vast::abi
             return hl::PointerType::get( t.getContext(), t );
         }
 
-        static hl::StructDeclOp get_struct_def( hl::RecordType t, mlir::ModuleOp m )
-        {
-            for ( auto &op : *m.getBody() )
-                if ( auto decl = mlir::dyn_cast< hl::StructDeclOp >( op ) )
-                    if ( decl.getName() == t.getName() )
-                        return decl;
-            return {};
-        }
-
         static bool can_be_promoted( mlir::Type t )
         {
             return false;
@@ -134,7 +126,7 @@ namespace vast::abi
         }
 
         // TODO(abi): Will need to live in a different interface.
-        static std::size_t pointer_size() { return 64; }
+        static std::size_t pointer_size() { return dl::x86_64_sysv.pointer.bw; }
 
         static std::size_t size( const auto &dl, mlir::Type t )
         {
@@ -145,7 +137,7 @@ namespace vast::abi
         static bool bits_contain_no_user_data( mlir::Type t, std::size_t start,
                                                std::size_t end, const auto &ctx )
         {
-            const auto &[ dl, op ] = ctx;
+            const auto &[ dl, layouts ] = ctx;
 
             if ( size( dl, t ) <= start )
                 return true;
@@ -157,7 +149,7 @@ namespace vast::abi
             {
                 // TODO(abi): CXXRecordDecl.
                 std::size_t current = 0;
-                for ( auto field : fields( t, op ) )
+                for ( auto field : layouts.layout_of( t ).field_types() )
                 {
                     if ( current >= end )
                         break;
@@ -235,24 +227,18 @@ namespace vast::abi
         static auto field_containing_offset( const auto &ctx, mlir::Type t, std::size_t offset )
             -> std::tuple< mlir::Type, std::size_t >
         {
-            const auto &[ dl, op ] = ctx;
+            const auto &[ dl, layouts ] = ctx;
 
-            auto curr = 0;
-            for ( auto field : fields( t, op ) )
+            std::size_t curr = 0;
+            for ( const auto &field : layouts.layout_of( t ).fields )
             {
-                if ( curr + size( dl, field ) > offset )
-                    return { field, curr };
-                curr += size( dl, field );
+                if ( curr + field.size > offset )
+                    return { field.type, curr };
+                curr += field.size;
             }
             VAST_UNREACHABLE( "Did not find field at offset {0} in {1}", offset,t );
 
         }
-
-        static auto fields(mlir_type type, auto func)
-        {
-            auto mod = func->template getParentOfType< vast_module >();
-            return vast::hl::field_types(type, mod);
-        }
     };
 
 
@@ -272,6 +258,8 @@ namespace vast::abi
 
         func_info info;
         const data_layout &dl;
+        // Shared by all functions of the module.
+        hl::record_layout_cache &layouts;
 
         static constexpr std::size_t max_gpr = 6;
         static constexpr std::size_t max_sse = 8;
@@ -280,8 +268,9 @@ namespace vast::abi
         std::size_t needed_sse = 0;
 
         classifier_base( func_info info,
-                         const data_layout &dl )
-            : info( std::move( info ) ), dl( dl )
+                         const data_layout &dl,
+                         hl::record_layout_cache &layouts )
+            : info( std::move( info ) ), dl( dl ), layouts( layouts )
         {}
 
         auto size( mlir::Type t )
@@ -409,7 +398,7 @@ namespace vast::abi
         }
 
         // TODO(abi): Refactor.
-        auto mk_ctx() const { return std::make_tuple( dl, info.raw_fn ); }
+        auto mk_ctx() const { return std::tie( dl, layouts ); }
 
         classification_t get_aggregate_class( mlir::Type t, std::size_t &offset )
         {
@@ -417,14 +406,14 @@ namespace vast::abi
                 return { Class::Memory, {} };
             // TODO(abi): C++ perks.
 
-            auto fields = TypeConfig::fields( t, info.raw_fn );
+            const auto &layout = layouts.layout_of( t );
             classification_t result = { Class::NoClass, Class::NoClass };
 
             auto field_offset = offset;
-            for ( auto field_type : fields )
+            for ( const auto &field : layout.fields )
             {
-                auto field_class = classify( field_type, field_offset );
-                field_offset += size( field_type );
+                auto field_class = classify( field.type, field_offset );
+                field_offset += field.size;
                 result = join( result, field_class );
             }
 
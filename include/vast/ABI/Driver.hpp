@@ -18,10 +18,10 @@ VAST_UNRELAX_WARNINGS
 namespace vast::abi
 {
     template< typename FnOp >
-    auto make_x86_64( FnOp fn, const mlir::DataLayout &dl )
+    auto make_x86_64( FnOp fn, const mlir::DataLayout &dl, hl::record_layout_cache &layouts )
     {
         using out = func_info< FnOp >;
         using classifier = classifier_base< out, mlir::DataLayout >;
-        return make< FnOp, classifier >( fn, dl );
+        return make< FnOp, classifier >( fn, dl, layouts );
     }
 } // namespace vast::abi
@@ -0,0 +1,94 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+#include <mlir/Pass/AnalysisManager.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/LoopNest.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace vast::analysis
+{
+    enum class check_kind
+    {
+        // The access has to be checked where it is.
+        required,
+        // The access can not be out of bounds, e.g., a constant subscript of
+        // an array of a known size, or an induction variable whose range in
+        // the body of its loop lies within the array.
+        in_bounds,
+        // An earlier check of the same region covers the access, either the
+        // check of the same address, or a check of the same base merged into
+        // a range check.
+        covered,
+        // The access is executed on every iteration of a loop that does not
+        // change its address, so it can be checked once per entry of the
+        // loop, on its first iteration.
+        hoistable
+    };
+
+    struct access_check
+    {
+        check_kind kind = check_kind::required;
+
+        // The covering check, or the outermost loop the check is hoisted from.
+        operation by = nullptr;
+    };
+
+    //
+    // Classifies the checks of the memory accesses of safety instrumentation,
+    // i.e., `hl.subscript`, `hl.deref` and `hl.member`, using the structured
+    // control flow of hl. Addresses are compared symbolically: constants,
+    // referenced variables and loads of local variables whose address is not
+    // taken, so that an assignment of a variable invalidates the checks of
+    // the addresses it is part of.
+    //
+    // Checks are covered only within a straight-line sequence of operations
+    // and the regions nested in it, and only if no operation between the
+    // checks may leave the sequence.
+    //
+    // Induction variables of loops are those of the loop nest of the root,
+    // which is shared with other analyses when run by a pass.
+    //
+    struct access_checks
+    {
+        explicit access_checks(operation root);
+
+        access_checks(operation root, const loop_nest_analysis &loops);
+
+        access_checks(operation root, mlir::AnalysisManager &am)
+            : access_checks(root, am.getAnalysis< loop_nest_analysis >())
+        {}
+
+        static bool is_access(operation op);
+
+        // Accesses of the root in the program order.
+        llvm::ArrayRef< operation > accesses() const { return order; }
+
+        access_check check(operation access) const { return checks.lookup(access); }
+
+        // Range of the constant subscripts merged into the check of the
+        // access, if any.
+        std::optional< std::pair< std::int64_t, std::int64_t > > range(operation access) const;
+
+        std::size_t count(check_kind kind) const;
+
+      private:
+        std::vector< operation > order;
+        llvm::DenseMap< operation, access_check > checks;
+        llvm::DenseMap< operation, std::pair< std::int64_t, std::int64_t > > ranges;
+
+        friend struct access_checks_builder;
+    };
+
+} // namespace vast::analysis
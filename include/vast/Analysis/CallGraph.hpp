@@ -0,0 +1,128 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <limits>
+
+namespace vast::analysis
+{
+    //
+    // Call graph of the functions of a module, usable as an MLIR analysis.
+    // Nodes are the functions defined or declared at the top level of the
+    // module, numbered in their order, and edges are stored in compressed
+    // sparse rows, callees and callers separately, each row sorted by the
+    // node it leads to and without duplicates.
+    //
+    // Direct calls resolve the symbol of their callee. Indirect calls may
+    // call any function whose address is taken anywhere in the module, by
+    // a function or by the initializer of a global, and whose signature
+    // accepts the number of arguments and results of the call. Parameter
+    // types are not compared, they are spelled differently by typedefs and
+    // qualifiers of the units of a linked program, hence the targets are
+    // a conservative superset.
+    //
+    // Functions are scanned in parallel, each into its own edge list, and the
+    // lists are merged into the rows afterwards. The graph does not observe
+    // the module, it has to be rebuilt once the functions change.
+    //
+    struct call_graph
+    {
+        using node_id = std::uint32_t;
+
+        static constexpr node_id no_node = std::numeric_limits< node_id >::max();
+
+        enum class edge_kind : std::uint8_t { direct, indirect };
+
+        struct edge
+        {
+            node_id node;
+            edge_kind kind;
+        };
+
+        explicit call_graph(operation root);
+
+        std::size_t size() const { return functions.size(); }
+        std::size_t edges() const { return callee_edges.size(); }
+
+        mlir::FunctionOpInterface function(node_id node) const { return functions[node]; }
+
+        node_id node(string_ref name) const;
+        node_id node(mlir::FunctionOpInterface fn) const;
+
+        // A direct edge is kept if the callee is called both directly and
+        // indirectly.
+        llvm::ArrayRef< edge > callees(node_id node) const { return row(callee_offsets, callee_edges, node); }
+        llvm::ArrayRef< edge > callers(node_id node) const { return row(caller_offsets, caller_edges, node); }
+
+        // True if the function makes an indirect call with no target among
+        // the functions of the module, e.g., to a function of another module.
+        bool calls_unknown(node_id node) const { return unknown_targets.test(node); }
+
+        bool address_taken(node_id node) const { return taken.test(node); }
+
+        // Functions reachable from the roots, the roots included.
+        llvm::BitVector reachable(llvm::ArrayRef< node_id > roots) const;
+
+        // Callees are visited before their callers, functions of a cycle in
+        // an unspecified order.
+        void post_order(auto &&yield) const {
+            llvm::BitVector visited(size());
+            std::vector< std::pair< node_id, std::size_t > > stack;
+            for (node_id root = 0; root < size(); ++root) {
+                if (visited.test(root)) {
+                    continue;
+                }
+
+                visited.set(root);
+                stack.emplace_back(root, 0);
+                while (!stack.empty()) {
+                    auto &[node, next] = stack.back();
+                    auto out = callees(node);
+                    if (next == out.size()) {
+                        yield(node);
+                        stack.pop_back();
+                        continue;
+                    }
+
+                    auto callee = out[next++].node;
+                    if (!visited.test(callee)) {
+                        visited.set(callee);
+                        stack.emplace_back(callee, 0);
+                    }
+                }
+            }
+        }
+
+      private:
+        static llvm::ArrayRef< edge > row(
+            const std::vector< std::uint32_t > &offsets, const std::vector< edge > &edges, node_id node
+        ) {
+            return llvm::ArrayRef(edges).slice(offsets[node], offsets[node + 1] - offsets[node]);
+        }
+
+        std::vector< mlir::FunctionOpInterface > functions;
+        llvm::DenseMap< mlir::StringAttr, node_id > nodes;
+
+        std::vector< std::uint32_t > callee_offsets;
+        std::vector< edge > callee_edges;
+
+        std::vector< std::uint32_t > caller_offsets;
+        std::vector< edge > caller_edges;
+
+        llvm::BitVector unknown_targets;
+        llvm::BitVector taken;
+    };
+
+} // namespace vast::analysis
@@ -0,0 +1,218 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Region.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/FlatFunction.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <functional>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace vast::analysis
+{
+    //
+    // Flow graph of the body of a function, built directly from the vast IR:
+    // structured control flow of hl (`hl.if`, `hl.cond`, `hl.while`, `hl.do`,
+    // `hl.for`, `hl.switch` with its cases, `hl.break`, `hl.continue`,
+    // `hl.label` and `hl.goto`), scopes and lazy regions of core, and blocks
+    // connected by terminators of ll and cf. The IR is not lowered.
+    //
+    // Nodes are straight-line sequences of operations. Structured operations
+    // are placed after their regions, where their results are defined, and
+    // lazy regions may or may not be evaluated. Operations with regions the
+    // graph does not know execute them in their order, isolated operations
+    // are not entered. Edges are stored in compressed sparse rows.
+    //
+    // The graph does not observe the function, it has to be rebuilt once the
+    // body changes. Graphs of distinct functions are independent, so that the
+    // functions of a module can be analysed in parallel.
+    //
+    // A graph built with the flat snapshot of the function also numbers its
+    // operations by the snapshot, so that transfers of problems can read the
+    // snapshot instead of the IR.
+    //
+    struct flow_graph
+    {
+        using node_id = std::uint32_t;
+
+        static constexpr node_id no_node = std::numeric_limits< node_id >::max();
+
+        // Every return leads to the exit.
+        static constexpr node_id entry = 0;
+        static constexpr node_id exit  = 1;
+
+        explicit flow_graph(mlir::Region &body);
+
+        // The snapshot has to be of the function of the body.
+        flow_graph(mlir::Region &body, const flat_function &flat);
+
+        std::size_t size() const { return offsets.size() - 1; }
+
+        llvm::ArrayRef< operation > ops(node_id node) const {
+            return llvm::ArrayRef(operations).slice(offsets[node], offsets[node + 1] - offsets[node]);
+        }
+
+        // Operations of the node numbered by the snapshot of the graph.
+        llvm::ArrayRef< flat_function::op_id > op_ids(node_id node) const {
+            VAST_ASSERT(has_op_ids());
+            return llvm::ArrayRef(ids).slice(offsets[node], offsets[node + 1] - offsets[node]);
+        }
+
+        bool has_op_ids() const { return numbered; }
+
+        llvm::ArrayRef< node_id > successors(node_id node) const { return row(succ_offsets, succ, node); }
+        llvm::ArrayRef< node_id > predecessors(node_id node) const { return row(pred_offsets, pred, node); }
+
+        // Node of the operation and its index in the node.
+        std::optional< std::pair< node_id, unsigned > > position(operation op) const;
+
+        // Reverse post-order from the entry along the successors, or from
+        // the exit along the predecessors if `backward`. Nodes unreachable
+        // from the start follow in the order of their ids.
+        std::vector< node_id > reverse_post_order(bool backward = false) const;
+
+      private:
+        static llvm::ArrayRef< node_id > row(
+            const std::vector< std::uint32_t > &offsets, const std::vector< node_id > &edges, node_id node
+        ) {
+            return llvm::ArrayRef(edges).slice(offsets[node], offsets[node + 1] - offsets[node]);
+        }
+
+        friend struct flow_graph_builder;
+
+        std::vector< operation > operations;
+        std::vector< std::uint32_t > offsets;
+
+        // parallel to operations in graphs numbered by a snapshot
+        std::vector< flat_function::op_id > ids;
+        bool numbered = false;
+
+        std::vector< std::uint32_t > succ_offsets;
+        std::vector< node_id > succ;
+
+        std::vector< std::uint32_t > pred_offsets;
+        std::vector< node_id > pred;
+
+        llvm::DenseMap< operation, std::pair< node_id, unsigned > > positions;
+    };
+
+    enum class flow_direction { forward, backward };
+
+    // `may` problems join the states of the neighbours by union, `must`
+    // problems by intersection.
+    enum class flow_meet { may, must };
+
+    //
+    // Bits an operation generates and kills. Kills of an operation have to
+    // be given before its gens.
+    //
+    struct gen_kill_facts
+    {
+        void gen(unsigned bit) { gens->set(bit); }
+        void gen(const llvm::BitVector &bits) { *gens |= bits; }
+
+        void kill(unsigned bit) {
+            if (kills) {
+                kills->set(bit);
+            }
+            gens->reset(bit);
+        }
+
+        void kill(const llvm::BitVector &bits) {
+            if (kills) {
+                *kills |= bits;
+            }
+            gens->reset(bits);
+        }
+
+        // Either the summary of a node, or a state the operations are
+        // applied to directly, which has no kills.
+        llvm::BitVector *gens;
+        llvm::BitVector *kills = nullptr;
+    };
+
+    //
+    // Gen/kill problem over dense bit-vector lattices, e.g., liveness,
+    // reaching definitions or taint, where every bit is a fact.
+    //
+    struct gen_kill_problem
+    {
+        using transfer_fn = std::function< void(operation, gen_kill_facts &) >;
+        using flat_transfer_fn = std::function< void(flat_function::op_id, gen_kill_facts &) >;
+
+        flow_direction direction = flow_direction::forward;
+        flow_meet meet = flow_meet::may;
+
+        unsigned bits = 0;
+
+        // Facts at the entry of a forward problem, or at the exit of a
+        // backward one, no facts if empty.
+        llvm::BitVector boundary;
+
+        transfer_fn transfer;
+
+        // Transfer over the snapshot the graph is numbered by, used instead
+        // of `transfer` if given.
+        flat_transfer_fn flat_transfer;
+    };
+
+    //
+    // Worklist solver of a gen/kill problem. Operations of every node are
+    // summarized into a single gen and kill set, so that the fixpoint
+    // iteration is a few word-wise loops per node, visited in reverse
+    // post-order of the direction of the problem. States of operations are
+    // recomputed from the state of their node on demand.
+    //
+    struct gen_kill_solver
+    {
+        using node_id = flow_graph::node_id;
+
+        gen_kill_solver(const flow_graph &graph, gen_kill_problem problem);
+
+        // Number of visits of nodes until the fixpoint.
+        std::size_t solve();
+
+        // States at the beginning and the end of a node in the program order.
+        const llvm::BitVector &in(node_id node) const { return ins[node]; }
+        const llvm::BitVector &out(node_id node) const { return outs[node]; }
+
+        // States before and after the operation in the program order, e.g.,
+        // facts live after it in a backward problem.
+        llvm::BitVector before(operation op) const;
+        llvm::BitVector after(operation op) const;
+
+        const flow_graph &graph;
+        const gen_kill_problem problem;
+
+      private:
+        // The state the transfer of the operation is applied to, i.e., the
+        // state before it for forward problems and after it for backward.
+        llvm::BitVector state_at(operation op, bool applied) const;
+
+        void summarize();
+
+        // Applies the transfers of the operations `[begin, end)` of the node
+        // in the direction of the problem.
+        void transfer(node_id node, std::size_t begin, std::size_t end, gen_kill_facts &facts) const;
+
+        bool forward() const { return problem.direction == flow_direction::forward; }
+
+        std::vector< llvm::BitVector > gens;
+        std::vector< llvm::BitVector > kills;
+
+        std::vector< llvm::BitVector > ins;
+        std::vector< llvm::BitVector > outs;
+    };
+
+} // namespace vast::analysis
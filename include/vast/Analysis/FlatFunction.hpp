@@ -0,0 +1,169 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/OperationSupport.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/Sequence.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace vast::analysis
+{
+    //
+    // Read-only snapshot of a function (e.g., `hl.func` or `ll.func`) in flat
+    // arrays, for analyses that visit its operations many times, e.g., until
+    // a fixpoint. The function itself is the operation zero, the other
+    // operations are numbered in pre-order, blocks of a region and regions of
+    // an operation consecutively, and values, i.e., arguments of blocks and
+    // results of operations, densely from zero in the order of their
+    // definition. Values the function uses but does not define are numbered
+    // after its own values.
+    //
+    // Operands, successors and the operations of blocks are rows of
+    // compressed sparse tables, so a visit of an operation reads a few
+    // contiguous arrays instead of chasing the pointers of the IR. Kinds of
+    // operations index the table of operation names of the snapshot.
+    //
+    // The snapshot is built in one walk and does not observe the function,
+    // it is invalidated once the function changes. As an MLIR analysis, it is
+    // invalidated by passes that do not preserve it.
+    //
+    struct flat_function
+    {
+        using op_id     = std::uint32_t;
+        using value_id  = std::uint32_t;
+        using block_id  = std::uint32_t;
+        using region_id = std::uint32_t;
+        using kind_id   = std::uint32_t;
+
+        static constexpr std::uint32_t none = std::numeric_limits< std::uint32_t >::max();
+
+        explicit flat_function(operation fn);
+
+        std::size_t num_ops() const { return ops.size(); }
+        std::size_t num_blocks() const { return block_region.size(); }
+        std::size_t num_regions() const { return region_parent.size(); }
+        std::size_t num_values() const { return values.size(); }
+
+        // Values defined by the function, the others follow them.
+        std::size_t num_own_values() const { return own_values; }
+
+        //
+        // Operations.
+        //
+        operation op(op_id id) const { return ops[id]; }
+        std::optional< op_id > id(operation op) const;
+
+        kind_id kind(op_id id) const { return kinds[id]; }
+        mlir::OperationName name(kind_id kind) const { return names[kind]; }
+        std::size_t num_kinds() const { return names.size(); }
+
+        // Kind of the operations of the type, none if the function has none.
+        template< typename op_t >
+        kind_id kind_of() const { return kind_of(op_t::getOperationName()); }
+
+        kind_id kind_of(string_ref name) const;
+
+        // Block the operation is in, none for the function.
+        block_id parent(op_id id) const { return op_parent[id]; }
+
+        llvm::ArrayRef< value_id > operands(op_id id) const {
+            return row(operand_offsets, operand_ids, id);
+        }
+
+        auto results(op_id id) const {
+            return llvm::seq< value_id >(first_result[id], first_result[id] + num_results[id]);
+        }
+
+        llvm::ArrayRef< block_id > successors(op_id id) const {
+            return row(successor_offsets, successor_ids, id);
+        }
+
+        auto regions(op_id id) const {
+            return llvm::seq< region_id >(region_offsets[id], region_offsets[id + 1]);
+        }
+
+        //
+        // Blocks and regions.
+        //
+        llvm::ArrayRef< op_id > block_ops(block_id id) const {
+            return row(block_op_offsets, block_op_ids, id);
+        }
+
+        auto arguments(block_id id) const {
+            return llvm::seq< value_id >(first_argument[id], first_argument[id] + num_arguments[id]);
+        }
+
+        region_id parent_region(block_id id) const { return block_region[id]; }
+
+        auto blocks(region_id id) const {
+            return llvm::seq< block_id >(region_blocks[id], region_blocks[id + 1]);
+        }
+
+        op_id parent_op(region_id id) const { return region_parent[id]; }
+
+        //
+        // Values.
+        //
+        mlir_value value(value_id id) const { return values[id]; }
+        std::optional< value_id > id(mlir_value value) const;
+
+        // Operation that defines the value, none for arguments of blocks and
+        // values defined outside of the function.
+        op_id defining_op(value_id id) const { return value_def[id]; }
+
+      private:
+        friend struct flat_function_builder;
+
+        template< typename id_t >
+        static llvm::ArrayRef< id_t > row(
+            const std::vector< std::uint32_t > &offsets, const std::vector< id_t > &ids, std::uint32_t idx
+        ) {
+            return llvm::ArrayRef(ids).slice(offsets[idx], offsets[idx + 1] - offsets[idx]);
+        }
+
+        // per operation
+        std::vector< operation > ops;
+        std::vector< kind_id > kinds;
+        std::vector< block_id > op_parent;
+        std::vector< value_id > first_result;
+        std::vector< std::uint32_t > num_results;
+        std::vector< std::uint32_t > operand_offsets;
+        std::vector< value_id > operand_ids;
+        std::vector< std::uint32_t > successor_offsets;
+        std::vector< block_id > successor_ids;
+        std::vector< region_id > region_offsets;
+
+        // per block
+        std::vector< region_id > block_region;
+        std::vector< value_id > first_argument;
+        std::vector< std::uint32_t > num_arguments;
+        std::vector< std::uint32_t > block_op_offsets;
+        std::vector< op_id > block_op_ids;
+
+        // per region
+        std::vector< op_id > region_parent;
+        std::vector< block_id > region_blocks;
+
+        // per value
+        std::vector< mlir_value > values;
+        std::vector< op_id > value_def;
+        std::size_t own_values = 0;
+
+        std::vector< mlir::OperationName > names;
+
+        llvm::DenseMap< operation, op_id > op_ids;
+        llvm::DenseMap< mlir_value, value_id > value_ids;
+    };
+
+} // namespace vast::analysis
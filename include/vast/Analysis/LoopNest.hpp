@@ -0,0 +1,100 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace vast::analysis
+{
+    //
+    // Induction variable of a canonical `for` loop:
+    //
+    //   v = init; ... for (; v <pred> bound; v += step) body
+    //
+    // where `v` is a local variable whose address is not taken, the bound is
+    // a constant and only the increment region of the loop writes `v`. The
+    // increment is `++`, `--`, `+=` or `-=` of a constant. Loops with labels
+    // are not canonical, as a jump may enter them past the condition.
+    //
+    struct induction_variable
+    {
+        mlir_value var;
+        std::int64_t init, step, bound;
+
+        // Comparison of the variable with the bound, `v <pred> bound`.
+        hl::Predicate predicate;
+    };
+
+    struct loop
+    {
+        // `hl.for`, `hl.while` or `hl.do`.
+        operation op;
+
+        const loop *parent = nullptr;
+        llvm::SmallVector< const loop *, 2 > children;
+
+        // Top-level loops are at depth zero.
+        unsigned depth = 0;
+
+        std::optional< induction_variable > induction;
+
+        // Number of iterations of a canonical loop by its condition, zero if
+        // the body is never entered. Exits may leave the loop earlier.
+        std::optional< std::uint64_t > trip_count;
+
+        // Operations that leave the loop other than by its condition:
+        // breaks of the loop, returns, gotos to labels outside of it and
+        // computed gotos.
+        llvm::SmallVector< operation, 2 > exits;
+
+        bool is_innermost() const { return children.empty(); }
+    };
+
+    //
+    // Loop tree of the structured control flow of hl, usable as an MLIR
+    // analysis and cached per function, e.g. by
+    // `getChildAnalysis< loop_nest_analysis >(fn)`. Loops nest by their
+    // regions, a loop of the condition or of the increment of another loop
+    // is its child as well. The analysis does not observe the function, it is
+    // invalidated by passes that do not preserve it.
+    //
+    struct loop_nest_analysis
+    {
+        explicit loop_nest_analysis(operation root);
+
+        static bool is_loop(operation op);
+
+        // Loops of the root in pre-order.
+        llvm::ArrayRef< const loop * > loops() const { return order; }
+
+        llvm::ArrayRef< const loop * > top_level() const { return roots; }
+
+        // Loop of the loop operation.
+        const loop *lookup(operation op) const { return by_op.lookup(op); }
+
+        // Innermost loop the operation is nested in.
+        const loop *loop_of(operation op) const;
+
+      private:
+        std::vector< std::unique_ptr< loop > > storage;
+        std::vector< const loop * > order;
+        std::vector< const loop * > roots;
+        llvm::DenseMap< operation, const loop * > by_op;
+
+        friend struct loop_nest_builder;
+    };
+
+} // namespace vast::analysis
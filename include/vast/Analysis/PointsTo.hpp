@@ -0,0 +1,111 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SparseBitVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <vector>
+
+namespace vast::analysis
+{
+    //
+    // Inclusion-based (Andersen-style) points-to analysis of the hl values of
+    // a module, usable as an MLIR analysis. Every value refers to a set of
+    // abstract memory objects: lvalues to the objects they designate, and
+    // pointers to the objects they point to. Objects are
+    //
+    //   - variables, i.e., `hl.var`, and parameters of functions,
+    //   - heap allocations, one per call of `malloc`, `calloc`, `realloc`,
+    //     `aligned_alloc`, `strdup` and `strndup`,
+    //   - functions, referred to by `hl.funcref`,
+    //   - fields of structures, identified by the index of the field in the
+    //     record layout cache, nested at most `max_field_depth` levels deep.
+    //     Members of unions and of records without a definition share the
+    //     object of their record.
+    //
+    // Stores to an object flow to its fields, and loads of an object read
+    // its fields as well, so aggregate initializers and copies are covered.
+    // Calls through function pointers bind the functions they may call as
+    // their targets are discovered. Results of calls of external functions
+    // may point to whatever their arguments point to.
+    //
+    // Constraints are solved by wave propagation: strongly connected
+    // components of the copy graph are collapsed, points-to sets are
+    // propagated along the acyclic graph level by level, with the components
+    // of a level processed in parallel, and loads, stores, field accesses and
+    // indirect calls add the edges of the newly discovered objects for the
+    // next wave, until no edge is added. Points-to sets are sparse bit
+    // vectors of object ids.
+    //
+    struct points_to
+    {
+        using object_id     = std::uint32_t;
+        using points_to_set = llvm::SparseBitVector<>;
+
+        static constexpr unsigned max_field_depth = 4;
+
+        enum class object_kind : std::uint8_t { variable, parameter, heap, function, field };
+
+        struct object
+        {
+            object_kind kind;
+            // The variable, the function of the parameter, the allocating
+            // call or the function, and for fields the operation of the
+            // outermost object.
+            operation op;
+            // The record of a field, the object itself otherwise.
+            object_id parent;
+            // Index of the field or of the parameter.
+            std::uint32_t index = 0;
+        };
+
+        explicit points_to(operation root);
+
+        // Objects the value may refer to, empty for values unknown to the
+        // analysis.
+        const points_to_set &pointees(mlir_value value) const;
+
+        // Objects the stored contents of the object may point to.
+        const points_to_set &contents(object_id object) const {
+            return sets[rep(content_nodes[object])];
+        }
+
+        bool may_alias(mlir_value a, mlir_value b) const {
+            return pointees(a).intersects(pointees(b));
+        }
+
+        const object &object_of(object_id id) const { return objects[id]; }
+
+        std::size_t size() const { return objects.size(); }
+
+        // Number of solver waves and of nodes merged into their components.
+        std::size_t waves() const { return _waves; }
+        std::size_t collapsed() const { return _collapsed; }
+
+      private:
+        friend struct points_to_solver;
+
+        using node_id = std::uint32_t;
+
+        node_id rep(node_id node) const;
+
+        std::vector< object > objects;
+        // node of the contents of every object
+        std::vector< node_id > content_nodes;
+
+        llvm::DenseMap< mlir_value, node_id > value_nodes;
+        std::vector< node_id > parents;
+        std::vector< points_to_set > sets;
+
+        std::size_t _waves = 0;
+        std::size_t _collapsed = 0;
+    };
+
+} // namespace vast::analysis
@@ -0,0 +1,134 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/STLFunctionalExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/CallGraph.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <optional>
+#include <vector>
+
+namespace vast::analysis
+{
+    //
+    // Condensation of the call graph into its strongly connected components.
+    // Components are numbered bottom-up, i.e., every component follows all
+    // the components it calls, and the numbering depends only on the graph,
+    // so it is the same in every run. Members of a component are sorted by
+    // their nodes.
+    //
+    struct call_graph_sccs
+    {
+        using scc_id  = std::uint32_t;
+        using node_id = call_graph::node_id;
+
+        explicit call_graph_sccs(const call_graph &graph);
+
+        const call_graph &graph() const { return _graph; }
+
+        std::size_t size() const { return member_offsets.size() - 1; }
+
+        scc_id scc(node_id node) const { return scc_of[node]; }
+
+        llvm::ArrayRef< node_id > members(scc_id scc) const {
+            return row(member_offsets, member_nodes, scc);
+        }
+
+        // Components called by the component, without itself.
+        llvm::ArrayRef< scc_id > callees(scc_id scc) const {
+            return row(callee_offsets, callee_sccs, scc);
+        }
+
+        llvm::ArrayRef< scc_id > callers(scc_id scc) const {
+            return row(caller_offsets, caller_sccs, scc);
+        }
+
+        // True if the component is a cycle, i.e., it has more than one
+        // function or its function calls itself.
+        bool recursive(scc_id scc) const;
+
+      private:
+        template< typename T >
+        static llvm::ArrayRef< T > row(
+            const std::vector< std::uint32_t > &offsets, const std::vector< T > &values, scc_id scc
+        ) {
+            return llvm::ArrayRef(values).slice(offsets[scc], offsets[scc + 1] - offsets[scc]);
+        }
+
+        const call_graph &_graph;
+
+        std::vector< scc_id > scc_of;
+
+        std::vector< std::uint32_t > member_offsets;
+        std::vector< node_id > member_nodes;
+
+        std::vector< std::uint32_t > callee_offsets;
+        std::vector< scc_id > callee_sccs;
+
+        std::vector< std::uint32_t > caller_offsets;
+        std::vector< scc_id > caller_sccs;
+    };
+
+    using scc_id = call_graph_sccs::scc_id;
+
+    // Called with the number of finished components and their total, by one
+    // thread at a time.
+    using scc_progress = llvm::function_ref< void(std::size_t, std::size_t) >;
+
+    //
+    // Runs `process` on every component once all the components it calls are
+    // processed. Ready components are run on the thread pool of the context
+    // and every finished component releases its callers, so independent
+    // subtrees of the DAG are processed concurrently. Without multithreading,
+    // components run in the order of their numbering.
+    //
+    // Once `process` fails, components that did not start yet are skipped and
+    // the schedule fails.
+    //
+    logical_result schedule_bottom_up(
+        const call_graph_sccs &sccs, mcontext_t *mctx,
+        llvm::function_ref< logical_result(scc_id) > process,
+        scc_progress progress = {}
+    );
+
+    //
+    // Computes a result per component bottom-up, `compute(scc, results)` may
+    // read the results of the callees of `scc`. The results are indexed by the
+    // components, hence they do not depend on the order in which the
+    // components were processed. Returns `std::nullopt` if any computation
+    // does.
+    //
+    template< typename result_t, typename compute_t >
+    std::optional< std::vector< result_t > > bottom_up_results(
+        const call_graph_sccs &sccs, mcontext_t *mctx, compute_t &&compute,
+        scc_progress progress = {}
+    ) {
+        // Elements are written by distinct components, and every one of them
+        // before its callers are released.
+        std::vector< std::optional< result_t > > slots(sccs.size());
+        auto process = [&] (scc_id scc) -> logical_result {
+            auto view = [&] (scc_id callee) -> const result_t & { return *slots[callee]; };
+            slots[scc] = compute(scc, view);
+            return mlir::success(slots[scc].has_value());
+        };
+
+        if (mlir::failed(schedule_bottom_up(sccs, mctx, process, progress))) {
+            return std::nullopt;
+        }
+
+        std::vector< result_t > results;
+        results.reserve(slots.size());
+        for (auto &slot : slots) {
+            results.push_back(std::move(*slot));
+        }
+        return results;
+    }
+
+} // namespace vast::analysis
@@ -0,0 +1,63 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Operation.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vast::analysis
+{
+    //
+    // Difference of the functions of two modules, e.g., of two tower layers.
+    // Functions defined or declared at the top level of the modules are
+    // matched by their symbol names and compared by their structural hashes,
+    // so equal functions cost only their hashing, which runs in parallel.
+    // Operations are compared only in the functions whose hashes differ.
+    //
+    struct op_line
+    {
+        enum class kind_t : std::uint8_t { removed, added };
+
+        kind_t kind;
+        // Nesting depth of the operation in its function.
+        unsigned depth;
+        // Name, attributes and types of the operation, without its regions.
+        std::string text;
+    };
+
+    struct changed_function
+    {
+        std::string name;
+        // Lines of the operations present only in one of the functions, in
+        // the order of the functions.
+        std::vector< op_line > lines;
+        // Set once the functions are too large to be compared operation by
+        // operation, their differing parts are then listed whole.
+        bool truncated = false;
+    };
+
+    struct module_diff
+    {
+        std::vector< std::string > removed;
+        std::vector< std::string > added;
+        std::vector< changed_function > changed;
+        std::size_t unchanged = 0;
+
+        bool empty() const { return removed.empty() && added.empty() && changed.empty(); }
+
+        void print(llvm::raw_ostream &os) const;
+    };
+
+    module_diff structural_diff(operation from, operation to);
+
+} // namespace vast::analysis
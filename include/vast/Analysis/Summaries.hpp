@@ -0,0 +1,73 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/STLFunctionalExtras.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/CallGraph.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::analysis
+{
+    //
+    // Structural hash of a function: its signature, attributes and body,
+    // without its name, the locations and the attributes of the meta
+    // dialect. Values are hashed by the order of their definitions, so
+    // that equal bodies of distinct modules or runs hash equally.
+    //
+    std::string body_hash(mlir::FunctionOpInterface fn);
+
+    //
+    // Keys of the summaries of the functions of the call graph, by node. The
+    // key of a function combines the hash of its body with the keys of its
+    // callees, so that a summary is recomputed once the function or any of
+    // the functions it reaches changes. Callees of a cycle contribute the
+    // hashes of their bodies. Bodies are hashed in parallel.
+    //
+    std::vector< std::string > summary_keys(const call_graph &graph);
+
+    //
+    // Store of serialized summaries of functions per (analysis, key), e.g.,
+    // side effects or noreturn, kept in memory and, if a directory is
+    // given, on disk as `<dir>/<analysis>/<key>`, so that successive runs
+    // recompute only the summaries of changed functions. Entries are
+    // written atomically, and the store may be used from multiple threads.
+    //
+    struct summary_store
+    {
+        explicit summary_store(std::string dir = {}) : dir(std::move(dir)) {}
+
+        std::optional< std::string > lookup(string_ref analysis, string_ref key);
+
+        void insert(string_ref analysis, string_ref key, std::string summary);
+
+        // Computes the summary only if it is not stored yet.
+        std::string get(string_ref analysis, string_ref key, llvm::function_ref< std::string() > compute);
+
+        std::size_t hits() const { return _hits; }
+        std::size_t misses() const { return _misses; }
+
+      private:
+        std::string path(string_ref analysis, string_ref key) const;
+
+        std::string dir;
+
+        std::mutex mutex;
+        llvm::StringMap< std::string > entries;
+
+        std::size_t _hits = 0;
+        std::size_t _misses = 0;
+    };
+
+} // namespace vast::analysis
@@ -6,8 +6,11 @@
 
 VAST_RELAX_WARNINGS
 #include <clang/Frontend/ASTUnit.h>
+#include <mlir/Dialect/ControlFlow/IR/ControlFlowOps.h>
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
 #include <mlir/IR/Verifier.h>
-#include <mlir/InitAllDialects.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/CodeGen/DefaultVisitor.hpp"
@@ -23,7 +26,7 @@ VAST_UNRELAX_WARNINGS
 namespace vast::cg
 {
     template< typename From, typename Symbol >
-    using scoped_symbol_table = llvm::ScopedHashTableScope< From, Symbol >;
+    using scoped_symbol_table = scoped_table_scope< From, Symbol >;
 
     using typedefs_scope    = scoped_symbol_table< const clang::TypedefDecl *, hl::TypeDefOp >;
     using typedecls_scope   = scoped_symbol_table< const clang::TypeDecl *, hl::TypeDeclOp >;
@@ -47,6 +50,41 @@ namespace vast::cg
         vars_scope          globs;
     };
 
+    //
+    // Registry of dialects available to the generated module. It is built once
+    // and shared by all contexts. Only dialects that codegen emits are loaded
+    // eagerly, upstream dialects needed by conversion pipelines are loaded
+    // lazily by passes that depend on them.
+    //
+    inline const mlir::DialectRegistry &codegen_dialect_registry() {
+        static const mlir::DialectRegistry registry = [] {
+            mlir::DialectRegistry registry;
+            vast::registerAllDialects(registry);
+            registry.insert<
+                mlir::DLTIDialect,
+                mlir::LLVM::LLVMDialect,
+                mlir::func::FuncDialect,
+                mlir::cf::ControlFlowDialect
+            >();
+            return registry;
+        }();
+
+        return registry;
+    }
+
+    inline void load_codegen_dialects(mcontext_t &mctx) {
+        mctx.appendDialectRegistry(codegen_dialect_registry());
+        mctx.loadDialect<
+            vast::abi::ABIDialect,
+            vast::core::CoreDialect,
+            vast::hl::HighLevelDialect,
+            vast::ll::LowLevelDialect,
+            vast::meta::MetaDialect,
+            vast::unsup::UnsupportedDialect,
+            mlir::DLTIDialect
+        >();
+    }
+
     template< typename derived_t >
     using default_visitor_stack = fallback_visitor< derived_t,
         default_visitor, unsup_visitor, unreach_visitor
@@ -66,9 +104,7 @@ namespace vast::cg
         codegen_instance(codegen_context &cgctx, meta_generator &meta)
             : base(cgctx, meta)
         {
-            mlir::registerAllDialects(cgctx.mctx);
-            vast::registerAllDialects(cgctx.mctx);
-            cgctx.mctx.loadAllAvailableDialects();
+            load_codegen_dialects(cgctx.mctx);
 
             scope = std::unique_ptr< scope_t >( new scope_t{
                 .typedefs   = cgctx.typedefs,
@@ -90,6 +126,8 @@ namespace vast::cg
             hl::emit_data_layout(mcontext(), this->ctx.mod, this->ctx.data_layout());
         }
 
+        // Functions are isolated from above, hence the verifier checks their
+        // bodies in parallel.
         bool verify_module() const {
             return mlir::verify(this->ctx.mod.get()).succeeded();
         }
@@ -302,6 +340,9 @@ namespace vast::cg
 
         logical_result build_compound_stmt_without_scope(const clang::CompoundStmt &stmt) {
             for (auto *curr : stmt.body()) {
+                if (this->out_of_budget()) {
+                    break;
+                }
                 if (build_stmt(curr, /* use current scope */ false).failed()) {
                     return mlir::failure();
                 }
@@ -0,0 +1,76 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/Allocator.h>
+VAST_UNRELAX_WARNINGS
+
+#include <cstddef>
+#include <vector>
+
+namespace vast::cg
+{
+    //
+    // function_arena
+    //
+    // Short-lived temporaries of codegen, e.g., operands and element types
+    // gathered before an operation is built, are allocated from an arena
+    // instead of the heap. The arena is reset when codegen of the outermost
+    // scope, i.e., a top-level declaration or a function body, finishes. The
+    // first slab is kept, so that consecutive functions reuse it.
+    //
+    // Temporaries must not outlive the scope they were allocated in.
+    //
+    struct function_arena
+    {
+        struct scope
+        {
+            explicit scope(function_arena &arena) : arena(arena) { ++arena.depth; }
+
+            ~scope() {
+                if (--arena.depth == 0) {
+                    arena.allocator.Reset();
+                }
+            }
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+            function_arena &arena;
+        };
+
+        llvm::BumpPtrAllocator allocator;
+        unsigned depth = 0;
+    };
+
+    // Allocator of standard containers backed by the function arena, memory
+    // is released only when the arena is reset.
+    template< typename T >
+    struct arena_allocator
+    {
+        using value_type = T;
+
+        arena_allocator(function_arena &arena) : arena(&arena) {}
+
+        template< typename U >
+        arena_allocator(const arena_allocator< U > &other) : arena(other.arena) {}
+
+        T *allocate(std::size_t n) {
+            return static_cast< T * >(arena->allocator.Allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T *, std::size_t) {}
+
+        template< typename U >
+        bool operator==(const arena_allocator< U > &other) const { return arena == other.arena; }
+
+        function_arena *arena;
+    };
+
+    template< typename T >
+    using arena_vector = std::vector< T, arena_allocator< T > >;
+
+} // namespace vast::cg
@@ -84,7 +84,43 @@ namespace vast::cg {
         }
 
         mlir_attr VisitNonNullAttr(const clang::NonNullAttr *attr) {
-            return make< hl::NonNullAttr >();
+            llvm::SmallVector< unsigned > params;
+            for (auto idx : attr->args()) {
+                params.push_back(idx.getLLVMIndex());
+            }
+            return make< hl::NonNullAttr >(params);
+        }
+
+        mlir_attr VisitReturnsNonNullAttr(const clang::ReturnsNonNullAttr *attr) {
+            return make< hl::ReturnsNonNullAttr >();
+        }
+
+        mlir_attr VisitHotAttr(const clang::HotAttr *attr) {
+            return make< hl::HotAttr >();
+        }
+
+        mlir_attr VisitColdAttr(const clang::ColdAttr *attr) {
+            return make< hl::ColdAttr >();
+        }
+
+        mlir_attr VisitNoInlineAttr(const clang::NoInlineAttr *attr) {
+            return make< hl::NoInlineAttr >();
+        }
+
+        mlir_attr VisitAlwaysInlineAttr(const clang::AlwaysInlineAttr *attr) {
+            return make< hl::AlwaysInlineAttr >();
+        }
+
+        mlir_attr VisitNoReturnAttr(const clang::NoReturnAttr *attr) {
+            return make< hl::NoReturnAttr >();
+        }
+
+        mlir_attr VisitC11NoReturnAttr(const clang::C11NoReturnAttr *attr) {
+            return make< hl::NoReturnAttr >();
+        }
+
+        mlir_attr VisitCXX11NoReturnAttr(const clang::CXX11NoReturnAttr *attr) {
+            return make< hl::NoReturnAttr >();
         }
 
         mlir_attr VisitModeAttr(const clang::ModeAttr *attr) {
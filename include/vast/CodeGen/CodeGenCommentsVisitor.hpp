@@ -0,0 +1,34 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/RawCommentList.h>
+#include <mlir/IR/BuiltinAttributes.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::cg {
+
+    constexpr string_ref comment_attr_name = "comment";
+
+    //
+    // Raw comment attached to a declaration (-vast-emit-comments).
+    //
+    // Comments are looked up only when they are requested, the text is a view
+    // of the source buffer up to its copy into the attribute.
+    //
+    inline mlir::StringAttr comment_attr(
+        acontext_t &actx, mcontext_t &mctx, const clang::Decl *decl
+    ) {
+        if (auto raw = actx.getRawCommentForDeclNoCache(decl)) {
+            return mlir::StringAttr::get(&mctx, raw->getRawText(actx.getSourceManager()));
+        }
+        return {};
+    }
+
+} // namespace vast::cg
@@ -7,6 +7,7 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/GlobalDecl.h>
 #include <clang/AST/ASTContext.h>
+#include <clang/Basic/CodeGenOptions.h>
 #include <clang/Basic/SourceManager.h>
 #include <llvm/ADT/ScopedHashTable.h>
 #include <llvm/ADT/SmallPtrSet.h>
@@ -16,6 +17,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/Support/LogicalResult.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/CodeGen/CodeGenArena.hpp"
 #include "vast/CodeGen/CodeGenScope.hpp"
 #include "vast/CodeGen/ScopeContext.hpp"
 #include "vast/CodeGen/Mangler.hpp"
@@ -36,6 +38,14 @@ namespace vast::cg
 {
     using source_language = core::SourceLanguage;
 
+    // -vast-unsupported=full|summary|drop
+    //
+    // full    mirrors the whole clang subtree
+    // summary emits one operation per subtree with its source range and the
+    //         types of the values it references
+    // drop    emits one bare operation per subtree
+    enum class unsupported_mode { full, summary, drop };
+
     namespace detail {
 
         static void set_source_language(vast_module op, source_language lang) {
@@ -70,6 +80,13 @@ namespace vast::cg
             // TODO(cg): For now we do not have our own operation, so we cannot
             //           introduce new ctor.
             set_triple(*module_ref, actx.getTargetInfo().getTriple().str());
+
+            if (actx.getLangOpts().isSignedOverflowDefined()) {
+                module_ref->getOperation()->setAttr(
+                    core::CoreDialect::getWrapvAttrName(), mlir::UnitAttr::get(&mctx)
+                );
+            }
+
             return module_ref;
         }
     } // namespace detail
@@ -81,11 +98,31 @@ namespace vast::cg
 
         dl::DataLayoutBlueprint dl;
 
+        // Attach clang record layouts to emitted record definitions.
+        bool emit_record_layouts = false;
+
+        // Attach raw comments to emitted declarations.
+        bool emit_comments = false;
+
+        // How subtrees of unsupported declarations and statements are emitted.
+        unsupported_mode unsupported = unsupported_mode::full;
+
+        // Name local variables by their index in the function instead of
+        // their identifiers.
+        bool strip_local_names = false;
+
+        // Index of the next local variable of the function in codegen.
+        unsigned local_index = 0;
+
+        // Thread-local storage model of `-ftls-model`, thread-local variables
+        // use it unless a more specific model applies to them.
+        clang::CodeGenOptions::TLSModel tls_model = clang::CodeGenOptions::GeneralDynamicTLSModel;
+
         codegen_context(mcontext_t &mctx, acontext_t &actx, owning_module_ref &&mod)
             : mctx(mctx)
             , actx(actx)
             , mod(std::move(mod))
-            , mangler(actx.createMangleContext())
+            , mangler(mctx, actx.createMangleContext())
         {}
 
         codegen_context(mcontext_t &mctx, acontext_t &actx, source_language lang)
@@ -94,8 +131,10 @@ namespace vast::cg
 
         lexical_scope_context *current_lexical_scope = nullptr;
 
-        // Never move this!
-        // It owns the strings that mangled_name_ref uses
+        // Temporaries of the declaration or function in codegen.
+        function_arena arena;
+
+        // Keeps the interned mangled names of declarations.
         CodeGenMangler mangler;
 
         using var_table = scoped_table< const clang::VarDecl *, Value >;
@@ -126,7 +165,18 @@ namespace vast::cg
         LabelTable labels;
 
         size_t anonymous_count = 0;
-        llvm::DenseMap< const clang::NamedDecl *, std::string > tag_names;
+
+        // Qualified names of declarations, computed once per translation unit.
+        // The names are uniqued in the MLIR context, hence the references to
+        // them stay valid and type attributes are built without rehashing.
+        llvm::DenseMap< const clang::NamedDecl *, mlir::StringAttr > tag_names;
+
+        // Names of the indices of stripped local variables.
+        std::vector< mlir::StringAttr > local_names;
+
+        // Namespace prefixes of declaration contexts, e.g., "ns::record::",
+        // shared by all declarations nested in the same context.
+        llvm::DenseMap< const clang::DeclContext *, std::string > namespace_prefixes;
 
         /// Set of global decls for which we already diagnosed mangled name conflict.
         /// Required to not issue a warning (on a mangling conflict) multiple times
@@ -144,7 +194,8 @@ namespace vast::cg
         // for emission and therefore should only be output if they are actually
         // used. If a decl is in this, then it is known to have not been referenced
         // yet.
-        std::map< mangled_name_ref, clang::GlobalDecl > deferred_decls;
+        using deferred_decls_map = llvm::DenseMap< mangled_name_ref, clang::GlobalDecl >;
+        deferred_decls_map deferred_decls;
 
         // A queue of (optional) vtables to consider emitting.
         std::vector< const clang::CXXRecordDecl * > deferred_vtables;
@@ -153,8 +204,9 @@ namespace vast::cg
             return mangler.get_mangled_name(decl, actx.getTargetInfo(), /* module name hash */ "");
         }
 
-        // This is a list of deferred decls which we have seen that *are* actually
-        // referenced. These get code generated when the module is done.
+        // This is a worklist of deferred decls which we have seen that *are*
+        // actually referenced. These get code generated in the insertion order
+        // when the module is done.
         std::vector< clang::GlobalDecl > deferred_decls_to_emit;
         void add_deferred_decl_to_emit(clang::GlobalDecl decl) {
             deferred_decls_to_emit.emplace_back(decl);
@@ -164,12 +216,6 @@ namespace vast::cg
             deferred_decls[name] = decl;
         }
 
-        auto receive_deferred_decls_to_emit() {
-            std::vector< clang::GlobalDecl > current;
-            current.swap(deferred_decls_to_emit);
-            return current;
-        }
-
         // After HandleTranslation finishes, differently from deferred_decls_to_emit,
         // default_methods_to_emit is only called after a set of vast passes run.
         // See add_default_methods_to_emit usage for examples.
@@ -178,9 +224,13 @@ namespace vast::cg
             default_methods_to_emit.emplace_back(decl);
         }
 
+        // Functions are the only globals codegen refers to by their symbols.
+        // They are all declared in `funcdecls`, hence the lookup is a single
+        // probe of the table, wherever the module nests them (e.g., in
+        // `hl.translation_unit`), instead of a scan of the module body.
         operation get_global_value(mangled_name_ref name) {
-            if (auto global = mlir::SymbolTable::lookupSymbolIn(mod.get(), name.name))
-                return global;
+            if (auto fn = funcdecls.lookup(name))
+                return fn;
             return {};
         }
 
@@ -194,24 +244,21 @@ namespace vast::cg
             return "anonymous[" + std::to_string(decl->getID()) + "]";
         }
 
-        std::string get_namespaced_for_decl_name(const clang::NamedDecl *decl) {
-            // gather contexts
-            std::vector< const clang::DeclContext * > dctxs;
-            for (const auto *dctx = decl->getDeclContext(); dctx; dctx = dctx->getParent()) {
-                dctxs.push_back(dctx);
+        const std::string &get_namespaced_for_decl_name(const clang::NamedDecl *decl) {
+            return namespace_prefix(decl->getDeclContext());
+        }
+
+        const std::string &namespace_prefix(const clang::DeclContext *dctx) {
+            if (auto it = namespace_prefixes.find(dctx); it != namespace_prefixes.end()) {
+                return it->second;
             }
 
             std::string name;
-            for (const auto *dctx : llvm::reverse(dctxs)) {
-                if (llvm::isa< clang::TranslationUnitDecl >(dctx))
-                    continue;
-
-                if (llvm::isa< clang::FunctionDecl >(dctx))
-                    continue;
-
-                if (llvm::isa< clang::LinkageSpecDecl >(dctx))
-                    continue;
+            if (auto parent = dctx->getParent()) {
+                name = namespace_prefix(parent);
+            }
 
+            if (!llvm::isa< clang::TranslationUnitDecl, clang::FunctionDecl, clang::LinkageSpecDecl >(dctx)) {
                 if (const auto *d = llvm::dyn_cast< clang::NamedDecl >(dctx)) {
                     name += get_decl_name(d);
                 } else {
@@ -221,21 +268,33 @@ namespace vast::cg
                 name += "::";
             }
 
-            return name;
+            return namespace_prefixes.try_emplace(dctx, std::move(name)).first->second;
         }
 
         std::string get_namespaced_decl_name(const clang::NamedDecl *decl) {
             return get_namespaced_for_decl_name(decl) + get_decl_name(decl);
         }
 
-        llvm::StringRef decl_name(const clang::NamedDecl *decl) {
-            if (tag_names.count(decl)) {
-                return tag_names[decl];
+        mlir::StringAttr decl_name_attr(const clang::NamedDecl *decl) {
+            if (auto it = tag_names.find(decl); it != tag_names.end()) {
+                return it->second;
             }
 
-            auto name = get_namespaced_decl_name(decl);
-            auto [it, _] = tag_names.try_emplace(decl, name);
-            return it->second;
+            auto name = mlir::StringAttr::get(&mctx, get_namespaced_decl_name(decl));
+            return tag_names.try_emplace(decl, name).first->second;
+        }
+
+        llvm::StringRef decl_name(const clang::NamedDecl *decl) {
+            return decl_name_attr(decl).getValue();
+        }
+
+        // Indices are shared by all functions, so that only a handful of
+        // names is ever interned.
+        llvm::StringRef local_name(unsigned idx) {
+            while (local_names.size() <= idx) {
+                local_names.push_back(mlir::StringAttr::get(&mctx, std::to_string(local_names.size())));
+            }
+            return local_names[idx].getValue();
         }
 
         const dl::DataLayoutBlueprint &data_layout() const { return dl; }
@@ -255,11 +314,11 @@ namespace vast::cg
         }
 
         hl::FuncOp lookup_function(mangled_name_ref mangled, bool with_error = true) {
-            return symbol(funcdecls, mangled, "undeclared function '" + mangled.name + "'", with_error);
+            return symbol(funcdecls, mangled, "undeclared function '" + mangled.name() + "'", with_error);
         }
 
         hl::FuncOp declare(mangled_name_ref mangled, auto vast_decl_builder) {
-            return declare< hl::FuncOp >(funcdecls, mangled, vast_decl_builder, mangled.name);
+            return declare< hl::FuncOp >(funcdecls, mangled, vast_decl_builder, mangled.name());
         }
 
         mlir_value declare(const clang::VarDecl *decl, mlir_value vast_value) {
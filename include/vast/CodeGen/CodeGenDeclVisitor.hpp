@@ -6,14 +6,17 @@
 
 VAST_RELAX_WARNINGS
 #include <llvm/ADT/ScopedHashTable.h>
+#include <llvm/ADT/StringSwitch.h>
 #include <clang/AST/DeclVisitor.h>
 #include <clang/AST/Attr.h>
+#include <clang/AST/RecordLayout.h>
 #include <clang/Basic/Diagnostic.h>
 #include <clang/Frontend/FrontendDiagnostic.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/CodeGen/CodeGenMeta.hpp"
 #include "vast/CodeGen/CodeGenBuilder.hpp"
+#include "vast/CodeGen/CodeGenCommentsVisitor.hpp"
 #include "vast/CodeGen/CodeGenVisitorBase.hpp"
 #include "vast/CodeGen/CodeGenVisitorLens.hpp"
 #include "vast/CodeGen/CodeGenFunction.hpp"
@@ -69,6 +72,12 @@ namespace vast::cg {
         }
 
         auto visit_decl_attrs(const clang::Decl *decl, operation op) {
+            if (context().emit_comments) {
+                if (auto comment = comment_attr(acontext(), mcontext(), decl)) {
+                    op->setAttr(comment_attr_name, comment);
+                }
+            }
+
             // getAttrs on decl without attrs triggers an assertion in clang
             if (decl->hasAttrs()) {
                 mlir::NamedAttrList attrs = op->getAttrs();
@@ -113,7 +122,7 @@ namespace vast::cg {
             // make function header, that will be later filled with function body
             // or returned as declaration in the case of external function
             auto fn = context().declare(mangled_name, [&] () {
-                return make< hl::FuncOp >(loc, mangled_name.name, fty, linkage);
+                return make< hl::FuncOp >(loc, mangled_name.symbol, fty, linkage);
             });
 
             visit_decl_attrs(function_decl, fn);
@@ -174,7 +183,7 @@ namespace vast::cg {
                             if (record_conflicting_definition(glob)) {
                                 auto &diags = acontext().getDiagnostics();
                                 // FIXME: this should not be responsibility of visitor
-                                diags.Report(decl->getLocation(), clang::diag::err_duplicate_mangled_name) << mangled_name.name;
+                                diags.Report(decl->getLocation(), clang::diag::err_duplicate_mangled_name) << mangled_name.name();
                                 diags.Report(other->getDecl()->getLocation(), clang::diag::note_previous_definition);
                             }
                         }
@@ -378,6 +387,8 @@ namespace vast::cg {
             };
 
             auto emit_function_body = [&] (auto fn) {
+                context().local_index = 0;
+
                 auto entry = fn.addEntryBlock();
                 set_insertion_point_to_start(entry);
 
@@ -443,7 +454,7 @@ namespace vast::cg {
                 auto type = visit_function_type(decl->getFunctionType(), decl->isVariadic());
                 // make function header, that will be later filled with function body
                 // or returned as declaration in the case of external function
-                return make< hl::FuncOp >(loc, mangled.name, type, linkage);
+                return make< hl::FuncOp >(loc, mangled.symbol, type, linkage);
             });
 
             if (!is_definition) {
@@ -499,6 +510,52 @@ namespace vast::cg {
             VAST_UNIMPLEMENTED_MSG("unknown thread storage class");
         }
 
+        //
+        // Chooses the model as clang and the llvm backend do together. Shared
+        // libraries need the dynamic models, executables access variables by
+        // an offset from the thread pointer, which is a link-time constant for
+        // variables they define and is loaded from the got otherwise. Models
+        // chosen by `-ftls-model` or the `tls_model` attribute are used if
+        // they are more specific. Returns no model for general dynamic.
+        //
+        llvm::StringRef VisitTLSModel(const clang::VarDecl *decl) const {
+            using cg_options = clang::CodeGenOptions;
+
+            const auto &lang = acontext().getLangOpts();
+            bool shared = lang.PICLevel != 0 && !lang.PIE;
+            bool local  = !decl->isExternallyVisible()
+                || decl->getVisibility() != clang::DefaultVisibility
+                || (!shared && decl->hasDefinition() != clang::VarDecl::DeclarationOnly);
+
+            auto model = shared
+                ? (local ? cg_options::LocalDynamicTLSModel : cg_options::GeneralDynamicTLSModel)
+                : (local ? cg_options::LocalExecTLSModel : cg_options::InitialExecTLSModel);
+
+            auto selected = context().tls_model;
+            if (const auto *attr = decl->getAttr< clang::TLSModelAttr >()) {
+                selected = llvm::StringSwitch< cg_options::TLSModel >(attr->getModel())
+                    .Case("local-dynamic", cg_options::LocalDynamicTLSModel)
+                    .Case("initial-exec", cg_options::InitialExecTLSModel)
+                    .Case("local-exec", cg_options::LocalExecTLSModel)
+                    .Default(cg_options::GeneralDynamicTLSModel);
+            }
+
+            switch (std::max(model, selected)) {
+                case cg_options::GeneralDynamicTLSModel: return {};
+                case cg_options::LocalDynamicTLSModel: return "localdynamic";
+                case cg_options::InitialExecTLSModel: return "initialexec";
+                case cg_options::LocalExecTLSModel: return "localexec";
+            }
+            VAST_UNIMPLEMENTED_MSG("unknown tls model");
+        }
+
+        llvm::StringRef var_name(const clang::VarDecl *decl) {
+            if (context().strip_local_names && decl->hasLocalStorage()) {
+                return context().local_name(context().local_index++);
+            }
+            return context().decl_name(decl->getUnderlyingDecl());
+        }
+
         operation VisitVarDecl(const clang::VarDecl *decl) {
             auto var_decl = context().declare(decl, [&] {
                 auto type = decl->getType();
@@ -513,7 +570,7 @@ namespace vast::cg {
                 auto var = this->template make_operation< hl::VarDeclOp >()
                     .bind(meta_location(decl))                                  // location
                     .bind(visit_as_lvalue_type(type))                           // type
-                    .bind(context().decl_name(decl->getUnderlyingDecl()))       // name
+                    .bind(var_name(decl))                                       // name
                     // The initializer region is filled later as it might
                     // have references to the VarDecl we are currently
                     // visiting - int *x = malloc(sizeof(*x))
@@ -527,6 +584,12 @@ namespace vast::cg {
 
                 if (auto tsc = VisitThreadStorageClass(decl); tsc != hl::TSClass::tsc_none) {
                     var.setThreadStorageClass(tsc);
+                    if (auto model = VisitTLSModel(decl); !model.empty()) {
+                        var->setAttr(
+                            hl::HighLevelDialect::getTLSModelAttrName(),
+                            mlir::StringAttr::get(&mcontext(), model)
+                        );
+                    }
                 }
 
                 return var;
@@ -757,7 +820,44 @@ namespace vast::cg {
                 }
             };
 
-            return make< Op >(loc, name, fields);
+            auto op = make< Op >(loc, name, fields);
+            if constexpr (std::is_same_v< Op, hl::StructDeclOp > || std::is_same_v< Op, hl::UnionDeclOp >) {
+                // Bitfields are lowered to the storage units of the clang
+                // layout, hence their records always carry it.
+                if (context().emit_record_layouts || has_bitfields(decl)) {
+                    attach_record_layout(op, decl);
+                }
+            }
+            return op;
+        }
+
+        static bool has_bitfields(const clang::RecordDecl *decl) {
+            return llvm::any_of(decl->fields(), [] (const clang::FieldDecl *field) {
+                return field->isBitField();
+            });
+        }
+
+        // Records the layout computed by clang, so that lowering does not
+        // need to recompute offsets of the record fields.
+        template< typename Op >
+        void attach_record_layout(Op op, const clang::RecordDecl *decl) {
+            if (!op || decl->isInvalidDecl() || decl->isDependentType() || decl->field_empty()) {
+                return;
+            }
+
+            const auto &layout = acontext().getASTRecordLayout(decl);
+
+            llvm::SmallVector< uint64_t > offsets;
+            for (auto field : decl->fields()) {
+                offsets.push_back(layout.getFieldOffset(field->getFieldIndex()));
+            }
+
+            op.setLayoutAttr(hl::RecordLayoutAttr::get(
+                &mcontext(),
+                uint64_t(acontext().toBits(layout.getSize())),
+                uint64_t(acontext().toBits(layout.getAlignment())),
+                offsets
+            ));
         }
 
         operation VisitRecordDecl(const clang::RecordDecl *decl) {
@@ -7,15 +7,21 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/Decl.h>
 #include <clang/AST/GlobalDecl.h>
+#include <llvm/Support/Regex.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
 #include "vast/CodeGen/CodeGen.hpp"
+#include "vast/CodeGen/HeaderCache.hpp"
+#include "vast/CodeGen/InstantiationCache.hpp"
+#include "vast/CodeGen/Profile.hpp"
 
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DataLayout.hpp"
+#include "vast/Util/MemoryLimit.hpp"
+#include "vast/Util/TimeBudget.hpp"
 
 namespace vast::cg
 {
@@ -37,6 +43,16 @@ namespace vast::cg
 
     meta_generator_ptr make_meta_generator(codegen_context &cgctx, const cc::vast_args &vargs);
 
+    // Builds matcher of -vast-roots=<regex;...> option, every entry has to
+    // match the whole function name.
+    std::optional< llvm::Regex > make_roots_matcher(const cc::vast_args &vargs);
+
+    unsupported_mode get_unsupported_mode(const cc::vast_args &vargs);
+
+    // Replaces the body of the function by an unsupported statement named by
+    // `reason`, followed by `hl.unreachable`.
+    void stub_function_body(hl::FuncOp fn, string_ref reason);
+
     // This is a layer that provides interface between
     // clang codegen and vast codegen
 
@@ -50,7 +66,24 @@ namespace vast::cg
             , vargs(vargs)
             , meta(make_meta_generator(cgctx, vargs))
             , codegen(cgctx, *meta)
-        {}
+            , record_emitted_functions(vargs.has_option(cc::opt::stream_functions))
+            , lazy_function_bodies(vargs.has_option(cc::opt::lazy_function_bodies))
+            , roots(make_roots_matcher(vargs))
+            , system_headers_decls_only(vargs.has_option(cc::opt::system_headers_decls_only))
+            , preamble_cache(make_header_cache(cgctx, vargs))
+            , in_preamble(preamble_cache.has_value())
+            , instantiations(make_instantiation_cache(cgctx, opts, vargs))
+        {
+            cgctx.emit_record_layouts = vargs.has_option(cc::opt::record_layouts);
+            cgctx.emit_comments = vargs.has_option(cc::opt::emit_comments);
+            cgctx.strip_local_names = vargs.has_option(cc::opt::strip_local_names);
+            cgctx.tls_model = opts.codegen.getDefaultTLSModel();
+            cgctx.unsupported = get_unsupported_mode(vargs);
+            enable_stats();
+            enable_memory_limit();
+            enable_function_budget();
+            enable_profile();
+        }
 
         ~codegen_driver() {
             VAST_ASSERT(deferred_inline_member_func_defs.empty());
@@ -67,8 +100,27 @@ namespace vast::cg
         void handle_top_level_decl(clang::DeclGroupRef decls);
         void handle_top_level_decl(clang::Decl *decl);
 
+        // Inline definitions of C++ member functions are recorded once their
+        // class is complete, and handled after the enclosing top-level
+        // declaration, as the linkage of the method may change until then
+        // (e.g., with a typedef name of an anonymous class).
+        void handle_inline_function_definition(clang::FunctionDecl *decl);
+
         void finalize();
 
+        // Yields function definitions with finished codegen since the last
+        // call. Definitions are recorded only if functions are streamed.
+        std::vector< hl::FuncOp > take_emitted_functions();
+
+        // With lazy function bodies, definitions are emitted as declarations
+        // and their bodies are generated on the first request. Bodies can be
+        // materialized only while the clang AST is alive.
+        bool has_lazy_body(string_ref name) const;
+
+        // Generates the body of the lazily emitted function. Returns null if
+        // there is no pending body of the given name.
+        hl::FuncOp materialize_function(string_ref name);
+
         const acontext_t &acontext() const { return cgctx.actx; }
         const mcontext_t &mcontext() const { return cgctx.mctx; }
 
@@ -80,6 +132,13 @@ namespace vast::cg
         operation build_global_function_definition(clang::GlobalDecl decl);
         operation build_global_var_definition(const clang::VarDecl *decl, bool tentative = false);
 
+        // Function bodies are emitted serially. Body emission is not safe to
+        // run concurrently even after Sema finished: the ASTContext lazily
+        // fills its caches (record layouts, type info, mangling numbers), and
+        // codegen updates module-level state (callee prototypes, type
+        // declarations, data layout entries, shared scope tables). To compile
+        // in parallel, use batch mode, which runs translation units
+        // concurrently.
         hl::FuncOp build_function_body(hl::FuncOp fn, clang::GlobalDecl decl);
 
         hl::FuncOp emit_function_epilogue(hl::FuncOp fn, clang::GlobalDecl decl);
@@ -97,8 +156,60 @@ namespace vast::cg
 
         bool may_drop_function_return(clang::QualType rty) const;
 
+        // With -vast-codegen-stats[=N], codegen records visits per node kind
+        // and the N slowest top-level declarations, printed at finalization.
+        void enable_stats();
+        void print_stats() const;
+
+        // With -vast-memory-limit, the budget is checked when codegen of a
+        // declaration starts and periodically while its nodes are visited.
+        void enable_memory_limit();
+        void check_memory_limit(const clang::Decl *decl);
+
+        // With -vast-function-budget, codegen of a function body that takes
+        // longer than the budget stops early and the body is stubbed.
+        void enable_function_budget();
+        hl::FuncOp stub_over_budget(hl::FuncOp fn, clang::GlobalDecl decl);
+
+        // With -fprofile-instr-use, functions are annotated by their entry
+        // counts and branches by their weights. Hot functions are exempt
+        // from the function budget.
+        void enable_profile();
+        std::optional< function_profile > profile_of(hl::FuncOp fn, clang::GlobalDecl decl) const;
+
+        // With -vast-header-cache, top-level declarations are collected until
+        // the first declaration of the main file. The preamble is then either
+        // spliced from the cache or generated and stored.
+        bool starts_main_file(clang::DeclGroupRef decls) const;
+        void emit_preamble(clang::SourceLocation end);
+
+        // With -vast-instantiation-cache, bodies of implicit template
+        // instantiations are spliced from the entries of earlier translation
+        // units, or the instantiations are left as declarations with
+        // -vast-instantiation-decls. Returns null if the body has to be
+        // generated.
+        hl::FuncOp emit_cached_instantiation(hl::FuncOp fn, string_ref key);
+
+        // With -vast-roots, definitions of other functions are deferred until
+        // they are referenced from code reachable from the roots.
+        bool is_root(const clang::FunctionDecl *decl) const;
+
+        // With -vast-system-headers-decls-only, definitions from system
+        // headers are emitted as declarations until they are referenced.
+        bool is_in_system_header(const clang::Decl *decl) const;
+
+        // Emits deferred definitions referenced through declarations that were
+        // emitted before their first use, until no new references appear.
+        void build_referenced_deferred_decls();
+
         const std::vector< clang::GlobalDecl >& deferred_decls_to_emit() const;
-        const std::map< mangled_name_ref, clang::GlobalDecl >& deferred_decls() const;
+        const codegen_context::deferred_decls_map& deferred_decls() const;
+
+        // Determine whether the definition has to be emitted even if nothing
+        // refers to it. In C++, other definitions, e.g., of inline functions or
+        // implicit instantiations, are deferred until they are referenced, as
+        // in clang. In C, all definitions are emitted.
+        bool must_be_emitted(const clang::ValueDecl *decl) const;
 
         // Determine whether the definition can be emitted eagerly, or should be
         // delayed until the end of the translation unit. This is relevant for
@@ -115,7 +226,8 @@ namespace vast::cg
 
         void add_replacement(string_ref name, mlir::Operation *Op);
 
-        // Call replaceAllUsesWith on all pairs in replacements.
+        // Redirects uses of the replaced symbols to their replacements and
+        // erases the replaced symbols, all in a single walk of the module.
         void apply_replacements();
 
         inline auto lang() const { return acontext().getLangOpts(); }
@@ -131,6 +243,28 @@ namespace vast::cg
 
         meta_generator_ptr meta;
         default_codegen codegen;
+
+        bool record_emitted_functions;
+        std::vector< hl::FuncOp > emitted_functions;
+
+        bool lazy_function_bodies;
+        llvm::StringMap< clang::GlobalDecl > lazy_bodies;
+
+        std::optional< llvm::Regex > roots;
+
+        bool system_headers_decls_only;
+
+        std::optional< memory_limit > memory;
+
+        std::optional< time_budget > budget;
+
+        std::optional< instr_profile > profile;
+
+        std::optional< header_cache > preamble_cache;
+        bool in_preamble;
+        std::vector< clang::DeclGroupRef > preamble;
+
+        std::optional< instantiation_cache > instantiations;
     };
 
 } // namespace vast::cg
@@ -9,11 +9,14 @@ VAST_RELAX_WARNINGS
 #include <clang/AST/CXXInheritance.h>
 #include <clang/AST/TypeLoc.h>
 #include <clang/Basic/FileEntry.h>
+#include <llvm/ADT/DenseMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Meta/MetaAttributes.hpp"
 
+#include <atomic>
 #include <concepts>
+#include <optional>
 
 namespace vast::cg
 {
@@ -45,24 +48,111 @@ namespace vast::cg
 
       private:
 
-        loc_t location(const clang::FullSourceLoc &loc) const {
-            auto file = loc.getFileEntry() ? loc.getFileEntry()->getName() : "unknown";
-            auto line = loc.getLineNumber();
-            auto col  = loc.getColumnNumber();
-            return { mlir::FileLineColLoc::get(mctx, file, line, col) };
+        mlir::StringAttr file_name(clang::FileID fid) const {
+            auto [it, inserted] = files.try_emplace(fid);
+            if (inserted) {
+                auto entry = actx->getSourceManager().getFileEntryForID(fid);
+                it->second = mlir::StringAttr::get(mctx, entry ? entry->getName() : "unknown");
+            }
+            return it->second;
         }
 
+        // Consecutive ops often share the source location, e.g., implicit
+        // casts and their operands, hence the last location is reused.
+        // Line lookups of the source manager are cached for the last queried
+        // file, so resolving locations in source order stays incremental.
         loc_t location(const clang::SourceLocation &loc) const {
-            return location(clang::FullSourceLoc(loc, actx->getSourceManager()));
+            if (last && last->first == loc) {
+                return last->second;
+            }
+
+            const auto &sm = actx->getSourceManager();
+            auto [fid, offset] = sm.getDecomposedLoc(loc);
+
+            auto line = sm.getLineNumber(fid, offset);
+            auto col  = sm.getColumnNumber(fid, offset);
+            loc_t result = { mlir::FileLineColLoc::get(file_name(fid), line, col) };
+
+            last = { loc, result };
+            return result;
         }
 
         acontext_t *actx;
         mcontext_t *mctx;
+
+        mutable llvm::DenseMap< clang::FileID, mlir::StringAttr > files;
+        mutable std::optional< std::pair< clang::SourceLocation, loc_t > > last;
     };
 
+    //
+    // Compact locations refer to files through the file table of the module,
+    // see meta::SourcePositionAttr.
+    //
+    struct compact_meta_gen : meta_generator {
+        compact_meta_gen(acontext_t *actx, mcontext_t *mctx, vast_module mod)
+            : actx(actx), mctx(mctx), mod(mod)
+        {}
+
+        loc_t location(const clang::Decl *decl) const final {
+            return location(decl->getLocation());
+        }
+
+        loc_t location(const clang::Stmt *stmt) const final {
+            return location(stmt->getBeginLoc());
+        }
+
+        loc_t location(const clang::Expr *expr) const final {
+            return location(expr->getExprLoc());
+        }
+
+      private:
+
+        unsigned file_index(clang::FileID fid) const {
+            auto [it, inserted] = files.try_emplace(fid);
+            if (inserted) {
+                auto entry = actx->getSourceManager().getFileEntryForID(fid);
+                it->second = meta::add_source_file(mod, entry ? entry->getName() : "unknown");
+            }
+            return it->second;
+        }
+
+        loc_t location(const clang::SourceLocation &loc) const {
+            const auto &sm = actx->getSourceManager();
+            auto [fid, offset] = sm.getDecomposedLoc(loc);
+
+            auto pos = meta::SourcePositionAttr::get(mctx,
+                file_index(fid), sm.getLineNumber(fid, offset), sm.getColumnNumber(fid, offset)
+            );
+
+            return mlir::FusedLoc::get({ mlir::UnknownLoc::get(mctx) }, pos, mctx);
+        }
+
+        acontext_t *actx;
+        mcontext_t *mctx;
+        vast_module mod;
+
+        mutable llvm::DenseMap< clang::FileID, unsigned > files;
+    };
+
+    struct unknown_meta_gen : meta_generator {
+        explicit unknown_meta_gen(mcontext_t *mctx) : mctx(mctx) {}
+
+        loc_t location(const clang::Decl *) const final { return mlir::UnknownLoc::get(mctx); }
+        loc_t location(const clang::Stmt *) const final { return mlir::UnknownLoc::get(mctx); }
+        loc_t location(const clang::Expr *) const final { return mlir::UnknownLoc::get(mctx); }
+
+      private:
+        mcontext_t *mctx;
+    };
+
+    //
+    // Generates identifiers unique across all translation units of the
+    // process, see meta::make_identifier. Units are compiled concurrently in
+    // batch mode, hence the local counter is atomic as well.
+    //
     struct id_meta_gen : meta_generator {
         id_meta_gen(acontext_t *, mcontext_t *mctx)
-            : mctx(mctx)
+            : mctx(mctx), unit(meta::make_unit_identifier())
         {}
 
         loc_t location(const clang::Decl *decl) const final { return location_impl(decl); }
@@ -80,11 +170,15 @@ namespace vast::cg
             return make_location(meta::IdentifierAttr::get(mctx, id));
         }
 
-        loc_t location_impl(auto token) const { return { make_location(counter++) }; }
-
-        mutable meta::identifier_t counter = 0;
+        loc_t location_impl(auto token) const {
+            auto local = counter.fetch_add(1, std::memory_order_relaxed);
+            return { make_location(meta::make_identifier(unit, local)) };
+        }
 
         mcontext_t *mctx;
+
+        meta::unit_identifier_t unit;
+        mutable std::atomic< meta::local_identifier_t > counter = 0;
     };
 
 } // namespace vast::cg
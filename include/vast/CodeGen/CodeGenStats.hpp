@@ -0,0 +1,99 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTContext.h>
+#include <clang/AST/Attr.h>
+#include <clang/AST/Decl.h>
+#include <clang/AST/Stmt.h>
+#include <clang/AST/Type.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <chrono>
+#include <vector>
+
+namespace vast::cg
+{
+    //
+    // Statistics of the codegen visitors (-vast-codegen-stats): visits of
+    // clang nodes per kind, how many of them fell through the first visitor
+    // of the stack, e.g., to the unsupported one, and time spent in codegen
+    // of the slowest top-level declarations.
+    //
+    // Visitors record the statistics only in builds with
+    // VAST_ENABLE_CODEGEN_STATS, otherwise the hooks compile to nothing.
+    //
+    struct codegen_stats
+    {
+        using duration = std::chrono::steady_clock::duration;
+
+        explicit codegen_stats(unsigned top) : top(top) {}
+
+        void visited(const clang::Stmt *stmt, bool fallback) {
+            count(stmts, stmt ? stmt->getStmtClassName() : "<null>", fallback);
+        }
+
+        void visited(const clang::Decl *decl, bool fallback) {
+            count(decls, decl ? decl->getDeclKindName() : "<null>", fallback);
+        }
+
+        void visited(const clang::Type *type, bool fallback) {
+            count(types, type ? type->getTypeClassName() : "<null>", fallback);
+        }
+
+        void visited(clang::QualType type, bool fallback) {
+            visited(type.getTypePtrOrNull(), fallback);
+        }
+
+        void visited(const clang::Attr *attr, bool fallback) {
+            count(attrs, attr ? attr->getSpelling() : "<null>", fallback);
+        }
+
+        // Records codegen time of the top-level declaration, only the `top`
+        // slowest ones are kept.
+        void timed(const clang::Decl *decl, const acontext_t &actx, duration time);
+
+        void print(llvm::raw_ostream &os) const;
+
+      private:
+        struct counter
+        {
+            std::uint64_t visits    = 0;
+            std::uint64_t fallbacks = 0;
+        };
+
+        using counters = llvm::StringMap< counter >;
+
+        static void count(counters &kinds, string_ref kind, bool fallback) {
+            auto &entry = kinds[kind];
+            ++entry.visits;
+            entry.fallbacks += fallback;
+        }
+
+        struct timed_decl
+        {
+            duration time;
+            std::string name;
+        };
+
+        unsigned top;
+
+        counters stmts;
+        counters decls;
+        counters types;
+        counters attrs;
+
+        // Min-heap of the slowest declarations by their time.
+        std::vector< timed_decl > slowest;
+        std::uint64_t timed_decls = 0;
+        duration total_time{};
+    };
+
+} // namespace vast::cg
@@ -5,8 +5,10 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <clang/AST/Attr.h>
 #include <clang/AST/StmtVisitor.h>
 #include <clang/AST/OperationKinds.h>
+#include <clang/Basic/Builtins.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/CodeGen/CodeGenMeta.hpp"
@@ -69,6 +71,9 @@ namespace vast::cg {
         operation VisitCompoundStmt(const clang::CompoundStmt *stmt) {
             return derived().template make_scoped< CoreScope >(meta_location(stmt), [&] {
                 for (auto s : stmt->body()) {
+                    if (derived().out_of_budget()) {
+                        break;
+                    }
                     visit(s);
                 }
             });
@@ -86,9 +91,18 @@ namespace vast::cg {
             return make< Op >(meta_location(op), type, lhs, rhs);
         }
 
+        // Operations on vectors are element-wise, hence they are selected by
+        // the element type.
+        static clang::QualType arith_type(clang::QualType ty) {
+            if (auto vector = ty->getAs< clang::VectorType >()) {
+                return vector->getElementType();
+            }
+            return ty;
+        }
+
         template< typename UOp, typename SOp >
         Operation* VisitIBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = arith_type(op->getType());
             if (ty->isUnsignedIntegerType())
                 return VisitBinOp< UOp >(op);
             if (ty->isIntegerType())
@@ -98,7 +112,7 @@ namespace vast::cg {
 
         template< typename IOp, typename FOp >
         operation VisitIFBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = arith_type(op->getType());
             if (ty->isIntegerType())
                 return VisitBinOp< IOp >(op);
             // FIXME: eventually decouple arithmetic and pointer additions?
@@ -111,7 +125,7 @@ namespace vast::cg {
 
         template< typename UOp, typename SOp, typename FOp >
         operation VisitIFBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = arith_type(op->getType());
             if (ty->isUnsignedIntegerType())
                 return VisitBinOp< UOp >(op);
             if (ty->isIntegerType())
@@ -239,6 +253,12 @@ namespace vast::cg {
 
         template< typename Op >
         operation VisitAssignBinOp(const clang::BinaryOperator *op) {
+            // Compound assignments of atomics without a read-modify-write
+            // are not supported.
+            if (op->getLHS()->getType()->isAtomicType()) {
+                return nullptr;
+            }
+
             auto lhs = visit(op->getLHS())->getResult(0);
             auto rhs = visit(op->getRHS())->getResult(0);
             return make< Op >(meta_location(op), lhs, rhs);
@@ -246,7 +266,7 @@ namespace vast::cg {
 
         template< typename UOp, typename SOp >
         operation VisitAssignIBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = arith_type(op->getType());
             if (ty->isUnsignedIntegerType())
                 return VisitAssignBinOp< UOp >(op);
             if (ty->isIntegerType())
@@ -256,7 +276,7 @@ namespace vast::cg {
 
         template< typename IOp, typename FOp >
         operation VisitAssignIFBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = arith_type(op->getType());
             if (ty->isIntegerType())
                 return VisitAssignBinOp< IOp >(op);
             // FIXME: eventually decouple arithmetic and pointer additions?
@@ -269,7 +289,7 @@ namespace vast::cg {
 
         template< typename UOp, typename SOp, typename FOp >
         operation VisitAssignIFBinOp(const clang::BinaryOperator *op) {
-            auto ty = op->getType();
+            auto ty = arith_type(op->getType());
             if (ty->isUnsignedIntegerType())
                 return VisitAssignBinOp< UOp >(op);
             if (ty->isIntegerType())
@@ -280,6 +300,9 @@ namespace vast::cg {
         }
 
         operation VisitBinAssign(const clang::BinaryOperator *op) {
+            if (op->getLHS()->getType()->isAtomicType()) {
+                return VisitAtomicAssign(op);
+            }
             return VisitAssignBinOp< hl::AssignOp >(op);
         }
 
@@ -300,10 +323,16 @@ namespace vast::cg {
         }
 
         operation VisitBinAddAssign(const clang::CompoundAssignOperator *op) {
+            if (op->getLHS()->getType()->isAtomicType()) {
+                return VisitAtomicCompoundAssign< hl::AtomicRMWKind::Add, hl::AddIOp >(op);
+            }
             return VisitAssignIFBinOp< hl::AddIAssignOp, hl::AddFAssignOp >(op);
         }
 
         operation VisitBinSubAssign(const clang::CompoundAssignOperator *op) {
+            if (op->getLHS()->getType()->isAtomicType()) {
+                return VisitAtomicCompoundAssign< hl::AtomicRMWKind::Sub, hl::SubIOp >(op);
+            }
             return VisitAssignIFBinOp< hl::SubIAssignOp, hl::SubFAssignOp >(op);
         }
 
@@ -316,14 +345,23 @@ namespace vast::cg {
         }
 
         operation VisitBinAndAssign(const clang::CompoundAssignOperator *op) {
+            if (op->getLHS()->getType()->isAtomicType()) {
+                return VisitAtomicCompoundAssign< hl::AtomicRMWKind::And, hl::BinAndOp >(op);
+            }
             return VisitAssignBinOp< hl::BinAndAssignOp >(op);
         }
 
         operation VisitBinOrAssign(const clang::CompoundAssignOperator *op) {
+            if (op->getLHS()->getType()->isAtomicType()) {
+                return VisitAtomicCompoundAssign< hl::AtomicRMWKind::Or, hl::BinOrOp >(op);
+            }
             return VisitAssignBinOp< hl::BinOrAssignOp >(op);
         }
 
         operation VisitBinXorAssign(const clang::CompoundAssignOperator *op) {
+            if (op->getLHS()->getType()->isAtomicType()) {
+                return VisitAtomicCompoundAssign< hl::AtomicRMWKind::Xor, hl::BinXorOp >(op);
+            }
             return VisitAssignBinOp< hl::BinXorAssignOp >(op);
         }
 
@@ -355,18 +393,30 @@ namespace vast::cg {
         }
 
         operation VisitUnaryPostInc(const clang::UnaryOperator *op) {
+            if (op->getSubExpr()->getType()->isAtomicType()) {
+                return VisitAtomicIncDec< hl::AtomicRMWKind::Add, hl::AddIOp >(op, /* prefix */ false);
+            }
             return VisitUnderlyingTypePreservingUnary< hl::PostIncOp >(op);
         }
 
         operation VisitUnaryPostDec(const clang::UnaryOperator *op) {
+            if (op->getSubExpr()->getType()->isAtomicType()) {
+                return VisitAtomicIncDec< hl::AtomicRMWKind::Sub, hl::SubIOp >(op, /* prefix */ false);
+            }
             return VisitUnderlyingTypePreservingUnary< hl::PostDecOp >(op);
         }
 
         operation VisitUnaryPreInc(const clang::UnaryOperator *op) {
+            if (op->getSubExpr()->getType()->isAtomicType()) {
+                return VisitAtomicIncDec< hl::AtomicRMWKind::Add, hl::AddIOp >(op, /* prefix */ true);
+            }
             return VisitUnderlyingTypePreservingUnary< hl::PreIncOp >(op);
         }
 
         operation VisitUnaryPreDec(const clang::UnaryOperator *op) {
+            if (op->getSubExpr()->getType()->isAtomicType()) {
+                return VisitAtomicIncDec< hl::AtomicRMWKind::Sub, hl::SubIOp >(op, /* prefix */ true);
+            }
             return VisitUnderlyingTypePreservingUnary< hl::PreDecOp >(op);
         }
 
@@ -417,11 +467,13 @@ namespace vast::cg {
             auto asm_attr = get_string_attr(stmt->getAsmString()->getString());
 
             if (stmt->isSimple()) {
-                return make< hl::AsmOp >(meta_location(stmt),
-                                               asm_attr,
-                                               stmt->isVolatile(),
-                                               false /*has_goto*/
-                                              );
+                auto op = make< hl::AsmOp >(meta_location(stmt),
+                                                  asm_attr,
+                                                  stmt->isVolatile(),
+                                                  false /*has_goto*/
+                                                 );
+                op.setIsSimple(true);
+                return op;
             }
 
             values_t outputs;
@@ -513,7 +565,143 @@ namespace vast::cg {
         // operation VisitCoyieldExpr(const clang::CoyieldExpr *expr)
         // operation VisitDependentCoawaitExpr(const clang::DependentCoawaitExpr *expr)
 
-        // operation VisitAttributedStmt(const clang::AttributedStmt *stmt)
+        //
+        // Attributed Statements
+        //
+
+        // Loop pragmas are attached to the loop they precede and `musttail`
+        // to the call of the return, other statement attributes are dropped.
+        operation VisitAttributedStmt(const clang::AttributedStmt *stmt) {
+            auto op = visit(stmt->getSubStmt());
+            if (!op) {
+                return op;
+            }
+
+            if (auto hints = loop_hints(stmt->getAttrs())) {
+                if (auto loop = find_loop(op)) {
+                    loop->setAttr(hl::HighLevelDialect::getLoopHintsAttrName(), hints);
+                }
+            }
+
+            auto is_musttail = [] (const clang::Attr *attr) { return clang::isa< clang::MustTailAttr >(attr); };
+            if (mlir::isa< hl::ReturnOp >(op) && llvm::any_of(stmt->getAttrs(), is_musttail)) {
+                mark_musttail(op);
+            }
+
+            return op;
+        }
+
+        // The call of a `musttail` return is the last call evaluated before
+        // the return, calls of its arguments precede it.
+        void mark_musttail(operation ret) {
+            for (auto prev = ret->getPrevNode(); prev; prev = prev->getPrevNode()) {
+                operation call = nullptr;
+                prev->walk([&] (operation nested) {
+                    if (mlir::isa< hl::CallOp, hl::IndirectCallOp >(nested)) {
+                        call = nested;
+                    }
+                });
+
+                if (call) {
+                    call->setAttr(
+                        hl::HighLevelDialect::getMustTailAttrName(), mlir::UnitAttr::get(&mcontext())
+                    );
+                    return;
+                }
+            }
+        }
+
+        hl::LoopHintsAttr loop_hints(llvm::ArrayRef< const clang::Attr * > attrs) {
+            mlir::BoolAttr vectorize, unroll, unroll_full, distribute;
+            unsigned vectorize_width = 0, interleave_count = 0, unroll_count = 0;
+
+            auto mctx = &mcontext();
+            auto value = [&] (const clang::LoopHintAttr *hint) -> unsigned {
+                auto expr = hint->getValue();
+                if (!expr || expr->isValueDependent()) {
+                    return 0;
+                }
+                return unsigned(expr->EvaluateKnownConstInt(lens::acontext()).getZExtValue());
+            };
+
+            bool any = false;
+            for (auto attr : attrs) {
+                auto hint = clang::dyn_cast< clang::LoopHintAttr >(attr);
+                if (!hint) {
+                    continue;
+                }
+
+                using hint_t = clang::LoopHintAttr;
+                auto enabled = hint->getState() == hint_t::Enable || hint->getState() == hint_t::AssumeSafety;
+                auto disabled = hint->getState() == hint_t::Disable;
+
+                switch (hint->getOption()) {
+                    case hint_t::Vectorize:
+                        if (enabled || disabled) {
+                            vectorize = mlir::BoolAttr::get(mctx, enabled);
+                        }
+                        break;
+                    case hint_t::VectorizeWidth:
+                        if (hint->getState() == hint_t::Numeric || hint->getState() == hint_t::FixedWidth) {
+                            vectorize_width = value(hint);
+                        }
+                        break;
+                    case hint_t::Interleave:
+                        if (disabled) {
+                            interleave_count = 1;
+                        }
+                        break;
+                    case hint_t::InterleaveCount:
+                        interleave_count = value(hint);
+                        break;
+                    case hint_t::Unroll:
+                        if (hint->getState() == hint_t::Full) {
+                            unroll_full = mlir::BoolAttr::get(mctx, true);
+                        } else if (enabled || disabled) {
+                            unroll = mlir::BoolAttr::get(mctx, enabled);
+                        }
+                        break;
+                    case hint_t::UnrollCount:
+                        unroll_count = value(hint);
+                        break;
+                    case hint_t::Distribute:
+                        if (enabled || disabled) {
+                            distribute = mlir::BoolAttr::get(mctx, enabled);
+                        }
+                        break;
+                    default:
+                        continue;
+                }
+
+                any = true;
+            }
+
+            if (!any) {
+                return {};
+            }
+
+            return hl::LoopHintsAttr::get(
+                mctx, vectorize, vectorize_width, interleave_count,
+                unroll, unroll_count, unroll_full, distribute
+            );
+        }
+
+        // Loops with an init statement are wrapped in a scope.
+        static operation find_loop(operation op) {
+            if (mlir::isa< hl::ForOp, hl::WhileOp, hl::DoOp >(op)) {
+                return op;
+            }
+
+            if (auto scope = mlir::dyn_cast< core::ScopeOp >(op)) {
+                for (auto &nested : scope.getBody().getOps()) {
+                    if (mlir::isa< hl::ForOp, hl::WhileOp, hl::DoOp >(nested)) {
+                        return &nested;
+                    }
+                }
+            }
+
+            return nullptr;
+        }
 
         //
         // Cast Operations
@@ -605,8 +793,9 @@ namespace vast::cg {
                 // case clang::CastKind::CK_ARCReclaimReturnedObject:
                 // case clang::CastKind::CK_ARCExtendBlockObject:
 
-                // case clang::CastKind::CK_AtomicToNonAtomic:
-                // case clang::CastKind::CK_NonAtomicToAtomic:
+                case clang::CastKind::CK_AtomicToNonAtomic:
+                case clang::CastKind::CK_NonAtomicToAtomic:
+                    return keep_category_cast();
 
                 // case clang::CastKind::CK_CopyAndAutoreleaseBlockObject:
                 // case clang::CastKind::CK_BuiltinFnToFnPtr:
@@ -629,7 +818,12 @@ namespace vast::cg {
         }
 
         operation VisitImplicitCastExpr(const clang::ImplicitCastExpr *expr) {
-             return VisitCast< hl::ImplicitCastOp >(expr);
+            if (expr->getCastKind() == clang::CastKind::CK_LValueToRValue
+                && expr->getSubExpr()->getType()->isAtomicType()
+            ) {
+                return VisitAtomicRead(expr);
+            }
+            return VisitCast< hl::ImplicitCastOp >(expr);
         }
 
         operation VisitCStyleCastExpr(const clang::CStyleCastExpr *expr) {
@@ -786,7 +980,13 @@ namespace vast::cg {
         operation VisitCaseStmt(const clang::CaseStmt *stmt) {
             auto lhs_builder  = make_value_builder(stmt->getLHS());
             auto body_builder = make_region_builder(stmt->getSubStmt());
-            return make< hl::CaseOp >(meta_location(stmt), lhs_builder, body_builder);
+            auto op = make< hl::CaseOp >(meta_location(stmt), lhs_builder, body_builder);
+            if (op && stmt->caseStmtIsGNURange()) {
+                op->setAttr(
+                    hl::HighLevelDialect::getCaseRangeAttrName(), mlir::UnitAttr::get(&mcontext())
+                );
+            }
+            return op;
         }
 
         operation VisitDefaultStmt(const clang::DefaultStmt *stmt) {
@@ -822,7 +1022,9 @@ namespace vast::cg {
         operation VisitWhileStmt(const clang::WhileStmt *stmt) {
             auto cond_builder = make_cond_builder(stmt->getCond());
             auto body_builder = make_region_builder(stmt->getBody());
-            return make< hl::WhileOp >(meta_location(stmt), cond_builder, body_builder);
+            auto op = make< hl::WhileOp >(meta_location(stmt), cond_builder, body_builder);
+            set_profile_weights(op, stmt);
+            return op;
         }
 
         // operation VisitCXXCatchStmt(const clang::CXXCatchStmt *stmt)
@@ -837,9 +1039,11 @@ namespace vast::cg {
             auto make_loop_op = [&] {
                 auto incr = make_region_builder(stmt->getInc());
                 auto body = make_region_builder(stmt->getBody());
-                if (auto cond = stmt->getCond())
-                    return make< hl::ForOp >(loc, make_cond_builder(cond), incr, body);
-                return make< hl::ForOp >(loc, make_yield_true(), incr, body);
+                auto op = stmt->getCond()
+                    ? make< hl::ForOp >(loc, make_cond_builder(stmt->getCond()), incr, body)
+                    : make< hl::ForOp >(loc, make_yield_true(), incr, body);
+                set_profile_weights(op, stmt);
+                return op;
             };
 
             if (stmt->getInit()) {
@@ -856,7 +1060,11 @@ namespace vast::cg {
             auto lab = visit(stmt->getLabel())->getResult(0);
             return make< hl::GotoStmt >(meta_location(stmt), lab);
         }
-        // operation VisitIndirectGotoStmt(const clang::IndirectGotoStmt *stmt)
+
+        operation VisitIndirectGotoStmt(const clang::IndirectGotoStmt *stmt) {
+            auto target = visit(stmt->getTarget())->getResult(0);
+            return make< hl::IndirectGotoStmt >(meta_location(stmt), target);
+        }
 
         operation VisitLabelStmt(const clang::LabelStmt *stmt) {
             auto lab = visit(stmt->getDecl())->getResult(0);
@@ -865,12 +1073,74 @@ namespace vast::cg {
         }
 
         operation VisitIfStmt(const clang::IfStmt *stmt) {
-            return this->template make_operation< hl::IfOp >()
+            auto op = this->template make_operation< hl::IfOp >()
                 .bind(meta_location(stmt))
                 .bind(make_cond_builder(stmt->getCond()))
                 .bind(make_region_builder(stmt->getThen()))
                 .bind_if(stmt->getElse(), make_region_builder(stmt->getElse()))
                 .freeze();
+
+            // Counts of the profile take precedence over the expectations
+            // of the source, as in clang.
+            if (!set_profile_weights(op, stmt) && op) {
+                if (auto weights = branch_weights(stmt)) {
+                    op->setAttr(hl::HighLevelDialect::getBranchWeightsAttrName(), weights);
+                }
+            }
+
+            return op;
+        }
+
+        // Sets the weights of the branch of `stmt` from the instrumentation
+        // profile (-fprofile-instr-use), if the statement is profiled.
+        bool set_profile_weights(operation op, const clang::Stmt *stmt) {
+            auto profile = derived().profile;
+            if (!op || !profile) {
+                return false;
+            }
+
+            auto it = profile->branches.find(stmt);
+            if (it == profile->branches.end()) {
+                return false;
+            }
+
+            auto [taken, not_taken] = it->second;
+            op->setAttr(
+                hl::HighLevelDialect::getBranchWeightsAttrName(),
+                hl::BranchWeightsAttr::get(&mcontext(), taken, not_taken)
+            );
+            return true;
+        }
+
+        // Weights of the likely and the unlikely branch, as clang assigns
+        // them to `__builtin_expect`.
+        static constexpr std::uint32_t likely_weight   = 2000;
+        static constexpr std::uint32_t unlikely_weight = 1;
+
+        hl::BranchWeightsAttr branch_weights(const clang::IfStmt *stmt) {
+            auto make_weights = [&] (bool likely) {
+                return likely
+                    ? hl::BranchWeightsAttr::get(&mcontext(), likely_weight, unlikely_weight)
+                    : hl::BranchWeightsAttr::get(&mcontext(), unlikely_weight, likely_weight);
+            };
+
+            switch (clang::Stmt::getLikelihood(stmt->getThen(), stmt->getElse())) {
+                case clang::Stmt::LH_Likely:   return make_weights(true);
+                case clang::Stmt::LH_Unlikely: return make_weights(false);
+                case clang::Stmt::LH_None:     break;
+            }
+
+            auto call = clang::dyn_cast< clang::CallExpr >(stmt->getCond()->IgnoreParenImpCasts());
+            if (!call || call->getBuiltinCallee() != clang::Builtin::BI__builtin_expect) {
+                return {};
+            }
+
+            auto expected = call->getArg(1);
+            if (expected->isValueDependent() || !expected->isEvaluatable(lens::acontext())) {
+                return {};
+            }
+
+            return make_weights(!expected->EvaluateKnownConstInt(lens::acontext()).isZero());
         }
 
         //
@@ -897,7 +1167,7 @@ namespace vast::cg {
 
         operation VisitAddrLabelExpr(const clang::AddrLabelExpr *expr) {
             auto lab = visit(expr->getLabel())->getResult(0);
-            auto rty = visit_as_lvalue_type(expr->getType());
+            auto rty = visit(expr->getType());
             return make< hl::AddrLabelExpr >(meta_location(expr), rty, lab);
         }
 
@@ -915,7 +1185,315 @@ namespace vast::cg {
 
         // operation VisitArrayTypeTraitExpr(const clang::ArrayTypeTraitExpr *expr)
         // operation VisitAsTypeExpr(const clang::AsTypeExpr *expr)
-        // operation VisitAtomicExpr(const clang::AtomicExpr *expr)
+
+        // Values llvm atomics can access, aggregates would need the locks of
+        // the atomic library and booleans are not whole bytes.
+        static bool has_native_atomics(clang::QualType type) {
+            return type->isScalarType() && !type->isBooleanType();
+        }
+
+        operation VisitAtomicExpr(const clang::AtomicExpr *expr) {
+            using clang::AtomicExpr;
+
+            if (!has_native_atomics(expr->getValueType())) {
+                return nullptr;
+            }
+
+            auto loc   = meta_location(expr);
+            auto order = [&] { return memory_order(expr->getOrder()); };
+            auto value_type = visit(expr->getValueType());
+            auto pointee    = [] (const clang::Expr *ptr) { return ptr->getType()->getPointeeType(); };
+
+            // Generic builtins pass their values by pointers.
+            auto value_of = [&] (const clang::Expr *ptr) {
+                return load(visit(ptr)->getResult(0), pointee(ptr), loc);
+            };
+
+            switch (expr->getOp()) {
+                case AtomicExpr::AO__c11_atomic_load:
+                case AtomicExpr::AO__atomic_load_n: {
+                    auto ptr = visit(expr->getPtr())->getResult(0);
+                    return make< hl::AtomicLoadOp >(loc, value_type, ptr, order());
+                }
+                case AtomicExpr::AO__atomic_load: {
+                    auto ptr   = visit(expr->getPtr())->getResult(0);
+                    auto ret   = visit(expr->getVal1())->getResult(0);
+                    auto value = make< hl::AtomicLoadOp >(loc, value_type, ptr, order());
+                    return store(ret, pointee(expr->getVal1()), value->getResult(0), loc);
+                }
+
+                // Initialization is not an atomic operation, it is a relaxed
+                // store, which is a plain one for the backend.
+                case AtomicExpr::AO__c11_atomic_init: {
+                    auto ptr   = visit(expr->getPtr())->getResult(0);
+                    auto value = visit(expr->getVal1())->getResult(0);
+                    return make< hl::AtomicStoreOp >(loc, ptr, value, hl::MemoryOrder::relaxed);
+                }
+                case AtomicExpr::AO__c11_atomic_store:
+                case AtomicExpr::AO__atomic_store_n: {
+                    auto ptr   = visit(expr->getPtr())->getResult(0);
+                    auto value = visit(expr->getVal1())->getResult(0);
+                    return make< hl::AtomicStoreOp >(loc, ptr, value, order());
+                }
+                case AtomicExpr::AO__atomic_store: {
+                    auto ptr   = visit(expr->getPtr())->getResult(0);
+                    auto value = value_of(expr->getVal1());
+                    return make< hl::AtomicStoreOp >(loc, ptr, value, order());
+                }
+
+                case AtomicExpr::AO__c11_atomic_exchange:
+                case AtomicExpr::AO__atomic_exchange_n: {
+                    auto ptr   = visit(expr->getPtr())->getResult(0);
+                    auto value = visit(expr->getVal1())->getResult(0);
+                    return make< hl::AtomicRMWOp >(
+                        loc, value_type, hl::AtomicRMWKind::Xchg, ptr, value, order()
+                    );
+                }
+                case AtomicExpr::AO__atomic_exchange: {
+                    auto ptr   = visit(expr->getPtr())->getResult(0);
+                    auto value = value_of(expr->getVal1());
+                    auto ret   = visit(expr->getVal2())->getResult(0);
+                    auto old   = make< hl::AtomicRMWOp >(
+                        loc, value_type, hl::AtomicRMWKind::Xchg, ptr, value, order()
+                    );
+                    return store(ret, pointee(expr->getVal2()), old->getResult(0), loc);
+                }
+
+                case AtomicExpr::AO__c11_atomic_compare_exchange_strong:
+                case AtomicExpr::AO__c11_atomic_compare_exchange_weak:
+                case AtomicExpr::AO__atomic_compare_exchange_n:
+                case AtomicExpr::AO__atomic_compare_exchange:
+                    return VisitAtomicCmpXchg(expr);
+
+                default:
+                    return VisitAtomicFetch(expr);
+            }
+        }
+        operation VisitAtomicCmpXchg(const clang::AtomicExpr *expr) {
+            using clang::AtomicExpr;
+
+            auto loc  = meta_location(expr);
+            auto weak = expr->getOp() == AtomicExpr::AO__c11_atomic_compare_exchange_weak;
+            if (expr->getOp() == AtomicExpr::AO__atomic_compare_exchange_n
+                || expr->getOp() == AtomicExpr::AO__atomic_compare_exchange
+            ) {
+                // A strong exchange is a valid weak one.
+                auto arg = expr->getWeak();
+                weak = !arg->isValueDependent() && arg->isEvaluatable(lens::acontext())
+                    && !arg->EvaluateKnownConstInt(lens::acontext()).isZero();
+            }
+
+            auto ptr           = visit(expr->getPtr())->getResult(0);
+            auto expected_ptr  = visit(expr->getVal1())->getResult(0);
+            auto expected_type = expr->getVal1()->getType()->getPointeeType();
+            auto expected      = load(expected_ptr, expected_type, loc);
+
+            auto desired = [&] {
+                auto arg = expr->getVal2();
+                auto value = visit(arg)->getResult(0);
+                if (expr->getOp() != AtomicExpr::AO__atomic_compare_exchange) {
+                    return value;
+                }
+                return load(value, arg->getType()->getPointeeType(), loc);
+            } ();
+
+            auto xchg = make< hl::AtomicCmpXchgOp >(
+                loc, visit(expr->getType()), expected.getType(), ptr, expected, desired,
+                memory_order(expr->getOrder()), memory_order(expr->getOrderFail()), weak
+            );
+
+            // The observed value is written back to `expected` only if the
+            // exchange fails, as in clang. On success nothing but the atomic
+            // object is written, a plain store would race with other threads.
+            auto failed = [&] (auto &, auto loc) {
+                auto success = xchg.getSuccess();
+                auto negated = make< hl::LNotOp >(loc, success.getType(), success);
+                make< hl::CondYieldOp >(loc, negated->getResult(0));
+            };
+
+            auto write_back = [&] (auto &, auto loc) {
+                store(expected_ptr, expected_type, xchg.getOld(), loc);
+            };
+
+            make< hl::IfOp >(loc, failed, write_back);
+            return xchg;
+        }
+
+        // Fetch and op builtins return the previous value, op and fetch
+        // builtins the new one. Only integers are supported.
+        operation VisitAtomicFetch(const clang::AtomicExpr *expr) {
+            using clang::AtomicExpr;
+            using kind = hl::AtomicRMWKind;
+
+            auto [rmw, returns_new] = [&] () -> std::pair< std::optional< kind >, bool > {
+                switch (expr->getOp()) {
+                    case AtomicExpr::AO__c11_atomic_fetch_add:
+                    case AtomicExpr::AO__atomic_fetch_add:  return { kind::Add, false };
+                    case AtomicExpr::AO__c11_atomic_fetch_sub:
+                    case AtomicExpr::AO__atomic_fetch_sub:  return { kind::Sub, false };
+                    case AtomicExpr::AO__c11_atomic_fetch_and:
+                    case AtomicExpr::AO__atomic_fetch_and:  return { kind::And, false };
+                    case AtomicExpr::AO__c11_atomic_fetch_or:
+                    case AtomicExpr::AO__atomic_fetch_or:   return { kind::Or, false };
+                    case AtomicExpr::AO__c11_atomic_fetch_xor:
+                    case AtomicExpr::AO__atomic_fetch_xor:  return { kind::Xor, false };
+                    case AtomicExpr::AO__c11_atomic_fetch_nand:
+                    case AtomicExpr::AO__atomic_fetch_nand: return { kind::Nand, false };
+                    case AtomicExpr::AO__c11_atomic_fetch_max:
+                    case AtomicExpr::AO__atomic_fetch_max:  return { kind::Max, false };
+                    case AtomicExpr::AO__c11_atomic_fetch_min:
+                    case AtomicExpr::AO__atomic_fetch_min:  return { kind::Min, false };
+                    case AtomicExpr::AO__atomic_add_fetch:  return { kind::Add, true };
+                    case AtomicExpr::AO__atomic_sub_fetch:  return { kind::Sub, true };
+                    case AtomicExpr::AO__atomic_and_fetch:  return { kind::And, true };
+                    case AtomicExpr::AO__atomic_or_fetch:   return { kind::Or, true };
+                    case AtomicExpr::AO__atomic_xor_fetch:  return { kind::Xor, true };
+                    case AtomicExpr::AO__atomic_nand_fetch: return { kind::Nand, true };
+                    default: return { std::nullopt, false };
+                }
+            } ();
+
+            if (!rmw || !expr->getValueType()->isIntegerType()) {
+                return nullptr;
+            }
+
+            auto loc   = meta_location(expr);
+            auto type  = visit(expr->getValueType());
+            auto ptr   = visit(expr->getPtr())->getResult(0);
+            auto value = visit(expr->getVal1())->getResult(0);
+            auto old   = make< hl::AtomicRMWOp >(
+                loc, type, *rmw, ptr, value, memory_order(expr->getOrder())
+            );
+
+            if (!returns_new) {
+                return old;
+            }
+
+            return combine(*rmw, old->getResult(0), value, loc);
+        }
+
+        // Value an atomic read-modify-write stores.
+        operation combine(hl::AtomicRMWKind rmw, mlir_value old, mlir_value value, loc_t loc) {
+            auto type = old.getType();
+            switch (rmw) {
+                case hl::AtomicRMWKind::Add: return make< hl::AddIOp >(loc, type, old, value);
+                case hl::AtomicRMWKind::Sub: return make< hl::SubIOp >(loc, type, old, value);
+                case hl::AtomicRMWKind::And: return make< hl::BinAndOp >(loc, type, old, value);
+                case hl::AtomicRMWKind::Or:  return make< hl::BinOrOp >(loc, type, old, value);
+                case hl::AtomicRMWKind::Xor: return make< hl::BinXorOp >(loc, type, old, value);
+                case hl::AtomicRMWKind::Nand: {
+                    auto conj = make< hl::BinAndOp >(loc, type, old, value)->getResult(0);
+                    return make< hl::NotOp >(loc, type, conj);
+                }
+                default:
+                    VAST_UNREACHABLE("read-modify-write without a combined value");
+            }
+        }
+
+        // Orders unknown at compile time are strengthened to sequential
+        // consistency.
+        hl::MemoryOrder memory_order(const clang::Expr *order) {
+            if (!order->isValueDependent() && order->isEvaluatable(lens::acontext())) {
+                auto value = order->EvaluateKnownConstInt(lens::acontext()).getZExtValue();
+                if (auto known = hl::symbolizeMemoryOrder(value)) {
+                    return *known;
+                }
+            }
+            return hl::MemoryOrder::seq_cst;
+        }
+
+        mlir_value load(mlir_value ptr, clang::QualType type, loc_t loc) {
+            auto ref = make< hl::Deref >(loc, visit_as_lvalue_type(type), ptr)->getResult(0);
+            return make< hl::ImplicitCastOp >(
+                loc, visit(type), ref, hl::CastKind::LValueToRValue
+            )->getResult(0);
+        }
+
+        operation store(mlir_value ptr, clang::QualType type, mlir_value value, loc_t loc) {
+            auto ref = make< hl::Deref >(loc, visit_as_lvalue_type(type), ptr)->getResult(0);
+            return make< hl::AssignOp >(loc, ref, value);
+        }
+
+        //
+        // Accesses of lvalues of atomic type are sequentially consistent,
+        // compound assignments and increments of integers are atomic
+        // read-modify-writes.
+        //
+
+        mlir_value atomic_address(const clang::Expr *lvalue) {
+            auto type = visit(lens::acontext().getPointerType(lvalue->getType()));
+            auto ref  = visit(lvalue)->getResult(0);
+            return make< hl::AddressOf >(meta_location(lvalue), type, ref)->getResult(0);
+        }
+
+        operation VisitAtomicRead(const clang::ImplicitCastExpr *expr) {
+            if (!has_native_atomics(expr->getType()->castAs< clang::AtomicType >()->getValueType())) {
+                return nullptr;
+            }
+
+            auto ptr = atomic_address(expr->getSubExpr());
+            return make< hl::AtomicLoadOp >(
+                meta_location(expr), visit(expr->getType()), ptr, hl::MemoryOrder::seq_cst
+            );
+        }
+
+        // The value of the assignment is the stored value.
+        operation VisitAtomicAssign(const clang::BinaryOperator *op) {
+            if (!has_native_atomics(op->getLHS()->getType()->castAs< clang::AtomicType >()->getValueType())) {
+                return nullptr;
+            }
+
+            auto ptr   = atomic_address(op->getLHS());
+            auto value = visit(op->getRHS());
+            make< hl::AtomicStoreOp >(
+                meta_location(op), ptr, value->getResult(0), hl::MemoryOrder::seq_cst
+            );
+            return value;
+        }
+
+        template< hl::AtomicRMWKind rmw, typename Op >
+        operation VisitAtomicCompoundAssign(const clang::CompoundAssignOperator *op) {
+            auto value_type = op->getLHS()->getType()->castAs< clang::AtomicType >()->getValueType();
+            if (!value_type->isIntegerType() || !op->getRHS()->getType()->isIntegerType()) {
+                return nullptr;
+            }
+
+            auto loc  = meta_location(op);
+            auto type = visit(value_type);
+            auto ptr  = atomic_address(op->getLHS());
+
+            // Truncation commutes with the supported operations, the operand
+            // is converted to the type of the atomic.
+            auto value = visit(op->getRHS())->getResult(0);
+            if (value.getType() != type) {
+                value = make< hl::ImplicitCastOp >(
+                    loc, type, value, hl::CastKind::IntegralCast
+                )->getResult(0);
+            }
+
+            auto old = make< hl::AtomicRMWOp >(loc, type, rmw, ptr, value, hl::MemoryOrder::seq_cst);
+            return make< Op >(loc, type, old->getResult(0), value);
+        }
+
+        template< hl::AtomicRMWKind rmw, typename Op >
+        operation VisitAtomicIncDec(const clang::UnaryOperator *op, bool prefix) {
+            auto value_type = op->getSubExpr()->getType()->castAs< clang::AtomicType >()->getValueType();
+            if (!value_type->isIntegerType()) {
+                return nullptr;
+            }
+
+            auto loc  = meta_location(op);
+            auto type = visit(value_type);
+            auto ptr  = atomic_address(op->getSubExpr());
+            auto one  = constant(loc, type, lens::acontext().MakeIntValue(1, value_type));
+
+            auto old = make< hl::AtomicRMWOp >(loc, type, rmw, ptr, one, hl::MemoryOrder::seq_cst);
+            if (!prefix) {
+                return old;
+            }
+            return make< Op >(loc, type, old->getResult(0), one);
+        }
+
         // operation VisitBlockExpr(const clang::BlockExpr *expr)
 
         // operation VisitCXXBindTemporaryExpr(const clang::CXXBindTemporaryExpr *expr)
@@ -959,10 +1537,11 @@ namespace vast::cg {
             return visit(callee);
         }
 
-        using Arguments = llvm::SmallVector< Value, 2 >;
+        using Arguments = arena_vector< Value >;
 
         Arguments VisitArguments(const clang::CallExpr *expr) {
-            Arguments args;
+            Arguments args(context().arena);
+            args.reserve(expr->getNumArgs());
             for (const auto &arg : expr->arguments()) {
                 args.push_back(visit(arg)->getResult(0));
             }
@@ -1010,6 +1589,27 @@ namespace vast::cg {
             return make< hl::StmtExprOp >(loc, rty, std::move(reg));
         }
 
+        operation VisitShuffleVectorExpr(const clang::ShuffleVectorExpr *expr) {
+            // Only the form with constant indices is supported.
+            if (expr->getNumSubExprs() < 3) {
+                return {};
+            }
+
+            auto lhs = visit(expr->getExpr(0))->getResult(0);
+            auto rhs = visit(expr->getExpr(1))->getResult(0);
+
+            // Index -1 selects an undefined element.
+            llvm::SmallVector< std::int32_t > mask;
+            for (unsigned i = 0; i < expr->getNumSubExprs() - 2; ++i) {
+                mask.push_back(std::int32_t(expr->getShuffleMaskIdx(lens::acontext(), i).getExtValue()));
+            }
+
+            auto rty = visit(expr->getType());
+            return make< hl::ShuffleVectorOp >(
+                meta_location(expr), rty, lhs, rhs, lens::mlir_builder().getDenseI32ArrayAttr(mask)
+            );
+        }
+
         template< typename Op >
         operation ExprTypeTrait(const clang::UnaryExprOrTypeTraitExpr *expr, auto rty, auto loc) {
             auto arg = make_value_builder(expr->getArgumentExpr());
@@ -1095,7 +1695,8 @@ namespace vast::cg {
         operation VisitInitListExpr(const clang::InitListExpr *expr) {
             auto ty = visit(expr->getType());
 
-            llvm::SmallVector< Value > elements;
+            arena_vector< Value > elements(context().arena);
+            elements.reserve(expr->getNumInits());
             for (auto elem : expr->inits()) {
                 elements.push_back(visit(elem)->getResult(0));
             }
@@ -106,17 +106,26 @@ namespace vast::cg {
                 .freeze();
         }
 
+        // Covers `ext_vector_type` vectors as well.
+        auto with_qualifiers(const clang::VectorType *ty, qualifiers quals) -> mlir_type {
+            auto element_type = visit(ty->getElementType());
+            return with_cvr_qualifiers(type_builder< hl::VectorType >()
+                .bind(std::uint64_t(ty->getNumElements()))
+                .bind(element_type), quals)
+                .freeze();
+        }
+
         auto make_name_attr(string_ref name) {
             return mlir::StringAttr::get(&mcontext(), name);
         }
 
         auto with_qualifiers(const clang::RecordType *ty, qualifiers quals) -> mlir_type {
-            auto name = make_name_attr( context().decl_name(ty->getDecl()) );
+            auto name = context().decl_name_attr(ty->getDecl());
             return with_cv_qualifiers( type_builder< hl::RecordType >().bind(name), quals ).freeze();
         }
 
         auto with_qualifiers(const clang::EnumType *ty, qualifiers quals) -> mlir_type {
-            auto name = make_name_attr( context().decl_name(ty->getDecl()) );
+            auto name = context().decl_name_attr(ty->getDecl());
             return with_cv_qualifiers( type_builder< hl::RecordType >().bind(name), quals ).freeze();
         }
 
@@ -186,6 +195,10 @@ namespace vast::cg {
                 return VisitArrayType(t, quals);
             }
 
+            if (auto t = llvm::dyn_cast< clang::VectorType >(underlying)) {
+                return VisitVectorType(t, quals);
+            }
+
             if (auto t = llvm::dyn_cast< clang::ElaboratedType >(underlying)) {
                 return VisitElaboratedType(t, quals);
             }
@@ -266,9 +279,10 @@ namespace vast::cg {
         }
 
         auto VisitCoreFunctionType(const clang::FunctionType *ty, bool variadic) -> core::FunctionType {
-            llvm::SmallVector< Type > args;
+            arena_vector< Type > args(context().arena);
 
             if (auto prototype = clang::dyn_cast< clang::FunctionProtoType >(ty)) {
+                args.reserve(prototype->getNumParams());
                 for (auto param : prototype->getParamTypes()) {
                     args.push_back(VisitLValueType(param));
                 }
@@ -335,6 +349,14 @@ namespace vast::cg {
             return VisitArrayType(ty, qualifiers());
         }
 
+        auto VisitVectorType(const clang::VectorType *ty, qualifiers quals) -> mlir_type {
+            return with_qualifiers(ty, quals);
+        }
+
+        auto VisitVectorType(const clang::VectorType *ty) -> mlir_type {
+            return VisitVectorType(ty, ty->desugar().getQualifiers());
+        }
+
         auto VisitRecordType(const clang::RecordType *ty, qualifiers quals) -> mlir_type {
             return with_qualifiers(ty, quals);
         }
@@ -367,6 +389,16 @@ namespace vast::cg {
             return VisitParenType(ty, ty->desugar().getQualifiers());
         }
 
+        // Atomicity is a property of the accesses, `_Atomic T` is `T` and its
+        // loads and stores are atomic operations.
+        auto VisitAtomicType(const clang::AtomicType *ty, qualifiers quals) -> mlir_type {
+            return visit(acontext().getQualifiedType(ty->getValueType(), quals));
+        }
+
+        auto VisitAtomicType(const clang::AtomicType *ty) -> mlir_type {
+            return VisitAtomicType(ty, ty->desugar().getQualifiers());
+        }
+
         auto VisitFunctionNoProtoType(const clang::FunctionNoProtoType *ty, qualifiers /* quals */) -> mlir_type {
             return VisitCoreFunctionType(ty, false /* variadic */ );
         }
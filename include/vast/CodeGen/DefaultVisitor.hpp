@@ -30,6 +30,12 @@ namespace vast::cg
         using stmt_visitor::Visit;
         using type_visitor::Visit;
         using attr_visitor::Visit;
+
+        // Implementations of clang visitors, which tell the fallback visitor
+        // the nodes that are not handled here.
+        using stmt_dispatch = default_stmt_visitor< derived_t >;
+        using decl_dispatch = default_decl_visitor< derived_t >;
+        using type_dispatch = default_type_visitor< derived_t >;
     };
 
 } // namespace vast::cg
@@ -0,0 +1,196 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/DeclVisitor.h>
+#include <clang/AST/StmtVisitor.h>
+#include <clang/AST/TypeVisitor.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/TypeList.hpp"
+
+#include <array>
+#include <type_traits>
+
+namespace vast::cg::dispatch
+{
+    //
+    // Compile-time dispatch tables of the fallback visitor chain.
+    //
+    // A visitor dispatching through a clang visitor yields null for nodes its
+    // implementation has no method for, as the clang defaults forward to the
+    // method of the parent node up to the root method that yields null. Such
+    // a visitor names its implementation, e.g., `using stmt_dispatch = ...`,
+    // and the tables tell for each node kind the first visitor of the chain
+    // that may yield, so the unsuccessful dispatches are not executed.
+    //
+    // Overloaded methods are assumed to be declared by the implementation,
+    // hence the tables are conservative.
+    //
+    namespace detail
+    {
+        template< typename member >
+        struct member_class;
+
+        template< typename R, typename C, typename ...args >
+        struct member_class< R (C::*)(args...) > { using type = C; };
+
+        template< typename R, typename C, typename ...args >
+        struct member_class< R (C::*)(args...) const > { using type = C; };
+
+        template< typename member >
+        using member_class_t = typename member_class< member >::type;
+
+    } // namespace detail
+
+    constexpr std::size_t stmt_kinds = clang::Stmt::lastStmtConstant + 1;
+    constexpr std::size_t decl_kinds = clang::Decl::lastDecl + 1;
+    constexpr std::size_t type_kinds = clang::Type::TypeLast + 1;
+
+    // Whether `impl` declares the method itself instead of inheriting the
+    // clang default from `base`.
+    #define VAST_DECLARES_VISIT(base, method) [] { \
+        if constexpr (requires { &impl::method; }) { \
+            return !std::is_same_v< detail::member_class_t< decltype(&impl::method) >, base >; \
+        } else { \
+            return true; \
+        } \
+    }()
+
+    template< typename impl >
+    struct stmt_table
+    {
+        using base = clang::StmtVisitorBase< llvm::make_const_ptr, impl, operation >;
+
+        static constexpr bool Stmt_handled = VAST_DECLARES_VISIT(base, VisitStmt);
+
+        #define ABSTRACT_STMT(STMT) STMT
+        #define STMT(CLASS, PARENT) \
+            static constexpr bool CLASS##_handled = VAST_DECLARES_VISIT(base, Visit##CLASS) || PARENT##_handled;
+        #include <clang/AST/StmtNodes.inc>
+
+        static constexpr auto handled = [] {
+            std::array< bool, stmt_kinds > table{};
+            #define ABSTRACT_STMT(STMT)
+            #define STMT(CLASS, PARENT) table[clang::Stmt::CLASS##Class] = CLASS##_handled;
+            #include <clang/AST/StmtNodes.inc>
+
+            // Operators are dispatched by their opcodes first.
+            table[clang::Stmt::BinaryOperatorClass]         = true;
+            table[clang::Stmt::CompoundAssignOperatorClass] = true;
+            table[clang::Stmt::UnaryOperatorClass]          = true;
+            return table;
+        }();
+    };
+
+    template< typename impl >
+    struct decl_table
+    {
+        using base = clang::declvisitor::Base< llvm::make_const_ptr, impl, operation >;
+
+        static constexpr bool Decl_handled = VAST_DECLARES_VISIT(base, VisitDecl);
+
+        #define ABSTRACT_DECL(DECL) DECL
+        #define DECL(DERIVED, BASE) \
+            static constexpr bool DERIVED##Decl_handled = VAST_DECLARES_VISIT(base, Visit##DERIVED##Decl) || BASE##_handled;
+        #include <clang/AST/DeclNodes.inc>
+
+        static constexpr auto handled = [] {
+            std::array< bool, decl_kinds > table{};
+            #define ABSTRACT_DECL(DECL)
+            #define DECL(DERIVED, BASE) table[clang::Decl::DERIVED] = DERIVED##Decl_handled;
+            #include <clang/AST/DeclNodes.inc>
+            return table;
+        }();
+    };
+
+    template< typename impl >
+    struct type_table
+    {
+        using base = clang::TypeVisitor< impl, mlir_type >;
+
+        static constexpr bool Type_handled = VAST_DECLARES_VISIT(base, VisitType);
+
+        #define ABSTRACT_TYPE(CLASS, PARENT) TYPE(CLASS, PARENT)
+        #define TYPE(CLASS, PARENT) \
+            static constexpr bool CLASS##Type_handled = VAST_DECLARES_VISIT(base, Visit##CLASS##Type) || PARENT##_handled;
+        #include <clang/AST/TypeNodes.inc>
+
+        static constexpr auto handled = [] {
+            std::array< bool, type_kinds > table{};
+            #define ABSTRACT_TYPE(CLASS, PARENT)
+            #define TYPE(CLASS, PARENT) table[clang::Type::CLASS] = CLASS##Type_handled;
+            #include <clang/AST/TypeNodes.inc>
+            return table;
+        }();
+    };
+
+    #undef VAST_DECLARES_VISIT
+
+    // Visitors without a table may yield for any node.
+    template< typename visitor >
+    constexpr bool may_yield(clang::Stmt::StmtClass kind) {
+        if constexpr (requires { typename visitor::stmt_dispatch; }) {
+            return stmt_table< typename visitor::stmt_dispatch >::handled[kind];
+        }
+        return true;
+    }
+
+    template< typename visitor >
+    constexpr bool may_yield(clang::Decl::Kind kind) {
+        if constexpr (requires { typename visitor::decl_dispatch; }) {
+            return decl_table< typename visitor::decl_dispatch >::handled[kind];
+        }
+        return true;
+    }
+
+    template< typename visitor >
+    constexpr bool may_yield(clang::Type::TypeClass kind) {
+        if constexpr (requires { typename visitor::type_dispatch; }) {
+            return type_table< typename visitor::type_dispatch >::handled[kind];
+        }
+        return true;
+    }
+
+    template< typename kind_t, std::size_t size, typename ...visitors >
+    constexpr auto make_first_visitors(util::type_list< visitors... >) {
+        std::array< unsigned, size > first{};
+        for (std::size_t kind = 0; kind < size; ++kind) {
+            unsigned idx = 0;
+            ((may_yield< visitors >(kind_t(kind)) || (++idx, false)) || ...);
+            first[kind] = idx;
+        }
+        return first;
+    }
+
+    //
+    // Index of the first visitor of the `visitors` list that may yield for
+    // the visited token, tokens without a table start at the first visitor.
+    //
+    template< typename visitors >
+    struct first_visitor
+    {
+        static constexpr auto stmts = make_first_visitors<
+            clang::Stmt::StmtClass, stmt_kinds
+        >(visitors{});
+
+        static constexpr auto decls = make_first_visitors<
+            clang::Decl::Kind, decl_kinds
+        >(visitors{});
+
+        static constexpr auto types = make_first_visitors<
+            clang::Type::TypeClass, type_kinds
+        >(visitors{});
+
+        static unsigned of(const clang::Stmt *stmt) { return stmts[stmt->getStmtClass()]; }
+        static unsigned of(const clang::Decl *decl) { return decls[decl->getKind()]; }
+        static unsigned of(const clang::Type *type) { return types[type->getTypeClass()]; }
+
+        static unsigned of(auto /* token */) { return 0; }
+    };
+
+} // namespace vast::cg::dispatch
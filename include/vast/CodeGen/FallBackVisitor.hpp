@@ -3,15 +3,33 @@
 #pragma once
 
 #include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Type.h>
+#include <llvm/ADT/DenseMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/FallBackDispatch.hpp"
+#include "vast/CodeGen/Profile.hpp"
+
+#include "vast/Util/MemoryLimit.hpp"
+#include "vast/Util/TimeBudget.hpp"
 #include "vast/Util/TypeList.hpp"
 
+#ifdef VAST_ENABLE_CODEGEN_STATS
+#include "vast/CodeGen/CodeGenStats.hpp"
+
+#include <optional>
+#endif
+
 namespace vast::cg
 {
     //
     // fallback_visitor
     //
     // Allows to specify chain of fallback visitors in case that first `visitor::Visit` is
-    // unsuccessful.
+    // unsuccessful. Visitors that cannot yield for a node, as told by the
+    // dispatch tables, are not tried.
     //
     template< typename derived_t, template< typename > typename ...visitors >
     struct fallback_visitor : visitors< derived_t >...
@@ -20,7 +38,18 @@ namespace vast::cg
         operation Visit(const clang::Decl *decl) { return visit_with_fallback(decl); }
         mlir_type Visit(const clang::Type *type) { return visit_with_fallback(type); }
         mlir_attr Visit(const clang::Attr *attr) { return visit_with_fallback(attr); }
-        mlir_type Visit(clang::QualType    type) { return visit_with_fallback(type); }
+        mlir_type Visit(clang::QualType type) {
+            if (auto cached = types.lookup(type)) {
+                return cached;
+            }
+
+            auto result = visit_with_fallback(type);
+            if (result && !is_forward_declared(type)) {
+                types[type] = result;
+            }
+
+            return result;
+        }
 
         using visitors_list = util::type_list< visitors< derived_t >... >;
 
@@ -28,9 +57,59 @@ namespace vast::cg
             using result_type = decltype(visitors_list::head::Visit(token));
 
             result_type result;
-            ((result = visitors< derived_t >::Visit(token)) || ... );
+            if (memory) {
+                memory->tick();
+            }
+            if (budget) {
+                budget->tick();
+            }
+
+            // Visitors before the first one that may yield are skipped.
+            const auto first = dispatch::first_visitor< visitors_list >::of(token);
+
+            unsigned layer = 0;
+            ((layer++ >= first && (result = visitors< derived_t >::Visit(token))) || ... );
+
+#ifdef VAST_ENABLE_CODEGEN_STATS
+            if (stats) {
+                // Visits that need any but the first visitor are fallbacks.
+                stats->visited(token, layer > 1);
+            }
+#endif
             return result;
         }
+
+        // Set if the memory budget is checked during codegen (-vast-memory-limit).
+        memory_limit *memory = nullptr;
+
+        // Set if the time of function codegen is limited (-vast-function-budget).
+        time_budget *budget = nullptr;
+
+        // Set if the function is in the instrumentation profile (-fprofile-instr-use).
+        const function_profile *profile = nullptr;
+
+        // Once the budget of the function is exceeded, compound statements
+        // skip their remaining statements, the body is stubbed afterwards.
+        bool out_of_budget() const { return budget && budget->exceeded(); }
+
+#ifdef VAST_ENABLE_CODEGEN_STATS
+        // Set if the statistics are collected (-vast-codegen-stats).
+        std::optional< codegen_stats > stats;
+#endif
+
+      private:
+        // Forward declared tags are visited again once they are complete,
+        // so that their completion is observed by the visitors.
+        static bool is_forward_declared(clang::QualType type) {
+            if (auto tag = type->getAsTagDecl()) {
+                return !tag->getDefinition();
+            }
+            return false;
+        }
+
+        // Converted types keyed by the exact (sugared and qualified) type, as
+        // typedefs and elaborations are preserved in the high-level types.
+        llvm::DenseMap< clang::QualType, mlir_type > types;
     };
 
 } // namespace vast::cg
@@ -0,0 +1,92 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/DeclGroup.h>
+#include <clang/Basic/LangOptions.h>
+#include <clang/Basic/SourceLocation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/CodeGenContext.hpp"
+
+#include "vast/Frontend/Options.hpp"
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Compression.hpp"
+#include "vast/Util/ContentHash.hpp"
+
+namespace vast::cg
+{
+    // Adds all language options to the key of a cache entry.
+    void add_language_options(content_hasher &hash, const clang::LangOptions &opts);
+
+    //
+    // Cache of the high-level declarations generated for the preamble of
+    // a translation unit, i.e., the top-level declarations that precede the
+    // first declaration of the main file, which usually come from the
+    // included headers. The fragment is stored as bytecode in a directory,
+    // keyed by a hash of the text that produced it: the contents and names
+    // of all files loaded so far, the predefines among them, the main file up
+    // to its first declaration, the language options, the target and the
+    // vast options. Translation units that include the same headers in the
+    // same configuration splice the stored fragment into their module instead
+    // of generating it again.
+    //
+    // Codegen state that refers to clang declarations is restored, once the
+    // fragment is spliced, by matching the declarations of the preamble with
+    // the operations of the fragment by their names, in the order in which
+    // they were generated. Declarations that have no generated counterpart
+    // are generated as usual.
+    //
+    // The cache supports only C. It is disabled together with the options
+    // that make the preamble depend on the rest of the translation unit
+    // (-vast-roots, -vast-system-headers-decls-only, -vast-lazy-function-bodies,
+    // -vast-stream-functions) and with locations that refer to module-level
+    // tables (-vast-locs=compact, -vast-locs-as-meta-ids).
+    //
+    struct header_cache
+    {
+        header_cache(string_ref dir, const cc::vast_args &vargs);
+
+        // Key of the preamble that ends at `end`, the whole main file is
+        // hashed if the location is invalid.
+        std::string key(const acontext_t &actx, clang::SourceLocation end) const;
+
+        // Returns null if there is no usable entry of the key.
+        owning_module_ref load(string_ref key, mcontext_t &mctx) const;
+
+        // Stores the module, which has to contain only the preamble, together
+        // with the data layout entries of the types it uses. Entries are
+        // written atomically, failures to write them are ignored.
+        void store(string_ref key, vast_module mod, const dl::DataLayoutBlueprint &dl) const;
+
+        // Moves the operations of the fragment to the end of the module and
+        // binds the declarations of the preamble to them. Returns top-level
+        // declarations that need to be generated.
+        std::vector< clang::Decl * > splice(
+            owning_module_ref fragment, codegen_context &cgctx,
+            llvm::ArrayRef< clang::DeclGroupRef > preamble
+        ) const;
+
+      private:
+        std::string entry_path(string_ref key) const;
+
+        std::string dir;
+
+        // vast options that affect codegen, serialized for the key
+        std::string flags;
+
+        // compression of the entries (-vast-bytecode-zstd)
+        util::bytecode_compression compression;
+    };
+
+    // Returns the cache of -vast-header-cache=<dir> if it supports the
+    // translation unit and the other options.
+    std::optional< header_cache > make_header_cache(
+        const codegen_context &cgctx, const cc::vast_args &vargs
+    );
+
+} // namespace vast::cg
@@ -0,0 +1,102 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Decl.h>
+#include <llvm/ADT/StringSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/CodeGenContext.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Frontend/Options.hpp"
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Compression.hpp"
+
+#include <optional>
+#include <string>
+
+namespace vast::cg
+{
+    //
+    // Cache of the bodies of implicit template instantiations, e.g., the
+    // members of `std::vector< int >` that every translation unit of
+    // a project instantiates. Entries are keyed by the mangled name of the
+    // instantiation and the odr hash of its template, together with a hash
+    // of the target, the language options and the vast options, and are
+    // shared by all translation units of the process (e.g., in batch mode).
+    // With a directory, they are also stored there as bytecode for later
+    // processes.
+    //
+    // An entry holds the definition, the declarations of the functions it
+    // refers to and the data layout entries of its types. It is spliced
+    // only if the translation unit agrees with it: the prototype and the
+    // callees have the same types, and the records, enums, typedefs and
+    // globals it names are declared by the module. Otherwise the
+    // instantiation is generated as usual.
+    //
+    // With `declarations_only`, the translation unit does not receive the
+    // body, the instantiation stays a declaration that the definition of
+    // the first unit resolves once the modules are linked into one program.
+    // Such entries are only kept in memory.
+    //
+    struct instantiation_cache
+    {
+        instantiation_cache(
+            std::optional< string_ref > dir, bool declarations_only,
+            const acontext_t &actx, const cc::vast_args &vargs
+        );
+
+        static bool is_cached(const clang::FunctionDecl *decl);
+
+        // Key of the instantiation, it changes with the definition of the
+        // template the instantiation is instantiated from.
+        std::string key(string_ref mangled, const clang::FunctionDecl *decl) const;
+
+        // Marks the instantiation as emitted, returns false if another
+        // translation unit has emitted it already.
+        bool claim(string_ref key) const;
+
+        // Returns null if there is no usable entry of the key.
+        owning_module_ref load(string_ref key, mcontext_t &mctx) const;
+
+        // Stores the definition, failures to store it are ignored.
+        void store(string_ref key, hl::FuncOp fn, codegen_context &cgctx) const;
+
+        // Moves the body of the cached definition to the prototype. Returns
+        // false, leaving the prototype and the module intact, if the entry
+        // does not fit the translation unit.
+        bool splice(owning_module_ref entry, hl::FuncOp fn, codegen_context &cgctx);
+
+        bool declarations_only;
+
+      private:
+        std::string entry_path(string_ref key) const;
+
+        // Collects names of the records, enums, typedefs and globals of the
+        // module, again once an entry names one that is not known yet.
+        void collect_declared(vast_module mod);
+
+        std::optional< std::string > dir;
+
+        // compression of the entries of the directory (-vast-bytecode-zstd)
+        util::bytecode_compression compression;
+
+        // hash of the configuration, the prefix of all keys
+        std::string config;
+
+        llvm::StringSet<> declared;
+    };
+
+    // Returns the cache of -vast-instantiation-cache[=<dir>] if it supports
+    // the translation unit and the other options.
+    std::optional< instantiation_cache > make_instantiation_cache(
+        const codegen_context &cgctx, const cc::action_options &opts, const cc::vast_args &vargs
+    );
+
+} // namespace vast::cg
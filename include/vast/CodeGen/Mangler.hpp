@@ -8,24 +8,36 @@ VAST_RELAX_WARNINGS
 #include <clang/AST/GlobalDecl.h>
 #include <clang/AST/Mangle.h>
 #include <clang/Basic/TargetInfo.h>
-#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/MapVector.h>
-#include <llvm/Support/Allocator.h>
+#include <mlir/IR/BuiltinAttributes.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
 
 namespace vast::cg
 {
+    //
+    // Mangled names are interned once in the mlir context as the symbol
+    // names of the emitted operations. Names are then compared and hashed by
+    // their pointers, and operations are built with the interned attribute.
+    //
     struct mangled_name_ref {
-        using value_type = string_ref;
+        using value_type = mlir::StringAttr;
 
-        value_type name;
+        value_type symbol;
+
+        string_ref name() const { return symbol.getValue(); }
+
+        friend bool operator==(const mangled_name_ref &a, const mangled_name_ref &b) {
+            return a.symbol == b.symbol;
+        }
 
         friend std::strong_ordering operator<=>(const mangled_name_ref &a, const mangled_name_ref &b) {
-            return a.name == b.name ? std::strong_ordering::equal :
-                   a.name < b.name  ? std::strong_ordering::less
-                                    : std::strong_ordering::greater;
+            if (a.symbol == b.symbol) {
+                return std::strong_ordering::equal;
+            }
+            return a.name() < b.name() ? std::strong_ordering::less : std::strong_ordering::greater;
         }
     };
 } // namespace vast::cg
@@ -35,12 +47,12 @@ namespace llvm {
 
     [[nodiscard]] hash_code hash_value(vast::cg::mangled_name_ref mangled);
 
-    // Provide DenseMapInfo for mangled_name_refs
+    // Provide DenseMapInfo for mangled_name_refs, keyed by the interned symbol
     template<>
     struct DenseMapInfo< vast::cg::mangled_name_ref, void > {
         using info_type  = vast::cg::mangled_name_ref;
         using value_type = info_type::value_type;
-        using base = DenseMapInfo< value_type, void >;
+        using base = DenseMapInfo< value_type >;
 
         static inline info_type getEmptyKey() {
             return { base::getEmptyKey() };
@@ -51,11 +63,11 @@ namespace llvm {
         }
 
         static unsigned getHashValue(info_type val) {
-            return base::getHashValue(val.name);
+            return base::getHashValue(val.symbol);
         }
 
         static bool isEqual(info_type lhs, info_type rhs) {
-            return base::isEqual(lhs.name, rhs.name);
+            return lhs.symbol == rhs.symbol;
         }
     };
 } // namespace llvm
@@ -64,14 +76,22 @@ namespace vast::cg
 {
     struct CodeGenMangler {
 
-        explicit CodeGenMangler(clang::MangleContext *mangle_context)
-            : mangle_context(mangle_context)
+        CodeGenMangler(mcontext_t &mctx, clang::MangleContext *mangle_context)
+            : mctx(mctx), mangle_context(mangle_context)
         {}
 
+        // Declarations are mangled once, later requests of the same canonical
+        // declaration return the interned name.
         mangled_name_ref get_mangled_name(
             clang::GlobalDecl decl, const clang::TargetInfo &target_info, const std::string &module_name_hash
         );
 
+        // Interns a symbol name that does not come from a declaration, e.g.,
+        // the name of a symbol use.
+        mangled_name_ref intern(string_ref name) const {
+            return { mlir::StringAttr::get(&mctx, name) };
+        }
+
         std::optional< clang::GlobalDecl >  lookup_representative_decl(mangled_name_ref name) const;
 
       private:
@@ -79,11 +99,13 @@ namespace vast::cg
             clang::GlobalDecl decl, const std::string &module_name_hash
         ) const;
 
+        mcontext_t &mctx;
         std::unique_ptr< clang::MangleContext > mangle_context;
 
         // An ordered map of canonical GlobalDecls to their mangled names.
         llvm::MapVector< clang::GlobalDecl, mangled_name_ref > mangled_decl_names;
-        llvm::StringMap< clang::GlobalDecl, llvm::BumpPtrAllocator > manglings;
+        // The first declaration of each mangled name.
+        llvm::DenseMap< mangled_name_ref, clang::GlobalDecl > manglings;
     };
 
 } // namespace vast::cg
@@ -0,0 +1,81 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Decl.h>
+#include <clang/AST/Stmt.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/VirtualFileSystem.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vast::cg
+{
+    //
+    // Counts of a single function of the profile, with the weights of its
+    // branches derived from the counters of the statements.
+    //
+    struct function_profile
+    {
+        std::uint64_t entry_count = 0;
+        bool hot = false;
+
+        // Weights of the taken and the not taken branch of `if` statements
+        // and of the conditions of `while` and `for` loops, scaled to 32 bits.
+        llvm::DenseMap< const clang::Stmt *, std::pair< std::uint32_t, std::uint32_t > > branches;
+    };
+
+    //
+    // Profile of clang instrumentation (-fprofile-instr-use=<file>). Records
+    // are matched by the name clang gives to the function in the profile,
+    // which prefixes functions with internal linkage by the main file name.
+    //
+    // Counters of a function are numbered in the order clang assigns them,
+    // the function body first and then the statements that start a region
+    // in the pre-order of the AST. The hash of the function is not
+    // recomputed, a record whose number of counters differs from the
+    // function is considered out of date and ignored.
+    //
+    // Counts of the branches are derived from the counters as clang does,
+    // except that exits by `break`, `return` and `goto` are not subtracted,
+    // so loop conditions are assumed to fail once per entry of the loop.
+    //
+    // IR-level profiles (-fprofile-generate) are left to the llvm backend,
+    // which reads them through the codegen options.
+    //
+    struct instr_profile
+    {
+        static std::optional< instr_profile > open(
+            string_ref path, llvm::vfs::FileSystem &fs, std::string &error
+        );
+
+        // Profile of the function named `name` by the mangler, none if it was
+        // not profiled or its record is out of date.
+        std::optional< function_profile > of(
+            const clang::FunctionDecl *decl, string_ref name, string_ref main_file
+        ) const;
+
+        bool is_ir_level() const { return ir_level; }
+
+      private:
+        // Counts by the name of the function, names with several records are
+        // ambiguous and left out.
+        llvm::StringMap< std::vector< std::uint64_t > > records;
+
+        // Functions entered at least this many times are hot.
+        std::uint64_t hot_threshold = 0;
+
+        std::uint64_t version = 0;
+        bool ir_level = false;
+    };
+
+} // namespace vast::cg
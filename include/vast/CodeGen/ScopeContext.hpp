@@ -4,6 +4,11 @@
 
 #include "vast/Util/Warnings.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ScopedHashTable.h>
+#include <llvm/Support/Allocator.h>
+VAST_UNRELAX_WARNINGS
+
 #include <gap/core/generator.hpp>
 
 #include <functional>
@@ -11,12 +16,25 @@
 
 namespace vast::cg
 {
+    // Symbol entries are allocated from an arena owned by the table, instead
+    // of a heap allocation per declared symbol that is freed when its scope
+    // is left. Entries are released together with the table.
+    template< typename From, typename To >
+    using scoped_table_base = llvm::ScopedHashTable<
+        From, To, llvm::DenseMapInfo< From >, llvm::BumpPtrAllocator
+    >;
+
+    template< typename From, typename To >
+    using scoped_table_scope = llvm::ScopedHashTableScope<
+        From, To, llvm::DenseMapInfo< From >, llvm::BumpPtrAllocator
+    >;
+
     template< typename From, typename To >
-    struct scoped_table : llvm::ScopedHashTable< From, To >
+    struct scoped_table : scoped_table_base< From, To >
     {
         using value_type = To;
 
-        using base = llvm::ScopedHashTable< From, To >;
+        using base = scoped_table_base< From, To >;
         using base::base;
 
         using base::count;
@@ -19,6 +19,54 @@
 
 namespace vast::cg {
 
+    namespace detail {
+
+        // Types of the values referenced in the subtree, every value once.
+        inline void referenced_types(
+            const clang::Stmt *stmt,
+            llvm::SmallPtrSetImpl< const clang::ValueDecl * > &seen,
+            std::vector< clang::QualType > &types
+        ) {
+            if (!stmt) {
+                return;
+            }
+
+            if (auto ref = mlir::dyn_cast< clang::DeclRefExpr >(stmt)) {
+                if (seen.insert(ref->getDecl()).second) {
+                    types.push_back(ref->getDecl()->getType());
+                }
+            }
+
+            for (auto child : stmt->children()) {
+                referenced_types(child, seen, types);
+            }
+        }
+
+        // Attributes of a summarized subtree (-vast-unsupported=summary): its
+        // source range and the types of the values it references.
+        void attach_summary(operation op, clang::SourceRange range, const clang::Stmt *body, auto &visitor) {
+            auto &actx = visitor.acontext();
+            auto &mctx = visitor.mcontext();
+            op->setAttr("range", mlir::StringAttr::get(
+                &mctx, range.printToString(actx.getSourceManager())
+            ));
+
+            llvm::SmallPtrSet< const clang::ValueDecl *, 8 > seen;
+            std::vector< clang::QualType > types;
+            referenced_types(body, seen, types);
+            if (types.empty()) {
+                return;
+            }
+
+            llvm::SmallVector< mlir_attr > attrs;
+            for (auto type : types) {
+                attrs.push_back(mlir::TypeAttr::get(visitor.visit(type)));
+            }
+            op->setAttr("referenced", mlir::ArrayAttr::get(&mctx, attrs));
+        }
+
+    } // namespace detail
+
     template< typename derived_t >
     struct unsup_stmt_visitor
         : stmt_visitor_base< derived_t >
@@ -27,11 +75,41 @@ namespace vast::cg {
         using lens = visitor_lens< derived_t, unsup_stmt_visitor >;
 
         using lens::derived;
+        using lens::context;
+        using lens::mcontext;
+        using lens::acontext;
         using lens::visit;
 
         using lens::meta_location;
 
         operation make_unsupported_stmt(auto stmt, mlir_type type = {}) {
+            switch (context().unsupported) {
+                case unsupported_mode::full:
+                    return make_full_stmt(stmt, type);
+                case unsupported_mode::summary: {
+                    auto op = make_leaf_stmt(stmt, type);
+                    detail::attach_summary(op, stmt->getSourceRange(), stmt, *this);
+                    return op;
+                }
+                case unsupported_mode::drop:
+                    return make_leaf_stmt(stmt, type);
+            }
+
+            VAST_UNREACHABLE("unknown unsupported mode");
+        }
+
+        // Unsupported subtree without its children, values it yields are
+        // still defined for the users of the subtree.
+        operation make_leaf_stmt(auto stmt, mlir_type type) {
+            return this->template make_operation< unsup::UnsupportedStmt >()
+                .bind(meta_location(stmt))
+                .bind(stmt->getStmtClassName())
+                .bind(type)
+                .bind(std::vector< BuilderCallBackFn >{})
+                .freeze();
+        }
+
+        operation make_full_stmt(auto stmt, mlir_type type) {
             std::vector< BuilderCallBackFn > children;
             for (auto ch : stmt->children()) {
                 // For each subexpression, the unsupported operation holds a region.
@@ -67,6 +145,8 @@ namespace vast::cg {
 
         using lens::derived;
         using lens::context;
+        using lens::mcontext;
+        using lens::acontext;
         using lens::visit;
 
         using lens::make_operation;
@@ -113,10 +193,23 @@ namespace vast::cg {
         }
 
         operation make_unsupported_decl(auto decl) {
+            if (context().unsupported == unsupported_mode::drop) {
+                return this->template make_operation< unsup::UnsupportedDecl >()
+                    .bind(meta_location(decl))      // location
+                    .bind(decl->getDeclKindName())  // name
+                    .freeze();
+            }
+
             auto op = this->template make_operation< unsup::UnsupportedDecl >()
                 .bind(meta_location(decl)) // location
                 .bind(decl_name(decl));    // name
 
+            if (context().unsupported == unsupported_mode::summary) {
+                auto summary = op.freeze();
+                detail::attach_summary(summary, decl->getSourceRange(), decl->getBody(), *this);
+                return summary;
+            }
+
             if (auto callback = make_body_callback(decl)) {
                 return std::move(op).bind(callback.value()).freeze(); // body
             }
@@ -126,7 +219,7 @@ namespace vast::cg {
 
         operation Visit(const clang::Decl *decl) {
             if (auto op = make_unsupported_decl(decl)) {
-                if (decl->hasAttrs()) {
+                if (decl->hasAttrs() && context().unsupported != unsupported_mode::drop) {
                     mlir::NamedAttrList attrs = op->getAttrs();
                     for (auto attr : decl->getAttrs()) {
                         attrs.append(attr->getSpelling(), visit(attr));
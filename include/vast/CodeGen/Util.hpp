@@ -9,28 +9,28 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/BuiltinOps.h>
 #include <mlir/IR/Region.h>
 #include <clang/AST/Attr.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Support/Casting.h>
 VAST_UNRELAX_WARNINGS
 
-#include <gap/core/generator.hpp>
-
 #include <vast/Util/TypeList.hpp>
 
 namespace vast::cg
 {
+    // Filters are lazy ranges rather than generators, which would allocate
+    // a coroutine frame on every visit of a declaration.
     template< typename T >
-    gap::generator< T * > filter(auto from) {
-        for (auto x : from) {
-            if (auto s = dyn_cast< T >(x))
-                co_yield s;
-        }
+    auto filter(auto &&from) {
+        return llvm::map_range(
+            llvm::make_filter_range(from, [] (auto x) { return llvm::isa< T >(x); }),
+            [] (auto x) { return llvm::cast< T >(x); }
+        );
     }
 
     template< typename list >
-    gap::generator< clang::Attr * > exclude_attrs(auto from) {
-        for (auto attr : from) {
-            if (!util::is_one_of< list >(attr)) {
-                co_yield attr;
-            }
-        }
+    auto exclude_attrs(auto &&from) {
+        return llvm::make_filter_range(from, [] (auto attr) {
+            return !util::is_one_of< list >(attr);
+        });
     }
 } // namespace vast::cg
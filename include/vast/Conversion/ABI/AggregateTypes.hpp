@@ -116,7 +116,6 @@ namespace vast::conv::abi
         };
 
         state_t &state;
-        vast_module mod;
         std::vector< mlir::Value > partials;
 
 
@@ -125,7 +124,7 @@ namespace vast::conv::abi
             auto handle_type = [&](mlir_type field_type) -> mlir::Value
             {
                 if (needs_nesting(field_type))
-                    return self_t(state, mod).run_on(field_type, rewriter);
+                    return self_t(state).run_on(field_type, rewriter);
 
                 state.adjust_by_align(field_type);
 
@@ -134,7 +133,7 @@ namespace vast::conv::abi
                 return state.allocate(field_type, rewriter);
             };
 
-            for (auto field_type : vast::hl::field_types(root_type, mod))
+            for (auto field_type : state.parent.layouts.members_of(root_type).field_types())
                 partials.push_back(handle_type(field_type));
 
             // Make the thing;
@@ -151,9 +150,8 @@ namespace vast::conv::abi
 
       public:
 
-        aggregate_reconstructor(state_t &state, vast_module mod)
-            : state(state),
-              mod(mod)
+        explicit aggregate_reconstructor(state_t &state)
+            : state(state)
         {}
 
         static state_t mk_state(const pattern &parent, op_t abi_op)
@@ -266,7 +264,6 @@ namespace vast::conv::abi
         };
 
         state_t &state;
-        vast_module mod;
         std::vector< mlir::Value > partials;
 
         bool needs_nesting(mlir_type type) const
@@ -280,7 +277,7 @@ namespace vast::conv::abi
             {
                 auto field_type = gep.getType();
                 if (needs_nesting(field_type))
-                    return self_t(state, mod).run_on(gep.getOperation(), rewriter);
+                    return self_t(state).run_on(gep.getOperation(), rewriter);
 
                 auto rvalue = hl::implicit_cast_lvalue_to_rvalue(rewriter, gep.getLoc(), gep);
                 state.adjust_by_align(rewriter, gep.getLoc(), rvalue.getType());
@@ -289,14 +286,14 @@ namespace vast::conv::abi
             };
 
             auto loc = root->getLoc();
-            for (auto field_gep : hl::generate_ptrs_to_record_members(root, loc, rewriter))
+            auto &layouts = state.parent.layouts;
+            for (auto field_gep : hl::generate_ptrs_to_record_members(root, loc, rewriter, layouts))
                 handle_field(field_gep);
         }
 
       public:
-        aggregate_deconstructor(state_t &state, vast_module mod)
-            : state(state),
-              mod(mod)
+        explicit aggregate_deconstructor(state_t &state)
+            : state(state)
         {}
 
         auto run(operation root, auto &rewriter) &&
@@ -326,10 +323,7 @@ namespace vast::conv::abi
     {
         using deconstructor_t = aggregate_deconstructor< pattern_t, abi_op_t >;
         auto state = deconstructor_t::mk_state(pattern, op);
-
-        auto module_op = op->template getParentOfType< vast_module >();
-        VAST_ASSERT(module_op);
-        return deconstructor_t(state, module_op).run(value, rewriter);
+        return deconstructor_t(state).run(value, rewriter);
     }
 
     // TODO(conv:abi): This is currently probably too restrained - figure out
@@ -343,10 +337,7 @@ namespace vast::conv::abi
     {
         using reconstructor_t = aggregate_reconstructor< pattern_t, abi_op_t >;
         auto state = reconstructor_t::mk_state(pattern, op);
-
-        auto module_op = op->template getParentOfType< vast_module >();
-        VAST_ASSERT(module_op);
-        return reconstructor_t(state, module_op).run(record_type, rewriter);
+        return reconstructor_t(state).run(record_type, rewriter);
     }
 
 } // namespace vast::conv::abi
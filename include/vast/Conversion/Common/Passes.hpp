@@ -5,12 +5,17 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
 #include "mlir/Transforms/DialectConversion.h"
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
 #include "vast/Conversion/Common/Types.hpp"
 #include "vast/Conversion/Common/Patterns.hpp"
+#include "vast/Conversion/Common/TBAA.hpp"
+
+#include "vast/Util/PatternStats.hpp"
 
 namespace vast {
 
@@ -76,6 +81,10 @@ namespace vast {
     // Aside from populating collection of patterns, this method also calls `legalize` method
     // of every pattern being added.
     //
+    // Neither of the methods may depend on the converted module. The target and
+    // the patterns are computed once in `initialize` and reused by every run of
+    // the pass.
+    //
     // Example usage:
     //
     // struct ExamplePass : ModuleConversionPassMixin< ExamplePass, ExamplePassBase > {
@@ -126,14 +135,26 @@ namespace vast {
         // Override
         void populate_conversions(config_t &){}
 
-        void run_on_operation() {
-            auto &ctx   = getContext();
-            auto config = config_t { rewrite_pattern_set(&ctx),
-                                     derived_t::create_conversion_target(ctx) };
+        // Shared by clones of the pass, as the target is not modified after
+        // initialization.
+        std::shared_ptr< const conversion_target > frozen_target;
+        mlir::FrozenRewritePatternSet frozen_patterns;
+
+        logical_result initialize(mcontext_t *ctx) override {
+            auto config = config_t { rewrite_pattern_set(ctx),
+                                     derived_t::create_conversion_target(*ctx) };
 
             self().populate_conversions(config);
+            count_pattern_applications(config.patterns, this->getArgument());
 
-            if (failed(populate::apply_conversions(std::move(config))))
+            frozen_target   = std::make_shared< const conversion_target >(std::move(config.target));
+            frozen_patterns = mlir::FrozenRewritePatternSet(std::move(config.patterns));
+            return mlir::success();
+        }
+
+        void run_on_operation() {
+            VAST_ASSERT(frozen_target);
+            if (failed(mlir::applyPartialConversion(getOperation(), *frozen_target, frozen_patterns)))
                 return signalPassFailure();
 
             this->after_operation();
@@ -191,18 +212,28 @@ namespace vast {
             conversion_target target;
             // Type converter cannot be moved!
             llvm_type_converter &tc;
+            // Symbol tables of the converted module, built before the
+            // conversion starts.
+            mlir::SymbolTableCollection &symbol_tables;
+            // Alias analysis tags of memory accesses, null if disabled.
+            conv::tbaa_tags *tbaa;
 
             mcontext_t *getContext() { return patterns.getContext(); }
 
             config(
-                rewrite_pattern_set patterns, conversion_target target, llvm_type_converter &tc
+                rewrite_pattern_set patterns, conversion_target target, llvm_type_converter &tc,
+                mlir::SymbolTableCollection &symbol_tables, conv::tbaa_tags *tbaa
             )
-                : patterns(std::move(patterns)), target(std::move(target)), tc(tc) {}
+                : patterns(std::move(patterns)), target(std::move(target)), tc(tc)
+                , symbol_tables(symbol_tables), tbaa(tbaa)
+            {}
 
             config(config &&other)
                 : patterns(std::move(other.patterns))
                 , target(std::move(other.target))
                 , tc(other.tc)
+                , symbol_tables(other.symbol_tables)
+                , tbaa(other.tbaa)
             {}
         };
 
@@ -211,9 +242,26 @@ namespace vast {
         // Override
         void populate_conversions(config &){}
 
+        // Override to attach alias analysis tags to memory accesses.
+        bool emit_tbaa_tags() const { return false; }
+
         template< typename pattern >
         static void add_pattern(config &cfg) {
-            cfg.patterns.template add< pattern >(cfg.tc);
+            if constexpr (std::is_constructible_v<
+                pattern, llvm_type_converter &, mlir::SymbolTableCollection &
+            >) {
+                cfg.patterns.template add< pattern >(cfg.tc, cfg.symbol_tables);
+            } else if constexpr (std::is_constructible_v<
+                pattern, llvm_type_converter &, conv::tbaa_tags *
+            >) {
+                cfg.patterns.template add< pattern >(cfg.tc, cfg.tbaa);
+            } else if constexpr (std::is_constructible_v<
+                pattern, llvm_type_converter &, mcontext_t *
+            >) {
+                cfg.patterns.template add< pattern >(cfg.tc, cfg.getContext());
+            } else {
+                cfg.patterns.template add< pattern >(cfg.tc);
+            }
         }
 
         void run_on_operation() {
@@ -224,17 +272,38 @@ namespace vast {
             derived_t::set_llvm_opts(llvm_options);
 
             auto tc = llvm_type_converter(getOperation(), &ctx, llvm_options, &dl_analysis);
+
+            // Conversion replaces symbols of the module, hence the tables are
+            // populated with the original operations ahead of time. Erasure of
+            // replaced operations is postponed until the conversion finishes.
+            mlir::SymbolTableCollection symbol_tables;
+            getOperation()->walk([&] (operation op) {
+                if (op->hasTrait< mlir::OpTrait::SymbolTable >())
+                    symbol_tables.getSymbolTable(op);
+            });
+
+            std::optional< conv::tbaa_tags > tbaa;
+            if (self().emit_tbaa_tags())
+                tbaa.emplace(&ctx);
+
             auto cfg = config(
-                rewrite_pattern_set(&ctx), derived_t::create_conversion_target(ctx, tc), tc
+                rewrite_pattern_set(&ctx), derived_t::create_conversion_target(ctx, tc), tc,
+                symbol_tables, tbaa ? &*tbaa : nullptr
             );
 
             // populate all patterns
             self().populate_conversions(cfg);
+            count_pattern_applications(cfg.patterns, this->getArgument());
 
             if (failed(populate::apply_conversions(std::move(cfg))))
                 return signalPassFailure();
+
+            this->after_operation();
         }
 
         void runOnOperation() override { run_on_operation(); }
+
+        // Runs only if the conversion was successful.
+        virtual void after_operation() {};
     };
 }
@@ -0,0 +1,108 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMAttrs.h>
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/Dialect/LLVMIR/LLVMTypes.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::conv
+{
+    //
+    // Type based alias analysis tags of scalar accesses, the tree mirrors the
+    // one clang emits:
+    //
+    //   root
+    //    `- omnipotent char
+    //        |- _Bool, int<width>, float<width>
+    //        `- any pointer
+    //
+    // Accessed types are already lowered to llvm types, which do not keep
+    // signedness nor the source name of integer types. Distinct C types of
+    // the same width therefore share their node, which is conservative, as C
+    // allows signed and unsigned variants of a type to alias. Accesses of
+    // 8-bit integers are char accesses and may alias anything. Aggregates are
+    // not tagged.
+    //
+    struct tbaa_tags
+    {
+        using type_descriptor = mlir::LLVM::TBAATypeDescriptorAttr;
+
+        explicit tbaa_tags(mcontext_t *mctx)
+            : mctx(mctx)
+            , root(mlir::LLVM::TBAARootAttr::get(mctx, mlir::StringAttr::get(mctx, "vast tbaa")))
+            , omnipotent_char(child("omnipotent char", root))
+        {}
+
+        // Tag of an access of a value of the `type`, null if the access may
+        // alias any other access.
+        mlir::LLVM::TBAATagAttr tag(mlir_type type) {
+            if (auto it = tags.find(type); it != tags.end()) {
+                return it->second;
+            }
+
+            mlir::LLVM::TBAATagAttr result;
+            if (auto node = descriptor(type)) {
+                result = mlir::LLVM::TBAATagAttr::get(node, node, 0);
+            }
+
+            return tags[type] = result;
+        }
+
+        void attach(auto access, mlir_type type) {
+            if (auto t = tag(type)) {
+                access.setTbaaAttr(mlir::ArrayAttr::get(mctx, { t }));
+            }
+        }
+
+      private:
+        type_descriptor child(string_ref name, mlir::LLVM::TBAANodeAttr parent) {
+            return type_descriptor::get(mctx, name, { mlir::LLVM::TBAAMemberAttr::get(parent, 0) });
+        }
+
+        type_descriptor scalar(const std::string &name) {
+            auto &node = scalars[name];
+            if (!node) {
+                node = child(name, omnipotent_char);
+            }
+            return node;
+        }
+
+        type_descriptor descriptor(mlir_type type) {
+            if (auto int_type = mlir::dyn_cast< mlir::IntegerType >(type)) {
+                auto width = int_type.getWidth();
+                if (width == 8) {
+                    return omnipotent_char;
+                }
+                return width == 1 ? scalar("_Bool") : scalar("int" + std::to_string(width));
+            }
+
+            if (auto float_type = mlir::dyn_cast< mlir::FloatType >(type)) {
+                return scalar("float" + std::to_string(float_type.getWidth()));
+            }
+
+            if (mlir::isa< mlir::LLVM::LLVMPointerType >(type)) {
+                return scalar("any pointer");
+            }
+
+            return {};
+        }
+
+        mcontext_t *mctx;
+
+        mlir::LLVM::TBAARootAttr root;
+        type_descriptor omnipotent_char;
+
+        llvm::StringMap< type_descriptor > scalars;
+        llvm::DenseMap< mlir_type, mlir::LLVM::TBAATagAttr > tags;
+    };
+
+} // namespace vast::conv
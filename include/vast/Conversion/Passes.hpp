@@ -57,6 +57,8 @@ namespace vast
 
     std::unique_ptr< mlir::Pass > createHLToLLFuncPass();
 
+    std::unique_ptr< mlir::Pass > createHLToLLPass();
+
     // Generate the code for registering passes.
     #define GEN_PASS_REGISTRATION
     #include "vast/Conversion/Passes.h.inc"
@@ -173,6 +173,7 @@ namespace vast::conv::tc {
 
             // Use provided data layout to get the correct type.
             addConversion([&](hl::ArrayType t) { return this->convert_arr_type(t); });
+            addConversion([&](hl::VectorType t) { return this->convert_vector_type(t); });
             addConversion([&](hl::VoidType t) -> maybe_type_t {
                 return { mlir::NoneType::get(&mctx) };
             });
@@ -265,5 +266,12 @@ namespace vast::conv::tc {
                 .and_then([&](auto t) { return mlir::MemRefType::get({ coerced_dim }, *t); })
                 .take_wrapped< maybe_type_t >();
         }
+
+        maybe_type_t convert_vector_type(hl::VectorType vec) {
+            auto size = std::int64_t(vec.getSize());
+            return Maybe(convert_type_to_type(vec.getElementType()))
+                .and_then([&](auto t) { return mlir::VectorType::get({ size }, *t); })
+                .take_wrapped< maybe_type_t >();
+        }
     };
 } // namespace vast::conv::tc
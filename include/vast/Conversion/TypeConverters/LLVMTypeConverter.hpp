@@ -188,6 +188,19 @@ namespace vast::conv::tc {
             return { std::move(out) };
         }
 
+        struct struct_body
+        {
+            types_t members;
+            bool packed = false;
+        };
+
+        std::optional< struct_body > convert_body(mlir_type t) {
+            if (auto fields = convert_field_types(t)) {
+                return struct_body{ std::move(*fields), false };
+            }
+            return std::nullopt;
+        }
+
         template< typename op_t >
         auto convert_recordlike() {
             // We need this prototype to handle recursive types.
@@ -199,9 +212,9 @@ namespace vast::conv::tc {
                 auto bt = stack.drop_back();
 
                 if (core.isOpaque() && std::ranges::find(bt, t) == bt.end()) {
-                    if (auto body = convert_field_types(t)) {
+                    if (auto body = self().convert_body(t)) {
                         // Multithreading may cause some issues?
-                        [[maybe_unused]] auto status = core.setBody(*body, false);
+                        [[maybe_unused]] auto status = core.setBody(body->members, body->packed);
                         VAST_ASSERT(mlir::succeeded(status));
                     }
                 }
@@ -219,20 +232,23 @@ namespace vast::conv::tc {
         using base = LLVMTypeConverter;
 
         vast_module mod;
+        hl::record_index records;
+        hl::record_layout_cache layouts;
 
         template< typename... Args >
         FullLLVMTypeConverter(vast_module mod,
                               Args &&...args)
         : base(std::forward< Args >(args)...),
-          mod(mod) {
+          mod(mod), records(mod),
+          layouts(mod, base::getDataLayoutAnalysis()->getAtOrAbove(mod)) {
             addConversion([&](hl::ElaboratedType t) { return convert_elaborated_type(t); });
             addConversion(convert_recordlike< hl::RecordType >());
         }
 
-        auto get_field_types(mlir_type t) -> std::optional< gap::generator< mlir_type > > {
+        auto get_field_types(mlir_type t) -> std::optional< hl::field_type_range > {
             if (!mlir::isa< hl::RecordType >(t))
                 return {};
-            auto def = hl::definition_of(t, mod);
+            auto def = records.definition_of(t);
             // Nothing found, leave the structure opaque.
             if (!def) {
                 return {};
@@ -240,6 +256,33 @@ namespace vast::conv::tc {
             return { hl::field_types(*def) };
         }
 
+        // Records with bitfields are lowered to the members of their layout,
+        // where runs of bitfields share integer storage units.
+        std::optional< struct_body > convert_body(mlir_type t) {
+            if (!mlir::isa< hl::RecordType >(t) || !records.definition_of(t)) {
+                return std::nullopt;
+            }
+
+            auto layout = layouts.bitfield_layout_of(t);
+            if (!layout) {
+                return LLVMStruct::convert_body(t);
+            }
+
+            auto i8 = mlir::IntegerType::get(t.getContext(), 8);
+
+            struct_body body{ {}, layout->packed };
+            for (const auto &member : layout->members) {
+                if (member.as_bytes) {
+                    body.members.push_back(LLVM::LLVMArrayType::get(i8, member.size / 8));
+                } else if (auto converted = convert_type_to_type(member.type)) {
+                    body.members.push_back(*converted);
+                } else {
+                    return std::nullopt;
+                }
+            }
+            return body;
+        }
+
         maybe_type_t convert_elaborated_type(hl::ElaboratedType t) {
             return this->convert_type_to_type(t.getElementType());
         }
@@ -8,6 +8,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/BuiltinDialect.h>
 #include <mlir/IR/Types.h>
 #include <mlir/Transforms/DialectConversion.h>
+#include <llvm/ADT/DenseMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Core/CoreTypes.hpp"
@@ -17,6 +18,8 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Util/DataLayout.hpp"
 #include "vast/Util/Maybe.hpp"
 
+#include <shared_mutex>
+
 namespace vast::conv::tc {
     using signature_conversion_t       = mlir::TypeConverter::SignatureConversion;
     using maybe_signature_conversion_t = std::optional< signature_conversion_t >;
@@ -60,6 +63,25 @@ namespace vast::conv::tc {
         return true;
     }
 
+    //
+    // Memo table of successful type conversions. Converters are created for a
+    // single pass run on a module, so the table is dropped together with the
+    // module state. Lookups are synchronized, as patterns may be applied to
+    // functions in parallel. Hits and misses are reported as statistics of
+    // `vast-type-conversion`.
+    //
+    struct conversion_cache
+    {
+        maybe_types_t lookup(mlir_type type) const;
+        void insert(mlir_type type, const types_t &converted);
+
+        void invalidate();
+
+      private:
+        mutable std::shared_mutex mutex;
+        llvm::DenseMap< mlir_type, types_t > entries;
+    };
+
     template< typename derived >
     struct mixins
     {
@@ -73,9 +95,21 @@ namespace vast::conv::tc {
             return [&](auto t) { return self().convert_type_to_type(t); };
         }
 
+        maybe_types_t convert_cached(mlir_type t) {
+            if (auto cached = conversions.lookup(t)) {
+                return cached;
+            }
+
+            auto converted = self().convert_type()(t);
+            if (converted) {
+                conversions.insert(t, *converted);
+            }
+            return converted;
+        }
+
         maybe_types_t convert_type_to_types(mlir_type t, std::size_t count = 1) {
             return Maybe(t)
-                .and_then(self().convert_type())
+                .and_then([&](auto t) { return convert_cached(t); })
                 .keep_if([&](const auto &ts) { return ts->size() == count; })
                 .template take_wrapped< maybe_types_t >();
         }
@@ -136,6 +170,8 @@ namespace vast::conv::tc {
         }
 
         mcontext_t &get_context() { return self().mctx; }
+
+        conversion_cache conversions;
     };
 
     // TODO(lukas): `rewriter.convertRegionTypes` should do the job, but it does not.
@@ -8,6 +8,7 @@
 #include "vast/Util/Common.hpp"
 
 #include <mlir/IR/FunctionInterfaces.h>
+#include <mlir/IR/PatternMatch.h>
 #include <mlir/Interfaces/CallInterfaces.h>
 #include <mlir/Interfaces/InferTypeOpInterface.h>
 
@@ -7,7 +7,9 @@
 VAST_RELAX_WARNINGS
 #include <mlir/IR/BuiltinDialect.h>
 #include <mlir/IR/FunctionInterfaces.h>
+#include <mlir/IR/PatternMatch.h>
 #include <mlir/Interfaces/InferTypeOpInterface.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
@@ -22,6 +24,9 @@ namespace vast::hl
     static constexpr auto auto_storage     = "is_auto";
     static constexpr auto register_storage = "is_register";
     static constexpr auto thread_storage   = "is_thread_local";
+    // Storage of objects of const qualified types, kept once the qualifiers
+    // are dropped by the lowering of types.
+    static constexpr auto constant_storage = "is_constant";
 
     template< typename Self >
     void set_unit_attr(Self &self, std::string_view attr) {
@@ -53,6 +58,11 @@ namespace vast::hl
         set_unit_attr(self, thread_storage);
     }
 
+    template< typename Self >
+    void set_constant_storage(Self &self) {
+        set_unit_attr(self, constant_storage);
+    }
+
     template< typename Self >
     bool has_unit_attr(const Self &self, std::string_view attr) {
         return self->hasAttr(attr);
@@ -83,6 +93,11 @@ namespace vast::hl
         return has_unit_attr(self, thread_storage);
     }
 
+    template< typename Self >
+    bool has_constant_storage(const Self &self) {
+        return has_unit_attr(self, constant_storage);
+    }
+
 } // namespace vast::hl
 
 #define GET_OP_CLASSES
@@ -11,6 +11,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/Dialect.h>
 #include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/SymbolTable.h>
 #include <mlir/IR/TypeSupport.h>
 #include <mlir/IR/Types.h>
 #include <mlir/Interfaces/CallInterfaces.h>
@@ -81,7 +82,7 @@ namespace vast::hl
     template< typename T >
     concept high_level_scalar_type = scalar_types::contains< T >;
 
-    using composite_types = util::type_list< ArrayType >;
+    using composite_types = util::type_list< ArrayType, VectorType >;
 
     using high_level_types = util::concat<
         scalar_types, composite_types, util::type_list< VoidType >
@@ -128,6 +129,16 @@ namespace vast::hl
     core::FunctionType getFunctionType(mlir::CallOpInterface call);
     core::FunctionType getFunctionType(mlir::CallInterfaceCallable callee, vast_module mod);
 
+    // Variants that resolve callees through cached symbol tables, which spares
+    // a scan of the enclosing symbol table for every call.
+    core::FunctionType getFunctionType(
+        mlir::CallOpInterface call, mlir::SymbolTableCollection &symbol_tables
+    );
+    core::FunctionType getFunctionType(
+        mlir::CallInterfaceCallable callee, vast_module mod,
+        mlir::SymbolTableCollection &symbol_tables
+    );
+
     Type getTypedefType(TypedefType type, vast_module mod);
 
     // unwraps all typedef aliases to get to real underlying type
@@ -146,6 +157,13 @@ namespace vast::hl
     // TODO(hl): Invent an interface/trait?
     auto name_of_record(mlir_type t) -> std::optional< std::string >;
 
+    /* categories of high level types */
+    enum class TypeCategory : std::uint8_t { None, Bool, Integer, Floating, Composite, Void };
+
+    // Category of the type by a single lookup of its type id, `None` for types
+    // that are not in `high_level_types`.
+    TypeCategory getTypeCategory(mlir_type type);
+
     bool isBoolType(mlir_type type);
     bool isIntegerType(mlir_type type);
     bool isFloatingType(mlir_type type);
@@ -10,49 +10,69 @@
 
 #include "vast/Util/Common.hpp"
 
+VAST_RELAX_WARNINGS
+#include <mlir/Analysis/DataLayoutAnalysis.h>
+#include <mlir/Pass/AnalysisManager.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Alignment.h>
+#include <llvm/Support/MathExtras.h>
+VAST_UNRELAX_WARNINGS
+
 #include "gap/core/generator.hpp"
 
+#include <mutex>
+#include <utility>
+
 /* Contains common utilities often needed to work with hl dialect. */
 
 namespace vast::hl
 {
+    //
+    // Helpers used per type conversion or per member access return lazy
+    // ranges over the operations, which do not allocate, unlike generators
+    // that allocate a coroutine frame on every call. Ranges refer to the
+    // operations, hence they must not be iterated while the visited
+    // operations are erased.
+    //
     template< typename T >
-    gap::generator< T > top_level_ops(vast_module module_op)
+    auto top_level_ops(vast_module module_op)
     {
-        auto body = module_op.getBody();
-        if (!body)
-            co_return;
-
-        for (auto &op : *body)
-            if (auto casted = mlir::dyn_cast< T >(op))
-                co_yield casted;
+        // the region is empty only while the module is being built
+        return module_op.getBodyRegion().getOps< T >();
     }
 
-    using type_generator = gap::generator< mlir::Type >;
     using value_generator = gap::generator< mlir::Value >;
 
-    static inline gap::generator< hl::FieldDeclOp > field_defs(hl::StructDeclOp op)
+    static inline auto field_defs(hl::StructDeclOp op)
     {
-        for (auto &maybe_field : op.getOps())
-        {
-            // TODO(hl): So normally only `hl.field` should be present here,
-            //           but currently also re-declarations of nested structures
-            //           are here - add hard fail if the conversion fails in the future.
-            if (mlir::isa< hl::StructDeclOp >(maybe_field))
-                continue;
+        // TODO(hl): So normally only `hl.field` should be present here,
+        //           but currently also re-declarations of nested structures
+        //           are here - add hard fail if the conversion fails in the future.
+        auto is_field = [] (operation maybe_field) {
+            return !mlir::isa< hl::StructDeclOp >(maybe_field);
+        };
 
+        auto as_field = [] (operation maybe_field) {
             auto field_decl = mlir::dyn_cast< hl::FieldDeclOp >(maybe_field);
             VAST_ASSERT(field_decl);
-            co_yield field_decl;
-        }
+            return field_decl;
+        };
+
+        auto ops = llvm::map_range(op.getOps(), [] (auto &nested) { return &nested; });
+        return llvm::map_range(llvm::make_filter_range(ops, is_field), as_field);
     }
 
-    static inline type_generator field_types(hl::StructDeclOp op)
+    static inline auto field_types(hl::StructDeclOp op)
     {
-        for (auto def : field_defs(op))
-            co_yield def.getType();
+        return llvm::map_range(field_defs(op), [] (hl::FieldDeclOp def) {
+            return def.getType();
+        });
     }
 
+    using field_type_range = decltype(field_types(std::declval< hl::StructDeclOp >()));
+
     // TODO(hl): This is a placeholder that works in our test cases so far.
     //           In general, we will need generic resolution for scoping that
     //           will be used instead of this function.
@@ -67,18 +87,451 @@ namespace vast::hl
         return {};
     }
 
+    //
+    // Index of top-level record definitions and typedefs of a module. It is
+    // built on the first lookup and replaces the linear scans of the module
+    // done by `definition_of`. The index can be used as an mlir analysis, which
+    // is invalidated after every pass that does not preserve it. Users that
+    // insert or erase records or typedefs themselves have to call `invalidate`.
+    //
+    struct record_index
+    {
+        explicit record_index(vast_module mod) : mod(mod) {}
+
+        explicit record_index(operation op)
+            : record_index(mlir::cast< vast_module >(op))
+        {}
+
+        auto definition_of(mlir_type t) -> std::optional< hl::StructDeclOp > {
+            auto type_name = hl::name_of_record(t);
+            VAST_CHECK(type_name, "hl::name_of_record failed with {0}", t);
+            return lookup(records(), *type_name);
+        }
+
+        auto typedef_of(string_ref name) -> std::optional< hl::TypeDefOp > {
+            return lookup(typedefs(), name);
+        }
+
+        field_type_range field_types(mlir_type t) {
+            auto def = definition_of(t);
+            VAST_CHECK(def, "Was not able to fetch definition of type: {0}", t);
+            return hl::field_types(*def);
+        }
+
+        void invalidate() {
+            built = false;
+            record_defs.clear();
+            typedef_defs.clear();
+        }
+
+      private:
+
+        template< typename op_t >
+        static auto lookup(const llvm::StringMap< op_t > &map, string_ref name)
+            -> std::optional< op_t >
+        {
+            if (auto it = map.find(name); it != map.end()) {
+                return { it->second };
+            }
+            return std::nullopt;
+        }
+
+        const llvm::StringMap< hl::StructDeclOp > &records() {
+            build();
+            return record_defs;
+        }
+
+        const llvm::StringMap< hl::TypeDefOp > &typedefs() {
+            build();
+            return typedef_defs;
+        }
+
+        void build() {
+            if (built) {
+                return;
+            }
+
+            // Keep the first definition of a name to match `definition_of`.
+            for (auto op : top_level_ops< hl::StructDeclOp >(mod)) {
+                record_defs.try_emplace(op.getName(), op);
+            }
+
+            for (auto op : top_level_ops< hl::TypeDefOp >(mod)) {
+                typedef_defs.try_emplace(op.getName(), op);
+            }
+
+            built = true;
+        }
+
+        vast_module mod;
+        bool built = false;
+
+        llvm::StringMap< hl::StructDeclOp > record_defs;
+        llvm::StringMap< hl::TypeDefOp > typedef_defs;
+    };
+
+    //
+    // Layout of a record definition: fields in the declaration order with
+    // their offsets, sizes and ABI alignments in bits. If the definition
+    // carries the layout computed by clang (`hl.layout`), its offsets, size
+    // and alignment are used as is. Otherwise, the layout is computed from the
+    // data layout and bitfields are laid out as ordinary fields of their type.
+    //
+    struct field_layout
+    {
+        mlir_type type;
+        string_ref name;
+        std::optional< std::uint32_t > bits;
+        std::uint64_t offset = 0;
+        std::uint64_t size   = 0;
+        std::uint64_t align  = 0;
+
+        // Member of the lowered record that holds the field, and the offset
+        // of a bitfield in its storage unit. Zero-width bitfields have none.
+        std::optional< std::uint32_t > member;
+        std::uint32_t bit_offset = 0;
+    };
+
+    //
+    // Member of a record with bitfields as it is lowered: a field, an integer
+    // storage unit shared by a run of adjacent bitfields, or padding, which
+    // has no type. Storage units whose allocation would overlap the next
+    // member are lowered to arrays of bytes.
+    //
+    struct member_layout
+    {
+        mlir_type type;
+        std::uint64_t offset = 0;
+        std::uint64_t size   = 0;
+        bool as_bytes = false;
+
+        // Alignment of accesses of a storage unit, implied by its offset and
+        // the alignment of the record.
+        std::uint64_t access_align = 0;
+    };
+
+    struct record_layout
+    {
+        llvm::SmallVector< field_layout > fields;
+        llvm::StringMap< std::size_t > indices;
+
+        std::uint64_t size  = 0;
+        std::uint64_t align = 0;
+
+        // Lowered members of records with bitfields laid out by clang, empty
+        // otherwise, in which case the fields are lowered as they are.
+        llvm::SmallVector< member_layout > members;
+        bool packed = false;
+
+        bool has_storage_units() const { return !members.empty(); }
+
+        auto field_types() const {
+            return llvm::map_range(fields, [] (const auto &field) { return field.type; });
+        }
+
+        std::optional< std::size_t > field_idx(string_ref name) const {
+            if (auto it = indices.find(name); it != indices.end()) {
+                return it->second;
+            }
+            return std::nullopt;
+        }
+
+      private:
+        friend struct record_layout_cache;
+        bool sized = false;
+        RecordLayoutAttr precomputed;
+    };
+
+    //
+    // Per-module cache of record layouts shared by the passes that inspect
+    // record members. Fields and their indices are collected on the first
+    // lookup of a record, offsets, sizes and alignments are computed only once
+    // the layout is requested. Same as `record_index`, the cache can be used
+    // as an mlir analysis and has to be invalidated by users that modify
+    // record definitions. Lookups are synchronized, so the cache can be shared
+    // by patterns applied to functions in parallel.
+    //
+    struct record_layout_cache
+    {
+        record_layout_cache(vast_module mod, const mlir::DataLayout &dl)
+            : records(mod), dl(dl)
+        {}
+
+        record_layout_cache(operation op, mlir::AnalysisManager &am)
+            : record_layout_cache(
+                mlir::cast< vast_module >(op),
+                am.getAnalysis< mlir::DataLayoutAnalysis >().getAtOrAbove(op)
+            )
+        {}
+
+        // Fields of the record without the data layout information.
+        const record_layout &members_of(mlir_type t) {
+            std::lock_guard< std::mutex > guard(mutex);
+            auto layout = lookup(t);
+            VAST_CHECK(layout, "Was not able to fetch definition of type: {0}", t);
+            return *layout;
+        }
+
+        const record_layout &layout_of(mlir_type t) {
+            std::lock_guard< std::mutex > guard(mutex);
+            auto layout = lookup(t);
+            VAST_CHECK(layout, "Was not able to fetch definition of type: {0}", t);
+            if (!layout->sized) {
+                compute_layout(*layout);
+            }
+            return *layout;
+        }
+
+        // Layout of a record with bitfield storage units, null if `t` is not
+        // such a record.
+        const record_layout *bitfield_layout_of(mlir_type t) {
+            if (!name_of_record(t)) {
+                return nullptr;
+            }
+
+            std::lock_guard< std::mutex > guard(mutex);
+            auto layout = lookup(t);
+            if (!layout) {
+                return nullptr;
+            }
+            if (!layout->sized) {
+                compute_layout(*layout);
+            }
+            return layout->has_storage_units() ? layout : nullptr;
+        }
+
+        std::optional< std::size_t > field_idx(mlir_type t, string_ref name) {
+            std::lock_guard< std::mutex > guard(mutex);
+            if (auto layout = lookup(t)) {
+                return layout->field_idx(name);
+            }
+            return std::nullopt;
+        }
+
+        auto definition_of(mlir_type t) -> std::optional< hl::StructDeclOp > {
+            std::lock_guard< std::mutex > guard(mutex);
+            return records.definition_of(t);
+        }
+
+        void invalidate() {
+            std::lock_guard< std::mutex > guard(mutex);
+            records.invalidate();
+            layouts.clear();
+        }
+
+        // The cache refers to the data layout of the analysis manager, hence
+        // it does not survive passes that do not preserve the data layout.
+        bool isInvalidated(const mlir::AnalysisManager::PreservedAnalyses &pa) const {
+            return !pa.isPreserved< record_layout_cache >()
+                || !pa.isPreserved< mlir::DataLayoutAnalysis >();
+        }
+
+      private:
+
+        record_layout *lookup(mlir_type t) {
+            auto &layout = layouts[t];
+            if (layout) {
+                return layout.get();
+            }
+
+            auto def = records.definition_of(t);
+            if (!def) {
+                return nullptr;
+            }
+
+            layout = std::make_unique< record_layout >();
+            for (auto field : field_defs(*def)) {
+                layout->indices.try_emplace(field.getName(), layout->fields.size());
+                layout->fields.push_back({ field.getType(), field.getName(), field.getBits() });
+            }
+
+            if (auto precomputed = def->getLayoutAttr()) {
+                if (precomputed.getOffsets().size() == layout->fields.size()) {
+                    layout->precomputed = precomputed;
+                }
+            }
+
+            return layout.get();
+        }
+
+        void compute_layout(record_layout &layout) const {
+            if (auto precomputed = layout.precomputed) {
+                for (auto [field, offset] : llvm::zip(layout.fields, precomputed.getOffsets())) {
+                    field.size   = field.bits.value_or(dl.getTypeSizeInBits(field.type));
+                    field.align  = dl.getTypeABIAlignment(field.type) * 8;
+                    field.offset = offset;
+                }
+
+                layout.size  = precomputed.getSize();
+                layout.align = precomputed.getAlign();
+                layout.sized = true;
+                lower_bitfields(layout);
+                return;
+            }
+
+            std::uint64_t offset = 0;
+            for (auto &field : layout.fields) {
+                field.size   = dl.getTypeSizeInBits(field.type);
+                field.align  = dl.getTypeABIAlignment(field.type) * 8;
+                field.offset = field.align ? llvm::alignTo(offset, field.align) : offset;
+                offset       = field.offset + field.size;
+                layout.align = std::max(layout.align, field.align);
+            }
+
+            layout.size  = layout.align ? llvm::alignTo(offset, layout.align) : offset;
+            layout.sized = true;
+        }
+
+        //
+        // Groups runs of adjacent bitfields into storage units as clang's
+        // `CGRecordLowering` does: a run continues while the next bitfield
+        // starts where the previous one ends, zero-width bitfields end it,
+        // and its storage is an integer of the run rounded up to bytes. The
+        // members are laid out at the offsets clang computed, with explicit
+        // padding, and the record is packed if the natural alignment of its
+        // members cannot reach them. Records that cannot be represented this
+        // way keep their fields as they are.
+        //
+        void lower_bitfields(record_layout &layout) const {
+            auto is_bitfield = [] (const field_layout &field) { return field.bits.has_value(); };
+            if (!llvm::any_of(layout.fields, is_bitfield)) {
+                return;
+            }
+
+            auto mctx = layout.fields.front().type.getContext();
+
+            struct member_t { member_layout layout; std::uint64_t align; bool storage; };
+            llvm::SmallVector< member_t > members;
+            llvm::SmallVector< std::optional< std::uint32_t > > placement;
+
+            std::optional< std::uint32_t > run;
+            std::uint64_t run_end = 0;
+            auto close_run = [&] {
+                if (run) {
+                    auto &unit = members[*run].layout;
+                    unit.size = llvm::alignTo(run_end - unit.offset, 8);
+                    unit.type = mlir::IntegerType::get(mctx, unsigned(unit.size));
+                    members[*run].align = dl.getTypeABIAlignment(unit.type) * 8;
+                    unit.access_align = llvm::commonAlignment(
+                        llvm::Align(std::max< std::uint64_t >(layout.align / 8, 1)), unit.offset / 8
+                    ).value() * 8;
+                    run.reset();
+                }
+            };
+
+            for (const auto &field : layout.fields) {
+                if (field.bits && *field.bits == 0) {
+                    close_run();
+                    placement.push_back(std::nullopt);
+                    continue;
+                }
+
+                if (field.bits) {
+                    if (!run || field.offset != run_end) {
+                        close_run();
+                        if (field.offset % 8 != 0) {
+                            return;
+                        }
+                        run = std::uint32_t(members.size());
+                        members.push_back({ { {}, field.offset, 0 }, 8, true });
+                    }
+                    run_end = field.offset + *field.bits;
+                    placement.push_back(run);
+                    continue;
+                }
+
+                close_run();
+                placement.push_back(std::uint32_t(members.size()));
+                members.push_back({ { field.type, field.offset, field.size }, field.align, false });
+            }
+            close_run();
+
+            // Storage units are allocated as their integer type, unless the
+            // allocation overlaps the next member or the end of the record.
+            for (std::size_t idx = 0; idx < members.size(); ++idx) {
+                auto next = idx + 1 < members.size() ? members[idx + 1].layout.offset : layout.size;
+                auto &member = members[idx];
+                auto &unit   = member.layout;
+                if (unit.offset + unit.size > next) {
+                    return;
+                }
+                if (member.storage && unit.offset + llvm::alignTo(unit.size, member.align) > next) {
+                    unit.as_bytes = true;
+                    member.align  = 8;
+                }
+            }
+
+            std::uint64_t max_align = 8;
+            bool packed = false;
+            for (const auto &member : members) {
+                packed |= member.align == 0 || member.layout.offset % member.align != 0;
+                max_align = std::max(max_align, member.align);
+            }
+            packed |= max_align > layout.align || layout.size % max_align != 0;
+
+            auto alloc_size = [&] (const member_t &member) {
+                return packed || member.layout.as_bytes
+                    ? member.layout.size
+                    : llvm::alignTo(member.layout.size, member.align);
+            };
+
+            llvm::SmallVector< member_layout > lowered;
+            llvm::SmallVector< std::uint32_t > indices;
+            std::uint64_t end = 0;
+            auto pad = [&] (std::uint64_t to, std::uint64_t natural) {
+                if (natural != to && to > end) {
+                    lowered.push_back({ {}, end, to - end, true });
+                }
+                end = to;
+            };
+
+            for (const auto &member : members) {
+                auto natural = packed ? end : llvm::alignTo(end, member.align);
+                if (member.layout.offset < end || (member.layout.offset - end) % 8 != 0) {
+                    return;
+                }
+                pad(member.layout.offset, natural);
+                indices.push_back(std::uint32_t(lowered.size()));
+                lowered.push_back(member.layout);
+                end = member.layout.offset + alloc_size(member);
+            }
+
+            if (end > layout.size) {
+                return;
+            }
+            pad(layout.size, packed ? end : llvm::alignTo(end, max_align));
+
+            for (auto [field, member] : llvm::zip(layout.fields, placement)) {
+                if (member) {
+                    field.member     = indices[*member];
+                    field.bit_offset = std::uint32_t(field.offset - members[*member].layout.offset);
+                }
+            }
+
+            layout.members = std::move(lowered);
+            layout.packed  = packed;
+        }
+
+        record_index records;
+        const mlir::DataLayout &dl;
+
+        llvm::DenseMap< mlir_type, std::unique_ptr< record_layout > > layouts;
+        std::mutex mutex;
+    };
+
     static inline auto type_decls(hl::StructDeclOp struct_decl)
-        -> gap::generator< hl::TypeDeclOp >
     {
         auto module_op = struct_decl->getParentOfType< vast_module >();
         VAST_ASSERT(module_op);
 
-        for (auto decl : top_level_ops< hl::TypeDeclOp >(module_op))
-            if (decl.getName() == struct_decl.getName())
-                co_yield decl;
+        auto declares_struct = [name = struct_decl.getName()] (hl::TypeDeclOp decl) {
+            return decl.getName() == name;
+        };
+
+        return llvm::make_filter_range(top_level_ops< hl::TypeDeclOp >(module_op), declares_struct);
     }
 
-    static inline type_generator field_types(mlir::Type t, vast_module module_op)
+    static inline field_type_range field_types(mlir::Type t, vast_module module_op)
     {
         auto def = definition_of(t, module_op);
         VAST_CHECK(def, "Was not able to fetch definition of type: {0}", t);
@@ -94,26 +547,20 @@ namespace vast::hl
             lvalue_op, hl::CastKind::LValueToRValue);
     }
 
-    // Given record `root` emit `hl::RecordMemberOp` for each its member.
-    auto generate_ptrs_to_record_members(operation root, auto loc, auto &bld)
-        -> gap::generator< hl::RecordMemberOp >
-    {
-        auto module_op = root->getParentOfType< vast_module >();
-        VAST_ASSERT(module_op);
-        auto def = definition_of(root->getResultTypes()[0], module_op);
-        VAST_CHECK(def, "Was not able to fetch definition of type from: {0}", *root);
+    // Given record `root` emit `hl::RecordMemberOp` for each its member. The
+    // members are emitted lazily, as the range is iterated.
+    auto generate_ptrs_to_record_members(
+        operation root, auto loc, auto &bld, record_layout_cache &layouts
+    ) {
+        VAST_ASSERT(root->getNumResults() == 1);
+        const auto &layout = layouts.members_of(root->getResultTypes()[0]);
 
-        for (auto field_def : field_defs(*def))
-        {
-            VAST_ASSERT(root->getNumResults() == 1);
+        return llvm::map_range(layout.fields, [root, loc, &bld] (const field_layout &field) {
             auto as_val = root->getResult(0);
             // `hl.member` requires type to be an lvalue.
-            auto wrap_type = hl::LValueType::get(module_op.getContext(), field_def.getType());
-            co_yield bld.template create< hl::RecordMemberOp >(loc,
-                                                               wrap_type,
-                                                               as_val,
-                                                               field_def.getName());
-        }
+            auto wrap_type = hl::LValueType::get(root->getContext(), field.type);
+            return bld.template create< hl::RecordMemberOp >(loc, wrap_type, as_val, field.name);
+        });
     }
 
     // Given record `root` emit `hl::RecordMemberOp` casted as rvalue for each
@@ -22,6 +22,14 @@ namespace vast::hl {
 
     std::unique_ptr< mlir::Pass > createDCEPass();
 
+    std::unique_ptr< mlir::Pass > createDeadDeclEliminationPass();
+
+    std::unique_ptr< mlir::Pass > createInlineFunctionsPass();
+
+    std::unique_ptr< mlir::Pass > createInstrumentCoveragePass();
+
+    std::unique_ptr< mlir::Pass > createInstrumentFunctionsPass();
+
     std::unique_ptr< mlir::Pass > createLowerTypeDefsPass();
 
     std::unique_ptr< mlir::Pass > createSpliceTrailingScopes();
@@ -10,6 +10,10 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/Dialect.h>
 #include <mlir/IR/OperationSupport.h>
 #include <mlir/Interfaces/SideEffectInterfaces.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
 VAST_RELAX_WARNINGS
 
 
@@ -20,6 +24,24 @@ namespace vast::meta
 {
     using identifier_t = std::uint64_t;
 
+    //
+    // Identifiers generated by codegen are unique across translation units
+    // of the process: the upper half holds the index of the unit, the lower
+    // half an index local to the unit.
+    //
+    using unit_identifier_t  = std::uint32_t;
+    using local_identifier_t = std::uint32_t;
+
+    constexpr identifier_t make_identifier(unit_identifier_t unit, local_identifier_t local) {
+        return (identifier_t(unit) << 32) | local;
+    }
+
+    constexpr unit_identifier_t unit_of(identifier_t id) { return unit_identifier_t(id >> 32); }
+    constexpr local_identifier_t local_of(identifier_t id) { return local_identifier_t(id); }
+
+    // Yields a fresh unit index, safe to call concurrently.
+    unit_identifier_t make_unit_identifier();
+
     void add_identifier(mlir::Operation *op, identifier_t id);
 
     void remove_identifier(mlir::Operation *op);
@@ -28,4 +50,75 @@ namespace vast::meta
 
     std::vector< mlir::Operation * > get_with_meta_location(mlir::Operation *scope, identifier_t id);
 
+    //
+    // Symbols of the scope by their meta identifiers and operations by the
+    // identifiers of their meta locations, collected in a single walk. It can
+    // be used as an analysis. The index does not observe the scope, it has
+    // to be rebuilt once the scope changes, unless identifiers are changed
+    // through the index itself.
+    //
+    struct identifier_index
+    {
+        explicit identifier_index(mlir::Operation *scope);
+
+        llvm::ArrayRef< mlir::Operation * > with_identifier(identifier_t id) const;
+
+        llvm::ArrayRef< mlir::Operation * > with_meta_location(identifier_t id) const;
+
+        // Sets the identifier of the symbol and updates the index.
+        void add(mlir::Operation *symbol, identifier_t id);
+
+        void remove(mlir::Operation *symbol);
+
+      private:
+        using operations = llvm::SmallVector< mlir::Operation *, 1 >;
+
+        llvm::DenseMap< identifier_t, operations > identifiers;
+        llvm::DenseMap< identifier_t, operations > locations;
+    };
+
+    // Module attribute with the file table of compact source positions.
+    static constexpr std::string_view source_files_name = "meta.files";
+
+    // Appends file to the file table of the module and yields its index.
+    unsigned add_source_file(mlir::ModuleOp mod, llvm::StringRef file);
+
+    // Yields file name of the index from the file table of the module.
+    std::optional< llvm::StringRef > get_source_file(mlir::ModuleOp mod, unsigned file);
+
+    //
+    // Operations of the scope by the source positions of their locations,
+    // both file-line-column locations and compact positions, including those
+    // nested in fused locations. Positions of every file are sorted, so a
+    // lookup is a binary search. Locations with only meta identifiers carry
+    // no position and are not indexed.
+    //
+    struct location_index
+    {
+        explicit location_index(mlir::Operation *scope);
+
+        // Operations at the position, ordered by column and then by the walk
+        // of the scope. The zero column matches the whole line.
+        std::vector< mlir::Operation * > at(llvm::StringRef file, unsigned line, unsigned column = 0) const;
+
+        // Yields all indexed positions, sorted within each file.
+        void positions(auto &&yield) const {
+            for (const auto &file : files) {
+                for (const auto &e : file.getValue()) {
+                    yield(file.getKey(), e.line, e.column, e.op);
+                }
+            }
+        }
+
+      private:
+        struct entry
+        {
+            unsigned line;
+            unsigned column;
+            mlir::Operation *op;
+        };
+
+        llvm::StringMap< std::vector< entry > > files;
+    };
+
 } // namespace vast::meta
@@ -35,7 +35,7 @@ namespace vast::cc {
     struct vast_stream_action : frontend_action {
         virtual ~vast_stream_action() = default;
 
-        vast_stream_consumer *consumer;
+        vast_stream_consumer *consumer = nullptr;
         output_type action;
 
     protected:
@@ -49,6 +49,11 @@ namespace vast::cc {
 
         void EndSourceFileAction() override;
 
+        // With -vast-release-ast, clang AST, Sema and preprocessor are freed
+        // before the output is emitted, so that the vast pipeline does not
+        // share peak memory with them.
+        void EndSourceFile() override;
+
     private:
         friend struct vast_consumer;
 
@@ -66,7 +71,7 @@ namespace vast::cc {
 
         owning_module_ref result();
 
-        vast_consumer *consumer;
+        vast_consumer *consumer = nullptr;
     protected:
 
         explicit vast_module_action(const vast_args &vargs);
@@ -102,6 +107,15 @@ namespace vast::cc {
         virtual void anchor();
     };
 
+    //
+    // Emit LLVM bitcode
+    //
+    struct emit_bc_action : vast_stream_action {
+        explicit emit_bc_action(const vast_args &vargs);
+    private:
+        virtual void anchor();
+    };
+
     //
     // Emit MLIR
     //
@@ -111,6 +125,15 @@ namespace vast::cc {
         virtual void anchor();
     };
 
+    //
+    // Emit MLIR bytecode
+    //
+    struct emit_mlir_bytecode_action : vast_stream_action {
+        explicit emit_mlir_bytecode_action(const vast_args &vargs);
+    private:
+        virtual void anchor();
+    };
+
     //
     // Emit obj
     //
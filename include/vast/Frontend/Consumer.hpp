@@ -12,6 +12,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Frontend/Diagnostics.hpp"
 #include "vast/Frontend/FrontendAction.hpp"
 #include "vast/Frontend/Options.hpp"
+#include "vast/Frontend/OutputCache.hpp"
 #include "vast/Frontend/Targets.hpp"
 
 #include "vast/CodeGen/CodeGenContext.hpp"
@@ -37,9 +38,9 @@ namespace vast::cc {
 
         void HandleCXXStaticMemberVarInstantiation(clang::VarDecl * /* decl */) override;
 
-        void HandleInlineFunctionDefinition(clang::FunctionDecl * /* decl */) override;
+        void HandleInlineFunctionDefinition(clang::FunctionDecl *decl) override;
 
-        void HandleInterestingDecl(clang::DeclGroupRef /* decl */) override;
+        void HandleInterestingDecl(clang::DeclGroupRef decls) override;
 
         void HandleTranslationUnit(acontext_t &acontext) override;
 
@@ -73,37 +74,96 @@ namespace vast::cc {
         //
         // contexts
         //
-        std::unique_ptr< mcontext_t > mctx = nullptr;
+        std::shared_ptr< mcontext_t > mctx = nullptr;
         std::unique_ptr< cg::codegen_context > cgctx = nullptr;
         std::unique_ptr< cg::codegen_driver > codegen = nullptr;
     };
 
+    struct function_streamer;
+
     struct vast_stream_consumer : vast_consumer {
         using base = vast_consumer;
 
         vast_stream_consumer(
-            output_type act, action_options opts, const vast_args &vargs, output_stream_ptr os
-        )
-            : base(std::move(opts), vargs), action(act), output_stream(std::move(os))
-        {}
+            output_type act, action_options opts, const vast_args &vargs, output_stream_ptr os,
+            std::optional< output_cache > cache = std::nullopt,
+            std::optional< function_cache > fn_cache = std::nullopt
+        );
+
+        ~vast_stream_consumer() override;
+
+        void Initialize(acontext_t &ctx) override;
+
+        bool HandleTopLevelDecl(clang::DeclGroupRef decls) override;
 
         void HandleTranslationUnit(acontext_t &acontext) override;
 
+        // Emits output of a module, which codegen finished before clang
+        // released the AST (-vast-release-ast).
+        void emit_released_output();
+
+        // Writes the output cached for the translation unit, codegen does not
+        // need to run then (-vast-cache-dir).
+        bool emit_cached_output();
+
       private:
+        // Emits the output and stores it in the cache.
+        void emit_and_store_output(owning_module_ref mod);
+
+        void emit_output(owning_module_ref mod);
+
         void emit_backend_output(
             backend backend_action, owning_module_ref mlir_module, mcontext_t *mctx
         );
 
+        // Number of module partitions optimized concurrently by the backend
+        // (-vast-backend-partitions).
+        unsigned backend_partitions() const;
+
+        // Number of shards of the module the vast pipeline processes
+        // concurrently (-vast-module-shards).
+        unsigned module_shards() const;
+
         void emit_mlir_output(
             target_dialect target, owning_module_ref mod, mcontext_t *mctx
         );
 
+        void emit_mlir_bytecode_output(
+            target_dialect target, owning_module_ref mod, mcontext_t *mctx
+        );
+
         void process_mlir_module(
             target_dialect target, mlir::ModuleOp mod, mcontext_t *mctx
         );
 
+        // Runs the pipeline again on the `reference` copy of the module input
+        // without threads and fails unless the printed results are the same
+        // (-vast-verify-determinism).
+        void verify_determinism(
+            target_dialect target, mlir::ModuleOp mod, mlir::ModuleOp reference, mcontext_t *mctx
+        );
+
+        mlir::OpPrintingFlags printing_flags() const;
+
         output_type action;
         output_stream_ptr output_stream;
+
+        // The only parts of the clang state needed to emit the output once
+        // codegen finishes.
+        std::unique_ptr< llvm::MemoryBuffer > main_file;
+        std::string data_layout;
+
+        // Module waiting for emission until clang releases the AST.
+        owning_module_ref released_module;
+
+        // Set if function definitions are streamed out of the module as soon
+        // as their codegen finishes (-vast-stream-functions).
+        std::unique_ptr< function_streamer > streamer;
+
+        std::optional< output_cache > cache;
+
+        // Taken by the streamer (-vast-function-cache).
+        std::optional< function_cache > fn_cache;
     };
 
 } // namespace vast::cc
@@ -0,0 +1,49 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/ThreadPool.h>
+#include <mlir/IR/MLIRContext.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::cc {
+
+    //
+    // Thread pool shared by all MLIR contexts created by the frontend. When
+    // set (e.g., in batch mode), contexts do not spawn their own threads, but
+    // schedule parallel work to the shared pool.
+    //
+    llvm::ThreadPool *shared_thread_pool();
+
+    void set_shared_thread_pool(llvm::ThreadPool *pool);
+
+    //
+    // Creates MLIR context for a translation unit that uses the shared thread
+    // pool if there is one. Translations to LLVM IR are registered up front.
+    //
+    std::unique_ptr< mcontext_t > make_mcontext();
+
+    //
+    // MLIR context shared by all translation units of the process (e.g., in
+    // batch mode with `--shared-context`). Types, attributes and identifiers
+    // are uniqued once for all the units instead of once per unit.
+    //
+    // The context is created with all the dialects loaded, so that no unit
+    // mutates it when it loads a dialect while the others are compiled.
+    // Units must not change its threading or register their own diagnostic
+    // handlers on it.
+    //
+    std::shared_ptr< mcontext_t > shared_mcontext();
+
+    std::shared_ptr< mcontext_t > make_shared_mcontext();
+
+    void set_shared_mcontext(std::shared_ptr< mcontext_t > mctx);
+
+    bool is_shared_mcontext(const mcontext_t &mctx);
+
+} // namespace vast::cc
@@ -52,8 +52,10 @@ namespace vast::cc
     struct diagnostics_printer {
         using printer_base = clang::TextDiagnosticPrinter;
 
-        explicit diagnostics_printer(diagnostics_options &opts, const std::string &path)
-            : printer(new printer_base(llvm::errs(), opts.get()))
+        explicit diagnostics_printer(
+            diagnostics_options &opts, const std::string &path, llvm::raw_ostream &os = llvm::errs()
+        )
+            : printer(new printer_base(os, opts.get()))
         {
             fixup_diag_prefix_exe_name(printer.get(), path);
         }
@@ -99,8 +101,10 @@ namespace vast::cc
 
     struct errs_diagnostics {
 
-        explicit errs_diagnostics(llvm::ArrayRef<const char *> argv, const std::string &path)
-            : opts(argv), printer(opts, path), engine(make_ids(), opts, printer.get(), false)
+        explicit errs_diagnostics(
+            llvm::ArrayRef<const char *> argv, const std::string &path, llvm::raw_ostream &os = llvm::errs()
+        )
+            : opts(argv), printer(opts, path, os), engine(make_ids(), opts, printer.get(), false)
         {
             if (!opts->DiagnosticSerializationFile.empty()) {
                 auto consumer = clang::serialized_diags::create(
@@ -99,8 +99,13 @@ namespace vast::cc {
         using exec_compile_t  = int (*)(argv_storage_base &);
         using compilation_ptr = std::unique_ptr< clang_compilation >;
 
-        driver(const std::string &path, argv_storage_base &cmd_args, exec_compile_t cc1, bool canonical_prefixes)
-            : cc1_entry_point(cc1), cmd_args(cmd_args), diag(cmd_args, path)
+        // Diagnostics of the driver are printed to `diag_os`, e.g., to send
+        // them to the client of the compile server.
+        driver(
+            const std::string &path, argv_storage_base &cmd_args, exec_compile_t cc1,
+            bool canonical_prefixes, llvm::raw_ostream &diag_os = llvm::errs()
+        )
+            : cc1_entry_point(cc1), cmd_args(cmd_args), diag(cmd_args, path, diag_os)
             , drv(path, llvm::sys::getDefaultTargetTriple(), diag.engine, "vast compiler")
         {
             drv.ResourceDir = CLANG_RESOURCE_DIR;
@@ -314,6 +319,11 @@ namespace vast::cc {
             if (vast::cc::opt::emit_only_llvm(vargs)) {
                 all_args.push_back("-emit-llvm");
             }
+
+            // -emit-llvm of a compilation without linking is bitcode.
+            if (vargs.has_option(vast::cc::opt::emit_llvm_bc)) {
+                all_args.push_back("-c");
+            }
         }
 
         void set_install_dir(argv_storage_base &argv, bool canonical_prefixes) {
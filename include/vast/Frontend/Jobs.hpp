@@ -0,0 +1,87 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/ThreadPool.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Options.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace vast::cc {
+
+    //
+    // Slots of the jobserver of the build system (e.g., `make -jN`), taken
+    // from `MAKEFLAGS`. The process owns one implicit slot, further slots are
+    // held as tokens read from the jobserver and written back once the
+    // client is destroyed.
+    //
+    struct jobserver_client
+    {
+        // The advertised jobserver, if it is reachable from the process.
+        static std::unique_ptr< jobserver_client > from_environment();
+
+        ~jobserver_client();
+
+        // Takes up to `count` more slots without blocking, returns the number
+        // of slots taken.
+        unsigned acquire(unsigned count);
+
+        // Slots of the process, including its implicit one.
+        unsigned slots() const { return 1 + unsigned(tokens.size()); }
+
+      private:
+        jobserver_client(int read_fd, int write_fd) : read_fd(read_fd), write_fd(write_fd) {}
+
+        // The client reads by a non-blocking descriptor of its own, it writes
+        // by the descriptor of the build system.
+        int read_fd, write_fd;
+        std::string tokens;
+    };
+
+    //
+    // Restricts the process to the processors of the NUMA node, threads
+    // created later inherit the placement. Returns the number of the
+    // processors, or nothing if the node is not known to the system.
+    //
+    std::optional< unsigned > bind_to_numa_node(unsigned node);
+
+    // Node of the processor the calling thread runs on.
+    std::optional< unsigned > current_numa_node();
+
+    //
+    // Number of workers of a process that was not given one: the slots of
+    // the jobserver if there is one, otherwise the hardware threads available
+    // to the process.
+    //
+    unsigned default_jobs(jobserver_client *jobserver);
+
+    //
+    // Execution context of a standalone compilation. One thread pool of
+    // `-vast-jobs=N` workers runs all the parallel work of vast-front: pass
+    // pipelines of the MLIR contexts (see `shared_thread_pool`), module
+    // shards, pipelined functions and backend partitions, so that the process
+    // occupies at most its jobs however the work nests. With `-vast-numa`,
+    // the workers are placed on the processors of one node.
+    //
+    struct execution_context
+    {
+        explicit execution_context(const vast_args &vargs);
+
+        ~execution_context();
+
+        unsigned jobs() const { return pool->getThreadCount(); }
+
+      private:
+        std::unique_ptr< jobserver_client > jobserver;
+        std::unique_ptr< llvm::ThreadPool > pool;
+    };
+
+} // namespace vast::cc
@@ -0,0 +1,34 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Frontend/Options.hpp"
+#include "vast/Frontend/Targets.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::cc {
+
+    //
+    // Runs the vast pipeline to `trg` on up to `shards` parts of the high-level
+    // module concurrently (-vast-module-shards=N). Every function and variable
+    // is owned by a single shard; the other shards that refer to it get its
+    // declaration. Internal symbols are kept together with the symbols that
+    // refer to them, so they never have to be declared across shards. Type
+    // declarations are copied to every shard. Shards are balanced by the
+    // number of their operations.
+    //
+    // The processed shards are linked back by the program linker into `mod`,
+    // which merges the copies of types and resolves the declarations. Symbols
+    // owned by later shards follow those of the first one, hence the order of
+    // top-level operations differs from the unsharded module.
+    //
+    // Only the high-level target is supported, as the linker resolves symbols
+    // of the high-level dialect.
+    //
+    logical_result process_in_shards(
+        vast_module mod, unsigned shards, target_dialect trg,
+        mcontext_t &mctx, const vast_args &vargs
+    );
+
+} // namespace vast::cc
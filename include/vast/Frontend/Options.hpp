@@ -14,6 +14,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Core/CoreAttributes.hpp"
 #include "vast/Util/Common.hpp"
+#include "vast/Util/Compression.hpp"
 
 namespace vast::cc
 {
@@ -45,6 +46,9 @@ namespace vast::cc
 
     constexpr string_ref vast_option_prefix = "-vast-";
 
+    // Command line spelling of the option, e.g., `-vast-simplify`.
+    inline std::string spelling(string_ref opt) { return (vast_option_prefix + opt).str(); }
+
     struct vast_args
     {
         using option_list = std::vector< string_ref >;
@@ -69,33 +73,124 @@ namespace vast::cc
 
     namespace opt {
         constexpr string_ref emit_llvm = "emit-llvm";
+        constexpr string_ref emit_llvm_bc = "emit-llvm-bc";
         constexpr string_ref emit_obj  = "emit-obj";
         constexpr string_ref emit_asm  = "emit-asm";
         constexpr string_ref emit_mlir = "emit-mlir";
+        constexpr string_ref emit_mlir_bytecode = "emit-mlir-bytecode";
 
         constexpr string_ref print_pipeline = "print-pipeline";
+        constexpr string_ref pipeline_stats = "pipeline-stats";
+        // counts and times applications of conversion patterns
+        constexpr string_ref pattern_stats = "pattern-stats";
+        // -vast-codegen-stats[=N], N slowest top-level declarations are reported
+        constexpr string_ref codegen_stats = "codegen-stats";
+        // -vast-trace=<file.json>
+        constexpr string_ref trace = "trace";
+        // prints operations, types and attributes after every pipeline step
+        constexpr string_ref ir_census = "ir-census";
+        // counts rewrites of the IR and the net change of every pass
+        constexpr string_ref ir_churn = "ir-churn";
         constexpr string_ref emit_crash_reproducer = "emit-crash-reproducer";
+        // -vast-memory-limit=<MB>
+        constexpr string_ref memory_limit = "memory-limit";
+        // -vast-function-budget=<ms>
+        constexpr string_ref function_budget = "function-budget";
 
         constexpr string_ref disable_multithreading = "disable-multithreading";
+        // -vast-jobs=N, workers of the process
+        constexpr string_ref jobs = "jobs";
+        // -vast-numa=auto|<node>
+        constexpr string_ref numa = "numa";
+        // -vast-backend-partitions=N
+        constexpr string_ref backend_partitions = "backend-partitions";
+        constexpr string_ref parallel_translation = "parallel-translation";
+        constexpr string_ref parallel_printing = "parallel-printing";
+        // -vast-module-shards=N
+        constexpr string_ref module_shards = "module-shards";
         constexpr string_ref debug = "debug";
 
         constexpr string_ref simplify = "simplify";
 
+        constexpr string_ref stream_functions = "stream-functions";
+        // runs the pipeline of streamed functions concurrently with codegen
+        constexpr string_ref pipelined_functions = "pipelined-functions";
+        constexpr string_ref release_ast = "release-ast";
+        constexpr string_ref lazy_function_bodies = "lazy-function-bodies";
+        constexpr string_ref roots = "roots";
+        constexpr string_ref system_headers_decls_only = "system-headers-decls-only";
+        constexpr string_ref record_layouts = "record-layouts";
+        constexpr string_ref emit_comments = "emit-comments";
+        constexpr string_ref strip_local_names = "strip-local-names";
+        // -vast-header-cache=<dir>
+        constexpr string_ref header_cache = "header-cache";
+        // -vast-cache-dir=<dir>
+        constexpr string_ref cache_dir = "cache-dir";
+        // -vast-cache-base-dir=<dir>
+        constexpr string_ref cache_base_dir = "cache-base-dir";
+        // -vast-remote-cache=http://<host>[:<port>][/<prefix>]
+        constexpr string_ref remote_cache = "remote-cache";
+        // options are matched by their prefixes, this one must not start with `remote-cache`
+        constexpr string_ref no_remote_cache_upload = "no-remote-cache-upload";
+        // -vast-function-cache=<dir>
+        constexpr string_ref function_cache = "function-cache";
+        // -vast-instantiation-cache[=<dir>]
+        constexpr string_ref instantiation_cache = "instantiation-cache";
+        // options are matched by their prefixes, this one must not start with `instantiation-cache`
+        constexpr string_ref instantiation_decls = "instantiation-decls";
+        // -vast-bytecode-zstd[=<level>]
+        constexpr string_ref bytecode_zstd = "bytecode-zstd";
+        // -vast-zstd-dict=<path>
+        constexpr string_ref zstd_dict = "zstd-dict";
+
         llvm::Twine disable(string_ref pipeline_name);
 
         constexpr string_ref show_locs = "show-locs";
         constexpr string_ref locs_as_meta_ids = "locs-as-meta-ids";
+        // -vast-locs=full|compact|none
+        constexpr string_ref locs = "locs";
 
         constexpr string_ref disable_vast_verifier = "disable-vast-verifier";
+        // -vast-verifier=none|checkpoints|all
+        constexpr string_ref verifier = "verifier";
         constexpr string_ref vast_verify_diags = "verify-diags";
+        constexpr string_ref verify_determinism = "verify-determinism";
         constexpr string_ref disable_emit_cxx_default = "disable-emit-cxx-default";
+        // -vast-unsupported=full|summary|drop
+        constexpr string_ref unsupported = "unsupported";
+        // -vast-snapshot="hl=<file>;std=<file>", bytecode of the module at
+        // the dialects on the way to the target
+        constexpr string_ref snapshot = "snapshot";
+        // -vast-hl-inline[=<threshold>]
+        constexpr string_ref hl_inline = "hl-inline";
+        // -vast-instrument-functions=call|xray|sampled
+        constexpr string_ref instrument_functions = "instrument-functions";
+        // -vast-instrument-filter=<regex>
+        constexpr string_ref instrument_filter = "instrument-filter";
+        // -vast-instrument-roots="f;g"
+        constexpr string_ref instrument_roots = "instrument-roots";
+        // -vast-instrument-sample-period=N
+        constexpr string_ref instrument_sample_period = "instrument-sample-period";
 
         bool emit_only_mlir(const vast_args &vargs);
         bool emit_only_llvm(const vast_args &vargs);
+
+        // Budget of -vast-memory-limit=<MB> in kilobytes, if given.
+        std::optional< std::int64_t > memory_limit_kb(const vast_args &vargs);
+
+        // Budget of -vast-function-budget=<ms> in milliseconds, if given.
+        std::optional< std::int64_t > function_budget_ms(const vast_args &vargs);
+
+        // Workers of -vast-jobs=N, if given.
+        std::optional< unsigned > jobs_count(const vast_args &vargs);
     } // namespace opt
 
     using source_language = core::SourceLanguage;
 
     source_language get_source_language(const language_options &opts);
 
+    // Compression of emitted and cached bytecode by -vast-bytecode-zstd and
+    // the dictionary of -vast-zstd-dict, or the one shipped with the tools.
+    util::bytecode_compression get_bytecode_compression(const vast_args &vargs);
+
 } // namespace vast::cc
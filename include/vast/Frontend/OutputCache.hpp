@@ -0,0 +1,150 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/SourceManager.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/CompilerInstance.hpp"
+#include "vast/Frontend/Options.hpp"
+#include "vast/Frontend/Targets.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::cc
+{
+    //
+    // Storage of the entries of the output cache, i.e., manifests keyed by
+    // invocation hashes and outputs keyed by result hashes.
+    //
+    struct cache_storage
+    {
+        enum class entry_kind { manifest, output };
+
+        virtual ~cache_storage() = default;
+
+        virtual std::optional< std::string > get(entry_kind kind, string_ref key) = 0;
+
+        // Failures to store an entry are ignored, the cache only misses then.
+        virtual void put(entry_kind kind, string_ref key, string_ref data) = 0;
+    };
+
+    using cache_storage_ptr = std::unique_ptr< cache_storage >;
+
+    // Entries are files of the directory, `<key>.manifest` and `<key>.out`.
+    // Every entry is written to a temporary file and renamed, so that
+    // concurrent compilations sharing the directory never read partial
+    // entries.
+    cache_storage_ptr make_local_storage(string_ref dir);
+
+    //
+    // Content-addressed cache of the MLIR outputs of translation units
+    // (-vast-cache-dir=<dir>), in the way of the direct mode of ccache.
+    //
+    // The invocation is hashed from the cc1 and vast arguments, the output
+    // kind, the working directory, the main file and the vast version.
+    // Under the invocation hash, the cache keeps a manifest of the files the
+    // translation unit read, with the hashes of their contents. The output is
+    // stored under the hash of the invocation and the manifest, hence a hit
+    // requires only hashing the dependencies again, neither the preprocessor
+    // nor codegen run.
+    //
+    // Storages are searched in order, an entry found in a later one, e.g.,
+    // a remote cache, is copied to the earlier ones. Paths under the base
+    // directory are hashed relative to it, so that keys of checkouts in
+    // different directories, or on different hosts, are equal.
+    //
+    struct output_cache
+    {
+        struct dependency
+        {
+            std::string path;
+            std::string hash;
+        };
+
+        output_cache(
+            std::vector< cache_storage_ptr > storages, std::string invocation, std::string base_dir
+        );
+
+        // Returns the cached output if the files read by the translation
+        // unit did not change since it was stored.
+        std::optional< std::string > lookup() const;
+
+        // Records the files read by the translation unit, has to be called
+        // while its source manager is alive.
+        void record_dependencies(const clang::SourceManager &sm);
+
+        // Stores the output together with the recorded dependencies.
+        void store(string_ref output) const;
+
+        string_ref invocation_hash() const { return invocation; }
+
+      private:
+        std::string result_hash(llvm::ArrayRef< dependency > deps) const;
+
+        // Replaces the base directory of a path by a placeholder and back.
+        std::string relocate(string_ref path) const;
+        std::string resolve(string_ref path) const;
+
+        std::vector< cache_storage_ptr > storages;
+        std::string invocation;
+        std::string base_dir;
+        std::vector< dependency > dependencies;
+    };
+
+    // Returns the cache of the invocation if -vast-cache-dir or
+    // -vast-remote-cache is set and the output can be cached, i.e., it is
+    // textual or bytecode MLIR of a file and diagnostics of the vast pipeline
+    // are not verified.
+    std::optional< output_cache > make_output_cache(
+        compiler_instance &ci, output_type act, const vast_args &vargs
+    );
+
+    //
+    // Cache of the function definitions processed by the function-local
+    // pipeline when they are streamed out of the module
+    // (-vast-function-cache=<dir>), so that a translation unit compiled again
+    // after an edit runs the pipeline only on the changed functions.
+    //
+    // A function is keyed by its fingerprint after codegen: the invocation
+    // without the contents of the main file, the target dialect, the name
+    // and the structural hash of the function, and the signatures of its
+    // direct callees. Locations are part of the fingerprint only if they are
+    // printed.
+    //
+    struct function_cache
+    {
+        function_cache(cache_storage_ptr storage, std::string invocation, bool locs);
+
+        std::string fingerprint(operation fn) const;
+
+        std::optional< std::string > lookup(string_ref fingerprint);
+
+        void store(string_ref fingerprint, string_ref output) const;
+
+        std::size_t hits() const { return _hits; }
+        std::size_t misses() const { return _misses; }
+
+      private:
+        cache_storage_ptr storage;
+        std::string invocation;
+        bool locs;
+
+        std::size_t _hits = 0;
+        std::size_t _misses = 0;
+    };
+
+    // Returns the function cache if -vast-function-cache is set together
+    // with -vast-stream-functions and the output can be cached.
+    std::optional< function_cache > make_function_cache(
+        compiler_instance &ci, output_type act, const vast_args &vargs
+    );
+
+} // namespace vast::cc
@@ -0,0 +1,29 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/IR/Module.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Options.hpp"
+
+namespace vast::cc {
+
+    //
+    // Runs the llvm optimization pipeline on `partitions` parts of the module
+    // concurrently. The module is split as by `llvm::SplitModule`, every part
+    // is optimized in its own llvm context and the optimized parts are linked
+    // back into a single module in the context of `mod`. Linkage of local
+    // symbols, which the split externalizes, is restored.
+    //
+    // As with partitioned LTO, there is no inlining across partitions.
+    //
+    std::unique_ptr< llvm::Module > optimize_in_partitions(
+        std::unique_ptr< llvm::Module > mod, unsigned partitions,
+        const codegen_options &codegen, const target_options &target
+    );
+
+} // namespace vast::cc
@@ -14,7 +14,19 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::cc {
 
-    enum class pipeline_source { ast };
+    enum class pipeline_source { ast, mlir };
+
+    //
+    // Verification of the module by the pipeline (-vast-verifier):
+    //
+    //   - `all` verifies after every pass (the default),
+    //   - `checkpoints` verifies only after codegen and after every step of
+    //     the conversion path,
+    //   - `none` does not verify at all.
+    //
+    enum class verifier_mode { none, checkpoints, all };
+
+    verifier_mode get_verifier_mode(const vast_args &vargs);
 
     //
     // Create pipeline schedule from source `src` to target `trg`
@@ -33,5 +45,46 @@ namespace vast::cc {
         const vast_args &vargs
     );
 
+    //
+    // Create pipeline schedule for already generated MLIR module `mod`.
+    //
+    // Only steps between the dialect the module was already lowered to and the
+    // target `trg` are scheduled.
+    //
+    std::unique_ptr< pipeline_t > setup_pipeline(
+        vast_module mod, target_dialect trg,
+        mcontext_t &mctx,
+        const vast_args &vargs
+    );
+
+    //
+    // Create pipeline schedule that processes a single generated `hl.func`.
+    //
+    // Only function-local steps can run on a function, hence the target `trg`
+    // has to be reachable without module-level conversions. Use
+    // `has_function_local_pipeline` to check it first.
+    //
+    std::unique_ptr< pipeline_t > setup_function_pipeline(
+        target_dialect trg,
+        mcontext_t &mctx,
+        const vast_args &vargs
+    );
+
+    bool has_function_local_pipeline(target_dialect trg, const vast_args &vargs);
+
+    constexpr string_ref reached_dialect_attr_name = "vast.reached_dialect";
+
+    //
+    // Returns the last dialect of the conversion path the module was lowered
+    // to. The dialect is taken from `reached_dialect_attr_name` attribute if
+    // present, otherwise it is inferred from the content of the module.
+    //
+    // Returns `std::nullopt` if no conversion step can be skipped.
+    //
+    std::optional< target_dialect > reached_dialect(vast_module mod);
+
+    // Records in the module the dialect it was lowered to.
+    void mark_reached_dialect(vast_module mod, target_dialect trg);
+
 } // namespace vast::cc
 
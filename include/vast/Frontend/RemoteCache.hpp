@@ -0,0 +1,32 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Frontend/OutputCache.hpp"
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::cc
+{
+    //
+    // Storage of the output cache on a server of the HTTP protocol of the
+    // Bazel remote cache (-vast-remote-cache=http://<host>[:<port>][/<prefix>]),
+    // e.g., bazel-remote or nginx with WebDAV:
+    //
+    //   GET|PUT <prefix>/cas/<sha256>   blobs, keyed by the digest of their contents
+    //   GET|PUT <prefix>/ac/<sha256>    action results, keyed by cache keys
+    //
+    // An entry is a blob in the CAS and an `ActionResult` message under its
+    // key in the action cache, with a single output file named by the kind of
+    // the entry that refers to the blob. Blobs are uploaded before the action
+    // results, so that servers validating action results accept them. Keys
+    // hash no host-specific state beyond the paths outside the base
+    // directory, so agents building the same commit share entries.
+    //
+    // Only plain HTTP is supported. Requests time out after a few seconds and
+    // the first failure disables the storage for the rest of the process, so
+    // that an unreachable server does not slow down compilation.
+    //
+    cache_storage_ptr make_remote_storage(string_ref url, bool no_upload);
+
+} // namespace vast::cc
@@ -0,0 +1,80 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+//===----------------------------------------------------------------------===//
+//
+// C interface of `vast::cc::session` (see Session.hpp) for embedding vast in
+// services that are not written in C++. A session is not thread-safe, use one
+// session per thread.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef VAST_FRONTEND_SESSION_H
+#define VAST_FRONTEND_SESSION_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct vast_session vast_session;
+typedef struct vast_result vast_result;
+
+typedef enum vast_target_dialect {
+    VAST_TARGET_HIGH_LEVEL,
+    VAST_TARGET_STD,
+    VAST_TARGET_LLVM,
+    VAST_TARGET_CIR
+} vast_target_dialect;
+
+typedef enum vast_output_kind {
+    // textual MLIR of the target dialect
+    VAST_OUTPUT_MLIR,
+    // MLIR bytecode of the target dialect
+    VAST_OUTPUT_MLIR_BYTECODE,
+    // object code, the target dialect is ignored
+    VAST_OUTPUT_OBJECT
+} vast_output_kind;
+
+typedef struct vast_session_options {
+    // name of the compiled source, null for "input.c"
+    const char *file;
+    // compiler arguments without the input
+    const char *const *args;
+    size_t num_args;
+    // options of vast, e.g., "-vast-simplify"
+    const char *const *vast_options;
+    size_t num_vast_options;
+    // nonzero to let the session run passes on its own threads
+    int multithreaded;
+} vast_session_options;
+
+// Returns null if the options are invalid, the errors are then written to
+// `diagnostics` if it is not null, which the caller frees by `free`.
+vast_session *vast_session_create(const vast_session_options *options, char **diagnostics);
+
+void vast_session_destroy(vast_session *session);
+
+// Never returns null, failed compilations return a result without output.
+vast_result *vast_session_compile(
+    vast_session *session, const char *source, size_t size,
+    vast_target_dialect target, vast_output_kind output
+);
+
+// Nonzero if the compilation succeeded.
+int vast_result_succeeded(const vast_result *result);
+
+// Output of the compilation, valid until the result is destroyed.
+const char *vast_result_data(const vast_result *result);
+size_t vast_result_size(const vast_result *result);
+
+// Null terminated diagnostics of the compilation.
+const char *vast_result_diagnostics(const vast_result *result);
+
+void vast_result_destroy(vast_result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VAST_FRONTEND_SESSION_H
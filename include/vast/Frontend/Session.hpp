@@ -0,0 +1,115 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/CompilerInvocation.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Options.hpp"
+#include "vast/Frontend/Targets.hpp"
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Pipeline.hpp"
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::cc {
+
+    struct session_options
+    {
+        // Name of the compiled source, its extension selects the language
+        // unless the arguments do (e.g., `-x c++`).
+        std::string file = "input.c";
+
+        // Compiler arguments without the input, e.g., `-std=c++17 -O2 -I...`.
+        std::vector< std::string > args;
+
+        // Options of vast, e.g., `-vast-simplify`.
+        std::vector< std::string > vast_options;
+
+        // Lets the MLIR context run passes on its own threads. Sessions of
+        // services that compile on many threads at once do better without.
+        bool multithreaded = false;
+    };
+
+    //
+    // In-process compiler for services that compile snippets on demand.
+    // A session keeps everything that does not depend on the source warm
+    // between compilations: the compiler invocation, the MLIR context with
+    // the dialects loaded (hence also the uniqued types and attributes and
+    // the frozen pattern sets of the conversions), the pipelines of the
+    // targets and the parsed preamble of the source, i.e., its leading
+    // includes are parsed again only once they change.
+    //
+    // A session is not thread-safe, but sessions do not share any state,
+    // so they can be used concurrently with one session per thread.
+    // Modules returned by `compile` live in the context of the session and
+    // must not outlive it.
+    //
+    // Failed compilations return nothing, their errors are then kept in
+    // `diagnostics`.
+    //
+    struct session
+    {
+        ~session();
+
+        // Module of the source lowered to the target dialect.
+        owning_module_ref compile(string_ref source, target_dialect trg);
+
+        // MLIR bytecode of the module lowered to the target dialect.
+        std::optional< std::string > compile_bytecode(string_ref source, target_dialect trg);
+
+        // Relocatable object code of the target of the compiler arguments.
+        std::optional< std::string > compile_object(string_ref source);
+
+        // Diagnostics of the last compilation.
+        string_ref diagnostics() const { return diags; }
+
+        mcontext_t &context() { return *mctx; }
+
+      private:
+        friend std::unique_ptr< session > make_session(session_options, std::string *);
+
+        session(
+            session_options opts, llvm::IntrusiveRefCntPtr< virtual_file_system > vfs,
+            std::shared_ptr< clang::CompilerInvocation > invocation
+        );
+
+        // Parses the source into the unit, reparsing the previous one.
+        bool parse(string_ref source);
+
+        owning_module_ref generate();
+
+        bool lower(vast_module mod, target_dialect trg);
+
+        session_options opts;
+        vast_args vargs;
+
+        // Real file system with a placeholder of the source, the contents
+        // are remapped on every parse.
+        llvm::IntrusiveRefCntPtr< virtual_file_system > vfs;
+        std::shared_ptr< clang::CompilerInvocation > invocation;
+        std::unique_ptr< mcontext_t > mctx;
+        std::unique_ptr< clang::ASTUnit > unit;
+
+        std::map< target_dialect, std::unique_ptr< pipeline_t > > pipelines;
+
+        std::string diags;
+        llvm::raw_string_ostream diags_os;
+        llvm::IntrusiveRefCntPtr< diagnostics_engine > engine;
+    };
+
+    // Returns null if the compiler arguments are invalid, reporting the
+    // errors to `diagnostics`.
+    std::unique_ptr< session > make_session(
+        session_options opts, std::string *diagnostics = nullptr
+    );
+
+} // namespace vast::cc
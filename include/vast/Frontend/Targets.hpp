@@ -9,7 +9,9 @@ namespace vast::cc {
     enum class output_type {
         emit_assembly,
         emit_mlir,
+        emit_mlir_bytecode,
         emit_llvm,
+        emit_bc,
         emit_obj,
         none
     };
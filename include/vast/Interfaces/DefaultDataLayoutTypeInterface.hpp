@@ -38,12 +38,14 @@ namespace vast
                        *out, current, entries.size());
         };
 
+        // Entries of all types of the same kind are passed in, hence compare
+        // the keys first and decode only the matching entries.
         auto casted_self = static_cast< const ConcreteType & >(self);
         for (const auto &entry : entries)
         {
-            auto raw = dl::DLEntry(entry);
-            if (casted_self == raw.type)
-                handle_entry(raw);
+            if (mlir::dyn_cast< mlir_type >(entry.getKey()) != casted_self)
+                continue;
+            handle_entry(dl::DLEntry(entry));
         }
 
         VAST_CHECK(out.has_value(), "Data layout query of {0} did not produce a value!",
@@ -0,0 +1,33 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+#include <limits>
+
+namespace vast::link
+{
+    //
+    // Extracts the dependency closure of the function of the name into a new
+    // module, e.g., to run analyses or reproduce a bug on kilobytes instead of
+    // the whole translation unit. The module keeps the attributes of the
+    // original one and its top-level operations are copies of:
+    //
+    //   - the function and its callees reachable by at most `depth` direct
+    //     calls, with their bodies,
+    //   - the global variables they refer to, with their initializers,
+    //   - the records, enums and typedefs of the types they use,
+    //   - declarations of the other functions they refer to, i.e., callees
+    //     beyond the depth and functions whose address is taken; definitions
+    //     are stubbed as external declarations.
+    //
+    // Dependencies of the copied variables and types are copied transitively.
+    // Operations keep their order, so types precede their uses. Returns null
+    // if there is no such function or the extracted module fails to verify.
+    //
+    owning_module_ref extract_function(
+        vast_module mod, string_ref name, unsigned depth = std::numeric_limits< unsigned >::max()
+    );
+
+} // namespace vast::link
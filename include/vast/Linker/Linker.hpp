@@ -0,0 +1,225 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/STLFunctionalExtras.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <string>
+#include <vector>
+
+namespace vast::link
+{
+    // Name of a top-level function, variable or type declaration.
+    string_ref name_of(operation op);
+
+    // Functions and variables, which are resolved by their names.
+    bool is_global(operation op);
+
+    // Records, enums, their forward declarations and typedefs, which are
+    // merged when equivalent.
+    bool is_type_declaration(operation op);
+
+    struct link_stats
+    {
+        std::size_t units = 0;
+
+        // declarations resolved against a definition or another declaration
+        std::size_t resolved = 0;
+
+        // weak, linkonce, common and available externally definitions
+        // replaced by a stronger one, or dropped in favour of an earlier one
+        std::size_t overridden = 0;
+
+        // internal symbols renamed to avoid collisions
+        std::size_t renamed = 0;
+
+        // identical type declarations merged
+        std::size_t deduplicated = 0;
+
+        // definitions of types renamed as they differ from the definition of
+        // their name in the program, and the names that have them
+        std::size_t type_conflicts = 0;
+        std::size_t conflicting_types = 0;
+
+        std::size_t errors = 0;
+    };
+
+    //
+    // External symbol table of a translation unit: names of the functions and
+    // variables the unit defines for other units, i.e., all but declarations
+    // and internal symbols, and the names it refers to without defining them.
+    //
+    struct unit_symbols
+    {
+        std::vector< std::string > defined;
+        std::vector< std::string > referenced;
+    };
+
+    unit_symbols external_symbols(vast_module mod);
+
+    //
+    // Whole-program module built from the modules of translation units, added
+    // one after another. Top-level operations are moved out of the added
+    // module, so it does not need to outlive the call, and the program never
+    // holds more than one copy of a symbol.
+    //
+    // Functions and global variables are resolved by name in the way of
+    // a static linker:
+    //
+    //   - declarations are resolved against the definition of the name, or
+    //     against the first declaration if there is none,
+    //   - external definitions override weak, linkonce and common ones, which
+    //     override available externally definitions; of definitions of the
+    //     same strength the first one is kept,
+    //   - two external definitions of a name are an error,
+    //   - internal and private symbols do not resolve against anything, they
+    //     are renamed to `<name>.<unit>` once another symbol of the name is
+    //     linked, together with their uses.
+    //
+    // Variables take their linkage from their storage class: static variables
+    // are internal, extern ones without an initializer are declarations and
+    // tentative definitions are common.
+    //
+    // Declarations of records, enums and typedefs are hashed structurally,
+    // by their name, attributes, e.g., layouts and typedef types, and their
+    // fields, whose types carry the qualifiers, so the copies repeated by
+    // every unit including a header are merged by comparing hashes.
+    // A definition replaces forward declarations. C allows distinct types of
+    // the same name in different units, hence a definition that differs from
+    // the one of the program is renamed to `<name>.<unit>` together with the
+    // types referring to it in its unit. Renamed types are reported once the
+    // program is finished, with one note for every renamed definition.
+    //
+    // Data layout entries of all units are merged, so that types of later
+    // units keep their layout. Different entries of a type are errors.
+    //
+    struct program_linker
+    {
+        explicit program_linker(mcontext_t &mctx);
+
+        // Links the top-level operations of the module, which is left empty.
+        // Errors are reported to the diagnostic handlers of the context and
+        // linking continues with the first definition of a name.
+        logical_result add(vast_module mod);
+
+        // The linked program, verified, after reporting conflicting types. The
+        // linker cannot be used afterwards.
+        owning_module_ref finish();
+
+        const link_stats &stats() const { return _stats; }
+
+      private:
+        friend unit_symbols external_symbols(vast_module mod);
+
+        enum class strength { declaration, available_externally, weak, strong, internal };
+
+        struct symbol_entry
+        {
+            operation op;
+            strength kind;
+            unsigned unit;
+        };
+
+        struct type_entry
+        {
+            operation op;
+            llvm::hash_code hash;
+
+            // new names and locations of the definitions of other units that
+            // differ from this one
+            llvm::SmallVector< std::pair< std::string, mlir::Location >, 1 > conflicts;
+        };
+
+        using type_table = llvm::StringMap< type_entry >;
+
+        static strength strength_of(operation op);
+
+        // Renames internal symbols of the unit, and symbols of the program,
+        // whose names collide.
+        void rename_internals(vast_module mod);
+
+        // Renames tags and typedefs of the unit whose definitions differ from
+        // the ones of the program, together with the types referring to them.
+        void rename_conflicting_types(vast_module mod);
+
+        // Adds the data layout entries of the unit to the ones of the program.
+        // Entries of the same type that differ are reported as errors.
+        logical_result merge_data_layout(vast_module mod);
+
+        void link_global(operation op, string_ref name, strength kind);
+        void link_type(type_table &table, operation op, string_ref name);
+
+        static bool same_definition(const type_entry &entry, operation op);
+
+        void report_conflicts();
+
+        std::string unique_name(string_ref name, unsigned unit) const;
+        std::string unique_type_name(const type_table &table, string_ref name, unsigned unit) const;
+
+        void move_to_program(operation op);
+
+        owning_module_ref _program;
+
+        // functions and variables
+        llvm::StringMap< symbol_entry > _globals;
+
+        // records, enums and their forward declarations, and typedefs, which
+        // live in separate namespaces
+        type_table _tags;
+        type_table _typedefs;
+
+        // types with conflicts, in the order of their first conflict
+        std::vector< const type_table::MapEntryTy * > _conflicting;
+
+        unsigned _unit = 0;
+        link_stats _stats;
+    };
+
+    //
+    // Links the modules of the files in their order. Modules are parsed in
+    // parallel, at most `window` of them ahead of the one being linked, so
+    // the memory does not grow with the number of inputs beyond the program
+    // itself.
+    //
+    owning_module_ref link_files(
+        mcontext_t &mctx, llvm::ArrayRef< std::string > files, unsigned window, link_stats *stats = nullptr
+    );
+
+    //
+    // Parses the modules of the files in their order and passes each of them
+    // to the callback, which may empty it. Modules are parsed in parallel, at
+    // most `window` of them ahead of the one being processed.
+    //
+    logical_result parse_files(
+        mcontext_t &mctx, llvm::ArrayRef< std::string > files, unsigned window,
+        llvm::function_ref< logical_result(std::size_t, vast_module) > process
+    );
+
+    //
+    // Assigns translation units to partitions, so that the units of
+    // a partition can be linked and analysed on their own node, and nodes
+    // exchange only the summaries of the functions referenced across
+    // partitions. Units are placed from the largest, by the number of the
+    // symbols they define, into the partition with the most references to
+    // or from the unit, among the partitions the unit does not fill above
+    // the average size by more than a quarter. Ties go to the smallest
+    // partition.
+    //
+    std::vector< unsigned > partition_units(llvm::ArrayRef< unit_symbols > units, unsigned partitions);
+
+    // Number of references resolved by a unit of another partition.
+    std::size_t cross_partition_references(
+        llvm::ArrayRef< unit_symbols > units, llvm::ArrayRef< unsigned > partition
+    );
+
+} // namespace vast::link
@@ -25,11 +25,22 @@ namespace mlir
 
 namespace vast::target::llvmir
 {
+    enum class translation_mode
+    {
+        serial,
+        // Function bodies are translated concurrently on the thread pool of
+        // the MLIR context and linked into a single module. Falls back to the
+        // serial translation if the context is not multithreaded.
+        parallel
+    };
+
     // Lower module into `llvm::Module` - it is expected that `mlir_module` is already
     // lowered as much as possible by vast (for example by calling the `prepare_module`
-    // function).
+    // function). Translations have to be registered in the context beforehand by
+    // `register_vast_to_llvm_ir`.
     std::unique_ptr< llvm::Module > translate(
-        vast_module mlir_module, llvm::LLVMContext &llvm_ctx
+        vast_module mlir_module, llvm::LLVMContext &llvm_ctx,
+        translation_mode mode = translation_mode::serial
     );
 
     void register_vast_to_llvm_ir(mlir::DialectRegistry &registry);
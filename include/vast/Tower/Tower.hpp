@@ -5,25 +5,152 @@
 #include "vast/Util/Common.hpp"
 
 VAST_RELAX_WARNINGS
+#include <mlir/IR/IRMapping.h>
+#include <mlir/IR/Threading.h>
 #include <mlir/Pass/PassManager.h>
+#include <llvm/ADT/DenseMap.h>
 VAST_UNRELAX_WARNINGS
 
+#include <limits>
+
 namespace vast::tw {
 
-    struct default_loc_rewriter_t
+    using op_position = std::uint32_t;
+
+    static constexpr op_position no_position = std::numeric_limits< op_position >::max();
+
+    //
+    // Pre-order numbering of the operations of a resident layer. Positions do
+    // not change when the layer is spilled and loaded again, so provenance
+    // tables refer to operations by their positions.
+    //
+    struct op_numbering
+    {
+        explicit op_numbering(vast_module mod);
+
+        auto op(op_position pos) const -> mlir::Operation * { return ops[pos]; }
+
+        auto position(mlir::Operation *op) const -> op_position {
+            auto it = positions.find(op);
+            return it != positions.end() ? it->second : no_position;
+        }
+
+        auto size() const -> std::size_t { return ops.size(); }
+
+      private:
+        std::vector< mlir::Operation * > ops;
+        llvm::DenseMap< mlir::Operation *, op_position > positions;
+    };
+
+    //
+    // Operations of a layer its clone was made from, recorded right after
+    // cloning. Clones are recognized by the position, name and location of
+    // their original, and the remaining operations by their location, so the
+    // layer can be spilled while the passes run on the clone.
+    //
+    struct clone_origins
+    {
+        clone_origins(const op_numbering &source, const mlir::IRMapping &mapping);
+
+        struct origin_t
+        {
+            op_position pos;
+            mlir::OperationName name;
+            mlir::Location loc;
+        };
+
+        llvm::DenseMap< mlir::Operation *, origin_t > clones;
+        llvm::DenseMap< mlir::Location, op_position > by_loc;
+    };
+
+    //
+    // Maps operations of a layer to the operations of the previous layer they
+    // were derived from. The table is built from the mapping of the clone of
+    // the previous layer, locations of the operations are left untouched.
+    //
+    // Passes can neither be observed by a listener, nor can they report the
+    // operations they replace. Cloned operations that survive the passes are
+    // recognized by their name and location, operations created by the
+    // passes are mapped through their location, which rewrites propagate
+    // from the replaced operations. The table, together with the reverse
+    // index, is resolved right after the passes, before the previous layer
+    // can be spilled.
+    //
+    struct default_provenance_t
     {
-        static auto insert(mlir::Operation *op) -> void;
-        static auto remove(mlir::Operation *op) -> void;
-        static auto prev(mlir::Operation *op) -> mlir::Operation *;
+        default_provenance_t() = default;
+
+        default_provenance_t(const op_numbering &layer, const clone_origins &origins);
+
+        // Table of a saved layer, the predecessors of its operations by their
+        // positions.
+        explicit default_provenance_t(std::vector< op_position > ops);
+
+        auto entries() const -> llvm::ArrayRef< op_position > { return ops; }
+
+        // `no_position` if the operation has no known predecessor.
+        auto prev(op_position pos) const -> op_position;
+
+        // Operations of the layer derived from the operation of the previous
+        // layer at `pos`.
+        auto next(op_position pos) const -> llvm::ArrayRef< op_position >;
+
+        // Links the operations of the layer to the predecessors of their
+        // previous operations, whose layer is about to be released.
+        auto skip(const default_provenance_t &released) -> void;
+
+      private:
+        auto index() -> void;
+
+        std::vector< op_position > ops;
+        llvm::DenseMap< op_position, llvm::SmallVector< op_position, 1 > > derived;
     };
 
+    // Serializes the module to bytecode in a temporary file.
+    auto spill_module(vast_module mod) -> std::string;
+
+    // Loads the spilled module back and removes its file.
+    auto load_spilled_module(mcontext_t &ctx, const std::string &path) -> owning_module_ref;
+
+    auto drop_spilled_module(const std::string &path) -> void;
+
+    //
+    // Files of a saved tower: a manifest of the live and released layers,
+    // and the bytecode and provenance table of every live layer.
+    //
+    auto saved_layer_path(const std::string &dir, std::size_t id, string_ref kind) -> std::string;
+
+    auto save_module(vast_module mod, const std::string &path) -> logical_result;
+
+    auto save_spilled_module(const std::string &spilled, const std::string &path) -> logical_result;
+
+    // Copies the saved module to a temporary file, which is then loaded like
+    // a spilled layer, so the saved tower stays intact.
+    auto restore_spilled_module(const std::string &path) -> std::optional< std::string >;
+
+    auto save_positions(llvm::ArrayRef< op_position > positions, const std::string &path)
+        -> logical_result;
+
+    auto restore_positions(const std::string &path) -> std::optional< std::vector< op_position > >;
+
+    auto save_manifest(const std::string &dir, const std::vector< bool > &live) -> logical_result;
+
+    // Whether the layers of the saved tower are live, by their ids.
+    auto restore_manifest(const std::string &dir) -> std::optional< std::vector< bool > >;
+
+    // Loads dialects the passes depend on, which is not allowed once passes
+    // run concurrently.
+    auto load_dependent_dialects(mlir::PassManager &pm) -> void;
+
     using pass_ptr_t = std::unique_ptr< mlir::Pass >;
 
-    template< typename loc_rewriter_t >
+    template< typename provenance_t >
     struct tower
     {
-        using loc_rewriter = loc_rewriter_t;
+        using provenance = provenance_t;
 
+        // The module of a handle stays valid only until its layer is spilled,
+        // `module` returns the current one.
         struct handle_t
         {
             std::size_t id;
@@ -33,25 +160,122 @@ namespace vast::tw {
         static auto get(mcontext_t &ctx, owning_module_ref mod)
             -> std::tuple< tower, handle_t > {
             tower t(ctx, std::move(mod));
-            handle_t h{ .id = 0, .mod = t._modules[0].get() };
+            handle_t h{ .id = 0, .mod = t._layers[0].mod.get() };
             return { std::move(t), h };
         }
 
-        auto apply(handle_t handle, mlir::PassManager &pm) -> handle_t {
-            handle.mod.walk(loc_rewriter::insert);
+        tower(tower &&) = default;
+        tower &operator=(tower &&) = default;
+
+        ~tower() {
+            for (auto &layer : _layers) {
+                if (!layer.spilled.empty()) {
+                    drop_spilled_module(layer.spilled);
+                }
+            }
+        }
+
+        //
+        // Clone of a layer the passes run on outside of the tower, e.g., on
+        // another thread while the tower is used. The clone becomes a new
+        // layer once it is committed.
+        //
+        struct pending_layer
+        {
+            std::size_t source;
+            owning_module_ref mod;
+            std::optional< clone_origins > origins;
+        };
+
+        auto fork(handle_t handle) -> pending_layer {
+            VAST_CHECK(!is_released(handle), "layer {0} was released", handle.id);
+            auto &source = load(handle.id);
+
+            mlir::IRMapping mapping;
+            owning_module_ref mod(mlir::cast< vast_module >(source.mod.get()->clone(mapping)));
+            return { handle.id, std::move(mod), clone_origins(*source.numbering, mapping) };
+        }
 
-            _modules.emplace_back(mlir::cast< vast_module >(handle.mod->clone()));
+        auto commit(pending_layer pending) -> handle_t {
+            VAST_CHECK(!is_released({ pending.source, {} }), "layer {0} was released", pending.source);
 
-            auto id  = _modules.size() - 1;
-            auto mod = _modules.back().get();
+            auto mod = pending.mod.get();
+            op_numbering numbering(mod);
+            provenance_t table(numbering, *pending.origins);
+            _layers.push_back({ std::move(pending.mod), std::move(numbering), std::move(table) });
 
-            if (mlir::failed(pm.run(mod))) {
+            auto id = _layers.size() - 1;
+            touch(id);
+            enforce_budget(id);
+            return { id, mod };
+        }
+
+        auto apply(handle_t handle, mlir::PassManager &pm) -> handle_t {
+            auto pending = fork(handle);
+            if (mlir::failed(pm.run(pending.mod.get()))) {
                 VAST_FATAL("some pass in apply() failed");
             }
 
-            handle.mod.walk(loc_rewriter::remove);
+            return commit(std::move(pending));
+        }
 
-            return { id, mod };
+        //
+        // Applies each of the pass managers to its own clone of the layer. The
+        // clones are made up front, then the branches run concurrently on the
+        // thread pool of the context. Returns handles of the new layers in the
+        // order of the pass managers, once all branches finish.
+        //
+        auto apply_many(handle_t handle, llvm::ArrayRef< mlir::PassManager * > pms)
+            -> llvm::SmallVector< handle_t >
+        {
+            VAST_CHECK(!is_released(handle), "layer {0} was released", handle.id);
+            const auto &source = load(handle.id);
+
+            struct branch_t
+            {
+                mlir::PassManager *pm;
+                owning_module_ref mod;
+                std::optional< clone_origins > origins;
+                std::optional< layer_t > layer;
+            };
+
+            std::vector< branch_t > branches(pms.size());
+            for (auto [branch, pm] : llvm::zip(branches, pms)) {
+                mlir::IRMapping mapping;
+                branch.pm  = pm;
+                branch.mod = mlir::cast< vast_module >(source.mod.get()->clone(mapping));
+                branch.origins.emplace(*source.numbering, mapping);
+                load_dependent_dialects(*pm);
+            }
+
+            auto result = mlir::failableParallelForEach(_ctx, branches, [&] (branch_t &branch) {
+                auto mod = branch.mod.get();
+                if (mlir::failed(branch.pm->run(mod))) {
+                    return mlir::failure();
+                }
+
+                op_numbering numbering(mod);
+                provenance_t table(numbering, *branch.origins);
+                branch.layer = layer_t{ std::move(branch.mod), std::move(numbering), std::move(table) };
+                return mlir::success();
+            });
+
+            if (mlir::failed(result)) {
+                VAST_FATAL("some pass in apply_many() failed");
+            }
+
+            // Layers are added only after all branches finish, so the storage
+            // is not shared between threads.
+            llvm::SmallVector< handle_t > handles;
+            for (auto &branch : branches) {
+                _layers.push_back(std::move(*branch.layer));
+                auto id = _layers.size() - 1;
+                touch(id);
+                handles.push_back({ id, _layers.back().mod.get() });
+            }
+
+            enforce_budget(_layers.size() - 1);
+            return handles;
         }
 
         auto apply(handle_t handle, pass_ptr_t pass) -> handle_t {
@@ -60,19 +284,285 @@ namespace vast::tw {
             return apply(handle, pm);
         }
 
-        auto top() -> handle_t { return { _modules.size(), _modules.back().get() }; }
+        // The top layer is never spilled.
+        auto top() -> handle_t { return { _layers.size() - 1, _layers.back().mod.get() }; }
+
+        // Loads the layer back, if it was spilled.
+        auto module(handle_t handle) -> vast_module {
+            VAST_CHECK(!is_released(handle), "layer {0} was released", handle.id);
+            return load(handle.id).mod.get();
+        }
+
+        // Live layers, from the oldest one to the top. Modules of spilled
+        // layers are null.
+        auto layers() const -> llvm::SmallVector< handle_t > {
+            llvm::SmallVector< handle_t > result;
+            for (std::size_t id = 0; id < _layers.size(); ++id) {
+                if (!_layers[id].is_released()) {
+                    result.push_back({ id, _layers[id].mod.get() });
+                }
+            }
+            return result;
+        }
+
+        // Operation of the previous live layer the `op` of the `handle` layer
+        // was derived from, null if there is none.
+        auto prev(handle_t handle, mlir::Operation *op) -> mlir::Operation * {
+            if (handle.id == 0) {
+                return nullptr;
+            }
+            return ancestor(handle, op, { prev_live(handle.id), {} });
+        }
+
+        // Operation of the `to` layer the `op` of the `from` layer originates
+        // from, null if there is none. The `to` layer precedes the `from` one.
+        auto ancestor(handle_t from, mlir::Operation *op, handle_t to) -> mlir::Operation * {
+            VAST_CHECK(to.id <= from.id, "layer {0} does not precede layer {1}", to.id, from.id);
+            auto pos = load(from.id).numbering->position(op);
+            for (auto id = from.id; pos != no_position && id > to.id; id = prev_live(id)) {
+                pos = _layers[id].provenance.prev(pos);
+            }
+
+            if (pos == no_position) {
+                return nullptr;
+            }
+            return load(to.id).numbering->op(pos);
+        }
+
+        // Operations of the `to` layer derived from the `op` of the `from`
+        // layer. The `to` layer follows the `from` one.
+        auto descendants(handle_t from, mlir::Operation *op, handle_t to)
+            -> llvm::SmallVector< mlir::Operation * >
+        {
+            VAST_CHECK(from.id <= to.id, "layer {0} does not follow layer {1}", to.id, from.id);
+            llvm::SmallVector< op_position > positions = { load(from.id).numbering->position(op) };
+            if (positions.front() == no_position) {
+                return {};
+            }
+
+            for (auto id = next_live_id(from.id); id <= to.id && !positions.empty(); id = next_live_id(id)) {
+                llvm::SmallVector< op_position > derived;
+                for (auto pos : positions) {
+                    llvm::append_range(derived, _layers[id].provenance.next(pos));
+                }
+                positions = std::move(derived);
+            }
+
+            const auto &numbering = *load(to.id).numbering;
+            llvm::SmallVector< mlir::Operation * > result;
+            for (auto pos : positions) {
+                result.push_back(numbering.op(pos));
+            }
+            return result;
+        }
+
+        //
+        // Every layer is a full copy of the module, so layers that are not
+        // needed anymore (e.g., intermediate results of a pipeline) can be
+        // released to bound the memory of long lowering sessions. The layer
+        // keeps its position in the tower, the following layer is relinked
+        // to the previous operations of the released one.
+        //
+        auto release(handle_t handle) -> void {
+            VAST_CHECK(handle.id + 1 < _layers.size(), "the top layer cannot be released");
+            VAST_CHECK(!is_released(handle), "layer {0} was already released", handle.id);
+
+            auto &released = _layers[handle.id];
+            next_live(handle.id).provenance.skip(released.provenance);
+            if (!released.spilled.empty()) {
+                drop_spilled_module(released.spilled);
+            }
+            released = {};
+        }
+
+        auto is_released(handle_t handle) const -> bool { return _layers[handle.id].is_released(); }
+
+        // Number of operations of a resident layer, none if it is spilled.
+        auto size(handle_t handle) const -> std::optional< std::size_t > {
+            const auto &layer = _layers[handle.id];
+            if (!layer.numbering) {
+                return std::nullopt;
+            }
+            return layer.numbering->size();
+        }
+
+        //
+        // Bounds the number of operations of resident layers. When the budget
+        // is exceeded, layers that were not used for the longest time are
+        // spilled to bytecode and transparently loaded back once a handle of
+        // theirs is used. No budget keeps all layers in memory.
+        //
+        auto set_budget(std::optional< std::size_t > ops) -> void {
+            _budget = ops;
+            enforce_budget(_layers.size() - 1);
+        }
+
+        auto budget() const -> std::optional< std::size_t > { return _budget; }
+
+        //
+        // Saves the live layers with their provenance tables to `dir`.
+        // Spilled layers are copied without being loaded.
+        //
+        auto save(const std::string &dir) const -> logical_result {
+            std::vector< bool > live;
+            for (std::size_t id = 0; id < _layers.size(); ++id) {
+                const auto &layer = _layers[id];
+                live.push_back(!layer.is_released());
+                if (layer.is_released()) {
+                    continue;
+                }
+
+                auto path = saved_layer_path(dir, id, "mlirbc");
+                auto saved = layer.is_resident()
+                    ? save_module(layer.mod.get(), path)
+                    : save_spilled_module(layer.spilled, path);
+                if (mlir::failed(saved)) {
+                    return mlir::failure();
+                }
+
+                auto table = saved_layer_path(dir, id, "provenance");
+                if (mlir::failed(save_positions(layer.provenance.entries(), table))) {
+                    return mlir::failure();
+                }
+            }
+
+            return save_manifest(dir, live);
+        }
+
+        //
+        // Tower saved to `dir`. Only the top layer is loaded, the others stay
+        // spilled until they are used.
+        //
+        static auto restore(mcontext_t &ctx, const std::string &dir) -> std::optional< tower > {
+            auto live = restore_manifest(dir);
+            if (!live || live->empty() || !live->back()) {
+                return std::nullopt;
+            }
+
+            tower t(ctx);
+            for (std::size_t id = 0; id < live->size(); ++id) {
+                if (!(*live)[id]) {
+                    t._layers.emplace_back();
+                    continue;
+                }
+
+                auto positions = restore_positions(saved_layer_path(dir, id, "provenance"));
+                auto spilled   = restore_spilled_module(saved_layer_path(dir, id, "mlirbc"));
+                if (!positions || !spilled) {
+                    return std::nullopt;
+                }
+
+                t._layers.push_back({
+                    owning_module_ref(), std::nullopt,
+                    provenance_t(std::move(*positions)), std::move(*spilled)
+                });
+            }
+
+            t.load(t._layers.size() - 1);
+            return t;
+        }
 
       private:
-        using module_storage_t = llvm::SmallVector< owning_module_ref, 2 >;
+        struct layer_t
+        {
+            owning_module_ref mod;
+            std::optional< op_numbering > numbering;
+            provenance_t provenance;
+
+            // bytecode file of a spilled layer
+            std::string spilled;
+            std::size_t last_use = 0;
+
+            bool is_resident() const { return bool(mod); }
+            bool is_released() const { return !mod && spilled.empty(); }
+        };
+
+        using layer_storage_t = llvm::SmallVector< layer_t, 2 >;
+
+        auto next_live_id(std::size_t id) const -> std::size_t {
+            while (++id < _layers.size() && _layers[id].is_released()) {}
+            return id;
+        }
+
+        // The top layer is never released.
+        auto next_live(std::size_t id) -> layer_t & { return _layers[next_live_id(id)]; }
+
+        auto prev_live(std::size_t id) const -> std::size_t {
+            while (id > 0 && _layers[--id].is_released()) {}
+            return id;
+        }
+
+        auto touch(std::size_t id) -> void { _layers[id].last_use = ++_clock; }
+
+        auto load(std::size_t id) -> layer_t & {
+            auto &layer = _layers[id];
+            if (!layer.is_resident()) {
+                layer.mod = load_spilled_module(*_ctx, layer.spilled);
+                layer.numbering.emplace(layer.mod.get());
+                layer.spilled.clear();
+            }
+
+            touch(id);
+            enforce_budget(id);
+            return layer;
+        }
+
+        auto spill(std::size_t id) -> void {
+            auto &layer = _layers[id];
+            layer.spilled = spill_module(layer.mod.get());
+            layer.numbering.reset();
+            layer.mod = owning_module_ref();
+        }
+
+        // Neither the top layer nor the `pinned` one are spilled.
+        auto enforce_budget(std::size_t pinned) -> void {
+            if (!_budget) {
+                return;
+            }
+
+            auto resident = [&] {
+                std::size_t ops = 0;
+                for (const auto &layer : _layers) {
+                    ops += layer.numbering ? layer.numbering->size() : 0;
+                }
+                return ops;
+            };
+
+            while (resident() > *_budget) {
+                std::optional< std::size_t > victim;
+                for (std::size_t id = 0; id + 1 < _layers.size(); ++id) {
+                    if (id == pinned || !_layers[id].is_resident()) {
+                        continue;
+                    }
+
+                    if (!victim || _layers[id].last_use < _layers[*victim].last_use) {
+                        victim = id;
+                    }
+                }
+
+                if (!victim) {
+                    return;
+                }
+
+                spill(*victim);
+            }
+        }
 
         mcontext_t *_ctx;
-        module_storage_t _modules;
+        layer_storage_t _layers;
+
+        std::optional< std::size_t > _budget;
+        std::size_t _clock = 0;
+
+        explicit tower(mcontext_t &ctx) : _ctx(&ctx) {}
 
         tower(mcontext_t &ctx, owning_module_ref mod) : _ctx(&ctx) {
-            _modules.emplace_back(std::move(mod));
+            op_numbering numbering(mod.get());
+            _layers.push_back({ std::move(mod), std::move(numbering), provenance_t() });
+            touch(0);
         }
     };
 
-    using default_tower = tower< default_loc_rewriter_t >;
+    using default_tower = tower< default_provenance_t >;
 
 } // namespace vast::tw
@@ -0,0 +1,101 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace vast::util
+{
+    //
+    // zstd compression of bytecode artifacts, i.e., emitted modules and cache
+    // entries. Small modules repeat most of their contents, e.g., names of
+    // dialects and operations and types of common headers, so a dictionary
+    // trained on typical modules (`zstd --train <modules> -o <dict>`)
+    // compresses them considerably better than frames without one.
+    //
+    // Frames record the id of their dictionary, hence plain bytecode, frames
+    // without a dictionary and frames of the loaded dictionary can be mixed
+    // freely. Without zstd (VAST_ENABLE_ZSTD), nothing is compressed and
+    // frames are not decompressed.
+    //
+#ifdef VAST_ENABLE_ZSTD
+    constexpr bool has_zstd = true;
+#else
+    constexpr bool has_zstd = false;
+#endif
+
+    constexpr int default_zstd_level = 3;
+
+    bool is_zstd_frame(string_ref bytes);
+
+    //
+    // Dictionary digested for the compression at a level and for the
+    // decompression once, so that frames of small modules do not pay for it.
+    //
+    struct zstd_dictionary
+    {
+        ~zstd_dictionary();
+
+        // Dictionaries are loaded once per process, null if the file cannot
+        // be read or zstd is not available.
+        static std::shared_ptr< const zstd_dictionary > load(string_ref path, int level);
+
+        unsigned id() const { return dict_id; }
+
+        ZSTD_CDict_s *compression_dict() const { return cdict; }
+        ZSTD_DDict_s *decompression_dict() const { return ddict; }
+
+      private:
+        zstd_dictionary(std::string bytes, int level);
+
+        std::string bytes;
+        unsigned dict_id = 0;
+        ZSTD_CDict_s *cdict = nullptr;
+        ZSTD_DDict_s *ddict = nullptr;
+    };
+
+    using zstd_dictionary_ptr = std::shared_ptr< const zstd_dictionary >;
+
+    // Dictionary shipped with the tools, i.e., the file of the VAST_ZSTD_DICT
+    // environment variable, null if it is not set.
+    zstd_dictionary_ptr default_zstd_dictionary(int level = default_zstd_level);
+
+    // Returns nothing without zstd support. With a dictionary, the level it
+    // was loaded with applies.
+    std::optional< std::string > zstd_compress(
+        string_ref bytes, int level, const zstd_dictionary *dict = nullptr
+    );
+
+    // Returns nothing if the bytes are not a complete frame or the frame
+    // needs a dictionary other than `dict`.
+    std::optional< std::string > zstd_decompress(
+        string_ref bytes, const zstd_dictionary *dict = nullptr
+    );
+
+    //
+    // Compression of the bytecode written by a tool, e.g., by the frontend
+    // with -vast-bytecode-zstd[=<level>] and -vast-zstd-dict=<path>.
+    //
+    struct bytecode_compression
+    {
+        // level of the written frames, plain bytecode is written without it
+        std::optional< int > level;
+        zstd_dictionary_ptr dict;
+
+        // Returns the bytes unchanged if they are not compressed or the frame
+        // would not be smaller.
+        std::string compress(std::string bytes) const;
+
+        // Plain bytecode is passed through, frames are decompressed. Returns
+        // nothing if a frame cannot be decompressed.
+        std::optional< std::string > decompress(std::string bytes) const;
+    };
+
+} // namespace vast::util
@@ -0,0 +1,55 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/SHA256.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace vast
+{
+    //
+    // SHA-256 of a sequence of strings and integers, used to key cache
+    // entries. Strings are prefixed by their size, so that the hash of
+    // a sequence does not depend on how its parts are split, and integers
+    // are encoded in little endian, so that keys are equal across hosts.
+    //
+    struct content_hasher
+    {
+        void add(string_ref data) {
+            add(std::uint64_t(data.size()));
+            sha.update(data);
+        }
+
+        void add(std::uint64_t value) {
+            std::array< std::uint8_t, sizeof(value) > bytes;
+            for (auto &byte : bytes) {
+                byte = std::uint8_t(value);
+                value >>= 8;
+            }
+            sha.update(bytes);
+        }
+
+        // Lower case hexadecimal digest, the hasher cannot be used afterwards.
+        std::string finish() { return llvm::toHex(sha.final(), /* lower case */ true); }
+
+      private:
+        llvm::SHA256 sha;
+    };
+
+    inline std::string content_hash(string_ref data) {
+        content_hasher hash;
+        hash.add(data);
+        return hash.finish();
+    }
+
+} // namespace vast
@@ -14,16 +14,18 @@ VAST_RELAX_WARNINGS
 #include <mlir/Interfaces/DataLayoutInterfaces.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+
 #include "vast/Util/Common.hpp"
+#include "vast/Util/TargetLayouts.hpp"
 
 #include <type_traits>
 
 namespace vast::dl {
-    // We are currently using `DLTI` dialect to help encoding data layout information,
-    // however in the future custom attributes will be probably preferable.
-    // Each entry is mapping `hl::Type -> uint32_t` and in the IR it is encoded as
-    // attribute of `ModuleOp`.
-    // TODO(lukas): Add alignment information & possibly ABI lowering relevant info?
+    // We are currently using `DLTI` dialect to help encoding data layout information.
+    // Each entry is mapping `hl::Type -> core::DataLayoutValueAttr` and in the IR it
+    // is encoded as attribute of `ModuleOp`.
+    // TODO(lukas): Add preferred alignment & possibly ABI lowering relevant info?
     struct DLEntry
     {
         using bitwidth_t = uint32_t;
@@ -35,21 +37,33 @@ namespace vast::dl {
         DLEntry(mlir_type type, bitwidth_t bw, bitwidth_t abi_align)
             : type(type), bw(bw), abi_align(abi_align) {}
 
+        DLEntry(mlir_type type, core::DataLayoutValueAttr value)
+            : type(type), bw(value.getBw()), abi_align(value.getAbiAlign()) {}
+
         DLEntry(mlir_type type, mlir::DictionaryAttr dict_attr)
             : type(type)
             , bw(extract(dict_attr, bw_key()))
             , abi_align(extract(dict_attr, abi_align_key())) {}
 
+        DLEntry(mlir_type type, mlir_attr value)
+            : DLEntry(from_value(type, value))
+        {}
+
         DLEntry(const mlir::DataLayoutEntryInterface &attr)
-            : DLEntry(
-                mlir::dyn_cast< mlir_type >(attr.getKey()),
-                mlir::dyn_cast< mlir::DictionaryAttr >(attr.getValue())
-            ) {
+            : DLEntry(mlir::dyn_cast< mlir_type >(attr.getKey()), attr.getValue()) {
             VAST_ASSERT(type);
         }
 
       private:
-        static mlir_type bw_type(mcontext_t &mctx) { return mlir::IntegerType::get(&mctx, 32); }
+        static DLEntry from_value(mlir_type type, mlir_attr value) {
+            if (auto dl_value = mlir::dyn_cast< core::DataLayoutValueAttr >(value)) {
+                return DLEntry(type, dl_value);
+            }
+
+            // Modules emitted before data layout values were introduced
+            // encode the entries as dictionaries.
+            return DLEntry(type, mlir::dyn_cast< mlir::DictionaryAttr >(value));
+        }
 
         static llvm::StringRef bw_key() { return "vast.dl.bw"; }
 
@@ -66,24 +80,9 @@ namespace vast::dl {
             return static_cast< bitwidth_t >(int_attr.getInt());
         }
 
-        mlir::StringAttr wrap_str(mcontext_t &mctx, llvm::StringRef str_value) const {
-            return mlir::StringAttr::get(&mctx, str_value);
-        }
-
       public:
         mlir::Attribute create_raw_attr(mcontext_t &mctx) const {
-            // TODO(lukas): There is `UI64Attr` in `IR/OpBase.td` not sure how to include it
-            //              though.
-            auto to_attr = [&](auto what) {
-                return mlir::IntegerAttr::get(bw_type(mctx), llvm::APInt(32, what));
-            };
-
-            std::array< mlir::NamedAttribute, 2 > all = {
-                mlir::NamedAttribute(wrap_str(mctx, bw_key()), to_attr(bw)),
-                mlir::NamedAttribute(wrap_str(mctx, abi_align_key()), to_attr(abi_align))
-            };
-
-            return mlir::DictionaryAttr::get(&mctx, all);
+            return core::DataLayoutValueAttr::get(&mctx, bw, abi_align);
         }
 
         // Wrap information in this object as `mlir::Attribute`, which is not attached yet
@@ -99,11 +98,32 @@ namespace vast::dl {
     struct DataLayoutBlueprint
     {
         bool try_emplace(mlir_type mty, const clang::Type *aty, const acontext_t &actx) {
+            if (entries.count(mty)) {
+                return false;
+            }
+
+            // Builtins and pointers of tabulated targets skip the clang query.
+            if (auto target = target_of(actx)) {
+                if (auto layout = lookup(*target, aty)) {
+                    return add_new(mty, layout->bw, layout->abi_align);
+                }
+            }
+
             // For other types this should be good-enough for now
             auto info      = actx.getTypeInfo(aty);
             auto bw        = static_cast< uint32_t >(info.Width);
             auto abi_align = static_cast< uint32_t >(info.Align);
-            return std::get< 1 >(entries.try_emplace(mty, dl::DLEntry{ mty, bw, abi_align }));
+            return add_new(mty, bw, abi_align);
+        }
+
+        // Adds entries of all tabulated builtins in one step, `type_of` maps
+        // a builtin kind to its type or returns null type if it has none.
+        void add_builtins(const target_layout &target, auto &&type_of) {
+            for (const auto &builtin : target.builtins) {
+                if (auto mty = type_of(builtin.kind)) {
+                    add(mty, dl::DLEntry{ mty, builtin.layout.bw, builtin.layout.abi_align });
+                }
+            }
         }
 
         void add(mlir_type type, dl::DLEntry entry) {
@@ -126,6 +146,21 @@ namespace vast::dl {
         }
 
         llvm::DenseMap< mlir_type, dl::DLEntry > entries;
+
+      private:
+        bool add_new(mlir_type mty, uint32_t bw, uint32_t abi_align) {
+            return std::get< 1 >(entries.try_emplace(mty, dl::DLEntry{ mty, bw, abi_align }));
+        }
+
+        const target_layout *target_of(const acontext_t &actx) {
+            if (!target) {
+                target = target_layout_for(actx.getTargetInfo().getTriple());
+            }
+            return *target;
+        }
+
+        // Table of the target of the translation unit, resolved on first use.
+        std::optional< const target_layout * > target;
     };
 
     template< typename Stream >
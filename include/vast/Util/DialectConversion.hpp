@@ -3,6 +3,8 @@
 #pragma once
 
 VAST_RELAX_WARNINGS
+#include <mlir/IR/Threading.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
 #include <mlir/Transforms/DialectConversion.h>
 VAST_UNRELAX_WARNINGS
 
@@ -18,6 +20,34 @@ namespace vast
 
 namespace vast::util
 {
+    // Functions with a body nested in `root`, excluding nested functions.
+    static inline llvm::SmallVector< operation > defined_functions(operation root) {
+        llvm::SmallVector< operation > functions;
+        root->walk< mlir::WalkOrder::PreOrder >([&] (mlir::FunctionOpInterface fn) {
+            if (!fn.isExternal())
+                functions.push_back(fn);
+            return mlir::WalkResult::skip();
+        });
+        return functions;
+    }
+
+    //
+    // Applies partial conversion to every function defined in `root`
+    // separately. Functions are converted in parallel if multithreading is
+    // enabled in the context, hence patterns may rewrite only the body of the
+    // function they are applied to and state they share has to be synchronized.
+    //
+    static inline logical_result apply_partial_conversion_per_function(
+        operation root,
+        const mlir::ConversionTarget &target,
+        const mlir::FrozenRewritePatternSet &patterns
+    ) {
+        auto functions = defined_functions(root);
+        return mlir::failableParallelForEach(root->getContext(), functions, [&] (operation fn) {
+            return mlir::applyPartialConversion(fn, target, patterns);
+        });
+    }
+
     template< typename Op >
     struct State
     {
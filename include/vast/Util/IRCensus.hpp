@@ -0,0 +1,45 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast {
+
+    //
+    // Census of an IR subtree (-vast-ir-census): operations per name, regions
+    // and blocks, and distinct types, attributes and locations reachable from
+    // the subtree, including the nested ones, per dialect.
+    //
+    // The MLIR context does not expose its uniqued storage, hence the
+    // distinct types and attributes are those the subtree uses, and storage
+    // sizes are estimates of the in-memory layouts of the operations and of
+    // the location attributes.
+    //
+    struct ir_census
+    {
+        llvm::StringMap< std::size_t > ops;
+        std::size_t regions = 0;
+        std::size_t blocks  = 0;
+        std::size_t op_bytes = 0;
+
+        llvm::StringMap< std::size_t > types;
+        llvm::StringMap< std::size_t > attrs;
+
+        // locations by their kind, e.g., FusedLoc
+        llvm::StringMap< std::size_t > locs;
+        std::size_t loc_bytes = 0;
+
+        static ir_census of(operation root);
+
+        void print(llvm::raw_ostream &os, string_ref step) const;
+    };
+
+} // namespace vast
@@ -0,0 +1,117 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/PatternMatch.h>
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace vast {
+
+    //
+    // Changes made to the IR by a single pass. Rewrites are counted by the
+    // listener of the patterns, the net change is measured around the runs
+    // of the pass. Conversions may run on several functions concurrently,
+    // hence the counters are atomic.
+    //
+    struct churn_counters
+    {
+        std::atomic< std::uint64_t > created  = 0;
+        // erased operations include the replaced ones
+        std::atomic< std::uint64_t > erased   = 0;
+        std::atomic< std::uint64_t > replaced = 0;
+        std::atomic< std::uint64_t > modified = 0;
+        std::atomic< std::uint64_t > blocks   = 0;
+
+        std::atomic< std::int64_t > net_ops    = 0;
+        std::atomic< std::int64_t > net_blocks = 0;
+    };
+
+    //
+    // Process-wide registry of the churn counters, rewrites are observed only
+    // if the collection is enabled.
+    //
+    namespace ir_churn {
+
+        bool enabled();
+        void enable(bool value = true);
+
+        churn_counters &counters(string_ref pass);
+
+        // Prints the counters of the passes, ordered by the number of
+        // the changes they made.
+        void print(llvm::raw_ostream &os);
+
+        void reset();
+
+    } // namespace ir_churn
+
+    //
+    // Counts the notifications of a rewriter and forwards them to the
+    // listener it replaced, i.e., to the conversion or greedy driver, which
+    // keeps track of the rewrites as before.
+    //
+    struct churn_listener : mlir::RewriterBase::Listener
+    {
+        churn_listener(churn_counters &counters, mlir::OpBuilder::Listener *next)
+            : counters(counters), next(next)
+        {}
+
+        void notifyOperationInserted(operation op) override;
+        void notifyBlockCreated(mlir::Block *block) override;
+
+        void notifyOperationModified(operation op) override;
+        void notifyOperationReplaced(operation op, operation replacement) override;
+        void notifyOperationReplaced(operation op, mlir::ValueRange replacement) override;
+        void notifyOperationRemoved(operation op) override;
+
+        logical_result notifyMatchFailure(
+            mlir::Location loc, llvm::function_ref< void(mlir::Diagnostic &) > reason
+        ) override;
+
+      private:
+        mlir::RewriterBase::Listener *next_rewrite_listener() const {
+            return llvm::dyn_cast_if_present< mlir::RewriterBase::Listener >(next);
+        }
+
+        churn_counters &counters;
+        mlir::OpBuilder::Listener *next;
+    };
+
+    //
+    // Enables the collection of IR churn for the passes of the owning pass
+    // manager, measures the net change of every pass and prints the
+    // counters to stderr once it is destroyed.
+    //
+    struct ir_churn_instrumentation : mlir::PassInstrumentation
+    {
+        ir_churn_instrumentation() { ir_churn::enable(); }
+
+        ~ir_churn_instrumentation() override;
+
+        void runBeforePass(mlir::Pass *pass, operation op) override;
+        void runAfterPass(mlir::Pass *pass, operation op) override;
+        void runAfterPassFailed(mlir::Pass *pass, operation op) override;
+
+      private:
+        struct ir_size { std::int64_t ops = 0, blocks = 0; };
+
+        static ir_size measure(operation root);
+
+        std::mutex mutex;
+        // sizes of the operations before the passes that run on them
+        llvm::DenseMap< std::pair< mlir::Pass *, operation >, ir_size > before;
+    };
+
+} // namespace vast
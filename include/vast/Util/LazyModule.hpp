@@ -0,0 +1,52 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeReader.h>
+#include <mlir/IR/Block.h>
+#include <mlir/Parser/Parser.h>
+#include <llvm/Support/SourceMgr.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::util
+{
+    //
+    // Module read from bytecode with the regions of isolated operations,
+    // e.g., function bodies, left in the buffer until they are materialized.
+    // Operations that are not materialized yet have empty regions, hence
+    // clients materialize what they are going to look into first.
+    //
+    struct lazy_module
+    {
+        // Null if the buffer does not hold a bytecode module.
+        static std::unique_ptr< lazy_module > open(
+            std::shared_ptr< llvm::SourceMgr > source_mgr, mcontext_t *ctx
+        );
+
+        vast_module get() const { return mod.get(); }
+
+        // Materializes operations accepted by the predicate, also nested in
+        // materialized operations, until no such operation is left.
+        logical_result materialize(llvm::function_ref< bool(operation) > should_materialize);
+
+        logical_result materialize_all();
+
+        bool is_materialized() const { return finalized; }
+
+      private:
+        lazy_module(std::shared_ptr< llvm::SourceMgr > source_mgr, mcontext_t *ctx);
+
+        std::shared_ptr< llvm::SourceMgr > source_mgr;
+        mlir::ParserConfig config;
+        mlir::BytecodeReader reader;
+        mlir::Block top;
+        owning_module_ref mod;
+        bool finalized = false;
+    };
+
+} // namespace vast::util
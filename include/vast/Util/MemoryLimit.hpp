@@ -0,0 +1,72 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLFunctionalExtras.h>
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Pipeline.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace vast {
+
+    //
+    // Budget of the resident memory of the process (-vast-memory-limit=<MB>).
+    //
+    // Exceeding the budget is a fatal error naming the work in progress. The
+    // error makes the driver generate crash diagnostics, i.e., the
+    // preprocessed input, and if it happens in the vast pipeline with
+    // -vast-emit-crash-reproducer, also the reproducer of the pipeline.
+    //
+    struct memory_limit
+    {
+        explicit memory_limit(std::int64_t limit_kb) : limit_kb(limit_kb) {}
+
+        // Reports the fatal error if the resident memory exceeds the budget,
+        // the description of the work in progress is built only then.
+        void check(llvm::function_ref< std::string() > where) const;
+
+        // Checks every `period` calls in the current scope, reading the
+        // resident memory is too costly to be done on every visited node.
+        void tick() {
+            if (++ticks % period == 0) {
+                check([&] { return scope; });
+            }
+        }
+
+        static constexpr unsigned period = 1024;
+
+        std::int64_t limit_kb;
+
+        // description of the work in progress, e.g., codegen of a declaration
+        std::string scope;
+        unsigned ticks = 0;
+    };
+
+    //
+    // Checks the budget before and after every pass, on any thread.
+    //
+    struct memory_limit_instrumentation : mlir::PassInstrumentation
+    {
+        memory_limit_instrumentation(const pipeline_t &ppl, memory_limit limit)
+            : ppl(ppl), limit(std::move(limit))
+        {}
+
+        void runBeforePass(mlir::Pass *pass, operation op) final;
+        void runAfterPass(mlir::Pass *pass, operation op) final;
+
+      private:
+        void check(mlir::Pass *pass, operation op, string_ref when) const;
+
+        const pipeline_t &ppl;
+        const memory_limit limit;
+    };
+
+} // namespace vast
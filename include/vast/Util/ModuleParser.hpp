@@ -0,0 +1,34 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/SourceMgr.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::util
+{
+    //
+    // Parses the main buffer of the source manager as a module. Large textual
+    // modules, as printed by MLIR, are split at the top-level operations of
+    // the module into one chunk per thread and the chunks are parsed
+    // concurrently. Every chunk is parsed with the aliases defined at the
+    // start of the file and the location aliases it uses, and keeps the line
+    // and column of the operations in the file.
+    //
+    // Bytecode, small modules, modules that do not have the printed layout
+    // and modules whose chunks do not parse on their own, e.g., because of
+    // values defined by other chunks, are parsed sequentially. The module is
+    // verified after all chunks were merged. Compressed bytecode is
+    // decompressed with the dictionary shipped with the tools.
+    //
+    owning_module_ref parse_module(llvm::SourceMgr &source_mgr, mcontext_t *ctx);
+
+    // Textual modules smaller than this are always parsed sequentially.
+    constexpr std::size_t parallel_parse_threshold = 1 << 20;
+
+} // namespace vast::util
@@ -0,0 +1,34 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/OperationSupport.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::util
+{
+    //
+    // Prints the module with its top-level operations printed concurrently,
+    // each into its own buffer, on the thread pool of the context. Buffers
+    // are written to the stream in the order of the operations, as single
+    // large writes, in batches of a few operations per thread, so the memory
+    // does not grow with the size of the output.
+    //
+    // Operations are printed in local scope: values are numbered within
+    // every isolated region, as in the full module, but operations do not
+    // use the aliases of the module, whose definitions are printed only for
+    // the module itself. The output parses to the same module as the output
+    // of `mod->print`.
+    //
+    // Without multithreading, operations are printed sequentially in the
+    // same way.
+    //
+    void print_module(vast_module mod, llvm::raw_ostream &os, mlir::OpPrintingFlags flags);
+
+} // namespace vast::util
@@ -0,0 +1,70 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/PatternMatch.h>
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+namespace vast {
+
+    //
+    // Counters of a single rewrite pattern in a single pass. Conversions may
+    // run on several functions concurrently, hence the counters are atomic.
+    //
+    struct pattern_counters
+    {
+        std::atomic< std::uint64_t > attempts    = 0;
+        std::atomic< std::uint64_t > successes   = 0;
+        std::atomic< std::uint64_t > failures    = 0;
+        std::atomic< std::uint64_t > nanoseconds = 0;
+    };
+
+    //
+    // Process-wide registry of the pattern counters. Passes wrap their
+    // patterns only if the collection is enabled, otherwise patterns run
+    // without any instrumentation.
+    //
+    namespace pattern_stats {
+
+        bool enabled();
+        void enable(bool value = true);
+
+        pattern_counters &counters(string_ref pass, string_ref pattern);
+
+        // Prints the counters grouped by passes, patterns of each pass
+        // ordered by their total time.
+        void print(llvm::raw_ostream &os);
+
+        void reset();
+
+    } // namespace pattern_stats
+
+    // Wraps every native pattern of `patterns`, so that its applications are
+    // counted in the registry under `pass`, as is the churn of the pass (see
+    // IRChurn.hpp). Does nothing unless either collection is enabled.
+    // Patterns are named by their debug names, which default to the names of
+    // their classes.
+    void count_pattern_applications(mlir::RewritePatternSet &patterns, string_ref pass);
+
+    //
+    // Enables the collection of pattern statistics for the passes of the
+    // owning pass manager and prints them to stderr once it is destroyed.
+    //
+    struct pattern_stats_instrumentation : mlir::PassInstrumentation
+    {
+        pattern_stats_instrumentation() { pattern_stats::enable(); }
+
+        ~pattern_stats_instrumentation() override;
+    };
+
+} // namespace vast
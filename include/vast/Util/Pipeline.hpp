@@ -5,7 +5,9 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringSet.h>
 #include <mlir/IR/DialectRegistry.h>
 #include <mlir/Pass/PassManager.h>
 #include <mlir/Pass/PassRegistry.h>
@@ -16,6 +18,10 @@ VAST_UNRELAX_WARNINGS
 
 #include "gap/core/generator.hpp"
 
+#include <functional>
+#include <map>
+#include <mutex>
+
 namespace vast {
 
     //
@@ -29,10 +35,16 @@ namespace vast {
     using pipeline_step_ptr = std::unique_ptr< pipeline_step >;
 
 
+    using pipeline_step_builder = std::function< pipeline_step_ptr(void) >;
+
     //
     // pipeline is a pass manager, which keeps track of duplicit passes and does
     // not schedule them twice
     //
+    // Passes are deduplicated by their anchor and textual form including
+    // options, so the same pass can be scheduled multiple times with different
+    // options.
+    //
     struct pipeline_t : mlir::PassManager
     {
         using base      = mlir::PassManager;
@@ -44,22 +56,75 @@ namespace vast {
 
         template< typename parent_t >
         void addNestedPass(std::unique_ptr< mlir::Pass > pass) {
-            auto id = pass->getTypeID();
-            if (seen.count(id)) {
+            if (!mark_seen(parent_t::getOperationName(), *pass)) {
+                return;
+            }
+
+            // Pipelines anchored on the parent operation itself (e.g., per
+            // function pipelines) run the pass directly.
+            if (getOpName() == parent_t::getOperationName()) {
+                base::addPass(std::move(pass));
                 return;
             }
 
-            seen.insert(id);
             base::addNestedPass< parent_t >(std::move(pass));
         }
 
+        // Verifies the operation at this point of the pipeline, regardless of
+        // the passes scheduled before.
+        void add_checkpoint();
+
+        // Prints the census of the operation (-vast-ir-census) after the step.
+        void add_census(string_ref step);
+
+        // Returns name of the top-level pipeline step that scheduled the pass.
+        string_ref step_of(pass_id_t id) const;
+
+        // Schedules step resolved from the builder, unless it was already
+        // scheduled to this pipeline.
+        void schedule(const pipeline_step_builder &builder);
+
         friend pipeline_t &operator<<(pipeline_t &ppl, pipeline_step_ptr pass);
 
-        llvm::DenseSet< pass_id_t > seen;
+        // Returns false if the pass was already scheduled.
+        bool mark_seen(string_ref anchor, mlir::Pass &pass);
+
+        llvm::StringSet<> seen;
+
+        // steps already scheduled to this pipeline
+        llvm::DenseSet< const pipeline_step * > scheduled;
+        // steps being scheduled, used to detect dependency cycles
+        llvm::DenseSet< const pipeline_step * > scheduling;
+
+        // name of the top-level step that is being scheduled
+        std::string scheduled_step;
+        llvm::DenseMap< pass_id_t, std::string > step_of_pass;
     };
 
+    //
+    // Process-wide memoization of pipeline steps. Steps created by plain
+    // builder functions are built only once and shared by all pipelines (e.g.,
+    // pipelines of different translation units). The planner resolves
+    // dependencies through the memoized steps, so the dependency graph is
+    // constructed only once.
+    //
+    struct pipeline_planner
+    {
+        using step_builder_fn = pipeline_step_ptr (*)();
 
-    using pipeline_step_builder = std::function< pipeline_step_ptr(void) >;
+        static pipeline_planner &instance();
+
+        // Returns memoized step for the builder. Steps of builders that are
+        // not plain functions (i.e., capturing lambdas) cannot be identified,
+        // hence are built on each request and owned by `owned`.
+        const pipeline_step *resolve(
+            const pipeline_step_builder &builder, pipeline_step_ptr &owned
+        );
+
+      private:
+        std::mutex mutex;
+        std::map< step_builder_fn, pipeline_step_ptr > steps;
+    };
 
     //
     // initilizer wrapper to setup dependencies after make is called
@@ -108,12 +173,14 @@ namespace vast {
         std::vector< pipeline_step_builder > dependencies;
     };
 
-    using pass_builder_t = llvm::function_ref< std::unique_ptr< mlir::Pass >(void) >;
+    // Owned by the step, as memoized steps outlive the builders they were
+    // created from.
+    using pass_builder_t = std::function< std::unique_ptr< mlir::Pass >(void) >;
 
     struct pass_pipeline_step : pipeline_step
     {
         explicit pass_pipeline_step(pass_builder_t builder)
-            : pass_builder(builder)
+            : pass_builder(std::move(builder)), pass_name(pass_builder()->getName().str())
         {}
 
         void schedule_on(pipeline_t &ppl) const override;
@@ -122,13 +189,15 @@ namespace vast {
 
     protected:
         pass_builder_t pass_builder;
+        // cached, so that querying the name does not construct the pass
+        std::string pass_name;
     };
 
     template< typename parent_t >
     struct nested_pass_pipeline_step : pass_pipeline_step
     {
         explicit nested_pass_pipeline_step(pass_builder_t builder)
-            : pass_pipeline_step(builder)
+            : pass_pipeline_step(std::move(builder))
         {}
 
         void schedule_on(pipeline_t &ppl) const override {
@@ -0,0 +1,110 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/Timer.h>
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Pipeline.hpp"
+
+#include <mutex>
+
+namespace vast {
+
+    //
+    // Number of operations and distinct types and attributes in an IR subtree.
+    //
+    struct ir_counts
+    {
+        std::int64_t ops   = 0;
+        std::int64_t types = 0;
+        std::int64_t attrs = 0;
+
+        static ir_counts of(operation root);
+    };
+
+    //
+    // Statistics accumulated over all runs of a single pass. Nested passes run
+    // once per anchor operation, hence the counts are sums over all runs.
+    //
+    struct pass_stats
+    {
+        std::string name;
+        std::string step;
+
+        unsigned runs = 0;
+
+        double wall_seconds = 0;
+        double cpu_seconds  = 0;
+
+        ir_counts delta;
+
+        std::int64_t peak_rss_kb       = 0;
+        std::int64_t peak_rss_delta_kb = 0;
+
+        llvm::json::Object to_json() const;
+    };
+
+    //
+    // Pass instrumentation that records wall time, cpu time, changes of IR
+    // size and peak RSS per pass and groups them by the top-level pipeline step
+    // that scheduled the pass.
+    //
+    // The report is written to `path` as JSON when the instrumentation is
+    // destroyed, i.e., together with the owning pass manager.
+    //
+    struct pipeline_stats_instrumentation : mlir::PassInstrumentation
+    {
+        pipeline_stats_instrumentation(const pipeline_t &ppl, std::string path)
+            : ppl(ppl), path(std::move(path))
+        {}
+
+        ~pipeline_stats_instrumentation() override;
+
+        void runBeforePass(mlir::Pass *pass, operation op) override;
+        void runAfterPass(mlir::Pass *pass, operation op) override;
+        void runAfterPassFailed(mlir::Pass *pass, operation op) override;
+
+        llvm::json::Value report() const;
+
+      private:
+        struct snapshot
+        {
+            llvm::TimeRecord time;
+            double cpu_seconds;
+            ir_counts counts;
+            std::int64_t peak_rss_kb;
+        };
+
+        void record(mlir::Pass *pass, operation op);
+
+        const pipeline_t &ppl;
+        std::string path;
+
+        std::mutex mutex;
+
+        llvm::DenseMap< std::pair< mlir::Pass *, operation >, snapshot > running;
+
+        // passes in order of their first execution
+        std::vector< pass_stats > passes;
+        llvm::DenseMap< mlir::TypeID, std::size_t > pass_index;
+    };
+
+    std::int64_t current_peak_rss_kb();
+
+    // Returns cpu time consumed by the calling thread, or by the whole
+    // process, taken from `fallback`, if the platform has no thread clock.
+    double current_thread_cpu_seconds(const llvm::TimeRecord &fallback);
+
+    // Resident set size of the process, the peak one where the current one
+    // is not available.
+    std::int64_t current_rss_kb();
+
+} // namespace vast
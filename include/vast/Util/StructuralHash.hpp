@@ -0,0 +1,79 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Operation.h>
+#include <mlir/IR/Region.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vast::util
+{
+    struct hash128
+    {
+        std::uint64_t low  = 0;
+        std::uint64_t high = 0;
+
+        // 32 lower case hexadecimal digits, the high half first.
+        std::string str() const;
+
+        bool operator==(const hash128 &) const = default;
+    };
+
+    //
+    // Structural hash of operations, equal for operations that differ only
+    // in locations, attributes of the meta dialect, e.g., identifiers of
+    // the clang declarations, and names of their values. Values are
+    // numbered by the order of their definitions and blocks by their order
+    // in the region, so that equal operations of distinct modules, contexts
+    // or runs hash equally.
+    //
+    // Types and attributes are hashed by their printed form once per hasher.
+    // Every region is hashed on its own, values defined above it are
+    // numbered in the order of their first use in it, and the hash is cached,
+    // so that hashing an enclosing operation reuses the hashes of the regions
+    // hashed before. The cache refers to the regions, hence the hasher must
+    // not outlive changes of the hashed operations.
+    //
+    struct structural_hasher
+    {
+        // The symbol name of `op` is not hashed if `ignore_symbol_name` is
+        // set, e.g., to compare functions regardless of their names.
+        hash128 hash(operation op, bool ignore_symbol_name = false);
+
+        hash128 hash(mlir::Region &region);
+
+      private:
+        struct region_entry
+        {
+            hash128 hash;
+            // Values defined above the region in the order of their first use.
+            llvm::SmallVector< mlir_value, 4 > captures;
+        };
+
+        struct encoder;
+
+        const region_entry &region(mlir::Region &region);
+
+        std::uint64_t type_hash(mlir_type type);
+        std::uint64_t attr_hash(mlir_attr attr);
+
+        llvm::DenseMap< mlir::Region *, region_entry > regions;
+        llvm::DenseMap< mlir_type, std::uint64_t > types;
+        llvm::DenseMap< mlir_attr, std::uint64_t > attrs;
+    };
+
+    // Hash of `op` with a fresh hasher.
+    hash128 structural_hash(operation op, bool ignore_symbol_name = false);
+
+} // namespace vast::util
@@ -6,6 +6,8 @@
 
 VAST_RELAX_WARNINGS
 #include <mlir/IR/SymbolTable.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/StringMap.h>
 #include <llvm/Support/raw_ostream.h>
 VAST_UNRELAX_WARNINGS
 
@@ -64,14 +66,136 @@ namespace vast::util
         }
     };
 
-    void yield_users(string_ref symbol, auto scope, auto &&yield) {
-        auto filter_symbols = [&](auto op) {
-            if (util::symbol_name(op) == symbol) {
-                yield_symbol_users(op, scope, std::forward< decltype(yield) >(yield));
+    //
+    // Symbols of a scope and their uses, collected in a single walk, so that
+    // queries walk neither the symbols nor the scope again.
+    //
+    // Vast symbols are used through their results, hence their users come
+    // from the use lists. Uses of mlir symbols are symbol references in
+    // attributes, which resolve the same way as
+    // `SymbolTable::lookupNearestSymbolFrom`: the root reference names
+    // a symbol of the nearest enclosing symbol table defining it, nested
+    // references name symbols of the tables of their parent symbols.
+    //
+    // The index does not observe the scope, it has to be rebuilt once the
+    // scope changes. It can be used as an analysis.
+    //
+    struct symbol_index
+    {
+        explicit symbol_index(mlir::Operation *scope) {
+            scope->walk([&] (mlir::Operation *op) {
+                if (auto symbol = mlir::dyn_cast< vast_symbol_interface >(op)) {
+                    add(symbol, symbol_name(symbol));
+                } else if (auto symbol = mlir::dyn_cast< mlir_symbol_interface >(op)) {
+                    add(symbol, symbol_name(symbol));
+                }
+            });
+
+            // Nested references are resolved together with their root.
+            scope->walk([&] (mlir::Operation *op) {
+                op->getAttrDictionary().walk< mlir::WalkOrder::PreOrder >([&] (mlir::SymbolRefAttr ref) {
+                    if (auto symbol = resolve(op, ref)) {
+                        uses[symbol].push_back(op);
+                    }
+                    return mlir::WalkResult::skip();
+                });
+            });
+        }
+
+        // Yields symbols of the scope in the order of the walk, like
+        // `util::symbols`.
+        void symbols(auto &&yield) const {
+            for (auto op : all) {
+                if (auto symbol = mlir::dyn_cast< vast_symbol_interface >(op)) {
+                    yield(symbol);
+                } else {
+                    yield(mlir::cast< mlir_symbol_interface >(op));
+                }
+            }
+        }
+
+        // Symbols of the name in any symbol table of the scope.
+        llvm::ArrayRef< mlir::Operation * > lookup(string_ref name) const {
+            if (auto it = by_name.find(name); it != by_name.end()) {
+                return it->second;
+            }
+            return {};
+        }
+
+        void users(mlir::Operation *symbol, auto &&yield) const {
+            if (mlir::isa< vast_symbol_interface >(symbol)) {
+                for (auto user : symbol->getUsers()) {
+                    yield(user);
+                }
+            }
+
+            if (auto it = uses.find(symbol); it != uses.end()) {
+                for (auto user : it->second) {
+                    yield(user);
+                }
+            }
+        }
+
+        // Users of all symbols of the name.
+        void users(string_ref name, auto &&yield) const {
+            for (auto symbol : lookup(name)) {
+                users(symbol, yield);
+            }
+        }
+
+      private:
+        using operations = llvm::SmallVector< mlir::Operation *, 1 >;
+
+        static mlir::Operation *symbol_table_of(mlir::Operation *op) {
+            for (auto parent = op->getParentOp(); parent; parent = parent->getParentOp()) {
+                if (parent->hasTrait< mlir::OpTrait::SymbolTable >()) {
+                    return parent;
+                }
             }
-        };
+            return nullptr;
+        }
 
-        util::symbols(scope, filter_symbols);
+        void add(mlir::Operation *symbol, string_ref name) {
+            all.push_back(symbol);
+            by_name[name].push_back(symbol);
+            tables.try_emplace({ symbol_table_of(symbol), name }, symbol);
+        }
+
+        mlir::Operation *lookup_in(mlir::Operation *table, string_ref name) const {
+            if (auto it = tables.find({ table, name }); it != tables.end()) {
+                return it->second;
+            }
+            return nullptr;
+        }
+
+        mlir::Operation *resolve(mlir::Operation *user, mlir::SymbolRefAttr ref) const {
+            // The user itself can be the nearest symbol table.
+            auto table = user->hasTrait< mlir::OpTrait::SymbolTable >() ? user : symbol_table_of(user);
+
+            mlir::Operation *symbol = nullptr;
+            for (; table && !symbol; table = symbol_table_of(table)) {
+                symbol = lookup_in(table, ref.getRootReference());
+            }
+
+            for (auto nested : ref.getNestedReferences()) {
+                if (!symbol) {
+                    break;
+                }
+                symbol = lookup_in(symbol, nested.getValue());
+            }
+
+            return symbol;
+        }
+
+        std::vector< mlir::Operation * > all;
+        llvm::StringMap< operations > by_name;
+        llvm::DenseMap< std::pair< mlir::Operation *, llvm::StringRef >, mlir::Operation * > tables;
+        llvm::DenseMap< mlir::Operation *, operations > uses;
+    };
+
+    // For repeated queries, keep the `symbol_index` instead.
+    void yield_users(string_ref symbol, auto scope, auto &&yield) {
+        symbol_index(scope).users(symbol, std::forward< decltype(yield) >(yield));
     }
 
     std::string show_location(auto &value) {
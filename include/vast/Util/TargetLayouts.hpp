@@ -0,0 +1,144 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Type.h>
+#include <llvm/TargetParser/Triple.h>
+VAST_UNRELAX_WARNINGS
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace vast::dl {
+
+    //
+    // Sizes and alignments of builtin types are fixed by the ABI of the
+    // target, hence they are tabulated here instead of being asked from
+    // clang or decoded from data layout attributes of the module every time.
+    // Targets without a table fall back to the queries.
+    //
+    struct type_layout
+    {
+        using bitwidth_t = std::uint32_t;
+
+        bitwidth_t bw;
+        bitwidth_t abi_align;
+    };
+
+    struct builtin_layout
+    {
+        using kind_t = clang::BuiltinType::Kind;
+
+        kind_t kind;
+        type_layout layout;
+    };
+
+    struct target_layout
+    {
+        std::string_view name;
+        type_layout pointer;
+        std::span< const builtin_layout > builtins;
+
+        constexpr std::optional< type_layout > lookup(builtin_layout::kind_t kind) const {
+            for (const auto &entry : builtins) {
+                if (entry.kind == kind) {
+                    return entry.layout;
+                }
+            }
+            return std::nullopt;
+        }
+    };
+
+    namespace detail {
+        using kind = clang::BuiltinType::Kind;
+
+        // Types of the same size and alignment on both tables.
+        #define VAST_LP64_COMMON_BUILTINS \
+            builtin_layout{ kind::Bool,      {   8,   8 } }, \
+            builtin_layout{ kind::Char_S,    {   8,   8 } }, \
+            builtin_layout{ kind::Char_U,    {   8,   8 } }, \
+            builtin_layout{ kind::SChar,     {   8,   8 } }, \
+            builtin_layout{ kind::UChar,     {   8,   8 } }, \
+            builtin_layout{ kind::Short,     {  16,  16 } }, \
+            builtin_layout{ kind::UShort,    {  16,  16 } }, \
+            builtin_layout{ kind::Int,       {  32,  32 } }, \
+            builtin_layout{ kind::UInt,      {  32,  32 } }, \
+            builtin_layout{ kind::Long,      {  64,  64 } }, \
+            builtin_layout{ kind::ULong,     {  64,  64 } }, \
+            builtin_layout{ kind::LongLong,  {  64,  64 } }, \
+            builtin_layout{ kind::ULongLong, {  64,  64 } }, \
+            builtin_layout{ kind::Int128,    { 128, 128 } }, \
+            builtin_layout{ kind::UInt128,   { 128, 128 } }, \
+            builtin_layout{ kind::Half,      {  16,  16 } }, \
+            builtin_layout{ kind::Float,     {  32,  32 } }, \
+            builtin_layout{ kind::Double,    {  64,  64 } }, \
+            builtin_layout{ kind::NullPtr,   {  64,  64 } }
+
+        // x86-64 System V psABI, `long double` is the x87 80-bit extended
+        // precision type padded to 16 bytes.
+        inline constexpr std::array x86_64_sysv_builtins = {
+            VAST_LP64_COMMON_BUILTINS,
+            builtin_layout{ kind::LongDouble, { 128, 128 } },
+            builtin_layout{ kind::Float128,   { 128, 128 } },
+        };
+
+        // AAPCS64, `long double` is the IEEE quad precision type.
+        inline constexpr std::array aarch64_aapcs_builtins = {
+            VAST_LP64_COMMON_BUILTINS,
+            builtin_layout{ kind::LongDouble, { 128, 128 } },
+        };
+
+        #undef VAST_LP64_COMMON_BUILTINS
+    } // namespace detail
+
+    inline constexpr target_layout x86_64_sysv = {
+        "x86_64-sysv", { 64, 64 }, detail::x86_64_sysv_builtins
+    };
+
+    inline constexpr target_layout aarch64_aapcs = {
+        "aarch64-aapcs", { 64, 64 }, detail::aarch64_aapcs_builtins
+    };
+
+    static_assert(x86_64_sysv.lookup(clang::BuiltinType::Long)->bw == 64);
+    static_assert(aarch64_aapcs.lookup(clang::BuiltinType::LongDouble)->bw == 128);
+
+    // Table of the target, `nullptr` if it is not tabulated. Windows is LLP64
+    // and Darwin on arm64 uses 64-bit `long double`, both use the queries.
+    inline const target_layout *target_layout_for(const llvm::Triple &triple) {
+        if (triple.isOSWindows() || triple.isOSBinFormatCOFF()) {
+            return nullptr;
+        }
+
+        switch (triple.getArch()) {
+            case llvm::Triple::x86_64:
+                return triple.isX32() ? nullptr : &x86_64_sysv;
+            case llvm::Triple::aarch64:
+                if (triple.isOSDarwin() || triple.getEnvironment() == llvm::Triple::GNUILP32) {
+                    return nullptr;
+                }
+                return &aarch64_aapcs;
+            default:
+                return nullptr;
+        }
+    }
+
+    // Tabulated layout of `type`, `std::nullopt` for types that are not
+    // builtins or pointers.
+    inline std::optional< type_layout > lookup(const target_layout &target, const clang::Type *type) {
+        if (type->isPointerType() || type->isBlockPointerType()) {
+            return target.pointer;
+        }
+
+        if (auto builtin = llvm::dyn_cast< clang::BuiltinType >(type)) {
+            return target.lookup(builtin->getKind());
+        }
+
+        return std::nullopt;
+    }
+
+} // namespace vast::dl
@@ -0,0 +1,47 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include <chrono>
+
+namespace vast {
+
+    //
+    // Budget of the time spent on a single function (-vast-function-budget=<ms>).
+    //
+    // Unlike the memory budget, exceeding it is not an error. Work on the
+    // function stops early and its body is replaced by a stub, so that a few
+    // pathological functions do not hold up the whole translation unit.
+    //
+    struct time_budget
+    {
+        using clock = std::chrono::steady_clock;
+
+        explicit time_budget(std::chrono::milliseconds limit) : limit(limit) {}
+
+        void start() {
+            deadline  = clock::now() + limit;
+            ticks     = 0;
+            exhausted = false;
+        }
+
+        // Checks the clock every `period` calls since the start, so that it
+        // can be called on every visited node.
+        void tick() {
+            if (!exhausted && ++ticks % period == 0) {
+                exhausted = clock::now() >= deadline;
+            }
+        }
+
+        bool exceeded() const { return exhausted; }
+
+        static constexpr unsigned period = 256;
+
+        std::chrono::milliseconds limit;
+
+        clock::time_point deadline;
+        unsigned ticks = 0;
+        bool exhausted = false;
+    };
+
+} // namespace vast
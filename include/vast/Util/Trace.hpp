@@ -0,0 +1,139 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Pipeline.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace vast {
+
+    //
+    // Events of a Chrome trace (-vast-trace) recorded on any thread. The llvm
+    // time trace profiler, which clang uses for -ftime-trace, records only on
+    // threads it was initialized on, whereas nested pipelines run passes on
+    // the threads of the MLIR context. The recorded events are written along
+    // with the events of the profiler of the thread compiling the translation
+    // unit, as a single timeline.
+    //
+    // As the profiler, the recorder drops events shorter than the granularity.
+    //
+    struct trace_recorder
+    {
+        using clock = std::chrono::steady_clock;
+
+        explicit trace_recorder(unsigned granularity_us)
+            : granularity(granularity_us), origin(clock::now())
+        {}
+
+        void record(
+            std::string name, std::string category, std::string detail,
+            std::uint64_t tid, clock::time_point start, clock::time_point end
+        );
+
+        // Writes the events of the llvm profiler of the calling thread merged
+        // with the recorded ones, the profiler has to be enabled.
+        void write(llvm::raw_ostream &os) const;
+
+        // Recorder of the translation unit compiled on the calling thread.
+        static trace_recorder *current();
+
+      private:
+        struct event
+        {
+            std::string name;
+            std::string category;
+            std::string detail;
+            std::uint64_t tid;
+            clock::time_point start;
+            clock::time_point end;
+        };
+
+        std::chrono::microseconds granularity;
+
+        // Start of the timeline, taken right after the llvm profiler start,
+        // to which timestamps of its events are relative.
+        clock::time_point origin;
+
+        mutable std::mutex mutex;
+        std::vector< event > events;
+    };
+
+    //
+    // Makes the recorder current on the calling thread in its scope.
+    //
+    struct trace_recorder_scope
+    {
+        explicit trace_recorder_scope(trace_recorder *recorder);
+        ~trace_recorder_scope();
+
+        trace_recorder_scope(const trace_recorder_scope &) = delete;
+        trace_recorder_scope &operator=(const trace_recorder_scope &) = delete;
+
+      private:
+        trace_recorder *previous;
+    };
+
+    //
+    // Pass instrumentation that records every pass run, on whichever thread it
+    // runs, and spans of the top-level pipeline steps. Consecutive top-level
+    // passes of the same step on the same operation make a single span, which
+    // is recorded on the thread that set up the pipeline.
+    //
+    struct trace_instrumentation : mlir::PassInstrumentation
+    {
+        trace_instrumentation(const pipeline_t &ppl, trace_recorder &recorder);
+
+        ~trace_instrumentation() override;
+
+        void runBeforePass(mlir::Pass *pass, operation op) override;
+        void runAfterPass(mlir::Pass *pass, operation op) override;
+        void runAfterPassFailed(mlir::Pass *pass, operation op) override;
+
+      private:
+        using clock = trace_recorder::clock;
+
+        struct running_pass
+        {
+            mlir::Pass *pass;
+            operation op;
+            clock::time_point start;
+        };
+
+        struct step_span
+        {
+            std::string name;
+            std::string detail;
+            operation op = nullptr;
+            clock::time_point start;
+            clock::time_point end;
+        };
+
+        void finish(mlir::Pass *pass, operation op);
+        void close_step();
+
+        const pipeline_t &ppl;
+        trace_recorder &recorder;
+        std::uint64_t owner;
+
+        std::mutex mutex;
+
+        // Passes running on every thread, nested passes run on top of the
+        // pass adaptors that schedule them.
+        llvm::DenseMap< std::uint64_t, std::vector< running_pass > > running;
+
+        step_span step;
+    };
+
+} // namespace vast
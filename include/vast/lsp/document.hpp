@@ -0,0 +1,106 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Tools/lsp-server-support/Protocol.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Meta/MetaDialect.hpp"
+#include "vast/repl/codegen.hpp"
+
+#include <filesystem>
+
+namespace vast::lsp
+{
+    //
+    // C source open in the editor, with a warm VAST module of its latest
+    // version that compiles. The module holds declarations only, the body
+    // of a function is generated once a request needs it. Generated bodies
+    // are kept across edits for as long as the tokens of their function and
+    // of everything around them do not change, so an edit generates again
+    // only the bodies of the changed functions that are queried.
+    //
+    // Positions are zero-based, as in the protocol, and assume single-byte
+    // characters.
+    //
+    struct c_document
+    {
+        c_document(std::filesystem::path path, mcontext_t &mctx);
+
+        // Parses the new contents, returns false if they do not compile.
+        // Bodies generated for the last version that compiled keep answering
+        // requests meanwhile.
+        bool update(std::string contents, std::int64_t version);
+
+        std::int64_t version() const { return _version; }
+
+        const std::string &contents() const { return _contents; }
+
+        // The operation at the position, printed without its regions.
+        std::optional< mlir::lsp::Hover > hover(const mlir::lsp::Position &pos);
+
+        // Definitions of the functions, variables and globals referred to by
+        // the operation at the position.
+        std::vector< mlir::lsp::Location > definition(const mlir::lsp::Position &pos);
+
+        // Name of the function or global referred to or defined by the
+        // operation at the position.
+        std::optional< std::string > symbol_at(const mlir::lsp::Position &pos);
+
+        // The function defined around the position, with its body.
+        hl::FuncOp function_at(const mlir::lsp::Position &pos);
+
+      private:
+        struct function_body
+        {
+            unsigned line;
+            hl::FuncOp fn;
+
+            // built on demand, the positions of the body do not change
+            std::optional< meta::location_index > index;
+        };
+
+        struct function_lines
+        {
+            std::string name;
+            unsigned first;
+            unsigned last;
+        };
+
+        // Keeps generated bodies that match the fingerprint of the new
+        // version, moved to their new lines.
+        void carry_over_bodies(const repl::codegen::source_fingerprint &print);
+
+        function_body *body_of(string_ref name);
+
+        operation op_at(const mlir::lsp::Position &pos);
+
+        std::optional< mlir::Location > definition_of(string_ref symbol);
+
+        std::filesystem::path _path;
+        mcontext_t &_mctx;
+
+        std::string _contents;
+        std::int64_t _version = 0;
+
+        // Unit of a version that does not compile, kept for reparsing.
+        std::unique_ptr< clang::ASTUnit > _unit;
+        std::unique_ptr< repl::codegen::lazy_session > _session;
+        std::optional< repl::codegen::source_fingerprint > _print;
+
+        // function definitions of the main file, sorted by lines
+        std::vector< function_lines > _functions;
+
+        // locations of top-level symbols of the module of declarations
+        llvm::StringMap< mlir::Location > _definitions;
+
+        // bodies generated for any version, owned by their own module
+        owning_module_ref _bodies;
+        llvm::StringMap< function_body > _generated;
+    };
+
+} // namespace vast::lsp
@@ -0,0 +1,78 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Tooling/CompilationDatabase.h>
+#include <mlir/IR/DialectRegistry.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/ThreadPool.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/query/index.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace vast::lsp
+{
+    //
+    // Indexes the translation units of a compilation database in the
+    // background. Units are compiled on a bounded pool of threads running at
+    // background priority, each in its own context, and their symbols and
+    // uses are written in the format of `vast-query --build-index` to the
+    // cache directory. Index files are named by a hash of the contents of the
+    // main file, the command line and its directory, so units that did not
+    // change since a previous session are not compiled again. Changes of
+    // included headers alone do not invalidate the index.
+    //
+    struct project_indexer
+    {
+        project_indexer(mlir::DialectRegistry &registry, std::string cache, unsigned threads);
+
+        // Waits for the running units, the pending ones are skipped.
+        ~project_indexer();
+
+        // Schedules all units of the database, given by its file or its
+        // directory.
+        logical_result index(string_ref database, std::string &error);
+
+        // Users of the symbols of the name in all indexed units.
+        void users(string_ref name, auto &&yield) const {
+            std::lock_guard guard(lock);
+            for (const auto &unit : units) {
+                unit.getValue()->users(name, yield);
+            }
+        }
+
+        std::size_t indexed() const {
+            std::lock_guard guard(lock);
+            return units.size();
+        }
+
+        std::size_t scheduled() const { return total; }
+
+      private:
+        void index_unit(const clang::tooling::CompileCommand &cmd);
+
+        // Index file of the unit, empty if its source cannot be read.
+        std::string cache_path(const clang::tooling::CompileCommand &cmd, string_ref contents) const;
+
+        mlir::DialectRegistry &registry;
+        std::string cache;
+
+        std::unique_ptr< clang::tooling::CompilationDatabase > database;
+        std::size_t total = 0;
+
+        std::atomic< bool > cancelled = false;
+
+        // indices of the units, by their main file
+        mutable std::mutex lock;
+        llvm::StringMap< std::unique_ptr< query::index_file > > units;
+
+        llvm::ThreadPool pool;
+    };
+
+} // namespace vast::lsp
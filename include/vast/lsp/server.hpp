@@ -0,0 +1,23 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/DialectRegistry.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::lsp
+{
+    //
+    // Language server for C sources. Every open document keeps a warm module
+    // emitted by VAST, see `c_document`, and serves hover, go to definition
+    // and the `vast/functionHL` request, which returns the high-level module
+    // of the function around a position, from it.
+    //
+    logical_result c_server_main(int argc, char **argv, mlir::DialectRegistry &registry);
+
+} // namespace vast::lsp
@@ -0,0 +1,134 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/MemoryBuffer.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::query
+{
+    //
+    // Persistent index of a module answering symbol, use and location queries
+    // without parsing the module. The file is a flat array of little-endian
+    // 32-bit words, hence it is used directly from the memory mapped buffer:
+    //
+    //   magic, version, #symbols, #uses, #positions, #string bytes
+    //   symbols   { name, kind, location, function, flags, first use, #uses }
+    //             sorted by name
+    //   uses      { kind, location, function } grouped by their symbol
+    //   positions { file, line, column, kind, location, function }
+    //             sorted by file, line and column
+    //   strings   null-terminated, referred to by their offsets
+    //
+    // Operations are described by their name, printed location and the name
+    // of the enclosing function, the operations themselves are not stored.
+    //
+    logical_result build_index(vast_module mod, string_ref path);
+
+    struct index_symbol
+    {
+        string_ref name;
+        string_ref kind;
+        string_ref location;
+        string_ref function;
+        bool is_global;
+    };
+
+    struct index_operation
+    {
+        string_ref kind;
+        string_ref location;
+        string_ref function;
+    };
+
+    struct index_file
+    {
+        // Null if the file is missing or is not an index.
+        static std::unique_ptr< index_file > open(string_ref path, std::string &error);
+
+        void symbols(auto &&yield) const {
+            for (std::uint32_t i = 0; i < num_symbols(); ++i) {
+                yield(symbol(i));
+            }
+        }
+
+        // Users of all symbols of the name.
+        void users(string_ref name, auto &&yield) const {
+            for (auto i = lower_bound(name); i < num_symbols() && string(symbol_word(i, 0)) == name; ++i) {
+                auto first = symbol_word(i, 5);
+                for (auto u = first; u < first + symbol_word(i, 6); ++u) {
+                    yield(use(u));
+                }
+            }
+        }
+
+        // The zero column matches the whole line.
+        void at(string_ref file, unsigned line, unsigned column, auto &&yield) const {
+            for (auto i = lower_bound(file, line, column); i < num_positions(); ++i) {
+                if (string(position_word(i, 0)) != file || position_word(i, 1) != line) {
+                    break;
+                }
+
+                if (column != 0 && position_word(i, 2) != column) {
+                    break;
+                }
+
+                yield(position(i));
+            }
+        }
+
+      private:
+        using word = llvm::support::ulittle32_t;
+
+        static constexpr std::uint32_t symbol_words   = 7;
+        static constexpr std::uint32_t use_words      = 3;
+        static constexpr std::uint32_t position_words = 6;
+
+        explicit index_file(std::unique_ptr< llvm::MemoryBuffer > buffer)
+            : buffer(std::move(buffer))
+        {}
+
+        const word *words() const { return reinterpret_cast< const word * >(buffer->getBufferStart()); }
+
+        std::uint32_t num_symbols() const { return words()[2]; }
+        std::uint32_t num_uses() const { return words()[3]; }
+        std::uint32_t num_positions() const { return words()[4]; }
+
+        const word *symbols_begin() const { return words() + 6; }
+        const word *uses_begin() const { return symbols_begin() + num_symbols() * symbol_words; }
+        const word *positions_begin() const { return uses_begin() + num_uses() * use_words; }
+        const char *strings_begin() const {
+            return reinterpret_cast< const char * >(positions_begin() + num_positions() * position_words);
+        }
+
+        std::uint32_t symbol_word(std::uint32_t i, std::uint32_t field) const {
+            return symbols_begin()[i * symbol_words + field];
+        }
+
+        std::uint32_t use_word(std::uint32_t i, std::uint32_t field) const {
+            return uses_begin()[i * use_words + field];
+        }
+
+        std::uint32_t position_word(std::uint32_t i, std::uint32_t field) const {
+            return positions_begin()[i * position_words + field];
+        }
+
+        string_ref string(std::uint32_t offset) const { return strings_begin() + offset; }
+
+        index_symbol symbol(std::uint32_t i) const;
+        index_operation use(std::uint32_t i) const;
+        index_operation position(std::uint32_t i) const;
+
+        std::uint32_t lower_bound(string_ref name) const;
+        std::uint32_t lower_bound(string_ref file, unsigned line, unsigned column) const;
+
+        std::unique_ptr< llvm::MemoryBuffer > buffer;
+    };
+
+} // namespace vast::query
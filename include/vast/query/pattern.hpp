@@ -0,0 +1,113 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vast::query
+{
+    //
+    // Inverted index of the operations of a scope by their name, with
+    // a posting list of every name per function, in program order.
+    // Operations outside of functions, e.g., initializers of globals, have
+    // a list of their own. Functions are indexed in parallel.
+    //
+    struct op_index
+    {
+        explicit op_index(operation root);
+
+        std::size_t functions() const { return postings.size(); }
+
+        // Operations of the name in the function.
+        llvm::ArrayRef< operation > operations(std::size_t function, string_ref name) const {
+            const auto &list = postings[function];
+            if (auto it = list.find(name); it != list.end()) {
+                return it->second;
+            }
+            return {};
+        }
+
+        // All the operations of the function.
+        llvm::ArrayRef< operation > operations(std::size_t function) const { return all[function]; }
+
+        mcontext_t *context() const { return mctx; }
+
+      private:
+        using postings_t = llvm::DenseMap< string_ref, std::vector< operation > >;
+
+        mcontext_t *mctx;
+        std::vector< postings_t > postings;
+        std::vector< std::vector< operation > > all;
+    };
+
+    //
+    // Structural pattern of an operation:
+    //
+    //   pattern    := root [ '(' constraint { ',' constraint } ')' ]
+    //   root       := <operation name> | '*' | 'const' | 'param'
+    //   constraint := <attribute> ( '=' | '!=' ) <value>
+    //               | 'operand' <index> ( '=' | '!=' | '~' | '!~' ) pattern
+    //
+    // `*` matches any operation, `const` constant-like operations and
+    // `param` parameters of a function. An attribute matches its value by
+    // the string, the referenced symbol or the integer it holds, or by its
+    // printed form otherwise. An operand matches by `=` if it is defined by
+    // an operation matching the pattern, and by `~` if any value it is
+    // derived from by operands of the defining operations, including
+    // itself, matches the pattern. `!` negates the constraint.
+    //
+    // For example, calls of `memcpy` with a size that is not a constant:
+    //
+    //   hl.call(callee=memcpy,operand2!=const)
+    //
+    // or assignments through a pointer derived from a parameter:
+    //
+    //   hl.assign(operand1~hl.deref(operand0~param))
+    //
+    struct pattern
+    {
+        enum class root_kind { operation, any, constant, param };
+
+        struct constraint
+        {
+            std::string attribute;
+            std::optional< unsigned > operand;
+            bool negated = false;
+            bool derived = false;
+            std::string value;
+            std::unique_ptr< pattern > nested;
+        };
+
+        root_kind root = root_kind::any;
+        std::string name;
+        std::vector< constraint > constraints;
+
+        static std::optional< pattern > parse(string_ref text, std::string &error);
+
+        bool matches(operation op) const;
+        bool matches(mlir_value value) const;
+
+        // Values are derived from the values the pattern matches.
+        bool matches_derived(mlir_value value) const;
+    };
+
+    //
+    // Operations of the index matching the pattern, in the order of the
+    // functions and of the operations in them. Only the posting lists of the
+    // root name are matched, in parallel across functions.
+    //
+    std::vector< operation > match(const op_index &index, const pattern &pat);
+
+} // namespace vast::query
@@ -0,0 +1,30 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::query
+{
+    //
+    // Exports facts of a module as tables for analytics, one CSV file with a
+    // header row per table in the `dir` directory:
+    //
+    //   functions   { function, name, op, definition, ops }
+    //   ops         { op, function, parent, kind, file, line, column }
+    //   calls       { caller, callee, indirect }
+    //   symbol_uses { symbol, kind, op, user }
+    //   types       { type, size_bits, align_bits }
+    //
+    // Operations are identified by their pre-order position in the module,
+    // the module itself is operation 0, and functions by their node in the
+    // call graph. Operations outside of functions, e.g., globals, have an
+    // empty function. Locations are the first file location of the
+    // operation. Types are the entries of the data layout of the module.
+    //
+    // Rows of the operations and functions are formatted in parallel, in
+    // chunks written in the order of the module.
+    //
+    logical_result export_tables(vast_module mod, string_ref dir);
+
+} // namespace vast::query
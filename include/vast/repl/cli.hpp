@@ -26,11 +26,37 @@ namespace vast::repl
         }
 
         void exec(command_ptr cmd) try {
+            if (state.job && state.job->finished) {
+                cmd::finish_job(state);
+            }
+
+            if (cmd->controls_jobs()) {
+                return cmd->run(state);
+            }
+
+            if (cmd->changes_tower() && state.has_running_job()) {
+                llvm::errs() << "error: " << state.job->name << " is running, use `wait` or `cancel`\n";
+                return;
+            }
+
+            std::lock_guard guard(state.lock);
             cmd->run(state);
         } catch (std::exception &e) {
             llvm::errs() << "error: " << e.what() << '\n';
         }
 
+        // Runs long commands in the background.
+        void set_background(bool background) { state.background = background; }
+
+        // Returns false if there is no running job.
+        bool cancel_job() {
+            if (!state.has_running_job()) {
+                return false;
+            }
+            exec(std::make_unique< cmd::cancel >());
+            return true;
+        }
+
       private:
         state_t state;
     };
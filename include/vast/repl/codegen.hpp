@@ -9,10 +9,15 @@ VAST_RELAX_WARNINGS
 #include <clang/Frontend/ASTUnit.h>
 #include <clang/Tooling/Tooling.h>
 #include <mlir/IR/Builders.h>
+#include <llvm/ADT/Hashing.h>
+#include <llvm/ADT/StringMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/repl/common.hpp"
 #include "vast/CodeGen/CodeGen.hpp"
+#include "vast/CodeGen/CodeGenContext.hpp"
+#include "vast/CodeGen/CodeGenDriver.hpp"
+#include "vast/Frontend/Options.hpp"
 
 #include <filesystem>
 
@@ -20,6 +25,99 @@ namespace vast::repl::codegen {
 
     std::unique_ptr< clang::ASTUnit > ast_from_source(string_ref source);
 
-    owning_module_ref emit_module(const std::filesystem::path &source, mcontext_t *ctx);
+    //
+    // Parses the source into an AST unit that can be parsed again after the
+    // source changes. Includes at the start of the file are precompiled into
+    // a preamble on the first parse, so the following parses do not parse
+    // the headers again unless the includes change.
+    //
+    std::unique_ptr< clang::ASTUnit > parse_source(const std::filesystem::path &source);
+
+    // Parses the contents in place of the file, e.g., an unsaved editor buffer.
+    std::unique_ptr< clang::ASTUnit > parse_source(const std::filesystem::path &source, string_ref contents);
+
+    // Parses the source with the arguments of its compile command, starting
+    // with the compiler, run in the directory. No preamble is built.
+    std::unique_ptr< clang::ASTUnit > parse_command_line(
+        llvm::ArrayRef< std::string > args, string_ref directory
+    );
+
+    // Parses the current contents of the source into the unit again.
+    bool reparse_source(clang::ASTUnit &unit, const std::filesystem::path &source);
+
+    bool reparse_source(clang::ASTUnit &unit, const std::filesystem::path &source, string_ref contents);
+
+    //
+    // Hashes of the tokens of the source. Tokens of each function definition
+    // of the main file are hashed separately, with their positions relative
+    // to the first token. All other tokens of the main file, including the
+    // preprocessor directives, and the contents of the included files make up
+    // the context of the functions.
+    //
+    struct source_fingerprint {
+        struct function_print {
+            llvm::hash_code tokens;
+            // lines of the first and the last token
+            unsigned line;
+            unsigned last_line;
+        };
+
+        llvm::hash_code context;
+        llvm::StringMap< function_print > functions;
+
+        // The function of the fingerprint can be used in place of the one of
+        // the other fingerprint, only moved by a number of lines.
+        bool matches(const source_fingerprint &other, string_ref function) const;
+    };
+
+    source_fingerprint fingerprint(const clang::ASTUnit &unit);
+
+    // Moves the file locations of the operation by the number of lines.
+    void shift_locations(operation root, string_ref file, int lines);
+
+    //
+    // Keeps the clang AST of the source alive and emits only function
+    // declarations up front. Function bodies are generated on demand.
+    //
+    struct lazy_session {
+        lazy_session(std::unique_ptr< clang::ASTUnit > unit, mcontext_t &mctx);
+
+        // Returns null if there is no pending body of the function.
+        hl::FuncOp materialize(string_ref name);
+
+        bool has_lazy_body(string_ref name) const { return driver.has_lazy_body(name); }
+
+        // Generates all pending bodies, returns their number.
+        std::size_t materialize_all();
+
+        vast_module module() { return cgctx.mod.get(); }
+
+        const clang::ASTUnit &ast() const { return *unit; }
+
+        // Destroys the session, keeping its AST unit for reparsing.
+        static std::unique_ptr< clang::ASTUnit > take_unit(std::unique_ptr< lazy_session > session);
+
+      private:
+        std::unique_ptr< clang::ASTUnit > unit;
+
+        cc::codegen_options codegen_opts;
+        cc::frontend_options front_opts;
+        cc::action_options opts;
+        cc::vast_args vargs;
+
+        cg::codegen_context cgctx;
+        cg::codegen_driver driver;
+    };
+
+    // Reparses the unit of the previous session, if there is one.
+    std::unique_ptr< lazy_session > make_lazy_session(
+        const std::filesystem::path &source, mcontext_t &mctx,
+        std::unique_ptr< lazy_session > previous = nullptr
+    );
+
+    // Null if the unit does not compile, the unit is kept for reparsing.
+    std::unique_ptr< lazy_session > make_lazy_session(
+        std::unique_ptr< clang::ASTUnit > &unit, mcontext_t &mctx
+    );
 
 } // namespace vast::repl::codegen
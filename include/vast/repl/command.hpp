@@ -21,6 +21,7 @@ VAST_UNRELAX_WARNINGS
 #include <filesystem>
 #include <tuple>
 #include <span>
+#include <utility>
 
 namespace vast::repl
 {
@@ -34,6 +35,13 @@ namespace vast::repl
 
             virtual void run(state_t &) const = 0;
             virtual ~base(){};
+
+            // Commands that replace or extend the tower do not run while
+            // a job is running.
+            virtual bool changes_tower() const { return false; }
+
+            // Job control runs without the lock of the state.
+            virtual bool controls_jobs() const { return false; }
         };
 
         void check_source(const state_t &state);
@@ -44,6 +52,9 @@ namespace vast::repl
 
         void check_and_emit_module(state_t &state);
 
+        // Joins the finished job and reports its outcome.
+        void finish_job(state_t &state);
+
         //
         // params
         //
@@ -51,8 +62,12 @@ namespace vast::repl
         struct flag_param    { bool set; };
         struct string_param  { std::string value; };
         struct integer_param { std::uint64_t value; };
+        // consumes all remaining tokens
+        struct integers_param { llvm::SmallVector< std::int64_t > values; };
+        // consumes all remaining tokens
+        struct words_param { llvm::SmallVector< std::string > values; };
 
-        enum class show_kind { source, ast, module, symbols };
+        enum class show_kind { source, ast, module, symbols, provenance };
 
         template< typename enum_type >
         enum_type from_string(string_ref token) requires(std::is_same_v< enum_type, show_kind >) {
@@ -60,6 +75,7 @@ namespace vast::repl
             if (token == "ast")     return enum_type::ast;
             if (token == "module")  return enum_type::module;
             if (token == "symbols") return enum_type::symbols;
+            if (token == "provenance") return enum_type::provenance;
             VAST_FATAL("uknnown show kind: {0}", token.str());
         }
 
@@ -96,6 +112,30 @@ namespace vast::repl
                 return { param };
             }
 
+            static constexpr bool is_integers_param = std::is_same_v< base, integers_param >;
+            static named_param parse(std::span< string_ref > tokens) requires(is_integers_param) {
+                integers_param param;
+                for (auto token : tokens) {
+                    std::int64_t value = 0;
+                    if (token.getAsInteger(0, value)) {
+                        VAST_FATAL("invalid integer argument: {0}", token.str());
+                    }
+                    param.values.push_back(value);
+                }
+                return { param };
+            }
+
+            static constexpr bool is_words_param = std::is_same_v< base, words_param >;
+            static named_param parse(std::span< string_ref > tokens) requires(is_words_param) {
+                words_param param;
+                for (auto token : tokens) {
+                    param.values.push_back(token.str());
+                }
+                return { param };
+            }
+
+            static constexpr bool consumes_rest = is_integers_param || is_words_param;
+
             static constexpr bool is_flag_param = std::is_same_v< base, flag_param >;
             static named_param parse(string_ref token) requires(is_flag_param) {
                 return { .value = flag_param(token == param_name) };
@@ -165,9 +205,24 @@ namespace vast::repl
 
             void run(state_t &state) const override;
 
+            bool changes_tower() const override { return true; }
+
             params_storage params;
         };
 
+        //
+        // reload command
+        //
+        struct reload : base {
+            static constexpr string_ref name() { return "reload"; }
+
+            using base::command_params;
+
+            void run(state_t &state) const override;
+
+            bool changes_tower() const override { return true; }
+        };
+
         //
         // show command
         //
@@ -175,9 +230,11 @@ namespace vast::repl
             static constexpr string_ref name() { return "show"; }
 
             static constexpr inline char kind_param[] = "kind_param_name";
+            static constexpr inline char identifier_param[] = "identifier";
 
             using command_params = util::type_list<
-                named_param< kind_param, show_kind >
+                named_param< kind_param, show_kind >,
+                named_param< identifier_param, integer_param >
             >;
 
             using params_storage = command_params::as_tuple;
@@ -237,10 +294,226 @@ namespace vast::repl
 
             void run(state_t &state) const override;
 
+            bool changes_tower() const override { return true; }
+
             params_storage params;
         };
 
-        using command_list = util::type_list< exit, help, load, show, meta, raise >;
+        //
+        // materialize command
+        //
+        struct materialize : base {
+            static constexpr string_ref name() { return "materialize"; }
+
+            static constexpr inline char symbol_param[] = "symbol";
+
+            using command_params =
+                util::type_list< named_param< symbol_param, string_param > >;
+
+            using params_storage = command_params::as_tuple;
+
+            materialize(const params_storage &params) : params(params) {}
+            materialize(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        //
+        // run command
+        //
+        struct execute : base {
+            static constexpr string_ref name() { return "run"; }
+
+            static constexpr inline char symbol_param[] = "symbol";
+            static constexpr inline char args_param[]   = "args";
+
+            using command_params = util::type_list<
+                named_param< symbol_param, string_param >,
+                named_param< args_param, integers_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            execute(const params_storage &params) : params(params) {}
+            execute(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        //
+        // budget command
+        //
+        struct budget : base {
+            static constexpr string_ref name() { return "budget"; }
+
+            static constexpr inline char ops_param[] = "ops";
+
+            using command_params =
+                util::type_list< named_param< ops_param, integer_param > >;
+
+            using params_storage = command_params::as_tuple;
+
+            budget(const params_storage &params) : params(params) {}
+            budget(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        //
+        // jobs command
+        //
+        struct jobs : base {
+            static constexpr string_ref name() { return "jobs"; }
+
+            using base::command_params;
+
+            void run(state_t &state) const override;
+
+            bool controls_jobs() const override { return true; }
+        };
+
+        //
+        // wait command
+        //
+        struct wait : base {
+            static constexpr string_ref name() { return "wait"; }
+
+            using base::command_params;
+
+            void run(state_t &state) const override;
+
+            bool controls_jobs() const override { return true; }
+        };
+
+        //
+        // cancel command
+        //
+        struct cancel : base {
+            static constexpr string_ref name() { return "cancel"; }
+
+            using base::command_params;
+
+            void run(state_t &state) const override;
+
+            bool controls_jobs() const override { return true; }
+        };
+
+        //
+        // time command
+        //
+        struct time : base {
+            static constexpr string_ref name() { return "time"; }
+
+            static constexpr inline char command_param[] = "command";
+
+            using command_params =
+                util::type_list< named_param< command_param, words_param > >;
+
+            using params_storage = command_params::as_tuple;
+
+            time(const params_storage &params);
+            time(params_storage &&params) : time(std::as_const(params)) {}
+
+            void run(state_t &state) const override;
+
+            bool changes_tower() const override { return timed->changes_tower(); }
+            bool controls_jobs() const override { return timed->controls_jobs(); }
+
+            params_storage params;
+            std::unique_ptr< base > timed;
+        };
+
+        //
+        // stats command
+        //
+        struct stats : base {
+            static constexpr string_ref name() { return "stats"; }
+
+            using base::command_params;
+
+            void run(state_t &state) const override;
+        };
+
+        //
+        // diff command
+        //
+        struct diff : base {
+            static constexpr string_ref name() { return "diff"; }
+
+            static constexpr inline char from_param[] = "from";
+            static constexpr inline char to_param[]   = "to";
+
+            using command_params = util::type_list<
+                named_param< from_param, integer_param >,
+                named_param< to_param, integer_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            diff(const params_storage &params) : params(params) {}
+            diff(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        //
+        // save command
+        //
+        struct save : base {
+            static constexpr string_ref name() { return "save"; }
+
+            static constexpr inline char dir_param[] = "dir";
+
+            using command_params = util::type_list<
+                named_param< dir_param, file_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            save(const params_storage &params) : params(params) {}
+            save(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        //
+        // restore command
+        //
+        struct restore : base {
+            static constexpr string_ref name() { return "restore"; }
+
+            static constexpr inline char dir_param[] = "dir";
+
+            using command_params = util::type_list<
+                named_param< dir_param, file_param >
+            >;
+
+            using params_storage = command_params::as_tuple;
+
+            restore(const params_storage &params) : params(params) {}
+            restore(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            bool changes_tower() const override { return true; }
+
+            params_storage params;
+        };
+
+        using command_list = util::type_list<
+            exit, help, load, reload, show, meta, raise, materialize, execute, budget,
+            jobs, wait, cancel, time, stats, diff, save, restore
+        >;
 
     } // namespace command
 
@@ -272,8 +545,12 @@ namespace vast::repl
             using current_param = typename params_list::head;
             using rest          = typename params_list::tail;
 
-            auto param = std::make_tuple(current_param::parse(tokens.front()));
-            return std::tuple_cat(param, parse_params< rest >(tail(tokens)));
+            if constexpr (current_param::consumes_rest) {
+                return std::make_tuple(current_param::parse(tokens));
+            } else {
+                auto param = std::make_tuple(current_param::parse(tokens.front()));
+                return std::tuple_cat(param, parse_params< rest >(tail(tokens)));
+            }
         }
     }
 
@@ -0,0 +1,44 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ADT/StringMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/repl/common.hpp"
+
+namespace vast::repl::jit {
+
+    //
+    // Compiled code of a single tower layer that is lowered to the llvm
+    // dialect. Functions can be called with integer arguments and have to
+    // return an integer or nothing.
+    //
+    struct session {
+        // Returns null if the module is not fully lowered to llvm or it fails
+        // to compile.
+        static std::unique_ptr< session > make(vast_module mod);
+
+        // Prints the returned value, if there is one.
+        logical_result call(string_ref name, llvm::ArrayRef< std::int64_t > args, llvm::raw_ostream &os);
+
+      private:
+        struct signature {
+            std::size_t arity;
+            // zero for functions without a result
+            unsigned result_width;
+        };
+
+        session(std::unique_ptr< llvm::orc::LLJIT > lljit, llvm::StringMap< signature > signatures)
+            : lljit(std::move(lljit)), signatures(std::move(signatures))
+        {}
+
+        std::unique_ptr< llvm::orc::LLJIT > lljit;
+        llvm::StringMap< signature > signatures;
+    };
+
+} // namespace vast::repl::jit
@@ -2,22 +2,85 @@
 
 #pragma once
 
+#include "vast/Util/Warnings.hpp"
+
+#include "vast/Dialect/Meta/MetaDialect.hpp"
 #include "vast/Tower/Tower.hpp"
 #include "vast/repl/common.hpp"
+#include "vast/repl/codegen.hpp"
+#include "vast/repl/jit.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <mlir/Support/Timing.h>
+VAST_UNRELAX_WARNINGS
 
+#include <atomic>
 #include <filesystem>
+#include <mutex>
+#include <thread>
 
 namespace vast::repl {
 
+    //
+    // Command running on a worker thread. The worker changes the tower only
+    // under the lock of the state, so other commands can inspect finished
+    // layers meanwhile. Cancellation takes effect between the steps.
+    //
+    struct job_t {
+        std::string name;
+        std::vector< std::string > steps;
+
+        std::atomic< std::size_t > done = 0;
+        std::atomic< bool > cancelled   = false;
+        std::atomic< bool > finished    = false;
+
+        // outcome reported by the worker once finished
+        std::string status;
+
+        std::thread worker;
+    };
+
     struct state_t {
         explicit state_t(mcontext_t &ctx) : ctx(ctx) {}
 
+        ~state_t() {
+            if (job && job->worker.joinable()) {
+                job->cancelled = true;
+                job->worker.join();
+            }
+        }
+
         bool exit = false;
 
         std::optional< std::filesystem::path > source;
 
         mcontext_t &ctx;
         std::optional< tw::default_tower > tower;
+
+        // fingerprint of the source of the base layer of the tower
+        std::optional< codegen::source_fingerprint > fingerprint;
+
+        // meta identifiers of the top layer, with the id of the layer
+        std::optional< std::pair< std::size_t, meta::identifier_index > > meta_index;
+
+        // session for on-demand function body generation
+        std::unique_ptr< codegen::lazy_session > lazy;
+
+        // compiled code of llvm-level tower layers, keyed by the layer id
+        llvm::DenseMap< std::size_t, std::unique_ptr< jit::session > > jit_sessions;
+
+        // long-running commands run in the background in interactive sessions
+        bool background = false;
+        std::unique_ptr< job_t > job;
+
+        // collects timing of the passes run by the command wrapped in `time`
+        mlir::DefaultTimingManager *timing = nullptr;
+
+        // held by commands and by the worker while they use the state
+        std::recursive_mutex lock;
+
+        bool has_running_job() const { return job && !job->finished; }
     };
 
 } // namespace vast::repl
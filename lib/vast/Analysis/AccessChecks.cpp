@@ -0,0 +1,430 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/AccessChecks.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/Core/CoreTraits.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "Utils.hpp"
+
+#include <tuple>
+
+namespace vast::analysis
+{
+    namespace
+    {
+        enum symbol_kind : std::uint8_t { unknown, constant, object, load };
+
+        // Symbolic value: a constant, an object named by a variable or a
+        // global, or the value loaded from a variable.
+        using symbol = std::tuple< std::uint8_t, const void *, std::int64_t >;
+
+        const symbol unknown_symbol = { unknown, nullptr, 0 };
+
+        symbol_kind kind(const symbol &sym) { return symbol_kind(std::get< 0 >(sym)); }
+
+        // Kind of the access with its symbolic base and index.
+        using check_key = std::tuple< const void *, symbol, symbol >;
+
+        bool has_jumps(operation root) {
+            return root->walk([] (operation op) {
+                if (core::is_return(op) || mlir::isa< hl::GotoStmt, hl::IndirectGotoStmt, hl::BreakOp, hl::ContinueOp >(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            }).wasInterrupted();
+        }
+
+        // Range `[lo, hi)` of the values of the induction variable in the
+        // body of its loop.
+        std::optional< std::pair< std::int64_t, std::int64_t > > body_range(const loop &node) {
+            if (!node.induction || !node.trip_count) {
+                return std::nullopt;
+            }
+
+            const auto &iv = *node.induction;
+            if (*node.trip_count == 0) {
+                return std::pair(iv.init, iv.init);
+            }
+
+            switch (iv.predicate) {
+                case hl::Predicate::slt:
+                case hl::Predicate::ult:
+                    return std::pair(iv.init, iv.bound);
+                case hl::Predicate::sle:
+                case hl::Predicate::ule:
+                    return std::pair(iv.init, iv.bound + 1);
+                case hl::Predicate::sgt:
+                case hl::Predicate::ugt:
+                    return std::pair(iv.bound + 1, iv.init + 1);
+                case hl::Predicate::sge:
+                case hl::Predicate::uge:
+                    return std::pair(iv.bound, iv.init + 1);
+                default:
+                    return std::nullopt;
+            }
+        }
+
+    } // namespace
+
+    struct access_checks_builder
+    {
+        // Checks available at a point of a straight-line sequence: checks of
+        // addresses, and the first constant subscript of every base, which
+        // later constant subscripts of the base are merged into.
+        struct available_checks
+        {
+            llvm::DenseMap< check_key, operation > checks;
+            llvm::DenseMap< symbol, operation > bases;
+        };
+
+        access_checks_builder(access_checks &result, const loop_nest_analysis &loops)
+            : result(result), loops(loops)
+        {}
+
+        // Variables of the function whose every reference is only read or
+        // assigned, so that loads are changed only by visible writes.
+        bool tracked(mlir_value var) {
+            if (auto it = tracked_vars.find(var); it != tracked_vars.end()) {
+                return it->second;
+            }
+
+            return tracked_vars[var] = only_read_or_assigned(var);
+        }
+
+        symbol symbol_of(mlir_value value) {
+            if (auto cst = constant_of(value)) {
+                return { constant, nullptr, *cst };
+            }
+
+            if (auto cast = value.getDefiningOp< hl::ImplicitCastOp >()) {
+                switch (cast.getKind()) {
+                    case hl::CastKind::IntegralCast:
+                    case hl::CastKind::NoOp:
+                    case hl::CastKind::ArrayToPointerDecay:
+                        return symbol_of(cast.getValue());
+                    case hl::CastKind::LValueToRValue:
+                        if (auto var = referenced_var(cast.getValue()); var && tracked(var)) {
+                            return { load, var.getAsOpaquePointer(), 0 };
+                        }
+                        return unknown_symbol;
+                    default:
+                        return unknown_symbol;
+                }
+            }
+
+            if (auto var = referenced_var(value)) {
+                return { object, var.getAsOpaquePointer(), 0 };
+            }
+
+            if (auto ref = value.getDefiningOp< hl::GlobalRefOp >()) {
+                return { object, ref.getGlobalAttr().getAsOpaquePointer(), 0 };
+            }
+
+            return unknown_symbol;
+        }
+
+        // Size of the array an address of the base points into.
+        static std::optional< std::uint64_t > array_size(mlir_value base) {
+            while (auto cast = base.getDefiningOp< hl::ImplicitCastOp >()) {
+                if (cast.getKind() != hl::CastKind::ArrayToPointerDecay) {
+                    break;
+                }
+                base = cast.getValue();
+            }
+
+            auto type = base.getType();
+            if (auto lvalue = mlir::dyn_cast< hl::LValueType >(type)) {
+                type = lvalue.getElementType();
+            }
+
+            if (auto array = mlir::dyn_cast< hl::ArrayType >(type)) {
+                return array.getSize();
+            }
+
+            return std::nullopt;
+        }
+
+        // Variables written within the operation.
+        const llvm::DenseSet< const void * > &writes(operation root) {
+            auto [it, inserted] = written_vars.try_emplace(root);
+            if (inserted) {
+                root->walk([&, &vars = it->second] (operation op) {
+                    if (auto var = referenced_var(written_lvalue(op))) {
+                        vars.insert(var.getAsOpaquePointer());
+                    }
+                });
+            }
+            return it->second;
+        }
+
+        static bool changes(const llvm::DenseSet< const void * > &vars, const symbol &sym) {
+            return kind(sym) == load && vars.contains(std::get< 1 >(sym));
+        }
+
+        // Whether the index lies within the array by the range of the
+        // induction variable of an enclosing loop.
+        bool bounded_by_loop(operation access, const symbol &index, std::uint64_t size) {
+            if (kind(index) != load) {
+                return false;
+            }
+
+            auto var = std::get< 1 >(index);
+            for (auto node = loops.loop_of(access); node; node = node->parent) {
+                if (!node->induction || node->induction->var.getAsOpaquePointer() != var) {
+                    continue;
+                }
+
+                // The increment of the loop may use the index past the bound.
+                if (!loop_body(node->op)->isAncestor(access->getParentRegion())) {
+                    return false;
+                }
+
+                auto range = body_range(*node);
+                return range && (range->first >= range->second
+                    || (range->first >= 0 && range->second <= std::int64_t(size)));
+            }
+
+            return false;
+        }
+
+        // Outermost loop the check of the access can be hoisted from. The
+        // access has to be executed on every iteration, so it may be nested
+        // only in scopes, declarations and expressions of the body, and no
+        // operation before it may jump.
+        operation hoist_target(operation access, const symbol &base, const symbol &index) {
+            if (kind(base) == unknown) {
+                return nullptr;
+            }
+
+            operation target = nullptr;
+            for (auto op = access; auto parent = op->getParentOp(); op = parent) {
+                for (auto prev = op->getPrevNode(); prev; prev = prev->getPrevNode()) {
+                    if (has_jumps(prev)) {
+                        return target;
+                    }
+                }
+
+                if (auto body = loop_body(parent)) {
+                    auto &vars = writes(parent);
+                    if (op->getParentRegion() != body || changes(vars, base) || changes(vars, index)) {
+                        return target;
+                    }
+
+                    target = parent;
+                    continue;
+                }
+
+                if (!mlir::isa< core::ScopeOp, hl::VarDeclOp, hl::ExprOp >(parent)) {
+                    return target;
+                }
+            }
+
+            return target;
+        }
+
+        void invalidate(available_checks &available, const llvm::DenseSet< const void * > &vars) {
+            if (vars.empty()) {
+                return;
+            }
+
+            llvm::SmallVector< check_key > checks;
+            for (const auto &[key, _] : available.checks) {
+                if (changes(vars, std::get< 1 >(key)) || changes(vars, std::get< 2 >(key))) {
+                    checks.push_back(key);
+                }
+            }
+            for (const auto &key : checks) {
+                available.checks.erase(key);
+            }
+
+            llvm::SmallVector< symbol > bases;
+            for (const auto &[base, _] : available.bases) {
+                if (changes(vars, base)) {
+                    bases.push_back(base);
+                }
+            }
+            for (const auto &base : bases) {
+                available.bases.erase(base);
+            }
+        }
+
+        void invalidate(available_checks &available, const void *var) {
+            llvm::DenseSet< const void * > vars;
+            vars.insert(var);
+            invalidate(available, vars);
+        }
+
+        access_check classify(operation access, available_checks &available) {
+            auto name = access->getName().getAsOpaquePointer();
+
+            if (auto member = mlir::dyn_cast< hl::RecordMemberOp >(access)) {
+                auto record = member.getRecord();
+                if (auto deref = record.getDefiningOp< hl::Deref >()) {
+                    return { check_kind::covered, deref };
+                }
+                if (kind(symbol_of(record)) == object) {
+                    return { check_kind::in_bounds };
+                }
+                return { check_kind::required };
+            }
+
+            if (auto deref = mlir::dyn_cast< hl::Deref >(access)) {
+                if (deref.getAddr().getDefiningOp< hl::AddressOf >()) {
+                    return { check_kind::in_bounds };
+                }
+
+                auto addr = symbol_of(deref.getAddr());
+                if (kind(addr) == unknown) {
+                    return { check_kind::required };
+                }
+
+                auto key = check_key{ name, addr, unknown_symbol };
+                if (auto covering = available.checks.lookup(key)) {
+                    return { check_kind::covered, covering };
+                }
+                available.checks[key] = access;
+
+                if (auto target = hoist_target(access, addr, unknown_symbol)) {
+                    return { check_kind::hoistable, target };
+                }
+                return { check_kind::required };
+            }
+
+            auto subscript = mlir::cast< hl::SubscriptOp >(access);
+            auto base  = symbol_of(subscript.getArray());
+            auto index = symbol_of(subscript.getIndex());
+
+            if (auto size = array_size(subscript.getArray())) {
+                if (kind(index) == constant) {
+                    auto value = std::get< 2 >(index);
+                    if (value >= 0 && std::uint64_t(value) < *size) {
+                        return { check_kind::in_bounds };
+                    }
+                }
+
+                if (bounded_by_loop(access, index, *size)) {
+                    return { check_kind::in_bounds };
+                }
+            }
+
+            if (kind(base) == unknown || kind(index) == unknown) {
+                return { check_kind::required };
+            }
+
+            auto key = check_key{ name, base, index };
+            if (auto covering = available.checks.lookup(key)) {
+                return { check_kind::covered, covering };
+            }
+            available.checks[key] = access;
+
+            if (kind(index) == constant) {
+                auto value = std::get< 2 >(index);
+                if (auto first = available.bases.lookup(base)) {
+                    auto &range = result.ranges[first];
+                    range.first  = std::min(range.first, value);
+                    range.second = std::max(range.second, value);
+                    return { check_kind::covered, first };
+                }
+                available.bases[base] = access;
+                result.ranges[access] = { value, value };
+            }
+
+            if (auto target = hoist_target(access, base, index)) {
+                return { check_kind::hoistable, target };
+            }
+            return { check_kind::required };
+        }
+
+        void visit(mlir::Region &region, const available_checks &outer) {
+            for (auto &block : region) {
+                // Checks of the nested regions may not be executed, so later
+                // subscripts of outer bases are not merged into them.
+                available_checks available;
+                if (&block == &region.front()) {
+                    available.checks = outer.checks;
+                }
+
+                for (auto &op : block) {
+                    visit(&op, available);
+                }
+            }
+        }
+
+        void visit(operation op, available_checks &available) {
+            // Labels may be entered by jumps that skip earlier checks.
+            if (mlir::isa< hl::LabelStmt >(op)) {
+                available = {};
+            }
+
+            if (access_checks::is_access(op)) {
+                result.order.push_back(op);
+                result.checks[op] = classify(op, available);
+            }
+
+            if (op->getNumRegions() != 0) {
+                // Checks before a loop do not cover the accesses of later
+                // iterations that follow a write of their addresses.
+                if (loop_body(op)) {
+                    invalidate(available, writes(op));
+                }
+
+                for (auto &region : op->getRegions()) {
+                    visit(region, available);
+                }
+
+                invalidate(available, writes(op));
+            } else if (auto var = referenced_var(written_lvalue(op))) {
+                invalidate(available, var.getAsOpaquePointer());
+            }
+
+            if (has_jumps(op)) {
+                available.bases.clear();
+            }
+        }
+
+        access_checks &result;
+        const loop_nest_analysis &loops;
+
+        llvm::DenseMap< mlir_value, bool > tracked_vars;
+        llvm::DenseMap< operation, llvm::DenseSet< const void * > > written_vars;
+    };
+
+    access_checks::access_checks(operation root)
+        : access_checks(root, loop_nest_analysis(root))
+    {}
+
+    access_checks::access_checks(operation root, const loop_nest_analysis &loops) {
+        access_checks_builder builder(*this, loops);
+        access_checks_builder::available_checks available;
+        for (auto &region : root->getRegions()) {
+            builder.visit(region, available);
+        }
+    }
+
+    bool access_checks::is_access(operation op) {
+        return mlir::isa< hl::SubscriptOp, hl::Deref, hl::RecordMemberOp >(op);
+    }
+
+    std::optional< std::pair< std::int64_t, std::int64_t > > access_checks::range(operation access) const {
+        if (auto it = ranges.find(access); it != ranges.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    std::size_t access_checks::count(check_kind kind) const {
+        return std::size_t(llvm::count_if(order, [&] (operation op) {
+            return check(op).kind == kind;
+        }));
+    }
+
+} // namespace vast::analysis
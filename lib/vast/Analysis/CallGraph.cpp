@@ -0,0 +1,242 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/CallGraph.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/IR/Threading.h>
+#include <mlir/Interfaces/CallInterfaces.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreTypes.hpp"
+
+namespace vast::analysis
+{
+    namespace
+    {
+        using node_id = call_graph::node_id;
+
+        // Number of arguments and results of an indirect call.
+        using call_shape = std::pair< unsigned, unsigned >;
+
+        struct function_scan
+        {
+            std::vector< node_id > direct;
+            std::vector< call_shape > indirect;
+            std::vector< node_id > taken;
+        };
+
+        bool is_variadic(mlir::FunctionOpInterface fn) {
+            auto type = mlir::dyn_cast< core::FunctionType >(fn.getFunctionType());
+            return type && type.isVarArg();
+        }
+
+        call_shape shape_of(mlir::FunctionOpInterface fn) {
+            return { unsigned(fn.getArgumentTypes().size()), unsigned(fn.getResultTypes().size()) };
+        }
+
+    } // namespace
+
+    call_graph::call_graph(operation root) {
+        for (auto &region : root->getRegions()) {
+            for (auto &op : region.getOps()) {
+                if (auto fn = mlir::dyn_cast< mlir::FunctionOpInterface >(op)) {
+                    nodes.try_emplace(mlir::SymbolTable::getSymbolName(fn), node_id(functions.size()));
+                    functions.push_back(fn);
+                }
+            }
+        }
+
+        auto lookup = [&] (mlir::StringAttr name) {
+            auto it = nodes.find(name);
+            return it != nodes.end() ? it->second : no_node;
+        };
+
+        // Callees of direct calls are not taken, other symbol references,
+        // e.g., of `hl.funcref`, are.
+        auto scan = [&] (operation op, function_scan &result) {
+            op->walk([&] (operation child) {
+                if (auto call = mlir::dyn_cast< mlir::CallOpInterface >(child)) {
+                    auto callee = call.getCallableForCallee();
+                    if (auto symbol = llvm::dyn_cast_if_present< mlir::SymbolRefAttr >(callee)) {
+                        if (auto node = lookup(symbol.getRootReference()); node != no_node) {
+                            result.direct.push_back(node);
+                        }
+                    } else {
+                        result.indirect.emplace_back(call.getArgOperands().size(), child->getNumResults());
+                    }
+                    return;
+                }
+
+                child->getAttrDictionary().walk([&] (mlir::SymbolRefAttr ref) {
+                    if (auto node = lookup(ref.getRootReference()); node != no_node) {
+                        result.taken.push_back(node);
+                    }
+                });
+            });
+        };
+
+        auto ctx = root->getContext();
+
+        std::vector< function_scan > scans(functions.size());
+        mlir::parallelFor(ctx, 0, functions.size(), [&] (std::size_t i) {
+            scan(functions[i], scans[i]);
+        });
+
+        // Initializers of globals take addresses as well.
+        function_scan globals;
+        for (auto &region : root->getRegions()) {
+            for (auto &op : region.getOps()) {
+                if (!mlir::isa< mlir::FunctionOpInterface >(op)) {
+                    scan(&op, globals);
+                }
+            }
+        }
+
+        taken.resize(size());
+        auto mark_taken = [&] (const function_scan &result) {
+            for (auto node : result.taken) {
+                taken.set(node);
+            }
+        };
+
+        llvm::for_each(scans, mark_taken);
+        mark_taken(globals);
+
+        // Targets of indirect calls by their shape, variadic functions accept
+        // any number of arguments beyond their parameters.
+        llvm::DenseMap< call_shape, std::vector< node_id > > targets;
+        std::vector< node_id > variadic;
+        for (auto node : taken.set_bits()) {
+            if (is_variadic(function(node))) {
+                variadic.push_back(node);
+            } else {
+                targets[shape_of(function(node))].push_back(node);
+            }
+        }
+
+        auto targets_of = [&] (call_shape call, auto &&yield) {
+            if (auto it = targets.find(call); it != targets.end()) {
+                for (auto node : it->second) {
+                    yield(node);
+                }
+            }
+
+            for (auto node : variadic) {
+                auto [params, results] = shape_of(function(node));
+                if (call.first >= params && call.second == results) {
+                    yield(node);
+                }
+            }
+        };
+
+        unknown_targets.resize(size());
+
+        std::vector< std::vector< edge > > rows(functions.size());
+        std::vector< char > unknown(functions.size(), false);
+        mlir::parallelFor(ctx, 0, functions.size(), [&] (std::size_t i) {
+            auto &row = rows[i];
+            auto &result = scans[i];
+
+            for (auto node : result.direct) {
+                row.push_back({ node, edge_kind::direct });
+            }
+
+            for (auto call : result.indirect) {
+                bool any = false;
+                targets_of(call, [&] (node_id node) {
+                    row.push_back({ node, edge_kind::indirect });
+                    any = true;
+                });
+                unknown[i] |= !any;
+            }
+
+            llvm::sort(row, [] (const edge &a, const edge &b) {
+                return std::tie(a.node, a.kind) < std::tie(b.node, b.kind);
+            });
+
+            auto last = std::unique(row.begin(), row.end(), [] (const edge &a, const edge &b) {
+                return a.node == b.node;
+            });
+            row.erase(last, row.end());
+
+            result = {};
+        });
+
+        callee_offsets.reserve(size() + 1);
+        callee_offsets.push_back(0);
+        for (const auto &row : rows) {
+            callee_offsets.push_back(callee_offsets.back() + std::uint32_t(row.size()));
+        }
+
+        std::vector< std::uint32_t > in_degree(size(), 0);
+        callee_edges.reserve(callee_offsets.back());
+        for (node_id node = 0; node < size(); ++node) {
+            for (const auto &out : rows[node]) {
+                ++in_degree[out.node];
+            }
+            callee_edges.insert(callee_edges.end(), rows[node].begin(), rows[node].end());
+            rows[node] = {};
+
+            if (unknown[node]) {
+                unknown_targets.set(node);
+            }
+        }
+
+        // Callers are filled in the order of the nodes, hence their rows are
+        // sorted as well.
+        caller_offsets.reserve(size() + 1);
+        caller_offsets.push_back(0);
+        for (auto degree : in_degree) {
+            caller_offsets.push_back(caller_offsets.back() + degree);
+        }
+
+        caller_edges.resize(callee_edges.size());
+        std::vector< std::uint32_t > fill(caller_offsets.begin(), caller_offsets.end() - 1);
+        for (node_id node = 0; node < size(); ++node) {
+            for (const auto &out : callees(node)) {
+                caller_edges[fill[out.node]++] = { node, out.kind };
+            }
+        }
+    }
+
+    auto call_graph::node(string_ref name) const -> node_id {
+        if (functions.empty()) {
+            return no_node;
+        }
+
+        auto it = nodes.find(mlir::StringAttr::get(functions.front()->getContext(), name));
+        return it != nodes.end() ? it->second : no_node;
+    }
+
+    auto call_graph::node(mlir::FunctionOpInterface fn) const -> node_id {
+        auto it = nodes.find(mlir::SymbolTable::getSymbolName(fn));
+        return it != nodes.end() && functions[it->second] == fn ? it->second : no_node;
+    }
+
+    llvm::BitVector call_graph::reachable(llvm::ArrayRef< node_id > roots) const {
+        llvm::BitVector result(size());
+
+        std::vector< node_id > worklist;
+        for (auto root : roots) {
+            if (!result.test(root)) {
+                result.set(root);
+                worklist.push_back(root);
+            }
+        }
+
+        while (!worklist.empty()) {
+            auto node = worklist.back();
+            worklist.pop_back();
+            for (const auto &out : callees(node)) {
+                if (!result.test(out.node)) {
+                    result.set(out.node);
+                    worklist.push_back(out.node);
+                }
+            }
+        }
+
+        return result;
+    }
+
+} // namespace vast::analysis
@@ -0,0 +1,565 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/Dataflow.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/OpDefinition.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/Core/CoreTraits.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include <algorithm>
+
+namespace vast::analysis
+{
+    using node_id = flow_graph::node_id;
+
+    //
+    // Builds the nodes and the edges of the graph while walking the regions,
+    // every visit takes the node the control enters the operation from and
+    // returns the node it leaves it from. Operations after a jump are placed
+    // into a fresh node without predecessors.
+    //
+    struct flow_graph_builder
+    {
+        struct jump_targets
+        {
+            node_id exit;
+            node_id next; // no_node for switches, which continue the enclosing loop
+        };
+
+        struct switch_state
+        {
+            node_id dispatch;
+            bool has_default = false;
+        };
+
+        // Return-like terminators of other regions than the body, e.g.,
+        // yields, continue in their parent.
+        mlir::Region *body = nullptr;
+
+        std::vector< std::vector< operation > > nodes;
+        std::vector< std::pair< node_id, node_id > > edges;
+
+        std::vector< jump_targets > jumps;
+        std::vector< switch_state > switches;
+
+        llvm::DenseMap< mlir_value, node_id > labels;
+        std::vector< std::pair< node_id, mlir_value > > gotos;
+        std::vector< node_id > indirect_gotos;
+
+        node_id make() {
+            nodes.emplace_back();
+            return node_id(nodes.size() - 1);
+        }
+
+        void edge(node_id from, node_id to) { edges.emplace_back(from, to); }
+
+        node_id append(operation op, node_id node) {
+            nodes[node].push_back(op);
+            return node;
+        }
+
+        node_id jump(operation op, node_id node, node_id target) {
+            edge(append(op, node), target);
+            return make();
+        }
+
+        node_id break_target() const {
+            VAST_CHECK(!jumps.empty(), "break outside of a loop or a switch");
+            return jumps.back().exit;
+        }
+
+        node_id continue_target() const {
+            for (const auto &targets : llvm::reverse(jumps)) {
+                if (targets.next != flow_graph::no_node) {
+                    return targets.next;
+                }
+            }
+            VAST_FATAL("continue outside of a loop");
+        }
+
+        node_id visit(mlir::Region &region, node_id node) {
+            if (region.empty()) {
+                return node;
+            }
+
+            if (region.hasOneBlock()) {
+                for (auto &op : region.front()) {
+                    node = visit(&op, node);
+                }
+                return node;
+            }
+
+            // Blocks connected by their terminators.
+            llvm::DenseMap< mlir::Block *, node_id > blocks;
+            for (auto &block : region) {
+                blocks[&block] = make();
+            }
+
+            edge(node, blocks[&region.front()]);
+
+            auto after = make();
+            for (auto &block : region) {
+                auto current = blocks[&block];
+                for (auto &op : block) {
+                    current = visit(&op, current);
+                }
+
+                auto terminator = block.empty() ? nullptr : &block.back();
+                if (terminator && terminator->getNumSuccessors() != 0) {
+                    for (auto succ : terminator->getSuccessors()) {
+                        edge(current, blocks[succ]);
+                    }
+                } else {
+                    edge(current, after);
+                }
+            }
+
+            return after;
+        }
+
+        node_id visit_lazy(mlir::Region &region, node_id node) {
+            auto lazy = make();
+            edge(node, lazy);
+
+            auto join = make();
+            edge(node, join);
+            edge(visit(region, lazy), join);
+            return join;
+        }
+
+        node_id visit_loop(
+            operation op, mlir::Region &cond, mlir::Region &loop_body, mlir::Region *incr, node_id node
+        ) {
+            auto header = make();
+            edge(node, header);
+
+            auto cond_end = visit(cond, header);
+
+            auto entry = make();
+            edge(cond_end, entry);
+
+            auto exit = make();
+            edge(cond_end, exit);
+
+            auto next = incr ? make() : header;
+
+            jumps.push_back({ exit, next });
+            auto body_end = visit(loop_body, entry);
+            jumps.pop_back();
+
+            edge(body_end, next);
+            if (incr) {
+                edge(visit(*incr, next), header);
+            }
+
+            return append(op, exit);
+        }
+
+        node_id visit_case(operation op, mlir::Region *lhs, mlir::Region &case_body, node_id node) {
+            VAST_CHECK(!switches.empty(), "case outside of a switch");
+            auto &state = switches.back();
+            if (lhs) {
+                state.dispatch = visit(*lhs, state.dispatch);
+            } else {
+                state.has_default = true;
+            }
+
+            // Entered from the dispatch or by falling through.
+            auto entry = make();
+            edge(state.dispatch, entry);
+            edge(node, entry);
+
+            return visit(case_body, append(op, entry));
+        }
+
+        node_id visit(operation op, node_id node) {
+            auto returns = op->hasTrait< mlir::OpTrait::ReturnLike >() && op->getParentRegion() == body;
+            if (core::is_return(op) || returns) {
+                return jump(op, node, flow_graph::exit);
+            }
+
+            if (op->getNumRegions() == 0 || op->hasTrait< mlir::OpTrait::IsIsolatedFromAbove >()) {
+                return llvm::TypeSwitch< operation, node_id >(op)
+                    .Case([&] (hl::BreakOp) { return jump(op, node, break_target()); })
+                    .Case([&] (hl::ContinueOp) { return jump(op, node, continue_target()); })
+                    .Case([&] (hl::GotoStmt stmt) {
+                        gotos.emplace_back(append(op, node), stmt.getLabel());
+                        return make();
+                    })
+                    .Case([&] (hl::IndirectGotoStmt) {
+                        indirect_gotos.push_back(append(op, node));
+                        return make();
+                    })
+                    .Default([&] (auto) { return append(op, node); });
+            }
+
+            return llvm::TypeSwitch< operation, node_id >(op)
+                .Case< hl::IfOp, hl::CondOp >([&] (auto branch) {
+                    auto cond_end = visit(branch.getCondRegion(), node);
+
+                    auto then_entry = make();
+                    edge(cond_end, then_entry);
+
+                    auto join = make();
+                    edge(visit(branch.getThenRegion(), then_entry), join);
+
+                    if (branch.getElseRegion().empty()) {
+                        edge(cond_end, join);
+                    } else {
+                        auto else_entry = make();
+                        edge(cond_end, else_entry);
+                        edge(visit(branch.getElseRegion(), else_entry), join);
+                    }
+
+                    return append(op, join);
+                })
+                .Case([&] (hl::WhileOp loop) {
+                    return visit_loop(op, loop.getCondRegion(), loop.getBodyRegion(), nullptr, node);
+                })
+                .Case([&] (hl::ForOp loop) {
+                    return visit_loop(op, loop.getCondRegion(), loop.getBodyRegion(), &loop.getIncrRegion(), node);
+                })
+                .Case([&] (hl::DoOp loop) {
+                    auto entry = make();
+                    edge(node, entry);
+
+                    auto cond = make();
+                    auto exit = make();
+
+                    jumps.push_back({ exit, cond });
+                    edge(visit(loop.getBodyRegion(), entry), cond);
+                    jumps.pop_back();
+
+                    auto cond_end = visit(loop.getCondRegion(), cond);
+                    edge(cond_end, entry);
+                    edge(cond_end, exit);
+
+                    return append(op, exit);
+                })
+                .Case([&] (hl::SwitchOp sw) {
+                    auto exit = make();
+
+                    jumps.push_back({ exit, flow_graph::no_node });
+                    switches.push_back({ visit(sw.getCondRegion(), node) });
+
+                    // Statements before the first case are not reachable.
+                    auto current = make();
+                    for (auto &region : sw.getCases()) {
+                        current = visit(region, current);
+                    }
+                    edge(current, exit);
+
+                    auto state = switches.pop_back_val();
+                    if (!state.has_default) {
+                        edge(state.dispatch, exit);
+                    }
+                    jumps.pop_back();
+
+                    return append(op, exit);
+                })
+                .Case([&] (hl::CaseOp c) { return visit_case(op, &c.getLhs(), c.getBody(), node); })
+                .Case([&] (hl::DefaultOp d) { return visit_case(op, nullptr, d.getBody(), node); })
+                .Case([&] (hl::LabelStmt stmt) {
+                    auto target = make();
+                    edge(node, target);
+                    labels[stmt.getLabel()] = target;
+                    return visit(stmt.getBody(), append(op, target));
+                })
+                .Case([&] (core::LazyOp lazy) {
+                    return append(op, visit_lazy(lazy.getLazy(), node));
+                })
+                .Default([&] (auto) {
+                    // Scopes and ops the graph does not know, e.g., initializers
+                    // of variables, execute their regions in their order.
+                    for (auto &region : op->getRegions()) {
+                        node = visit(region, node);
+                    }
+                    return append(op, node);
+                });
+        }
+
+        static void make_rows(
+            std::vector< std::pair< node_id, node_id > > &edges, std::size_t size,
+            std::vector< std::uint32_t > &offsets, std::vector< node_id > &targets
+        ) {
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+            offsets.assign(size + 1, 0);
+            targets.reserve(edges.size());
+            for (auto [from, to] : edges) {
+                ++offsets[from + 1];
+                targets.push_back(to);
+            }
+
+            for (std::size_t idx = 0; idx < size; ++idx) {
+                offsets[idx + 1] += offsets[idx];
+            }
+        }
+
+        void build(mlir::Region &region, flow_graph &graph) {
+            body = &region;
+
+            auto entry = make();
+            auto exit  = make();
+            VAST_ASSERT(entry == flow_graph::entry && exit == flow_graph::exit);
+
+            edge(visit(region, entry), exit);
+
+            // Unknown labels conservatively lead to the exit.
+            for (auto [node, label] : gotos) {
+                auto it = labels.find(label);
+                edge(node, it != labels.end() ? it->second : exit);
+            }
+
+            // Computed gotos may jump to any label whose address is taken.
+            if (!indirect_gotos.empty()) {
+                llvm::SmallVector< node_id > targets;
+                region.walk([&] (hl::AddrLabelExpr addr) {
+                    auto it = labels.find(addr.getLabel());
+                    auto target = it != labels.end() ? it->second : exit;
+                    if (!llvm::is_contained(targets, target)) {
+                        targets.push_back(target);
+                    }
+                });
+
+                for (auto node : indirect_gotos) {
+                    for (auto target : targets) {
+                        edge(node, target);
+                    }
+                }
+            }
+
+            graph.offsets.reserve(nodes.size() + 1);
+            graph.offsets.push_back(0);
+            for (node_id node = 0; node < nodes.size(); ++node) {
+                for (auto op : nodes[node]) {
+                    auto idx = unsigned(graph.operations.size() - graph.offsets.back());
+                    graph.positions[op] = { node, idx };
+                    graph.operations.push_back(op);
+                }
+                graph.offsets.push_back(std::uint32_t(graph.operations.size()));
+            }
+
+            auto reversed = edges;
+            for (auto &[from, to] : reversed) {
+                std::swap(from, to);
+            }
+
+            make_rows(edges, nodes.size(), graph.succ_offsets, graph.succ);
+            make_rows(reversed, nodes.size(), graph.pred_offsets, graph.pred);
+        }
+    };
+
+    flow_graph::flow_graph(mlir::Region &body) {
+        flow_graph_builder().build(body, *this);
+    }
+
+    flow_graph::flow_graph(mlir::Region &body, const flat_function &flat) : flow_graph(body) {
+        ids.reserve(operations.size());
+        for (auto op : operations) {
+            auto id = flat.id(op);
+            VAST_CHECK(id, "operation of the flow graph is not in the snapshot");
+            ids.push_back(*id);
+        }
+        numbered = true;
+    }
+
+    std::optional< std::pair< node_id, unsigned > > flow_graph::position(operation op) const {
+        if (auto it = positions.find(op); it != positions.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    std::vector< node_id > flow_graph::reverse_post_order(bool backward) const {
+        auto next = [&] (node_id node) { return backward ? predecessors(node) : successors(node); };
+
+        std::vector< node_id > order;
+        order.reserve(size());
+
+        llvm::BitVector visited(size());
+        std::vector< std::pair< node_id, std::size_t > > stack;
+
+        auto start = backward ? exit : entry;
+        visited.set(start);
+        stack.emplace_back(start, 0);
+        while (!stack.empty()) {
+            auto &[node, idx] = stack.back();
+            auto out = next(node);
+            if (idx == out.size()) {
+                order.push_back(node);
+                stack.pop_back();
+                continue;
+            }
+
+            auto to = out[idx++];
+            if (!visited.test(to)) {
+                visited.set(to);
+                stack.emplace_back(to, 0);
+            }
+        }
+
+        std::reverse(order.begin(), order.end());
+        for (node_id node = 0; node < size(); ++node) {
+            if (!visited.test(node)) {
+                order.push_back(node);
+            }
+        }
+
+        return order;
+    }
+
+    namespace
+    {
+        // Word-wise `state = (state & ~kill) | gen`.
+        void apply(llvm::BitVector &state, const llvm::BitVector &gen, const llvm::BitVector &kill) {
+            state.reset(kill);
+            state |= gen;
+        }
+
+        void meet(llvm::BitVector &state, const llvm::BitVector &other, flow_meet kind) {
+            if (kind == flow_meet::may) {
+                state |= other;
+            } else {
+                state &= other;
+            }
+        }
+
+    } // namespace
+
+    gen_kill_solver::gen_kill_solver(const flow_graph &graph, gen_kill_problem problem)
+        : graph(graph), problem(std::move(problem))
+    {
+        auto size = graph.size();
+        auto init = llvm::BitVector(this->problem.bits, this->problem.meet == flow_meet::must);
+        ins.assign(size, init);
+        outs.assign(size, init);
+        summarize();
+    }
+
+    void gen_kill_solver::summarize() {
+        gens.assign(graph.size(), llvm::BitVector(problem.bits));
+        kills.assign(graph.size(), llvm::BitVector(problem.bits));
+
+        VAST_CHECK(
+            !problem.flat_transfer || graph.has_op_ids(),
+            "flat transfer requires a graph numbered by a snapshot"
+        );
+
+        for (node_id node = 0; node < graph.size(); ++node) {
+            gen_kill_facts facts{ &gens[node], &kills[node] };
+            transfer(node, 0, graph.ops(node).size(), facts);
+        }
+    }
+
+    void gen_kill_solver::transfer(node_id node, std::size_t begin, std::size_t end, gen_kill_facts &facts) const {
+        auto run = [&] (auto ops, const auto &fn) {
+            ops = ops.slice(begin, end - begin);
+            if (forward()) {
+                for (auto op : ops) {
+                    fn(op, facts);
+                }
+            } else {
+                for (auto op : llvm::reverse(ops)) {
+                    fn(op, facts);
+                }
+            }
+        };
+
+        if (problem.flat_transfer) {
+            run(graph.op_ids(node), problem.flat_transfer);
+        } else {
+            run(graph.ops(node), problem.transfer);
+        }
+    }
+
+    std::size_t gen_kill_solver::solve() {
+        auto boundary = problem.boundary.empty()
+            ? llvm::BitVector(problem.bits)
+            : problem.boundary;
+        VAST_CHECK(boundary.size() == problem.bits, "boundary of a different size than the problem");
+
+        // Forward problems flow from the predecessors into `in`, backward
+        // from the successors into `out`.
+        auto &sources = forward() ? outs : ins;
+        auto &targets = forward() ? ins : outs;
+        auto start    = forward() ? flow_graph::entry : flow_graph::exit;
+
+        auto order = graph.reverse_post_order(!forward());
+
+        llvm::BitVector dirty(graph.size(), true);
+        llvm::BitVector state(problem.bits);
+
+        std::size_t visits = 0;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto node : order) {
+                if (!dirty.test(node)) {
+                    continue;
+                }
+
+                dirty.reset(node);
+                ++visits;
+
+                auto neighbours = forward() ? graph.predecessors(node) : graph.successors(node);
+                auto &target = targets[node];
+                if (node == start) {
+                    target = boundary;
+                } else if (!neighbours.empty()) {
+                    target = sources[neighbours.front()];
+                    for (auto neighbour : neighbours.drop_front()) {
+                        meet(target, sources[neighbour], problem.meet);
+                    }
+                }
+
+                state = target;
+                apply(state, gens[node], kills[node]);
+                if (state == sources[node]) {
+                    continue;
+                }
+
+                std::swap(sources[node], state);
+                for (auto next : forward() ? graph.successors(node) : graph.predecessors(node)) {
+                    dirty.set(next);
+                    changed = true;
+                }
+            }
+        }
+
+        return visits;
+    }
+
+    llvm::BitVector gen_kill_solver::state_at(operation op, bool applied) const {
+        auto position = graph.position(op);
+        VAST_CHECK(position, "operation is not in the flow graph");
+
+        auto [node, idx] = position.value();
+        auto ops   = graph.ops(node);
+        auto state = forward() ? ins[node] : outs[node];
+
+        gen_kill_facts facts{ &state };
+        if (forward()) {
+            transfer(node, 0, idx + unsigned(applied), facts);
+        } else {
+            transfer(node, idx + unsigned(!applied), ops.size(), facts);
+        }
+
+        return state;
+    }
+
+    llvm::BitVector gen_kill_solver::before(operation op) const {
+        return state_at(op, /* applied */ !forward());
+    }
+
+    llvm::BitVector gen_kill_solver::after(operation op) const {
+        return state_at(op, /* applied */ forward());
+    }
+
+} // namespace vast::analysis
@@ -0,0 +1,158 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/FlatFunction.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Operation.h>
+#include <llvm/ADT/SmallVector.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::analysis
+{
+    using op_id     = flat_function::op_id;
+    using value_id  = flat_function::value_id;
+    using block_id  = flat_function::block_id;
+    using region_id = flat_function::region_id;
+    using kind_id   = flat_function::kind_id;
+
+    //
+    // Numbers the operations in pre-order. Regions of an operation, their
+    // blocks and the arguments of the blocks are numbered when the operation
+    // is, so that regions of an operation and blocks of a region are
+    // consecutive. Operands are resolved once all values are numbered, as
+    // blocks may use values of the blocks that follow them.
+    //
+    struct flat_function_builder
+    {
+        explicit flat_function_builder(flat_function &flat) : flat(flat) {}
+
+        value_id add_value(mlir_value value, op_id def) {
+            auto id = value_id(flat.values.size());
+            flat.values.push_back(value);
+            flat.value_def.push_back(def);
+            flat.value_ids[value] = id;
+            return id;
+        }
+
+        kind_id kind(mlir::OperationName name) {
+            auto [it, inserted] = kinds.try_emplace(name, kind_id(flat.names.size()));
+            if (inserted) {
+                flat.names.push_back(name);
+            }
+            return it->second;
+        }
+
+        void visit(operation op, block_id parent) {
+            auto id = op_id(flat.ops.size());
+            flat.ops.push_back(op);
+            flat.op_ids[op] = id;
+            flat.kinds.push_back(kind(op->getName()));
+            flat.op_parent.push_back(parent);
+            if (parent != flat_function::none) {
+                block_ops[parent].push_back(id);
+            }
+
+            flat.first_result.push_back(value_id(flat.values.size()));
+            flat.num_results.push_back(op->getNumResults());
+            for (auto result : op->getResults()) {
+                add_value(result, id);
+            }
+
+            // Successors are blocks of the region of the operation, which are
+            // numbered already.
+            for (auto succ : op->getSuccessors()) {
+                flat.successor_ids.push_back(block_ids.lookup(succ));
+            }
+            flat.successor_offsets.push_back(std::uint32_t(flat.successor_ids.size()));
+
+            for (auto &region : op->getRegions()) {
+                flat.region_parent.push_back(id);
+                for (auto &block : region) {
+                    auto bid = block_id(flat.block_region.size());
+                    block_ids[&block] = bid;
+                    flat.block_region.push_back(region_id(flat.region_parent.size() - 1));
+                    flat.first_argument.push_back(value_id(flat.values.size()));
+                    flat.num_arguments.push_back(block.getNumArguments());
+                    for (auto arg : block.getArguments()) {
+                        add_value(arg, flat_function::none);
+                    }
+                    block_ops.emplace_back();
+                }
+                flat.region_blocks.push_back(block_id(flat.block_region.size()));
+            }
+            flat.region_offsets.push_back(region_id(flat.region_parent.size()));
+
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    auto bid = block_ids.lookup(&block);
+                    for (auto &child : block) {
+                        visit(&child, bid);
+                    }
+                }
+            }
+        }
+
+        void build(operation fn) {
+            flat.successor_offsets.push_back(0);
+            flat.region_offsets.push_back(0);
+            flat.region_blocks.push_back(0);
+
+            visit(fn, flat_function::none);
+            flat.own_values = flat.values.size();
+
+            flat.operand_offsets.reserve(flat.ops.size() + 1);
+            flat.operand_offsets.push_back(0);
+            for (auto op : flat.ops) {
+                for (auto operand : op->getOperands()) {
+                    auto it = flat.value_ids.find(operand);
+                    auto id = it != flat.value_ids.end()
+                        ? it->second
+                        : add_value(operand, flat_function::none);
+                    flat.operand_ids.push_back(id);
+                }
+                flat.operand_offsets.push_back(std::uint32_t(flat.operand_ids.size()));
+            }
+
+            flat.block_op_offsets.reserve(block_ops.size() + 1);
+            flat.block_op_offsets.push_back(0);
+            for (const auto &ops : block_ops) {
+                flat.block_op_ids.insert(flat.block_op_ids.end(), ops.begin(), ops.end());
+                flat.block_op_offsets.push_back(std::uint32_t(flat.block_op_ids.size()));
+            }
+        }
+
+        flat_function &flat;
+
+        llvm::DenseMap< mlir::OperationName, kind_id > kinds;
+        llvm::DenseMap< mlir::Block *, block_id > block_ids;
+        std::vector< llvm::SmallVector< op_id, 8 > > block_ops;
+    };
+
+    flat_function::flat_function(operation fn) {
+        flat_function_builder(*this).build(fn);
+    }
+
+    std::optional< op_id > flat_function::id(operation op) const {
+        if (auto it = op_ids.find(op); it != op_ids.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    std::optional< value_id > flat_function::id(mlir_value value) const {
+        if (auto it = value_ids.find(value); it != value_ids.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    kind_id flat_function::kind_of(string_ref name) const {
+        for (kind_id kind = 0; kind < names.size(); ++kind) {
+            if (names[kind].getStringRef() == name) {
+                return kind;
+            }
+        }
+        return none;
+    }
+
+} // namespace vast::analysis
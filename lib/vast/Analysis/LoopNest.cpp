@@ -0,0 +1,369 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/LoopNest.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/MathExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/Core/CoreTraits.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "Utils.hpp"
+
+#include <cstdint>
+
+namespace vast::analysis
+{
+    namespace
+    {
+        // Predicate of the comparison with swapped operands.
+        hl::Predicate swapped(hl::Predicate pred) {
+            switch (pred) {
+                case hl::Predicate::slt: return hl::Predicate::sgt;
+                case hl::Predicate::sle: return hl::Predicate::sge;
+                case hl::Predicate::sgt: return hl::Predicate::slt;
+                case hl::Predicate::sge: return hl::Predicate::sle;
+                case hl::Predicate::ult: return hl::Predicate::ugt;
+                case hl::Predicate::ule: return hl::Predicate::uge;
+                case hl::Predicate::ugt: return hl::Predicate::ult;
+                case hl::Predicate::uge: return hl::Predicate::ule;
+                default: return pred;
+            }
+        }
+
+        // Step of the write of the variable, if it is an increment by
+        // a constant.
+        std::optional< std::int64_t > step_of(operation op) {
+            if (mlir::isa< hl::PreIncOp, hl::PostIncOp >(op)) {
+                return 1;
+            }
+            if (mlir::isa< hl::PreDecOp, hl::PostDecOp >(op)) {
+                return -1;
+            }
+            if (auto add = mlir::dyn_cast< hl::AddIAssignOp >(op)) {
+                return constant_of(add.getSrc());
+            }
+            if (auto sub = mlir::dyn_cast< hl::SubIAssignOp >(op)) {
+                if (auto step = constant_of(sub.getSrc()); step && *step != INT64_MIN) {
+                    return -*step;
+                }
+            }
+            return std::nullopt;
+        }
+
+        bool writes(mlir::Region &region, mlir_value var) {
+            return region.walk([&] (operation op) {
+                if (referenced_var(written_lvalue(op)) == var) {
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            }).wasInterrupted();
+        }
+
+        bool has_labels(operation loop) {
+            return loop->walk([] (hl::LabelStmt) {
+                return mlir::WalkResult::interrupt();
+            }).wasInterrupted();
+        }
+
+        // Value of the variable at the loop by the nearest preceding write of
+        // its block or of the scopes the loop starts.
+        std::optional< std::int64_t > initial_value(operation loop, mlir_value var) {
+            for (auto at = loop; at; at = at->getParentOp()) {
+                for (auto op = at->getPrevNode(); op; op = op->getPrevNode()) {
+                    if (auto decl = mlir::dyn_cast< hl::VarDeclOp >(op); decl && decl.getResult() == var) {
+                        auto &init = decl.getInitializer();
+                        if (!init.hasOneBlock() || init.front().empty()) {
+                            return std::nullopt;
+                        }
+                        if (auto yield = mlir::dyn_cast< hl::ValueYieldOp >(init.front().back())) {
+                            return constant_of(yield.getResult());
+                        }
+                        return std::nullopt;
+                    }
+
+                    // A jump to the label may skip the write.
+                    if (mlir::isa< hl::LabelStmt >(op)) {
+                        return std::nullopt;
+                    }
+
+                    auto written = llvm::any_of(op->getRegions(), [&] (auto &region) {
+                        return writes(region, var);
+                    }) || referenced_var(written_lvalue(op)) == var;
+
+                    if (!written) {
+                        continue;
+                    }
+
+                    if (auto assign = mlir::dyn_cast< hl::AssignOp >(op)) {
+                        if (referenced_var(assign.getDst()) == var) {
+                            return constant_of(assign.getSrc());
+                        }
+                    }
+
+                    return std::nullopt;
+                }
+
+                if (!mlir::isa_and_nonnull< core::ScopeOp >(at->getParentOp())) {
+                    return std::nullopt;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        std::optional< induction_variable > compute_induction(hl::ForOp loop) {
+            auto &cond = loop.getCondRegion();
+            if (!cond.hasOneBlock()) {
+                return std::nullopt;
+            }
+
+            auto yield = mlir::dyn_cast< hl::CondYieldOp >(cond.front().back());
+            auto cmp = yield ? yield.getResult().getDefiningOp< hl::CmpOp >() : hl::CmpOp();
+            if (!cmp) {
+                return std::nullopt;
+            }
+
+            auto pred  = cmp.getPredicate();
+            auto var   = loaded_var(cmp.getLhs());
+            auto bound = constant_of(cmp.getRhs());
+            if (!var || !bound) {
+                pred  = swapped(pred);
+                var   = loaded_var(cmp.getRhs());
+                bound = constant_of(cmp.getLhs());
+            }
+
+            if (!var || !bound || pred == hl::Predicate::eq || !only_read_or_assigned(var)) {
+                return std::nullopt;
+            }
+
+            if (writes(loop.getCondRegion(), var) || writes(loop.getBodyRegion(), var)) {
+                return std::nullopt;
+            }
+
+            // The increment region has to write the variable exactly once.
+            std::optional< std::int64_t > step;
+            unsigned increments = 0;
+            loop.getIncrRegion().walk([&] (operation op) {
+                if (referenced_var(written_lvalue(op)) == var) {
+                    step = step_of(op);
+                    ++increments;
+                }
+            });
+
+            if (increments != 1 || !step || *step == 0) {
+                return std::nullopt;
+            }
+
+            // Labels of the loop may be entered past its condition.
+            if (has_labels(loop)) {
+                return std::nullopt;
+            }
+
+            auto init = initial_value(loop, var);
+            if (!init) {
+                return std::nullopt;
+            }
+
+            return induction_variable{ var, *init, *step, *bound, pred };
+        }
+
+        // Number of iterations of `for (v = init; v <pred> bound; v += step)`
+        // if the variable reaches the bound without wrapping around.
+        std::optional< std::uint64_t > compute_trip_count(const induction_variable &iv) {
+            auto init = iv.init, step = iv.step, bound = iv.bound;
+
+            bool is_unsigned = iv.predicate == hl::Predicate::ult
+                || iv.predicate == hl::Predicate::ule
+                || iv.predicate == hl::Predicate::ugt
+                || iv.predicate == hl::Predicate::uge;
+            if (is_unsigned && (init < 0 || bound < 0)) {
+                return std::nullopt;
+            }
+
+            // Distance of the values is computed modulo 2^64, it is exact
+            // whenever the larger value is first.
+            auto distance = [] (std::int64_t hi, std::int64_t lo) {
+                return std::uint64_t(hi) - std::uint64_t(lo);
+            };
+
+            auto magnitude = step > 0 ? std::uint64_t(step) : std::uint64_t(0) - std::uint64_t(step);
+
+            // Iterations while `v < hi` for increasing, or `v > lo` for
+            // decreasing variable.
+            auto up_to = [&] (std::int64_t hi) -> std::optional< std::uint64_t > {
+                if (init >= hi) {
+                    return 0;
+                }
+                if (step < 0) {
+                    return std::nullopt;
+                }
+                return llvm::divideCeil(distance(hi, init), magnitude);
+            };
+
+            auto down_to = [&] (std::int64_t lo) -> std::optional< std::uint64_t > {
+                if (init <= lo) {
+                    return 0;
+                }
+                if (step > 0) {
+                    return std::nullopt;
+                }
+                return llvm::divideCeil(distance(init, lo), magnitude);
+            };
+
+            switch (iv.predicate) {
+                case hl::Predicate::slt:
+                case hl::Predicate::ult:
+                    return up_to(bound);
+                case hl::Predicate::sle:
+                case hl::Predicate::ule:
+                    if (bound == INT64_MAX) {
+                        return std::nullopt;
+                    }
+                    return up_to(bound + 1);
+                case hl::Predicate::sgt:
+                case hl::Predicate::ugt:
+                    return down_to(bound);
+                case hl::Predicate::sge:
+                case hl::Predicate::uge:
+                    if (bound == INT64_MIN) {
+                        return std::nullopt;
+                    }
+                    return down_to(bound - 1);
+                case hl::Predicate::ne: {
+                    if (init == bound) {
+                        return 0;
+                    }
+                    if ((bound > init) != (step > 0)) {
+                        return std::nullopt;
+                    }
+                    auto span = bound > init ? distance(bound, init) : distance(init, bound);
+                    if (span % magnitude != 0) {
+                        return std::nullopt;
+                    }
+                    return span / magnitude;
+                }
+                default:
+                    return std::nullopt;
+            }
+        }
+
+    } // namespace
+
+    struct loop_nest_builder
+    {
+        explicit loop_nest_builder(loop_nest_analysis &result) : result(result) {}
+
+        void visit(operation op, loop *parent) {
+            if (loop_nest_analysis::is_loop(op)) {
+                parent = add(op, parent);
+            }
+
+            for (auto &region : op->getRegions()) {
+                for (auto &child : region.getOps()) {
+                    visit(&child, parent);
+                }
+            }
+        }
+
+        loop *add(operation op, loop *parent) {
+            auto &node = result.storage.emplace_back(std::make_unique< loop >());
+            node->op = op;
+            node->parent = parent;
+
+            if (parent) {
+                node->depth = parent->depth + 1;
+                parent->children.push_back(node.get());
+            } else {
+                result.roots.push_back(node.get());
+            }
+
+            if (auto for_loop = mlir::dyn_cast< hl::ForOp >(op)) {
+                node->induction = compute_induction(for_loop);
+                if (node->induction) {
+                    node->trip_count = compute_trip_count(*node->induction);
+                }
+            }
+
+            result.order.push_back(node.get());
+            result.by_op[op] = node.get();
+            return node.get();
+        }
+
+        // Records the jump as an exit of every loop it leaves.
+        void add_exits(operation jump) {
+            auto exits = [&] (const loop *node) {
+                if (mlir::isa< hl::IndirectGotoStmt >(jump) || core::is_return(jump)) {
+                    return true;
+                }
+
+                if (auto go = mlir::dyn_cast< hl::GotoStmt >(jump)) {
+                    return !llvm::any_of(go.getLabel().getUsers(), [&] (operation user) {
+                        return mlir::isa< hl::LabelStmt >(user) && node->op->isProperAncestor(user);
+                    });
+                }
+
+                return false;
+            };
+
+            if (mlir::isa< hl::BreakOp >(jump)) {
+                for (auto op = jump->getParentOp(); op; op = op->getParentOp()) {
+                    if (mlir::isa< hl::SwitchOp >(op)) {
+                        return;
+                    }
+                    if (auto node = result.lookup(op)) {
+                        mutable_loop(node)->exits.push_back(jump);
+                        return;
+                    }
+                }
+                return;
+            }
+
+            for (auto node = result.loop_of(jump); node; node = node->parent) {
+                if (exits(node)) {
+                    mutable_loop(node)->exits.push_back(jump);
+                }
+            }
+        }
+
+        static loop *mutable_loop(const loop *node) { return const_cast< loop * >(node); }
+
+        loop_nest_analysis &result;
+    };
+
+    loop_nest_analysis::loop_nest_analysis(operation root) {
+        loop_nest_builder builder(*this);
+        for (auto &region : root->getRegions()) {
+            for (auto &op : region.getOps()) {
+                builder.visit(&op, nullptr);
+            }
+        }
+
+        if (order.empty()) {
+            return;
+        }
+
+        // Walks in the program order of the jumps, as they have no regions.
+        root->walk([&] (operation op) {
+            if (core::is_return(op) || mlir::isa< hl::GotoStmt, hl::IndirectGotoStmt, hl::BreakOp >(op)) {
+                builder.add_exits(op);
+            }
+        });
+    }
+
+    bool loop_nest_analysis::is_loop(operation op) {
+        return mlir::isa< hl::ForOp, hl::WhileOp, hl::DoOp >(op);
+    }
+
+    const loop *loop_nest_analysis::loop_of(operation op) const {
+        for (auto parent = op->getParentOp(); parent; parent = parent->getParentOp()) {
+            if (auto node = lookup(parent)) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+} // namespace vast::analysis
@@ -0,0 +1,606 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/PointsTo.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Threading.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace vast::analysis
+{
+    namespace
+    {
+        bool is_lvalue(mlir_type type) { return mlir::isa< hl::LValueType >(type); }
+
+        bool is_allocator(string_ref name) {
+            return llvm::StringSwitch< bool >(name)
+                .Cases("malloc", "calloc", "realloc", "aligned_alloc", true)
+                .Cases("strdup", "strndup", true)
+                .Default(false);
+        }
+
+        // Address-of and casts that decay an lvalue to the pointer to its
+        // object copy the lvalue instead of loading it.
+        bool yields_address(operation op) {
+            if (mlir::isa< hl::AddressOf >(op)) {
+                return true;
+            }
+
+            auto decays = [] (hl::CastKind kind) {
+                return kind == hl::CastKind::ArrayToPointerDecay
+                    || kind == hl::CastKind::FunctionToPointerDecay;
+            };
+
+            if (auto cast = mlir::dyn_cast< hl::ImplicitCastOp >(op)) {
+                return decays(cast.getKind());
+            }
+            if (auto cast = mlir::dyn_cast< hl::CStyleCastOp >(op)) {
+                return decays(cast.getKind());
+            }
+            return false;
+        }
+
+    } // namespace
+
+    struct points_to_solver
+    {
+        using node_id       = points_to::node_id;
+        using object_id     = points_to::object_id;
+        using object_kind   = points_to::object_kind;
+        using points_to_set = points_to::points_to_set;
+
+        enum class constraint_kind : std::uint8_t { load, store, field, call };
+
+        //
+        // Constraint over the objects of the points-to set of `src`:
+        //
+        //   load:  dst ⊇ *src
+        //   store: *src ⊇ dst
+        //   field: dst ⊇ { &src->field }
+        //   call:  binds the functions src points to to the call
+        //
+        struct constraint
+        {
+            constraint_kind kind;
+            node_id src;
+            node_id dst = 0;
+            std::uint32_t field = 0;
+            operation call = nullptr;
+            // objects the constraint was already applied to
+            points_to_set done;
+        };
+
+        struct function_info
+        {
+            object_id object;
+            llvm::SmallVector< object_id > params;
+            node_id ret;
+            bool external;
+        };
+
+        points_to_solver(points_to &result, vast_module mod)
+            : result(result), mod(mod), dl(mod), layouts(mod, dl)
+        {}
+
+        points_to &result;
+        vast_module mod;
+        mlir::DataLayout dl;
+        hl::record_layout_cache layouts;
+
+        std::vector< node_id > &parents = result.parents;
+        std::vector< points_to_set > &sets = result.sets;
+        std::vector< llvm::SmallVector< node_id, 2 > > preds;
+        std::vector< constraint > constraints;
+
+        // per object
+        std::vector< node_id > &contents = result.content_nodes;
+        std::vector< llvm::SmallVector< node_id, 1 > > readers;
+        std::vector< llvm::SmallVector< object_id, 1 > > fields_of;
+
+        llvm::DenseMap< std::pair< object_id, std::uint32_t >, object_id > fields;
+        llvm::DenseMap< operation, object_id > variables;
+        llvm::StringMap< object_id > globals;
+        llvm::DenseMap< operation, function_info > functions;
+        llvm::StringMap< operation > functions_by_name;
+
+        bool changed = false;
+
+        //
+        // Graph construction.
+        //
+        node_id make_node() {
+            auto id = node_id(parents.size());
+            parents.push_back(id);
+            sets.emplace_back();
+            preds.emplace_back();
+            return id;
+        }
+
+        node_id node(mlir_value value) {
+            auto [it, inserted] = result.value_nodes.try_emplace(value, 0);
+            if (inserted) {
+                it->second = make_node();
+            }
+            return it->second;
+        }
+
+        object_id make_object(object_kind kind, operation op, std::optional< object_id > parent = std::nullopt, std::uint32_t index = 0) {
+            auto id = object_id(result.objects.size());
+            result.objects.push_back({ kind, op, parent.value_or(id), index });
+            contents.push_back(make_node());
+            readers.emplace_back();
+            fields_of.emplace_back();
+            return id;
+        }
+
+        node_id find(node_id node) {
+            while (parents[node] != node) {
+                parents[node] = parents[parents[node]];
+                node = parents[node];
+            }
+            return node;
+        }
+
+        void add_edge(node_id from, node_id to) {
+            from = find(from);
+            to   = find(to);
+            if (from != to) {
+                preds[to].push_back(from);
+                changed = true;
+            }
+        }
+
+        void add_object(node_id node, object_id object) {
+            if (sets[find(node)].test_and_set(object)) {
+                changed = true;
+            }
+        }
+
+        void add_constraint(constraint_kind kind, node_id src, node_id dst, std::uint32_t field = 0, operation call = nullptr) {
+            constraints.push_back({ kind, src, dst, field, call, {} });
+        }
+
+        //
+        // Objects.
+        //
+        unsigned depth(object_id object) const {
+            unsigned depth = 0;
+            for (; result.objects[object].parent != object; object = result.objects[object].parent) {
+                ++depth;
+            }
+            return depth;
+        }
+
+        // Fields receive what is stored to their record, and readers of the
+        // record read its fields.
+        object_id field_object(object_id record, std::uint32_t index) {
+            if (auto it = fields.find({ record, index }); it != fields.end()) {
+                return it->second;
+            }
+
+            if (depth(record) >= points_to::max_field_depth) {
+                return record;
+            }
+
+            auto field = make_object(object_kind::field, result.objects[record].op, record, index);
+            fields[{ record, index }] = field;
+            fields_of[record].push_back(field);
+
+            add_edge(contents[record], contents[field]);
+            readers[field] = readers[record];
+            for (auto reader : readers[field]) {
+                add_edge(contents[field], reader);
+            }
+
+            return field;
+        }
+
+        void read(object_id object, node_id reader) {
+            add_edge(contents[object], reader);
+            readers[object].push_back(reader);
+            for (auto field : fields_of[object]) {
+                read(field, reader);
+            }
+        }
+
+        //
+        // Constraints of the module.
+        //
+        void declare_symbols() {
+            mod->walk([&] (operation op) {
+                if (auto fn = mlir::dyn_cast< mlir::FunctionOpInterface >(op)) {
+                    function_info info;
+                    info.object   = make_object(object_kind::function, op);
+                    info.ret      = make_node();
+                    info.external = fn.isExternal();
+                    for (unsigned i = 0; i < fn.getNumArguments(); ++i) {
+                        info.params.push_back(make_object(object_kind::parameter, op, std::nullopt, i));
+                    }
+                    functions[op] = std::move(info);
+
+                    // Definitions take precedence over declarations of the name.
+                    auto [it, inserted] = functions_by_name.try_emplace(fn.getName(), op);
+                    if (!inserted && !fn.isExternal()) {
+                        it->second = op;
+                    }
+                } else if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                    auto object = make_object(object_kind::variable, op);
+                    variables[op] = object;
+                    if (!op->getParentOfType< mlir::FunctionOpInterface >()) {
+                        globals.try_emplace(var.getName(), object);
+                    }
+                }
+            });
+        }
+
+        const function_info *function_of(string_ref name) {
+            if (auto it = functions_by_name.find(name); it != functions_by_name.end()) {
+                return &functions[it->second];
+            }
+            return nullptr;
+        }
+
+        void bind_call(operation call, const function_info &callee, mlir::ValueRange args) {
+            for (auto [arg, param] : llvm::zip(args, callee.params)) {
+                add_edge(node(arg), contents[param]);
+            }
+
+            for (auto res : call->getResults()) {
+                add_edge(callee.ret, node(res));
+                if (callee.external) {
+                    for (auto arg : args) {
+                        add_edge(node(arg), node(res));
+                    }
+                }
+            }
+        }
+
+        void call(hl::CallOp call) {
+            auto args = call.getArgOperands();
+            if (auto callee = function_of(call.getCallee())) {
+                if (callee->external && is_allocator(call.getCallee())) {
+                    for (auto res : call->getResults()) {
+                        add_object(node(res), make_object(object_kind::heap, call));
+                    }
+                }
+                return bind_call(call, *callee, args);
+            }
+
+            for (auto res : call->getResults()) {
+                for (auto arg : args) {
+                    add_edge(node(arg), node(res));
+                }
+            }
+        }
+
+        void yield(operation op) {
+            auto parent = op->getParentOp();
+            if (auto var = mlir::dyn_cast< hl::VarDeclOp >(parent)) {
+                if (op->getParentRegion() != &var.getInitializer()) {
+                    return;
+                }
+
+                for (auto value : op->getOperands()) {
+                    add_edge(node(value), contents[variables[var]]);
+                }
+                return;
+            }
+
+            for (auto value : op->getOperands()) {
+                for (auto res : parent->getResults()) {
+                    add_edge(node(value), node(res));
+                }
+            }
+        }
+
+        void member(hl::RecordMemberOp op) {
+            auto base = op.getRecord();
+            auto type = base.getType();
+            if (auto lvalue = mlir::dyn_cast< hl::LValueType >(type)) {
+                type = lvalue.getElementType();
+            }
+
+            std::optional< std::size_t > index;
+            if (hl::name_of_record(type)) {
+                index = layouts.field_idx(type, op.getName());
+            }
+
+            if (!index) {
+                return add_edge(node(base), node(op.getElement()));
+            }
+
+            add_constraint(constraint_kind::field, node(base), node(op.getElement()), std::uint32_t(*index));
+        }
+
+        void generic(operation op) {
+            for (auto res : op->getResults()) {
+                for (auto operand : op->getOperands()) {
+                    if (is_lvalue(operand.getType()) && !is_lvalue(res.getType()) && !yields_address(op)) {
+                        add_constraint(constraint_kind::load, node(operand), node(res));
+                    } else {
+                        add_edge(node(operand), node(res));
+                    }
+                }
+            }
+        }
+
+        void generate(operation op) {
+            if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                return add_object(node(var.getResult()), variables[op]);
+            }
+
+            if (auto fn = mlir::dyn_cast< mlir::FunctionOpInterface >(op)) {
+                if (!fn.isExternal()) {
+                    const auto &info = functions[op];
+                    for (auto [arg, param] : llvm::zip(fn.getArguments(), info.params)) {
+                        add_object(node(arg), param);
+                    }
+                }
+                return;
+            }
+
+            if (auto ref = mlir::dyn_cast< hl::GlobalRefOp >(op)) {
+                if (auto it = globals.find(ref.getGlobal()); it != globals.end()) {
+                    add_object(node(ref.getResult()), it->second);
+                }
+                return;
+            }
+
+            if (auto ref = mlir::dyn_cast< hl::FuncRefOp >(op)) {
+                if (auto callee = function_of(ref.getFunction())) {
+                    add_object(node(ref.getResult()), callee->object);
+                }
+                return;
+            }
+
+            // Plain and compound assignments store the source to the
+            // destination and result in the stored value.
+            if (op->getName().getStringRef().starts_with("hl.assign") && op->getNumOperands() == 2) {
+                auto src = op->getOperand(0);
+                auto dst = op->getOperand(1);
+                add_constraint(constraint_kind::store, node(dst), node(src));
+                for (auto res : op->getResults()) {
+                    add_edge(node(src), node(res));
+                    if (!mlir::isa< hl::AssignOp >(op)) {
+                        add_constraint(constraint_kind::load, node(dst), node(res));
+                    }
+                }
+                return;
+            }
+
+            if (auto member = mlir::dyn_cast< hl::RecordMemberOp >(op)) {
+                return this->member(member);
+            }
+
+            if (auto call = mlir::dyn_cast< hl::CallOp >(op)) {
+                return this->call(call);
+            }
+
+            if (auto call = mlir::dyn_cast< hl::IndirectCallOp >(op)) {
+                return add_constraint(constraint_kind::call, node(call.getCallee()), 0, 0, op);
+            }
+
+            if (auto ret = mlir::dyn_cast< hl::ReturnOp >(op)) {
+                if (auto fn = op->getParentOfType< mlir::FunctionOpInterface >()) {
+                    for (auto value : ret.getResult()) {
+                        add_edge(node(value), functions[fn].ret);
+                    }
+                }
+                return;
+            }
+
+            if (mlir::isa< hl::ValueYieldOp >(op) || op->hasTrait< mlir::OpTrait::IsTerminator >()) {
+                return yield(op);
+            }
+
+            generic(op);
+        }
+
+        //
+        // Solver.
+        //
+        void normalize(node_id node) {
+            auto &list = preds[node];
+            for (auto &pred : list) {
+                pred = find(pred);
+            }
+            llvm::sort(list);
+            list.erase(std::unique(list.begin(), list.end()), list.end());
+            list.erase(std::remove(list.begin(), list.end(), node), list.end());
+        }
+
+        //
+        // Collapses the strongly connected components of the copy graph by
+        // an iterative Tarjan's traversal of the predecessors, which emits
+        // every component after the components it receives from. Components
+        // are grouped by their level, i.e., the longest path from a node
+        // without predecessors.
+        //
+        std::vector< std::vector< node_id > > collapse() {
+            constexpr auto unvisited = std::numeric_limits< std::uint32_t >::max();
+
+            auto size = parents.size();
+            for (node_id node = 0; node < size; ++node) {
+                if (find(node) == node) {
+                    normalize(node);
+                }
+            }
+
+            std::vector< std::uint32_t > index(size, unvisited), low(size), level(size, 0);
+            std::vector< bool > on_stack(size, false);
+            std::vector< node_id > stack;
+            std::vector< std::pair< node_id, std::uint32_t > > frames;
+            std::vector< std::vector< node_id > > levels;
+            std::uint32_t counter = 0;
+
+            auto enter = [&] (node_id node) {
+                index[node] = low[node] = counter++;
+                stack.push_back(node);
+                on_stack[node] = true;
+                frames.emplace_back(node, 0);
+            };
+
+            auto emit = [&] (node_id root) {
+                while (true) {
+                    auto member = stack.back();
+                    stack.pop_back();
+                    on_stack[member] = false;
+                    if (member == root) {
+                        break;
+                    }
+
+                    parents[member] = root;
+                    sets[root] |= sets[member];
+                    sets[member].clear();
+                    preds[root].append(preds[member].begin(), preds[member].end());
+                    preds[member].clear();
+                    ++result._collapsed;
+                }
+                normalize(root);
+
+                std::uint32_t lvl = 0;
+                for (auto pred : preds[root]) {
+                    lvl = std::max(lvl, level[pred] + 1);
+                }
+                level[root] = lvl;
+
+                if (levels.size() <= lvl) {
+                    levels.resize(lvl + 1);
+                }
+                levels[lvl].push_back(root);
+            };
+
+            for (node_id start = 0; start < size; ++start) {
+                if (parents[start] != start || index[start] != unvisited) {
+                    continue;
+                }
+
+                enter(start);
+                while (!frames.empty()) {
+                    auto [node, next] = frames.back();
+                    if (next < preds[node].size()) {
+                        ++frames.back().second;
+                        auto pred = preds[node][next];
+                        if (index[pred] == unvisited) {
+                            enter(pred);
+                        } else if (on_stack[pred]) {
+                            low[node] = std::min(low[node], index[pred]);
+                        }
+                        continue;
+                    }
+
+                    frames.pop_back();
+                    if (!frames.empty()) {
+                        auto caller = frames.back().first;
+                        low[caller] = std::min(low[caller], low[node]);
+                    }
+
+                    if (low[node] == index[node]) {
+                        emit(node);
+                    }
+                }
+            }
+
+            return levels;
+        }
+
+        // Nodes of a level only read the sets of lower levels.
+        void propagate(const std::vector< std::vector< node_id > > &levels) {
+            if (levels.empty()) {
+                return;
+            }
+
+            for (const auto &nodes : llvm::drop_begin(levels)) {
+                mlir::parallelFor(mod.getContext(), 0, nodes.size(), [&] (std::size_t i) {
+                    auto node = nodes[i];
+                    for (auto pred : preds[node]) {
+                        sets[node] |= sets[pred];
+                    }
+                });
+            }
+        }
+
+        void apply(constraint &c, object_id object) {
+            switch (c.kind) {
+                case constraint_kind::load:
+                    return read(object, c.dst);
+                case constraint_kind::store:
+                    return add_edge(c.dst, contents[object]);
+                case constraint_kind::field:
+                    return add_object(c.dst, field_object(object, c.field));
+                case constraint_kind::call: {
+                    const auto &target = result.objects[object];
+                    if (target.kind != object_kind::function) {
+                        return;
+                    }
+                    auto call = mlir::cast< hl::IndirectCallOp >(c.call);
+                    return bind_call(call, functions[target.op], call.getArgOperands());
+                }
+            }
+        }
+
+        void process_constraints() {
+            for (auto &c : constraints) {
+                auto fresh = sets[find(c.src)];
+                fresh.intersectWithComplement(c.done);
+                if (fresh.empty()) {
+                    continue;
+                }
+
+                c.done |= fresh;
+                for (auto object : fresh) {
+                    apply(c, object_id(object));
+                }
+            }
+        }
+
+        void solve() {
+            declare_symbols();
+            mod->walk([&] (operation op) { generate(op); });
+
+            do {
+                ++result._waves;
+                propagate(collapse());
+
+                changed = false;
+                process_constraints();
+            } while (changed);
+
+            for (node_id node = 0; node < parents.size(); ++node) {
+                find(node);
+            }
+        }
+    };
+
+    points_to::points_to(operation root) {
+        points_to_solver(*this, mlir::cast< vast_module >(root)).solve();
+    }
+
+    auto points_to::rep(node_id node) const -> node_id {
+        while (parents[node] != node) {
+            node = parents[node];
+        }
+        return node;
+    }
+
+    auto points_to::pointees(mlir_value value) const -> const points_to_set & {
+        static const points_to_set empty;
+        if (auto it = value_nodes.find(value); it != value_nodes.end()) {
+            return sets[rep(it->second)];
+        }
+        return empty;
+    }
+
+} // namespace vast::analysis
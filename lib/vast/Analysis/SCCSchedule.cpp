@@ -0,0 +1,213 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/SCCSchedule.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Diagnostics.h>
+#include <mlir/IR/MLIRContext.h>
+#include <llvm/Support/ThreadPool.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace vast::analysis
+{
+    namespace
+    {
+        using node_id = call_graph::node_id;
+
+        constexpr auto unvisited = std::numeric_limits< std::uint32_t >::max();
+
+        // Builds rows from the (row, value) pairs, sorted and without
+        // duplicates.
+        template< typename T >
+        void build_rows(
+            std::vector< std::pair< std::uint32_t, T > > pairs, std::size_t rows,
+            std::vector< std::uint32_t > &offsets, std::vector< T > &values
+        ) {
+            std::sort(pairs.begin(), pairs.end());
+            pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+            offsets.assign(rows + 1, 0);
+            values.reserve(pairs.size());
+            for (auto [row, value] : pairs) {
+                ++offsets[row + 1];
+                values.push_back(value);
+            }
+
+            for (std::size_t row = 0; row < rows; ++row) {
+                offsets[row + 1] += offsets[row];
+            }
+        }
+
+    } // namespace
+
+    // Iterative Tarjan, components are completed callees first.
+    call_graph_sccs::call_graph_sccs(const call_graph &graph)
+        : _graph(graph), scc_of(graph.size(), unvisited)
+    {
+        auto size = graph.size();
+
+        std::vector< std::uint32_t > index(size, unvisited);
+        std::vector< std::uint32_t > low(size, 0);
+        std::vector< bool > on_stack(size, false);
+        std::vector< node_id > stack;
+        std::vector< std::pair< node_id, std::size_t > > frames;
+
+        std::uint32_t next_index = 0;
+        std::vector< std::pair< scc_id, node_id > > members;
+        scc_id next_scc = 0;
+
+        for (node_id root = 0; root < size; ++root) {
+            if (index[root] != unvisited) {
+                continue;
+            }
+
+            frames.emplace_back(root, 0);
+            index[root] = low[root] = next_index++;
+            stack.push_back(root);
+            on_stack[root] = true;
+
+            while (!frames.empty()) {
+                auto &[node, next] = frames.back();
+                auto out = graph.callees(node);
+
+                if (next < out.size()) {
+                    auto callee = out[next++].node;
+                    if (index[callee] == unvisited) {
+                        index[callee] = low[callee] = next_index++;
+                        stack.push_back(callee);
+                        on_stack[callee] = true;
+                        frames.emplace_back(callee, 0);
+                    } else if (on_stack[callee]) {
+                        low[node] = std::min(low[node], index[callee]);
+                    }
+                    continue;
+                }
+
+                auto done = node;
+                frames.pop_back();
+                if (!frames.empty()) {
+                    auto parent = frames.back().first;
+                    low[parent] = std::min(low[parent], low[done]);
+                }
+
+                if (low[done] != index[done]) {
+                    continue;
+                }
+
+                node_id member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    on_stack[member] = false;
+                    scc_of[member] = next_scc;
+                    members.emplace_back(next_scc, member);
+                } while (member != done);
+                ++next_scc;
+            }
+        }
+
+        std::vector< std::pair< std::uint32_t, scc_id > > callee_pairs;
+        std::vector< std::pair< std::uint32_t, scc_id > > caller_pairs;
+        for (node_id node = 0; node < size; ++node) {
+            for (auto edge : graph.callees(node)) {
+                auto from = scc_of[node];
+                auto to   = scc_of[edge.node];
+                if (from != to) {
+                    callee_pairs.emplace_back(from, to);
+                    caller_pairs.emplace_back(to, from);
+                }
+            }
+        }
+
+        build_rows(std::move(members), next_scc, member_offsets, member_nodes);
+        build_rows(std::move(callee_pairs), next_scc, callee_offsets, callee_sccs);
+        build_rows(std::move(caller_pairs), next_scc, caller_offsets, caller_sccs);
+    }
+
+    bool call_graph_sccs::recursive(scc_id scc) const {
+        auto nodes = members(scc);
+        if (nodes.size() != 1) {
+            return true;
+        }
+
+        auto node = nodes.front();
+        return llvm::any_of(_graph.callees(node), [&] (auto edge) { return edge.node == node; });
+    }
+
+    logical_result schedule_bottom_up(
+        const call_graph_sccs &sccs, mcontext_t *mctx,
+        llvm::function_ref< logical_result(scc_id) > process,
+        scc_progress progress
+    ) {
+        auto total = sccs.size();
+
+        std::mutex progress_mutex;
+        std::size_t finished = 0;
+        auto report = [&] {
+            if (progress) {
+                std::scoped_lock lock(progress_mutex);
+                progress(++finished, total);
+            }
+        };
+
+        if (total == 0) {
+            return mlir::success();
+        }
+
+        if (!mctx->isMultithreadingEnabled()) {
+            for (scc_id scc = 0; scc < total; ++scc) {
+                if (mlir::failed(process(scc))) {
+                    return mlir::failure();
+                }
+                report();
+            }
+            return mlir::success();
+        }
+
+        // Diagnostics are emitted in the order of the components, as if they
+        // were processed sequentially.
+        mlir::ParallelDiagnosticHandler diagnostics(mctx);
+
+        std::vector< std::atomic< std::uint32_t > > pending(total);
+        for (scc_id scc = 0; scc < total; ++scc) {
+            pending[scc].store(std::uint32_t(sccs.callees(scc).size()), std::memory_order_relaxed);
+        }
+
+        std::atomic< bool > failed = false;
+
+        llvm::ThreadPoolTaskGroup tasks(mctx->getThreadPool());
+        std::function< void(scc_id) > run = [&] (scc_id scc) {
+            if (!failed.load(std::memory_order_relaxed)) {
+                diagnostics.setOrderIDForThread(scc);
+                if (mlir::failed(process(scc))) {
+                    failed = true;
+                }
+                diagnostics.eraseOrderIDForThread();
+            }
+            report();
+
+            // The last finished callee releases the caller, which then sees
+            // everything the callees wrote.
+            for (auto caller : sccs.callers(scc)) {
+                if (pending[caller].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    tasks.async([&run, caller] { run(caller); });
+                }
+            }
+        };
+
+        for (scc_id scc = 0; scc < total; ++scc) {
+            if (sccs.callees(scc).empty()) {
+                tasks.async([&run, scc] { run(scc); });
+            }
+        }
+
+        tasks.wait();
+        return mlir::failure(failed.load());
+    }
+
+} // namespace vast::analysis
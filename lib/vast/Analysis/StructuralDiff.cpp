@@ -0,0 +1,225 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/StructuralDiff.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/IR/Threading.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/STLExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/StructuralHash.hpp"
+
+#include <optional>
+
+namespace vast::analysis
+{
+    namespace
+    {
+        // Functions compared operation by operation have at most this many
+        // pairs of operations left once their common prefix and suffix are
+        // removed.
+        constexpr std::size_t max_compared_pairs = std::size_t(1) << 22;
+
+        using functions_t = llvm::MapVector< llvm::StringRef, mlir::FunctionOpInterface >;
+
+        functions_t functions(operation root) {
+            functions_t result;
+            for (auto &region : root->getRegions()) {
+                for (auto &op : region.getOps()) {
+                    if (auto fn = mlir::dyn_cast< mlir::FunctionOpInterface >(op)) {
+                        result.insert({ mlir::SymbolTable::getSymbolName(fn).getValue(), fn });
+                    }
+                }
+            }
+            return result;
+        }
+
+        struct op_entry
+        {
+            unsigned depth;
+            std::string text;
+
+            bool operator==(const op_entry &) const = default;
+        };
+
+        // Like the structural hash, neither locations, nor attributes of the
+        // meta dialect, nor names of the values are shown.
+        std::string op_text(operation op) {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            os << op->getName();
+
+            for (auto attr : op->getAttrs()) {
+                if (attr.getValue().getDialect().getNamespace() != "meta") {
+                    os << " " << attr.getName().getValue() << " = " << attr.getValue();
+                }
+            }
+
+            if (op->getNumOperands() || op->getNumResults()) {
+                os << " : (";
+                llvm::interleaveComma(op->getOperandTypes(), os);
+                os << ") -> (";
+                llvm::interleaveComma(op->getResultTypes(), os);
+                os << ")";
+            }
+            return os.str();
+        }
+
+        // Operations nested in `fn` in pre-order, `fn` itself first.
+        std::vector< op_entry > flatten(operation fn) {
+            std::vector< op_entry > entries;
+            auto visit = [&] (auto &self, operation op, unsigned depth) -> void {
+                entries.push_back({ depth, op_text(op) });
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto &nested : block) {
+                            self(self, &nested, depth + 1);
+                        }
+                    }
+                }
+            };
+            visit(visit, fn, 0);
+            return entries;
+        }
+
+        changed_function compare(llvm::StringRef name, operation from, operation to) {
+            changed_function result{ name.str(), {}, false };
+
+            auto a = flatten(from);
+            auto b = flatten(to);
+
+            std::size_t prefix = 0;
+            while (prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix]) {
+                ++prefix;
+            }
+
+            std::size_t suffix = 0;
+            while (suffix < a.size() - prefix && suffix < b.size() - prefix
+                && a[a.size() - suffix - 1] == b[b.size() - suffix - 1]
+            ) {
+                ++suffix;
+            }
+
+            auto n = a.size() - prefix - suffix;
+            auto m = b.size() - prefix - suffix;
+
+            auto removed = [&] (std::size_t i) {
+                auto &entry = a[prefix + i];
+                result.lines.push_back({ op_line::kind_t::removed, entry.depth, std::move(entry.text) });
+            };
+
+            auto added = [&] (std::size_t j) {
+                auto &entry = b[prefix + j];
+                result.lines.push_back({ op_line::kind_t::added, entry.depth, std::move(entry.text) });
+            };
+
+            if (n * m > max_compared_pairs) {
+                result.truncated = true;
+                for (std::size_t i = 0; i < n; ++i) {
+                    removed(i);
+                }
+                for (std::size_t j = 0; j < m; ++j) {
+                    added(j);
+                }
+                return result;
+            }
+
+            // Longest common subsequences of the suffixes, fits 16 bits as
+            // the shorter side has at most 2^11 operations.
+            std::vector< std::uint16_t > lcs((n + 1) * (m + 1), 0);
+            auto at = [&] (std::size_t i, std::size_t j) -> std::uint16_t & {
+                return lcs[i * (m + 1) + j];
+            };
+
+            for (auto i = n; i-- > 0;) {
+                for (auto j = m; j-- > 0;) {
+                    at(i, j) = a[prefix + i] == b[prefix + j]
+                        ? std::uint16_t(at(i + 1, j + 1) + 1)
+                        : std::max(at(i + 1, j), at(i, j + 1));
+                }
+            }
+
+            std::size_t i = 0, j = 0;
+            while (i < n || j < m) {
+                if (i < n && j < m && a[prefix + i] == b[prefix + j]) {
+                    ++i, ++j;
+                } else if (j == m || (i < n && at(i + 1, j) >= at(i, j + 1))) {
+                    removed(i++);
+                } else {
+                    added(j++);
+                }
+            }
+
+            return result;
+        }
+
+    } // namespace
+
+    module_diff structural_diff(operation from, operation to) {
+        module_diff result;
+
+        auto before = functions(from);
+        auto after  = functions(to);
+
+        std::vector< std::pair< llvm::StringRef, std::pair< operation, operation > > > matched;
+        for (auto [name, fn] : before) {
+            if (auto it = after.find(name); it != after.end()) {
+                matched.push_back({ name, { fn, it->second } });
+            } else {
+                result.removed.push_back(name.str());
+            }
+        }
+
+        for (auto [name, fn] : after) {
+            if (!before.count(name)) {
+                result.added.push_back(name.str());
+            }
+        }
+
+        std::vector< std::optional< changed_function > > compared(matched.size());
+        mlir::parallelFor(from->getContext(), 0, matched.size(), [&] (std::size_t idx) {
+            auto [name, fns] = matched[idx];
+            auto [a, b] = fns;
+            if (util::structural_hash(a) != util::structural_hash(b)) {
+                compared[idx] = compare(name, a, b);
+            }
+        });
+
+        for (auto &fn : compared) {
+            if (fn) {
+                result.changed.push_back(std::move(*fn));
+            } else {
+                ++result.unchanged;
+            }
+        }
+
+        return result;
+    }
+
+    void module_diff::print(llvm::raw_ostream &os) const {
+        for (const auto &name : removed) {
+            os << "removed: " << name << "\n";
+        }
+
+        for (const auto &name : added) {
+            os << "added: " << name << "\n";
+        }
+
+        for (const auto &fn : changed) {
+            os << "changed: " << fn.name << (fn.truncated ? " (too large to match operations)" : "") << "\n";
+            if (fn.lines.empty()) {
+                os << "  operands or successors differ\n";
+            }
+            for (const auto &line : fn.lines) {
+                os << (line.kind == op_line::kind_t::removed ? "  - " : "  + ");
+                os.indent(2 * line.depth) << line.text << "\n";
+            }
+        }
+
+        os << unchanged << " unchanged functions\n";
+    }
+
+} // namespace vast::analysis
@@ -0,0 +1,145 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Analysis/Summaries.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/IR/Threading.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/ContentHash.hpp"
+#include "vast/Util/StructuralHash.hpp"
+
+#include <algorithm>
+
+namespace vast::analysis
+{
+    namespace
+    {
+        std::optional< std::string > read_entry(const llvm::Twine &path) {
+            auto buffer = llvm::MemoryBuffer::getFile(
+                path, /* text */ false, /* null terminated */ false
+            );
+            if (!buffer) {
+                return std::nullopt;
+            }
+            return buffer.get()->getBuffer().str();
+        }
+
+        void write_entry(string_ref path, string_ref data) {
+            if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path))) {
+                return;
+            }
+
+            // Concurrent runs never observe a partially written entry.
+            llvm::SmallString< 256 > tmp;
+            int fd;
+            if (llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, tmp)) {
+                return;
+            }
+
+            bool written = [&] {
+                llvm::raw_fd_ostream os(fd, /* should close */ true);
+                os << data;
+                os.close();
+                return !os.has_error();
+            } ();
+
+            if (!written || llvm::sys::fs::rename(tmp, path)) {
+                llvm::sys::fs::remove(tmp);
+            }
+        }
+
+    } // namespace
+
+    std::string body_hash(mlir::FunctionOpInterface fn) {
+        return util::structural_hash(fn, /* ignore symbol name */ true).str();
+    }
+
+    std::vector< std::string > summary_keys(const call_graph &graph) {
+        std::vector< std::string > bodies(graph.size());
+        if (graph.size() != 0) {
+            auto *mctx = graph.function(0)->getContext();
+            mlir::parallelFor(mctx, 0, graph.size(), [&] (std::size_t node) {
+                bodies[node] = body_hash(graph.function(call_graph::node_id(node)));
+            });
+        }
+
+        // Callees precede their callers, except for the back edges of cycles.
+        std::vector< std::string > keys(graph.size());
+        graph.post_order([&] (call_graph::node_id node) {
+            std::vector< string_ref > callees;
+            for (auto edge : graph.callees(node)) {
+                const auto &key = keys[edge.node];
+                callees.push_back(key.empty() ? bodies[edge.node] : key);
+            }
+            std::sort(callees.begin(), callees.end());
+
+            content_hasher hash;
+            hash.add(bodies[node]);
+            hash.add(std::uint64_t(graph.calls_unknown(node)));
+            hash.add(std::uint64_t(callees.size()));
+            for (auto callee : callees) {
+                hash.add(callee);
+            }
+            keys[node] = hash.finish();
+        });
+
+        return keys;
+    }
+
+    std::string summary_store::path(string_ref analysis, string_ref key) const {
+        llvm::SmallString< 256 > path(dir);
+        llvm::sys::path::append(path, analysis, key);
+        return path.str().str();
+    }
+
+    std::optional< std::string > summary_store::lookup(string_ref analysis, string_ref key) {
+        auto entry = (analysis + "/" + key).str();
+        {
+            std::scoped_lock lock(mutex);
+            if (auto it = entries.find(entry); it != entries.end()) {
+                ++_hits;
+                return it->second;
+            }
+        }
+
+        if (!dir.empty()) {
+            if (auto summary = read_entry(path(analysis, key))) {
+                std::scoped_lock lock(mutex);
+                ++_hits;
+                entries.try_emplace(entry, *summary);
+                return summary;
+            }
+        }
+
+        std::scoped_lock lock(mutex);
+        ++_misses;
+        return std::nullopt;
+    }
+
+    void summary_store::insert(string_ref analysis, string_ref key, std::string summary) {
+        if (!dir.empty()) {
+            write_entry(path(analysis, key), summary);
+        }
+
+        std::scoped_lock lock(mutex);
+        entries[(analysis + "/" + key).str()] = std::move(summary);
+    }
+
+    std::string summary_store::get(
+        string_ref analysis, string_ref key, llvm::function_ref< std::string() > compute
+    ) {
+        if (auto summary = lookup(analysis, key)) {
+            return std::move(summary.value());
+        }
+
+        auto summary = compute();
+        insert(analysis, key, summary);
+        return summary;
+    }
+
+} // namespace vast::analysis
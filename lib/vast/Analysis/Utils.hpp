@@ -0,0 +1,116 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/STLExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <optional>
+
+//
+// Helpers of the analyses that reason about the values of local variables of
+// hl functions.
+//
+namespace vast::analysis
+{
+    inline mlir::Region *loop_body(operation op) {
+        if (auto loop = mlir::dyn_cast< hl::WhileOp >(op)) {
+            return &loop.getBodyRegion();
+        }
+        if (auto loop = mlir::dyn_cast< hl::ForOp >(op)) {
+            return &loop.getBodyRegion();
+        }
+        if (auto loop = mlir::dyn_cast< hl::DoOp >(op)) {
+            return &loop.getBodyRegion();
+        }
+        return nullptr;
+    }
+
+    // Lvalue the operation assigns or increments in place.
+    inline mlir_value written_lvalue(operation op) {
+        if (mlir::isa< hl::PreIncOp, hl::PostIncOp, hl::PreDecOp, hl::PostDecOp >(op)) {
+            return op->getOperand(0);
+        }
+
+        // Compound assignments take the source first.
+        if (op->getName().getStringRef().starts_with("hl.assign")) {
+            return op->getOperand(1);
+        }
+
+        return {};
+    }
+
+    // Variable the lvalue names directly.
+    inline mlir_value referenced_var(mlir_value lvalue) {
+        if (auto ref = lvalue ? lvalue.getDefiningOp< hl::DeclRefOp >() : hl::DeclRefOp()) {
+            return ref.getDecl();
+        }
+        return {};
+    }
+
+    // Variable whose value the rvalue loads.
+    inline mlir_value loaded_var(mlir_value value) {
+        while (auto cast = value.getDefiningOp< hl::ImplicitCastOp >()) {
+            if (cast.getKind() == hl::CastKind::LValueToRValue) {
+                return referenced_var(cast.getValue());
+            }
+            if (cast.getKind() != hl::CastKind::IntegralCast) {
+                return {};
+            }
+            value = cast.getValue();
+        }
+        return {};
+    }
+
+    inline std::optional< std::int64_t > constant_of(mlir_value value) {
+        if (auto cast = value.getDefiningOp< hl::ImplicitCastOp >()) {
+            if (cast.getKind() == hl::CastKind::IntegralCast) {
+                return constant_of(cast.getValue());
+            }
+        }
+
+        if (auto cst = value.getDefiningOp< hl::ConstantOp >()) {
+            if (auto attr = mlir::dyn_cast< core::IntegerAttr >(cst.getValue())) {
+                if (attr.getValue().getSignificantBits() <= 64) {
+                    return attr.getValue().getExtValue();
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    // Whether the variable is local to its function and every reference of it
+    // is only read or assigned, so that its value is changed only by visible
+    // writes.
+    inline bool only_read_or_assigned(mlir_value var) {
+        auto read_or_assigned = [] (operation user, mlir_value ref) {
+            if (auto cast = mlir::dyn_cast< hl::ImplicitCastOp >(user)) {
+                return cast.getKind() == hl::CastKind::LValueToRValue;
+            }
+            auto written = written_lvalue(user);
+            return written == ref && llvm::count(user->getOperands(), ref) == 1;
+        };
+
+        auto is_local = mlir::isa< mlir::BlockArgument >(var)
+            || (var.getDefiningOp< hl::VarDeclOp >()
+                && var.getDefiningOp()->getParentOfType< mlir::FunctionOpInterface >());
+
+        return is_local && llvm::all_of(var.getUsers(), [&] (operation user) {
+            auto ref = mlir::dyn_cast< hl::DeclRefOp >(user);
+            return ref && llvm::all_of(ref->getUsers(), [&] (operation ref_user) {
+                return read_or_assigned(ref_user, ref.getResult());
+            });
+        });
+    }
+
+} // namespace vast::analysis
@@ -5,8 +5,27 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/GlobalDecl.h>
 #include <clang/Basic/TargetInfo.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <llvm/ADT/ScopeExit.h>
+#include <llvm/ADT/Statistic.h>
+#include <llvm/ADT/StringExtras.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+
+#include "vast/Util/Symbols.hpp"
+
+#include <chrono>
+
+#define DEBUG_TYPE "vast-codegen"
+
+STATISTIC(num_deferred_decls, "Number of deferred global declarations");
+STATISTIC(num_deferred_decls_emitted, "Number of emitted deferred global declarations");
+STATISTIC(num_cached_preambles, "Number of preambles spliced from the header cache");
+STATISTIC(num_cached_instantiations, "Number of instantiation bodies spliced from the instantiation cache");
+STATISTIC(num_declared_instantiations, "Number of instantiations left to the units that emitted them first");
+STATISTIC(num_replaced_symbols, "Number of global symbols replaced at the end of the module");
+
 namespace vast::cg
 {
     defer_handle_of_top_level_decl::defer_handle_of_top_level_decl(
@@ -26,16 +45,64 @@ namespace vast::cg
 
 
     meta_generator_ptr make_meta_generator(codegen_context &cgctx, const cc::vast_args &vargs) {
-        // TODO make configurable based on vast args
         if (vargs.has_option(cc::opt::locs_as_meta_ids)) {
             return std::make_unique< id_meta_gen >(&cgctx.actx, &cgctx.mctx);
         }
+
+        auto mode = vargs.get_option(cc::opt::locs).value_or("full");
+        if (mode == "compact") {
+            return std::make_unique< compact_meta_gen >(&cgctx.actx, &cgctx.mctx, cgctx.mod.get());
+        }
+
+        if (mode == "none") {
+            return std::make_unique< unknown_meta_gen >(&cgctx.mctx);
+        }
+
+        VAST_CHECK(mode == "full", "unknown location mode: {0}", mode);
         return std::make_unique< default_meta_gen >(&cgctx.actx, &cgctx.mctx);
     }
 
+    std::optional< llvm::Regex > make_roots_matcher(const cc::vast_args &vargs) {
+        auto entries = vargs.get_options_list(cc::opt::roots);
+        if (!entries) {
+            return std::nullopt;
+        }
+
+        llvm::Regex matcher("^(" + llvm::join(entries.value(), "|") + ")$");
+
+        std::string error;
+        VAST_CHECK(matcher.isValid(error), "invalid -vast-roots pattern: {0}", error);
+        return matcher;
+    }
+
+    unsupported_mode get_unsupported_mode(const cc::vast_args &vargs) {
+        auto mode = vargs.get_option(cc::opt::unsupported).value_or("full");
+        if (mode == "summary") {
+            return unsupported_mode::summary;
+        }
+        if (mode == "drop") {
+            return unsupported_mode::drop;
+        }
+        VAST_CHECK(mode == "full", "unknown -vast-unsupported mode: {0}", mode);
+        return unsupported_mode::full;
+    }
+
+    void codegen_driver::handle_inline_function_definition(clang::FunctionDecl *decl) {
+        VAST_ASSERT(decl->doesThisDeclarationHaveABody());
+        deferred_inline_member_func_defs.push_back(decl);
+    }
+
     void codegen_driver::finalize() {
+        if (in_preamble) {
+            emit_preamble({});
+        }
+
+        // Inline definitions seen after the last top-level declaration.
+        build_deferred_decls();
+
         codegen.emit_data_layout();
         build_deferred();
+        build_referenced_deferred_decls();
         // TODO: buildVTablesOpportunistically();
         // TODO: applyGlobalValReplacements();
         apply_replacements();
@@ -77,6 +144,116 @@ namespace vast::cg
         // }
 
         // TODO: FINISH THE REST OF THIS
+
+        print_stats();
+    }
+
+    void codegen_driver::enable_stats() {
+        if (!vargs.has_option(cc::opt::codegen_stats)) {
+            return;
+        }
+
+#ifdef VAST_ENABLE_CODEGEN_STATS
+        unsigned top = 10;
+        if (auto value = vargs.get_option(cc::opt::codegen_stats)) {
+            if (value->getAsInteger(10, top)) {
+                VAST_FATAL("invalid -vast-codegen-stats value: {0}", value.value());
+            }
+        }
+
+        codegen.stats.emplace(top);
+#else
+        llvm::errs() << "vast: -vast-codegen-stats requires vast built with "
+                        "VAST_ENABLE_CODEGEN_STATS, no statistics are collected\n";
+#endif
+    }
+
+    void codegen_driver::print_stats() const {
+#ifdef VAST_ENABLE_CODEGEN_STATS
+        if (codegen.stats) {
+            codegen.stats->print(llvm::errs());
+        }
+#endif
+    }
+
+    void codegen_driver::enable_memory_limit() {
+        if (auto limit_kb = cc::opt::memory_limit_kb(vargs)) {
+            memory.emplace(*limit_kb);
+            codegen.memory = &memory.value();
+        }
+    }
+
+    void codegen_driver::enable_function_budget() {
+        if (auto budget_ms = cc::opt::function_budget_ms(vargs)) {
+            budget.emplace(std::chrono::milliseconds(*budget_ms));
+        }
+    }
+
+    void codegen_driver::enable_profile() {
+        if (!opts.codegen.hasProfileClangUse()) {
+            return;
+        }
+
+        std::string error;
+        const auto &path = opts.codegen.ProfileInstrumentUsePath;
+        profile = instr_profile::open(path, opts.vfs, error);
+        if (!profile) {
+            VAST_FATAL("could not read profile {0}: {1}", path, error);
+        }
+    }
+
+    void codegen_driver::check_memory_limit(const clang::Decl *decl) {
+        if (!memory) {
+            return;
+        }
+
+        std::string scope;
+        llvm::raw_string_ostream os(scope);
+        os << "during codegen of ";
+        if (auto named = llvm::dyn_cast< clang::NamedDecl >(decl)) {
+            os << "'" << named->getQualifiedNameAsString() << "'";
+        } else {
+            os << "<" << decl->getDeclKindName() << ">";
+        }
+        os << " (" << decl->getLocation().printToString(acontext().getSourceManager()) << ")";
+
+        memory->scope = os.str();
+        memory->check([&] { return memory->scope; });
+    }
+
+    std::vector< hl::FuncOp > codegen_driver::take_emitted_functions() {
+        std::vector< hl::FuncOp > result;
+        result.swap(emitted_functions);
+        return result;
+    }
+
+    bool codegen_driver::has_lazy_body(string_ref name) const {
+        return lazy_bodies.count(name);
+    }
+
+    hl::FuncOp codegen_driver::materialize_function(string_ref name) {
+        auto it = lazy_bodies.find(name);
+        if (it == lazy_bodies.end()) {
+            return {};
+        }
+
+        auto decl = it->second;
+        lazy_bodies.erase(it);
+
+        auto fn = mlir::cast< hl::FuncOp >(build_global_function_declaration(decl));
+        VAST_CHECK(fn.isDeclaration(), "lazy function {0} already has a body", name);
+
+        defer_handle_of_top_level_decl defer(*this);
+        return build_function_body(fn, decl);
+    }
+
+    bool codegen_driver::is_root(const clang::FunctionDecl *decl) const {
+        VAST_ASSERT(roots);
+        return roots->match(decl->getNameAsString()) || roots->match(cgctx.get_mangled_name(decl).name());
+    }
+
+    bool codegen_driver::is_in_system_header(const clang::Decl *decl) const {
+        return acontext().getSourceManager().isInSystemHeader(decl->getLocation());
     }
 
     bool codegen_driver::verify_module() const {
@@ -102,7 +279,47 @@ namespace vast::cg
         build_deferred_decls();
     }
 
+    bool codegen_driver::starts_main_file(clang::DeclGroupRef decls) const {
+        const auto &sm = acontext().getSourceManager();
+        return llvm::any_of(decls, [&] (const clang::Decl *decl) {
+            return sm.isInMainFile(sm.getExpansionLoc(decl->getBeginLoc()));
+        });
+    }
+
+    void codegen_driver::emit_preamble(clang::SourceLocation end) {
+        in_preamble = false;
+        auto decls = std::exchange(preamble, {});
+
+        auto key = preamble_cache->key(cgctx.actx, end);
+        if (auto fragment = preamble_cache->load(key, cgctx.mctx)) {
+            defer_handle_of_top_level_decl defer(*this);
+            for (auto decl : preamble_cache->splice(std::move(fragment), cgctx, decls)) {
+                handle_top_level_decl(decl);
+            }
+            ++num_cached_preambles;
+            return;
+        }
+
+        for (auto group : decls) {
+            handle_top_level_decl(group);
+        }
+
+        // Incomplete preambles of erroneous translation units are not stored.
+        if (!opts.diags.hasErrorOccurred()) {
+            preamble_cache->store(key, cgctx.mod.get(), cgctx.dl);
+        }
+    }
+
     void codegen_driver::handle_top_level_decl(clang::DeclGroupRef decls) {
+        if (in_preamble) {
+            if (!starts_main_file(decls)) {
+                preamble.push_back(decls);
+                return;
+            }
+
+            emit_preamble((*decls.begin())->getBeginLoc());
+        }
+
         defer_handle_of_top_level_decl defer(*this);
 
         for (auto decl : decls) {
@@ -111,10 +328,27 @@ namespace vast::cg
     }
 
     void codegen_driver::handle_top_level_decl(clang::Decl *decl) {
+        // Tentative definitions are completed after all top-level declarations.
+        if (in_preamble) {
+            emit_preamble({});
+        }
+
         // Ignore dependent declarations
         if (decl->isTemplated())
             return;
 
+        function_arena::scope arena_scope(cgctx.arena);
+        check_memory_limit(decl);
+
+#ifdef VAST_ENABLE_CODEGEN_STATS
+        auto start = std::chrono::steady_clock::now();
+        auto record_time = llvm::make_scope_exit([&] {
+            if (codegen.stats) {
+                codegen.stats->timed(decl, acontext(), std::chrono::steady_clock::now() - start);
+            }
+        });
+#endif
+
         // Consteval function shouldn't be emitted.
         if (auto *fn = llvm::dyn_cast< clang::FunctionDecl >(decl)) {
             if (fn->isConsteval()) {
@@ -181,6 +415,19 @@ namespace vast::cg
             return fn;
         }
 
+        if (lazy_function_bodies) {
+            lazy_bodies[fn.getSymName()] = decl;
+            return fn;
+        }
+
+        std::optional< std::string > instantiation_key;
+        if (instantiations && instantiation_cache::is_cached(function_decl)) {
+            instantiation_key = instantiations->key(fn.getSymName(), function_decl);
+            if (auto cached = emit_cached_instantiation(fn, *instantiation_key)) {
+                return cached;
+            }
+        }
+
         // TODO setGVProperties
         // TODO MaubeHandleStaticInExternC
         // TODO maybeSetTrivialComdat
@@ -188,6 +435,14 @@ namespace vast::cg
 
         fn = build_function_body(fn, decl);
 
+        if (instantiation_key && fn && !instantiations->declarations_only) {
+            instantiations->store(*instantiation_key, fn, cgctx);
+        }
+
+        if (record_emitted_functions) {
+            emitted_functions.push_back(fn);
+        }
+
         // TODO: setNonAliasAttributes
         // TODO: SetLLVMFunctionAttributesForDeclaration
 
@@ -202,6 +457,33 @@ namespace vast::cg
         return fn;
     }
 
+    hl::FuncOp codegen_driver::emit_cached_instantiation(hl::FuncOp fn, string_ref key) {
+        if (instantiations->declarations_only) {
+            if (instantiations->claim(key)) {
+                return {};
+            }
+
+            // Declarations of linkonce functions would never be defined.
+            fn->setAttr("linkage", core::GlobalLinkageKindAttr::get(
+                fn.getContext(), core::GlobalLinkageKind::ExternalLinkage
+            ));
+            ++num_declared_instantiations;
+            return fn;
+        }
+
+        auto entry = instantiations->load(key, cgctx.mctx);
+        if (!entry || !instantiations->splice(std::move(entry), fn, cgctx)) {
+            return {};
+        }
+
+        if (record_emitted_functions) {
+            emitted_functions.push_back(fn);
+        }
+
+        ++num_cached_instantiations;
+        return fn;
+    }
+
     operation codegen_driver::build_global_var_definition(const clang::VarDecl *decl, bool tentative) {
         VAST_UNIMPLEMENTED_IF(lang().OpenCL || lang().OpenMPIsTargetDevice);
 
@@ -210,11 +492,26 @@ namespace vast::cg
         VAST_UNIMPLEMENTED_IF(lang().CUDA);
         VAST_UNIMPLEMENTED_IF(lang().OpenMP);
 
-        return codegen.Visit(decl);
+        auto op = codegen.Visit(decl);
+
+        // Declarations emitted with another type, e.g., of an array of unknown
+        // bound, are replaced by the definition once the module is finished.
+        auto var = mlir::dyn_cast_if_present< hl::VarDeclOp >(op);
+        if (var && decl->isThisDeclarationADefinition() == clang::VarDecl::Definition) {
+            for (const auto *redecl : decl->redecls()) {
+                auto declared = cgctx.vars.lookup(redecl);
+                if (redecl != decl && declared && declared.getType() != var.getType()) {
+                    add_replacement(var.getName(), var);
+                    break;
+                }
+            }
+        }
+
+        return op;
     }
 
-    operation codegen_driver::build_global_decl(const clang::GlobalDecl &/* decl */) {
-        VAST_UNIMPLEMENTED;
+    operation codegen_driver::build_global_decl(const clang::GlobalDecl &decl) {
+        return build_global_definition(decl);
     }
 
     operation codegen_driver::build_global(clang::GlobalDecl decl) {
@@ -232,6 +529,21 @@ namespace vast::cg
 
                 VAST_UNIMPLEMENTED_MSG("FunctionDecl");
             }
+
+            if (roots && !is_root(fn)) {
+                cgctx.set_deferred_decl(cgctx.get_mangled_name(decl), decl);
+                ++num_deferred_decls;
+                return {};
+            }
+
+            if (system_headers_decls_only && is_in_system_header(fn)) {
+                // The prototype has to exist before the definition is deferred,
+                // otherwise its creation would count as the first use.
+                auto proto = build_global_function_declaration(decl);
+                cgctx.set_deferred_decl(cgctx.get_mangled_name(decl), decl);
+                ++num_deferred_decls;
+                return proto;
+            }
         } else {
             const auto *var = llvm::cast< clang::VarDecl >(glob);
             VAST_CHECK(var->isFileVarDecl(), "Cannot emit local var decl as global.");
@@ -263,7 +575,7 @@ namespace vast::cg
         // Defer code generation to first use when possible, e.g. if this is an inline
         // function. If the global mjust always be emitted, do it eagerly if possible
         // to benefit from cache locality.
-        if (may_be_emitted_eagerly(glob)) {
+        if (must_be_emitted(glob) && may_be_emitted_eagerly(glob)) {
             // Emit the definition if it can't be deferred.
             return build_global_definition(glob);
         }
@@ -282,23 +594,38 @@ namespace vast::cg
         if (cgctx.get_global_value(mangled_name) != nullptr) {
             // The value has already been used and should therefore be emitted.
             cgctx.add_deferred_decl_to_emit(decl);
-        } else {
+        } else if (must_be_emitted(glob)) {
             // The value must be emitted, but cannot be emitted eagerly.
             VAST_ASSERT(!may_be_emitted_eagerly(glob));
             cgctx.add_deferred_decl_to_emit(decl);
+        } else {
+            // Otherwise, remember that we saw a deferred decl with this name.
+            // The first use of the mangled name will cause it to move into
+            // the worklist.
+            cgctx.set_deferred_decl(mangled_name, decl);
+            ++num_deferred_decls;
         }
 
         return {};
     }
 
+    bool codegen_driver::must_be_emitted(const clang::ValueDecl *glob) const {
+        if (!lang().CPlusPlus || lang().EmitAllDecls) {
+            return true;
+        }
+
+        return cgctx.actx.DeclMustBeEmitted(glob);
+    }
+
     bool codegen_driver::may_be_emitted_eagerly(const clang::ValueDecl *glob) {
         VAST_UNIMPLEMENTED_IF(lang().OpenMP);
 
         if (const auto *fn = llvm::dyn_cast< clang::FunctionDecl >(glob)) {
             // Implicit template instantiations may change linkage if they are later
             // explicitly instantiated, so they should not be emitted eagerly.
-            constexpr auto implicit = clang::TSK_ImplicitInstantiation;
-            VAST_UNIMPLEMENTED_IF(fn->getTemplateSpecializationKind() == implicit);
+            if (fn->getTemplateSpecializationKind() == clang::TSK_ImplicitInstantiation) {
+                return false;
+            }
             VAST_UNIMPLEMENTED_IF(fn->isTemplated());
             return true;
         }
@@ -327,38 +654,51 @@ namespace vast::cg
         // Emit deferred declare target declarations
         VAST_UNIMPLEMENTED_IF(lang().OpenMP && !lang().OpenMPSimd);
 
-        const auto &deferred_vtables = cgctx.deferred_vtables;
-        const auto &deferred_decls_to_emit = cgctx.deferred_decls_to_emit;
-
         // Emit code for any potentially referenced deferred decls. Since a previously
         // unused static decl may become used during the generation of code for a
         // static function, iterate until no changes are made.
-        VAST_UNIMPLEMENTED_IF(!deferred_vtables.empty());
+        VAST_UNIMPLEMENTED_IF(!cgctx.deferred_vtables.empty());
 
         // Emit CUDA/HIP static device variables referenced by host code only. Note we
         // should not clear CUDADeviceVarODRUsedByHost since it is still needed for
         // further handling.
         VAST_UNIMPLEMENTED_IF(lang().CUDA && lang().CUDAIsDevice);
 
-        // Stop if we're out of both deferred vtables and deferred declarations.
-        if (deferred_decls_to_emit.empty()) {
-            return;
+        // Emit the worklist in the insertion order. If build_global_decl
+        // schedules more work, it is appended to the end of the worklist.
+        // Elements are copied as the worklist may grow during emission.
+        auto &worklist = cgctx.deferred_decls_to_emit;
+        for (std::size_t idx = 0; idx < worklist.size(); ++idx) {
+            auto decl = worklist[idx];
+            build_global_decl(decl);
+            ++num_deferred_decls_emitted;
         }
 
-        // Grab the list of decls to emit. If build_global_definition schedules more
-        // work, it will not interfere with this.
-        auto curr_decls_to_emit = cgctx.receive_deferred_decls_to_emit();
-        for (auto &decl : curr_decls_to_emit) {
-            build_global_decl(decl);
+        worklist.clear();
+    }
+
+    void codegen_driver::build_referenced_deferred_decls() {
+        auto &deferred = cgctx.deferred_decls;
+
+        bool changed = true;
+        while (changed && !deferred.empty()) {
+            changed = false;
+
+            auto uses = mlir::SymbolTable::getSymbolUses(cgctx.mod->getOperation());
+            if (!uses) {
+                return;
+            }
 
-            // FIXME: rework to worklist?
-            // If we found out that we need to emit more decls, do that recursively.
-            // This has the advantage that the decls are emitted in a DFS and related
-            // ones are close together, which is convenient for testing.
-            if (!deferred_vtables.empty() || !deferred_decls_to_emit.empty()) {
-                build_deferred();
-                VAST_ASSERT(deferred_vtables.empty() && deferred_decls_to_emit.empty());
+            for (const auto &use : uses.value()) {
+                auto name = use.getSymbolRef().getRootReference();
+                if (auto it = deferred.find(mangled_name_ref{ name }); it != deferred.end()) {
+                    cgctx.add_deferred_decl_to_emit(it->second);
+                    deferred.erase(it);
+                    changed = true;
+                }
             }
+
+            build_deferred();
         }
     }
 
@@ -367,9 +707,88 @@ namespace vast::cg
     }
 
     void codegen_driver::apply_replacements() {
-        if (!replacements.empty()) {
-            VAST_UNIMPLEMENTED_MSG(" function replacement in module release");
+        if (replacements.empty()) {
+            return;
         }
+
+        auto mod = cgctx.mod.get();
+
+        auto name_of = [] (operation op) -> std::optional< string_ref > {
+            if (auto symbol = mlir::dyn_cast< util::vast_symbol_interface >(op)) {
+                return util::symbol_name(symbol);
+            }
+            if (auto symbol = mlir::dyn_cast< util::mlir_symbol_interface >(op)) {
+                return util::symbol_name(symbol);
+            }
+            return std::nullopt;
+        };
+
+        // Replaced symbols are found in one pass over the module body.
+        llvm::DenseMap< mlir::StringAttr, mlir::StringAttr > renamed;
+        llvm::SmallVector< std::pair< operation, operation > > replaced;
+        for (auto &op : mod.getBody()->getOperations()) {
+            auto name = name_of(&op);
+            if (!name) {
+                continue;
+            }
+
+            auto it = replacements.find(*name);
+            if (it == replacements.end() || it->second == &op) {
+                continue;
+            }
+
+            auto replacement = it->second;
+            auto new_name = name_of(replacement);
+            VAST_CHECK(new_name, "replacement of {0} is not a symbol", *name);
+
+            renamed.try_emplace(
+                mlir::StringAttr::get(mod.getContext(), *name),
+                mlir::StringAttr::get(mod.getContext(), *new_name)
+            );
+            replaced.emplace_back(&op, replacement);
+        }
+
+        // Uses of all the replaced symbols are redirected in a single walk,
+        // rather than a walk of the module per replaced symbol.
+        if (!renamed.empty()) {
+            mlir::AttrTypeReplacer replacer;
+            replacer.addReplacement([&] (mlir::SymbolRefAttr ref)
+                -> std::optional< std::pair< mlir_attr, mlir::WalkResult > >
+            {
+                auto it = renamed.find(ref.getRootReference());
+                if (it == renamed.end()) {
+                    return std::nullopt;
+                }
+                return { {
+                    mlir::SymbolRefAttr::get(it->second, ref.getNestedReferences()),
+                    mlir::WalkResult::skip()
+                } };
+            });
+
+            mod.walk([&] (operation op) {
+                // Global variables are referenced by their names.
+                if (auto ref = mlir::dyn_cast< hl::GlobalRefOp >(op)) {
+                    if (auto it = renamed.find(ref.getGlobalAttr()); it != renamed.end()) {
+                        ref.setGlobalAttr(it->second);
+                    }
+                }
+
+                replacer.replaceElementsIn(op,
+                    /* replace attrs */ true, /* replace locs */ false, /* replace types */ false
+                );
+            });
+        }
+
+        for (auto [old, replacement] : replaced) {
+            // Vast symbols are used through their results.
+            if (old->getNumResults() == replacement->getNumResults()) {
+                old->replaceAllUsesWith(replacement);
+            }
+            old->erase();
+            ++num_replaced_symbols;
+        }
+
+        replacements.clear();
     }
 
 } // namespace vast::cg
@@ -5,10 +5,28 @@
 VAST_RELAX_WARNINGS
 #include <clang/AST/GlobalDecl.h>
 #include <clang/Basic/TargetInfo.h>
+#include <llvm/ADT/ScopeExit.h>
 VAST_UNRELAX_WARNINGS
 
 namespace vast::cg
 {
+    void stub_function_body(hl::FuncOp fn, string_ref reason) {
+        // Functions are isolated from above, once the references inside of
+        // the body are dropped, nothing refers to its operations.
+        auto &body = fn.getBody();
+        body.dropAllReferences();
+        body.getBlocks().clear();
+
+        mlir::OpBuilder bld(fn.getContext());
+        bld.setInsertionPointToStart(fn.addEntryBlock());
+
+        auto loc = fn.getLoc();
+        bld.create< unsup::UnsupportedStmt >(
+            loc, reason, mlir_type(), std::vector< BuilderCallBackFn >{}
+        );
+        bld.create< hl::UnreachableOp >(loc);
+    }
+
     bool codegen_driver::may_drop_function_return(clang::QualType rty) const {
         // We can't just disard the return value for a record type with a complex
         // destructor or a non-trivially copyable type.
@@ -97,8 +115,39 @@ namespace vast::cg
 
     // This function implements the logic from CodeGenFunction::GenerateCode
     hl::FuncOp codegen_driver::build_function_body(hl::FuncOp fn, clang::GlobalDecl decl) {
+        function_arena::scope arena_scope(cgctx.arena);
+        check_memory_limit(decl.getDecl());
+
+        auto fn_profile = profile_of(fn, decl);
+        if (fn_profile) {
+            auto mctx = fn.getContext();
+            fn->setAttr(
+                hl::HighLevelDialect::getEntryCountAttrName(),
+                mlir::IntegerAttr::get(mlir::IntegerType::get(mctx, 64), fn_profile->entry_count)
+            );
+            if (fn_profile->hot) {
+                fn->setAttr(hl::HighLevelDialect::getProfileHotAttrName(), mlir::UnitAttr::get(mctx));
+            }
+            codegen.profile = &fn_profile.value();
+        }
+
+        // The budget is checked only while the body is generated, hot
+        // functions are always generated in full.
+        if (budget && !(fn_profile && fn_profile->hot)) {
+            budget->start();
+            codegen.budget = &budget.value();
+        }
+        auto release_budget = llvm::make_scope_exit([&] {
+            codegen.budget  = nullptr;
+            codegen.profile = nullptr;
+        });
+
         fn = codegen.emit_function_prologue(fn, decl, opts);
 
+        if (codegen.out_of_budget()) {
+            return stub_over_budget(fn, decl);
+        }
+
         if (mlir::failed(fn.verifyBody())) {
             return nullptr;
         }
@@ -106,4 +155,32 @@ namespace vast::cg
         return emit_function_epilogue(fn, decl);
     }
 
+    std::optional< function_profile > codegen_driver::profile_of(
+        hl::FuncOp fn, clang::GlobalDecl decl
+    ) const {
+        if (!profile || profile->is_ir_level()) {
+            return std::nullopt;
+        }
+
+        auto function_decl = llvm::dyn_cast< clang::FunctionDecl >(decl.getDecl());
+        if (!function_decl || !function_decl->hasBody()) {
+            return std::nullopt;
+        }
+
+        return profile->of(function_decl, fn.getSymName(), opts.codegen.MainFileName);
+    }
+
+    hl::FuncOp codegen_driver::stub_over_budget(hl::FuncOp fn, clang::GlobalDecl decl) {
+        stub_function_body(fn, "FunctionBudget");
+
+        std::string name = "<anonymous>";
+        if (auto named = llvm::dyn_cast< clang::NamedDecl >(decl.getDecl())) {
+            name = named->getQualifiedNameAsString();
+        }
+
+        fn.emitRemark() << "codegen of '" << name << "' exceeded the function budget of "
+                        << budget->limit.count() << " ms, its body is replaced by a stub";
+        return fn;
+    }
+
 } // namespace vast::cg
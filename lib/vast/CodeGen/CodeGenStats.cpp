@@ -0,0 +1,110 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/CodeGenStats.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/SourceManager.h>
+#include <llvm/Support/Format.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+
+namespace vast::cg
+{
+    namespace
+    {
+        double milliseconds(codegen_stats::duration time) {
+            return std::chrono::duration< double, std::milli >(time).count();
+        }
+
+        std::string describe(const clang::Decl *decl, const acontext_t &actx) {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+
+            if (auto named = llvm::dyn_cast< clang::NamedDecl >(decl)) {
+                os << named->getQualifiedNameAsString();
+            } else {
+                os << "<" << decl->getDeclKindName() << ">";
+            }
+
+            os << " (" << decl->getLocation().printToString(actx.getSourceManager()) << ")";
+            return text;
+        }
+
+    } // namespace
+
+    void codegen_stats::timed(const clang::Decl *decl, const acontext_t &actx, duration time) {
+        ++timed_decls;
+        total_time += time;
+
+        if (top == 0) {
+            return;
+        }
+
+        auto faster = [] (const timed_decl &a, const timed_decl &b) { return a.time > b.time; };
+
+        if (slowest.size() < top) {
+            slowest.push_back({ time, describe(decl, actx) });
+            std::push_heap(slowest.begin(), slowest.end(), faster);
+            return;
+        }
+
+        // The declaration is named only if it is among the slowest ones.
+        if (time <= slowest.front().time) {
+            return;
+        }
+
+        std::pop_heap(slowest.begin(), slowest.end(), faster);
+        slowest.back() = { time, describe(decl, actx) };
+        std::push_heap(slowest.begin(), slowest.end(), faster);
+    }
+
+    void codegen_stats::print(llvm::raw_ostream &os) const {
+        auto print_kinds = [&] (string_ref category, const counters &kinds) {
+            if (kinds.empty()) {
+                return;
+            }
+
+            std::vector< std::pair< string_ref, counter > > sorted;
+            for (const auto &entry : kinds) {
+                sorted.emplace_back(entry.getKey(), entry.getValue());
+            }
+
+            std::sort(sorted.begin(), sorted.end(), [] (const auto &a, const auto &b) {
+                if (a.second.visits != b.second.visits) {
+                    return a.second.visits > b.second.visits;
+                }
+                return a.first < b.first;
+            });
+
+            os << "  " << category << ":\n";
+            for (const auto &[kind, count] : sorted) {
+                os << llvm::format("    %10llu %10llu  ",
+                    static_cast< unsigned long long >(count.visits),
+                    static_cast< unsigned long long >(count.fallbacks)
+                ) << kind << "\n";
+            }
+        };
+
+        os << "===- vast codegen statistics -===\n";
+        os << "  visits / fallbacks per node kind\n";
+        print_kinds("Stmt", stmts);
+        print_kinds("Decl", decls);
+        print_kinds("Type", types);
+        print_kinds("Attr", attrs);
+
+        os << llvm::format("  top-level declarations: %llu in %.3f ms\n",
+            static_cast< unsigned long long >(timed_decls), milliseconds(total_time)
+        );
+
+        auto sorted = slowest;
+        std::sort(sorted.begin(), sorted.end(), [] (const auto &a, const auto &b) {
+            return a.time > b.time;
+        });
+
+        for (const auto &decl : sorted) {
+            os << llvm::format("    %10.3f ms  ", milliseconds(decl.time)) << decl.name << "\n";
+        }
+    }
+
+} // namespace vast::cg
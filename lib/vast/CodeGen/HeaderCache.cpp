@@ -0,0 +1,394 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/HeaderCache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/LangOptions.h>
+#include <clang/Basic/SourceManager.h>
+#include <clang/Basic/TargetInfo.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/Diagnostics.h>
+#include <mlir/Parser/Parser.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Version.inc"
+
+namespace vast::cg
+{
+    void add_language_options(content_hasher &hash, const clang::LangOptions &opts) {
+        #define LANGOPT(Name, Bits, Default, Description) \
+            hash.add(std::uint64_t(opts.Name));
+        #define ENUM_LANGOPT(Name, Type, Bits, Default, Description) \
+            hash.add(std::uint64_t(opts.get##Name()));
+        #include <clang/Basic/LangOptions.def>
+    }
+
+    namespace
+    {
+        // Bumped whenever the layout of the entries changes.
+        constexpr string_ref format = "vast-header-cache-1";
+
+        // Operations of the fragment that carry codegen state, by their kind
+        // and name, in the order in which they were generated.
+        struct fragment_symbols
+        {
+            explicit fragment_symbols(vast_module fragment) {
+                fragment->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+                    if (mlir::isa< hl::FuncOp >(op)) {
+                        return mlir::WalkResult::skip();
+                    }
+
+                    if (mlir::isa< hl::VarDeclOp, hl::TypeDefOp, hl::TypeDeclOp, hl::EnumDeclOp >(op)) {
+                        auto name = op->getAttrOfType< mlir::StringAttr >("name");
+                        symbols[key(op->getName().getStringRef(), name.getValue())].ops.push_back(op);
+                    }
+
+                    return mlir::WalkResult::advance();
+                });
+            }
+
+            template< typename op_t >
+            op_t take(string_ref name) {
+                auto it = symbols.find(key(op_t::getOperationName(), name));
+                if (it == symbols.end() || it->second.next == it->second.ops.size()) {
+                    return {};
+                }
+
+                auto &entry = it->second;
+                return mlir::cast< op_t >(entry.ops[entry.next++]);
+            }
+
+            static std::string key(string_ref kind, string_ref name) {
+                return (kind + "/" + name).str();
+            }
+
+            struct entry
+            {
+                llvm::SmallVector< operation, 1 > ops;
+                std::size_t next = 0;
+            };
+
+            llvm::StringMap< entry > symbols;
+        };
+
+        struct preamble_binder
+        {
+            // Returns false if the declaration has no generated counterpart.
+            bool bind(const clang::Decl *decl) {
+                if (auto var = clang::dyn_cast< clang::VarDecl >(decl)) {
+                    return bind_var(var);
+                }
+
+                if (auto def = clang::dyn_cast< clang::TypedefDecl >(decl)) {
+                    return bind_typedef(def);
+                }
+
+                if (auto en = clang::dyn_cast< clang::EnumDecl >(decl)) {
+                    return bind_enum(en);
+                }
+
+                if (auto record = clang::dyn_cast< clang::RecordDecl >(decl)) {
+                    return bind_record(record);
+                }
+
+                // Functions are bound by their symbols, other declarations
+                // leave no state behind.
+                return true;
+            }
+
+            bool bind_var(const clang::VarDecl *decl) {
+                if (cgctx.vars.lookup(decl)) {
+                    return true;
+                }
+
+                auto var = symbols.take< hl::VarDeclOp >(cgctx.decl_name(decl->getUnderlyingDecl()));
+                if (!var) {
+                    return false;
+                }
+
+                return succeeded(cgctx.vars.declare(decl, var.getResult()));
+            }
+
+            bool bind_typedef(const clang::TypedefDecl *decl) {
+                if (cgctx.typedefs.lookup(decl)) {
+                    return true;
+                }
+
+                auto def = symbols.take< hl::TypeDefOp >(decl->getName());
+                if (!def) {
+                    return false;
+                }
+
+                return succeeded(cgctx.typedefs.declare(decl, def));
+            }
+
+            bool bind_enum(const clang::EnumDecl *decl) {
+                if (cgctx.enumdecls.lookup(decl)) {
+                    return true;
+                }
+
+                // Redeclarations complete the operation of the first declaration.
+                if (!decl->isFirstDecl()) {
+                    for (auto prev = decl->getPreviousDecl(); prev; prev = prev->getPreviousDecl()) {
+                        if (auto op = cgctx.enumdecls.lookup(prev)) {
+                            return bind_constants(decl, op);
+                        }
+                    }
+                    return false;
+                }
+
+                auto op = symbols.take< hl::EnumDeclOp >(decl->getName());
+                if (!op || failed(cgctx.enumdecls.declare(decl, op))) {
+                    return false;
+                }
+
+                return bind_constants(decl, op);
+            }
+
+            bool bind_constants(const clang::EnumDecl *decl, hl::EnumDeclOp op) {
+                if (!decl->isComplete() || op.getConstants().empty()) {
+                    return true;
+                }
+
+                auto constants = op.getConstants().front().getOps< hl::EnumConstantOp >();
+                for (auto [con, val] : llvm::zip(decl->enumerators(), constants)) {
+                    if (failed(cgctx.enumconsts.declare(con, val))) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            bool bind_record(const clang::RecordDecl *decl) {
+                // Names of tags tell field declarations that their types are
+                // already defined.
+                cgctx.decl_name(decl);
+
+                if (!decl->isCompleteDefinition()) {
+                    if (cgctx.typedecls.lookup(decl)) {
+                        return true;
+                    }
+
+                    // A missing forward declaration is harmless, types
+                    // refer to records by their names.
+                    if (auto op = symbols.take< hl::TypeDeclOp >(decl->getName())) {
+                        return succeeded(cgctx.typedecls.declare(decl, op));
+                    }
+                    return true;
+                }
+
+                for (auto child : decl->decls()) {
+                    if (auto tag = clang::dyn_cast< clang::TagDecl >(child)) {
+                        bind(tag);
+                    }
+                }
+
+                return true;
+            }
+
+            codegen_context &cgctx;
+            fragment_symbols &symbols;
+        };
+
+    } // namespace
+
+    header_cache::header_cache(string_ref dir, const cc::vast_args &vargs)
+        : dir(dir.str()), compression(cc::get_bytecode_compression(vargs))
+    {
+        for (auto arg : vargs.args) {
+            if (!string_ref(arg).starts_with(cc::vast_option_prefix.str() + cc::opt::header_cache.str())) {
+                flags += arg;
+                flags += '\0';
+            }
+        }
+    }
+
+    std::string header_cache::entry_path(string_ref key) const {
+        llvm::SmallString< 256 > path(dir);
+        llvm::sys::path::append(path, key + ".mlirbc");
+        return path.str().str();
+    }
+
+    std::string header_cache::key(const acontext_t &actx, clang::SourceLocation end) const {
+        content_hasher hash;
+        hash.add(format);
+        hash.add(VAST_VERSION_STRING);
+        hash.add(flags);
+
+        const auto &target = actx.getTargetInfo();
+        hash.add(target.getTriple().str());
+        hash.add(target.getDataLayoutString());
+        add_language_options(hash, actx.getLangOpts());
+
+        const auto &sm = actx.getSourceManager();
+        auto main = sm.getMainFileID();
+        auto main_offset = sm.getSLocEntry(main).getOffset();
+
+        // Files in the order in which they were entered, together with
+        // the predefines and command line buffers. A file included more
+        // than once is hashed with every inclusion.
+        for (unsigned idx = 0; idx < sm.local_sloc_entry_size(); ++idx) {
+            const auto &entry = sm.getLocalSLocEntry(idx);
+            if (!entry.isFile()) {
+                continue;
+            }
+
+            const auto &file = entry.getFile();
+            auto buffer = file.getContentCache().getBufferIfLoaded();
+
+            // The name of the main file does not matter, only its preamble.
+            if (entry.getOffset() == main_offset) {
+                auto text = buffer ? buffer->getBuffer() : string_ref();
+                if (end.isValid()) {
+                    auto [fid, offset] = sm.getDecomposedExpansionLoc(end);
+                    if (fid == main) {
+                        text = text.take_front(offset);
+                    }
+                }
+                hash.add("<main>");
+                hash.add(text);
+                continue;
+            }
+
+            hash.add(file.getName());
+            hash.add(buffer ? buffer->getBuffer() : string_ref());
+        }
+
+        return hash.finish();
+    }
+
+    owning_module_ref header_cache::load(string_ref key, mcontext_t &mctx) const {
+        auto path = entry_path(key);
+        if (!llvm::sys::fs::exists(path)) {
+            return {};
+        }
+
+        auto buffer = llvm::MemoryBuffer::getFile(path, /* text */ false, /* null terminated */ false);
+        if (!buffer) {
+            return {};
+        }
+
+        // A damaged entry is a miss, it is replaced once the preamble is
+        // generated again.
+        auto bytes = compression.decompress((*buffer)->getBuffer().str());
+        if (!bytes) {
+            return {};
+        }
+
+        mlir::ScopedDiagnosticHandler silence(&mctx, [] (mlir::Diagnostic &) {
+            return mlir::success();
+        });
+
+        mlir::ParserConfig config(&mctx);
+        return mlir::parseSourceString< vast_module >(*bytes, config);
+    }
+
+    void header_cache::store(string_ref key, vast_module mod, const dl::DataLayoutBlueprint &dl) const {
+        if (llvm::sys::fs::create_directories(dir)) {
+            return;
+        }
+
+        auto &mctx = *mod.getContext();
+        owning_module_ref fragment(mod.clone());
+        fragment->getOperation()->setAttr(mlir::DLTIDialect::kDataLayoutAttrName, dl.wrap(mctx));
+
+        std::string bytes;
+        {
+            llvm::raw_string_ostream os(bytes);
+            if (failed(mlir::writeBytecodeToFile(fragment.get(), os))) {
+                return;
+            }
+        }
+        bytes = compression.compress(std::move(bytes));
+
+        // Concurrent compilations never observe a partially written entry.
+        auto path = entry_path(key);
+        llvm::SmallString< 256 > tmp;
+        int fd;
+        if (llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, tmp)) {
+            return;
+        }
+
+        bool written = [&] {
+            llvm::raw_fd_ostream os(fd, /* should close */ true);
+            os << bytes;
+            os.close();
+            return !os.has_error();
+        } ();
+
+        if (!written || llvm::sys::fs::rename(tmp, path)) {
+            llvm::sys::fs::remove(tmp);
+        }
+    }
+
+    std::vector< clang::Decl * > header_cache::splice(
+        owning_module_ref fragment, codegen_context &cgctx,
+        llvm::ArrayRef< clang::DeclGroupRef > preamble
+    ) const {
+        if (auto spec = fragment->getOperation()->getAttrOfType< mlir::DataLayoutSpecAttr >(
+                mlir::DLTIDialect::kDataLayoutAttrName
+            )) {
+            for (auto entry : spec.getEntries()) {
+                cgctx.dl.add(mlir::dyn_cast< mlir_type >(entry.getKey()), dl::DLEntry(entry));
+            }
+        }
+
+        // Functions, including implicitly declared builtins, are bound by
+        // their symbols, whose names are owned by the context.
+        for (auto fn : fragment->getOps< hl::FuncOp >()) {
+            if (!cgctx.funcdecls.lookup(mangled_name_ref{ fn.getSymNameAttr() })) {
+                std::ignore = cgctx.funcdecls.declare(mangled_name_ref{ fn.getSymNameAttr() }, fn);
+            }
+        }
+
+        fragment_symbols symbols(fragment.get());
+        preamble_binder binder{ cgctx, symbols };
+
+        std::vector< clang::Decl * > missing;
+        for (auto group : preamble) {
+            for (auto decl : group) {
+                if (!binder.bind(decl)) {
+                    missing.push_back(decl);
+                }
+            }
+        }
+
+        auto &body = cgctx.mod->getBody()->getOperations();
+        body.splice(body.end(), fragment->getBody()->getOperations());
+        return missing;
+    }
+
+    std::optional< header_cache > make_header_cache(
+        const codegen_context &cgctx, const cc::vast_args &vargs
+    ) {
+        auto dir = vargs.get_option(cc::opt::header_cache);
+        if (!dir || dir->empty()) {
+            return std::nullopt;
+        }
+
+        if (cgctx.actx.getLangOpts().CPlusPlus) {
+            return std::nullopt;
+        }
+
+        for (auto opt : {
+            cc::opt::roots, cc::opt::system_headers_decls_only, cc::opt::lazy_function_bodies,
+            cc::opt::stream_functions, cc::opt::locs_as_meta_ids
+        }) {
+            if (vargs.has_option(opt)) {
+                return std::nullopt;
+            }
+        }
+
+        if (vargs.get_option(cc::opt::locs).value_or("full") == "compact") {
+            return std::nullopt;
+        }
+
+        return header_cache(dir.value(), vargs);
+    }
+
+} // namespace vast::cg
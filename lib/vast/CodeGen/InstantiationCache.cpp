@@ -0,0 +1,427 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/InstantiationCache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ODRHash.h>
+#include <clang/Basic/TargetInfo.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <mlir/IR/Diagnostics.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Parser/Parser.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/HeaderCache.hpp"
+#include "vast/Util/ContentHash.hpp"
+#include "vast/Version.inc"
+
+#include <mutex>
+
+namespace vast::cg
+{
+    namespace
+    {
+        // Bumped whenever the layout of the entries changes.
+        constexpr string_ref format = "vast-instantiation-cache-1";
+
+        // Entries of all translation units of the process, as bytecode.
+        // Instantiations emitted as declarations only are marked by empty
+        // entries.
+        struct process_entries
+        {
+            std::mutex mutex;
+            llvm::StringMap< std::string > entries;
+        };
+
+        process_entries &entries_of_process() {
+            static process_entries entries;
+            return entries;
+        }
+
+        bool is_named_decl(operation op) {
+            return mlir::isa<
+                hl::StructDeclOp, hl::UnionDeclOp, hl::ClassDeclOp, hl::CxxStructDeclOp,
+                hl::EnumDeclOp, hl::TypeDefOp, hl::TypeDeclOp, hl::VarDeclOp
+            >(op);
+        }
+
+        // Visits all types of the function, including the types nested in
+        // other types and in attributes.
+        void walk_types(hl::FuncOp fn, auto &&visit) {
+            auto walk = [&] (mlir_type type) {
+                type.walk([&] (mlir_type nested) { visit(nested); });
+            };
+
+            fn->walk([&] (operation op) {
+                op->getAttrDictionary().walk([&] (mlir_type type) { visit(type); });
+                for (auto type : op->getResultTypes()) {
+                    walk(type);
+                }
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto type : block.getArgumentTypes()) {
+                            walk(type);
+                        }
+                    }
+                }
+            });
+        }
+
+        // Names of the definition that the translation unit has to declare.
+        struct referenced_names
+        {
+            explicit referenced_names(hl::FuncOp fn) {
+                walk_types(fn, [&] (mlir_type type) {
+                    if (auto record = mlir::dyn_cast< hl::RecordType >(type)) {
+                        used.insert(record.getName());
+                    } else if (auto en = mlir::dyn_cast< hl::EnumType >(type)) {
+                        used.insert(en.getName());
+                    } else if (auto def = mlir::dyn_cast< hl::TypedefType >(type)) {
+                        used.insert(def.getName());
+                    }
+                });
+
+                fn.getBody().walk([&] (operation op) {
+                    if (auto ref = mlir::dyn_cast< hl::GlobalRefOp >(op)) {
+                        used.insert(ref.getGlobal());
+                    } else if (is_named_decl(op)) {
+                        local.insert(op->getAttrOfType< mlir::StringAttr >("name").getValue());
+                    }
+                });
+            }
+
+            // Names the body does not declare itself.
+            auto external() const {
+                return llvm::make_filter_range(used.keys(), [&] (string_ref name) {
+                    return !local.contains(name);
+                });
+            }
+
+            llvm::StringSet<> used;
+            llvm::StringSet<> local;
+        };
+
+    } // namespace
+
+    instantiation_cache::instantiation_cache(
+        std::optional< string_ref > dir, bool declarations_only,
+        const acontext_t &actx, const cc::vast_args &vargs
+    )
+        : declarations_only(declarations_only)
+    {
+        // Markers of declarations are meaningful only for the units of the
+        // process, another process would never emit the definitions.
+        if (dir && !declarations_only) {
+            this->dir = dir->str();
+            compression = cc::get_bytecode_compression(vargs);
+        }
+
+        content_hasher hash;
+        hash.add(format);
+        hash.add(VAST_VERSION_STRING);
+
+        auto prefix = cc::vast_option_prefix.str() + cc::opt::instantiation_cache.str();
+        for (auto arg : vargs.args) {
+            if (!string_ref(arg).starts_with(prefix)) {
+                hash.add(string_ref(arg));
+            }
+        }
+
+        const auto &target = actx.getTargetInfo();
+        hash.add(target.getTriple().str());
+        hash.add(target.getDataLayoutString());
+        add_language_options(hash, actx.getLangOpts());
+
+        config = hash.finish();
+    }
+
+    bool instantiation_cache::is_cached(const clang::FunctionDecl *decl) {
+        return decl->getTemplateSpecializationKind() == clang::TSK_ImplicitInstantiation;
+    }
+
+    std::string instantiation_cache::key(string_ref mangled, const clang::FunctionDecl *decl) const {
+        content_hasher hash;
+        hash.add(config);
+        hash.add(mangled);
+
+        // The mangled name stays the same when the template is edited, the
+        // odr hash of its definition does not.
+        if (const auto *pattern = decl->getTemplateInstantiationPattern()) {
+            clang::ODRHash odr;
+            odr.AddFunctionDecl(pattern);
+            hash.add(std::uint64_t(odr.CalculateHash()));
+        }
+
+        return hash.finish();
+    }
+
+    std::string instantiation_cache::entry_path(string_ref key) const {
+        llvm::SmallString< 256 > path(*dir);
+        llvm::sys::path::append(path, key + ".mlirbc");
+        return path.str().str();
+    }
+
+    bool instantiation_cache::claim(string_ref key) const {
+        auto &process = entries_of_process();
+        std::lock_guard lock(process.mutex);
+        return process.entries.try_emplace(key).second;
+    }
+
+    owning_module_ref instantiation_cache::load(string_ref key, mcontext_t &mctx) const {
+        auto &process = entries_of_process();
+
+        std::string bytes;
+        {
+            std::lock_guard lock(process.mutex);
+            if (auto it = process.entries.find(key); it != process.entries.end()) {
+                bytes = it->second;
+            }
+        }
+
+        mlir::ParserConfig config(&mctx);
+        if (!bytes.empty()) {
+            return mlir::parseSourceString< vast_module >(bytes, config);
+        }
+
+        if (!dir || !llvm::sys::fs::exists(entry_path(key))) {
+            return {};
+        }
+
+        auto buffer = llvm::MemoryBuffer::getFile(entry_path(key));
+        if (!buffer) {
+            return {};
+        }
+
+        // A damaged entry is a miss, it is replaced once the instantiation
+        // is generated again.
+        auto stored = compression.decompress((*buffer)->getBuffer().str());
+        if (!stored) {
+            return {};
+        }
+
+        owning_module_ref entry;
+        {
+            mlir::ScopedDiagnosticHandler silence(&mctx, [] (mlir::Diagnostic &) {
+                return mlir::success();
+            });
+            entry = mlir::parseSourceString< vast_module >(*stored, config);
+        }
+
+        if (entry) {
+            std::lock_guard lock(process.mutex);
+            process.entries.try_emplace(key, std::move(*stored));
+        }
+
+        return entry;
+    }
+
+    void instantiation_cache::store(string_ref key, hl::FuncOp fn, codegen_context &cgctx) const {
+        auto &process = entries_of_process();
+        {
+            // The first unit that generated the instantiation keeps its entry.
+            std::lock_guard lock(process.mutex);
+            if (process.entries.count(key)) {
+                return;
+            }
+        }
+
+        auto &mctx = *fn.getContext();
+        owning_module_ref entry(vast_module::create(fn.getLoc()));
+        mlir::OpBuilder bld(&mctx);
+        bld.setInsertionPointToEnd(entry->getBody());
+        bld.clone(*fn.getOperation());
+
+        // Declarations of the callees let the unit that splices the entry
+        // check their types, or declare those it has not seen yet.
+        llvm::DenseSet< mlir::StringAttr > callees;
+        if (auto uses = mlir::SymbolTable::getSymbolUses(&fn.getBody())) {
+            for (auto use : *uses) {
+                auto name = use.getSymbolRef().getRootReference();
+                if (name == fn.getSymNameAttr() || !callees.insert(name).second) {
+                    continue;
+                }
+
+                // References to other symbols are not supported.
+                auto callee = cgctx.funcdecls.lookup(mangled_name_ref{ name });
+                if (!callee) {
+                    return;
+                }
+                bld.insert(callee->cloneWithoutRegions());
+            }
+        }
+
+        std::vector< mlir::DataLayoutEntryInterface > layout;
+        llvm::DenseSet< mlir_type > seen;
+        walk_types(fn, [&] (mlir_type type) {
+            if (!seen.insert(type).second) {
+                return;
+            }
+            if (auto it = cgctx.dl.entries.find(type); it != cgctx.dl.entries.end()) {
+                layout.push_back(it->second.wrap(mctx));
+            }
+        });
+        entry->getOperation()->setAttr(
+            mlir::DLTIDialect::kDataLayoutAttrName, mlir::DataLayoutSpecAttr::get(&mctx, layout)
+        );
+
+        std::string bytes;
+        {
+            llvm::raw_string_ostream os(bytes);
+            if (failed(mlir::writeBytecodeToFile(entry.get(), os))) {
+                return;
+            }
+        }
+
+        {
+            std::lock_guard lock(process.mutex);
+            if (!process.entries.try_emplace(key, bytes).second) {
+                return;
+            }
+        }
+
+        if (!dir || llvm::sys::fs::create_directories(*dir)) {
+            return;
+        }
+
+        // Concurrent compilations never observe a partially written entry.
+        auto path = entry_path(key);
+        llvm::SmallString< 256 > tmp;
+        int fd;
+        if (llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, tmp)) {
+            return;
+        }
+
+        bool written = [&] {
+            llvm::raw_fd_ostream os(fd, /* should close */ true);
+            os << compression.compress(std::move(bytes));
+            os.close();
+            return !os.has_error();
+        } ();
+
+        if (!written || llvm::sys::fs::rename(tmp, path)) {
+            llvm::sys::fs::remove(tmp);
+        }
+    }
+
+    void instantiation_cache::collect_declared(vast_module mod) {
+        declared.clear();
+        mod->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            if (mlir::isa< hl::FuncOp >(op)) {
+                return mlir::WalkResult::skip();
+            }
+
+            if (is_named_decl(op)) {
+                declared.insert(op->getAttrOfType< mlir::StringAttr >("name").getValue());
+            }
+
+            return mlir::WalkResult::advance();
+        });
+    }
+
+    bool instantiation_cache::splice(owning_module_ref entry, hl::FuncOp fn, codegen_context &cgctx) {
+        auto def = entry->lookupSymbol< hl::FuncOp >(fn.getSymNameAttr());
+        if (!def || def.isDeclaration() || def.getFunctionType() != fn.getFunctionType()) {
+            return false;
+        }
+
+        std::vector< hl::FuncOp > undeclared;
+        for (auto callee : entry->getOps< hl::FuncOp >()) {
+            if (callee == def) {
+                continue;
+            }
+
+            auto known = cgctx.funcdecls.lookup(mangled_name_ref{ callee.getSymNameAttr() });
+            if (!known) {
+                undeclared.push_back(callee);
+            } else if (known.getFunctionType() != callee.getFunctionType()) {
+                return false;
+            }
+        }
+
+        referenced_names names(def);
+        auto all_declared = [&] {
+            return llvm::all_of(names.external(), [&] (string_ref name) {
+                return declared.contains(name);
+            });
+        };
+
+        if (!all_declared()) {
+            collect_declared(cgctx.mod.get());
+            if (!all_declared()) {
+                return false;
+            }
+        }
+
+        std::vector< std::pair< mlir_type, dl::DLEntry > > layout;
+        if (auto spec = entry->getOperation()->getAttrOfType< mlir::DataLayoutSpecAttr >(
+                mlir::DLTIDialect::kDataLayoutAttrName
+            )) {
+            for (auto attr : spec.getEntries()) {
+                auto type = mlir::dyn_cast< mlir_type >(attr.getKey());
+                dl::DLEntry layout_entry(attr);
+                if (auto it = cgctx.dl.entries.find(type); it != cgctx.dl.entries.end()) {
+                    if (!(it->second == layout_entry)) {
+                        return false;
+                    }
+                    continue;
+                }
+                layout.emplace_back(type, layout_entry);
+            }
+        }
+
+        // The entry fits, nothing below fails.
+        for (auto [type, layout_entry] : layout) {
+            cgctx.dl.add(type, layout_entry);
+        }
+
+        auto &body = cgctx.mod->getBody()->getOperations();
+        for (auto callee : undeclared) {
+            callee->remove();
+            body.push_back(callee);
+            std::ignore = cgctx.funcdecls.declare(mangled_name_ref{ callee.getSymNameAttr() }, callee);
+        }
+
+        fn.getBody().takeBody(def.getBody());
+        return true;
+    }
+
+    std::optional< instantiation_cache > make_instantiation_cache(
+        const codegen_context &cgctx, const cc::action_options &opts, const cc::vast_args &vargs
+    ) {
+        if (!vargs.has_option(cc::opt::instantiation_cache)) {
+            return std::nullopt;
+        }
+
+        if (!cgctx.actx.getLangOpts().CPlusPlus) {
+            return std::nullopt;
+        }
+
+        // Bodies have to depend only on the instantiation, and their
+        // locations must not refer to module-level tables.
+        if (vargs.has_option(cc::opt::function_budget) || vargs.has_option(cc::opt::locs_as_meta_ids)) {
+            return std::nullopt;
+        }
+
+        if (opts.codegen.hasProfileClangUse()) {
+            return std::nullopt;
+        }
+
+        if (vargs.get_option(cc::opt::locs).value_or("full") == "compact") {
+            return std::nullopt;
+        }
+
+        return instantiation_cache(
+            vargs.get_option(cc::opt::instantiation_cache),
+            vargs.has_option(cc::opt::instantiation_decls),
+            cgctx.actx, vargs
+        );
+    }
+
+} // namespace vast::cg
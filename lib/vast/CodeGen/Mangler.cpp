@@ -8,6 +8,9 @@ namespace vast::cg
         clang::GlobalDecl decl, const clang::TargetInfo &target_info, const std::string &module_name_hash
     ) {
         auto canonical = decl.getCanonicalDecl();
+        if (auto it = mangled_decl_names.find(canonical); it != mangled_decl_names.end()) {
+            return it->second;
+        }
 
         // Some ABIs don't have constructor variants. Make sure that base and complete
         // constructors get mangled the same.
@@ -18,15 +21,15 @@ namespace vast::cg
         // VAST_UNIMPLEMENTED_IF(!langOpts.CUDAIsDevice);
 
         // Keep the first result in the case of a mangling collision.
-        auto mangled_name = mangle(decl, module_name_hash);
+        auto mangled_name = intern(mangle(decl, module_name_hash));
 
-        auto result = manglings.insert(std::make_pair(mangled_name, decl));
-        return mangled_decl_names[canonical] = mangled_name_ref{ result.first->first() };
+        manglings.try_emplace(mangled_name, decl);
+        return mangled_decl_names[canonical] = mangled_name;
     }
 
     std::optional< clang::GlobalDecl > CodeGenMangler::lookup_representative_decl(mangled_name_ref mangled_name) const {
-        if (auto res = manglings.find(mangled_name.name); res != manglings.end()) {
-            return res->getValue();
+        if (auto res = manglings.find(mangled_name); res != manglings.end()) {
+            return res->second;
         }
 
         return std::nullopt;
@@ -101,7 +104,7 @@ namespace vast::cg
 namespace llvm {
 
     [[nodiscard]] hash_code hash_value(vast::cg::mangled_name_ref mangled) {
-        return hash_value(mangled.name);
+        return hash_value(mangled.symbol.getAsOpaquePointer());
     }
 
 } // llvm
@@ -0,0 +1,301 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/Profile.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/DeclCXX.h>
+#include <clang/AST/ExprCXX.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/AST/StmtCXX.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/ProfileData/InstrProf.h>
+#include <llvm/ProfileData/InstrProfReader.h>
+#include <llvm/ProfileData/ProfileCommon.h>
+VAST_UNRELAX_WARNINGS
+
+#include <limits>
+
+namespace vast::cg
+{
+    namespace
+    {
+        //
+        // Numbers the counters of a function as `MapRegionCounters` of clang
+        // does: the body of the function first, then the statements that
+        // start a region. Bodies of nested functions, blocks and lambdas
+        // have counters of their own.
+        //
+        struct region_counters : clang::RecursiveASTVisitor< region_counters >
+        {
+            bool TraverseBlockExpr(clang::BlockExpr *) { return true; }
+            bool TraverseCapturedStmt(clang::CapturedStmt *) { return true; }
+
+            bool TraverseLambdaExpr(clang::LambdaExpr *expr) {
+                for (auto [capture, init] : llvm::zip(expr->captures(), expr->capture_inits())) {
+                    TraverseLambdaCapture(expr, &capture, init);
+                }
+                return true;
+            }
+
+            bool VisitDecl(const clang::Decl *decl) {
+                switch (decl->getKind()) {
+                    case clang::Decl::Function:
+                    case clang::Decl::CXXMethod:
+                    case clang::Decl::CXXConstructor:
+                    case clang::Decl::CXXDestructor:
+                    case clang::Decl::CXXConversion:
+                    case clang::Decl::ObjCMethod:
+                    case clang::Decl::Block:
+                    case clang::Decl::Captured:
+                        counters[decl->getBody()] = next++;
+                        break;
+                    default:
+                        break;
+                }
+                return true;
+            }
+
+            bool VisitStmt(const clang::Stmt *stmt) {
+                if (starts_region(stmt)) {
+                    counters[stmt] = next++;
+                }
+                return true;
+            }
+
+            static bool starts_region(const clang::Stmt *stmt) {
+                switch (stmt->getStmtClass()) {
+                    case clang::Stmt::LabelStmtClass:
+                    case clang::Stmt::WhileStmtClass:
+                    case clang::Stmt::DoStmtClass:
+                    case clang::Stmt::ForStmtClass:
+                    case clang::Stmt::CXXForRangeStmtClass:
+                    case clang::Stmt::ObjCForCollectionStmtClass:
+                    case clang::Stmt::SwitchStmtClass:
+                    case clang::Stmt::CaseStmtClass:
+                    case clang::Stmt::DefaultStmtClass:
+                    case clang::Stmt::IfStmtClass:
+                    case clang::Stmt::CXXTryStmtClass:
+                    case clang::Stmt::CXXCatchStmtClass:
+                    case clang::Stmt::ConditionalOperatorClass:
+                    case clang::Stmt::BinaryConditionalOperatorClass:
+                        return true;
+                    case clang::Stmt::BinaryOperatorClass: {
+                        auto op = clang::cast< clang::BinaryOperator >(stmt)->getOpcode();
+                        return op == clang::BO_LAnd || op == clang::BO_LOr;
+                    }
+                    default:
+                        return false;
+                }
+            }
+
+            llvm::DenseMap< const clang::Stmt *, unsigned > counters;
+            unsigned next = 0;
+        };
+
+        std::uint64_t sat_sub(std::uint64_t a, std::uint64_t b) { return a > b ? a - b : 0; }
+
+        //
+        // Propagates the counts of the regions to the branches, the count of
+        // a statement is the count of the region it is in.
+        //
+        struct branch_counts
+        {
+            std::uint64_t count_of(const clang::Stmt *stmt) const {
+                auto it = regions.counters.find(stmt);
+                return it != regions.counters.end() ? counts[it->second] : 0;
+            }
+
+            void weigh(const clang::Stmt *stmt, std::uint64_t taken, std::uint64_t not_taken) {
+                // No branch weights without executions, as clang does.
+                if (taken == 0 && not_taken == 0) {
+                    return;
+                }
+
+                auto max   = std::max(taken, not_taken);
+                auto limit = std::uint64_t(std::numeric_limits< std::uint32_t >::max());
+                auto scale = max < limit ? 1 : max / limit + 1;
+                profile.branches[stmt] = {
+                    std::uint32_t(taken / scale + 1), std::uint32_t(not_taken / scale + 1)
+                };
+            }
+
+            void visit(const clang::Stmt *stmt, std::uint64_t current) {
+                if (!stmt) {
+                    return;
+                }
+
+                if (auto compound = clang::dyn_cast< clang::CompoundStmt >(stmt)) {
+                    for (auto child : compound->body()) {
+                        current = visit_in_sequence(child, current);
+                    }
+                    return;
+                }
+
+                if (auto if_stmt = clang::dyn_cast< clang::IfStmt >(stmt)) {
+                    visit(if_stmt->getInit(), current);
+                    visit(if_stmt->getCond(), current);
+                    auto then_count = count_of(if_stmt);
+                    auto else_count = sat_sub(current, then_count);
+                    weigh(if_stmt, then_count, else_count);
+                    visit(if_stmt->getThen(), then_count);
+                    visit(if_stmt->getElse(), else_count);
+                    return;
+                }
+
+                // The condition holds once per iteration and fails once per
+                // entry of the loop.
+                if (auto while_stmt = clang::dyn_cast< clang::WhileStmt >(stmt)) {
+                    auto body = count_of(while_stmt);
+                    weigh(while_stmt, body, current);
+                    visit(while_stmt->getCond(), body + current);
+                    visit(while_stmt->getBody(), body);
+                    return;
+                }
+
+                if (auto for_stmt = clang::dyn_cast< clang::ForStmt >(stmt)) {
+                    auto body = count_of(for_stmt);
+                    weigh(for_stmt, body, current);
+                    visit(for_stmt->getInit(), current);
+                    visit(for_stmt->getCond(), body + current);
+                    visit(for_stmt->getInc(), body);
+                    visit(for_stmt->getBody(), body);
+                    return;
+                }
+
+                if (clang::isa< clang::BlockExpr, clang::LambdaExpr, clang::CapturedStmt >(stmt)) {
+                    return;
+                }
+
+                if (region_counters::starts_region(stmt)) {
+                    visit_region(stmt, current);
+                    return;
+                }
+
+                for (auto child : stmt->children()) {
+                    visit(child, current);
+                }
+            }
+
+            // Statements of the other regions, whose counters are the counts
+            // of their nested statements.
+            void visit_region(const clang::Stmt *stmt, std::uint64_t current) {
+                auto count = count_of(stmt);
+
+                if (auto cond = clang::dyn_cast< clang::ConditionalOperator >(stmt)) {
+                    visit(cond->getCond(), current);
+                    visit(cond->getTrueExpr(), count);
+                    visit(cond->getFalseExpr(), sat_sub(current, count));
+                    return;
+                }
+
+                if (auto binary = clang::dyn_cast< clang::BinaryOperator >(stmt)) {
+                    visit(binary->getLHS(), current);
+                    visit(binary->getRHS(), count);
+                    return;
+                }
+
+                // Loops and switches enter their bodies, labels and cases
+                // start their statements, with the count of the region.
+                auto body = clang::isa< clang::SwitchStmt >(stmt) ? std::uint64_t(0) : count;
+                for (auto child : stmt->children()) {
+                    visit(child, body);
+                }
+            }
+
+            // Returns the count of the statement that follows `stmt`.
+            std::uint64_t visit_in_sequence(const clang::Stmt *stmt, std::uint64_t current) {
+                if (clang::isa< clang::LabelStmt, clang::SwitchCase >(stmt)) {
+                    current = count_of(stmt);
+                }
+
+                visit(stmt, current);
+
+                if (clang::isa< clang::ReturnStmt, clang::BreakStmt, clang::ContinueStmt, clang::GotoStmt >(stmt)) {
+                    return 0;
+                }
+
+                if (auto sw = clang::dyn_cast< clang::SwitchStmt >(stmt)) {
+                    return count_of(sw);
+                }
+
+                return current;
+            }
+
+            const region_counters &regions;
+            llvm::ArrayRef< std::uint64_t > counts;
+            function_profile &profile;
+        };
+
+    } // namespace
+
+    std::optional< instr_profile > instr_profile::open(
+        string_ref path, llvm::vfs::FileSystem &fs, std::string &error
+    ) {
+        auto reader = llvm::IndexedInstrProfReader::create(path, fs);
+        if (auto err = reader.takeError()) {
+            error = llvm::toString(std::move(err));
+            return std::nullopt;
+        }
+
+        instr_profile profile;
+        profile.version  = (*reader)->getVersion();
+        profile.ir_level = (*reader)->isIRLevelProfile();
+        if (profile.ir_level) {
+            return profile;
+        }
+
+        llvm::StringSet<> ambiguous;
+        for (const auto &record : **reader) {
+            auto [it, inserted] = profile.records.try_emplace(record.Name, record.Counts);
+            if (!inserted) {
+                ambiguous.insert(record.Name);
+            }
+        }
+
+        if ((*reader)->hasError()) {
+            error = "malformed profile records";
+            return std::nullopt;
+        }
+
+        for (const auto &name : ambiguous) {
+            profile.records.erase(name.getKey());
+        }
+
+        const auto &summary   = (*reader)->getSummary(/* use context sensitive */ false);
+        profile.hot_threshold = llvm::ProfileSummaryBuilder::getHotCountThreshold(
+            summary.getDetailedSummary()
+        );
+
+        return profile;
+    }
+
+    std::optional< function_profile > instr_profile::of(
+        const clang::FunctionDecl *decl, string_ref name, string_ref main_file
+    ) const {
+        auto linkage = decl->isExternallyVisible()
+            ? llvm::GlobalValue::ExternalLinkage
+            : llvm::GlobalValue::InternalLinkage;
+
+        auto it = records.find(llvm::getPGOFuncName(name, linkage, main_file, version));
+        if (it == records.end() || it->second.empty()) {
+            return std::nullopt;
+        }
+
+        region_counters regions;
+        regions.TraverseDecl(const_cast< clang::FunctionDecl * >(decl));
+
+        const auto &counts = it->second;
+        if (regions.next != counts.size()) {
+            return std::nullopt;
+        }
+
+        function_profile profile;
+        profile.entry_count = counts.front();
+        profile.hot         = hot_threshold && profile.entry_count >= hot_threshold;
+
+        branch_counts branches{ regions, counts, profile };
+        branches.visit(decl->getBody(), profile.entry_count);
+        return profile;
+    }
+
+} // namespace vast::cg
@@ -14,6 +14,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/Rewrite/PatternApplicator.h>
 
 #include <llvm/ADT/APFloat.h>
+#include <llvm/ADT/DenseMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include "../PassesDetails.hpp"
@@ -24,6 +25,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/TypeConverters/TypeConverter.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
@@ -35,6 +37,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Util/Common.hpp"
 #include "vast/Util/Functions.hpp"
 #include "vast/Util/DialectConversion.hpp"
+#include "vast/Util/PatternStats.hpp"
 #include "vast/Util/Symbols.hpp"
 
 #include "vast/Dialect/ABI/ABIOps.hpp"
@@ -64,10 +67,25 @@ namespace vast
         -> abi_info_map_t< R >
     {
         abi_info_map_t< R > out;
+        auto layouts = hl::record_layout_cache(root_op, dl);
+
+        // Classification depends only on the function type, as the target and
+        // the data layout are the same for the whole module. Functions sharing
+        // a signature reuse the classification of its first occurrence.
+        llvm::DenseMap< mlir_type, abi::func_info< R > > classified;
+
         auto gather = [&](R op, const mlir::WalkStage &)
         {
+            auto fty = op.getFunctionType();
+            auto it  = classified.find(fty);
+            if (it == classified.end())
+                it = classified.try_emplace(fty, abi::make_x86_64(op, dl, layouts)).first;
+
+            auto info   = it->second;
+            info.raw_fn = op;
+
             auto name = op.getName();
-            out.emplace( name.str(), abi::make_x86_64(op, dl) );
+            out.emplace( name.str(), std::move(info) );
 
             return mlir::WalkResult::advance();
         };
@@ -107,18 +125,39 @@ namespace vast
                 };
             };
 
+            static bool is_indirect(const abi::arg_info &e)
+            {
+                return std::holds_alternative< abi::indirect >(e.style);
+            }
+
+            // Values returned indirectly are still results of the call, they
+            // are read from the return slot once the callee returns.
             bool returns_value()
             {
-                // TODO(conv:abi): `sret`?
                 for (const auto &e : self().abi_info.rets())
                     if (!std::holds_alternative< abi::ignore >(e.style))
                         return true;
                 return false;
             }
 
-            types_t abified_args() const
+            // Pointers to the memory of values returned indirectly (`sret`),
+            // they are passed before the arguments.
+            types_t ret_slots() const
             {
                 types_t out;
+                for (const auto &e : self().abi_info.rets())
+                {
+                    if (!is_indirect(e))
+                        continue;
+                    auto trgs = e.target_types();
+                    out.insert(out.end(), trgs.begin(), trgs.end());
+                }
+                return out;
+            }
+
+            types_t abified_args() const
+            {
+                types_t out = ret_slots();
                 for (const auto &e : self().abi_info.args())
                 {
                     auto trgs = e.target_types();
@@ -132,6 +171,8 @@ namespace vast
                 types_t out;
                 for (const auto &e : self().abi_info.rets())
                 {
+                    if (is_indirect(e))
+                        continue;
                     auto trgs = e.target_types();
                     out.insert(out.end(), trgs.begin(), trgs.end());
                 }
@@ -219,12 +260,50 @@ namespace vast
 
             using types_t = std::vector< mlir::Type >;
 
+            // Return slots and arguments passed indirectly are marked with the
+            // type they point to. An argument passed in several registers keeps
+            // its attributes on the first one.
+            mlir::SmallVector< mlir::DictionaryAttr, 8 > abified_arg_attrs()
+            {
+                mlir::SmallVector< mlir::DictionaryAttr, 8 > original;
+                op.getAllArgAttrs(original);
+
+                auto mctx = op.getContext();
+                auto mark = [&](mlir::DictionaryAttr attrs, const std::string &name,
+                                mlir_type ptr)
+                {
+                    auto pointee = mlir::cast< hl::PointerType >(ptr).getElementType();
+                    mlir::NamedAttrList list(attrs);
+                    list.set(name, mlir::TypeAttr::get(pointee));
+                    return list.getDictionary(mctx);
+                };
+
+                mlir::SmallVector< mlir::DictionaryAttr, 8 > out;
+                for (auto slot : this->ret_slots())
+                    out.push_back(mark({}, hl::HighLevelDialect::getSRetAttrName(), slot));
+
+                for (auto [abi_arg, attrs] : llvm::zip(abi_info.args(), original))
+                {
+                    auto trgs = abi_arg.target_types();
+                    for (std::size_t i = 0; i < trgs.size(); ++i)
+                    {
+                        if (i != 0)
+                            out.push_back(mlir::DictionaryAttr::get(mctx));
+                        else if (this->is_indirect(abi_arg))
+                            out.push_back(mark(attrs, hl::HighLevelDialect::getByValAttrName(),
+                                               trgs[0]));
+                        else
+                            out.push_back(attrs);
+                    }
+                }
+                return out;
+            }
+
             abi::FuncOp make()
             {
-                mlir::SmallVector< mlir::DictionaryAttr, 8 > arg_attrs;
                 mlir::SmallVector< mlir::NamedAttribute, 8 > other_attrs;
 
-                op.getAllArgAttrs(arg_attrs);
+                auto arg_attrs = abified_arg_attrs();
                 auto wrapper = rewriter.template create< abi::FuncOp >(
                         op.getLoc(),
                         // Temporal, to avoid verification issues, will be changed once
@@ -314,7 +393,8 @@ namespace vast
                     for (std::size_t i = 0; i < arg_info.target_types().size(); ++i)
                         arg_locs.push_back(loc);
                 };
-                // TODO(conv:abi): This won't work with `sret`.
+                for (std::size_t i = 0; i < this->ret_slots().size(); ++i)
+                    arg_locs.push_back(op.getLoc());
                 this->zip(abi_info.args(), collect_arg_locs(op), process);
 
 
@@ -327,7 +407,9 @@ namespace vast
                 // arg_info -> { original type, [ arguments in the new function] }
                 std::unordered_map< const abi::arg_info *, mapped_arg_t > arg_to_locals;
 
-                auto func_arg_it = func.args_begin();
+                // Return slots are not arguments of the original function, the
+                // epilogue stores to them.
+                auto func_arg_it = std::next(func.args_begin(), this->ret_slots().size());
                 auto op_arg_it = op.args_begin();
                 for (std::size_t i = 0; i < abi_info.args().size(); ++i)
                 {
@@ -434,6 +516,21 @@ namespace vast
                 return { vals.begin(), vals.end() };
             }
 
+            // Read from the slot once the callee returns.
+            auto mk_ret(auto &bld, auto loc,
+                        const abi::indirect &,
+                        mlir::Value result,
+                        values_t concrete_args)
+                -> values_t
+            {
+                VAST_ASSERT(concrete_args.size() == 1);
+                auto val = rewriter.template create< abi::IndirectOp >(
+                        loc,
+                        result.getType(),
+                        concrete_args[0]).getResult();
+                return { val };
+            }
+
             auto mk_ret(auto &, auto loc,
                         const abi::ignore &,
                         mlir::Value,
@@ -503,6 +600,7 @@ namespace vast
                             op.getCallee(),
                             this->abified_rets(),
                             args);
+                    mark_musttail(call);
 
                     auto to_yield = [ & ]() -> mlir::ResultRange
                     {
@@ -512,7 +610,7 @@ namespace vast
                         return bld.template create< abi::CallRetsOp >(
                                 loc,
                                 op.getResults().getType(),
-                                rets_maker(call.getResults())).getResults();
+                                rets_maker(call.getResults(), args)).getResults();
                     }();
 
                     bld.template create< abi::YieldOp >(
@@ -538,6 +636,8 @@ namespace vast
                         std::visit(dispatch, arg_info.style);
                     };
 
+                    for (auto slot : this->ret_slots())
+                        out.push_back(bld.template create< abi::RetSlotOp >(loc, slot));
                     this->zip(abi_info.args(), op.getArgOperands(), process);
 
                     bld.template create< abi::YieldOp >(
@@ -548,10 +648,26 @@ namespace vast
 
             }
 
-            auto rets_maker(mlir::ValueRange vals)
+            // Values returned indirectly are read from their slots, which are
+            // the first arguments of the call.
+            auto rets_maker(mlir::ValueRange vals, values_t args)
             {
                 return [=, this](auto &bld, auto loc)
                 {
+                    std::vector< mlir::Value > concretes;
+                    auto slot_it = args.begin();
+                    auto val_it  = vals.begin();
+                    for (const auto &e : abi_info.rets())
+                    {
+                        for (std::size_t i = 0; i < e.target_types().size(); ++i)
+                        {
+                            if (this->is_indirect(e))
+                                concretes.push_back(*(slot_it++));
+                            else
+                                concretes.push_back(*(val_it++));
+                        }
+                    }
+
                     std::vector< mlir::Value > out;
                     auto store = [&](auto vals)
                     {
@@ -567,7 +683,7 @@ namespace vast
                         std::visit(dispatch, arg_info.style);
                     };
 
-                    this->zip_ret(abi_info.rets(), op.getResults(), vals, process);
+                    this->zip_ret(abi_info.rets(), op.getResults(), concretes, process);
 
                     bld.template create< abi::YieldOp >(
                         loc,
@@ -576,14 +692,26 @@ namespace vast
                 };
             }
 
+            // Lowering of the call keeps it a `musttail` call, the execution
+            // is marked as well, so that its return slot is the one of the
+            // caller.
+            void mark_musttail(operation target)
+            {
+                auto musttail = hl::HighLevelDialect::getMustTailAttrName();
+                if (auto attr = op->getAttr(musttail))
+                    target->setAttr(musttail, attr);
+            }
+
             auto make()
             {
-                return rewriter.template create< abi::CallExecutionOp >(
+                auto exec = rewriter.template create< abi::CallExecutionOp >(
                         op.getLoc(),
                         op.getCallee(),
                         op.getResults().getType(),
                         op.getArgOperands(),
                         execution_region_maker());
+                mark_musttail(exec);
+                return exec;
             }
         };
 
@@ -626,6 +754,17 @@ namespace vast
                 return mk_direct< abi::DirectOp >(bld, loc, arg, concrete_arg);
             }
 
+            // Stored to the return slot, nothing is returned.
+            auto mk_ret(auto &bld, auto loc, const abi::indirect &arg, mlir::Value concrete_arg)
+                -> values_t
+            {
+                rewriter.template create< abi::IndirectOp >(
+                        op.getLoc(),
+                        arg.target_types,
+                        concrete_arg);
+                return {};
+            }
+
             auto mk_ret(auto &, auto, const auto &abi_arg, const mlir::Value &)
                 -> mlir::ResultRange
             {
@@ -852,9 +991,20 @@ namespace vast
         mlir::LogicalResult run(phase_t phase)
         {
             auto [trg, patterns] = std::move(phase);
+            count_pattern_applications(patterns, this->getArgument());
             return mlir::applyPartialConversion(this->getOperation(), trg, std::move(patterns));
         }
 
+        // Phases that rewrite only function bodies are applied to each
+        // function separately, so they can run in parallel.
+        mlir::LogicalResult run_per_function(phase_t phase)
+        {
+            auto [trg, patterns] = std::move(phase);
+            return util::apply_partial_conversion_per_function(
+                this->getOperation(), trg, mlir::FrozenRewritePatternSet(std::move(patterns))
+            );
+        }
+
         void runOnOperation() override
         {
             auto &mctx = this->getContext();
@@ -865,13 +1015,15 @@ namespace vast
             auto abi_info_map = collect_abi_info< hl::FuncOp >(
                     op, dl_analysis.getAtOrAbove(op));
 
-            if (mlir::failed(run(first_phase(tc, abi_info_map))))
+            // Classification above is the only module-wide step, except for
+            // the replacement of function signatures.
+            if (mlir::failed(run_per_function(first_phase(tc, abi_info_map))))
                 return signalPassFailure();
 
             if (mlir::failed(run(second_phase(tc, abi_info_map))))
                 return signalPassFailure();
 
-            if (mlir::failed(run(third_phase(tc, abi_info_map))))
+            if (mlir::failed(run_per_function(third_phase(tc, abi_info_map))))
                 return signalPassFailure();
         }
     };
@@ -5,6 +5,7 @@
 VAST_RELAX_WARNINGS
 #include <mlir/Analysis/DataLayoutAnalysis.h>
 #include <mlir/IR/PatternMatch.h>
+#include <mlir/IR/Threading.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
@@ -21,6 +22,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/ABI/Common.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
@@ -75,6 +77,139 @@ namespace vast
             return query_bw(dl, target) == query_bw(dl, type_range);
         }
 
+        // Return slot of the function `op` is nested in, if it has one.
+        mlir::Value find_ret_slot(operation op)
+        {
+            auto fn = op->getParentOfType< abi::FuncOp >();
+            VAST_CHECK(fn && !fn.getBody().empty(), "Return outside of a function: {0}", *op);
+
+            for (unsigned idx = 0; idx < fn.getNumArguments(); ++idx)
+                if (fn.getArgAttr(idx, hl::HighLevelDialect::getSRetAttrName()))
+                    return fn.getArgument(idx);
+            return {};
+        }
+
+        // Return slot of the function `op` is nested in.
+        mlir::Value ret_slot(operation op)
+        {
+            auto slot = find_ret_slot(op);
+            VAST_CHECK(slot, "Function {0} has no return slot.",
+                       op->getParentOfType< abi::FuncOp >().getName());
+            return slot;
+        }
+
+        bool is_musttail(operation op)
+        {
+            return op && op->hasAttr(hl::HighLevelDialect::getMustTailAttrName());
+        }
+
+        // A `musttail` call returns its value through the return slot of its
+        // caller, which returns right after it.
+        mlir::Value musttail_ret_slot(abi::RetSlotOp slot)
+        {
+            auto args = slot->getParentOfType< abi::CallArgsOp >();
+            if (!args)
+                return {};
+
+            auto musttail_use = [](operation user) {
+                return mlir::isa< abi::CallOp >(user) && is_musttail(user);
+            };
+
+            if (!llvm::any_of(args->getUsers(), musttail_use))
+                return {};
+            return find_ret_slot(slot);
+        }
+
+        // Local variable `value` is loaded from, if it can be constructed in
+        // the return slot.
+        hl::VarDeclOp returned_variable(mlir::Value value)
+        {
+            auto cast = value.getDefiningOp< hl::ImplicitCastOp >();
+            if (!cast || cast.getKind() != hl::CastKind::LValueToRValue)
+                return {};
+
+            auto ref = cast.getValue().getDefiningOp< hl::DeclRefOp >();
+            if (!ref)
+                return {};
+
+            auto var = ref.getDecl().getDefiningOp< hl::VarDeclOp >();
+            if (!var || !var.hasLocalStorage() || !var.getAllocationSize().empty())
+                return {};
+
+            if (hl::strip_value_category(var.getType()) != cast.getType())
+                return {};
+
+            if (!var.getInitializer().empty() && !var.getInitializer().hasOneBlock())
+                return {};
+            return var;
+        }
+
+        // If every return of the function returns the same local variable,
+        // there is no need for a copy to the return slot. The variable is
+        // constructed directly in the slot, similar to the named return value
+        // optimization of C++. There is no other way to observe the slot, as
+        // callers allocate it for the call only.
+        void elide_return_copy(abi::FuncOp fn)
+        {
+            hl::VarDeclOp var;
+            llvm::SmallVector< abi::IndirectOp, 4 > returns;
+
+            auto walked = fn.walk([&](abi::EpilogueOp epilogue) {
+                for (auto indirect : epilogue.getBody().getOps< abi::IndirectOp >())
+                {
+                    auto returned = returned_variable(indirect.getValue());
+                    if (!returned || (var && var != returned))
+                        return mlir::WalkResult::interrupt();
+                    var = returned;
+                    returns.push_back(indirect);
+                }
+                return mlir::WalkResult::advance();
+            });
+
+            if (walked.wasInterrupted() || !var)
+                return;
+
+            mlir::OpBuilder bld(var);
+            auto type = var.getType();
+            auto storage = bld.create< hl::Deref >(var.getLoc(), type, ret_slot(var));
+
+            mlir::Value constructed = storage;
+            if (!var.getInitializer().empty())
+            {
+                // Initializer may reference the variable itself.
+                var.getResult().replaceUsesWithIf(storage, [&](mlir::OpOperand &use) {
+                    return var->isAncestor(use.getOwner());
+                });
+
+                auto &init = var.getInitializer().front();
+                auto yield = mlir::cast< hl::ValueYieldOp >(init.getTerminator());
+                var->getBlock()->getOperations().splice(var->getIterator(),
+                                                        init.getOperations());
+
+                bld.setInsertionPoint(var);
+                constructed = bld.create< ll::InitializeVar >(
+                        yield.getLoc(), type, storage, yield.getResult());
+                yield.erase();
+            }
+
+            var.getResult().replaceAllUsesWith(constructed);
+            var.erase();
+
+            // Loads of the returned value are dead now.
+            for (auto indirect : returns)
+            {
+                auto load = indirect.getValue().getDefiningOp();
+                indirect.erase();
+                if (!load->use_empty())
+                    continue;
+
+                auto ref = load->getOperand(0).getDefiningOp();
+                load->erase();
+                if (ref->use_empty())
+                    ref->erase();
+            }
+        }
+
         // [ `current_arg`, offset into `current_arg`, size of `current_arg` ]
         using arg_list_position = std::tuple< std::size_t, std::size_t, std::size_t >;
 
@@ -85,11 +220,13 @@ namespace vast
             using op_t = Op;
 
             const mlir::DataLayout &dl;
+            hl::record_layout_cache &layouts;
 
             template< typename ... Args >
-            abi_pattern_base(const mlir::DataLayout &dl, Args && ... args)
+            abi_pattern_base(const mlir::DataLayout &dl, hl::record_layout_cache &layouts,
+                             Args && ... args)
                 : base(std::forward< Args >(args) ...),
-                  dl(dl)
+                  dl(dl), layouts(layouts)
             {}
 
             using state_capture = match_and_rewrite_state_capture< op_t >;
@@ -103,6 +240,12 @@ namespace vast
             virtual values match_on(abi::DirectOp direct, state_capture &state) const = 0;
             virtual values match_on(abi::IndirectOp indirect, state_capture &state) const = 0;
 
+            // Return slots are allocated by callers only.
+            virtual values match_on(abi::RetSlotOp slot, state_capture &state) const
+            {
+                VAST_UNREACHABLE("Unexpected return slot: {0}", slot);
+            }
+
             virtual values match_on(mlir::Operation *op, state_capture &state) const
             {
                 co_return;
@@ -114,6 +257,8 @@ namespace vast
                     return this->match_on(direct, state);
                 if (auto indirect = mlir::dyn_cast< abi::IndirectOp >(op))
                     return this->match_on(indirect, state);
+                if (auto slot = mlir::dyn_cast< abi::RetSlotOp >(op))
+                    return this->match_on(slot, state);
                 return this->match_on(op, state);
             }
 
@@ -424,9 +569,22 @@ namespace vast
                     co_yield v;
             }
 
+            // Copy of the returned value to the return slot, unless it was
+            // elided by constructing the value in the slot.
             values match_on(abi::IndirectOp indirect, state_capture &state) const override
             {
-                VAST_UNREACHABLE("Not implemented");
+                auto loc = indirect.getLoc();
+                auto value = indirect.getValue();
+                auto type = hl::LValueType::get(indirect.getContext(), value.getType());
+
+                // Value of a `musttail` call is already in the slot.
+                if (is_musttail(value.getDefiningOp< abi::CallExecutionOp >()))
+                    co_return;
+
+                auto slot = state.rewriter.template create< hl::Deref >(
+                    loc, type, ret_slot(indirect));
+                state.rewriter.template create< ll::InitializeVar >(loc, type, slot, value);
+                co_return;
             }
         };
 
@@ -490,6 +648,10 @@ namespace vast
                     co_yield v;
             }
 
+            // Arguments passed indirectly are `byval`, the call itself makes
+            // the copy the callee works with. Hence a value loaded from memory
+            // is passed by the address of that memory, any other value is
+            // materialized in a temporary.
             values match_on(abi::IndirectOp indirect, state_capture &state) const override
             {
                 auto loc = indirect.getLoc();
@@ -497,6 +659,16 @@ namespace vast
                 auto ptr_type = indirect.getResult().getType();
                 auto type = hl::LValueType::get(mctx, indirect.getValue().getType());
 
+                if (auto cast = indirect.getValue().getDefiningOp< hl::ImplicitCastOp >())
+                {
+                    if (cast.getKind() == hl::CastKind::LValueToRValue)
+                    {
+                        co_yield state.rewriter.template create< hl::AddressOf >(
+                            loc, ptr_type, cast.getValue());
+                        co_return;
+                    }
+                }
+
                 auto var = state.rewriter.template create< ll::UninitializedVar >(
                     indirect.getLoc(), type);
                 // Now we initilizae before yielding the ptr
@@ -508,6 +680,25 @@ namespace vast
                     ptr_type,
                     initialized);
             }
+
+            // Memory for the value returned indirectly, for the duration of
+            // the call.
+            values match_on(abi::RetSlotOp slot, state_capture &state) const override
+            {
+                if (auto caller_slot = musttail_ret_slot(slot))
+                {
+                    co_yield caller_slot;
+                    co_return;
+                }
+
+                auto ptr_type = mlir::cast< hl::PointerType >(slot.getType());
+                auto type = hl::LValueType::get(slot.getContext(), ptr_type.getElementType());
+
+                auto var = state.rewriter.template create< ll::UninitializedVar >(
+                    slot.getLoc(), type);
+                co_yield state.rewriter.template create< hl::AddressOf >(
+                    slot.getLoc(), ptr_type, var);
+            }
         };
 
         struct call_rets : function_border_base< abi::CallRetsOp >
@@ -533,9 +724,29 @@ namespace vast
                     co_yield v;
             }
 
-            values match_on(abi::IndirectOp, state_capture &) const override
+            // Value is read from the return slot, the variable of the slot is
+            // used directly if the arguments are already lowered.
+            values match_on(abi::IndirectOp indirect, state_capture &state) const override
             {
-                VAST_UNREACHABLE("Not implemented.");
+                auto loc = indirect.getLoc();
+                auto type = hl::strip_value_category(indirect.getResult().getType());
+                auto lvalue_type = hl::LValueType::get(indirect.getContext(), type);
+
+                auto slot = state.rewriter.getRemappedValue(indirect.getValue());
+                auto lvalue = [&]() -> mlir::Value {
+                    if (auto addr = slot.getDefiningOp< hl::AddressOf >())
+                        return addr.getValue();
+                    return state.rewriter.template create< hl::Deref >(loc, lvalue_type, slot);
+                }();
+
+                if (mlir::isa< hl::LValueType >(indirect.getResult().getType()))
+                {
+                    co_yield lvalue;
+                    co_return;
+                }
+
+                co_yield state.rewriter.template create< hl::ImplicitCastOp >(
+                    loc, type, lvalue, hl::CastKind::LValueToRValue);
             }
         };
 
@@ -583,6 +794,10 @@ namespace vast
                         op.getCallee(),
                         op.getResults().getTypes(),
                         ops.getOperands());
+
+                auto musttail = hl::HighLevelDialect::getMustTailAttrName();
+                if (auto attr = op->getAttr(musttail))
+                    new_op->setAttr(musttail, attr);
                 rewriter.replaceOp(op, new_op.getResults());
                 return mlir::success();
             }
@@ -649,18 +864,18 @@ namespace vast
             return target;
         }
 
-        void add_patterns(auto &config, const auto &dl)
+        // Patterns that rewrite only function bodies.
+        void add_body_patterns(auto &config, const auto &dl, auto &layouts)
         {
-            config.patterns.template add< pattern::prologue >(dl, config.getContext());
-            config.patterns.template add< pattern::epilogue >(dl, config.getContext());
+            auto mctx = config.getContext();
+            config.patterns.template add< pattern::prologue >(dl, layouts, mctx);
+            config.patterns.template add< pattern::epilogue >(dl, layouts, mctx);
 
-            config.patterns.template add< pattern::call_args >(dl, config.getContext());
-            config.patterns.template add< pattern::call_rets >(dl, config.getContext());
+            config.patterns.template add< pattern::call_args >(dl, layouts, mctx);
+            config.patterns.template add< pattern::call_rets >(dl, layouts, mctx);
 
-            config.patterns.template add< pattern::call >(config.getContext());
-            config.patterns.template add< pattern::call_exec >(config.getContext());
-
-            config.patterns.template add< pattern::function >(config.getContext());
+            config.patterns.template add< pattern::call >(mctx);
+            config.patterns.template add< pattern::call_exec >(mctx);
 
             config.target.template addIllegalOp< abi::PrologueOp >();
             config.target.template addIllegalOp< abi::EpilogueOp >();
@@ -670,7 +885,12 @@ namespace vast
 
             config.target.template addIllegalOp< abi::CallOp >();
             config.target.template addIllegalOp< abi::CallExecutionOp >();
+        }
 
+        // Patterns that replace functions themselves.
+        void add_function_patterns(auto &config)
+        {
+            config.patterns.template add< pattern::function >(config.getContext());
             config.target.template addIllegalOp< abi::FuncOp >();
         }
 
@@ -681,17 +901,37 @@ namespace vast
         // There is no helper we can use.
         void runOnOperation() override
         {
-            auto &ctx   = getContext();
-            auto config = config_t { rewrite_pattern_set(&ctx),
-                                     create_conversion_target(ctx) };
-            auto op     = this->getOperation();
+            auto &ctx = getContext();
+            auto op   = this->getOperation();
 
             const auto &dl_analysis = this->template getAnalysis< mlir::DataLayoutAnalysis >();
             auto dl = dl_analysis.getAtOrAbove(op);
+            auto layouts = hl::record_layout_cache(op, dl);
+
+            // Bodies are lowered per function, so the functions can be
+            // processed in parallel. Data layout memoizes its queries, hence
+            // each function gets its own instance and patterns.
+            auto lower_body = [&] (operation fn) {
+                if (auto abi_fn = mlir::dyn_cast< abi::FuncOp >(fn))
+                    pattern::elide_return_copy(abi_fn);
+
+                auto fn_dl = mlir::DataLayout(op);
+                auto config = config_t { rewrite_pattern_set(&ctx),
+                                         create_conversion_target(ctx) };
+                add_body_patterns(config, fn_dl, layouts);
+                count_pattern_applications(config.patterns, getArgument());
+                return mlir::applyPartialConversion(fn, config.target, std::move(config.patterns));
+            };
+
+            auto functions = util::defined_functions(op);
+            if (mlir::failed(mlir::failableParallelForEach(&ctx, functions, lower_body)))
+                return signalPassFailure();
 
-            add_patterns(config, dl);
+            auto function_config = config_t { rewrite_pattern_set(&ctx),
+                                              create_conversion_target(ctx) };
+            add_function_patterns(function_config);
 
-            if (mlir::failed(base::apply_conversions(std::move(config))))
+            if (mlir::failed(base::apply_conversions(std::move(function_config))))
                 return signalPassFailure();
 
             this->after_operation();
@@ -7,6 +7,7 @@
 #include "vast/Util/TypeUtils.hpp"
 
 #include "vast/Conversion/Common/Patterns.hpp"
+#include "vast/Conversion/Common/TBAA.hpp"
 #include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
 
 namespace vast::conv::irstollvm {
@@ -27,6 +28,35 @@ namespace vast::conv::irstollvm {
 
         auto dl(auto op) const { return tc.getDataLayoutAnalysis()->getAtOrAbove(op); }
 
+        // Whether `addr` may point into a packed structure, i.e., is derived
+        // from one by member accesses.
+        static bool may_point_into_packed(mlir_value addr) {
+            while (auto gep = addr.getDefiningOp< LLVM::GEPOp >()) {
+                auto ptr = mlir::dyn_cast< LLVM::LLVMPointerType >(gep.getBase().getType());
+                if (!ptr || ptr.isOpaque()) {
+                    return true;
+                }
+
+                auto record = mlir::dyn_cast< LLVM::LLVMStructType >(ptr.getElementType());
+                if (record && record.isPacked()) {
+                    return true;
+                }
+
+                addr = gep.getBase();
+            }
+            return false;
+        }
+
+        // Alignment of an access of the `type` through `addr`: the ABI
+        // alignment from the data layout, or none for members of packed
+        // structures.
+        unsigned alignment(operation op, mlir_value addr, mlir_type type) const {
+            if (may_point_into_packed(addr)) {
+                return 1;
+            }
+            return dl(op).getTypeABIAlignment(type);
+        }
+
         auto mk_alloca(auto &rewriter, mlir_type trg_type, auto loc) const {
             auto count = rewriter.template create< LLVM::ConstantOp >(
                 loc, type_converter().convertType(rewriter.getIndexType()),
@@ -55,6 +85,26 @@ namespace vast::conv::irstollvm {
         }
     };
 
+    // Base of patterns that emit loads and stores of converted values.
+    template< typename op_t >
+    struct access_pattern : base_pattern< op_t >
+    {
+        using base = base_pattern< op_t >;
+
+        tbaa_tags *tbaa;
+
+        access_pattern(tc::FullLLVMTypeConverter &tc, tbaa_tags *tbaa)
+            : base(tc), tbaa(tbaa)
+        {}
+
+        // Attaches alias analysis tag of the accessed `type`, if enabled.
+        void tag(auto access, mlir_type type) const {
+            if (tbaa) {
+                tbaa->attach(access, type);
+            }
+        }
+    };
+
     template< typename src_t, typename trg_t >
     struct one_to_one : base_pattern< src_t >
     {
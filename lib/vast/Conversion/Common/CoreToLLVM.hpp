@@ -0,0 +1,281 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+#include <mlir/Transforms/DialectConversion.h>
+VAST_UNRELAX_WARNINGS
+
+#include <iterator>
+
+#include "vast/Conversion/Common/Patterns.hpp"
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/TypeList.hpp"
+
+namespace vast
+{
+    namespace pattern
+    {
+        namespace LLVM = mlir::LLVM;
+
+
+        template< typename Op >
+        struct lazy_base : operation_conversion_pattern< Op >, llvm_pattern_utils
+        {
+            using base = operation_conversion_pattern< Op >;
+            using base::base;
+
+            auto lazy_into_block(
+                Operation* lazy_op, Block* target, conversion_rewriter &rewriter) const
+            {
+                auto &lazy_region = dyn_cast< core::LazyOp >(*lazy_op).getLazy();
+
+                // Last block should have hl.value.yield with the final value
+                auto &yield = lazy_region.back().back();
+                auto res = dyn_cast< hl::ValueYieldOp>(yield).getResult();
+                rewriter.eraseOp(&yield);
+
+                auto &first_block = lazy_region.front();
+                // The rewriter API doesn't provide a call to insert into a selected block
+                auto target_it = std::next(target->getIterator());
+                rewriter.inlineRegionBefore(
+                    lazy_region, *target->getParent(), target_it
+                );
+                rewriter.mergeBlocks(&first_block, target, std::nullopt);
+
+                rewriter.eraseOp(lazy_op);
+
+                return res;
+            }
+
+            // Lazy regions with at most this many operations are evaluated
+            // eagerly if they are free of side effects.
+            static constexpr std::size_t max_speculated_ops = 8;
+
+            static bool is_speculatable(operation op) {
+                if (auto load = mlir::dyn_cast< LLVM::LoadOp >(op)) {
+                    // Loads of local variables cannot trap.
+                    return !load.getVolatile_()
+                        && load.getAddr().template getDefiningOp< LLVM::AllocaOp >();
+                }
+                // Division by zero traps.
+                if (mlir::isa< LLVM::SDivOp, LLVM::UDivOp, LLVM::SRemOp, LLVM::URemOp >(op)) {
+                    return false;
+                }
+                return mlir::isPure(op) && op->getNumRegions() == 0;
+            }
+
+            // Whether the lazy region can be evaluated unconditionally, i.e.,
+            // it is a single cheap block without side effects that yields an
+            // integer.
+            static bool is_cheap_and_pure(Operation *lazy_op) {
+                auto lazy = mlir::dyn_cast_or_null< core::LazyOp >(lazy_op);
+                if (!lazy || !lazy.getLazy().hasOneBlock()) {
+                    return false;
+                }
+
+                auto &block = lazy.getLazy().front();
+                auto yield  = mlir::dyn_cast< hl::ValueYieldOp >(block.back());
+                if (!yield || !mlir::isa< mlir::IntegerType >(yield.getResult().getType())) {
+                    return false;
+                }
+
+                // Operations of other dialects are already replaced if the
+                // region is lowered by the same conversion, they are erased
+                // only once the conversion finishes.
+                auto ops = llvm::make_filter_range(block.without_terminator(), [] (auto &op) {
+                    return mlir::isa< LLVM::LLVMDialect >(op.getDialect());
+                });
+
+                if (std::distance(ops.begin(), ops.end()) > std::ptrdiff_t(max_speculated_ops)) {
+                    return false;
+                }
+
+                return llvm::all_of(ops, [] (auto &op) { return is_speculatable(&op); });
+            }
+
+            mlir_type result_type(Operation *op) const {
+                auto type = op->getResult(0).getType();
+                if (auto tc = this->getTypeConverter()) {
+                    return tc->convertType(type);
+                }
+                return type;
+            }
+
+            // Moves the single block of the lazy region in front of `point`.
+            static Value lazy_inline(
+                Operation *lazy_op, Operation *point, conversion_rewriter &rewriter
+            ) {
+                auto &block = dyn_cast< core::LazyOp >(*lazy_op).getLazy().front();
+                auto yield  = dyn_cast< hl::ValueYieldOp >(block.back());
+                auto res    = yield.getResult();
+                rewriter.eraseOp(yield);
+                rewriter.inlineBlockBefore(&block, point, std::nullopt);
+                rewriter.eraseOp(lazy_op);
+                return res;
+            }
+
+            auto to_i1(conversion_rewriter &rewriter, Location loc, Value value) const {
+                auto zero = this->iN(rewriter, loc, value.getType(), 0);
+                return rewriter.create< LLVM::ICmpOp >(loc, LLVM::ICmpPredicate::ne, value, zero);
+            }
+        };
+
+        template< typename LOp, bool short_on_true >
+        struct lazy_bin_logical : lazy_base< LOp >
+        {
+            using base = lazy_base< LOp >;
+            using base::base;
+            using adaptor_t = typename LOp::Adaptor;
+            using base::lazy_into_block;
+            using base::iN;
+
+            // Both sides are computed and combined without branches if the
+            // right-hand side needs not be skipped. The right-hand side may
+            // be poison (e.g., an oversized shift or an overflow of `nsw`
+            // arithmetic) when the left-hand side short-circuits, hence it is
+            // combined by `llvm.select`, which does not propagate poison of
+            // the unselected value, rather than by `llvm.and` or `llvm.or`.
+            logical_result branchless(LOp op, adaptor_t ops, conversion_rewriter &rewriter) const {
+                auto lhs_res = base::lazy_inline(ops.getLhs().getDefiningOp(), op, rewriter);
+                auto rhs_res = base::lazy_inline(ops.getRhs().getDefiningOp(), op, rewriter);
+
+                rewriter.setInsertionPoint(op);
+                auto loc = op.getLoc();
+                auto lhs = this->to_i1(rewriter, loc, lhs_res);
+                auto rhs = this->to_i1(rewriter, loc, rhs_res);
+
+                auto i1 = rewriter.getI1Type();
+                auto combined = [&] () -> Value {
+                    if constexpr (short_on_true) {
+                        auto tru = this->iN(rewriter, loc, i1, 1);
+                        return rewriter.create< LLVM::SelectOp >(loc, lhs, tru, rhs);
+                    } else {
+                        auto fls = this->iN(rewriter, loc, i1, 0);
+                        return rewriter.create< LLVM::SelectOp >(loc, lhs, rhs, fls);
+                    }
+                }();
+
+                rewriter.replaceOpWithNewOp< LLVM::ZExtOp >(op, this->result_type(op), combined);
+                return logical_result::success();
+            }
+
+            void cond_br_lhs(
+                conversion_rewriter &rewriter, auto loc, Value cond, Block *rhs, Block *end) const
+            {
+                if constexpr (short_on_true) {
+                    rewriter.create< LLVM::CondBrOp >(loc, cond, end, cond, rhs, std::nullopt);
+                } else {
+                    rewriter.create< LLVM::CondBrOp >(loc, cond, rhs, std::nullopt, end, cond);
+                }
+            }
+
+            logical_result matchAndRewrite(
+                LOp op, adaptor_t ops, conversion_rewriter &rewriter) const override
+            {
+                if (base::is_cheap_and_pure(ops.getLhs().getDefiningOp())
+                    && base::is_cheap_and_pure(ops.getRhs().getDefiningOp())
+                ) {
+                    return branchless(op, ops, rewriter);
+                }
+
+                /* Splitting the block at the place of the logical operation.
+                 * It is divided into 3 parts:
+                 *   1) the operations that happen before the logical operation, to this
+                 *      part the evaluation of lhs is appended
+                 *   2) empty block to which the evaluation of rhs is inserted
+                 *   3) end block that recieves the evaluation of the logical operation
+                 */
+                auto curr_block = rewriter.getBlock();
+                auto rhs_block = curr_block->splitBlock(op);
+                auto end_block = rhs_block->splitBlock(op);
+
+                auto lhs_res = lazy_into_block(ops.getLhs().getDefiningOp(), curr_block, rewriter);
+                auto rhs_res = lazy_into_block(ops.getRhs().getDefiningOp(), rhs_block, rewriter);
+
+                rewriter.setInsertionPointToEnd(curr_block);
+                auto zero = iN(rewriter, op.getLoc(), lhs_res.getType(), 0);
+
+                auto cmp_lhs = rewriter.create< LLVM::ICmpOp >(
+                    op.getLoc(), LLVM::ICmpPredicate::ne, lhs_res, zero
+                );
+
+                // Block argument that recieves the result value
+                auto end_arg = end_block->addArgument(cmp_lhs.getType(), op.getLoc());
+
+                cond_br_lhs(rewriter, op.getLoc(), cmp_lhs, rhs_block, end_block);
+
+                // In the case that the `rhs` region consists of multiple blocks (i.e.
+                // it has already been lowered, since hl doesn't have blocks)
+                // we need to insert the break to the last block of this region - which
+                // is the region that is created by splitting the `end_block`.
+                // e.g.: in a && (b || c) mlir first matches the `||` which creates
+                // it's own cf blocks and then matches the `&&`
+                auto rhs_end_it = std::prev(end_block->getIterator());
+                rewriter.setInsertionPointToEnd(&*rhs_end_it);
+                auto cmp_rhs = rewriter.create< LLVM::ICmpOp >(
+                    op.getLoc(), LLVM::ICmpPredicate::ne, rhs_res, zero
+                );
+                rewriter.create< LLVM::BrOp >(op.getLoc(), cmp_rhs.getResult(), end_block);
+
+                rewriter.setInsertionPointToStart(end_block);
+                rewriter.replaceOpWithNewOp< LLVM::ZExtOp >(op, this->result_type(op), end_arg);
+
+                return logical_result::success();
+            }
+        };
+
+        // Only selects of cheap values without side effects are lowered, to
+        // `llvm.select`.
+        struct lazy_select : lazy_base< core::SelectOp >
+        {
+            using base = lazy_base< core::SelectOp >;
+            using base::base;
+            using adaptor_t = typename core::SelectOp::Adaptor;
+
+            logical_result matchAndRewrite(
+                core::SelectOp op, adaptor_t ops, conversion_rewriter &rewriter
+            ) const override {
+                auto then_op = ops.getThenRegion().getDefiningOp();
+                auto else_op = ops.getElseRegion().getDefiningOp();
+
+                VAST_PATTERN_CHECK(op.getNumResults() == 1, "Unsupported select: {0}", op);
+                VAST_PATTERN_CHECK(
+                    is_cheap_and_pure(then_op) && is_cheap_and_pure(else_op),
+                    "Select of lazy values with side effects: {0}", op
+                );
+                VAST_PATTERN_CHECK(
+                    then_op->getResult(0).getType() == else_op->getResult(0).getType(),
+                    "Select of values of different types: {0}", op
+                );
+
+                auto then_res = lazy_inline(then_op, op, rewriter);
+                auto else_res = lazy_inline(else_op, op, rewriter);
+
+                rewriter.setInsertionPoint(op);
+                auto cond = ops.getCond();
+                if (cond.getType() != rewriter.getI1Type()) {
+                    cond = to_i1(rewriter, op.getLoc(), cond);
+                }
+
+                rewriter.replaceOpWithNewOp< LLVM::SelectOp >(op, cond, then_res, else_res);
+                return logical_result::success();
+            }
+        };
+
+        using bin_lop_conversions = util::type_list<
+            lazy_bin_logical< core::BinLAndOp, false >,
+            lazy_bin_logical< core::BinLOrOp, true >,
+            lazy_select
+        >;
+
+    } //namespace pattern
+} // namespace vast
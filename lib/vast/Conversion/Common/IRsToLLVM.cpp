@@ -8,19 +8,26 @@ VAST_RELAX_WARNINGS
 #include <mlir/Conversion/LLVMCommon/TypeConverter.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
 #include <mlir/IR/PatternMatch.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+#include <mlir/Transforms/RegionUtils.h>
 
 #include <llvm/ADT/APFloat.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/TargetParser/Triple.h>
 VAST_UNRELAX_WARNINGS
 
 #include "../PassesDetails.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 
 #include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreDialect.hpp"
 
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
@@ -36,6 +43,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
 
 #include "Common.hpp"
+#include "CoreToLLVM.hpp"
 #include "LLCFToLLVM.hpp"
 
 namespace vast::conv::irstollvm
@@ -48,6 +56,152 @@ namespace vast::conv::irstollvm
         erase_pattern< hl::TypeDeclOp >
     >;
 
+    //
+    // Bitfield of a record with storage units (see `hl::record_layout_cache`)
+    // accessed through the member `lvalue` of the original operation. Its
+    // storage unit is loaded once per access, the field is extracted by a
+    // shift and a mask, or by a pair of shifts if it is signed, and written
+    // by a single read-modify-write of the unit, as clang emits them.
+    //
+    struct bitfield_ref
+    {
+        mlir_type type;
+        std::uint32_t offset;
+        std::uint32_t width;
+        std::uint32_t storage_bits;
+        unsigned align;
+        bool is_signed;
+
+        static std::optional< bitfield_ref > of(
+            tc::FullLLVMTypeConverter &tc, mlir_value lvalue
+        ) {
+            auto gep = lvalue.getDefiningOp< ll::StructGEPOp >();
+            if (!gep) {
+                return std::nullopt;
+            }
+
+            auto layout = tc.layouts.bitfield_layout_of(gep.getRecord().getType());
+            if (!layout || gep.getIdx() >= layout->fields.size()) {
+                return std::nullopt;
+            }
+
+            const auto &field = layout->fields[gep.getIdx()];
+            if (!field.bits || !field.member) {
+                return std::nullopt;
+            }
+
+            return in(*layout, field);
+        }
+
+        static bitfield_ref in(const hl::record_layout &layout, const hl::field_layout &field) {
+            const auto &unit = layout.members[*field.member];
+            return bitfield_ref{
+                field.type, field.bit_offset, *field.bits, std::uint32_t(unit.size),
+                unsigned(unit.access_align / 8), hl::isSigned(field.type)
+            };
+        }
+
+        mlir::IntegerType storage_type(mcontext_t *mctx) const {
+            return mlir::IntegerType::get(mctx, storage_bits);
+        }
+
+        // Value of the field as a value of the converted field type `result`.
+        mlir_value load(
+            conversion_rewriter &rewriter, loc_t loc, mlir_value addr, mlir_type result,
+            unsigned access_align
+        ) const {
+            auto storage = rewriter.create< LLVM::LoadOp >(loc, addr, std::min(align, access_align));
+            return extract(rewriter, loc, storage, offset, result);
+        }
+
+        // Stores `value` to the field, returns the new value of the field as
+        // a value of the type of `value`.
+        mlir_value store(
+            conversion_rewriter &rewriter, loc_t loc, mlir_value value, mlir_value addr,
+            unsigned access_align
+        ) const {
+            auto unit  = storage_type(rewriter.getContext());
+            auto src   = int_cast(rewriter, loc, value, unit, true);
+            auto align = std::min(this->align, access_align);
+
+            auto stored = src;
+            if (width != storage_bits) {
+                auto mask = llvm::APInt::getLowBitsSet(storage_bits, width);
+                src = rewriter.create< LLVM::AndOp >(loc, src, constant(rewriter, loc, unit, mask));
+                stored = src;
+                if (offset) {
+                    src = rewriter.create< LLVM::ShlOp >(
+                        loc, src, constant(rewriter, loc, unit, llvm::APInt(storage_bits, offset))
+                    );
+                }
+
+                auto old = rewriter.create< LLVM::LoadOp >(loc, addr, align);
+                auto cleared = rewriter.create< LLVM::AndOp >(
+                    loc, old, constant(rewriter, loc, unit, ~mask.shl(offset))
+                );
+                src = rewriter.create< LLVM::OrOp >(loc, cleared, src);
+            }
+
+            rewriter.create< LLVM::StoreOp >(loc, src, addr, align);
+            return extract(rewriter, loc, stored, 0, value.getType());
+        }
+
+      private:
+        static mlir_value constant(
+            conversion_rewriter &rewriter, loc_t loc, mlir_type type, const llvm::APInt &value
+        ) {
+            return rewriter.create< LLVM::ConstantOp >(loc, type, rewriter.getIntegerAttr(type, value));
+        }
+
+        static mlir_value int_cast(
+            conversion_rewriter &rewriter, loc_t loc, mlir_value value, mlir_type type, bool sign
+        ) {
+            auto from = mlir::dyn_cast< mlir::IntegerType >(value.getType());
+            auto to   = mlir::dyn_cast< mlir::IntegerType >(type);
+            if (!from || !to || from.getWidth() == to.getWidth()) {
+                return value;
+            }
+            if (from.getWidth() > to.getWidth()) {
+                return rewriter.create< LLVM::TruncOp >(loc, type, value);
+            }
+            if (sign) {
+                return rewriter.create< LLVM::SExtOp >(loc, type, value);
+            }
+            return rewriter.create< LLVM::ZExtOp >(loc, type, value);
+        }
+
+        // Field at `at` of the storage `value`.
+        mlir_value extract(
+            conversion_rewriter &rewriter, loc_t loc, mlir_value value, std::uint32_t at,
+            mlir_type result
+        ) const {
+            auto unit  = value.getType();
+            auto shift = [&] (std::uint32_t bits) {
+                return constant(rewriter, loc, unit, llvm::APInt(storage_bits, bits));
+            };
+
+            if (is_signed) {
+                auto high = storage_bits - at - width;
+                if (high) {
+                    value = rewriter.create< LLVM::ShlOp >(loc, value, shift(high));
+                }
+                if (at + high) {
+                    value = rewriter.create< LLVM::AShrOp >(loc, value, shift(at + high));
+                }
+            } else {
+                if (at) {
+                    value = rewriter.create< LLVM::LShrOp >(loc, value, shift(at));
+                }
+                if (at + width < storage_bits) {
+                    auto mask = llvm::APInt::getLowBitsSet(storage_bits, width);
+                    value = rewriter.create< LLVM::AndOp >(loc, value, constant(rewriter, loc, unit, mask));
+                }
+            }
+
+            return int_cast(rewriter, loc, value, result, is_signed);
+        }
+    };
+
     struct ll_struct_gep : base_pattern< ll::StructGEPOp >
     {
         using base = base_pattern< ll::StructGEPOp >;
@@ -58,104 +212,209 @@ namespace vast::conv::irstollvm
         logical_result matchAndRewrite(
             op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
         ) const override {
+            auto layout = tc.layouts.bitfield_layout_of(op.getRecord().getType());
+            if (layout && ops.getIdx() < layout->fields.size()) {
+                return rewrite_member(op, ops, *layout, rewriter);
+            }
+
             std::vector< mlir::LLVM::GEPArg > indices{ 0ul, ops.getIdx() };
             auto gep = rewriter.create< mlir::LLVM::GEPOp >(
-                op.getLoc(), convert(op.getType()), ops.getRecord(), indices
+                op.getLoc(), convert(op.getType()), ops.getRecord(), indices, /* inbounds */ true
+            );
+
+            rewriter.replaceOp(op, gep);
+            return mlir::success();
+        }
+
+        // Fields of records with storage units are addressed by their member
+        // in the lowered record, bitfields by the address of their storage.
+        logical_result rewrite_member(
+            op_t op, typename op_t::Adaptor ops, const hl::record_layout &layout,
+            conversion_rewriter &rewriter
+        ) const {
+            const auto &field = layout.fields[ops.getIdx()];
+            if (!field.member) {
+                return mlir::failure();
+            }
+
+            auto record = mlir::dyn_cast< LLVM::LLVMPointerType >(ops.getRecord().getType());
+            auto body   = record
+                ? mlir::dyn_cast< LLVM::LLVMStructType >(record.getElementType())
+                : LLVM::LLVMStructType();
+            if (!body || *field.member >= body.getBody().size()) {
+                return mlir::failure();
+            }
+
+            auto member_type = body.getBody()[*field.member];
+            std::vector< mlir::LLVM::GEPArg > indices{ 0ul, std::int32_t(*field.member) };
+            mlir_value gep = rewriter.create< mlir::LLVM::GEPOp >(
+                op.getLoc(), LLVM::LLVMPointerType::get(member_type, record.getAddressSpace()),
+                ops.getRecord(), indices, /* inbounds */ true
             );
 
+            // Storage units lowered to bytes are accessed as their integer.
+            const auto &unit = layout.members[*field.member];
+            if (field.bits && unit.as_bytes) {
+                auto storage = mlir::IntegerType::get(op.getContext(), unsigned(unit.size));
+                gep = rewriter.create< LLVM::BitcastOp >(
+                    op.getLoc(), LLVM::LLVMPointerType::get(storage, record.getAddressSpace()), gep
+                );
+            }
+
             rewriter.replaceOp(op, gep);
             return mlir::success();
         }
     };
 
-    struct ll_extract : base_pattern< ll::Extract >
+    // Coerced values are packed into and unpacked from integers of their
+    // size. Values of other types are reinterpreted as integers by a single
+    // cast, so that no operation is spent on bits that are not moved.
+    template< typename op_t >
+    struct bits_pattern : base_pattern< op_t >
     {
-        using base = base_pattern< ll::Extract >;
+        using base = base_pattern< op_t >;
         using base::base;
 
-        using op_t = ll::Extract;
+        std::size_t bw(operation op, mlir_type type) const {
+            return this->dl(op).getTypeSizeInBits(type);
+        }
+
+        mlir_type int_type(operation op, mlir_type type) const {
+            return mlir::IntegerType::get(op->getContext(), unsigned(bw(op, type)));
+        }
+
+        mlir_value to_int(operation op, mlir_value value, conversion_rewriter &rewriter) const {
+            auto type = value.getType();
+            if (mlir::isa< mlir::IntegerType >(type)) {
+                return value;
+            }
 
-        std::size_t to_number(mlir::TypedAttr attr) const {
-            auto int_attr = mlir::dyn_cast< mlir::IntegerAttr >(attr);
-            VAST_CHECK(int_attr, "Cannot convert {0} to `mlir::IntegerAttr`.", attr);
+            auto loc = op->getLoc();
+            if (mlir::isa< LLVM::LLVMPointerType >(type)) {
+                return rewriter.create< LLVM::PtrToIntOp >(loc, int_type(op, type), value);
+            }
+            return rewriter.create< LLVM::BitcastOp >(loc, int_type(op, type), value);
+        }
+
+        mlir_value from_int(operation op, mlir_value value, mlir_type type, conversion_rewriter &rewriter) const {
+            if (value.getType() == type) {
+                return value;
+            }
 
-            return int_attr.getUInt();
+            auto loc = op->getLoc();
+            if (mlir::isa< LLVM::LLVMPointerType >(type)) {
+                return rewriter.create< LLVM::IntToPtrOp >(loc, type, value);
+            }
+            return rewriter.create< LLVM::BitcastOp >(loc, type, value);
         }
+    };
 
-        bool is_consistent(op_t op) const {
-            auto size      = to_number(op.getTo()) - to_number(op.getFrom()) + 1;
-            const auto &dl = this->type_converter().getDataLayoutAnalysis()->getAtOrAbove(op);
-            auto target_bw = dl.getTypeSizeInBits(convert(op.getType()));
+    struct ll_extract : bits_pattern< ll::Extract >
+    {
+        using base = bits_pattern< ll::Extract >;
+        using base::base;
 
-            return target_bw != size;
+        using op_t = ll::Extract;
+
+        // Extracts of whole bytes of a value in memory load only the bytes
+        // at their offset.
+        mlir_value load_bytes(
+            op_t op, mlir_value ptr, mlir_type trg_type, conversion_rewriter &rewriter
+        ) const {
+            auto loc  = op.getLoc();
+            auto mctx = op.getContext();
+            auto i8   = mlir::IntegerType::get(mctx, 8);
+
+            auto bytes = rewriter.create< LLVM::BitcastOp >(loc, LLVM::LLVMPointerType::get(i8), ptr);
+            std::vector< LLVM::GEPArg > indices{ std::int32_t(op.from() / 8) };
+            auto addr = rewriter.create< LLVM::GEPOp >(
+                loc, bytes.getType(), bytes, indices, /* inbounds */ true
+            );
+            auto typed = rewriter.create< LLVM::BitcastOp >(loc, LLVM::LLVMPointerType::get(trg_type), addr);
+            return rewriter.create< LLVM::LoadOp >(loc, trg_type, typed, /* alignment */ 1);
         }
 
         logical_result matchAndRewrite(
             op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
         ) const override {
             auto loc = op.getLoc();
+            auto trg_type = convert(op.getType());
+            auto from = op.from();
 
-            auto value = [&]() -> mlir::Value {
-                auto arg = ops.getArg();
-                if (auto ptr = mlir::dyn_cast< mlir::LLVM::LLVMPointerType >(arg.getType())) {
-                    return rewriter.create< mlir::LLVM::LoadOp >(
-                        op.getLoc(), ptr.getElementType(), arg
-                    );
+            auto arg = ops.getArg();
+            if (auto ptr = mlir::dyn_cast< LLVM::LLVMPointerType >(arg.getType())) {
+                if (from % 8 == 0 && bw(op, trg_type) % 8 == 0) {
+                    rewriter.replaceOp(op, load_bytes(op, arg, trg_type, rewriter));
+                    return mlir::success();
                 }
-                return arg;
-            }();
+                arg = rewriter.create< LLVM::LoadOp >(loc, ptr.getElementType(), arg);
+            }
 
-            auto from = op.from();
+            // Same size, e.g., a double passed in an integer register.
+            if (from == 0 && bw(op, arg.getType()) == bw(op, trg_type)) {
+                rewriter.replaceOp(op, from_int(op, to_int(op, arg, rewriter), trg_type, rewriter));
+                return mlir::success();
+            }
 
-            auto shift = rewriter.create< mlir::LLVM::LShrOp >(
-                loc, value, iN(rewriter, loc, value.getType(), from)
-            );
-            auto trg_type = convert(op.getType());
-            auto trunc = rewriter.create< mlir::LLVM::TruncOp >(loc, trg_type, shift);
-            rewriter.replaceOp(op, trunc);
+            mlir_value value = to_int(op, arg, rewriter);
+            if (from != 0) {
+                value = rewriter.create< LLVM::LShrOp >(
+                    loc, value, iN(rewriter, loc, value.getType(), from)
+                );
+            }
+
+            auto int_trg = int_type(op, trg_type);
+            if (value.getType() != int_trg) {
+                value = rewriter.create< LLVM::TruncOp >(loc, int_trg, value);
+            }
+
+            rewriter.replaceOp(op, from_int(op, value, trg_type, rewriter));
             return mlir::success();
         }
     };
 
-    struct ll_concat : base_pattern< ll::Concat >
+    struct ll_concat : bits_pattern< ll::Concat >
     {
-        using base = base_pattern< ll::Concat >;
+        using base = bits_pattern< ll::Concat >;
         using base::base;
 
         using op_t = ll::Concat;
 
-        std::size_t bw(operation op) const {
-            VAST_ASSERT(op->getNumResults() == 1);
-            const auto &dl = this->type_converter().getDataLayoutAnalysis()->getAtOrAbove(op);
-            return dl.getTypeSizeInBits(convert(op->getResult(0).getType()));
-        }
-
         logical_result matchAndRewrite(
             op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
         ) const override {
             auto loc = op.getLoc();
+            auto trg_type = convert(op.getType());
+            auto args = ops.getOperands();
+
+            // A single value of the same size is only reinterpreted.
+            if (args.size() == 1 && bw(op, args[0].getType()) == bw(op, trg_type)) {
+                rewriter.replaceOp(op, from_int(op, to_int(op, args[0], rewriter), trg_type, rewriter));
+                return mlir::success();
+            }
 
-            auto resize = [&](auto w) -> mlir::Value {
-                auto trg_type = convert(op.getType());
-                if (w.getType() == trg_type) {
-                    return w;
+            auto int_trg = int_type(op, trg_type);
+            auto resize = [&] (mlir_value value) -> mlir_value {
+                value = to_int(op, value, rewriter);
+                if (value.getType() == int_trg) {
+                    return value;
                 }
-                return rewriter.create< mlir::LLVM::ZExtOp >(loc, trg_type, w);
+                return rewriter.create< LLVM::ZExtOp >(loc, int_trg, value);
             };
-            mlir::Value head = resize(ops.getOperands()[0]);
 
-            std::size_t start = bw(ops.getOperands()[0].getDefiningOp());
-            for (std::size_t i = 1; i < ops.getOperands().size(); ++i) {
-                auto full    = resize(ops.getOperands()[i]);
-                auto shifted = rewriter.create< mlir::LLVM::ShlOp >(
-                    loc, full, mk_index(loc, start, rewriter)
-                );
-                head = rewriter.create< mlir::LLVM::OrOp >(loc, head, shifted->getResult(0));
-
-                start += bw(ops.getOperands()[i].getDefiningOp());
+            mlir_value head;
+            std::size_t start = 0;
+            for (auto arg : args) {
+                auto width = bw(op, arg.getType());
+                auto part  = resize(arg);
+                if (start != 0) {
+                    part = rewriter.create< LLVM::ShlOp >(loc, part, iN(rewriter, loc, int_trg, start));
+                }
+                head  = head ? rewriter.create< LLVM::OrOp >(loc, head, part) : part;
+                start += width;
             }
 
-            rewriter.replaceOp(op, head);
+            rewriter.replaceOp(op, from_int(op, head, trg_type, rewriter));
             return mlir::success();
         }
     };
@@ -210,10 +469,401 @@ namespace vast::conv::irstollvm
         }
     };
 
-    using label_stmt = hl_scopelike< hl::LabelStmt >;
-    using scope_op   = hl_scopelike< core::ScopeOp >;
+    using scope_op = hl_scopelike< core::ScopeOp >;
+
+    // Index of a label within its function that its address (`&&label`) is
+    // lowered to, assigned before the conversion.
+    static constexpr const char *label_index_attr = "vast.label_index";
+
+    // Marks globals whose address escapes through their references, assigned
+    // before the conversion.
+    static constexpr const char *address_taken_attr = "vast.address_taken";
+
+    // Jumps are resolved once functions are flat, labels until then remain
+    // as `hl.label` markers without a body.
+    struct label_stmt : hl_scopelike< hl::LabelStmt >
+    {
+        using base = hl_scopelike< hl::LabelStmt >;
+        using base::base;
+
+        using op_t = hl::LabelStmt;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            rewriter.create< hl::LabelStmt >(op.getLoc(), ops.getLabel(), [] (auto &, auto) {});
+            return base::matchAndRewrite(op, ops, rewriter);
+        }
+
+        static bool is_marker(op_t op) {
+            auto &body = op.getBody();
+            return body.empty() || (body.hasOneBlock() && body.front().empty());
+        }
+
+        static void legalize(conversion_target &target) {
+            target.addDynamicallyLegalOp< op_t >(is_marker);
+        }
+    };
+
+    // LLVM dialect has no `blockaddress`, addresses of labels are their
+    // indices, which computed gotos dispatch on.
+    struct label_addr : base_pattern< hl::AddrLabelExpr >
+    {
+        using op_t = hl::AddrLabelExpr;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto decl = op.getLabel().getDefiningOp< hl::LabelDeclOp >();
+            VAST_PATTERN_CHECK(decl, "Address of an unknown label");
+            auto index = decl->getAttrOfType< mlir::IntegerAttr >(label_index_attr);
+            VAST_PATTERN_CHECK(index, "Address of a label without an index");
+
+            auto value = rewriter.create< LLVM::ConstantOp >(op.getLoc(), index.getType(), index);
+            rewriter.replaceOpWithNewOp< LLVM::IntToPtrOp >(op, convert(op.getType()), value);
+            return logical_result::success();
+        }
+    };
+
+    struct indirect_goto : base_pattern< hl::IndirectGotoStmt >
+    {
+        using op_t = hl::IndirectGotoStmt;
+        using base = base_pattern< op_t >;
+        using base::base;
 
-    using label_patterns = util::type_list< erase_pattern< hl::LabelDeclOp >, label_stmt >;
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            rewriter.updateRootInPlace(op, [&] { op->setOperands(ops.getOperands()); });
+            return logical_result::success();
+        }
+    };
+
+    using label_patterns = util::type_list< label_stmt, label_addr, indirect_goto >;
+
+    //
+    // Extended asm is lowered as clang lowers it. Outputs that cannot be
+    // in memory are results of `llvm.inline_asm` stored to their lvalues,
+    // the other outputs and memory inputs are passed by their address (`=*`
+    // and `*` constraints). Read-write outputs (`+`) are read by inputs tied
+    // to them, which follow the other inputs, so the numbering of operands in
+    // the template stays the same.
+    //
+    struct inline_asm : base_pattern< hl::AsmOp >
+    {
+        using op_t = hl::AsmOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        static constexpr auto npos = string_ref::npos;
+
+        // Names of operands in the order of their numbers, outputs first.
+        static llvm::SmallVector< mlir::Attribute > operand_names(op_t op) {
+            llvm::SmallVector< mlir::Attribute > names;
+            if (auto outs = op.getOutputNames()) {
+                names.append(outs->begin(), outs->end());
+            }
+            if (auto ins = op.getInputNames()) {
+                names.append(ins->begin(), ins->end());
+            }
+            return names;
+        }
+
+        static std::optional< unsigned > index_of(
+            llvm::ArrayRef< mlir::Attribute > names, string_ref name
+        ) {
+            for (auto [idx, attr] : llvm::enumerate(names)) {
+                auto str = mlir::dyn_cast< mlir::StringAttr >(attr);
+                if (str && str.getValue() == name) {
+                    return idx;
+                }
+            }
+            return std::nullopt;
+        }
+
+        // Rewrites the operand references of a gcc template to the syntax of
+        // llvm, `%0` to `$0`, `%[name]` to the number of the operand and
+        // modifiers as `%h0` to `${0:h}`.
+        static std::optional< std::string > llvm_template(
+            string_ref gcc, llvm::ArrayRef< mlir::Attribute > names
+        ) {
+            std::string out;
+            for (std::size_t i = 0; i < gcc.size(); ++i) {
+                auto c = gcc[i];
+                if (c == '$') {
+                    out += "$$";
+                    continue;
+                }
+
+                if (c != '%') {
+                    out += c;
+                    continue;
+                }
+
+                if (++i == gcc.size()) {
+                    return std::nullopt;
+                }
+
+                switch (c = gcc[i]) {
+                    case '%': out += '%'; continue;
+                    case '=': out += "${:uid}"; continue;
+                    case '{': out += "$("; continue;
+                    case '|': out += "$|"; continue;
+                    case '}': out += "$)"; continue;
+                    default: break;
+                }
+
+                char modifier = 0;
+                if (llvm::isAlpha(c)) {
+                    modifier = c;
+                    if (++i == gcc.size()) {
+                        return std::nullopt;
+                    }
+                    c = gcc[i];
+                }
+
+                unsigned idx = 0;
+                if (llvm::isDigit(c)) {
+                    auto end = gcc.find_if_not(llvm::isDigit, i);
+                    if (gcc.slice(i, end).getAsInteger(10, idx)) {
+                        return std::nullopt;
+                    }
+                    i = (end == npos ? gcc.size() : end) - 1;
+                } else if (c == '[') {
+                    auto end = gcc.find(']', i);
+                    if (end == npos) {
+                        return std::nullopt;
+                    }
+                    auto named = index_of(names, gcc.slice(i + 1, end));
+                    if (!named) {
+                        return std::nullopt;
+                    }
+                    idx = *named;
+                    i = end;
+                } else {
+                    return std::nullopt;
+                }
+
+                if (idx >= names.size()) {
+                    return std::nullopt;
+                }
+
+                if (modifier) {
+                    out += "${" + std::to_string(idx) + ":" + modifier + "}";
+                } else {
+                    out += "$" + std::to_string(idx);
+                }
+            }
+            return out;
+        }
+
+        // Basic asm has no escapes but the `$` of llvm templates.
+        static std::string escape_simple(string_ref gcc) {
+            std::string out;
+            for (auto c : gcc) {
+                if (c == '$') {
+                    out += '$';
+                }
+                out += c;
+            }
+            return out;
+        }
+
+        // Drops the modifiers the operands express, the alternatives of gcc
+        // constraints are separated by `|` in llvm.
+        static std::optional< std::string > simplify(
+            string_ref constraint, llvm::ArrayRef< mlir::Attribute > names
+        ) {
+            std::string out;
+            for (std::size_t i = 0; i < constraint.size(); ++i) {
+                switch (auto c = constraint[i]) {
+                    case '=': case '+': case '*': break;
+                    case 'g': out += "imr"; break;
+                    case ',': out += '|'; break;
+                    case '#':
+                        while (i + 1 < constraint.size() && constraint[i + 1] != ',') {
+                            ++i;
+                        }
+                        break;
+                    case '[': {
+                        auto end = constraint.find(']', i);
+                        if (end == npos) {
+                            return std::nullopt;
+                        }
+                        auto idx = index_of(names, constraint.slice(i + 1, end));
+                        if (!idx) {
+                            return std::nullopt;
+                        }
+                        out += std::to_string(*idx);
+                        i = end;
+                        break;
+                    }
+                    default: out += c;
+                }
+            }
+            return out;
+        }
+
+        static string_ref constraint_at(std::optional< mlir::ArrayAttr > constraints, std::size_t idx) {
+            return mlir::cast< mlir::StringAttr >((*constraints)[idx]).getValue();
+        }
+
+        static bool allows_memory(string_ref constraint) {
+            return constraint.find_first_of("moV<>X") != npos;
+        }
+
+        static bool memory_only(string_ref constraint) {
+            return !constraint.empty() && constraint.find_first_not_of("moV<>") == npos;
+        }
+
+        static std::string clobber(string_ref name) {
+            return "~{" + name.ltrim("%#").str() + "}";
+        }
+
+        // Clobbers clang adds to every asm of the target.
+        static llvm::ArrayRef< string_ref > machine_clobbers(op_t op) {
+            static const string_ref x86[] = { "~{dirflag}", "~{fpsr}", "~{flags}" };
+            auto mod    = op->getParentOfType< vast_module >();
+            auto triple = mod ? mod->getAttrOfType< mlir::StringAttr >(
+                core::CoreDialect::getTargetTripleAttrName()
+            ) : mlir::StringAttr();
+
+            if (triple && llvm::Triple(triple.getValue()).isX86()) {
+                return x86;
+            }
+            return {};
+        }
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            VAST_PATTERN_CHECK(!op.getHasGoto(), "asm goto is not supported");
+
+            auto names = operand_names(op);
+            auto asm_string = op.getIsSimple()
+                ? std::optional< std::string >(escape_simple(op.getAsmTemplate()))
+                : llvm_template(op.getAsmTemplate(), names);
+            VAST_PATTERN_CHECK(asm_string, "Malformed asm template");
+
+            auto output_names = llvm::ArrayRef(names).take_front(op.getAsmOutputs().size());
+            auto loc = op.getLoc();
+
+            llvm::SmallVector< std::string > constraints, tied_constraints;
+            llvm::SmallVector< mlir::Value > operands, tied_operands, results_addrs;
+            llvm::SmallVector< mlir::Attribute > operand_attrs;
+            llvm::SmallVector< mlir_type > result_types;
+
+            auto direct = [&] (mlir::Value value) {
+                operands.push_back(value);
+                operand_attrs.push_back(rewriter.getDictionaryAttr({}));
+            };
+
+            // Operands passed by address need the type of their memory.
+            auto indirect = [&] (mlir::Value addr, mlir_type element) {
+                operands.push_back(addr);
+                operand_attrs.push_back(rewriter.getDictionaryAttr(rewriter.getNamedAttr(
+                    LLVM::InlineAsmOp::getElementTypeAttrName(), mlir::TypeAttr::get(element)
+                )));
+            };
+
+            auto element_type = [&] (mlir::Value value) {
+                return convert(mlir::cast< hl::LValueType >(value.getType()).getElementType());
+            };
+
+            for (auto [idx, out] : llvm::enumerate(op.getAsmOutputs())) {
+                auto gcc    = constraint_at(op.getOutputConstraints(), idx);
+                auto simple = simplify(gcc, output_names);
+                VAST_PATTERN_CHECK(simple, "Malformed asm constraint: {0}", gcc);
+
+                auto addr    = ops.getAsmOutputs()[idx];
+                auto element = element_type(out);
+                if (allows_memory(*simple)) {
+                    constraints.push_back("=*" + *simple);
+                    indirect(addr, element);
+                    continue;
+                }
+
+                constraints.push_back("=" + *simple);
+                result_types.push_back(element);
+                results_addrs.push_back(addr);
+
+                if (gcc.contains('+')) {
+                    tied_constraints.push_back(std::to_string(idx));
+                    tied_operands.push_back(rewriter.create< LLVM::LoadOp >(loc, element, addr));
+                }
+            }
+
+            for (auto [idx, in] : llvm::enumerate(op.getAsmInputs())) {
+                auto gcc    = constraint_at(op.getInputConstraints(), idx);
+                auto simple = simplify(gcc, output_names);
+                VAST_PATTERN_CHECK(simple, "Malformed asm constraint: {0}", gcc);
+
+                auto value = ops.getAsmInputs()[idx];
+                if (!mlir::isa< hl::LValueType >(in.getType())) {
+                    constraints.push_back(*simple);
+                    direct(value);
+                } else if (memory_only(*simple)) {
+                    constraints.push_back("*" + *simple);
+                    indirect(value, element_type(in));
+                } else {
+                    constraints.push_back(*simple);
+                    direct(rewriter.create< LLVM::LoadOp >(loc, element_type(in), value));
+                }
+            }
+
+            constraints.append(tied_constraints);
+            for (auto value : tied_operands) {
+                direct(value);
+            }
+
+            if (auto clobbers = op.getClobbers()) {
+                for (auto name : clobbers->getAsValueRange< mlir::StringAttr >()) {
+                    constraints.push_back(clobber(name));
+                }
+            }
+
+            for (auto name : machine_clobbers(op)) {
+                constraints.push_back(name.str());
+            }
+
+            mlir_type result_type;
+            if (result_types.size() == 1) {
+                result_type = result_types.front();
+            } else if (result_types.size() > 1) {
+                result_type = LLVM::LLVMStructType::getLiteral(rewriter.getContext(), result_types);
+            }
+
+            // Asm without outputs is implicitly volatile.
+            bool side_effects = op.getIsVolatile() || op.getAsmOutputs().empty();
+
+            auto asm_op = rewriter.create< LLVM::InlineAsmOp >(
+                loc, result_type, operands,
+                rewriter.getStringAttr(*asm_string),
+                rewriter.getStringAttr(llvm::join(constraints, ",")),
+                side_effects ? rewriter.getUnitAttr() : mlir::UnitAttr(),
+                /* is align stack */ mlir::UnitAttr(),
+                /* asm dialect */ LLVM::AsmDialectAttr(),
+                rewriter.getArrayAttr(operand_attrs)
+            );
+
+            for (auto [idx, addr] : llvm::enumerate(results_addrs)) {
+                mlir::Value result = asm_op.getRes();
+                if (result_types.size() > 1) {
+                    result = rewriter.create< LLVM::ExtractValueOp >(
+                        loc, result, llvm::ArrayRef< int64_t >{ std::int64_t(idx) }
+                    );
+                }
+                rewriter.create< LLVM::StoreOp >(loc, result, addr);
+            }
+
+            rewriter.eraseOp(op);
+            return logical_result::success();
+        }
+    };
+
+    using asm_patterns = util::type_list< inline_asm >;
 
     // TODO(conv): Figure out if these can be somehow unified.
     using inline_region_from_op_conversions =
@@ -232,16 +882,83 @@ namespace vast::conv::irstollvm
             auto trg_type = tc.convert_type_to_type(op.getType());
             VAST_PATTERN_CHECK(trg_type, "Could not convert vardecl type");
 
+            // Elements of vectors are addressed within the vector in memory.
+            llvm::SmallVector< LLVM::GEPArg, 2 > indices;
+            if (mlir::isa< mlir::VectorType >(hl::strip_value_category(op.getArray()))) {
+                VAST_PATTERN_CHECK(mlir::isa< hl::LValueType >(op.getArray().getType()),
+                    "Subscript of a vector value is not supported"
+                );
+                indices.push_back(0);
+            }
+            indices.push_back(ops.getIndex());
+
+            // Subscripts stay within the array, or point one past its end.
             auto gep = rewriter.create< mlir::LLVM::GEPOp >(
                     op.getLoc(),
                     *trg_type, ops.getArray(),
-                    ops.getIndex() );
+                    indices, /* inbounds */ true );
 
             rewriter.replaceOp(op, gep);
             return logical_result::success();
         }
     };
 
+    struct shuffle_vector : base_pattern< hl::ShuffleVectorOp >
+    {
+        using op_t = hl::ShuffleVectorOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+                op_t op, typename op_t::Adaptor ops,
+                conversion_rewriter &rewriter) const override
+        {
+            rewriter.replaceOpWithNewOp< LLVM::ShuffleVectorOp >(
+                op, ops.getLhs(), ops.getRhs(), op.getMask()
+            );
+            return logical_result::success();
+        }
+    };
+
+
+    // Number of scalars the aggregate consists of.
+    static std::size_t scalar_count(mlir_type type)
+    {
+        if (auto array = mlir::dyn_cast< LLVM::LLVMArrayType >(type))
+            return array.getNumElements() * scalar_count(array.getElementType());
+
+        if (auto record = mlir::dyn_cast< LLVM::LLVMStructType >(type))
+        {
+            std::size_t count = 0;
+            for (auto member : record.getBody())
+                count += scalar_count(member);
+            return count;
+        }
+
+        return 1;
+    }
+
+    static bool is_load(operation op)
+    {
+        auto cast = mlir::dyn_cast< hl::ImplicitCastOp >(op);
+        return cast && cast.getKind() == hl::CastKind::LValueToRValue;
+    }
+
+    // Tensor type of the constant value of nested arrays of scalars, null
+    // for any other type.
+    static mlir::RankedTensorType as_tensor_type(mlir_type type)
+    {
+        llvm::SmallVector< std::int64_t, 2 > shape;
+        while (auto array = mlir::dyn_cast< LLVM::LLVMArrayType >(type))
+        {
+            shape.push_back(array.getNumElements());
+            type = array.getElementType();
+        }
+
+        if (shape.empty() || !mlir::isa< mlir::IntegerType, mlir::FloatType >(type))
+            return {};
+        return mlir::RankedTensorType::get(shape, type);
+    }
 
     struct uninit_var : base_pattern< ll::UninitializedVar >
     {
@@ -249,10 +966,30 @@ namespace vast::conv::irstollvm
         using base = base_pattern< op_t >;
         using base::base;
 
+        // Allocas outside of the entry block are dynamic allocations, e.g.,
+        // grow the stack in every iteration of a loop. Variables of nested
+        // blocks are therefore allocated in the entry block, their scopes are
+        // kept by lifetime markers.
+        static mlir::Block *entry_block(op_t op)
+        {
+            auto fn = op->getParentOfType< LLVM::LLVMFuncOp >();
+            if (!fn || fn.getBody().empty())
+                return nullptr;
+
+            auto entry = &fn.getBody().front();
+            if (op->getBlock() == entry || !entry->mightHaveTerminator())
+                return nullptr;
+            return entry;
+        }
+
         logical_result matchAndRewrite(
                 op_t op, typename op_t::Adaptor ops,
                 conversion_rewriter &rewriter) const override
         {
+            mlir::OpBuilder::InsertionGuard guard(rewriter);
+            if (auto entry = entry_block(op))
+                rewriter.setInsertionPoint(entry->getTerminator());
+
             auto alloca = mk_alloca(rewriter, convert(op.getType()), op.getLoc());
             rewriter.replaceOp(op, alloca);
 
@@ -260,69 +997,410 @@ namespace vast::conv::irstollvm
         }
     };
 
-    struct initialize_var : base_pattern< ll::InitializeVar >
+    template< typename op_t, typename marker_t >
+    struct lifetime_marker : base_pattern< op_t >
     {
-        using op_t = ll::InitializeVar;
         using base = base_pattern< op_t >;
         using base::base;
 
-        // TODO(conv:abi): This seems like a weird hack, try to figure out
-        //                 how to make this more sane.
-        // First one is intended to catch the `adaptor`
-        auto erase(auto, auto &) const {}
-        auto erase(hl::InitListExpr op, auto &rewriter) const
+        logical_result matchAndRewrite(
+                op_t op, typename op_t::Adaptor ops,
+                conversion_rewriter &rewriter) const override
+        {
+            auto ptr = mlir::dyn_cast< LLVM::LLVMPointerType >(ops.getVar().getType());
+            VAST_PATTERN_CHECK(ptr && ptr.getElementType(), "Lifetime marker of a non-pointer");
+
+            auto size = this->dl(op).getTypeSize(ptr.getElementType());
+            rewriter.replaceOpWithNewOp< marker_t >(
+                op, static_cast< std::int64_t >(size), ops.getVar()
+            );
+
+            return logical_result::success();
+        }
+    };
+
+    using lifetime_start = lifetime_marker< ll::LifetimeStart, LLVM::LifetimeStartOp >;
+    using lifetime_end   = lifetime_marker< ll::LifetimeEnd, LLVM::LifetimeEndOp >;
+
+    struct initialize_var : access_pattern< ll::InitializeVar >
+    {
+        using op_t = ll::InitializeVar;
+        using base = access_pattern< op_t >;
+        using base::base;
+
+        // Aggregates initialized by more constants are initialized by memory
+        // intrinsics instead of a store per element.
+        static constexpr std::size_t max_constant_stores = 16;
+
+        static inline constexpr const char *init_global_var_prefix = "vast.init.constant_";
+
+        // TODO(conv:abi): This seems like a weird hack, try to figure out
+        //                 how to make this more sane.
+        // First one is intended to catch the `adaptor`
+        auto erase(auto, auto &) const {}
+        auto erase(hl::InitListExpr op, auto &rewriter) const
+        {
+            rewriter.eraseOp(op);
+        }
+
+        static bool points_to_scalar(mlir_type t)
+        {
+            auto ptr = mlir::dyn_cast< mlir::LLVM::LLVMPointerType >(t);
+            VAST_ASSERT(ptr);
+            return !mlir::isa< mlir::LLVM::LLVMStructType >(ptr.getElementType());
+        }
+
+        static mlir::TypedAttr constant_value(mlir_value value)
+        {
+            if (auto cst = value.getDefiningOp< LLVM::ConstantOp >())
+            {
+                if (mlir::isa< mlir::IntegerAttr, mlir::FloatAttr >(cst.getValue()))
+                    return mlir::cast< mlir::TypedAttr >(cst.getValue());
+                return {};
+            }
+
+            // Integral casts of constants, e.g., elements of `unsigned char`
+            // tables.
+            auto op = value.getDefiningOp();
+            if (!op || !mlir::isa< LLVM::TruncOp, LLVM::SExtOp, LLVM::ZExtOp >(op))
+                return {};
+
+            auto src  = mlir::dyn_cast_or_null< mlir::IntegerAttr >(constant_value(op->getOperand(0)));
+            auto type = mlir::dyn_cast< mlir::IntegerType >(value.getType());
+            if (!src || !type)
+                return {};
+
+            auto width = type.getWidth();
+            auto cst   = src.getValue();
+            if (mlir::isa< LLVM::SExtOp >(op))
+                return mlir::IntegerAttr::get(type, cst.sext(width));
+            if (mlir::isa< LLVM::ZExtOp >(op))
+                return mlir::IntegerAttr::get(type, cst.zext(width));
+            return mlir::IntegerAttr::get(type, cst.trunc(width));
+        }
+
+        static bool is_zero(mlir::TypedAttr attr)
+        {
+            if (auto int_attr = mlir::dyn_cast< mlir::IntegerAttr >(attr))
+                return int_attr.getValue().isZero();
+            return mlir::cast< mlir::FloatAttr >(attr).getValue().isPosZero();
+        }
+
+        // Collects constants of all leaves of the initializer list in the
+        // order of their addresses, fails if any of them is not a constant.
+        static bool collect_constants(
+            mlir::ValueRange elements, llvm::SmallVectorImpl< mlir::Attribute > &out
+        ) {
+            for (auto element : elements)
+            {
+                if (auto nested = mlir::dyn_cast_or_null< hl::InitListExpr >(element.getDefiningOp()))
+                {
+                    if (!collect_constants(nested.getElements(), out))
+                        return false;
+                    continue;
+                }
+
+                auto attr = constant_value(element);
+                if (!attr)
+                    return false;
+                out.push_back(attr);
+            }
+            return true;
+        }
+
+        std::string next_init_name(vast_module mod) const
+        {
+            std::size_t current = 0;
+            for (auto global : mod.getOps< mlir::LLVM::GlobalOp >())
+            {
+                auto name = global.getName();
+                if (!name.consume_front(init_global_var_prefix))
+                    continue;
+
+                std::size_t idx = 0;
+                name.getAsInteger(10, idx);
+                current = std::max< std::size_t >(idx, current);
+            }
+            return init_global_var_prefix + std::to_string(current + 1);
+        }
+
+        mlir_value mk_size(op_t op, mlir_type type, conversion_rewriter &rewriter) const
+        {
+            auto i64 = rewriter.getI64Type();
+            return rewriter.create< LLVM::ConstantOp >(
+                op.getLoc(), i64, rewriter.getIntegerAttr(i64, this->dl(op).getTypeSize(type))
+            );
+        }
+
+        // Copies the constant initializer from a constant global.
+        void copy_from_global(
+            op_t op, mlir_value ptr, mlir::RankedTensorType tensor_type,
+            llvm::ArrayRef< mlir::Attribute > constants, conversion_rewriter &rewriter
+        ) const {
+            auto type = mlir::cast< LLVM::LLVMPointerType >(ptr.getType()).getElementType();
+            auto mod  = op->getParentOfType< vast_module >();
+            auto name = next_init_name(mod);
+
+            {
+                mlir::OpBuilder::InsertionGuard guard(rewriter);
+                rewriter.setInsertionPoint(&*mod.begin());
+                rewriter.create< LLVM::GlobalOp >(
+                    op.getLoc(), type, true /* is constant */, LLVM::Linkage::Internal,
+                    name, mlir::DenseElementsAttr::get(tensor_type, constants)
+                );
+            }
+
+            auto global = rewriter.create< LLVM::AddressOfOp >(
+                op.getLoc(), LLVM::LLVMPointerType::get(type), name
+            );
+            rewriter.create< LLVM::MemcpyOp >(
+                op.getLoc(), ptr, global, mk_size(op, type, rewriter), false /* is volatile */
+            );
+        }
+
+        // Zeroes the whole variable, only non-zero elements are then stored.
+        // Elements missing in the initializer list are zeroed as well.
+        void zero_fill(op_t op, mlir_value ptr, conversion_rewriter &rewriter) const
         {
-            rewriter.eraseOp(op);
+            auto type = mlir::cast< LLVM::LLVMPointerType >(ptr.getType()).getElementType();
+            auto i8   = rewriter.getI8Type();
+            auto zero = rewriter.create< LLVM::ConstantOp >(
+                op.getLoc(), i8, rewriter.getIntegerAttr(i8, 0)
+            );
+            rewriter.create< LLVM::MemsetOp >(
+                op.getLoc(), ptr, zero, mk_size(op, type, rewriter), false /* is volatile */
+            );
         }
 
-        static bool points_to_scalar(mlir_type t)
-        {
-            auto ptr = mlir::dyn_cast< mlir::LLVM::LLVMPointerType >(t);
-            VAST_ASSERT(ptr);
-            return !mlir::isa< mlir::LLVM::LLVMStructType >(ptr.getElementType());
+        // Returns true if the initialization was emitted as memory intrinsics
+        // entirely. Otherwise, if `allow_partial` is set, mostly zero
+        // initializations are zeroed and `skip_zeroes` is set.
+        bool handle_constant_init(
+            op_t op, typename op_t::Adaptor ops, mlir_value ptr,
+            bool allow_partial, bool &skip_zeroes, conversion_rewriter &rewriter
+        ) const {
+            llvm::SmallVector< mlir::Attribute > constants;
+            if (!collect_constants(ops.getElements(), constants))
+                return false;
+
+            auto type  = mlir::cast< LLVM::LLVMPointerType >(ptr.getType()).getElementType();
+            auto count = scalar_count(type);
+            if (count <= max_constant_stores || constants.size() > count)
+                return false;
+
+            auto tensor_type  = as_tensor_type(type);
+            auto zeroes       = std::size_t(llvm::count_if(constants, [] (auto attr) {
+                return is_zero(mlir::cast< mlir::TypedAttr >(attr));
+            })) + count - constants.size();
+            auto all_zeroes   = zeroes == count;
+
+            // Elements missing at the end of a flat list are zero.
+            if (tensor_type && tensor_type.getRank() == 1 && !constants.empty())
+            {
+                auto elem = mlir::cast< mlir::TypedAttr >(constants.front()).getType();
+                while (constants.size() < count)
+                    constants.push_back(rewriter.getZeroAttr(elem));
+            }
+
+            auto complete = tensor_type
+                && tensor_type.getNumElements() == std::int64_t(constants.size())
+                && llvm::all_of(constants, [&] (auto attr) {
+                    return mlir::cast< mlir::TypedAttr >(attr).getType()
+                        == tensor_type.getElementType();
+                });
+
+            if (complete && !all_zeroes)
+            {
+                copy_from_global(op, ptr, tensor_type, constants, rewriter);
+                return true;
+            }
+
+            if (!all_zeroes && (!allow_partial || zeroes * 2 < count))
+                return false;
+
+            zero_fill(op, ptr, rewriter);
+            skip_zeroes = true;
+            return all_zeroes;
         }
 
-        void handle_root(typename op_t::Adaptor ops,
+        void handle_root(op_t op, typename op_t::Adaptor ops,
                          auto ptr, auto &rewriter) const
         {
+            if (auto layout = this->tc.layouts.bitfield_layout_of(op.getVar().getType()))
+            {
+                auto elements = ops.getElements();
+                auto type = mlir::cast< LLVM::LLVMPointerType >(ptr.getType()).getElementType();
+                if (elements.size() == 1 && elements[0].getType() == type)
+                {
+                    auto store = rewriter.template create< LLVM::StoreOp >(
+                        elements[0].getLoc(), elements[0], ptr, this->alignment(op, ptr, type)
+                    );
+                    tag(store, type);
+                    return;
+                }
+
+                zero_fill(op, ptr, rewriter);
+                return handle_bitfield_init_list(op, elements, ptr, *layout, rewriter);
+            }
+
+            auto is_struct = !points_to_scalar(ptr.getType());
+            auto is_array  = mlir::isa< LLVM::LLVMArrayType >(
+                mlir::cast< LLVM::LLVMPointerType >(ptr.getType()).getElementType()
+            );
+
+            // Arrays are initialized by a store of the whole value, hence
+            // their initialization is never split.
+            bool skip_zeroes = false;
+            if ((is_struct || is_array)
+                && handle_constant_init(op, ops, ptr, is_struct, skip_zeroes, rewriter)
+            ) {
+                return erase_nested(ops.getElements(), rewriter);
+            }
+
+            if (is_struct)
+                return handle_init_list(op, ops, ptr, skip_zeroes, rewriter);
+
+            // Vectors initialized by a list of scalars are stored element by
+            // element, elements missing in the list are zero.
+            auto type = mlir::cast< LLVM::LLVMPointerType >(ptr.getType()).getElementType();
+            if (auto vector = mlir::dyn_cast< mlir::VectorType >(type))
+            {
+                auto is_vector = [] (mlir_type t) { return mlir::isa< mlir::VectorType >(t); };
+                auto list = ops.getElements()[0].getDefiningOp< hl::InitListExpr >();
+                if (list && llvm::none_of(list.getElements().getTypes(), is_vector))
+                {
+                    if (list.getElements().size() < std::size_t(vector.getNumElements()))
+                        zero_fill(op, ptr, rewriter);
+                    return handle_init_list(op, list, ptr, false, rewriter);
+                }
+            }
+
             // Scalar need special handling, because we won't be doing any GEPs
             // into it - mlir verifier would survive that, but conversion
             // to `llvm::` will complain.
-            if (!points_to_scalar(ptr.getType()))
-                return handle_init_list(ops, ptr, rewriter);
-
             // We know it must be only one if the type is scalar.
             auto element = ops.getElements()[0];
-            rewriter.template create< LLVM::StoreOp >(
+            auto store = rewriter.template create< LLVM::StoreOp >(
                     element.getLoc(),
                     element,
-                    ptr);
+                    ptr,
+                    this->alignment(op, ptr, element.getType()));
+            tag(store, element.getType());
+        }
+
+        void erase_nested(mlir::ValueRange elements, auto &rewriter) const
+        {
+            for (auto element : elements)
+                if (auto nested = mlir::dyn_cast_or_null< hl::InitListExpr >(element.getDefiningOp()))
+                {
+                    erase_nested(nested.getElements(), rewriter);
+                    erase(nested, rewriter);
+                }
         }
 
-        void handle_init_list(auto init_list, auto ptr, auto &rewriter) const
+        void handle_init_list(op_t op, auto init_list, auto ptr,
+                              bool skip_zeroes, auto &rewriter) const
         {
             for (auto [i, element] : llvm::enumerate(init_list.getElements()))
             {
+                if (skip_zeroes)
+                    if (auto attr = constant_value(element); attr && is_zero(attr))
+                        continue;
+
                 auto e_type = LLVM::LLVMPointerType::get(element.getType());
                 std::vector< mlir::LLVM::GEPArg > indices { 0ul, i };
 
                 auto gep = rewriter.template create< LLVM::GEPOp >(
-                        element.getLoc(), e_type, ptr, indices);
+                        element.getLoc(), e_type, ptr, indices, /* inbounds */ true);
 
                 if (auto nested = mlir::dyn_cast< hl::InitListExpr >(element.getDefiningOp()))
-                    handle_init_list(nested, gep, rewriter);
+                    handle_init_list(op, nested, gep, skip_zeroes, rewriter);
                 else
-                    rewriter.template create< LLVM::StoreOp >(element.getLoc(), element, gep);
+                {
+                    auto store = rewriter.template create< LLVM::StoreOp >(
+                        element.getLoc(), element, gep,
+                        this->alignment(op, gep, element.getType())
+                    );
+                    tag(store, element.getType());
+                }
             }
             erase(init_list, rewriter);
         }
 
 
+        // Records with bitfields are zeroed, then their non-zero bitfields
+        // are merged into the storage units and other fields are stored.
+        // Unnamed bitfields are not initialized.
+        void handle_bitfield_init_list(
+            op_t op, mlir::ValueRange elements, mlir_value ptr, const hl::record_layout &layout,
+            conversion_rewriter &rewriter
+        ) const {
+            auto record = mlir::cast< LLVM::LLVMPointerType >(ptr.getType());
+            auto body   = mlir::cast< LLVM::LLVMStructType >(record.getElementType());
+
+            auto is_initialized = [] (const hl::field_layout &field) {
+                return !field.bits || !field.name.starts_with("anonymous[");
+            };
+
+            auto element = elements.begin();
+            for (const auto &field : layout.fields)
+            {
+                if (element == elements.end())
+                    break;
+                if (!is_initialized(field))
+                    continue;
+
+                auto value = *element++;
+                if (!field.member)
+                    continue;
+                if (auto attr = constant_value(value); attr && is_zero(attr))
+                    continue;
+
+                auto loc = value.getLoc();
+                auto member_type = body.getBody()[*field.member];
+                std::vector< mlir::LLVM::GEPArg > indices { 0ul, std::int32_t(*field.member) };
+                mlir_value gep = rewriter.template create< LLVM::GEPOp >(
+                    loc, LLVM::LLVMPointerType::get(member_type, record.getAddressSpace()),
+                    ptr, indices, /* inbounds */ true
+                );
+
+                if (field.bits)
+                {
+                    auto bitfield = bitfield_ref::in(layout, field);
+                    auto storage  = bitfield.storage_type(op.getContext());
+                    if (layout.members[*field.member].as_bytes)
+                        gep = rewriter.template create< LLVM::BitcastOp >(
+                            loc, LLVM::LLVMPointerType::get(storage, record.getAddressSpace()), gep
+                        );
+                    bitfield.store(rewriter, loc, value, gep, this->alignment(op, gep, storage));
+                    continue;
+                }
+
+                auto nested = mlir::dyn_cast_or_null< hl::InitListExpr >(value.getDefiningOp());
+                if (!nested)
+                {
+                    auto store = rewriter.template create< LLVM::StoreOp >(
+                        loc, value, gep, this->alignment(op, gep, value.getType())
+                    );
+                    tag(store, value.getType());
+                    continue;
+                }
+
+                if (auto nested_layout = this->tc.layouts.bitfield_layout_of(field.type))
+                {
+                    handle_bitfield_init_list(op, nested.getElements(), gep, *nested_layout, rewriter);
+                    erase(nested, rewriter);
+                }
+                else
+                    handle_init_list(op, nested, gep, true /* skip zeroes */, rewriter);
+            }
+        }
+
         logical_result matchAndRewrite(
                 op_t op, typename op_t::Adaptor ops,
                 conversion_rewriter &rewriter) const override
         {
-            handle_root(ops, ops.getVar(), rewriter);
+            handle_root(op, ops, ops.getVar(), rewriter);
             rewriter.replaceOp(op, ops.getVar());
 
             return logical_result::success();
@@ -364,6 +1442,306 @@ namespace vast::conv::irstollvm
         using base = base_pattern< op_t >;
         using base::base;
 
+        using constants_t = llvm::SmallVector< llvm::APInt >;
+        using float_constants_t = llvm::SmallVector< llvm::APFloat >;
+
+        static bool is_foldable(operation op) {
+            return mlir::isa<
+                hl::ConstantOp, hl::ImplicitCastOp, hl::InitListExpr, hl::ValueYieldOp
+            >(op);
+        }
+
+        // Value of an integer constant, possibly under integral casts, as
+        // a value of the converted type of `value`.
+        std::optional< llvm::APInt > fold_int(mlir_value value) const {
+            auto type = mlir::dyn_cast< mlir::IntegerType >(this->convert(value.getType()));
+            if (!type) {
+                return std::nullopt;
+            }
+
+            if (auto cst = value.getDefiningOp< hl::ConstantOp >()) {
+                if (auto attr = mlir::dyn_cast< core::IntegerAttr >(cst.getValue())) {
+                    return attr.getValue().sextOrTrunc(type.getWidth());
+                }
+                return std::nullopt;
+            }
+
+            auto cast = value.getDefiningOp< hl::ImplicitCastOp >();
+            if (!cast || cast.getKind() != hl::CastKind::IntegralCast) {
+                return std::nullopt;
+            }
+
+            auto src = fold_int(cast.getValue());
+            if (!src) {
+                return std::nullopt;
+            }
+
+            auto src_type = mlir::dyn_cast< mlir::IntegerType >(cast.getValue().getType());
+            if (src_type && src_type.isUnsigned()) {
+                return src->zextOrTrunc(type.getWidth());
+            }
+            return src->sextOrTrunc(type.getWidth());
+        }
+
+        std::optional< llvm::APFloat > fold_float(mlir_value value) const {
+            auto type = mlir::dyn_cast< mlir::FloatType >(this->convert(value.getType()));
+            auto cst  = value.getDefiningOp< hl::ConstantOp >();
+            if (!type || !cst) {
+                return std::nullopt;
+            }
+
+            auto attr = mlir::dyn_cast< core::FloatAttr >(cst.getValue());
+            if (!attr) {
+                return std::nullopt;
+            }
+
+            bool lost = false;
+            auto result = attr.getValue();
+            result.convert(type.getFloatSemantics(), llvm::APFloat::rmNearestTiesToEven, &lost);
+            return result;
+        }
+
+        // Collects scalars of the `value` of the converted `type` in the
+        // order of their addresses. Elements missing at the end of
+        // initializer lists are zero.
+        template< typename constant_t >
+        bool fold(mlir_value value, mlir_type type, llvm::SmallVectorImpl< constant_t > &out) const {
+            auto array = mlir::dyn_cast< LLVM::LLVMArrayType >(type);
+            if (!array) {
+                std::optional< constant_t > scalar;
+                if constexpr (std::is_same_v< constant_t, llvm::APInt >) {
+                    scalar = fold_int(value);
+                } else {
+                    scalar = fold_float(value);
+                }
+
+                if (!scalar) {
+                    return false;
+                }
+                out.push_back(*scalar);
+                return true;
+            }
+
+            auto list = value.getDefiningOp< hl::InitListExpr >();
+            if (!list || list.getElements().size() > array.getNumElements()) {
+                return false;
+            }
+
+            for (auto element : list.getElements()) {
+                if (!fold(element, array.getElementType(), out)) {
+                    return false;
+                }
+            }
+
+            auto missing = (array.getNumElements() - list.getElements().size())
+                * scalar_count(array.getElementType());
+            if (missing != 0) {
+                auto scalar = as_tensor_type(array).getElementType();
+                if constexpr (std::is_same_v< constant_t, llvm::APInt >) {
+                    out.append(missing, llvm::APInt::getZero(scalar.getIntOrFloatBitWidth()));
+                } else {
+                    auto semantics = mlir::cast< mlir::FloatType >(scalar).getFloatSemantics();
+                    out.append(missing, llvm::APFloat::getZero(semantics));
+                }
+            }
+
+            return true;
+        }
+
+        // Constant value of the initializer that consists only of constants,
+        // their integral casts and initializer lists of nested arrays of
+        // scalars. Such initializers are emitted as the value of the global
+        // instead of operations building it element by element.
+        mlir::Attribute fold_initializer(op_t op, mlir_type target_type) const {
+            auto &init = op.getInitializer();
+            if (!init.hasOneBlock() || !llvm::all_of(init.front(), is_foldable)) {
+                return {};
+            }
+
+            auto yield = mlir::dyn_cast< hl::ValueYieldOp >(init.front().getTerminator());
+            if (!yield) {
+                return {};
+            }
+
+            auto value = yield.getResult();
+
+            if (mlir::isa< mlir::IntegerType >(target_type)) {
+                if (auto cst = fold_int(value)) {
+                    return mlir::IntegerAttr::get(target_type, *cst);
+                }
+                return {};
+            }
+
+            if (mlir::isa< mlir::FloatType >(target_type)) {
+                if (auto cst = fold_float(value)) {
+                    return mlir::FloatAttr::get(target_type, *cst);
+                }
+                return {};
+            }
+
+            auto tensor_type = as_tensor_type(target_type);
+            if (!tensor_type) {
+                return {};
+            }
+
+            if (mlir::isa< mlir::IntegerType >(tensor_type.getElementType())) {
+                constants_t constants;
+                if (!fold(value, target_type, constants)) {
+                    return {};
+                }
+                return mlir::DenseElementsAttr::get(tensor_type, constants);
+            }
+
+            float_constants_t constants;
+            if (!fold(value, target_type, constants)) {
+                return {};
+            }
+            return mlir::DenseElementsAttr::get(tensor_type, constants);
+        }
+
+        // Zero constants, their casts that keep the value zero and
+        // initializer lists of such values. Elements missing at the end of
+        // initializer lists are zero as well.
+        static bool is_zero_value(mlir_value value) {
+            if (auto list = value.getDefiningOp< hl::InitListExpr >()) {
+                return llvm::all_of(list.getElements(), is_zero_value);
+            }
+
+            if (auto cast = value.getDefiningOp< hl::ImplicitCastOp >()) {
+                switch (cast.getKind()) {
+                    case hl::CastKind::IntegralCast:
+                    case hl::CastKind::IntegralToBoolean:
+                    case hl::CastKind::IntegralToFloating:
+                    case hl::CastKind::FloatingCast:
+                    case hl::CastKind::NullToPointer:
+                        return is_zero_value(cast.getValue());
+                    default:
+                        return false;
+                }
+            }
+
+            auto cst = value.getDefiningOp< hl::ConstantOp >();
+            if (!cst) {
+                return false;
+            }
+
+            if (auto attr = mlir::dyn_cast< core::IntegerAttr >(cst.getValue())) {
+                return attr.getValue().isZero();
+            }
+
+            // Negative zero is not all zero bits.
+            if (auto attr = mlir::dyn_cast< core::FloatAttr >(cst.getValue())) {
+                return attr.getValue().isPosZero();
+            }
+            return false;
+        }
+
+        // Tentative definitions and definitions with an initializer of zero
+        // values only.
+        static bool is_zero_initialized(op_t op) {
+            auto &init = op.getInitializer();
+            if (init.empty()) {
+                return !op.hasExternalStorage();
+            }
+
+            if (!init.hasOneBlock() || !llvm::all_of(init.front(), is_foldable)) {
+                return false;
+            }
+
+            auto yield = mlir::dyn_cast< hl::ValueYieldOp >(init.front().getTerminator());
+            return yield && is_zero_value(yield.getResult());
+        }
+
+        // Zero value of the type, null if there is no attribute for the zero
+        // value of the type.
+        static mlir::Attribute zero_value(mlir_type type, conversion_rewriter &rewriter) {
+            if (mlir::isa< mlir::IntegerType, mlir::FloatType >(type)) {
+                return rewriter.getZeroAttr(type);
+            }
+
+            if (auto tensor_type = as_tensor_type(type)) {
+                auto zero = rewriter.getZeroAttr(tensor_type.getElementType());
+                return mlir::DenseElementsAttr::get(tensor_type, zero);
+            }
+
+            return {};
+        }
+
+        // Values of the global are only loaded, directly or through
+        // subscripts of the decayed array.
+        static bool is_only_loaded(mlir_value ref) {
+            return llvm::all_of(ref.getUsers(), [] (operation user) {
+                if (is_load(user)) {
+                    return true;
+                }
+
+                auto cast = mlir::dyn_cast< hl::ImplicitCastOp >(user);
+                if (!cast || cast.getKind() != hl::CastKind::ArrayToPointerDecay) {
+                    return false;
+                }
+
+                return llvm::all_of(cast->getUsers(), [&] (operation use) {
+                    auto subscript = mlir::dyn_cast< hl::SubscriptOp >(use);
+                    return subscript && subscript.getArray() == cast.getResult()
+                        && is_only_loaded(subscript.getResult());
+                });
+            });
+        }
+
+        LLVM::GlobalOp make_global(
+            op_t op, mlir_type type, mlir::Attribute value, conversion_rewriter &rewriter
+        ) const {
+            auto constant = hl::has_constant_storage(op);
+            auto linkage  = op.getStorageClass() == hl::StorageClass::sc_static
+                ? LLVM::Linkage::Internal : LLVM::Linkage::External;
+
+            auto gop = rewriter.create< LLVM::GlobalOp >(
+                op.getLoc(), type, constant, linkage, op.getName(), value
+            );
+
+            // Constants nobody can observe the address of can be merged with
+            // other read-only data.
+            if (constant && linkage == LLVM::Linkage::Internal && !op->hasAttr(address_taken_attr)) {
+                gop.setUnnamedAddrAttr(LLVM::UnnamedAddrAttr::get(
+                    op.getContext(), LLVM::UnnamedAddr::Global
+                ));
+            }
+
+            if (op.getThreadStorageClass().value_or(hl::TSClass::tsc_none) != hl::TSClass::tsc_none) {
+                gop.setThreadLocal_(true);
+                auto tls_model = hl::HighLevelDialect::getTLSModelAttrName();
+                if (auto model = op->getAttr(tls_model)) {
+                    gop->setAttr(tls_model, model);
+                }
+            }
+
+            return gop;
+        }
+
+        // There are no zero constants of records in llvm dialect, globals of
+        // records and of arrays of records are emitted as zeroed bytes with
+        // the alignment of their type instead. References to such globals are
+        // cast to their type once the module is converted.
+        bool make_zero_global(
+            op_t op, mlir_type type, conversion_rewriter &rewriter
+        ) const {
+            if (auto zero = zero_value(type, rewriter)) {
+                make_global(op, type, zero, rewriter);
+                return true;
+            }
+
+            const auto &dl = this->dl(op);
+            auto size = dl.getTypeSize(type);
+            if (size == 0) {
+                return false;
+            }
+
+            auto bytes = LLVM::LLVMArrayType::get(rewriter.getI8Type(), size);
+            auto gop   = make_global(op, bytes, zero_value(bytes, rewriter), rewriter);
+            gop.setAlignment(dl.getTypeABIAlignment(type));
+            return true;
+        }
+
         logical_result matchAndRewrite(
                 op_t op, typename op_t::Adaptor ops,
                 conversion_rewriter &rewriter) const override
@@ -371,18 +1749,25 @@ namespace vast::conv::irstollvm
             auto t = mlir::dyn_cast< hl::LValueType >(op.getType());
             auto target_type = this->convert(t.getElementType());
 
+            // Globals initialized to zero get a zero value, hence they are
+            // placed in `.bss` and no operations build their value.
+            if (is_zero_initialized(op) && make_zero_global(op, target_type, rewriter)) {
+                rewriter.eraseOp(op);
+                return logical_result::success();
+            }
+
+            if (auto value = fold_initializer(op, target_type)) {
+                make_global(op, target_type, value, rewriter);
+                rewriter.eraseOp(op);
+                return logical_result::success();
+            }
+
             // Sadly, we cannot build `mlir::LLVM::GlobalOp` without
             // providing a value attribute.
             auto dummy_value = rewriter.getIntegerAttr(target_type, 0);
 
             // So we know this is a global, otherwise it would be in `ll:`.
-            auto gop = rewriter.create< mlir::LLVM::GlobalOp >(
-                    op.getLoc(),
-                    target_type,
-                    // TODO(conv:irstollvm): Constant.
-                    true,
-                    LLVM::Linkage::Internal,
-                    op.getName(), dummy_value);
+            auto gop = make_global(op, target_type, dummy_value, rewriter);
 
             // If we want the global to have a body it cannot have value attribute.
             gop.removeValueAttr();
@@ -423,6 +1808,8 @@ namespace vast::conv::irstollvm
 
     using init_conversions = util::type_list<
         uninit_var,
+        lifetime_start,
+        lifetime_end,
         initialize_var,
         init_list_expr,
         vardecl,
@@ -468,6 +1855,12 @@ namespace vast::conv::irstollvm
             auto new_func = rewriter.create< LLVM::LLVMFuncOp >(
                 func_op.getLoc(), func_op.getName(), target_type, linkage, false, LLVM::CConv::C
             );
+            set_function_attrs(func_op, new_func, rewriter);
+
+            // Has to be done before the body is converted, as the analysis
+            // relies on the high-level operations.
+            set_pointer_arg_attrs(func_op, new_func, rewriter);
+            set_abi_arg_attrs(func_op, new_func);
             rewriter.inlineRegionBefore(func_op.getBody(), new_func.getBody(), new_func.end());
             tc::convert_region_types(func_op, new_func, signature);
 
@@ -478,6 +1871,180 @@ namespace vast::conv::irstollvm
             return logical_result::success();
         }
 
+        static mlir_type param_type(mlir_type type) {
+            if (auto lvalue = mlir::dyn_cast< hl::LValueType >(type)) {
+                type = lvalue.getElementType();
+            }
+            if (auto decayed = mlir::dyn_cast< hl::DecayedType >(type)) {
+                type = decayed.getElementType();
+            }
+            return type;
+        }
+
+        // The pointer value is only used to read the memory it points to.
+        static bool is_only_read_through(mlir_value ptr) {
+            return llvm::all_of(ptr.getUsers(), [&] (operation user) {
+                if (auto subscript = mlir::dyn_cast< hl::SubscriptOp >(user)) {
+                    if (subscript.getArray() != ptr) {
+                        return false;
+                    }
+                } else if (!mlir::isa< hl::Deref >(user)) {
+                    return false;
+                }
+                return llvm::all_of(user->getUsers(), is_load);
+            });
+        }
+
+        // Every use of the parameter loads its value, which in turn is only
+        // dereferenced to be loaded from. Any other use, e.g., an assignment
+        // to the parameter or passing it to a call, may write through it.
+        static bool is_readonly_param(mlir_value param) {
+            return llvm::all_of(param.getUsers(), [] (operation user) {
+                return mlir::isa< hl::DeclRefOp >(user)
+                    && llvm::all_of(user->getUsers(), [] (operation use) {
+                        return is_load(use) && is_only_read_through(use->getResult(0));
+                    });
+            });
+        }
+
+        // Lowers attributes of the source function to llvm function,
+        // parameter and result attributes. Function attributes of llvm
+        // already present, e.g., XRay sleds requested by the function
+        // instrumentation, are kept.
+        void set_function_attrs(
+            op_t func_op, LLVM::LLVMFuncOp fn, conversion_rewriter &rewriter
+        ) const {
+            auto mctx = rewriter.getContext();
+
+            llvm::SmallVector< mlir::Attribute > passthrough;
+            if (auto attrs = func_op->template getAttrOfType< mlir::ArrayAttr >("passthrough")) {
+                passthrough.append(attrs.begin(), attrs.end());
+            }
+
+            auto pass = [&] (llvm::StringRef name) {
+                passthrough.push_back(mlir::StringAttr::get(mctx, name));
+            };
+
+            auto memory = [&] (LLVM::ModRefInfo other) {
+                fn.setMemoryAttr(LLVM::MemoryEffectsAttr::get(mctx, {
+                    /* other */ other, /* argmem */ other, /* inaccessiblemem */ other
+                }));
+            };
+
+            auto unit = rewriter.getUnitAttr();
+            auto has_result = fn.getFunctionType().getReturnType()
+                && !mlir::isa< LLVM::LLVMVoidType >(fn.getFunctionType().getReturnType());
+            auto pointer_result = has_result
+                && mlir::isa< LLVM::LLVMPointerType >(fn.getFunctionType().getReturnType());
+
+            bool is_const = false;
+            for (auto attr : func_op->getAttrs()) {
+                auto value = attr.getValue();
+                if (mlir::isa< hl::HotAttr >(value))           { pass("hot"); }
+                else if (mlir::isa< hl::ColdAttr >(value))     { pass("cold"); }
+                else if (mlir::isa< hl::NoInlineAttr >(value)) { pass("noinline"); }
+                else if (mlir::isa< hl::AlwaysInlineAttr >(value)) { pass("alwaysinline"); }
+                else if (mlir::isa< hl::NoReturnAttr >(value)) { pass("noreturn"); }
+                else if (mlir::isa< hl::NoThrowAttr >(value))  { pass("nounwind"); }
+                else if (mlir::isa< hl::ConstAttr >(value)) {
+                    is_const = true;
+                    memory(LLVM::ModRefInfo::NoModRef);
+                } else if (mlir::isa< hl::PureAttr >(value) && !is_const) {
+                    memory(LLVM::ModRefInfo::Ref);
+                } else if (mlir::isa< hl::RestrictAttr >(value) && pointer_result) {
+                    // `malloc` functions return memory no other pointer aliases.
+                    fn.setResultAttr(0, LLVM::LLVMDialect::getNoAliasAttrName(), unit);
+                } else if (mlir::isa< hl::ReturnsNonNullAttr >(value) && pointer_result) {
+                    fn.setResultAttr(0, LLVM::LLVMDialect::getNonNullAttrName(), unit);
+                } else if (auto nonnull = mlir::dyn_cast< hl::NonNullAttr >(value)) {
+                    set_nonnull_args(fn, nonnull, rewriter);
+                }
+            }
+
+            if (!passthrough.empty()) {
+                fn.setPassthroughAttr(mlir::ArrayAttr::get(mctx, passthrough));
+            }
+
+            auto entry_count = hl::HighLevelDialect::getEntryCountAttrName();
+            if (auto count = func_op->template getAttrOfType< mlir::IntegerAttr >(entry_count)) {
+                fn.setFunctionEntryCount(count.getInt());
+            }
+        }
+
+        // Pointer parameters listed by the attribute, or all of them if the
+        // list is empty.
+        static void set_nonnull_args(
+            LLVM::LLVMFuncOp fn, hl::NonNullAttr attr, conversion_rewriter &rewriter
+        ) {
+            auto inputs = fn.getFunctionType().getParams();
+            auto set = [&] (unsigned idx) {
+                if (idx < inputs.size() && mlir::isa< LLVM::LLVMPointerType >(inputs[idx])) {
+                    fn.setArgAttr(idx, LLVM::LLVMDialect::getNonNullAttrName(), rewriter.getUnitAttr());
+                }
+            };
+
+            if (attr.getParams().empty()) {
+                for (unsigned idx = 0; idx < inputs.size(); ++idx) {
+                    set(idx);
+                }
+            } else {
+                for (auto idx : attr.getParams()) {
+                    set(idx);
+                }
+            }
+        }
+
+        // Restrict qualified pointer parameters are `noalias`. Pointer
+        // parameters nothing is stored through are `readonly`. Besides const
+        // qualified pointees, this covers pointees whose qualifiers were
+        // already dropped by the lowering of types.
+        void set_pointer_arg_attrs(
+            op_t func_op, LLVM::LLVMFuncOp fn, conversion_rewriter &rewriter
+        ) const {
+            auto inputs = func_op.getFunctionType().getInputs();
+            if (inputs.size() != fn.getNumArguments()) {
+                return;
+            }
+
+            auto unit = rewriter.getUnitAttr();
+            for (auto [idx, input] : llvm::enumerate(inputs)) {
+                auto ptr = mlir::dyn_cast< hl::PointerType >(param_type(input));
+                if (!ptr) {
+                    continue;
+                }
+
+                if (auto quals = ptr.getQuals(); quals && quals.getIsRestrict()) {
+                    fn.setArgAttr(idx, LLVM::LLVMDialect::getNoAliasAttrName(), unit);
+                }
+
+                if (!func_op.getBody().empty()) {
+                    auto param = func_op.getBody().front().getArgument(idx);
+                    if (is_readonly_param(param)) {
+                        fn.setArgAttr(idx, LLVM::LLVMDialect::getReadonlyAttrName(), unit);
+                    }
+                }
+            }
+        }
+
+        // Pointer parameters of the return slot and of the arguments the abi
+        // passes in memory, with the type they point to.
+        void set_abi_arg_attrs(op_t func_op, LLVM::LLVMFuncOp fn) const {
+            if (func_op.getNumArguments() != fn.getNumArguments()) {
+                return;
+            }
+
+            auto set = [&] (unsigned idx, const std::string &from, llvm::StringRef to) {
+                if (auto attr = func_op.template getArgAttrOfType< mlir::TypeAttr >(idx, from)) {
+                    fn.setArgAttr(idx, to, mlir::TypeAttr::get(this->convert(attr.getValue())));
+                }
+            };
+
+            for (unsigned idx = 0; idx < fn.getNumArguments(); ++idx) {
+                set(idx, hl::HighLevelDialect::getSRetAttrName(), LLVM::LLVMDialect::getStructRetAttrName());
+                set(idx, hl::HighLevelDialect::getByValAttrName(), LLVM::LLVMDialect::getByValAttrName());
+            }
+        }
+
         logical_result args_to_allocas(
                 mlir::LLVM::LLVMFuncOp fn,
                 conversion_rewriter &rewriter) const
@@ -536,8 +2103,20 @@ namespace vast::conv::irstollvm
 
         static inline constexpr const char *strlit_global_var_prefix = "vast.strlit.constant_";
 
+        using strlit_key_t = std::pair< mlir::Attribute, mlir_type >;
+
+        // Pool of string literals of the converted module, patterns are
+        // created for each run of the pass. Occurrences of the same literal
+        // share one global, globals are numbered in the order their
+        // literals are first converted.
+        mutable llvm::DenseMap< strlit_key_t, std::string > strlit_pool;
+        mutable std::size_t last_strlit = 0;
+
         std::string next_strlit_name(vast_module mod) const
         {
+            if (!strlit_pool.empty())
+                return strlit_global_var_prefix + std::to_string(++last_strlit);
+
             std::size_t current = 0;
             for (auto &op : mod.getOps())
             {
@@ -553,8 +2132,8 @@ namespace vast::conv::irstollvm
                 name.getAsInteger(10, idx);
                 current = std::max< std::size_t >(idx, current);
             }
-            return strlit_global_var_prefix + std::to_string(current + 1);
-
+            last_strlit = current + 1;
+            return strlit_global_var_prefix + std::to_string(last_strlit);
         }
 
         logical_result handle_void_const(
@@ -635,20 +2214,32 @@ namespace vast::conv::irstollvm
 
             auto ptr_type = mlir::dyn_cast< mlir::LLVM::LLVMPointerType >(target_type);
 
-            auto mod = op->getParentOfType< mlir::ModuleOp >();
-            auto name = next_strlit_name(mod);
-
-            rewriter.guarded([&]()
+            strlit_key_t key{ converted_attr, ptr_type.getElementType() };
+            auto it = strlit_pool.find(key);
+            if (it == strlit_pool.end())
             {
-                rewriter->setInsertionPoint(&*mod.begin());
-                rewriter->template create< mlir::LLVM::GlobalOp >(
-                    op.getLoc(),
-                    ptr_type.getElementType(),
-                    true, /* is constant */
-                    LLVM::Linkage::Internal,
-                    name,
-                    converted_attr);
-            });
+                auto mod = op->getParentOfType< mlir::ModuleOp >();
+                auto fresh = next_strlit_name(mod);
+
+                rewriter.guarded([&]()
+                {
+                    rewriter->setInsertionPoint(&*mod.begin());
+                    auto global = rewriter->template create< mlir::LLVM::GlobalOp >(
+                        op.getLoc(),
+                        ptr_type.getElementType(),
+                        true, /* is constant */
+                        LLVM::Linkage::Private,
+                        fresh,
+                        converted_attr);
+                    global.setUnnamedAddrAttr(mlir::LLVM::UnnamedAddrAttr::get(
+                        op->getContext(), mlir::LLVM::UnnamedAddr::Global
+                    ));
+                });
+
+                it = strlit_pool.try_emplace(key, std::move(fresh)).first;
+            }
+
+            const auto &name = it->second;
 
             return rewriter->template create< mlir::LLVM::AddressOfOp >(op.getLoc(),
                                                                         target_type,
@@ -721,7 +2312,17 @@ namespace vast::conv::irstollvm
         };
 
         auto lvalue_to_rvalue = [&] {
-            rewriter.template replaceOpWithNewOp< LLVM::LoadOp >(op, dst_type, src);
+            if (auto bitfield = bitfield_ref::of(pattern.tc, op.getValue())) {
+                auto storage = bitfield->storage_type(op.getContext());
+                rewriter.replaceOp(op, bitfield->load(
+                    rewriter, op.getLoc(), src, dst_type, pattern.alignment(op, src, storage)
+                ));
+                return mlir::success();
+            }
+
+            rewriter.template replaceOpWithNewOp< LLVM::LoadOp >(
+                op, dst_type, src, pattern.alignment(op, src, dst_type)
+            );
             return mlir::success();
         };
 
@@ -732,7 +2333,7 @@ namespace vast::conv::irstollvm
 
         auto arr_to_ptr_decay = [&] {
             rewriter.template replaceOpWithNewOp< LLVM::GEPOp >(
-                op, dst_type, src, LLVM::GEPArg{ 0 }
+                op, dst_type, src, LLVM::GEPArg{ 0 }, /* inbounds */ true
             );
             return mlir::success();
         };
@@ -767,6 +2368,21 @@ namespace vast::conv::irstollvm
             return mlir::success();
         };
 
+        auto vector_splat = [&] {
+            auto vector_type = mlir::cast< mlir::VectorType >(dst_type);
+            auto loc = op.getLoc();
+            auto undef = rewriter.template create< LLVM::UndefOp >(loc, vector_type);
+            auto zero = pattern.constant(rewriter, loc, rewriter.getI32Type(), 0);
+            auto element = rewriter.template create< LLVM::InsertElementOp >(
+                loc, vector_type, undef, src, zero
+            );
+            llvm::SmallVector< std::int32_t > mask(vector_type.getNumElements(), 0);
+            rewriter.template replaceOpWithNewOp< LLVM::ShuffleVectorOp >(
+                op, element, undef, mask
+            );
+            return mlir::success();
+        };
+
         auto integral_cast = [&] {
             // TODO: consult with clang, we are mistreating bool -> int conversion
             pattern.replace_with_trunc_or_ext(op, src, orig_src_type, dst_type, rewriter);
@@ -870,7 +2486,8 @@ namespace vast::conv::irstollvm
             case hl::CastKind::ToVoid:
                 return to_void();
 
-            // case hl::CastKind::VectorSplat:
+            case hl::CastKind::VectorSplat:
+                return vector_splat();
             case hl::CastKind::IntegralCast:
                 return integral_cast();
             case hl::CastKind::IntegralToBoolean:
@@ -914,8 +2531,10 @@ namespace vast::conv::irstollvm
             // case hl::CastKind::ARCReclaimReturnedObject:
             // case hl::CastKind::ARCExtendBlockObject:
 
-            // case hl::CastKind::AtomicToNonAtomic:
-            // case hl::CastKind::NonAtomicToAtomic:
+            // Atomic types are lowered to their value types.
+            case hl::CastKind::AtomicToNonAtomic:
+            case hl::CastKind::NonAtomicToAtomic:
+                return noop();
 
             // case hl::CastKind::CopyAndAutoreleaseBlockObject:
             // case hl::CastKind::BuiltinFnToFnPtr:
@@ -963,10 +2582,60 @@ namespace vast::conv::irstollvm
     };
 
 
+    //
+    // Signed overflow is undefined in C, hence additions, subtractions and
+    // multiplications of signed integers at least as wide as `int` are marked
+    // by `hl.nsw`, which the translation to llvm ir turns into `nsw` flags.
+    // Narrower operands are promoted, their overflow happens on the
+    // conversion back, which is defined. The pass drops the marks if signed
+    // overflow wraps (`wrapv`).
+    //
+    template< typename Trg >
+    void mark_no_signed_wrap(operation op, mlir_type type) {
+        constexpr bool may_wrap = std::is_same_v< Trg, LLVM::AddOp >
+            || std::is_same_v< Trg, LLVM::SubOp >
+            || std::is_same_v< Trg, LLVM::MulOp >;
+
+        if constexpr (may_wrap) {
+            constexpr unsigned int_width = 32;
+
+            auto result = mlir::dyn_cast< mlir::IntegerType >(op->getResult(0).getType());
+            if (!result || result.getWidth() < int_width) {
+                return;
+            }
+
+            type = hl::strip_value_category(type);
+            if (!hl::isIntegerType(type) && !mlir::isa< mlir::IntegerType >(type)) {
+                return;
+            }
+
+            if (hl::isSigned(type)) {
+                op->setAttr(hl::HighLevelDialect::getNoSignedWrapAttrName(), mlir::UnitAttr::get(op->getContext()));
+            }
+        }
+    }
+
+    template< typename Src, typename Trg >
+    struct integer_arith : base_pattern< Src >
+    {
+        using base = base_pattern< Src >;
+        using base::base;
+
+        using adaptor_t = typename Src::Adaptor;
+
+        logical_result
+        matchAndRewrite(Src op, adaptor_t ops, conversion_rewriter &rewriter) const override {
+            auto new_op = rewriter.create< Trg >(op.getLoc(), this->convert(op.getType()), ops.getOperands());
+            mark_no_signed_wrap< Trg >(new_op, op.getType());
+            rewriter.replaceOp(op, new_op);
+            return mlir::success();
+        }
+    };
+
     using one_to_one_conversions = util::type_list<
-        one_to_one< hl::AddIOp, LLVM::AddOp >,
-        one_to_one< hl::SubIOp, LLVM::SubOp >,
-        one_to_one< hl::MulIOp, LLVM::MulOp >,
+        integer_arith< hl::AddIOp, LLVM::AddOp >,
+        integer_arith< hl::SubIOp, LLVM::SubOp >,
+        integer_arith< hl::MulIOp, LLVM::MulOp >,
 
         one_to_one< hl::AddFOp, LLVM::FAddOp >,
         one_to_one< hl::SubFOp, LLVM::FSubOp >,
@@ -992,11 +2661,66 @@ namespace vast::conv::irstollvm
 
 
     template< typename Src, typename Trg >
-    struct assign_pattern : base_pattern< Src >
+    struct assign_pattern : access_pattern< Src >
     {
-        using base = base_pattern< Src >;
+        using base = access_pattern< Src >;
         using base::base;
 
+        // Assignment of a loaded aggregate whose result is not used, i.e., a
+        // copy of one object to another.
+        static bool is_unused_aggregate_copy(Src op, mlir_value rhs, mlir_type type) {
+            if (!mlir::isa< LLVM::LLVMStructType, LLVM::LLVMArrayType >(type)) {
+                return false;
+            }
+
+            auto src = op.getSrc();
+            return op->use_empty() && src.hasOneUse()
+                && src.template getDefiningOp< hl::ImplicitCastOp >()
+                && rhs.template getDefiningOp< LLVM::LoadOp >();
+        }
+
+        // Copies the object by `memcpy` instead of a load and a store of the
+        // whole aggregate value.
+        logical_result copy_aggregate(
+            Src op, mlir_value lhs, mlir_value rhs, mlir_type type,
+            conversion_rewriter &rewriter
+        ) const {
+            auto load = rhs.template getDefiningOp< LLVM::LoadOp >();
+            auto i64  = rewriter.getI64Type();
+            auto size = rewriter.create< LLVM::ConstantOp >(
+                op.getLoc(), i64, rewriter.getIntegerAttr(i64, this->dl(op).getTypeSize(type))
+            );
+            rewriter.create< LLVM::MemcpyOp >(
+                op.getLoc(), lhs, load.getAddr(), size, false /* is volatile */
+            );
+            rewriter.eraseOp(op);
+            rewriter.eraseOp(load);
+            return logical_result::success();
+        }
+
+        // The result is the new value of the bitfield, as in clang.
+        logical_result assign_bitfield(
+            Src op, mlir_value lhs, mlir_value rhs, mlir_type type, const bitfield_ref &bitfield,
+            conversion_rewriter &rewriter
+        ) const {
+            auto loc   = op.getLoc();
+            auto align = this->alignment(op, lhs, bitfield.storage_type(op.getContext()));
+
+            auto new_value = [&] () -> mlir_value {
+                if constexpr (!std::is_same_v< Trg, void >) {
+                    auto current = bitfield.load(rewriter, loc, lhs, type, align);
+                    auto arith   = rewriter.create< Trg >(loc, type, current, rhs);
+                    mark_no_signed_wrap< Trg >(arith, op.getSrc().getType());
+                    return arith;
+                } else {
+                    return rhs;
+                }
+            }();
+
+            rewriter.replaceOp(op, bitfield.store(rewriter, loc, new_value, lhs, align));
+            return logical_result::success();
+        }
+
         logical_result matchAndRewrite(
                     Src op, typename Src::Adaptor ops,
                     conversion_rewriter &rewriter) const override
@@ -1010,19 +2734,35 @@ namespace vast::conv::irstollvm
 
             auto target_ty = this->convert(op.getSrc().getType());
 
+            if (auto bitfield = bitfield_ref::of(this->tc, op.getDst())) {
+                return assign_bitfield(op, lhs, rhs, target_ty, *bitfield, rewriter);
+            }
+
+            auto align = this->alignment(op, lhs, target_ty);
+
+            if constexpr (std::is_same_v< Trg, void >) {
+                if (is_unused_aggregate_copy(op, rhs, target_ty)) {
+                    return copy_aggregate(op, lhs, rhs, target_ty, rewriter);
+                }
+            }
+
             // Probably the easiest way to compose this (some template specialization would
             // require a lot of boilerplate).
             auto new_op = [&]()
             {
                 if constexpr (!std::is_same_v< Trg, void >) {
-                    auto load_lhs = rewriter.create< LLVM::LoadOp >(op.getLoc(), lhs);
-                    return rewriter.create< Trg >(op.getLoc(), target_ty, load_lhs, rhs);
+                    auto load_lhs = rewriter.create< LLVM::LoadOp >(op.getLoc(), lhs, align);
+                    this->tag(load_lhs, target_ty);
+                    auto arith = rewriter.create< Trg >(op.getLoc(), target_ty, load_lhs, rhs);
+                    mark_no_signed_wrap< Trg >(arith, op.getSrc().getType());
+                    return arith;
                 } else {
                     return rhs;
                 }
             }();
 
-            rewriter.create< LLVM::StoreOp >(op.getLoc(), new_op, lhs);
+            auto store = rewriter.create< LLVM::StoreOp >(op.getLoc(), new_op, lhs, align);
+            this->tag(store, target_ty);
 
             // `hl.assign` returns value for cases like `int x = y = 5;`
             rewriter.replaceOp(op, new_op);
@@ -1059,21 +2799,168 @@ namespace vast::conv::irstollvm
         assign_pattern< hl::AssignOp, void >
     >;
 
+    // Orders of C11 map to the llvm ones, except for `consume`, which llvm
+    // does not have and clang strengthens to `acquire`.
+    static LLVM::AtomicOrdering atomic_ordering(hl::MemoryOrder order) {
+        switch (order) {
+            case hl::MemoryOrder::relaxed: return LLVM::AtomicOrdering::monotonic;
+            case hl::MemoryOrder::consume:
+            case hl::MemoryOrder::acquire: return LLVM::AtomicOrdering::acquire;
+            case hl::MemoryOrder::release: return LLVM::AtomicOrdering::release;
+            case hl::MemoryOrder::acq_rel: return LLVM::AtomicOrdering::acq_rel;
+            case hl::MemoryOrder::seq_cst: return LLVM::AtomicOrdering::seq_cst;
+        }
+        VAST_UNREACHABLE("unknown memory order");
+    }
+
+    // Loads, as well as failed exchanges, cannot release and stores cannot
+    // acquire. Such orders are undefined, they are weakened to valid ones.
+    static LLVM::AtomicOrdering load_ordering(hl::MemoryOrder order) {
+        switch (order) {
+            case hl::MemoryOrder::release: return LLVM::AtomicOrdering::monotonic;
+            case hl::MemoryOrder::acq_rel: return LLVM::AtomicOrdering::acquire;
+            default: return atomic_ordering(order);
+        }
+    }
+
+    static LLVM::AtomicOrdering store_ordering(hl::MemoryOrder order) {
+        switch (order) {
+            case hl::MemoryOrder::consume:
+            case hl::MemoryOrder::acquire: return LLVM::AtomicOrdering::monotonic;
+            case hl::MemoryOrder::acq_rel: return LLVM::AtomicOrdering::release;
+            default: return atomic_ordering(order);
+        }
+    }
+
+    struct atomic_load : base_pattern< hl::AtomicLoadOp >
+    {
+        using op_t = hl::AtomicLoadOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto type = convert(op.getType());
+            rewriter.replaceOpWithNewOp< LLVM::LoadOp >(
+                op, type, ops.getPtr(), alignment(op, ops.getPtr(), type),
+                /* volatile */ false, /* nontemporal */ false, load_ordering(op.getOrder())
+            );
+            return logical_result::success();
+        }
+    };
+
+    struct atomic_store : base_pattern< hl::AtomicStoreOp >
+    {
+        using op_t = hl::AtomicStoreOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto value = ops.getValue();
+            rewriter.replaceOpWithNewOp< LLVM::StoreOp >(
+                op, value, ops.getPtr(), alignment(op, ops.getPtr(), value.getType()),
+                /* volatile */ false, /* nontemporal */ false, store_ordering(op.getOrder())
+            );
+            return logical_result::success();
+        }
+    };
+
+    struct atomic_rmw : base_pattern< hl::AtomicRMWOp >
+    {
+        using op_t = hl::AtomicRMWOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        static LLVM::AtomicBinOp bin_op(op_t op) {
+            auto is_signed = hl::isSigned(op.getValue().getType());
+            switch (op.getKind()) {
+                case hl::AtomicRMWKind::Xchg: return LLVM::AtomicBinOp::xchg;
+                case hl::AtomicRMWKind::Add:  return LLVM::AtomicBinOp::add;
+                case hl::AtomicRMWKind::Sub:  return LLVM::AtomicBinOp::sub;
+                case hl::AtomicRMWKind::And:  return LLVM::AtomicBinOp::_and;
+                case hl::AtomicRMWKind::Or:   return LLVM::AtomicBinOp::_or;
+                case hl::AtomicRMWKind::Xor:  return LLVM::AtomicBinOp::_xor;
+                case hl::AtomicRMWKind::Nand: return LLVM::AtomicBinOp::nand;
+                case hl::AtomicRMWKind::Max:
+                    return is_signed ? LLVM::AtomicBinOp::max : LLVM::AtomicBinOp::umax;
+                case hl::AtomicRMWKind::Min:
+                    return is_signed ? LLVM::AtomicBinOp::min : LLVM::AtomicBinOp::umin;
+            }
+            VAST_UNREACHABLE("unknown read-modify-write operation");
+        }
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto value = ops.getValue();
+            rewriter.replaceOpWithNewOp< LLVM::AtomicRMWOp >(
+                op, bin_op(op), ops.getPtr(), value, atomic_ordering(op.getOrder()),
+                /* syncscope */ llvm::StringRef(), alignment(op, ops.getPtr(), value.getType())
+            );
+            return logical_result::success();
+        }
+    };
+
+    struct atomic_cmpxchg : base_pattern< hl::AtomicCmpXchgOp >
+    {
+        using op_t = hl::AtomicCmpXchgOp;
+        using base = base_pattern< op_t >;
+        using base::base;
+
+        logical_result matchAndRewrite(
+            op_t op, typename op_t::Adaptor ops, conversion_rewriter &rewriter
+        ) const override {
+            auto loc      = op.getLoc();
+            auto expected = ops.getExpected();
+
+            auto xchg = rewriter.create< LLVM::AtomicCmpXchgOp >(
+                loc, ops.getPtr(), expected, ops.getDesired(),
+                atomic_ordering(op.getSuccessOrder()), load_ordering(op.getFailureOrder()),
+                /* syncscope */ llvm::StringRef(), alignment(op, ops.getPtr(), expected.getType()),
+                op.getWeak()
+            );
+
+            using position = llvm::ArrayRef< std::int64_t >;
+            auto old = rewriter.create< LLVM::ExtractValueOp >(loc, xchg, position{ 0 });
+            mlir_value success = rewriter.create< LLVM::ExtractValueOp >(loc, xchg, position{ 1 });
+
+            auto bool_type = convert(op.getSuccess().getType());
+            if (success.getType() != bool_type) {
+                success = rewriter.create< LLVM::ZExtOp >(loc, bool_type, success);
+            }
+
+            rewriter.replaceOp(op, { success, old });
+            return logical_result::success();
+        }
+    };
+
+    using atomic_conversions = util::type_list<
+        atomic_load, atomic_store, atomic_rmw, atomic_cmpxchg
+    >;
+
 
     struct call : base_pattern< hl::CallOp >
     {
         using base = base_pattern< hl::CallOp >;
-        using base::base;
+
+        mlir::SymbolTableCollection &symbol_tables;
+
+        call(tc::FullLLVMTypeConverter &tc, mlir::SymbolTableCollection &symbol_tables)
+            : base(tc), symbol_tables(symbol_tables)
+        {}
 
         logical_result matchAndRewrite(
                     hl::CallOp op, typename hl::CallOp::Adaptor ops,
                     conversion_rewriter &rewriter) const override
         {
-            auto module = op->getParentOfType< mlir::ModuleOp >();
-            if (!module)
-                return logical_result::failure();
-
-            auto callee = module.lookupSymbol< mlir::LLVM::LLVMFuncOp >(op.getCallee());
+            // Tables contain functions as they were before the conversion,
+            // the result types are converted the same way as the callee is.
+            auto callee = symbol_tables.lookupNearestSymbolFrom< mlir::FunctionOpInterface >(
+                op, op.getCalleeAttr()
+            );
             if (!callee)
                 return logical_result::failure();
 
@@ -1084,7 +2971,11 @@ namespace vast::conv::irstollvm
 
             auto mk_call = [&](auto ... args)
             {
-                return rewriter.create< mlir::LLVM::CallOp >(op.getLoc(), args ...);
+                auto call = rewriter.create< mlir::LLVM::CallOp >(op.getLoc(), args ...);
+                auto musttail = hl::HighLevelDialect::getMustTailAttrName();
+                if (auto attr = op->getAttr(musttail))
+                    call->setAttr(musttail, attr);
+                return call;
             };
 
             if (rtys->empty() || rtys->front().isa< mlir::LLVM::LLVMVoidType >())
@@ -1137,11 +3028,18 @@ namespace vast::conv::irstollvm
             if (is_lvalue(arg))
                 return logical_result::failure();
 
-            auto value = rewriter.create< LLVM::LoadOp >(op.getLoc(), arg);
+            if (auto bitfield = bitfield_ref::of(this->tc, op.getArg()))
+                return adjust_bitfield(op, arg, *bitfield, rewriter);
+
+            auto ptr_type = mlir::cast< LLVM::LLVMPointerType >(arg.getType());
+            auto align = this->alignment(op, arg, ptr_type.getElementType());
+
+            auto value = rewriter.create< LLVM::LoadOp >(op.getLoc(), arg, align);
             auto one = this->constant(rewriter, op.getLoc(), value.getType(), 1);
             auto adjust = rewriter.create< Trg >(op.getLoc(), value, one);
+            mark_no_signed_wrap< Trg >(adjust, op.getType());
 
-            rewriter.create< LLVM::StoreOp >(op.getLoc(), adjust, arg);
+            rewriter.create< LLVM::StoreOp >(op.getLoc(), adjust, arg, align);
 
             auto yielded = [&]() {
                 if constexpr (prefix_yield< YieldAt >())
@@ -1154,6 +3052,28 @@ namespace vast::conv::irstollvm
 
             return logical_result::success();
         }
+
+        logical_result adjust_bitfield(
+            Op op, mlir_value arg, const bitfield_ref &bitfield, conversion_rewriter &rewriter
+        ) const {
+            auto loc   = op.getLoc();
+            auto type  = this->convert(bitfield.type);
+            auto align = this->alignment(op, arg, bitfield.storage_type(op.getContext()));
+
+            auto value  = bitfield.load(rewriter, loc, arg, type, align);
+            auto one    = this->constant(rewriter, loc, type, 1);
+            auto adjust = rewriter.create< Trg >(loc, value, one);
+            mark_no_signed_wrap< Trg >(adjust, op.getType());
+
+            auto stored = bitfield.store(rewriter, loc, adjust, arg, align);
+
+            if constexpr (prefix_yield< YieldAt >())
+                rewriter.replaceOp(op, stored);
+            else if constexpr (postfix_yield< YieldAt >())
+                rewriter.replaceOp(op, value);
+
+            return logical_result::success();
+        }
     };
 
     struct logical_not : base_pattern< hl::LNotOp >
@@ -1249,10 +3169,13 @@ namespace vast::conv::irstollvm
 
             auto zero = this->constant(rewriter, op.getLoc(), arg_type, 0);
 
-            if (llvm::isa< mlir::FloatType >(arg_type))
+            if (llvm::isa< mlir::FloatType >(arg_type)) {
                 rewriter.replaceOpWithNewOp< LLVM::FSubOp >(op, zero, arg);
-            else
-                rewriter.replaceOpWithNewOp< LLVM::SubOp >(op, zero, arg);
+            } else {
+                auto sub = rewriter.create< LLVM::SubOp >(op.getLoc(), zero, arg);
+                mark_no_signed_wrap< LLVM::SubOp >(sub, op.getType());
+                rewriter.replaceOp(op, sub);
+            }
 
             return logical_result::success();
         }
@@ -1304,9 +3227,9 @@ namespace vast::conv::irstollvm
         }
     };
 
-    struct deref : base_pattern< hl::Deref >
+    struct deref : access_pattern< hl::Deref >
     {
-        using base = base_pattern< hl::Deref >;
+        using base = access_pattern< hl::Deref >;
         using base::base;
 
         logical_result matchAndRewrite(
@@ -1318,7 +3241,9 @@ namespace vast::conv::irstollvm
                 return logical_result::failure();
 
             auto loaded = rewriter.create< mlir::LLVM::LoadOp >(
-                    op.getLoc(), *trg_type, ops.getAddr());
+                    op.getLoc(), *trg_type, ops.getAddr(),
+                    alignment(op, ops.getAddr(), *trg_type));
+            tag(loaded, *trg_type);
             rewriter.replaceOp(op, loaded);
 
             return logical_result::success();
@@ -1407,6 +3332,7 @@ namespace vast::conv::irstollvm
         cmp,
         deref,
         subscript,
+        shuffle_vector,
         sizeof_pattern,
         propagate_yield< hl::ExprOp, hl::ValueYieldOp >,
         value_yield_in_global_var
@@ -1473,8 +3399,6 @@ namespace vast::conv::irstollvm
 
     using lazy_op_type_conversions = util::type_list<
         lazy_op_type< core::LazyOp >,
-        lazy_op_type< core::BinLAndOp >,
-        lazy_op_type< core::BinLOrOp >,
         fixup_yield_types< hl::ValueYieldOp >
     >;
 
@@ -1496,8 +3420,6 @@ namespace vast::conv::irstollvm
             };
 
             legal_with_llvm_ret_type( core::LazyOp{} );
-            legal_with_llvm_ret_type( core::BinLAndOp{} );
-            legal_with_llvm_ret_type( core::BinLOrOp{} );
             legal_with_llvm_ret_type( hl::ValueYieldOp{} );
 
 
@@ -1505,6 +3427,12 @@ namespace vast::conv::irstollvm
                 get_has_only_legal_types< hl::InitListExpr >(tc)
             );
 
+            // Labels and jumps are lowered once the functions are converted.
+            target.addLegalOp< hl::LabelDeclOp, hl::GotoStmt >();
+            target.addDynamicallyLegalOp< hl::IndirectGotoStmt >(
+                get_has_only_legal_types< hl::IndirectGotoStmt >(tc)
+            );
+
             target.addIllegalOp< mlir::func::FuncOp >();
             target.markUnknownOpDynamicallyLegal([](auto) { return true; });
 
@@ -1517,15 +3445,18 @@ namespace vast::conv::irstollvm
                 inline_region_from_op_conversions,
                 return_conversions,
                 assign_conversions,
+                atomic_conversions,
                 unary_in_place_conversions,
                 sign_conversions,
                 init_conversions,
                 base_op_conversions,
                 ignore_patterns,
                 label_patterns,
+                asm_patterns,
                 lazy_op_type_conversions,
                 ll_generic_patterns,
-                ll_cf::conversions
+                ll_cf::conversions,
+                pattern::bin_lop_conversions
             >(cfg);
         }
 
@@ -1533,6 +3464,330 @@ namespace vast::conv::irstollvm
             llvm_options.useBarePtrCallConv = true;
         }
 
+        bool emit_tbaa_tags() const { return emit_tbaa; }
+
+        // Each return of a function has its own copy of the epilogue code
+        // and return, branches to a shared return block replace them.
+        static void merge_return_paths(LLVM::LLVMFuncOp fn) {
+            llvm::SmallVector< LLVM::ReturnOp > returns;
+            for (auto &block : fn.getBody()) {
+                if (block.empty()) {
+                    continue;
+                }
+
+                // Returns of `musttail` calls have to stay right after them.
+                if (auto ret = mlir::dyn_cast< LLVM::ReturnOp >(block.back())) {
+                    if (!musttail_call_of(ret)) {
+                        returns.push_back(ret);
+                    }
+                }
+            }
+
+            if (returns.size() < 2) {
+                return;
+            }
+
+            auto exit = new mlir::Block();
+            fn.getBody().push_back(exit);
+            for (auto type : returns.front().getOperandTypes()) {
+                exit->addArgument(type, fn.getLoc());
+            }
+
+            mlir::OpBuilder bld(fn.getContext());
+            bld.setInsertionPointToEnd(exit);
+            bld.create< LLVM::ReturnOp >(fn.getLoc(), exit->getArguments());
+
+            for (auto ret : returns) {
+                bld.setInsertionPoint(ret);
+                bld.create< LLVM::BrOp >(ret.getLoc(), ret.getOperands(), exit);
+                ret.erase();
+            }
+        }
+
+        static LLVM::CallOp musttail_call_of(LLVM::ReturnOp ret) {
+            auto call = mlir::dyn_cast_or_null< LLVM::CallOp >(ret->getPrevNode());
+            if (!call || !call->hasAttr(hl::HighLevelDialect::getMustTailAttrName())) {
+                return {};
+            }
+            return llvm::equal(ret->getOperands(), call->getResults()) ? call : LLVM::CallOp();
+        }
+
+        // Stores to memory that is never read, such as temporaries of values
+        // rebuilt by the abi lowering that nothing uses.
+        static bool is_dead_store(operation op) {
+            auto store = mlir::dyn_cast< LLVM::StoreOp >(op);
+            if (!store) {
+                return false;
+            }
+
+            auto alloca = store.getAddr().getDefiningOp< LLVM::AllocaOp >();
+            return alloca && llvm::all_of(alloca->getUsers(), [&] (operation user) {
+                auto other = mlir::dyn_cast< LLVM::StoreOp >(user);
+                return other && other.getValue() != alloca.getResult();
+            });
+        }
+
+        //
+        // A `musttail` call has to be right before the return of its result.
+        // Computations the lowering left in between whose results are not
+        // used are erased. Calls whose result is still not returned right
+        // away, for example as the abi rebuilds it in memory, are emitted as
+        // `tail` calls with a warning.
+        //
+        static void place_musttail_call(LLVM::CallOp call) {
+            auto musttail = hl::HighLevelDialect::getMustTailAttrName();
+            if (!call->hasAttr(musttail)) {
+                return;
+            }
+
+            auto block = call->getBlock();
+            for (bool erased = true; erased && !block->empty();) {
+                erased = false;
+                auto op = block->back().getPrevNode();
+                while (op && op != call.getOperation()) {
+                    auto prev = op->getPrevNode();
+                    if (mlir::isOpTriviallyDead(op) || is_dead_store(op)) {
+                        op->erase();
+                        erased = true;
+                    }
+                    op = prev;
+                }
+            }
+
+            auto ret = mlir::dyn_cast< LLVM::ReturnOp >(call->getNextNode());
+            if (ret && musttail_call_of(ret)) {
+                return;
+            }
+
+            call->removeAttr(musttail);
+            call->setAttr(hl::HighLevelDialect::getTailAttrName(), mlir::UnitAttr::get(call.getContext()));
+            mlir::emitWarning(call.getLoc(), "musttail call is not followed by a return of its result, emitted as a tail call");
+        }
+
+        // Addresses of labels are their indices within the function, starting
+        // at one so that no label is at the null address.
+        static void number_address_taken_labels(vast_module mod) {
+            llvm::DenseMap< operation, std::int64_t > last_index;
+            mod.walk([&] (hl::AddrLabelExpr addr) {
+                auto decl = addr.getLabel().getDefiningOp< hl::LabelDeclOp >();
+                if (!decl || decl->hasAttr(label_index_attr)) {
+                    return;
+                }
+
+                auto fn    = decl->getParentOfType< mlir::FunctionOpInterface >();
+                auto index = ++last_index[fn];
+                decl->setAttr(label_index_attr, mlir::IntegerAttr::get(
+                    mlir::IntegerType::get(mod.getContext(), 64), index
+                ));
+            });
+        }
+
+        // Jumps skip the declarations between them and their labels, variables
+        // of constant size are allocated at the entry of the function so that
+        // they dominate every label.
+        static void hoist_allocas(LLVM::LLVMFuncOp fn) {
+            auto &entry = fn.getBody().front();
+
+            llvm::SmallVector< LLVM::AllocaOp > allocas;
+            fn.walk([&] (LLVM::AllocaOp alloca) {
+                auto size = alloca.getArraySize().getDefiningOp< LLVM::ConstantOp >();
+                if (size && alloca->getBlock() != &entry) {
+                    allocas.push_back(alloca);
+                }
+            });
+
+            mlir::OpBuilder bld(fn.getContext());
+            bld.setInsertionPointToStart(&entry);
+            for (auto alloca : allocas) {
+                auto size = bld.clone(*alloca.getArraySize().getDefiningOp());
+                alloca->moveAfter(size);
+                alloca->setOperand(0, size->getResult(0));
+                bld.setInsertionPointAfter(alloca);
+            }
+        }
+
+        // Labels start blocks, gotos branch to them and computed gotos switch
+        // over the indices of the labels whose address is taken. Code after a
+        // jump that no label starts is unreachable and erased.
+        //
+        // Labels and jumps are collected in the order of the function first,
+        // blocks are then split at them from the back, so that every split
+        // moves only the operations up to the previous split. Otherwise every
+        // split moves the rest of its block, which makes state machines with
+        // thousands of labels quadratic.
+        static void lower_gotos(LLVM::LLVMFuncOp fn) {
+            llvm::SmallVector< hl::LabelStmt > labels;
+            llvm::SmallVector< operation > jumps;
+            fn.walk([&] (operation op) {
+                if (auto label = mlir::dyn_cast< hl::LabelStmt >(op)) {
+                    labels.push_back(label);
+                } else if (mlir::isa< hl::GotoStmt, hl::IndirectGotoStmt >(op)) {
+                    jumps.push_back(op);
+                }
+            });
+
+            if (labels.empty() && jumps.empty()) {
+                return;
+            }
+
+            hoist_allocas(fn);
+
+            mlir::OpBuilder bld(fn.getContext());
+            auto fallthrough = [&] (mlir::Block *block, mlir::Block *dest, loc_t loc) {
+                if (block->empty() || !block->back().hasTrait< mlir::OpTrait::IsTerminator >()) {
+                    bld.setInsertionPointToEnd(block);
+                    bld.create< LLVM::BrOp >(loc, mlir::ValueRange(), dest);
+                }
+            };
+
+            llvm::DenseMap< mlir_value, mlir::Block * > blocks;
+            for (auto label : llvm::reverse(labels)) {
+                auto block = label->getBlock();
+                auto dest  = block->splitBlock(label);
+                fallthrough(block, dest, label.getLoc());
+                blocks[label.getLabel()] = dest;
+                label.erase();
+            }
+
+            llvm::SmallVector< std::pair< llvm::APInt, mlir::Block * > > targets;
+            fn.walk([&] (hl::LabelDeclOp decl) {
+                auto index = decl->getAttrOfType< mlir::IntegerAttr >(label_index_attr);
+                if (index && blocks.count(decl.getResult())) {
+                    targets.emplace_back(index.getValue(), blocks[decl.getResult()]);
+                }
+            });
+
+            mlir::Block *invalid_target = nullptr;
+            auto switch_over_targets = [&] (hl::IndirectGotoStmt jump) {
+                if (!invalid_target) {
+                    invalid_target = new mlir::Block();
+                    fn.getBody().push_back(invalid_target);
+                    bld.setInsertionPointToEnd(invalid_target);
+                    bld.create< LLVM::UnreachableOp >(fn.getLoc());
+                }
+
+                llvm::SmallVector< llvm::APInt > values;
+                llvm::SmallVector< mlir::Block * > dests;
+                for (auto [value, dest] : targets) {
+                    values.push_back(value);
+                    dests.push_back(dest);
+                }
+
+                bld.setInsertionPoint(jump);
+                auto index = bld.create< LLVM::PtrToIntOp >(
+                    jump.getLoc(), bld.getI64Type(), jump.getTarget()
+                );
+                llvm::SmallVector< mlir::ValueRange > no_operands(values.size());
+                bld.create< LLVM::SwitchOp >(
+                    jump.getLoc(), index, invalid_target, mlir::ValueRange(),
+                    values, dests, no_operands
+                );
+            };
+
+            for (auto jump : llvm::reverse(jumps)) {
+                auto block = jump->getBlock();
+                auto rest  = block->splitBlock(std::next(jump->getIterator()));
+
+                if (auto direct = mlir::dyn_cast< hl::GotoStmt >(jump)) {
+                    VAST_CHECK(blocks.count(direct.getLabel()), "Goto to an unknown label");
+                    bld.setInsertionPoint(jump);
+                    bld.create< LLVM::BrOp >(
+                        jump->getLoc(), mlir::ValueRange(), blocks[direct.getLabel()]
+                    );
+                } else {
+                    switch_over_targets(mlir::cast< hl::IndirectGotoStmt >(jump));
+                }
+
+                jump->erase();
+                if (rest->empty()) {
+                    rest->erase();
+                }
+            }
+
+            mlir::IRRewriter rewriter{ fn.getContext() };
+            std::ignore = mlir::eraseUnreachableBlocks(rewriter, fn.getBody());
+        }
+
+        // References of all globals are inspected in a single walk, rather
+        // than a walk of the module for every global.
+        static void mark_address_taken_globals(vast_module mod) {
+            llvm::StringSet<> taken;
+            mod.walk([&] (hl::GlobalRefOp ref) {
+                if (!vardecl::is_only_loaded(ref.getResult())) {
+                    taken.insert(ref.getGlobal());
+                }
+            });
+
+            if (taken.empty()) {
+                return;
+            }
+
+            mod.walk([&] (hl::VarDeclOp var) {
+                if (taken.contains(var.getName())) {
+                    var->setAttr(address_taken_attr, mlir::UnitAttr::get(mod.getContext()));
+                }
+            });
+        }
+
+        void runOnOperation() override {
+            number_address_taken_labels(getOperation());
+            mark_address_taken_globals(getOperation());
+            base::runOnOperation();
+        }
+
+        bool signed_overflow_wraps() {
+            return wrapv || getOperation()->hasAttr(core::CoreDialect::getWrapvAttrName());
+        }
+
+        void after_operation() override {
+            getOperation()->walk(lower_gotos);
+            getOperation()->walk([] (hl::LabelDeclOp decl) { decl.erase(); });
+
+            // Placing the calls erases operations after them.
+            llvm::SmallVector< LLVM::CallOp > calls;
+            getOperation()->walk([&] (LLVM::CallOp call) { calls.push_back(call); });
+            llvm::for_each(calls, place_musttail_call);
+
+            if (merge_returns) {
+                getOperation()->walk(merge_return_paths);
+            }
+
+            if (signed_overflow_wraps()) {
+                getOperation()->walk([] (operation op) {
+                    op->removeAttr(hl::HighLevelDialect::getNoSignedWrapAttrName());
+                });
+            }
+
+            if (!inbounds) {
+                getOperation()->walk([] (LLVM::GEPOp gep) { gep.setInbounds(false); });
+            }
+
+            cast_zeroed_globals(getOperation());
+        }
+
+        // References to globals emitted as zeroed bytes have the type of the
+        // source global, they are cast from the address of the bytes.
+        static void cast_zeroed_globals(vast_module mod) {
+            mlir::SymbolTable symbols(mod);
+            mlir::OpBuilder bld(mod.getContext());
+
+            mod.walk([&] (LLVM::AddressOfOp addr) {
+                auto global = symbols.lookup< LLVM::GlobalOp >(addr.getGlobalName());
+                if (!global) {
+                    return;
+                }
+
+                auto type = LLVM::LLVMPointerType::get(global.getType(), global.getAddrSpace());
+                if (addr.getType() == type) {
+                    return;
+                }
+
+                bld.setInsertionPointAfter(addr);
+                auto cast = bld.create< LLVM::BitcastOp >(addr.getLoc(), addr.getType(), addr);
+                addr.getResult().replaceAllUsesExcept(cast, cast);
+                addr.getResult().setType(type);
+            });
+        }
     };
 } // namespace vast::conv
 
@@ -9,6 +9,8 @@ VAST_RELAX_WARNINGS
 #include <llvm/ADT/APFloat.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
 #include "vast/Util/Symbols.hpp"
@@ -21,6 +23,16 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::conv::irstollvm::ll_cf
 {
+    // Latches keep the hints of their loop, the translation to llvm ir
+    // attaches them as `llvm.loop` metadata.
+    static inline void copy_loop_hints(operation from, operation to)
+    {
+        auto name = hl::HighLevelDialect::getLoopHintsAttrName();
+        if (auto hints = from->getAttr(name)) {
+            to->setAttr(name, hints);
+        }
+    }
+
     struct br : base_pattern< ll::Br >
     {
         using base = base_pattern< ll::Br >;
@@ -33,7 +45,8 @@ namespace vast::conv::irstollvm::ll_cf
                     op_t op, adaptor_t ops,
                     conversion_rewriter &rewriter) const override
         {
-            rewriter.create< LLVM::BrOp >(op.getLoc(), ops.getOperands(), op.getDest());
+            auto br = rewriter.create< LLVM::BrOp >(op.getLoc(), ops.getOperands(), op.getDest());
+            copy_loop_hints(op, br);
             rewriter.eraseOp(op);
 
             return mlir::success();
@@ -53,11 +66,18 @@ namespace vast::conv::irstollvm::ll_cf
             op_t op, adaptor_t ops,
             conversion_rewriter &rewriter) const override
         {
+            std::optional< std::pair< uint32_t, uint32_t > > weights;
+            auto name = hl::HighLevelDialect::getBranchWeightsAttrName();
+            if (auto attr = op->getAttrOfType< hl::BranchWeightsAttr >(name)) {
+                weights = std::make_pair(attr.getTaken(), attr.getNotTaken());
+            }
+
             rewriter.create< LLVM::CondBrOp >(
                 op.getLoc(),
                 ops.getCond(),
                 op.getTrueDest() , ops.getTrueOperands(),
-                op.getFalseDest(), ops.getFalseOperands()
+                op.getFalseDest(), ops.getFalseOperands(),
+                weights
             );
             rewriter.eraseOp( op );
 
@@ -66,6 +86,37 @@ namespace vast::conv::irstollvm::ll_cf
 
     };
 
+    struct switch_op : base_pattern< ll::Switch >
+    {
+        using base = base_pattern< ll::Switch >;
+        using base::base;
+
+        using op_t = ll::Switch;
+        using adaptor_t = typename op_t::Adaptor;
+
+        logical_result matchAndRewrite(
+            op_t op, adaptor_t ops,
+            conversion_rewriter &rewriter) const override
+        {
+            llvm::SmallVector< llvm::APInt > values;
+            for (auto value : op.getCaseValues()) {
+                values.push_back(mlir::cast< mlir::IntegerAttr >(value).getValue());
+            }
+
+            llvm::SmallVector< mlir::ValueRange > no_operands(values.size());
+            rewriter.create< LLVM::SwitchOp >(
+                op.getLoc(),
+                ops.getValue(),
+                op.getDefaultDest(), mlir::ValueRange(),
+                values, op.getCaseDests(), no_operands
+            );
+            rewriter.eraseOp(op);
+
+            return mlir::success();
+        }
+
+    };
+
     template< typename Op >
     struct scope_like : base_pattern< Op >
     {
@@ -88,13 +139,21 @@ namespace vast::conv::irstollvm::ll_cf
             if (auto ret = mlir::dyn_cast< ll::ScopeRet >(last)) {
                 make_after_op< LLVM::BrOp >(rewriter, &last, last.getLoc(), no_vals, &end);
             } else if (auto ret = mlir::isa< ll::ScopeRecurse >(last)) {
-                make_after_op< LLVM::BrOp >(rewriter, &last, last.getLoc(),
-                                            no_vals, &start);
+                auto br = make_after_op< LLVM::BrOp >(rewriter, &last, last.getLoc(),
+                                                      no_vals, &start);
+                copy_loop_hints(&last, br);
             } else if (auto ret = mlir::dyn_cast< ll::CondScopeRet >(last)) {
+                // Loop conditions carry the weights of the profile.
+                std::optional< std::pair< uint32_t, uint32_t > > weights;
+                auto name = hl::HighLevelDialect::getBranchWeightsAttrName();
+                if (auto attr = ret->template getAttrOfType< hl::BranchWeightsAttr >(name)) {
+                    weights = std::make_pair(attr.getTaken(), attr.getNotTaken());
+                }
+
                 make_after_op< LLVM::CondBrOp >(rewriter, &last, last.getLoc(),
                                                 ret.getCond(),
                                                 ret.getDest(), ret.getDestOperands(),
-                                                &end, no_vals);
+                                                &end, no_vals, weights);
             } else {
                 // Nothing to do (do not erase, since it is a standard branching).
                 return mlir::success();
@@ -172,6 +231,7 @@ namespace vast::conv::irstollvm::ll_cf
     using conversions = util::type_list<
           cond_br
         , br
+        , switch_op
         , scope
     >;
 
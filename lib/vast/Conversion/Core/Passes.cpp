@@ -18,17 +18,18 @@ namespace vast::conv::pipeline {
         // working. In the future we will add proper debug information emission
         // directly from our frontend.
         return nested< mlir::LLVM::LLVMFuncOp >(mlir::LLVM::createDIScopeForLLVMFuncOpPass)
-            .depends_on(core_to_llvm);
+            .depends_on(irs_to_llvm);
     }
 
     pipeline_step_ptr core_to_llvm() {
-        // TODO add dependencies
         return pass(createCoreToLLVMPass)
             .depends_on(to_ll, irs_to_llvm);
     }
 
+    // Core operations are lowered together with the rest of the module by
+    // `irs_to_llvm`, which shares one type converter for all the dialects.
     pipeline_step_ptr to_llvm() {
-        return compose("to-llvm", irs_to_llvm, core_to_llvm, llvm_debug_scope);
+        return compose("to-llvm", irs_to_llvm, llvm_debug_scope);
     }
 
 } // namespace vast::conv::pipeline
@@ -10,6 +10,8 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include "PassesDetails.hpp"
+#include "Phases.hpp"
+#include "vast/Analysis/CallGraph.hpp"
 #include "vast/Conversion/Common/Block.hpp"
 #include "vast/Conversion/Common/Passes.hpp"
 #include "vast/Conversion/Common/Patterns.hpp"
@@ -141,8 +143,19 @@ namespace vast
                 bin_lop_conversions
             >(config);
         }
+
+        // Only function bodies are rewritten.
+        void after_operation() override {
+            markAnalysesPreserved<
+                mlir::DataLayoutAnalysis, hl::record_layout_cache, analysis::call_graph
+            >();
+        }
     };
 
+    conv::hltoll::phase conv::hltoll::lazy_regions_phase(mcontext_t &mctx) {
+        return make_phase< HLEmitLazyRegionsPass >(mctx);
+    }
+
     std::unique_ptr< mlir::Pass > createHLEmitLazyRegionsPass() {
         return std::make_unique< HLEmitLazyRegionsPass >();
     }
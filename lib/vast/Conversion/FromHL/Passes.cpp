@@ -9,11 +9,21 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Conversion/Passes.hpp"
 
+#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
+
 namespace vast::conv::pipeline {
 
-    pipeline_step_ptr hl_to_ll_cf() {
+    pipeline_step_ptr hl_to_ll_func() {
         // TODO add dependencies
-        return pass(createHLToLLCFPass);
+        return pass(createHLToLLFuncPass);
+    }
+
+    pipeline_step_ptr hl_to_ll_cf() {
+        // Control flow is function local, therefore the conversion is nested
+        // on functions (already lowered by `hl_to_ll_func`) to allow the pass
+        // manager to run it in parallel.
+        return nested< ll::FuncOp >(createHLToLLCFPass)
+            .depends_on(hl_to_ll_func);
     }
 
     pipeline_step_ptr hl_to_ll_geps() {
@@ -31,11 +41,6 @@ namespace vast::conv::pipeline {
         return pass(createHLEmitLazyRegionsPass);
     }
 
-    pipeline_step_ptr hl_to_ll_func() {
-        // TODO add dependencies
-        return pass(createHLToLLFuncPass);
-    }
-
     pipeline_step_ptr to_ll() {
         return compose( "to-ll",
             hl_to_ll_func,
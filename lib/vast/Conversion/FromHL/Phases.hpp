@@ -0,0 +1,70 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Rewrite/FrozenRewritePatternSet.h>
+#include <mlir/Transforms/DialectConversion.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Conversion/Common/Types.hpp"
+#include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/PatternStats.hpp"
+
+//
+// Conversion phases of the hl to ll lowering. Every phase consists of the
+// conversion target and the frozen patterns of one of the staged passes, so
+// the staged passes and the fused `vast-hl-to-ll` pass share them.
+//
+namespace vast::conv::hltoll
+{
+    struct phase
+    {
+        conversion_target target;
+        mlir::FrozenRewritePatternSet patterns;
+
+        logical_result apply(operation op) const {
+            return mlir::applyPartialConversion(op, target, patterns);
+        }
+
+        logical_result apply(llvm::ArrayRef< operation > ops) const {
+            return mlir::applyPartialConversion(ops, target, patterns);
+        }
+    };
+
+    // Builds the phase from the static interface of `ModuleConversionPassMixin`.
+    template< typename pass_t >
+    phase make_phase(mcontext_t &mctx) {
+        typename pass_t::config_t config{
+            mlir::RewritePatternSet(&mctx), pass_t::create_conversion_target(mctx)
+        };
+        pass_t::populate_conversions(config);
+        count_pattern_applications(config.patterns, pass_t::getArgumentName());
+        return { std::move(config.target), mlir::FrozenRewritePatternSet(std::move(config.patterns)) };
+    }
+
+    phase func_phase(mcontext_t &mctx);
+
+    // Patterns keep a reference to the type converter.
+    phase vars_phase(mcontext_t &mctx, conv::tc::LLVMTypeConverter &tc);
+
+    phase cf_phase(mcontext_t &mctx);
+
+    // Removes blocks left unreachable in `ll.scope` by the control flow phase.
+    void erase_unreachable_scope_blocks(operation root);
+
+    // Merges blocks of function bodies into their only predecessor, if it
+    // ends with an unconditional branch to them.
+    void merge_trivial_block_chains(operation root);
+
+    phase lazy_regions_phase(mcontext_t &mctx);
+
+    // Patterns keep a reference to the layout cache.
+    phase geps_phase(mcontext_t &mctx, hl::record_layout_cache &layouts);
+
+} // namespace vast::conv::hltoll
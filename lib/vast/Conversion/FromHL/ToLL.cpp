@@ -0,0 +1,211 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Analysis/DataLayoutAnalysis.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <mlir/Transforms/DialectConversion.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+#include "Phases.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
+#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/DialectConversion.hpp"
+
+namespace vast::conv::hltoll
+{
+    namespace
+    {
+        bool is_scalar(mlir_type type) {
+            if (auto lvalue = mlir::dyn_cast< hl::LValueType >(type)) {
+                type = lvalue.getElementType();
+            }
+
+            return mlir::isa< mlir::IntegerType, mlir::FloatType, hl::PointerType, hl::VoidType >(type);
+        }
+
+        bool has_scalar_types(operation op) {
+            if (!llvm::all_of(op->getResultTypes(), is_scalar)) {
+                return false;
+            }
+
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    if (!llvm::all_of(block.getArgumentTypes(), is_scalar)) {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        // Operations of the function body that only the ll conversions lower:
+        // variables, statements with regions, jumps and member accesses. Only
+        // expressions are allowed to have regions.
+        bool needs_ll_conversion(operation op) {
+            if (op->getNumRegions() != 0) {
+                return !mlir::isa< hl::ExprOp >(op);
+            }
+
+            return mlir::isa<
+                hl::BreakOp, hl::ContinueOp, hl::GotoStmt, hl::IndirectGotoStmt, hl::RecordMemberOp
+            >(op);
+        }
+
+        // Functions that `vast-irs-to-llvm` lowers directly, without any of
+        // the ll phases.
+        bool is_simple_function(hl::FuncOp fn) {
+            if (fn.isDeclaration() || !fn.getBody().hasOneBlock()) {
+                return false;
+            }
+
+            auto fty = fn.getFunctionType();
+            if (!llvm::all_of(fty.getInputs(), is_scalar) || !llvm::all_of(fty.getResults(), is_scalar)) {
+                return false;
+            }
+
+            auto result = fn.getBody().walk([] (operation op) {
+                if (needs_ll_conversion(op) || !has_scalar_types(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            });
+
+            return !result.wasInterrupted();
+        }
+
+    } // namespace
+
+    //
+    // Fused equivalent of the `to-ll` pipeline step. Stateless phases are
+    // frozen once when the pass is initialized, phases that depend on module
+    // analyses once per module. Functions are then lowered one by one, each by
+    // all remaining phases in the order of the staged pipeline:
+    //
+    //   vast-hl-to-ll-func, vast-hl-to-ll-vars, vast-hl-to-ll-cf,
+    //   vast-hl-to-lazy-regions, vast-hl-to-ll-geps
+    //
+    // All phases except the function conversion are function local, hence the
+    // result is the same as the result of the staged passes.
+    //
+    // With `direct-simple-functions` enabled, simple functions are not touched
+    // at all and are left to be lowered directly by `vast-irs-to-llvm`.
+    //
+    struct HLToLL : HLToLLBase< HLToLL >
+    {
+        using base = HLToLLBase< HLToLL >;
+
+        std::shared_ptr< const phase > func;
+        std::shared_ptr< const phase > cf;
+        std::shared_ptr< const phase > lazy_regions;
+
+        logical_result initialize(mcontext_t *mctx) override {
+            func = std::make_shared< phase >(func_phase(*mctx));
+            cf   = std::make_shared< phase >(cf_phase(*mctx));
+            lazy_regions = std::make_shared< phase >(lazy_regions_phase(*mctx));
+            return mlir::success();
+        }
+
+        logical_result lower_function(operation fn, const phase &vars, const phase &geps) {
+            if (mlir::failed(vars.apply(fn)) || mlir::failed(cf->apply(fn))) {
+                return mlir::failure();
+            }
+
+            erase_unreachable_scope_blocks(fn);
+            merge_trivial_block_chains(fn);
+
+            if (mlir::failed(lazy_regions->apply(fn)) || mlir::failed(geps.apply(fn))) {
+                return mlir::failure();
+            }
+
+            return mlir::success();
+        }
+
+        // Initializers of globals can contain short-circuiting operations and
+        // member accesses as well.
+        logical_result lower_globals(vast_module mod, const phase &vars, const phase &geps) {
+            for (auto &op : mod.getOps()) {
+                if (mlir::isa< mlir::FunctionOpInterface >(op) || op.getNumRegions() == 0) {
+                    continue;
+                }
+
+                if (mlir::failed(vars.apply(&op))
+                    || mlir::failed(lazy_regions->apply(&op))
+                    || mlir::failed(geps.apply(&op))
+                ) {
+                    return mlir::failure();
+                }
+            }
+
+            return mlir::success();
+        }
+
+        logical_result convert_functions(vast_module mod) {
+            if (!direct_simple_functions) {
+                return func->apply(mod);
+            }
+
+            llvm::SmallVector< operation > ops;
+            for (auto &op : mod.getOps()) {
+                auto fn = mlir::dyn_cast< hl::FuncOp >(op);
+                if (!fn || !is_simple_function(fn)) {
+                    ops.push_back(&op);
+                }
+            }
+
+            return func->apply(ops);
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+            auto &mctx = getContext();
+
+            // Function conversion replaces module-level operations, therefore
+            // it is applied to the whole module before the function bodies.
+            if (mlir::failed(convert_functions(mod))) {
+                return signalPassFailure();
+            }
+
+            const auto &dl_analysis = getAnalysis< mlir::DataLayoutAnalysis >();
+
+            mlir::LowerToLLVMOptions llvm_options(&mctx);
+            llvm_options.useBarePtrCallConv = true;
+            conv::tc::LLVMTypeConverter type_converter(&mctx, llvm_options, &dl_analysis);
+
+            auto vars = vars_phase(mctx, type_converter);
+            auto geps = geps_phase(mctx, getAnalysis< hl::record_layout_cache >());
+
+            for (auto fn : util::defined_functions(mod)) {
+                // Simple functions that were kept in hl.
+                if (mlir::isa< hl::FuncOp >(fn)) {
+                    continue;
+                }
+
+                if (mlir::failed(lower_function(fn, vars, geps))) {
+                    return signalPassFailure();
+                }
+            }
+
+            if (mlir::failed(lower_globals(mod, vars, geps))) {
+                return signalPassFailure();
+            }
+
+            // Functions are replaced, records are kept.
+            markAnalysesPreserved< mlir::DataLayoutAnalysis, hl::record_layout_cache >();
+        }
+    };
+
+} // namespace vast::conv::hltoll
+
+std::unique_ptr< mlir::Pass > vast::createHLToLLPass()
+{
+    return std::make_unique< vast::conv::hltoll::HLToLL >();
+}
@@ -3,15 +3,19 @@
 #include "vast/Conversion/Passes.hpp"
 
 VAST_RELAX_WARNINGS
+#include <mlir/Analysis/DataLayoutAnalysis.h>
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Dialect/ControlFlow/IR/ControlFlowOps.h>
+#include <mlir/IR/FunctionInterfaces.h>
 
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Rewrite/FrozenRewritePatternSet.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 #include <mlir/Transforms/RegionUtils.h>
+
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Analysis/CallGraph.hpp"
 #include "vast/Conversion/Common/Passes.hpp"
 #include "vast/Conversion/Common/Patterns.hpp"
 
@@ -30,6 +34,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
 #include "../PassesDetails.hpp"
+#include "Phases.hpp"
 
 namespace vast::conv
 {
@@ -81,6 +86,13 @@ namespace vast::conv
             });
         }
 
+        // Hints of branches are kept by the operations they are lowered to.
+        void copy_attr( mlir::Operation *from, mlir::Operation *to, llvm::StringRef name )
+        {
+            if ( auto attr = from->getAttr( name ) )
+                to->setAttr( name, attr );
+        }
+
         template< typename Fn, typename H, typename ... Args >
         auto apply( Fn &&fn, mlir::Operation *op )
         {
@@ -126,6 +138,11 @@ namespace vast::conv
             mlir::Block *entry;
             mlir::Block *exit;
 
+            // `break` in `hl.switch` belongs to the switch, `continue` to the
+            // enclosing loop.
+            bool handle_break = true;
+            bool handle_continue = true;
+
             handle_terminators( bld_t &bld, mlir::Block *entry, mlir::Block *exit )
                 : bld( bld ), entry( entry ), exit( exit )
             {}
@@ -155,6 +172,19 @@ namespace vast::conv
                 if ( starts_cf_scope( op ) )
                     return mlir::success();
 
+                if ( mlir::isa< hl::SwitchOp >( op ) )
+                {
+                    if ( !handle_continue )
+                        return mlir::success();
+
+                    auto nested = *this;
+                    nested.handle_break = false;
+                    for ( auto &region : op->getRegions() )
+                        if ( mlir::failed( nested.run( region ) ) )
+                            return mlir::failure();
+                    return mlir::success();
+                }
+
                 for ( auto &region : op->getRegions() )
                     if ( mlir::failed( run( region ) ) )
                         return mlir::failure();
@@ -171,6 +201,8 @@ namespace vast::conv
             // TODO( conv:hltollcf ): Refactor using wrapper once we have it finalized.
             maybe_op_t do_replace( hl::ContinueOp op )
             {
+                if ( !handle_continue )
+                    return {};
                 auto g = mlir::OpBuilder::InsertionGuard( bld );
                 bld.setInsertionPointAfter( op );
                 if ( entry )
@@ -187,6 +219,8 @@ namespace vast::conv
 
             maybe_op_t do_replace( hl::BreakOp op )
             {
+                if ( !handle_break )
+                    return {};
                 auto g = mlir::OpBuilder::InsertionGuard( bld );
                 bld.setInsertionPointAfter( op );
                 if ( exit )
@@ -274,9 +308,10 @@ namespace vast::conv
                 auto true_block = inline_region_before( rewriter,
                                                         op.getThenRegion(), tail_block );
 
-                bld.make_at_end< ll::CondBr >( cond_block,
-                                               op.getLoc(), cond_value,
-                                               true_block, false_block );
+                auto br = bld.make_at_end< ll::CondBr >( cond_block,
+                                                         op.getLoc(), cond_value,
+                                                         true_block, false_block );
+                copy_attr( op, br, hl::HighLevelDialect::getBranchWeightsAttrName() );
                 rewriter.eraseOp( cond_yield_op );
 
 
@@ -351,14 +386,28 @@ namespace vast::conv
                 auto [ cond_yield, value ] = fetch_cond_yield( bld, *cond_block );
                 VAST_CHECK( value, "Condition region yield unexpected type" );
 
-                bld.make_at_end< ll::CondScopeRet >( cond_block,
-                                                     op.getLoc(), *value, body_block );
+                auto ret = bld.make_at_end< ll::CondScopeRet >( cond_block,
+                                                                op.getLoc(), *value, body_block );
+                copy_attr( op, ret, hl::HighLevelDialect::getBranchWeightsAttrName() );
                 rewriter.eraseOp( cond_yield );
 
                 VAST_PATTERN_CHECK(parent_t::tie( bld, op.getLoc(),
                                                    *scope_entry, *cond_block ),
                                    tie_fail);
 
+                // `continue` of the loop recurses into its scope.
+                auto hints = hl::HighLevelDialect::getLoopHintsAttrName();
+                if ( op->hasAttr( hints ) )
+                {
+                    scope.walk( [ & ]( ll::ScopeRecurse recurse ) {
+                        auto parent = recurse->getParentOp();
+                        while ( parent && !mlir::isa< ll::Scope, hl::WhileOp, hl::ForOp >( parent ) )
+                            parent = parent->getParentOp();
+                        if ( parent == scope )
+                            copy_attr( op, recurse, hints );
+                    });
+                }
+
                 rewriter.eraseOp( op );
                 return mlir::success();
             }
@@ -405,8 +454,9 @@ namespace vast::conv
                 auto [ cond_yield, value ] = fetch_cond_yield( bld, *cond_block );
                 VAST_PATTERN_CHECK( value, "Condition region yield unexpected type" );
 
-                bld.make_at_end< ll::CondScopeRet >( cond_block,
-                                                     op.getLoc(), *value, body_block );
+                auto ret = bld.make_at_end< ll::CondScopeRet >( cond_block,
+                                                                op.getLoc(), *value, body_block );
+                copy_attr( op, ret, hl::HighLevelDialect::getBranchWeightsAttrName() );
                 rewriter.eraseOp( cond_yield );
 
                 auto mk_tie = [ & ]( auto &from, auto &to )
@@ -418,6 +468,10 @@ namespace vast::conv
                 VAST_PATTERN_CHECK( mk_tie( *body_block, *inc_block ), tie_fail );
                 VAST_PATTERN_CHECK( mk_tie( *inc_block, *cond_block ), tie_fail );
 
+                // The latch of the loop.
+                if ( auto latch = mlir::dyn_cast< ll::Br >( inc_block->back() ) )
+                    copy_attr( op, latch, hl::HighLevelDialect::getLoopHintsAttrName() );
+
                 rewriter.eraseOp( op );
 
                 return mlir::success();
@@ -429,6 +483,236 @@ namespace vast::conv
             }
         };
 
+        // Lowers `hl.switch` with constant case values to `ll.switch`. Labels
+        // split the flattened cases into blocks that fall through to the next
+        // one, `break` jumps to the block after the switch.
+        struct switch_op : base_pattern< hl::SwitchOp >
+        {
+            using parent_t = base_pattern< hl::SwitchOp >;
+            using parent_t::parent_t;
+
+            using case_values_t = llvm::SmallVector< llvm::APInt >;
+
+            static auto yielded_value( mlir::Region &region ) -> mlir_value
+            {
+                if ( !region.hasOneBlock() )
+                    return {};
+                auto yield = terminator_t< hl::ValueYieldOp >::get( region.front() );
+                if ( !yield )
+                    return {};
+                return yield.op().getResult();
+            }
+
+            static std::optional< llvm::APInt > case_value( hl::CaseOp op, unsigned width )
+            {
+                // Only the lower bound of a case range is kept.
+                if ( op->hasAttr( hl::HighLevelDialect::getCaseRangeAttrName() ) )
+                    return std::nullopt;
+
+                auto value = yielded_value( op.getLhs() );
+                if ( !value )
+                    return std::nullopt;
+
+                auto cst = value.getDefiningOp< hl::ConstantOp >();
+                if ( !cst )
+                    return std::nullopt;
+
+                auto attr = mlir::dyn_cast< core::IntegerAttr >( cst.getValue() );
+                if ( !attr )
+                    return std::nullopt;
+
+                return attr.getValue().extOrTrunc( width );
+            }
+
+            static bool is_label( mlir::Operation *op )
+            {
+                return mlir::isa< hl::CaseOp, hl::DefaultOp >( op );
+            }
+
+            // Collects case values of labels in the block and in bodies of
+            // the labels themselves, as these are flattened by the lowering.
+            static bool collect_case_values( mlir::Block &block, unsigned width,
+                                             case_values_t &values )
+            {
+                for ( auto &op : block )
+                {
+                    // Declarations next to labels (e.g., before the first one)
+                    // are visible in the following cases, which their blocks
+                    // would not dominate once the switch is split.
+                    if ( mlir::isa< hl::VarDeclOp >( op ) )
+                        return false;
+
+                    if ( !is_label( &op ) )
+                        continue;
+
+                    if ( auto label = mlir::dyn_cast< hl::CaseOp >( op ) )
+                    {
+                        auto value = case_value( label, width );
+                        if ( !value )
+                            return false;
+                        values.push_back( *value );
+                    }
+
+                    auto &body = op.getRegion( op.getNumRegions() - 1 );
+                    if ( !body.empty() && !collect_case_values( body.front(), width, values ) )
+                        return false;
+                }
+
+                return true;
+            }
+
+            // Case values of the switch. Yields nothing if any of them is not
+            // a constant or a case range, if some label is nested in another
+            // statement (e.g., Duff's device), as such labels cannot be
+            // flattened, or if a variable is declared next to the labels.
+            static std::optional< case_values_t > case_values( hl::SwitchOp op )
+            {
+                auto cond = yielded_value( op.getCondRegion() );
+                if ( !cond || !mlir::isa< mlir::IntegerType >( cond.getType() ) )
+                    return std::nullopt;
+
+                if ( op.getCases().size() != 1 || !op.getCases().front().hasOneBlock() )
+                    return std::nullopt;
+
+                auto &cases = op.getCases().front();
+
+                std::size_t labels = 0;
+                cases.walk( [&] ( mlir::Operation *nested ) {
+                    // Labels of nested switches belong to them.
+                    if ( mlir::isa< hl::SwitchOp >( nested ) )
+                        return mlir::WalkResult::skip();
+                    if ( mlir::isa< hl::CaseOp >( nested ) )
+                        ++labels;
+                    return mlir::WalkResult::advance();
+                } );
+
+                case_values_t values;
+                auto width = cond.getType().getIntOrFloatBitWidth();
+                if ( !collect_case_values( cases.front(), width, values ) || values.size() != labels )
+                    return std::nullopt;
+
+                return values;
+            }
+
+            // Inlines bodies of the labels right after them, so that every
+            // label of the switch ends up in `block`. Labels are returned in
+            // the order of their cases.
+            static auto flatten_labels( mlir::Block &block, conversion_rewriter &rewriter )
+                -> llvm::SmallVector< mlir::Operation * >
+            {
+                llvm::SmallVector< mlir::Operation * > labels;
+                for ( auto it = block.begin(); it != block.end(); ++it )
+                {
+                    if ( !is_label( &*it ) )
+                        continue;
+
+                    labels.push_back( &*it );
+                    auto &body = it->getRegion( it->getNumRegions() - 1 );
+                    if ( !body.empty() )
+                        rewriter.inlineBlockBefore( &body.front(), &block, std::next( it ) );
+                }
+
+                return labels;
+            }
+
+            mlir::LogicalResult matchAndRewrite(
+                hl::SwitchOp op,
+                hl::SwitchOp::Adaptor ops,
+                conversion_rewriter &rewriter) const override
+            {
+                VAST_PATTERN_CHECK( case_values( op ), "Switch with non-constant case values." );
+
+                auto bld = rewriter_wrapper_t( rewriter );
+
+                auto [ original_block, tail_block ] = split_at_op( op, rewriter );
+                VAST_CHECK( original_block && tail_block,
+                            "Failed extraction of switch into block." );
+
+                auto handler = handle_terminators( rewriter, nullptr, tail_block );
+                handler.handle_continue = false;
+                if ( mlir::failed( handler.run( op.getCases().front() ) ) )
+                    return mlir::failure();
+
+                auto cond_block = inline_region_before( rewriter,
+                                                        op.getCondRegion(), tail_block );
+                auto cond_yield = terminator_t< hl::ValueYieldOp >::get( *cond_block ).op();
+                auto cond_value = cond_yield.getResult();
+                auto width = cond_value.getType().getIntOrFloatBitWidth();
+
+                // Statements that precede the first label are never executed.
+                auto current = inline_region_before( rewriter,
+                                                     op.getCases().front(), tail_block );
+
+                // The skeleton of the switch is built first: all labels are
+                // flattened into one block, which is then split at them from
+                // the back. Every split moves only the statements of its own
+                // case, hence generated state machines with thousands of cases
+                // are lowered in time linear in their size.
+                auto labels = flatten_labels( *current, rewriter );
+
+                llvm::SmallVector< mlir::Block * > blocks( labels.size() );
+                for ( auto idx = labels.size(); idx-- > 0; )
+                    blocks[ idx ] = rewriter.splitBlock( current,
+                                                         mlir::Block::iterator( labels[ idx ] ) );
+
+                llvm::SmallVector< mlir::Attribute > case_attrs;
+                llvm::SmallVector< mlir::Block * > case_dests;
+                mlir::Block *default_dest = tail_block;
+
+                auto case_type = rewriter.getIntegerType( width );
+
+                for ( auto [ label, block ] : llvm::zip( labels, blocks ) )
+                {
+                    // The label stays first in its block until it is erased, so the
+                    // last operation of the previous block is its real terminator.
+                    VAST_PATTERN_CHECK( parent_t::tie( bld, op.getLoc(), *current, *block ),
+                                        tie_fail );
+
+                    if ( auto case_op = mlir::dyn_cast< hl::CaseOp >( label ) )
+                    {
+                        auto value = case_value( case_op, width );
+                        VAST_CHECK( value, "Non-constant case value." );
+                        case_attrs.push_back( rewriter.getIntegerAttr( case_type, *value ) );
+                        case_dests.push_back( block );
+                    }
+                    else
+                    {
+                        default_dest = block;
+                    }
+
+                    rewriter.eraseOp( label );
+                    current = block;
+                }
+
+                VAST_PATTERN_CHECK( parent_t::tie( bld, op.getLoc(), *current, *tail_block ),
+                                    tie_fail );
+
+                bld.make_at_end< ll::Switch >( cond_block, op.getLoc(), cond_value,
+                                               rewriter.getArrayAttr( case_attrs ),
+                                               default_dest, case_dests );
+                rewriter.eraseOp( cond_yield );
+
+                rewriter.mergeBlocks( cond_block, original_block, std::nullopt );
+
+                if ( !any_terminator_t::has( *tail_block ) )
+                {
+                    bld.guarded_at_end( tail_block, [&](){
+                        bld->template create< ll::ScopeRet >( op.getLoc() );
+                    });
+                }
+                rewriter.eraseOp( op );
+
+                return mlir::success();
+            }
+
+            static void legalize( conversion_target &trg )
+            {
+                trg.addDynamicallyLegalOp< hl::SwitchOp >( [] ( hl::SwitchOp op ) {
+                    return !case_values( op ).has_value();
+                } );
+            }
+        };
+
         template< typename op_t, typename trg_t >
         struct replace : base_pattern< op_t >
         {
@@ -457,6 +741,7 @@ namespace vast::conv
               if_op
             , while_op
             , for_op
+            , switch_op
             , replace< hl::ReturnOp, ll::ReturnOp >
             , replace< core::ImplicitReturnOp, ll::ReturnOp >
         >;
@@ -492,13 +777,8 @@ namespace vast::conv
 
         void after_operation() override
         {
-            auto clean_scopes = [&](ll::Scope scope)
-            {
-                mlir::IRRewriter rewriter{ &this->getContext() };
-                // We really don't care if anything ws remove or not.
-                std::ignore = mlir::eraseUnreachableBlocks(rewriter, scope.getBody());
-            };
-            this->getOperation().walk(clean_scopes);
+            hltoll::erase_unreachable_scope_blocks(this->getOperation());
+            hltoll::merge_trivial_block_chains(this->getOperation());
 
             auto clean_functions = [&](hl::FuncOp fn)
             {
@@ -506,10 +786,67 @@ namespace vast::conv
                 // We really don't care if anything ws remove or not.
                 std::ignore = mlir::eraseUnreachableBlocks(rewriter, fn.getBody());
             };
-            this->getOperation().walk(clean_functions);
+            this->getOperation()->walk(clean_functions);
+
+            // Only function bodies are rewritten.
+            markAnalysesPreserved<
+                mlir::DataLayoutAnalysis, hl::record_layout_cache, analysis::call_graph
+            >();
         }
     };
 
+    hltoll::phase hltoll::cf_phase(mcontext_t &mctx)
+    {
+        return make_phase< HLToLLCF >(mctx);
+    }
+
+    void hltoll::erase_unreachable_scope_blocks(operation root)
+    {
+        auto clean_scopes = [&](ll::Scope scope)
+        {
+            mlir::IRRewriter rewriter{ root->getContext() };
+            // We really don't care if anything ws remove or not.
+            std::ignore = mlir::eraseUnreachableBlocks(rewriter, scope.getBody());
+        };
+        root->walk(clean_scopes);
+    }
+
+    void hltoll::merge_trivial_block_chains(operation root)
+    {
+        auto merge = [] (mlir::Block &block) {
+            auto br = block.empty() ? ll::Br() : mlir::dyn_cast< ll::Br >(block.back());
+            if (!br) {
+                return false;
+            }
+
+            auto succ = br.getDest();
+            if (succ == &block || succ->getSinglePredecessor() != &block) {
+                return false;
+            }
+
+            for (auto [arg, operand] : llvm::zip(succ->getArguments(), br.getOperands())) {
+                arg.replaceAllUsesWith(operand);
+            }
+
+            br.erase();
+            block.getOperations().splice(block.end(), succ->getOperations());
+            succ->erase();
+            return true;
+        };
+
+        // Only function bodies are merged, the first and the second block of
+        // `ll.scope` have a special meaning.
+        root->walk([&] (mlir::FunctionOpInterface fn) {
+            if (fn.isExternal()) {
+                return;
+            }
+
+            for (auto &block : fn.getFunctionBody()) {
+                while (merge(block)) {}
+            }
+        });
+    }
+
 } // namespace vast::conv
 
 std::unique_ptr< mlir::Pass > vast::createHLToLLCFPass()
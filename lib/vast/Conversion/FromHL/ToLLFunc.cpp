@@ -2,6 +2,7 @@
 #include "vast/Dialect/HighLevel/Passes.hpp"
 
 #include "PassesDetails.hpp"
+#include "Phases.hpp"
 
 #include "vast/Conversion/Common/Passes.hpp"
 #include "vast/Conversion/Common/Patterns.hpp"
@@ -65,9 +66,19 @@ namespace vast::conv::hltollfunc
                 util::type_list< pattern::func_op>
             >(config);
         }
+
+        // Functions are replaced, records are kept.
+        void after_operation() override {
+            markAnalysesPreserved< mlir::DataLayoutAnalysis, hl::record_layout_cache >();
+        }
     };
 } // namespace vast::conv::hltollfunc
 
+vast::conv::hltoll::phase vast::conv::hltoll::func_phase(mcontext_t &mctx)
+{
+    return make_phase< hltollfunc::HLToLLFunc >(mctx);
+}
+
 
 std::unique_ptr< mlir::Pass > vast::createHLToLLFuncPass()
 {
@@ -10,11 +10,14 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include "PassesDetails.hpp"
+#include "Phases.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
+#include "vast/Analysis/CallGraph.hpp"
+
 #include "vast/Util/Symbols.hpp"
 #include "vast/Util/DialectConversion.hpp"
 
@@ -22,27 +25,21 @@ namespace vast
 {
     namespace pattern
     {
-        template< typename T >
-        struct DoConversion {};
-
-        template<>
-        struct DoConversion< hl::RecordMemberOp > : util::State< hl::RecordMemberOp >
+        struct record_member_op : mlir::OpConversionPattern< hl::RecordMemberOp >
         {
-            using util::State< hl::RecordMemberOp >::State;
+            using op_t = hl::RecordMemberOp;
+            using base = mlir::OpConversionPattern< op_t >;
 
-            mlir::LogicalResult convert()
-            {
-                auto parent_type = operands.getRecord().getType();
+            record_member_op(mcontext_t *mctx, hl::record_layout_cache &layouts)
+                : base(mctx), layouts(layouts)
+            {}
 
-                auto module_op = op->getParentOfType< vast_module >();
-                if (!module_op)
-                    return mlir::failure();
-
-                auto struct_decl = hl::definition_of(parent_type, module_op);
-                if (!struct_decl)
-                    return mlir::failure();
+            logical_result matchAndRewrite(
+                op_t op, typename op_t::Adaptor operands, conversion_rewriter &rewriter
+            ) const override {
+                auto parent_type = operands.getRecord().getType();
 
-                auto idx = hl::field_idx(op.getName(), *struct_decl);
+                auto idx = layouts.field_idx(parent_type, op.getName());
                 if (!idx)
                     return mlir::failure();
 
@@ -57,12 +54,25 @@ namespace vast
                 return mlir::success();
             }
 
+            hl::record_layout_cache &layouts;
         };
 
-        using record_member_op = util::BasePattern< hl::RecordMemberOp, DoConversion >;
-
     } // namespace pattern
 
+    conv::hltoll::phase conv::hltoll::geps_phase(
+        mcontext_t &mctx, hl::record_layout_cache &layouts
+    ) {
+        mlir::ConversionTarget trg(mctx);
+        trg.markUnknownOpDynamicallyLegal( [](auto) { return true; } );
+        trg.addIllegalOp< hl::RecordMemberOp >();
+
+        mlir::RewritePatternSet patterns(&mctx);
+        patterns.add< pattern::record_member_op >(&mctx, layouts);
+        count_pattern_applications(patterns, "vast-hl-to-ll-geps");
+
+        return { std::move(trg), mlir::FrozenRewritePatternSet(std::move(patterns)) };
+    }
+
     struct HLToLLGEPsPass : HLToLLGEPsBase< HLToLLGEPsPass >
     {
         void runOnOperation() override
@@ -70,16 +80,16 @@ namespace vast
             auto op = this->getOperation();
             auto &mctx = this->getContext();
 
-            mlir::ConversionTarget trg(mctx);
-            trg.markUnknownOpDynamicallyLegal( [](auto) { return true; } );
-            trg.addIllegalOp< hl::RecordMemberOp >();
+            auto &layouts = this->getAnalysis< hl::record_layout_cache >();
 
-            mlir::RewritePatternSet patterns(&mctx);
-
-            patterns.add< pattern::record_member_op >(&mctx);
-
-            if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns))))
+            if (mlir::failed(conv::hltoll::geps_phase(mctx, layouts).apply(op)))
                 return signalPassFailure();
+
+            // Only member accesses are rewritten, symbols and their users stay.
+            markAnalysesPreserved<
+                mlir::DataLayoutAnalysis, hl::record_layout_cache,
+                analysis::call_graph, util::symbol_index
+            >();
         }
     };
 } // namespace vast
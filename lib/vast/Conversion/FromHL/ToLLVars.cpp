@@ -12,10 +12,14 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include "PassesDetails.hpp"
+#include "Phases.hpp"
 
+#include "vast/Dialect/Core/CoreOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
+#include "vast/Analysis/CallGraph.hpp"
+
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DialectConversion.hpp"
 #include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
@@ -59,6 +63,55 @@ namespace vast
             using Base = BasePattern< op_t >;
             using Base::Base;
 
+            // Labels and cases in the scope can be jumped to past the
+            // declaration, which would skip the start of its lifetime.
+            static bool may_bypass_declarations(core::ScopeOp scope)
+            {
+                auto result = scope.walk([] (operation op) {
+                    if (mlir::isa< hl::LabelStmt, hl::CaseOp, hl::DefaultOp >(op))
+                        return mlir::WalkResult::interrupt();
+                    return mlir::WalkResult::advance();
+                });
+                return result.wasInterrupted();
+            }
+
+            // Variables of compound statements live until the end of their
+            // scope, variables of the function body until the return.
+            static core::ScopeOp lifetime_scope(op_t op)
+            {
+                auto scope = mlir::dyn_cast< core::ScopeOp >(op->getParentOp());
+                if (!scope || !scope.getBody().hasOneBlock())
+                    return {};
+
+                if (!op.hasLocalStorage() || !op.getAllocationSize().empty())
+                    return {};
+
+                if (may_bypass_declarations(scope))
+                    return {};
+                return scope;
+            }
+
+            static void mark_lifetime(
+                core::ScopeOp scope, ll::UninitializedVar var, conversion_rewriter &rewriter
+            ) {
+                mlir::OpBuilder::InsertionGuard guard(rewriter);
+
+                rewriter.setInsertionPointAfter(var);
+                rewriter.create< ll::LifetimeStart >(var.getLoc(), var);
+
+                // A jump at the end of the scope leaves it as well.
+                auto &block = scope.getBody().front();
+                if (!block.empty() && mlir::isa<
+                        hl::ReturnOp, hl::BreakOp, hl::ContinueOp, hl::GotoStmt, hl::IndirectGotoStmt
+                    >(block.back())
+                ) {
+                    rewriter.setInsertionPoint(&block.back());
+                } else {
+                    rewriter.setInsertionPointToEnd(&block);
+                }
+                rewriter.create< ll::LifetimeEnd >(var.getLoc(), var);
+            }
+
             mlir::LogicalResult matchAndRewrite(
                 op_t op, typename op_t::Adaptor ops,
                 conversion_rewriter &rewriter) const override
@@ -68,6 +121,9 @@ namespace vast
                 auto uninit_var = rewriter.create< ll::UninitializedVar >(op.getLoc(),
                                                                           trg_type);
 
+                if (auto scope = lifetime_scope(op))
+                    mark_lifetime(scope, uninit_var, rewriter);
+
                 if (op.getInitializer().empty())
                 {
                     rewriter.replaceOp(op, uninit_var);
@@ -108,6 +164,26 @@ namespace vast
 
     } // namespace pattern
 
+    conv::hltoll::phase conv::hltoll::vars_phase(
+        mcontext_t &mctx, conv::tc::LLVMTypeConverter &type_converter
+    ) {
+        mlir::ConversionTarget trg(mctx);
+        trg.markUnknownOpDynamicallyLegal( [](auto) { return true; } );
+        trg.addDynamicallyLegalOp< hl::VarDeclOp >([](hl::VarDeclOp op)
+        {
+            // TODO(conv): `!ast_node->isLocalVarDeclOrParam()` should maybe be ported
+            //             to the mlir op?
+            return mlir::isa< vast_module >(op->getParentOp());
+        });
+
+        mlir::RewritePatternSet patterns(&mctx);
+
+        patterns.add< pattern::vardecl_op >(type_converter);
+        count_pattern_applications(patterns, "vast-hl-to-ll-vars");
+
+        return { std::move(trg), mlir::FrozenRewritePatternSet(std::move(patterns)) };
+    }
+
     struct HLToLLVarsPass : HLToLLVarsBase< HLToLLVarsPass >
     {
         void runOnOperation() override
@@ -115,27 +191,19 @@ namespace vast
             auto op = this->getOperation();
             auto &mctx = this->getContext();
 
-            mlir::ConversionTarget trg(mctx);
-            trg.markUnknownOpDynamicallyLegal( [](auto) { return true; } );
-            trg.addDynamicallyLegalOp< hl::VarDeclOp >([&](hl::VarDeclOp op)
-            {
-                // TODO(conv): `!ast_node->isLocalVarDeclOrParam()` should maybe be ported
-                //             to the mlir op?
-                return mlir::isa< vast_module >(op->getParentOp());
-            });
-
             const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
 
             mlir::LowerToLLVMOptions llvm_options(&mctx);
             llvm_options.useBarePtrCallConv = true;
             conv::tc::LLVMTypeConverter type_converter(&mctx, llvm_options, &dl_analysis);
 
-            mlir::RewritePatternSet patterns(&mctx);
-
-            patterns.add< pattern::vardecl_op >(type_converter);
-
-            if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns))))
+            if (mlir::failed(conv::hltoll::vars_phase(mctx, type_converter).apply(op)))
                 return signalPassFailure();
+
+            // Variables are lowered in place, records and functions are kept.
+            markAnalysesPreserved<
+                mlir::DataLayoutAnalysis, hl::record_layout_cache, analysis::call_graph
+            >();
         }
     };
 } // namespace vast
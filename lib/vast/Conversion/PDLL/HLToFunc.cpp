@@ -1,5 +1,14 @@
 // Copyright (c) 2022-present, Trail of Bits, Inc.
 
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/PDL/IR/PDL.h>
+#include <mlir/IR/DialectInterface.h>
+#include <mlir/Rewrite/FrozenRewritePatternSet.h>
+#include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+VAST_UNRELAX_WARNINGS
+
 #include "vast/Conversion/Passes.hpp"
 #include "vast/Util/Common.hpp"
 
@@ -7,29 +16,78 @@
 
 #include "vast/Conversion/HLToFunc.hpp"
 
+#include <mutex>
+
 namespace vast::pdll
 {
 
     using RewritePatternSet = mlir::RewritePatternSet;
     using FrozenRewritePatternSet = mlir::FrozenRewritePatternSet;
 
+    //
+    // Patterns of the pass frozen once per context, i.e., their PDL is
+    // compiled to bytecode only by the first pass instance of the context,
+    // its clones and the pipelines of later translation units that share the
+    // context reuse it. The cache is an interface of the PDL dialect, so it
+    // lives exactly as long as the context.
+    //
+    struct hl_to_func_patterns : mlir::DialectInterface::Base< hl_to_func_patterns >
+    {
+        MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(hl_to_func_patterns)
+
+        explicit hl_to_func_patterns(mlir::Dialect *dialect) : Base(dialect) {}
+
+        const FrozenRewritePatternSet &get(mcontext_t *ctx) const {
+            std::call_once(compiled, [&] {
+                RewritePatternSet pattern_list(ctx);
+                populateGeneratedPDLLPatterns(pattern_list);
+                patterns = std::move(pattern_list);
+            });
+            return patterns;
+        }
+
+        mutable std::once_flag compiled;
+        mutable FrozenRewritePatternSet patterns;
+    };
+
     struct HLToFuncPass : HLToFuncBase< HLToFuncPass >
     {
         using HLToFuncBase::HLToFuncBase;
 
+        void getDependentDialects(mlir::DialectRegistry &registry) const override {
+            HLToFuncBase::getDependentDialects(registry);
+            // Every pipeline with the pass appends the extension again.
+            registry.addExtension(+[] (mcontext_t *, mlir::pdl::PDLDialect *dialect) {
+                if (!dialect->getRegisteredInterface< hl_to_func_patterns >()) {
+                    dialect->addInterfaces< hl_to_func_patterns >();
+                }
+            });
+        }
+
         LogicalResult initialize(mcontext_t *ctx) override {
-            // Build the pattern set within the `initialize` to avoid recompiling PDL
-            // patterns during each `runOnOperation` invocation.
-            RewritePatternSet pattern_list(ctx);
-            populateGeneratedPDLLPatterns(pattern_list);
-            patterns = std::move(pattern_list);
+            auto pdl = ctx->getLoadedDialect< mlir::pdl::PDLDialect >();
+            auto cache = pdl ? pdl->getRegisteredInterface< hl_to_func_patterns >() : nullptr;
+            if (!cache) {
+                return mlir::failure();
+            }
+
+            // Frozen sets share their compiled patterns when copied.
+            patterns = cache->get(ctx);
             return mlir::success();
         }
 
         void runOnOperation() override {
-            if (failed(mlir::applyPatternsAndFoldGreedily(getOperation(), patterns))) {
-                return signalPassFailure();
-            }
+            // Every operation is converted once by the pattern that matches it,
+            // therefore one top-down sweep suffices. Conversions keep regions
+            // as they are, so the driver does not simplify them.
+            mlir::GreedyRewriteConfig config;
+            config.useTopDownTraversal = true;
+            config.enableRegionSimplification = false;
+            config.maxIterations = 1;
+
+            // A single iteration that rewrote anything is reported as not
+            // converged, which is expected here.
+            std::ignore = mlir::applyPatternsAndFoldGreedily(getOperation(), patterns, config);
         }
 
         FrozenRewritePatternSet patterns;
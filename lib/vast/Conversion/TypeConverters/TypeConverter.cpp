@@ -2,6 +2,17 @@
 
 #include "vast/Conversion/TypeConverters/TypeConverter.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/Statistic.h>
+VAST_UNRELAX_WARNINGS
+
+#include <mutex>
+
+#define DEBUG_TYPE "vast-type-conversion"
+
+STATISTIC(num_conversion_cache_hits, "Number of type conversions reused from the cache");
+STATISTIC(num_conversion_cache_misses, "Number of type conversions computed by converters");
+
 namespace vast::conv::tc
 {
     bool base_type_converter::isSignatureLegal(core::FunctionType ty)
@@ -9,4 +20,28 @@ namespace vast::conv::tc
         return base::isLegal(llvm::concat<const mlir_type>(ty.getInputs(), ty.getResults()));
     }
 
+    maybe_types_t conversion_cache::lookup(mlir_type type) const
+    {
+        std::shared_lock lock(mutex);
+        if (auto it = entries.find(type); it != entries.end()) {
+            ++num_conversion_cache_hits;
+            return it->second;
+        }
+
+        ++num_conversion_cache_misses;
+        return std::nullopt;
+    }
+
+    void conversion_cache::insert(mlir_type type, const types_t &converted)
+    {
+        std::unique_lock lock(mutex);
+        entries.try_emplace(type, converted);
+    }
+
+    void conversion_cache::invalidate()
+    {
+        std::unique_lock lock(mutex);
+        entries.clear();
+    }
+
 } // namespace vast::tc
@@ -0,0 +1,208 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeImplementation.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreDialect.hpp"
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreTypes.hpp"
+
+#include "vast/Util/Common.hpp"
+
+//
+// Compact bytecode encoding of core types, literal attributes and data layout
+// values. Every encoded entry starts with its code followed by its parameters.
+//
+// Codes are part of the bytecode format, new entries may only be appended.
+//
+namespace vast::core
+{
+    namespace
+    {
+        enum class type_code : std::uint64_t
+        {
+            function_type = 0,
+        };
+
+        enum class attr_code : std::uint64_t
+        {
+            boolean_attr          = 0,
+            signed_integer_attr   = 1,
+            unsigned_integer_attr = 2,
+            void_attr             = 3,
+            data_layout_attr      = 4,
+        };
+
+    } // namespace
+
+    struct CoreBytecodeDialectInterface : mlir::BytecodeDialectInterface
+    {
+        using BytecodeDialectInterface::BytecodeDialectInterface;
+
+        using reader_t = mlir::DialectBytecodeReader;
+        using writer_t = mlir::DialectBytecodeWriter;
+
+        static void write_types(mlir::ArrayRef< mlir_type > types, writer_t &writer) {
+            writer.writeVarInt(types.size());
+            for (auto type : types) {
+                writer.writeType(type);
+            }
+        }
+
+        static logical_result read_types(reader_t &reader, llvm::SmallVectorImpl< mlir_type > &types) {
+            std::uint64_t size;
+            if (mlir::failed(reader.readVarInt(size))) {
+                return mlir::failure();
+            }
+
+            types.resize(size);
+            for (auto &type : types) {
+                if (mlir::failed(reader.readType(type))) {
+                    return mlir::failure();
+                }
+            }
+
+            return mlir::success();
+        }
+
+        //
+        // types
+        //
+
+        logical_result writeType(mlir_type type, writer_t &writer) const final {
+            if (auto fty = type.dyn_cast< FunctionType >()) {
+                writer.writeVarInt(std::uint64_t(type_code::function_type));
+                write_types(fty.getInputs(), writer);
+                write_types(fty.getResults(), writer);
+                writer.writeVarInt(fty.isVarArg());
+                return mlir::success();
+            }
+
+            return mlir::failure();
+        }
+
+        mlir_type readType(reader_t &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            if (type_code(code) == type_code::function_type) {
+                llvm::SmallVector< mlir_type > inputs, results;
+                std::uint64_t vararg;
+                if (mlir::failed(read_types(reader, inputs))
+                    || mlir::failed(read_types(reader, results))
+                    || mlir::failed(reader.readVarInt(vararg))
+                ) {
+                    return {};
+                }
+
+                return FunctionType::get(getContext(), inputs, results, vararg);
+            }
+
+            reader.emitError() << "unknown core type code: " << code;
+            return {};
+        }
+
+        //
+        // attributes
+        //
+
+        logical_result writeAttribute(mlir_attr attr, writer_t &writer) const final {
+            return llvm::TypeSwitch< mlir_attr, logical_result >(attr)
+                .Case([&] (BooleanAttr a) {
+                    writer.writeVarInt(std::uint64_t(attr_code::boolean_attr));
+                    writer.writeType(a.getType());
+                    writer.writeVarInt(a.getValue());
+                    return mlir::success();
+                })
+                .Case([&] (IntegerAttr a) {
+                    const auto &value = a.getValue();
+                    auto code = value.isSigned()
+                        ? attr_code::signed_integer_attr
+                        : attr_code::unsigned_integer_attr;
+                    writer.writeVarInt(std::uint64_t(code));
+                    writer.writeType(a.getType());
+                    writer.writeVarInt(value.getBitWidth());
+                    writer.writeAPIntWithKnownWidth(value);
+                    return mlir::success();
+                })
+                .Case([&] (VoidAttr a) {
+                    writer.writeVarInt(std::uint64_t(attr_code::void_attr));
+                    writer.writeType(a.getType());
+                    return mlir::success();
+                })
+                .Case([&] (DataLayoutValueAttr a) {
+                    writer.writeVarInt(std::uint64_t(attr_code::data_layout_attr));
+                    writer.writeVarInt(a.getBw());
+                    writer.writeVarInt(a.getAbiAlign());
+                    return mlir::success();
+                })
+                .Default([] (auto) { return mlir::failure(); });
+        }
+
+        mlir_attr read_integer(reader_t &reader, bool is_signed) const {
+            mlir_type type;
+            std::uint64_t bitwidth;
+            if (mlir::failed(reader.readType(type)) || mlir::failed(reader.readVarInt(bitwidth))) {
+                return {};
+            }
+
+            auto value = reader.readAPIntWithKnownWidth(static_cast< unsigned >(bitwidth));
+            if (mlir::failed(value)) {
+                return {};
+            }
+
+            return IntegerAttr::get(type, llvm::APSInt(*value, !is_signed));
+        }
+
+        mlir_attr readAttribute(reader_t &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            mlir_type type;
+            switch (attr_code(code)) {
+                case attr_code::boolean_attr: {
+                    std::uint64_t value;
+                    if (mlir::failed(reader.readType(type)) || mlir::failed(reader.readVarInt(value))) {
+                        return {};
+                    }
+                    return BooleanAttr::get(type, value);
+                }
+                case attr_code::signed_integer_attr:
+                    return read_integer(reader, true /* signed */);
+                case attr_code::unsigned_integer_attr:
+                    return read_integer(reader, false /* signed */);
+                case attr_code::void_attr: {
+                    if (mlir::failed(reader.readType(type))) {
+                        return {};
+                    }
+                    return VoidAttr::get(getContext(), type);
+                }
+                case attr_code::data_layout_attr: {
+                    std::uint64_t bw, abi_align;
+                    if (mlir::failed(reader.readVarInt(bw)) || mlir::failed(reader.readVarInt(abi_align))) {
+                        return {};
+                    }
+                    return DataLayoutValueAttr::get(
+                        getContext(), unsigned(bw), unsigned(abi_align)
+                    );
+                }
+            }
+
+            reader.emitError() << "unknown core attribute code: " << code;
+            return {};
+        }
+    };
+
+    void CoreDialect::registerBytecodeInterface() {
+        addInterfaces< CoreBytecodeDialectInterface >();
+    }
+
+} // namespace vast::core
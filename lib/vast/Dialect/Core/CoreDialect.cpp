@@ -10,6 +10,7 @@
 #include <mlir/IR/TypeSupport.h>
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/DialectImplementation.h>
+#include <mlir/Interfaces/FoldInterfaces.h>
 
 #include <llvm/ADT/TypeSwitch.h>
 #include <llvm/Support/ErrorHandling.h>
@@ -52,6 +53,17 @@ namespace vast::core
         }
     };
 
+    // Constants used in a scope are materialized in the scope, as they are
+    // in the regions of hl operations.
+    struct CoreFoldInterface : mlir::DialectFoldInterface
+    {
+        using mlir::DialectFoldInterface::DialectFoldInterface;
+
+        bool shouldMaterializeInto(mlir::Region *region) const final {
+            return mlir::isa< ScopeOp >(region->getParentOp());
+        }
+    };
+
     void CoreDialect::initialize()
     {
         registerTypes();
@@ -62,7 +74,8 @@ namespace vast::core
             #include "vast/Dialect/Core/Core.cpp.inc"
         >();
 
-        addInterfaces< CoreOpAsmDialectInterface >();
+        addInterfaces< CoreOpAsmDialectInterface, CoreFoldInterface >();
+        registerBytecodeInterface();
     }
 
     using OpBuilder = mlir::OpBuilder;
@@ -24,6 +24,41 @@
 namespace vast::core
 {
     GRAPH_REGION_OP(ScopeOp);
+
+    static bool is_declaration(operation op)
+    {
+        return mlir::isa< VastSymbolOpInterface, mlir::SymbolOpInterface >(op);
+    }
+
+    //
+    // Scopes that declare nothing do not delimit lifetime nor visibility of
+    // anything, hence their body is inlined into the parent block. Soft
+    // terminators are moved only to the end of the parent block.
+    //
+    logical_result ScopeOp::canonicalize(ScopeOp op, mlir::PatternRewriter &rewriter)
+    {
+        auto &body = op.getBody();
+        if (body.empty()) {
+            rewriter.eraseOp(op);
+            return mlir::success();
+        }
+
+        if (!body.hasOneBlock()) {
+            return mlir::failure();
+        }
+
+        auto &block = body.front();
+        auto is_trailing = op->getNextNode() == nullptr;
+        for (auto &nested : block) {
+            if (is_declaration(&nested) || (is_soft_terminator(&nested) && !is_trailing)) {
+                return mlir::failure();
+            }
+        }
+
+        rewriter.inlineBlockBefore(&block, op);
+        rewriter.eraseOp(op);
+        return mlir::success();
+    }
 } // namespace vast::core
 
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,316 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeImplementation.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "vast/Util/Common.hpp"
+
+//
+// Compact bytecode encoding of the most frequent high-level types and
+// qualifier attributes. Every encoded entry starts with its code followed by
+// the parameters of the type. Types without a custom encoding fall back to
+// their textual assembly form.
+//
+// Codes are part of the bytecode format, new entries may only be appended.
+//
+namespace vast::hl
+{
+    namespace
+    {
+        enum class type_code : std::uint64_t
+        {
+            void_type        = 0,
+            bool_type        = 1,
+            char_type        = 2,
+            short_type       = 3,
+            int_type         = 4,
+            long_type        = 5,
+            longlong_type    = 6,
+            int128_type      = 7,
+            half_type        = 8,
+            bfloat16_type    = 9,
+            float_type       = 10,
+            double_type      = 11,
+            longdouble_type  = 12,
+            float128_type    = 13,
+            pointer_type     = 14,
+            lvalue_type      = 15,
+            rvalue_type      = 16,
+            reference_type   = 17,
+            record_type      = 18,
+            enum_type        = 19,
+            typedef_type     = 20,
+            elaborated_type  = 21,
+            paren_type       = 22,
+            decayed_type     = 23,
+            attributed_type  = 24,
+            label_type       = 25,
+        };
+
+        enum class attr_code : std::uint64_t
+        {
+            cv_qualifiers  = 0,
+            ucv_qualifiers = 1,
+            cvr_qualifiers = 2,
+        };
+
+        //
+        // Qualifiers are encoded as a single bitmask, where the lowest bit
+        // marks the presence of the optional qualifiers attribute.
+        //
+        std::uint64_t encode(CVQualifiersAttr quals) {
+            if (!quals) {
+                return 0;
+            }
+            return 1 | quals.getIsConst() << 1 | quals.getIsVolatile() << 2;
+        }
+
+        std::uint64_t encode(UCVQualifiersAttr quals) {
+            if (!quals) {
+                return 0;
+            }
+            return 1 | quals.getIsUnsigned() << 1 | quals.getIsConst() << 2 | quals.getIsVolatile() << 3;
+        }
+
+        std::uint64_t encode(CVRQualifiersAttr quals) {
+            if (!quals) {
+                return 0;
+            }
+            return 1 | quals.getIsConst() << 1 | quals.getIsVolatile() << 2 | quals.getIsRestrict() << 3;
+        }
+
+        bool bit(std::uint64_t bits, unsigned idx) { return bits & (1u << idx); }
+
+        template< typename quals_t >
+        quals_t decode(mcontext_t *ctx, std::uint64_t bits) {
+            if (!bit(bits, 0)) {
+                return {};
+            }
+
+            if constexpr (std::is_same_v< quals_t, CVQualifiersAttr >) {
+                return CVQualifiersAttr::get(ctx, bit(bits, 1), bit(bits, 2));
+            } else if constexpr (std::is_same_v< quals_t, UCVQualifiersAttr >) {
+                return UCVQualifiersAttr::get(ctx, bit(bits, 1), bit(bits, 2), bit(bits, 3));
+            } else {
+                static_assert(std::is_same_v< quals_t, CVRQualifiersAttr >);
+                return CVRQualifiersAttr::get(ctx, bit(bits, 1), bit(bits, 2), bit(bits, 3));
+            }
+        }
+
+        template< typename type_t >
+        using quals_of = decltype(std::declval< type_t >().getQuals());
+
+    } // namespace
+
+    struct HighLevelBytecodeDialectInterface : mlir::BytecodeDialectInterface
+    {
+        using BytecodeDialectInterface::BytecodeDialectInterface;
+
+        using reader_t = mlir::DialectBytecodeReader;
+        using writer_t = mlir::DialectBytecodeWriter;
+
+        //
+        // types
+        //
+
+        template< typename type_t >
+        static logical_result write_qualified(type_code code, type_t type, writer_t &writer) {
+            writer.writeVarInt(std::uint64_t(code));
+            writer.writeVarInt(encode(type.getQuals()));
+            return mlir::success();
+        }
+
+        template< typename type_t >
+        static logical_result write_qualified_element(type_code code, type_t type, writer_t &writer) {
+            writer.writeVarInt(std::uint64_t(code));
+            writer.writeType(type.getElementType());
+            writer.writeVarInt(encode(type.getQuals()));
+            return mlir::success();
+        }
+
+        template< typename type_t >
+        static logical_result write_qualified_name(type_code code, type_t type, writer_t &writer) {
+            writer.writeVarInt(std::uint64_t(code));
+            writer.writeOwnedString(type.getName());
+            writer.writeVarInt(encode(type.getQuals()));
+            return mlir::success();
+        }
+
+        template< typename type_t >
+        static logical_result write_element(type_code code, type_t type, writer_t &writer) {
+            writer.writeVarInt(std::uint64_t(code));
+            writer.writeType(type.getElementType());
+            return mlir::success();
+        }
+
+        logical_result writeType(mlir_type type, writer_t &writer) const final {
+            using tc = type_code;
+            return llvm::TypeSwitch< mlir_type, logical_result >(type)
+                .Case([&] (VoidType t)       { return write_qualified(tc::void_type, t, writer); })
+                .Case([&] (BoolType t)       { return write_qualified(tc::bool_type, t, writer); })
+                .Case([&] (CharType t)       { return write_qualified(tc::char_type, t, writer); })
+                .Case([&] (ShortType t)      { return write_qualified(tc::short_type, t, writer); })
+                .Case([&] (IntType t)        { return write_qualified(tc::int_type, t, writer); })
+                .Case([&] (LongType t)       { return write_qualified(tc::long_type, t, writer); })
+                .Case([&] (LongLongType t)   { return write_qualified(tc::longlong_type, t, writer); })
+                .Case([&] (Int128Type t)     { return write_qualified(tc::int128_type, t, writer); })
+                .Case([&] (HalfType t)       { return write_qualified(tc::half_type, t, writer); })
+                .Case([&] (BFloat16Type t)   { return write_qualified(tc::bfloat16_type, t, writer); })
+                .Case([&] (FloatType t)      { return write_qualified(tc::float_type, t, writer); })
+                .Case([&] (DoubleType t)     { return write_qualified(tc::double_type, t, writer); })
+                .Case([&] (LongDoubleType t) { return write_qualified(tc::longdouble_type, t, writer); })
+                .Case([&] (Float128Type t)   { return write_qualified(tc::float128_type, t, writer); })
+                .Case([&] (PointerType t)    { return write_qualified_element(tc::pointer_type, t, writer); })
+                .Case([&] (ElaboratedType t) { return write_qualified_element(tc::elaborated_type, t, writer); })
+                .Case([&] (RecordType t)     { return write_qualified_name(tc::record_type, t, writer); })
+                .Case([&] (EnumType t)       { return write_qualified_name(tc::enum_type, t, writer); })
+                .Case([&] (TypedefType t)    { return write_qualified_name(tc::typedef_type, t, writer); })
+                .Case([&] (LValueType t)     { return write_element(tc::lvalue_type, t, writer); })
+                .Case([&] (RValueType t)     { return write_element(tc::rvalue_type, t, writer); })
+                .Case([&] (ReferenceType t)  { return write_element(tc::reference_type, t, writer); })
+                .Case([&] (ParenType t)      { return write_element(tc::paren_type, t, writer); })
+                .Case([&] (DecayedType t)    { return write_element(tc::decayed_type, t, writer); })
+                .Case([&] (AttributedType t) { return write_element(tc::attributed_type, t, writer); })
+                .Case([&] (LabelType) {
+                    writer.writeVarInt(std::uint64_t(tc::label_type));
+                    return mlir::success();
+                })
+                .Default([] (auto) { return mlir::failure(); });
+        }
+
+        template< typename type_t >
+        mlir_type read_qualified(reader_t &reader) const {
+            std::uint64_t quals;
+            if (mlir::failed(reader.readVarInt(quals))) {
+                return {};
+            }
+            return type_t::get(getContext(), decode< quals_of< type_t > >(getContext(), quals));
+        }
+
+        template< typename type_t >
+        mlir_type read_qualified_element(reader_t &reader) const {
+            mlir_type element;
+            std::uint64_t quals;
+            if (mlir::failed(reader.readType(element)) || mlir::failed(reader.readVarInt(quals))) {
+                return {};
+            }
+            return type_t::get(getContext(), element, decode< quals_of< type_t > >(getContext(), quals));
+        }
+
+        template< typename type_t >
+        mlir_type read_qualified_name(reader_t &reader) const {
+            string_ref name;
+            std::uint64_t quals;
+            if (mlir::failed(reader.readString(name)) || mlir::failed(reader.readVarInt(quals))) {
+                return {};
+            }
+            return type_t::get(getContext(), name, decode< quals_of< type_t > >(getContext(), quals));
+        }
+
+        template< typename type_t >
+        mlir_type read_element(reader_t &reader) const {
+            mlir_type element;
+            if (mlir::failed(reader.readType(element))) {
+                return {};
+            }
+            return type_t::get(getContext(), element);
+        }
+
+        mlir_type readType(reader_t &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            switch (type_code(code)) {
+                case type_code::void_type:       return read_qualified< VoidType >(reader);
+                case type_code::bool_type:       return read_qualified< BoolType >(reader);
+                case type_code::char_type:       return read_qualified< CharType >(reader);
+                case type_code::short_type:      return read_qualified< ShortType >(reader);
+                case type_code::int_type:        return read_qualified< IntType >(reader);
+                case type_code::long_type:       return read_qualified< LongType >(reader);
+                case type_code::longlong_type:   return read_qualified< LongLongType >(reader);
+                case type_code::int128_type:     return read_qualified< Int128Type >(reader);
+                case type_code::half_type:       return read_qualified< HalfType >(reader);
+                case type_code::bfloat16_type:   return read_qualified< BFloat16Type >(reader);
+                case type_code::float_type:      return read_qualified< FloatType >(reader);
+                case type_code::double_type:     return read_qualified< DoubleType >(reader);
+                case type_code::longdouble_type: return read_qualified< LongDoubleType >(reader);
+                case type_code::float128_type:   return read_qualified< Float128Type >(reader);
+                case type_code::pointer_type:    return read_qualified_element< PointerType >(reader);
+                case type_code::elaborated_type: return read_qualified_element< ElaboratedType >(reader);
+                case type_code::record_type:     return read_qualified_name< RecordType >(reader);
+                case type_code::enum_type:       return read_qualified_name< EnumType >(reader);
+                case type_code::typedef_type:    return read_qualified_name< TypedefType >(reader);
+                case type_code::lvalue_type:     return read_element< LValueType >(reader);
+                case type_code::rvalue_type:     return read_element< RValueType >(reader);
+                case type_code::reference_type:  return read_element< ReferenceType >(reader);
+                case type_code::paren_type:      return read_element< ParenType >(reader);
+                case type_code::decayed_type:    return read_element< DecayedType >(reader);
+                case type_code::attributed_type: return read_element< AttributedType >(reader);
+                case type_code::label_type:      return LabelType::get(getContext());
+            }
+
+            reader.emitError() << "unknown hl type code: " << code;
+            return {};
+        }
+
+        //
+        // attributes
+        //
+
+        template< typename attr_t >
+        static logical_result write_quals(attr_code code, attr_t attr, writer_t &writer) {
+            writer.writeVarInt(std::uint64_t(code));
+            writer.writeVarInt(encode(attr));
+            return mlir::success();
+        }
+
+        logical_result writeAttribute(mlir_attr attr, writer_t &writer) const final {
+            using ac = attr_code;
+            return llvm::TypeSwitch< mlir_attr, logical_result >(attr)
+                .Case([&] (CVQualifiersAttr a)  { return write_quals(ac::cv_qualifiers, a, writer); })
+                .Case([&] (UCVQualifiersAttr a) { return write_quals(ac::ucv_qualifiers, a, writer); })
+                .Case([&] (CVRQualifiersAttr a) { return write_quals(ac::cvr_qualifiers, a, writer); })
+                .Default([] (auto) { return mlir::failure(); });
+        }
+
+        template< typename attr_t >
+        mlir_attr read_quals(reader_t &reader) const {
+            std::uint64_t quals;
+            if (mlir::failed(reader.readVarInt(quals))) {
+                return {};
+            }
+            return decode< attr_t >(getContext(), quals);
+        }
+
+        mlir_attr readAttribute(reader_t &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            switch (attr_code(code)) {
+                case attr_code::cv_qualifiers:  return read_quals< CVQualifiersAttr >(reader);
+                case attr_code::ucv_qualifiers: return read_quals< UCVQualifiersAttr >(reader);
+                case attr_code::cvr_qualifiers: return read_quals< CVRQualifiersAttr >(reader);
+            }
+
+            reader.emitError() << "unknown hl attribute code: " << code;
+            return {};
+        }
+    };
+
+    void HighLevelDialect::registerBytecodeInterface() {
+        addInterfaces< HighLevelBytecodeDialectInterface >();
+    }
+
+} // namespace vast::hl
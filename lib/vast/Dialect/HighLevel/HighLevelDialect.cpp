@@ -15,6 +15,7 @@
 #include <mlir/IR/DialectImplementation.h>
 #include <mlir/IR/OpImplementation.h>
 #include <mlir/IR/DialectInterface.h>
+#include <mlir/Interfaces/FoldInterfaces.h>
 
 #include <llvm/ADT/TypeSwitch.h>
 #include <llvm/Support/ErrorHandling.h>
@@ -44,6 +45,16 @@ namespace vast::hl
         }
     };
 
+    // Constants are materialized in the region of their hl operation, e.g.,
+    // the condition or the body of a loop, instead of being hoisted to the
+    // entry of the function, so that regions stay self-contained.
+    struct HighLevelFoldInterface : mlir::DialectFoldInterface
+    {
+        using mlir::DialectFoldInterface::DialectFoldInterface;
+
+        bool shouldMaterializeInto(mlir::Region *) const final { return true; }
+    };
+
     void HighLevelDialect::initialize()
     {
         registerTypes();
@@ -54,7 +65,8 @@ namespace vast::hl
             #include "vast/Dialect/HighLevel/HighLevel.cpp.inc"
         >();
 
-        addInterfaces< HighLevelOpAsmDialectInterface >();
+        addInterfaces< HighLevelOpAsmDialectInterface, HighLevelFoldInterface >();
+        registerBytecodeInterface();
     }
 
     using DialectParser = mlir::AsmParser;
@@ -62,7 +74,12 @@ namespace vast::hl
 
     Operation *HighLevelDialect::materializeConstant(Builder &builder, Attribute value, Type type, Location loc)
     {
-        VAST_UNIMPLEMENTED;
+        auto typed = mlir::dyn_cast< mlir::TypedAttr >(value);
+        if (!typed || typed.getType() != type) {
+            return nullptr;
+        }
+
+        return builder.create< ConstantOp >(loc, type, typed);
     }
 
 } // namespace vast::hl
@@ -12,6 +12,8 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/OpImplementation.h>
 #include <mlir/IR/FunctionInterfaces.h>
 #include <mlir/IR/FunctionImplementation.h>
+#include <mlir/IR/PatternMatch.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
 
 #include <llvm/Support/ErrorHandling.h>
 VAST_UNRELAX_WARNINGS
@@ -68,6 +70,428 @@ namespace vast::hl
         return adaptor.getValue();
     }
 
+    //===----------------------------------------------------------------------===//
+    // Constant folding
+    //===----------------------------------------------------------------------===//
+
+    using maybe_apsint = std::optional< llvm::APSInt >;
+
+    // Size of the type in bits, if the module data layout has an entry for it.
+    // The data layout is emitted after the codegen, hence folders cannot rely
+    // on its presence.
+    static std::optional< std::uint64_t > type_size_in_bits(Operation *op, mlir_type type) {
+        auto mod = op->getParentOfType< mlir::ModuleOp >();
+        if (!mod) {
+            return std::nullopt;
+        }
+
+        auto spec = mod.getDataLayoutSpec();
+        if (!spec) {
+            return std::nullopt;
+        }
+
+        auto has_entry = llvm::any_of(spec.getEntries(), [&] (auto entry) {
+            return mlir::dyn_cast< mlir_type >(entry.getKey()) == type;
+        });
+
+        if (!has_entry) {
+            return std::nullopt;
+        }
+
+        return mlir::DataLayout(mod).getTypeSizeInBits(type);
+    }
+
+    static core::IntegerAttr integer_of_type(Attribute attr, mlir_type type) {
+        auto cst = mlir::dyn_cast_if_present< core::IntegerAttr >(attr);
+        return cst && cst.getType() == type ? cst : core::IntegerAttr();
+    }
+
+    static core::FloatAttr float_of_type(Attribute attr, mlir_type type) {
+        auto cst = mlir::dyn_cast_if_present< core::FloatAttr >(attr);
+        return cst && cst.getType() == type ? cst : core::FloatAttr();
+    }
+
+    static bool is_integer_constant(Attribute attr, std::int64_t value) {
+        auto cst = mlir::dyn_cast_if_present< core::IntegerAttr >(attr);
+        return cst && cst.getValue() == value;
+    }
+
+    // Folds binary operation on integer constants of the result type. The
+    // `fold` yields nothing if the operation has undefined behavior.
+    template< typename op_t, typename fold_t >
+    static FoldResult fold_integer_binary(op_t op, Attribute lhs, Attribute rhs, fold_t &&fold) {
+        auto type = op.getType();
+        auto l = integer_of_type(lhs, type);
+        auto r = integer_of_type(rhs, type);
+        if (!l || !r) {
+            return {};
+        }
+
+        if (auto result = fold(l.getValue(), r.getValue())) {
+            return core::IntegerAttr::get(type, *result);
+        }
+
+        return {};
+    }
+
+    template< typename op_t, typename fold_t >
+    static FoldResult fold_float_binary(op_t op, Attribute lhs, Attribute rhs, fold_t &&fold) {
+        auto type = op.getType();
+        auto l = float_of_type(lhs, type);
+        auto r = float_of_type(rhs, type);
+        if (!l || !r) {
+            return {};
+        }
+
+        auto result = l.getValue();
+        fold(result, r.getValue());
+        return core::FloatAttr::get(type, result);
+    }
+
+    // Operation with the neutral `rhs` yields its `lhs`.
+    template< typename op_t >
+    static FoldResult fold_neutral_rhs(op_t op, Attribute rhs, std::int64_t neutral) {
+        if (op.getLhs().getType() == op.getType() && is_integer_constant(rhs, neutral)) {
+            return op.getLhs();
+        }
+        return {};
+    }
+
+    static constexpr auto rounding = llvm::APFloat::rmNearestTiesToEven;
+
+    FoldResult AddIOp::fold(FoldAdaptor adaptor) {
+        if (auto neutral = fold_neutral_rhs(*this, adaptor.getRhs(), 0)) {
+            return neutral;
+        }
+
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint { return l + r; }
+        );
+    }
+
+    FoldResult SubIOp::fold(FoldAdaptor adaptor) {
+        if (auto neutral = fold_neutral_rhs(*this, adaptor.getRhs(), 0)) {
+            return neutral;
+        }
+
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint { return l - r; }
+        );
+    }
+
+    FoldResult MulIOp::fold(FoldAdaptor adaptor) {
+        if (auto neutral = fold_neutral_rhs(*this, adaptor.getRhs(), 1)) {
+            return neutral;
+        }
+
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint { return l * r; }
+        );
+    }
+
+    FoldResult DivSOp::fold(FoldAdaptor adaptor) {
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint {
+                if (r.isZero()) {
+                    return std::nullopt;
+                }
+
+                bool overflow = false;
+                auto result = l.sdiv_ov(r, overflow);
+                if (overflow) {
+                    return std::nullopt;
+                }
+                return llvm::APSInt(result, l.isUnsigned());
+            }
+        );
+    }
+
+    FoldResult DivUOp::fold(FoldAdaptor adaptor) {
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint {
+                if (r.isZero()) {
+                    return std::nullopt;
+                }
+                return llvm::APSInt(l.udiv(r), l.isUnsigned());
+            }
+        );
+    }
+
+    FoldResult RemSOp::fold(FoldAdaptor adaptor) {
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint {
+                // The remainder is undefined if the quotient is not representable.
+                bool overflow = false;
+                if (r.isZero() || (l.sdiv_ov(r, overflow), overflow)) {
+                    return std::nullopt;
+                }
+                return llvm::APSInt(l.srem(r), l.isUnsigned());
+            }
+        );
+    }
+
+    FoldResult RemUOp::fold(FoldAdaptor adaptor) {
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint {
+                if (r.isZero()) {
+                    return std::nullopt;
+                }
+                return llvm::APSInt(l.urem(r), l.isUnsigned());
+            }
+        );
+    }
+
+    FoldResult BinXorOp::fold(FoldAdaptor adaptor) {
+        if (auto neutral = fold_neutral_rhs(*this, adaptor.getRhs(), 0)) {
+            return neutral;
+        }
+
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint { return l ^ r; }
+        );
+    }
+
+    FoldResult BinOrOp::fold(FoldAdaptor adaptor) {
+        if (auto neutral = fold_neutral_rhs(*this, adaptor.getRhs(), 0)) {
+            return neutral;
+        }
+
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint { return l | r; }
+        );
+    }
+
+    FoldResult BinAndOp::fold(FoldAdaptor adaptor) {
+        return fold_integer_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const auto &l, const auto &r) -> maybe_apsint { return l & r; }
+        );
+    }
+
+    FoldResult AddFOp::fold(FoldAdaptor adaptor) {
+        return fold_float_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (auto &l, const auto &r) { l.add(r, rounding); }
+        );
+    }
+
+    FoldResult SubFOp::fold(FoldAdaptor adaptor) {
+        return fold_float_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (auto &l, const auto &r) { l.subtract(r, rounding); }
+        );
+    }
+
+    FoldResult MulFOp::fold(FoldAdaptor adaptor) {
+        return fold_float_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (auto &l, const auto &r) { l.multiply(r, rounding); }
+        );
+    }
+
+    FoldResult DivFOp::fold(FoldAdaptor adaptor) {
+        return fold_float_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (auto &l, const auto &r) { l.divide(r, rounding); }
+        );
+    }
+
+    FoldResult RemFOp::fold(FoldAdaptor adaptor) {
+        return fold_float_binary(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (auto &l, const auto &r) { l.mod(r); }
+        );
+    }
+
+    // Shifts by negative amounts or by at least the width of the shifted
+    // value are undefined, and are not folded.
+    template< typename op_t, typename fold_t >
+    static FoldResult fold_shift(op_t op, Attribute lhs, Attribute rhs, fold_t &&fold) {
+        if (is_integer_constant(rhs, 0)) {
+            return op.getLhs();
+        }
+
+        auto l = integer_of_type(lhs, op.getType());
+        auto r = mlir::dyn_cast_if_present< core::IntegerAttr >(rhs);
+        if (!l || !r) {
+            return {};
+        }
+
+        auto amount = r.getValue();
+        if (amount.isNegative() || amount.uge(l.getValue().getBitWidth())) {
+            return {};
+        }
+
+        auto shift = static_cast< unsigned >(amount.getZExtValue());
+        return core::IntegerAttr::get(op.getType(), fold(l.getValue(), shift));
+    }
+
+    FoldResult BinShlOp::fold(FoldAdaptor adaptor) {
+        return fold_shift(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const llvm::APSInt &l, unsigned n) { return llvm::APSInt(l.shl(n), l.isUnsigned()); }
+        );
+    }
+
+    FoldResult BinLShrOp::fold(FoldAdaptor adaptor) {
+        return fold_shift(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const llvm::APSInt &l, unsigned n) { return llvm::APSInt(l.lshr(n), l.isUnsigned()); }
+        );
+    }
+
+    FoldResult BinAShrOp::fold(FoldAdaptor adaptor) {
+        return fold_shift(*this, adaptor.getLhs(), adaptor.getRhs(),
+            [] (const llvm::APSInt &l, unsigned n) { return llvm::APSInt(l.ashr(n), l.isUnsigned()); }
+        );
+    }
+
+    FoldResult PlusOp::fold(FoldAdaptor) { return getArg(); }
+
+    FoldResult MinusOp::fold(FoldAdaptor adaptor) {
+        if (auto cst = integer_of_type(adaptor.getArg(), getType())) {
+            auto value = cst.getValue();
+            // Negation of the minimal signed value overflows.
+            if (value.isSigned() && value.isMinSignedValue()) {
+                return {};
+            }
+            return core::IntegerAttr::get(getType(), -value);
+        }
+
+        if (auto cst = float_of_type(adaptor.getArg(), getType())) {
+            return core::FloatAttr::get(getType(), llvm::neg(cst.getValue()));
+        }
+
+        return {};
+    }
+
+    FoldResult NotOp::fold(FoldAdaptor adaptor) {
+        if (auto cst = integer_of_type(adaptor.getArg(), getType())) {
+            return core::IntegerAttr::get(getType(), ~cst.getValue());
+        }
+        return {};
+    }
+
+    using effects_t = llvm::SmallVectorImpl<
+        mlir::SideEffects::EffectInstance< mlir::MemoryEffects::Effect >
+    >;
+
+    // Casts to the type of the casted value are no-ops. Integral casts of
+    // constants are folded if the width of the target type is known.
+    template< typename op_t >
+    static FoldResult fold_cast(op_t op, Attribute value) {
+        if (op.getValue().getType() == op.getType()) {
+            return op.getValue();
+        }
+
+        if (!value) {
+            return {};
+        }
+
+        auto type = op.getType();
+        auto kind = op.getKind();
+
+        if (kind == CastKind::IntegralToBoolean && isBoolType(type)) {
+            if (auto cst = mlir::dyn_cast< core::IntegerAttr >(value)) {
+                return core::BooleanAttr::get(type, !cst.getValue().isZero());
+            }
+            return {};
+        }
+
+        if (kind != CastKind::IntegralCast || !isIntegerType(type) || isBoolType(type)) {
+            return {};
+        }
+
+        auto width = type_size_in_bits(op, type);
+        if (!width) {
+            return {};
+        }
+
+        llvm::APSInt result;
+        if (auto cst = mlir::dyn_cast< core::IntegerAttr >(value)) {
+            result = cst.getValue().extOrTrunc(static_cast< unsigned >(*width));
+        } else if (auto cst = mlir::dyn_cast< core::BooleanAttr >(value)) {
+            result = llvm::APSInt(llvm::APInt(static_cast< unsigned >(*width), cst.getValue()));
+        } else {
+            return {};
+        }
+
+        result.setIsUnsigned(isUnsigned(type));
+        return core::IntegerAttr::get(type, result);
+    }
+
+    // Loads keep their effects conservative, as loads of volatile lvalues
+    // must be neither merged nor removed. Other casts are free of effects,
+    // so that casts of constants are deduplicated with the constants.
+    template< typename op_t >
+    static void cast_effects(op_t op, effects_t &effects) {
+        auto kind = op.getKind();
+        if (kind == CastKind::LValueToRValue || kind == CastKind::LValueToRValueBitCast) {
+            effects.emplace_back(mlir::MemoryEffects::Read::get(), op.getValue());
+            effects.emplace_back(mlir::MemoryEffects::Write::get(), op.getValue());
+        }
+    }
+
+    void ImplicitCastOp::getEffects(effects_t &effects) { cast_effects(*this, effects); }
+    void CStyleCastOp::getEffects(effects_t &effects) { cast_effects(*this, effects); }
+    void BuiltinBitCastOp::getEffects(effects_t &effects) { cast_effects(*this, effects); }
+
+    FoldResult ImplicitCastOp::fold(FoldAdaptor adaptor) {
+        return fold_cast(*this, adaptor.getValue());
+    }
+
+    FoldResult CStyleCastOp::fold(FoldAdaptor adaptor) {
+        return fold_cast(*this, adaptor.getValue());
+    }
+
+    FoldResult BuiltinBitCastOp::fold(FoldAdaptor) {
+        if (getValue().getType() == getType()) {
+            return getValue();
+        }
+        return {};
+    }
+
+    FoldResult SizeOfTypeOp::fold(FoldAdaptor) {
+        auto size  = type_size_in_bits(*this, getArg());
+        auto width = type_size_in_bits(*this, getType());
+        if (!size || !width) {
+            return {};
+        }
+
+        llvm::APInt bytes(static_cast< unsigned >(*width), *size / 8);
+        return core::IntegerAttr::get(getType(), llvm::APSInt(bytes, isUnsigned(getType())));
+    }
+
+    // Size of the type does not depend on runtime values.
+    static bool has_static_size(mlir_type type) {
+        if (auto elaborated = mlir::dyn_cast< ElaboratedType >(type)) {
+            return has_static_size(elaborated.getElementType());
+        }
+
+        // Typedefs may name variable length arrays.
+        if (mlir::isa< TypedefType >(type)) {
+            return false;
+        }
+
+        if (auto array = mlir::dyn_cast< ArrayType >(type)) {
+            return array.getSize().has_value() && has_static_size(array.getElementType());
+        }
+
+        return true;
+    }
+
+    // The operand of sizeof is not evaluated, unless its size is determined
+    // at runtime, therefore only its type is needed.
+    logical_result SizeOfExprOp::canonicalize(SizeOfExprOp op, mlir::PatternRewriter &rewriter) {
+        auto type = get_maybe_yielded_type(op.getExpr());
+        if (!type) {
+            return mlir::failure();
+        }
+
+        if (auto lvalue = mlir::dyn_cast< LValueType >(type)) {
+            type = lvalue.getElementType();
+        }
+
+        if (!has_static_size(type)) {
+            return mlir::failure();
+        }
+
+        rewriter.replaceOpWithNewOp< SizeOfTypeOp >(op, op.getType(), type);
+        return mlir::success();
+    }
+
 
     void build_expr_trait(Builder &bld, State &st, Type rty, BuilderCallback expr) {
         VAST_ASSERT(expr && "the builder callback for 'expr' region must be present");
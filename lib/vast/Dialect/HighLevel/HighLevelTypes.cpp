@@ -7,6 +7,7 @@
 #include <sstream>
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/TypeSwitch.h>
 #include <mlir/IR/OpImplementation.h>
 #include <mlir/IR/DialectImplementation.h>
@@ -105,6 +106,38 @@ namespace vast::hl
         VAST_UNIMPLEMENTED_MSG("unknown callee type");
     }
 
+    core::FunctionType getFunctionType(
+        mlir::CallOpInterface call, mlir::SymbolTableCollection &symbol_tables
+    ) {
+        auto callee = call.getCallableForCallee();
+        if (auto sym = callee.dyn_cast< mlir::SymbolRefAttr >()) {
+            // lookup from the call to respect symbol tables nested in the module
+            return mlir::dyn_cast_or_null< FuncOp >(
+                symbol_tables.lookupNearestSymbolFrom(call, sym)
+            ).getFunctionType();
+        }
+
+        auto mod = call->getParentOfType< vast_module >();
+        return getFunctionType(callee, mod, symbol_tables);
+    }
+
+    core::FunctionType getFunctionType(
+        mlir::CallInterfaceCallable callee, vast_module mod,
+        mlir::SymbolTableCollection &symbol_tables
+    ) {
+        if (auto sym = callee.dyn_cast< mlir::SymbolRefAttr >()) {
+            return mlir::dyn_cast_or_null< FuncOp >(
+                symbol_tables.lookupSymbolIn(mod, sym)
+            ).getFunctionType();
+        }
+
+        if (auto value = callee.dyn_cast< Value >()) {
+            return getFunctionType(value.getType(), mod);
+        }
+
+        VAST_UNIMPLEMENTED_MSG("unknown callee type");
+    }
+
 
     void HighLevelDialect::registerTypes() {
         addTypes<
@@ -113,6 +146,36 @@ namespace vast::hl
         >();
     }
 
+    namespace
+    {
+        using category_table = llvm::SmallDenseMap< mlir::TypeID, TypeCategory, 16 >;
+
+        template< typename ...types >
+        void add_category(category_table &table, util::type_list< types... >, TypeCategory category)
+        {
+            (table.try_emplace(mlir::TypeID::get< types >(), category), ...);
+        }
+
+        const category_table &type_categories()
+        {
+            static const category_table table = [] {
+                category_table table;
+                add_category(table, util::type_list< BoolType >{}, TypeCategory::Bool);
+                add_category(table, integer_types{}, TypeCategory::Integer);
+                add_category(table, floating_types{}, TypeCategory::Floating);
+                add_category(table, composite_types{}, TypeCategory::Composite);
+                add_category(table, util::type_list< VoidType >{}, TypeCategory::Void);
+                return table;
+            } ();
+            return table;
+        }
+    } // namespace
+
+    TypeCategory getTypeCategory(mlir_type type)
+    {
+        return type_categories().lookup(type.getTypeID());
+    }
+
     bool isBoolType(mlir_type type)
     {
         return type.isa< BoolType >();
@@ -120,12 +183,12 @@ namespace vast::hl
 
     bool isIntegerType(mlir_type type)
     {
-        return util::is_one_of< integer_types >(type);
+        return getTypeCategory(type) == TypeCategory::Integer;
     }
 
     bool isFloatingType(mlir_type type)
     {
-        return util::is_one_of< floating_types >(type);
+        return getTypeCategory(type) == TypeCategory::Floating;
     }
 
     bool isSigned(mlir_type type)
@@ -151,7 +214,7 @@ namespace vast::hl
 
     bool isHighLevelType(mlir_type type)
     {
-        return util::is_one_of< high_level_types >(type);
+        return getTypeCategory(type) != TypeCategory::None;
     }
 
 } // namespace vast::hl
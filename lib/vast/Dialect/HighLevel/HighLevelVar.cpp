@@ -29,6 +29,9 @@ namespace vast::hl
     bool VarDeclOp::isInRecordContext() { return isRecordContext(getDeclContextKind()); }
 
     DeclContextKind VarDeclOp::getDeclContextKind() {
+        // Functions are not symbol tables, hence they are looked up first.
+        if ((*this)->getParentOfType< mlir::FunctionOpInterface >())
+            return DeclContextKind::dc_function;
         auto st = mlir::SymbolTable::getNearestSymbolTable(*this);
         if (mlir::isa< FuncOp >(st))
             return DeclContextKind::dc_function;
@@ -52,10 +55,19 @@ namespace vast::hl
 
     bool VarDeclOp::isLocalVarDecl() { return isInFunctionOrMethodContext(); }
 
+    // Storage classes are omitted if they are none.
+    static StorageClass storage_class(VarDeclOp op) {
+        return op.getStorageClass().value_or(StorageClass::sc_none);
+    }
+
+    static TSClass thread_storage_class(VarDeclOp op) {
+        return op.getThreadStorageClass().value_or(TSClass::tsc_none);
+    }
+
     bool VarDeclOp::hasLocalStorage() {
-        switch (getStorageClass().value()) {
+        switch (storage_class(*this)) {
             case StorageClass::sc_none:
-                return !isFileVarDecl() && getThreadStorageClass() == TSClass::tsc_none;
+                return !isFileVarDecl() && thread_storage_class(*this) == TSClass::tsc_none;
             case StorageClass::sc_register: return isLocalVarDecl();
             case StorageClass::sc_auto: return true;
             case StorageClass::sc_extern:
@@ -69,10 +81,10 @@ namespace vast::hl
     bool VarDeclOp::isStaticLocal() {
         if (isFileVarDecl())
             return false;
-        auto sc = getStorageClass();
+        auto sc = storage_class(*this);
         if (sc == StorageClass::sc_static)
             return true;
-        auto tsc = getThreadStorageClass();
+        auto tsc = thread_storage_class(*this);
         return sc == StorageClass::sc_none && tsc == TSClass::tsc_cxx_thread;
     }
 
@@ -86,7 +98,7 @@ namespace vast::hl
     StorageDuration VarDeclOp::getStorageDuration() {
         if (hasLocalStorage())
             return StorageDuration::sd_automatic;
-        if (getThreadStorageClass() != TSClass::tsc_none)
+        if (thread_storage_class(*this) != TSClass::tsc_none)
             return StorageDuration::sd_thread;
         return StorageDuration::sd_static;
     }
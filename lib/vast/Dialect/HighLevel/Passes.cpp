@@ -5,17 +5,23 @@
 VAST_RELAX_WARNINGS
 #include <mlir/Pass/Pass.h>
 #include <mlir/Pass/PassManager.h>
+#include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+#include <mlir/Transforms/Passes.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
 namespace vast::hl::pipeline {
 
     //
     // canonicalization pipeline passes
     //
+    // Function local passes are nested on functions, so the pass manager can
+    // process functions of a module in parallel.
+    //
     static pipeline_step_ptr splice_trailing_scopes() {
-        return pass(hl::createSpliceTrailingScopes);
+        return nested< hl::FuncOp >(hl::createSpliceTrailingScopes);
     }
 
     // TODO: add more passes here (remove reduntant skips etc.)
@@ -39,12 +45,37 @@ namespace vast::hl::pipeline {
     //
     // simplifcaiton passes
     //
+    static pipeline_step_ptr dead_decls() {
+        return pass(hl::createDeadDeclEliminationPass);
+    }
+
     static pipeline_step_ptr dce() {
-        return pass(hl::createDCEPass).depends_on(canonicalize);
+        return nested< hl::FuncOp >(hl::createDCEPass).depends_on(canonicalize);
+    }
+
+    // Folds constant expressions and applies canonicalization patterns of
+    // operations. Blocks of hl regions are not merged nor erased, as the
+    // structure of control flow regions is given by their operations, and
+    // constants stay in the regions that use them.
+    static std::unique_ptr< mlir::Pass > create_canonicalizer() {
+        mlir::GreedyRewriteConfig config;
+        config.enableRegionSimplification = false;
+        return mlir::createCanonicalizerPass(config);
+    }
+
+    static pipeline_step_ptr fold_constants() {
+        return nested< hl::FuncOp >(create_canonicalizer).depends_on(dce);
+    }
+
+    // Deduplicates operations free of side effects, i.e., constants repeated
+    // in a region, sizes and alignments of types, and casts of the same
+    // values.
+    static pipeline_step_ptr cse() {
+        return nested< hl::FuncOp >(mlir::createCSEPass).depends_on(fold_constants);
     }
 
     pipeline_step_ptr simplify() {
-        return compose("simplify", dce, desugar);
+        return compose("simplify", dead_decls, dce, fold_constants, cse, desugar);
     }
 
     //
@@ -3,24 +3,18 @@
 #include "vast/Dialect/HighLevel/Passes.hpp"
 
 VAST_RELAX_WARNINGS
-#include <mlir/Dialect/Func/IR/FuncOps.h>
-#include <mlir/Dialect/ControlFlow/IR/ControlFlowOps.h>
-
-#include <mlir/Transforms/DialectConversion.h>
-#include <mlir/Rewrite/FrozenRewritePatternSet.h>
-#include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+#include <mlir/IR/PatternMatch.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Transforms/RegionUtils.h>
 VAST_UNRELAX_WARNINGS
 
-#include "vast/Conversion/Common/Passes.hpp"
-
 #include "vast/Util/Common.hpp"
-#include "vast/Util/DialectConversion.hpp"
-#include "vast/Util/Terminator.hpp"
-#include "vast/Util/TypeList.hpp"
 
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
-#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
 #include "PassesDetails.hpp"
 
@@ -34,64 +28,213 @@ namespace vast::hl
             return ( mlir::isa< Args >( op ) || ... );
         }
 
+        std::optional< bool > constant_value(mlir_value value) {
+            auto cst = value.getDefiningOp< hl::ConstantOp >();
+            if (!cst) {
+                return std::nullopt;
+            }
+
+            if (auto attr = mlir::dyn_cast< core::BooleanAttr >(cst.getValue())) {
+                return attr.getValue();
+            }
+
+            if (auto attr = mlir::dyn_cast< core::IntegerAttr >(cst.getValue())) {
+                return !attr.getValue().isZero();
+            }
+
+            return std::nullopt;
+        }
+
+        // Condition regions are folded only if they consist of a constant and
+        // its yield, so no side effects are lost by erasing them.
+        std::optional< bool > constant_condition(mlir::Region &cond) {
+            if (!cond.hasOneBlock()) {
+                return std::nullopt;
+            }
+
+            auto &block = cond.front();
+            if (block.getOperations().size() != 2) {
+                return std::nullopt;
+            }
+
+            if (auto yield = mlir::dyn_cast< hl::CondYieldOp >(block.back())) {
+                return constant_value(yield.getResult());
+            }
+
+            return std::nullopt;
+        }
+
+        // Labels and cases in a region can be reached by `goto` or by the
+        // enclosing switch (e.g., Duff's device), even if the region itself is
+        // never entered.
+        bool has_jump_targets(mlir::Region &region) {
+            return region.walk([] (operation op) {
+                if (is_one_of< hl::LabelStmt, hl::LabelDeclOp, hl::CaseOp, hl::DefaultOp >(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            }).wasInterrupted();
+        }
+
     } // namespace
 
+    //
+    // Removes code that is never executed:
+    //
+    //   - operations after `hl.return`, `hl.break`, `hl.continue` and calls of
+    //     `noreturn` functions,
+    //   - branches of `hl.if` and `hl.while` with constant conditions,
+    //   - `core.select` with a constant condition,
+    //   - blocks without predecessors, e.g., after `hl-to-ll-cf` conversion.
+    //
+    // Blocks are processed from a worklist and operations are erased as soon
+    // as they are found dead.
+    //
     struct DCE : DCEBase< DCE >
     {
         using base = DCEBase< DCE >;
-        using operations_t = std::vector< mlir::Operation * >;
 
-        operations_t to_erase;
+        using worklist_t = std::vector< mlir::Block * >;
 
-        void simplify( mlir::Operation *root )
-        {
-            // If there is no reagion we have nothing to do.
-            for ( auto &region : root->getRegions() )
-                simplify( region );
+        // The pass is nested on functions and its instance is reused by their
+        // runs, hence the tables are built for each run.
+        std::optional< mlir::SymbolTableCollection > symbol_tables;
+
+        bool is_noreturn_call(operation op) {
+            auto call = mlir::dyn_cast< hl::CallOp >(op);
+            if (!call) {
+                return false;
+            }
+
+            auto callee = symbol_tables->lookupNearestSymbolFrom< hl::FuncOp >(
+                call, call.getCalleeAttr()
+            );
+
+            return callee && llvm::any_of(callee->getAttrs(), [] (auto attr) {
+                return mlir::isa< hl::NoReturnAttr >(attr.getValue());
+            });
         }
 
-        void simplify( mlir::Region &region )
-        {
-            for ( auto &block : region )
-                simplify( block );
+        bool is_terminator_like(operation op) {
+            return is_one_of< hl::ReturnOp, hl::BreakOp, hl::ContinueOp >(op);
         }
 
-        bool is_terminator_like( mlir::Operation *op )
-        {
-            return is_one_of< hl::ReturnOp, hl::BreakOp, hl::ContinueOp >( op );
+        static void push_nested_blocks(operation op, worklist_t &worklist) {
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    worklist.push_back(&block);
+                }
+            }
         }
 
-        void simplify( mlir::Block &block )
-        {
-            auto breakpoint = simplify_until_terminator( block );
-            while ( breakpoint != block.end() )
-                to_erase.emplace_back( &*( breakpoint++ ) );
+        // Erases operations that follow `op` in its block. Regular block
+        // terminators are kept, as control flow regions require them.
+        static void erase_after(operation op, bool keep_terminator) {
+            auto block = op->getBlock();
+            while (&block->back() != op) {
+                auto &last = block->back();
+                if (keep_terminator && last.hasTrait< mlir::OpTrait::IsTerminator >()) {
+                    if (last.getPrevNode() == op) {
+                        break;
+                    }
+                    last.getPrevNode()->erase();
+                    continue;
+                }
+                last.erase();
+            }
         }
 
-        auto simplify_until_terminator( mlir::Block &block )
-            -> mlir::Block::iterator
-        {
-            for ( auto it = block.begin(); it != block.end(); std::advance( it, 1 ) )
-            {
-                if ( is_terminator_like( &*it ) )
-                    return std::next( it );
-                simplify( &*it );
+        // Replaces the operation by the region that is always executed. The
+        // region is kept in a scope to preserve lifetimes of its declarations.
+        static operation replace_by_region(operation op, mlir::Region &region) {
+            if (region.empty()) {
+                op->erase();
+                return nullptr;
+            }
+
+            mlir::OpBuilder bld(op);
+            auto scope = bld.create< core::ScopeOp >(op->getLoc());
+            scope.getBody().takeBody(region);
+            op->erase();
+            return scope;
+        }
+
+        // Folds control flow operation with a constant condition. Yields
+        // whether the operation was folded and the operation that replaced it.
+        std::pair< bool, operation > fold(operation op) {
+            if (auto if_op = mlir::dyn_cast< hl::IfOp >(op)) {
+                if (auto cond = constant_condition(if_op.getCondRegion())) {
+                    auto &taken   = *cond ? if_op.getThenRegion() : if_op.getElseRegion();
+                    auto &dropped = *cond ? if_op.getElseRegion() : if_op.getThenRegion();
+                    if (!has_jump_targets(dropped)) {
+                        return { true, replace_by_region(op, taken) };
+                    }
+                }
+            }
+
+            if (auto while_op = mlir::dyn_cast< hl::WhileOp >(op)) {
+                if (auto cond = constant_condition(while_op.getCondRegion());
+                    cond && !*cond && !has_jump_targets(while_op.getBodyRegion())
+                ) {
+                    op->erase();
+                    return { true, nullptr };
+                }
+            }
+
+            if (auto select = mlir::dyn_cast< core::SelectOp >(op)) {
+                if (auto cond = constant_value(select.getCond()); cond && select->getNumResults() == 1) {
+                    auto taken = *cond ? select.getThenRegion() : select.getElseRegion();
+                    if (taken.getType() == select->getResult(0).getType()) {
+                        select->getResult(0).replaceAllUsesWith(taken);
+                        op->erase();
+                        return { true, nullptr };
+                    }
+                }
+            }
+
+            return { false, nullptr };
+        }
+
+        void simplify(mlir::Block &block, worklist_t &worklist) {
+            for (auto it = block.begin(); it != block.end();) {
+                auto op = &*(it++);
+
+                if (auto [folded, replacement] = fold(op); folded) {
+                    if (replacement) {
+                        push_nested_blocks(replacement, worklist);
+                    }
+                    continue;
+                }
+
+                if (is_terminator_like(op)) {
+                    erase_after(op, false /* keep terminator */);
+                    return;
+                }
+
+                if (is_noreturn_call(op)) {
+                    erase_after(op, true /* keep terminator */);
+                    return;
+                }
+
+                push_nested_blocks(op, worklist);
             }
-            return block.end();
         }
 
         void runOnOperation() override
         {
             auto root = getOperation();
+            symbol_tables.emplace();
+
+            worklist_t worklist;
+            push_nested_blocks(root, worklist);
+            while (!worklist.empty()) {
+                auto block = worklist.back();
+                worklist.pop_back();
+                simplify(*block, worklist);
+            }
 
-            simplify( root );
-            // Due to dataflow dependencies last SSA values must be destroyed first.
-            std::reverse( to_erase.begin(), to_erase.end() );
-            for ( auto op : to_erase )
-                op->erase();
-
-            // This is what mlir codebase does.
-            to_erase.clear();
+            mlir::IRRewriter rewriter(&getContext());
+            std::ignore = mlir::eraseUnreachableBlocks(rewriter, root->getRegions());
         }
     };
 
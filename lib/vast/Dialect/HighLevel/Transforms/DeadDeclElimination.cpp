@@ -0,0 +1,204 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Name that the type uses to refer to its declaration.
+        std::optional< string_ref > declared_name(mlir_type type) {
+            return llvm::TypeSwitch< mlir_type, std::optional< string_ref > >(type)
+                .Case< RecordType, EnumType, TypedefType >([] (auto t) {
+                    return std::optional< string_ref >(t.getName());
+                })
+                .Default([] (auto) { return std::nullopt; });
+        }
+
+        bool is_static(hl::FuncOp fn) {
+            return fn.getLinkage() == core::GlobalLinkageKind::InternalLinkage;
+        }
+
+    } // namespace
+
+    //
+    // Removes top-level declarations that nothing references: function
+    // declarations, static function definitions, records, typedefs and enums.
+    //
+    // Functions are MLIR symbols and are referenced through symbol uses. Other
+    // declarations are vast symbols that are referenced by name from types
+    // (`!hl.record`, `!hl.enum`, `!hl.typedef`) or from `hl.enumref`. Starting
+    // from the remaining top-level operations, every reachable declaration is
+    // marked live, the rest is erased.
+    //
+    struct DeadDeclElimination : DeadDeclEliminationBase< DeadDeclElimination >
+    {
+        using base = DeadDeclEliminationBase< DeadDeclElimination >;
+
+        using decls_t = llvm::SmallVector< operation, 2 >;
+
+        llvm::StringMap< decls_t > functions;
+        llvm::StringMap< decls_t > types;
+        llvm::StringMap< decls_t > enum_constants;
+
+        llvm::DenseSet< operation > dead;
+        std::vector< operation > worklist;
+
+        void add_candidate(llvm::StringMap< decls_t > &decls, string_ref name, operation op) {
+            decls[name].push_back(op);
+            dead.insert(op);
+        }
+
+        void collect_candidates(vast_module mod) {
+            for (auto &op : mod.getOps()) {
+                llvm::TypeSwitch< operation >(&op)
+                    .Case([&] (hl::FuncOp fn) {
+                        if (fn.isDeclaration() || is_static(fn)) {
+                            add_candidate(functions, fn.getSymName(), fn);
+                        } else {
+                            worklist.push_back(fn);
+                        }
+                    })
+                    .Case< hl::StructDeclOp, hl::UnionDeclOp, hl::TypeDeclOp, hl::TypeDefOp >(
+                        [&] (auto decl) { add_candidate(types, decl.getName(), decl); }
+                    )
+                    .Case([&] (hl::EnumDeclOp decl) {
+                        add_candidate(types, decl.getName(), decl);
+                        decl.walk([&] (hl::EnumConstantOp constant) {
+                            enum_constants[constant.getName()].push_back(decl);
+                        });
+                    })
+                    .Default([&] (operation op) { worklist.push_back(op); });
+            }
+        }
+
+        void mark_live(const llvm::StringMap< decls_t > &decls, string_ref name) {
+            if (auto it = decls.find(name); it != decls.end()) {
+                for (auto op : it->second) {
+                    if (dead.erase(op)) {
+                        worklist.push_back(op);
+                    }
+                }
+            }
+        }
+
+        void mark_references(operation root, mlir::AttrTypeWalker &walker) {
+            root->walk([&] (operation op) {
+                walker.walk(op->getAttrDictionary());
+
+                for (auto type : op->getResultTypes()) {
+                    walker.walk(type);
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto arg : block.getArgumentTypes()) {
+                            walker.walk(arg);
+                        }
+                    }
+                }
+
+                if (auto ref = mlir::dyn_cast< hl::EnumRefOp >(op)) {
+                    mark_live(enum_constants, ref.getValue());
+                }
+            });
+        }
+
+        bool references_dead_type(mlir_type type) {
+            auto result = type.walk([&] (mlir_type t) {
+                auto name = declared_name(t);
+                if (name && types.count(*name) && !is_live_type(*name)) {
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            });
+            return result.wasInterrupted();
+        }
+
+        bool is_live_type(string_ref name) {
+            return llvm::any_of(types.lookup(name), [&] (operation op) {
+                return !dead.contains(op);
+            });
+        }
+
+        // Entries of removed types would require their definitions in the
+        // data layout conversions of later passes.
+        void prune_data_layout(vast_module mod) {
+            auto spec = mod.getDataLayoutSpec();
+            if (!spec) {
+                return;
+            }
+
+            auto is_live_entry = [&] (mlir::DataLayoutEntryInterface entry) {
+                auto type = mlir::dyn_cast< mlir_type >(entry.getKey());
+                return !type || !references_dead_type(type);
+            };
+
+            auto entries = llvm::to_vector(llvm::make_filter_range(spec.getEntries(), is_live_entry));
+            if (entries.size() == spec.getEntries().size()) {
+                return;
+            }
+
+            mod->setAttr(
+                mlir::DLTIDialect::kDataLayoutAttrName,
+                mlir::DataLayoutSpecAttr::get(&getContext(), entries)
+            );
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+
+            collect_candidates(mod);
+
+            mlir::AttrTypeWalker walker;
+            walker.addWalk([&] (mlir::SymbolRefAttr ref) {
+                mark_live(functions, ref.getRootReference().getValue());
+            });
+            walker.addWalk([&] (mlir_type type) {
+                if (auto name = declared_name(type)) {
+                    mark_live(types, *name);
+                }
+            });
+
+            while (!worklist.empty()) {
+                auto op = worklist.back();
+                worklist.pop_back();
+                mark_references(op, walker);
+            }
+
+            prune_data_layout(mod);
+
+            for (auto &op : llvm::make_early_inc_range(mod.getOps())) {
+                if (dead.contains(&op)) {
+                    op.erase();
+                }
+            }
+
+            functions.clear();
+            types.clear();
+            enum_constants.clear();
+            dead.clear();
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createDeadDeclEliminationPass() {
+        return std::make_unique< DeadDeclElimination >();
+    }
+
+} // namespace vast::hl
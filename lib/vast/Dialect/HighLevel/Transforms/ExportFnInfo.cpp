@@ -17,6 +17,9 @@ VAST_UNRELAX_WARNINGS
 #include <vast/Util/Symbols.hpp>
 #include <vast/Util/TypeSwitch.hpp>
 
+#include <algorithm>
+#include <vector>
+
 namespace vast::hl
 {
     llvm::json::Object json_type_entry(const mlir::DataLayout &dl, mlir::Type type);
@@ -208,46 +211,80 @@ namespace vast::hl
         return type_entry(dl, type).take();
     }
 
-    struct ExportFnInfo : ExportFnInfoBase< ExportFnInfo > {
-        void runOnOperation() override {
-            mlir::ModuleOp mod = this->getOperation();
-
-            llvm::json::Object top;
-
-            // TODO use FunctionOpInterface instead of specific operation
-            util::functions(mod, [&](FuncOp fn) {
-                const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
-                const auto &dl          = dl_analysis.getAtOrAbove(mod);
-
-                llvm::json::Array args;
-                for (auto &arg_type : fn.getArgumentTypes()) {
-                    args.push_back(json_type_entry(dl, arg_type));
-                }
+    //
+    // type entries are shared by all functions of the module
+    //
+    struct TypeEntryCache {
+        const mlir::DataLayout &dl;
+        llvm::DenseMap< mlir::Type, llvm::json::Value > entries;
 
-                llvm::json::Array rets;
-                for (auto &ret_type : fn.getResultTypes()) {
-                    rets.push_back(json_type_entry(dl, ret_type));
-                }
+        explicit TypeEntryCache(const mlir::DataLayout &dl) : dl(dl) {}
 
-                llvm::json::Object current;
-                current["rets"] = std::move(rets);
-                current["args"] = std::move(args);
+        const llvm::json::Value &get(mlir::Type type) {
+            if (auto it = entries.find(type); it != entries.end()) {
+                return it->second;
+            }
 
-                top[fn.getName().str()] = std::move(current);
-            });
+            return entries.try_emplace(type, json_type_entry(dl, type)).first->second;
+        }
+    };
 
-            auto value = llvm::formatv("{0:2}", llvm::json::Value(std::move(top)));
+    struct ExportFnInfo : ExportFnInfoBase< ExportFnInfo > {
+        void runOnOperation() override {
             // If destination filename was supplied by the user.
             if (!this->o.empty()) {
                 std::error_code ec;
 
                 llvm::raw_fd_ostream out(this->o, ec, llvm::sys::fs::OF_Text);
                 VAST_ASSERT(!ec);
-                out << std::move(value);
+                emit(out);
             } else {
-                llvm::outs() << std::move(value);
+                emit(llvm::outs());
             }
         }
+
+        // Streams the entries, so that the document of the whole module is
+        // never materialized. Functions are emitted in the order of their
+        // names, as the keys of a json object are when it is printed.
+        void emit(llvm::raw_ostream &os) {
+            mlir::ModuleOp mod = this->getOperation();
+
+            const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
+            TypeEntryCache types(dl_analysis.getAtOrAbove(mod));
+
+            // TODO use FunctionOpInterface instead of specific operation
+            std::vector< std::pair< llvm::StringRef, FuncOp > > fns;
+            util::functions(mod, [&](FuncOp fn) { fns.emplace_back(fn.getName(), fn); });
+
+            // Later functions of the same name take precedence.
+            std::stable_sort(fns.begin(), fns.end(), [] (const auto &a, const auto &b) {
+                return a.first < b.first;
+            });
+
+            llvm::json::OStream json(os, 2);
+            json.object([&] {
+                for (auto it = fns.begin(); it != fns.end(); ++it) {
+                    if (std::next(it) != fns.end() && std::next(it)->first == it->first) {
+                        continue;
+                    }
+
+                    auto fn = it->second;
+                    json.attributeObject(it->first, [&] {
+                        json.attributeArray("args", [&] {
+                            for (auto arg_type : fn.getArgumentTypes()) {
+                                json.value(types.get(arg_type));
+                            }
+                        });
+
+                        json.attributeArray("rets", [&] {
+                            for (auto ret_type : fn.getResultTypes()) {
+                                json.value(types.get(ret_type));
+                            }
+                        });
+                    });
+                }
+            });
+        }
     };
 
 } // namespace vast::hl
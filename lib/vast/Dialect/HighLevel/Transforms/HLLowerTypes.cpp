@@ -23,6 +23,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/Common/Types.hpp"
 
 #include "vast/Util/Maybe.hpp"
+#include "vast/Util/PatternStats.hpp"
 #include "vast/Util/TypeUtils.hpp"
 
 #include "vast/Conversion/TypeConverters/DataLayout.hpp"
@@ -40,12 +41,59 @@ namespace vast::hl
         using lower_type = conv::tc::hl_type_converting_pattern< type_converter_t >;
     } // namespace pattern
 
+    namespace {
+
+        bool has_const_qualifier(mlir_type type) {
+            bool is_const = false;
+            type.walkImmediateSubElements(
+                [&] (mlir::Attribute attr) {
+                    if (auto quals = mlir::dyn_cast< ConstQualifierInterface >(attr)) {
+                        is_const |= quals.hasConst();
+                    }
+                },
+                [] (mlir_type) {}
+            );
+            return is_const;
+        }
+
+        // Arrays are const if their elements are.
+        bool is_const_qualified(mlir_type type) {
+            if (has_const_qualifier(type)) {
+                return true;
+            }
+
+            if (auto elaborated = mlir::dyn_cast< ElaboratedType >(type)) {
+                return is_const_qualified(elaborated.getElementType());
+            }
+
+            if (auto array = mlir::dyn_cast< ArrayType >(type)) {
+                return is_const_qualified(array.getElementType());
+            }
+
+            return false;
+        }
+
+        // Lowered types do not have qualifiers, therefore the constness of
+        // objects of static storage duration is kept on their declarations.
+        void mark_constant_storage(operation root) {
+            root->walk([] (VarDeclOp var) {
+                auto type = mlir::dyn_cast< LValueType >(var.getType());
+                if (type && var.hasGlobalStorage() && is_const_qualified(type.getElementType())) {
+                    set_constant_storage(var);
+                }
+            });
+        }
+
+    } // namespace
+
     struct HLLowerTypesPass : HLLowerTypesBase< HLLowerTypesPass >
     {
         void runOnOperation() override {
             auto op    = this->getOperation();
             auto &mctx = this->getContext();
 
+            mark_constant_storage(op);
+
             const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
             type_converter_t type_converter(dl_analysis.getAtOrAbove(op), mctx);
 
@@ -56,6 +104,7 @@ namespace vast::hl
             mlir::RewritePatternSet patterns(&mctx);
 
             patterns.add< pattern::lower_type >(type_converter, mctx);
+            count_pattern_applications(patterns, getArgument());
 
             if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns)))) {
                 return signalPassFailure();
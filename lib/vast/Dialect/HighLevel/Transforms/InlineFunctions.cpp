@@ -0,0 +1,302 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/IRMapping.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Interfaces/CallInterfaces.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/FormatVariadic.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Analysis/CallGraph.hpp"
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/Core/CoreTraits.hpp"
+#include "vast/Dialect/Core/Linkage.hpp"
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Functions every translation unit that uses them defines, i.e.,
+        // `static` and `inline` functions.
+        bool has_inlinable_linkage(hl::FuncOp fn) {
+            using linkage = core::GlobalLinkageKind;
+            switch (fn.getLinkage()) {
+                case linkage::InternalLinkage:
+                case linkage::PrivateLinkage:
+                case linkage::LinkOnceAnyLinkage:
+                case linkage::LinkOnceODRLinkage:
+                case linkage::AvailableExternallyLinkage:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        template< typename attr_t >
+        bool has_attr_of_type(operation op) {
+            return llvm::any_of(op->getAttrs(), [] (mlir::NamedAttribute attr) {
+                return mlir::isa< attr_t >(attr.getValue());
+            });
+        }
+
+        // Operations inlining would duplicate or break: labels are unique in
+        // a function, static locals are shared by all the calls.
+        bool prevents_inlining(operation op) {
+            if (mlir::isa< hl::GotoStmt, hl::IndirectGotoStmt, hl::LabelStmt, hl::LabelDeclOp >(op)) {
+                return true;
+            }
+
+            if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                return var.isStaticLocal();
+            }
+
+            return false;
+        }
+
+    } // namespace
+
+    //
+    // Inlines calls of small `static` and `inline` functions. A function is
+    // inlined if it is not `noinline`, it is not recursive, its only return
+    // ends its body, and its body has at most `threshold` operations, unless
+    // it is `always_inline`.
+    //
+    // The body of the callee replaces the call by an `hl.stmt.expr`, which
+    // declares the parameters as variables initialized by the arguments and
+    // yields the returned value, or by a `core.scope` if the callee returns
+    // nothing. Variables of the inlined body are renamed after the callee
+    // and the inlined call, so that they do not clash with the variables of
+    // the caller or of other inlined calls.
+    //
+    // Callees are processed before their callers, so that calls inlined into
+    // a callee are inlined transitively. Inlined functions that are not
+    // referenced anymore are erased.
+    //
+    struct InlineFunctions : InlineFunctionsBase< InlineFunctions >
+    {
+        using base = InlineFunctionsBase< InlineFunctions >;
+
+        // Costs of the callees, `std::nullopt` if the callee can not be inlined.
+        llvm::DenseMap< operation, std::optional< std::size_t > > costs;
+
+        // Number of calls inlined by the run of the pass.
+        std::size_t inlined_calls = 0;
+
+        std::string inlined_name(hl::FuncOp callee, string_ref name) const {
+            return llvm::formatv("{0}.{1}.{2}", callee.getSymName(), name, inlined_calls).str();
+        }
+
+        std::optional< std::size_t > cost(hl::FuncOp fn, const analysis::call_graph &graph) {
+            if (auto it = costs.find(fn); it != costs.end()) {
+                return it->second;
+            }
+
+            auto result = compute_cost(fn, graph);
+            costs[fn] = result;
+            return result;
+        }
+
+        std::optional< std::size_t > compute_cost(hl::FuncOp fn, const analysis::call_graph &graph) {
+            if (fn.isDeclaration() || fn.isVarArg() || !fn.getBody().hasOneBlock()) {
+                return std::nullopt;
+            }
+
+            if (has_attr_of_type< hl::NoInlineAttr >(fn)) {
+                return std::nullopt;
+            }
+
+            auto always = has_attr_of_type< hl::AlwaysInlineAttr >(fn);
+            if (!always && !has_inlinable_linkage(fn)) {
+                return std::nullopt;
+            }
+
+            if (is_recursive(fn, graph)) {
+                return std::nullopt;
+            }
+
+            auto &entry = fn.getBody().front();
+            std::size_t ops = 0;
+            std::size_t returns = 0;
+            auto result = fn.getBody().walk([&] (operation op) {
+                ++ops;
+                if (core::is_return(op)) {
+                    if (op->getBlock() != &entry || ++returns > 1) {
+                        return mlir::WalkResult::interrupt();
+                    }
+                }
+
+                if (prevents_inlining(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+
+                return mlir::WalkResult::advance();
+            });
+
+            if (result.wasInterrupted() || returns != 1) {
+                return std::nullopt;
+            }
+
+            return always ? 0 : ops;
+        }
+
+        static bool is_recursive(hl::FuncOp fn, const analysis::call_graph &graph) {
+            auto node = graph.node(fn);
+            if (node == analysis::call_graph::no_node) {
+                return true;
+            }
+
+            llvm::SmallVector< analysis::call_graph::node_id > callees;
+            for (auto edge : graph.callees(node)) {
+                callees.push_back(edge.node);
+            }
+            return graph.reachable(callees).test(node);
+        }
+
+        static operation return_of(hl::FuncOp fn) {
+            for (auto &op : fn.getBody().front()) {
+                if (core::is_return(&op)) {
+                    return &op;
+                }
+            }
+            return nullptr;
+        }
+
+        void inline_call(hl::CallOp call, hl::FuncOp callee) {
+            auto mctx = &getContext();
+            auto loc  = call.getLoc();
+            auto &entry = callee.getBody().front();
+            auto ret = return_of(callee);
+
+            auto region = std::make_unique< mlir::Region >();
+            auto block  = new mlir::Block();
+            region->push_back(block);
+
+            mlir::OpBuilder bld(mctx);
+            bld.setInsertionPointToStart(block);
+
+            mlir::IRMapping mapping;
+            for (auto [idx, arg] : llvm::enumerate(entry.getArguments())) {
+                auto init = [&, operand = call.getArgOperands()[idx]] (auto &bld, auto loc) {
+                    bld.template create< hl::ValueYieldOp >(loc, operand);
+                };
+
+                auto name = inlined_name(callee, "arg" + std::to_string(idx));
+                auto var = bld.create< hl::VarDeclOp >(loc, arg.getType(), name, init);
+                mapping.map(arg, var.getResult());
+            }
+
+            for (auto &op : entry) {
+                if (&op == ret) {
+                    break;
+                }
+
+                bld.clone(op, mapping)->walk([&] (hl::VarDeclOp var) {
+                    var.setName(inlined_name(callee, var.getName()));
+                });
+            }
+
+            // Calls of functions that return nothing have no value to yield.
+            if (ret->getNumOperands() == 0) {
+                bld.setInsertionPoint(call);
+                auto scope = bld.create< core::ScopeOp >(loc);
+                scope.getBody().takeBody(*region);
+                call.erase();
+                return;
+            }
+
+            auto value = mapping.lookupOrDefault(ret->getOperand(0));
+            bld.create< hl::ValueYieldOp >(loc, value);
+
+            bld.setInsertionPoint(call);
+            auto type = call.getNumResults() != 0 ? call.getResult(0).getType() : value.getType();
+            auto expr = bld.create< hl::StmtExprOp >(loc, type, std::move(region));
+
+            if (call.getNumResults() != 0) {
+                call.getResult(0).replaceAllUsesWith(expr.getResult());
+            }
+            call.erase();
+        }
+
+        void runOnOperation() override
+        {
+            auto mod = getOperation();
+            costs.clear();
+            inlined_calls = 0;
+
+            analysis::call_graph graph(mod);
+
+            llvm::DenseSet< operation > inlined;
+            graph.post_order([&] (analysis::call_graph::node_id node) {
+                auto caller = mlir::dyn_cast< hl::FuncOp >(graph.function(node).getOperation());
+                if (!caller || caller.isDeclaration()) {
+                    return;
+                }
+
+                llvm::SmallVector< hl::CallOp > calls;
+                caller.walk([&] (hl::CallOp call) { calls.push_back(call); });
+
+                for (auto call : calls) {
+                    auto target = graph.node(call.getCallee());
+                    if (target == analysis::call_graph::no_node || target == node) {
+                        continue;
+                    }
+
+                    auto callee = mlir::dyn_cast< hl::FuncOp >(graph.function(target).getOperation());
+                    if (!callee || call.getNumOperands() != callee.getNumArguments()) {
+                        continue;
+                    }
+
+                    auto cost = this->cost(callee, graph);
+                    if (!cost || *cost > threshold) {
+                        continue;
+                    }
+
+                    inline_call(call, callee);
+                    inlined.insert(callee);
+                    ++inlined_calls;
+                }
+            });
+
+            if (inlined.empty()) {
+                return;
+            }
+
+            // Functions referenced by symbol, e.g., by calls that were not
+            // inlined or by taking their address.
+            llvm::DenseSet< mlir::StringAttr > referenced;
+            if (auto uses = mlir::SymbolTable::getSymbolUses(&mod.getBodyRegion())) {
+                for (const auto &use : *uses) {
+                    referenced.insert(use.getSymbolRef().getRootReference());
+                }
+            }
+
+            for (auto op : inlined) {
+                auto fn = mlir::cast< hl::FuncOp >(op);
+                if (!has_inlinable_linkage(fn) || fn->hasAttr("used")) {
+                    continue;
+                }
+
+                if (!referenced.contains(fn.getSymNameAttr())) {
+                    fn.erase();
+                }
+            }
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createInlineFunctionsPass()
+    {
+        return std::make_unique< InlineFunctions >();
+    }
+} // namespace vast::hl
@@ -0,0 +1,305 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinAttributes.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/Core/CoreTraits.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        constexpr auto coverage_attr_name = "vast.coverage";
+
+        // Counters of derived edges.
+        constexpr std::int64_t derived = -1;
+
+        bool is_loop(operation op) {
+            return mlir::isa< hl::WhileOp, hl::ForOp, hl::DoOp >(op);
+        }
+
+        // Whether the control may leave the operation other than by falling
+        // through it, e.g., by a return or a break of an enclosing loop.
+        bool may_escape(operation root) {
+            auto escapes = [root] (operation op, auto &&is_target) {
+                auto target = op->getParentOp();
+                while (target && !is_target(target)) {
+                    target = target->getParentOp();
+                }
+                return !target || (target != root && !root->isProperAncestor(target));
+            };
+
+            auto result = root->walk([&] (operation op) {
+                if (core::is_return(op) || mlir::isa< hl::GotoStmt, hl::IndirectGotoStmt >(op)) {
+                    return mlir::WalkResult::interrupt();
+                }
+
+                if (mlir::isa< hl::BreakOp >(op)) {
+                    auto breaks = [] (operation t) { return is_loop(t) || mlir::isa< hl::SwitchOp >(t); };
+                    if (escapes(op, breaks)) {
+                        return mlir::WalkResult::interrupt();
+                    }
+                }
+
+                if (mlir::isa< hl::ContinueOp >(op) && escapes(op, is_loop)) {
+                    return mlir::WalkResult::interrupt();
+                }
+
+                return mlir::WalkResult::advance();
+            });
+
+            return result.wasInterrupted();
+        }
+
+        bool may_escape(mlir::Region &region) {
+            for (auto &block : region) {
+                for (auto &op : block) {
+                    if (may_escape(&op)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // Point the increment of a counter is inserted before, the end of
+        // the block if there is no operation.
+        struct probe_site
+        {
+            mlir::Block *block;
+            operation before;
+            loc_t loc;
+        };
+
+    } // namespace
+
+    //
+    // Inserts counters of the edges of structured control flow: the entry of
+    // a function, the branches of `hl.if`, the bodies and the exits of loops,
+    // and the cases and the exit of `hl.switch`. Every counter is an element
+    // of a single module array incremented in place by HL operations, so the
+    // probes are lowered with the rest of the code and cost a load, an add
+    // and a store each.
+    //
+    // The minimal mode places counters on the chords of the spanning tree
+    // of the structured control flow, i.e., it omits counters of edges whose
+    // counts follow from the conservation of the flow: the else branch of an
+    // `hl.if` is derived from the count of its parent, and the exit of a loop
+    // or a switch equals its entry if the control can not escape its body.
+    // Counts are known at a point as long as no preceding operation of the
+    // region could have left the region. Derived edges are marked by `-1` in
+    // the `vast.coverage` attribute of the instrumented operations.
+    //
+    struct InstrumentCoverage : InstrumentCoverageBase< InstrumentCoverage >
+    {
+        using base = InstrumentCoverageBase< InstrumentCoverage >;
+
+        std::vector< probe_site > sites;
+
+        std::int64_t probe(mlir::Block &block, operation before, loc_t loc) {
+            sites.push_back({ &block, before, loc });
+            return std::int64_t(sites.size() - 1);
+        }
+
+        std::int64_t probe_entry(mlir::Region &region, loc_t loc) {
+            if (region.empty()) {
+                region.emplaceBlock();
+            }
+            auto &block = region.front();
+            return probe(block, block.empty() ? nullptr : &block.front(), loc);
+        }
+
+        std::int64_t probe_exit(operation op) {
+            return probe(*op->getBlock(), op->getNextNode(), op->getLoc());
+        }
+
+        static void annotate(operation op, llvm::ArrayRef< std::int64_t > counters) {
+            op->setAttr(coverage_attr_name, mlir::DenseI64ArrayAttr::get(op->getContext(), counters));
+        }
+
+        // Visits the operations of the region given whether the count at its
+        // entry is known, and yields whether it is known at its end.
+        bool visit(mlir::Region &region, bool known) {
+            known = known && region.hasOneBlock();
+            for (auto &block : region) {
+                for (auto &op : llvm::make_early_inc_range(block)) {
+                    known = visit(&op, known);
+                }
+            }
+            return known;
+        }
+
+        // Exit of a loop or a switch.
+        std::int64_t exit_counter(operation op, bool known) {
+            if (minimal && known && !may_escape(op)) {
+                return derived;
+            }
+            return probe_exit(op);
+        }
+
+        bool visit(operation op, bool known) {
+            return llvm::TypeSwitch< operation, bool >(op)
+                .Case([&] (hl::IfOp if_op) {
+                    auto &cond = if_op.getCondRegion();
+                    visit(cond, false);
+
+                    auto then_counter = probe_entry(if_op.getThenRegion(), op->getLoc());
+                    visit(if_op.getThenRegion(), true);
+
+                    // The else branch is probed even if empty.
+                    auto else_counter = derived;
+                    if (!minimal || !known || may_escape(cond)) {
+                        else_counter = probe_entry(if_op.getElseRegion(), op->getLoc());
+                    }
+                    visit(if_op.getElseRegion(), true);
+
+                    annotate(op, { then_counter, else_counter });
+                    return known && !may_escape(op);
+                })
+                .Case([&] (hl::WhileOp loop) {
+                    visit(loop.getCondRegion(), false);
+                    auto body = probe_entry(loop.getBodyRegion(), op->getLoc());
+                    visit(loop.getBodyRegion(), true);
+                    annotate(op, { body, exit_counter(op, known) });
+                    return true;
+                })
+                .Case([&] (hl::ForOp loop) {
+                    visit(loop.getCondRegion(), false);
+                    visit(loop.getIncrRegion(), false);
+                    auto body = probe_entry(loop.getBodyRegion(), op->getLoc());
+                    visit(loop.getBodyRegion(), true);
+                    annotate(op, { body, exit_counter(op, known) });
+                    return true;
+                })
+                .Case([&] (hl::DoOp loop) {
+                    auto body = probe_entry(loop.getBodyRegion(), op->getLoc());
+                    visit(loop.getBodyRegion(), true);
+                    visit(loop.getCondRegion(), false);
+                    annotate(op, { body, exit_counter(op, known) });
+                    return true;
+                })
+                .Case([&] (hl::SwitchOp sw) {
+                    visit(sw.getCondRegion(), false);
+
+                    llvm::SmallVector< std::int64_t > cases;
+                    for (auto &region : sw.getCases()) {
+                        for (auto &nested : region.getOps()) {
+                            if (mlir::isa< hl::CaseOp, hl::DefaultOp >(nested)) {
+                                auto &body = nested.getRegions().back();
+                                cases.push_back(probe_entry(body, nested.getLoc()));
+                            }
+                        }
+                        visit(region, false);
+                    }
+
+                    cases.push_back(exit_counter(op, known));
+                    annotate(op, cases);
+                    return true;
+                })
+                .Case([&] (hl::CaseOp c) {
+                    visit(c.getBody(), true);
+                    return false;
+                })
+                .Case([&] (hl::DefaultOp d) {
+                    visit(d.getBody(), true);
+                    return false;
+                })
+                .Case([&] (core::ScopeOp scope) {
+                    return visit(scope.getBody(), known);
+                })
+                .Default([&] (operation) {
+                    if (core::is_return(op) || mlir::isa< hl::GotoStmt, hl::IndirectGotoStmt, hl::BreakOp, hl::ContinueOp >(op)) {
+                        return false;
+                    }
+
+                    // Labels are entered by jumps, lazy regions may or may
+                    // not be executed.
+                    for (auto &region : op->getRegions()) {
+                        visit(region, false);
+                    }
+                    return known && !mlir::isa< hl::LabelStmt >(op) && !may_escape(op);
+                });
+        }
+
+        void instrument(hl::FuncOp fn) {
+            auto &body = fn.getBody();
+            annotate(fn, { probe_entry(body, fn.getLoc()) });
+            visit(body, true);
+        }
+
+        void runOnOperation() override
+        {
+            auto mod = getOperation();
+            auto mctx = &getContext();
+            sites.clear();
+
+            string_ref name = counters.getValue();
+            for (auto var : mod.getOps< hl::VarDeclOp >()) {
+                if (var.getName() == name) {
+                    mod.emitError() << "coverage counters '" << name << "' are already defined";
+                    return signalPassFailure();
+                }
+            }
+
+            llvm::SmallVector< hl::FuncOp > functions;
+            mod.walk([&] (hl::FuncOp fn) {
+                if (!fn.isDeclaration()) {
+                    functions.push_back(fn);
+                }
+            });
+
+            for (auto fn : functions) {
+                instrument(fn);
+            }
+
+            if (sites.empty()) {
+                return;
+            }
+
+            auto counter_ty = hl::LongLongType::get(mctx, hl::UCVQualifiersAttr::get(mctx, true, false, false));
+            auto array_ty   = hl::ArrayType::get(mctx, SizeParam(sites.size()), counter_ty);
+
+            // Counters of static storage are zero initialized.
+            auto bld = mlir::OpBuilder::atBlockBegin(mod.getBody());
+            auto array_lty = hl::LValueType::get(mctx, array_ty);
+            auto var = bld.create< hl::VarDeclOp >(mod.getLoc(), array_lty, name);
+            if (per_thread) {
+                var.setThreadStorageClass(hl::TSClass::tsc_c_thread);
+            }
+
+            auto counter_lty = hl::LValueType::get(mctx, counter_ty);
+            auto symbol      = mlir::StringAttr::get(mctx, name);
+
+            for (auto [id, site] : llvm::enumerate(sites)) {
+                if (site.before) {
+                    bld.setInsertionPoint(site.before);
+                } else {
+                    bld.setInsertionPointToEnd(site.block);
+                }
+
+                auto ref = bld.create< hl::GlobalRefOp >(site.loc, array_lty, symbol);
+                auto idx = bld.create< hl::ConstantOp >(site.loc, counter_ty, llvm::APSInt(llvm::APInt(64, id), true));
+                auto counter = bld.create< hl::SubscriptOp >(site.loc, counter_lty, ref, idx);
+                bld.create< hl::PreIncOp >(site.loc, counter_ty, counter);
+            }
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createInstrumentCoveragePass()
+    {
+        return std::make_unique< InstrumentCoverage >();
+    }
+} // namespace vast::hl
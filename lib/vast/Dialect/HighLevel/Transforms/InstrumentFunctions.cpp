@@ -0,0 +1,279 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/BitVector.h>
+#include <llvm/Support/Regex.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Analysis/CallGraph.hpp"
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/Core/CoreTraits.hpp"
+#include "vast/Dialect/Core/CoreTypes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/LowLevel/LowLevelOps.hpp"
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        constexpr auto instrumented_attr_name = "vast.instrumented_functions";
+
+        // Function attributes the lowering to llvm passes through.
+        constexpr auto passthrough_attr_name = "passthrough";
+
+        enum class instrument_mode { call, xray, sampled };
+
+        std::optional< instrument_mode > parse_mode(string_ref mode) {
+            if (mode == "call")    return instrument_mode::call;
+            if (mode == "xray")    return instrument_mode::xray;
+            if (mode == "sampled") return instrument_mode::sampled;
+            return std::nullopt;
+        }
+
+    } // namespace
+
+    //
+    // Inserts entry and exit hooks into function definitions:
+    //
+    //   - `call` calls `enter-hook(id)` at the entry and `exit-hook(id)`
+    //     before every return, where `id` is the index of the function in the
+    //     `vast.instrumented_functions` attribute of the module,
+    //   - `xray` marks the functions by `function-instrument = xray-always`,
+    //     so that llvm emits XRay sleds of nops, which the XRay runtime
+    //     patches into calls of its handlers when tracing is enabled,
+    //   - `sampled` counts entries of every function in the module array
+    //     `<enter-hook>_samples`, and calls the entry hook on every
+    //     `sample-period`-th entry. Exits are not sampled.
+    //
+    // Functions are selected by the `filter` regular expression of their
+    // names, and by reachability in the call graph from the `roots`.
+    //
+    struct InstrumentFunctions : InstrumentFunctionsBase< InstrumentFunctions >
+    {
+        using base = InstrumentFunctionsBase< InstrumentFunctions >;
+
+        mlir_type id_type() {
+            auto mctx = &getContext();
+            return hl::IntType::get(mctx, hl::UCVQualifiersAttr::get(mctx, true, false, false));
+        }
+
+        void declare_hook(vast_module mod, string_ref name) {
+            if (mlir::SymbolTable::lookupSymbolIn(mod, name)) {
+                return;
+            }
+
+            auto mctx = &getContext();
+            auto type = core::FunctionType::get({ id_type() }, { hl::VoidType::get(mctx) }, false);
+            auto bld  = mlir::OpBuilder::atBlockEnd(mod.getBody());
+            bld.create< hl::FuncOp >(mod.getLoc(), name, type);
+        }
+
+        mlir_value make_id(mlir::OpBuilder &bld, loc_t loc, std::uint64_t id) {
+            return bld.create< hl::ConstantOp >(loc, id_type(), llvm::APSInt(llvm::APInt(32, id), true));
+        }
+
+        void call_hook(mlir::OpBuilder &bld, loc_t loc, string_ref hook, std::uint64_t id) {
+            auto mctx = &getContext();
+            bld.create< hl::CallOp >(
+                loc, hook, mlir::TypeRange{ hl::VoidType::get(mctx) }, mlir::ValueRange{ make_id(bld, loc, id) }
+            );
+        }
+
+        void instrument_calls(mlir::FunctionOpInterface fn, std::uint64_t id) {
+            auto &body = fn.getFunctionBody();
+            auto bld = mlir::OpBuilder::atBlockBegin(&body.front());
+            call_hook(bld, fn.getLoc(), enter_hook, id);
+
+            llvm::SmallVector< operation > returns;
+            fn->walk([&] (operation op) {
+                auto returns_from_fn = op->hasTrait< mlir::OpTrait::ReturnLike >()
+                    && op->getParentRegion() == &body;
+                if (core::is_return(op) || returns_from_fn) {
+                    returns.push_back(op);
+                }
+            });
+
+            for (auto ret : returns) {
+                bld.setInsertionPoint(ret);
+                call_hook(bld, ret->getLoc(), exit_hook, id);
+            }
+        }
+
+        // ++samples[id] & (period - 1) ? : enter(id)
+        void instrument_sampled(mlir::FunctionOpInterface fn, std::uint64_t id, mlir_type samples_type) {
+            auto mctx = &getContext();
+
+            auto counter_ty  = id_type();
+            auto samples_lty = hl::LValueType::get(mctx, samples_type);
+            auto counter_lty = hl::LValueType::get(mctx, counter_ty);
+            auto samples     = mlir::StringAttr::get(mctx, samples_name());
+
+            auto cond = [&] (auto &bld, auto loc) {
+                auto ref = bld.template create< hl::GlobalRefOp >(loc, samples_lty, samples);
+                auto counter = bld.template create< hl::SubscriptOp >(loc, counter_lty, ref, make_id(bld, loc, id));
+                auto count = bld.template create< hl::PreIncOp >(loc, counter_ty, counter);
+                auto mask  = make_id(bld, loc, sample_period - 1);
+                auto bits  = bld.template create< hl::BinAndOp >(loc, counter_ty, count, mask);
+                auto zero  = make_id(bld, loc, 0);
+                auto taken = bld.template create< hl::CmpOp >(
+                    loc, hl::IntType::get(mctx), hl::Predicate::eq, bits, zero
+                );
+                bld.template create< hl::CondYieldOp >(loc, taken);
+            };
+
+            auto then = [&] (auto &bld, auto loc) { call_hook(bld, loc, enter_hook, id); };
+
+            auto bld = mlir::OpBuilder::atBlockBegin(&fn.getFunctionBody().front());
+            bld.create< hl::IfOp >(fn.getLoc(), cond, then);
+        }
+
+        std::string samples_name() const { return enter_hook + "_samples"; }
+
+        // Functions selected by the filter and the roots.
+        llvm::SmallVector< mlir::FunctionOpInterface > select(vast_module mod) {
+            std::optional< llvm::Regex > regex;
+            if (!filter.empty()) {
+                std::string error;
+                regex.emplace(filter);
+                if (!regex->isValid(error)) {
+                    mod.emitError() << "invalid function filter '" << filter << "': " << error;
+                    signalPassFailure();
+                    return {};
+                }
+            }
+
+            std::optional< llvm::BitVector > reachable;
+            std::optional< analysis::call_graph > graph;
+            if (!roots.empty()) {
+                graph.emplace(mod);
+                llvm::SmallVector< analysis::call_graph::node_id > nodes;
+                for (const auto &root : roots) {
+                    if (auto node = graph->node(root); node != analysis::call_graph::no_node) {
+                        nodes.push_back(node);
+                    }
+                }
+                reachable = graph->reachable(nodes);
+            }
+
+            llvm::SmallVector< mlir::FunctionOpInterface > selected;
+            mod.walk([&] (mlir::FunctionOpInterface fn) {
+                if (!mlir::isa< hl::FuncOp, ll::FuncOp >(fn) || fn.isExternal()) {
+                    return;
+                }
+
+                auto name = fn.getName();
+                if (name == enter_hook || name == exit_hook) {
+                    return;
+                }
+
+                if (regex && !regex->match(name)) {
+                    return;
+                }
+
+                if (reachable) {
+                    auto node = graph->node(fn);
+                    if (node == analysis::call_graph::no_node || !reachable->test(node)) {
+                        return;
+                    }
+                }
+
+                selected.push_back(fn);
+            });
+
+            return selected;
+        }
+
+        void runOnOperation() override
+        {
+            auto mod  = getOperation();
+            auto mctx = &getContext();
+
+            auto kind = parse_mode(mode);
+            if (!kind) {
+                mod.emitError() << "unknown function instrumentation mode '" << mode << "'";
+                return signalPassFailure();
+            }
+
+            if (*kind == instrument_mode::sampled && !llvm::isPowerOf2_32(sample_period)) {
+                mod.emitError() << "sample period has to be a power of two, got " << sample_period.getValue();
+                return signalPassFailure();
+            }
+
+            auto functions = select(mod);
+            if (functions.empty()) {
+                return;
+            }
+
+            llvm::SmallVector< mlir::Attribute > names;
+            for (auto fn : functions) {
+                names.push_back(mlir::StringAttr::get(mctx, fn.getName()));
+            }
+            mod->setAttr(instrumented_attr_name, mlir::ArrayAttr::get(mctx, names));
+
+            switch (*kind) {
+                case instrument_mode::call: {
+                    declare_hook(mod, enter_hook);
+                    declare_hook(mod, exit_hook);
+                    for (auto [id, fn] : llvm::enumerate(functions)) {
+                        instrument_calls(fn, id);
+                    }
+                    break;
+                }
+
+                case instrument_mode::xray: {
+                    auto xray = mlir::ArrayAttr::get(mctx, {
+                        mlir::StringAttr::get(mctx, "function-instrument"),
+                        mlir::StringAttr::get(mctx, "xray-always")
+                    });
+
+                    for (auto fn : functions) {
+                        llvm::SmallVector< mlir::Attribute > attrs;
+                        if (auto passthrough = fn->getAttrOfType< mlir::ArrayAttr >(passthrough_attr_name)) {
+                            attrs.append(passthrough.begin(), passthrough.end());
+                        }
+                        attrs.push_back(xray);
+                        fn->setAttr(passthrough_attr_name, mlir::ArrayAttr::get(mctx, attrs));
+                    }
+                    break;
+                }
+
+                case instrument_mode::sampled: {
+                    declare_hook(mod, enter_hook);
+
+                    // Counters of static storage are zero initialized.
+                    auto samples_type = hl::ArrayType::get(mctx, SizeParam(functions.size()), id_type());
+                    auto bld = mlir::OpBuilder::atBlockBegin(mod.getBody());
+                    bld.create< hl::VarDeclOp >(
+                        mod.getLoc(), hl::LValueType::get(mctx, samples_type), samples_name()
+                    );
+
+                    for (auto [id, fn] : llvm::enumerate(functions)) {
+                        if (!mlir::isa< hl::FuncOp >(fn)) {
+                            fn.emitWarning() << "sampled instrumentation requires hl.func, skipped";
+                            continue;
+                        }
+                        instrument_sampled(fn, id, samples_type);
+                    }
+                    break;
+                }
+            }
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createInstrumentFunctionsPass()
+    {
+        return std::make_unique< InstrumentFunctions >();
+    }
+} // namespace vast::hl
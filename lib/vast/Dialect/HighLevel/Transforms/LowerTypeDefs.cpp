@@ -3,14 +3,19 @@
 #include "vast/Dialect/HighLevel/Passes.hpp"
 
 VAST_RELAX_WARNINGS
+#include <mlir/Analysis/DataLayoutAnalysis.h>
 #include <mlir/Dialect/ControlFlow/IR/ControlFlowOps.h>
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 
 #include <mlir/Rewrite/FrozenRewritePatternSet.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+
+#include <llvm/ADT/StringMap.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Analysis/CallGraph.hpp"
+
 #include "vast/Conversion/Common/Passes.hpp"
 #include "vast/Conversion/Common/Patterns.hpp"
 #include "vast/Conversion/Common/Rewriter.hpp"
@@ -40,13 +45,44 @@ namespace vast::hl {
                 vast_module mod;
                 mcontext_t &mctx;
 
+                // Typedef names resolved to their bottom types, populated
+                // once from the module typedefs.
+                llvm::StringMap< mlir_type > resolved;
+
                 type_converter(mcontext_t &mctx, vast_module mod)
                     : conv::tc::base_type_converter(),
                       mod(mod), mctx(mctx)
                 {
+                    resolve_typedefs();
                     addConversion([&](mlir_type t) { return this->convert(t); });
                 }
 
+                void resolve_typedefs() {
+                    llvm::StringMap< mlir_type > declared;
+                    for (auto def : mod.getOps< hl::TypeDefOp >()) {
+                        declared[def.getName()] = def.getType();
+                    }
+
+                    for (const auto &entry : declared) {
+                        resolve(entry.getKey(), declared);
+                    }
+                }
+
+                mlir_type resolve(string_ref name, const llvm::StringMap< mlir_type > &declared) {
+                    if (auto it = resolved.find(name); it != resolved.end()) {
+                        return it->second;
+                    }
+
+                    auto type = declared.lookup(name);
+                    VAST_CHECK(type, "unknown typedef name: {0}", name);
+
+                    if (auto def = mlir::dyn_cast< hl::TypedefType >(hl::strip_elaborated(type))) {
+                        type = resolve(def.getName(), declared);
+                    }
+
+                    return resolved[name] = type;
+                }
+
                 maybe_types_t do_conversion(mlir_type type) {
                     types_t out;
                     if (mlir::succeeded(this->convertTypes(type, out))) {
@@ -55,9 +91,13 @@ namespace vast::hl {
                     return {};
                 }
 
-                // TODO(conv): This may need to be precomputed instead.
                 maybe_type_t nested_type(mlir_type type) {
-                    return hl::getBottomTypedefType(type, mod);
+                    if (auto def = mlir::dyn_cast< hl::TypedefType >(hl::strip_elaborated(type))) {
+                        auto it = resolved.find(def.getName());
+                        VAST_CHECK(it != resolved.end(), "unknown typedef name: {0}", def.getName());
+                        return it->second;
+                    }
+                    return type;
                 }
 
                 maybe_type_t convert(mlir_type type) {
@@ -111,14 +151,25 @@ namespace vast::hl {
             auto target    = create_conversion_target(mctx);
             vast_module op = getOperation();
 
+            // Typedef types name the typedefs of the module, without them
+            // there is nothing to lower.
+            if (op.getOps< hl::TypeDefOp >().empty()) {
+                return markAllAnalysesPreserved();
+            }
+
             rewrite_pattern_set patterns(&mctx);
 
             auto tc = pattern::type_converter(mctx, op);
             patterns.template add< pattern::resolve_typedef >(tc, mctx);
+            count_pattern_applications(patterns, getArgument());
 
             if (mlir::failed(mlir::applyPartialConversion(op, target, std::move(patterns)))) {
                 return signalPassFailure();
             }
+
+            // Operations are updated in place, but record fields change their
+            // types and typedefs are erased.
+            markAnalysesPreserved< mlir::DataLayoutAnalysis, analysis::call_graph >();
         }
     };
 
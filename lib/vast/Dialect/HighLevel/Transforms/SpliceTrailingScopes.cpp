@@ -73,6 +73,10 @@ namespace vast::hl
 
         void runOnOperation() override
         {
+            // The pass is nested on functions and its instance is reused by
+            // their runs, scopes of previous runs might be already erased.
+            to_splice.clear();
+
             auto op = getOperation();
             find(op);
             std::reverse(to_splice.begin(), to_splice.end());
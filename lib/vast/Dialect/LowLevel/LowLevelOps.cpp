@@ -24,6 +24,21 @@ namespace vast::ll
         return mlir::SuccessorOperands( getOperandsMutable() );
     }
 
+    logical_result Switch::verify()
+    {
+        if ( getCaseValues().size() != getCaseDests().size() )
+            return emitOpError( "expects one destination per case value" );
+
+        auto width = getValue().getType().getIntOrFloatBitWidth();
+        for ( auto value : getCaseValues() ) {
+            auto attr = mlir::dyn_cast< mlir::IntegerAttr >( value );
+            if ( !attr || attr.getValue().getBitWidth() != width )
+                return emitOpError( "expects integer case values of the value width" );
+        }
+
+        return mlir::success();
+    }
+
     // This is currently stolen from HighLevel/HighLevelOps.cpp.
     // Do we need a separate version?
 
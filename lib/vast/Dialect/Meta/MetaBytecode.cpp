@@ -0,0 +1,95 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeImplementation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Meta/MetaDialect.hpp"
+#include "vast/Dialect/Meta/MetaAttributes.hpp"
+
+#include "vast/Util/Common.hpp"
+
+//
+// Bytecode encoding of metadata attributes. Identifiers and source positions
+// are attached to most operations when locations are emitted as metadata,
+// hence they are encoded directly as variable-width integers instead of their
+// textual form.
+//
+// Codes are part of the bytecode format, new entries may only be appended.
+//
+namespace vast::meta
+{
+    namespace
+    {
+        enum class attr_code : std::uint64_t
+        {
+            identifier_attr      = 0,
+            source_position_attr = 1,
+        };
+
+    } // namespace
+
+    struct MetaBytecodeDialectInterface : mlir::BytecodeDialectInterface
+    {
+        using BytecodeDialectInterface::BytecodeDialectInterface;
+
+        using reader_t = mlir::DialectBytecodeReader;
+        using writer_t = mlir::DialectBytecodeWriter;
+
+        logical_result writeAttribute(mlir_attr attr, writer_t &writer) const final {
+            if (auto id = attr.dyn_cast< IdentifierAttr >()) {
+                writer.writeVarInt(std::uint64_t(attr_code::identifier_attr));
+                writer.writeVarInt(id.getValue());
+                return mlir::success();
+            }
+
+            if (auto pos = attr.dyn_cast< SourcePositionAttr >()) {
+                writer.writeVarInt(std::uint64_t(attr_code::source_position_attr));
+                writer.writeVarInt(pos.getFile());
+                writer.writeVarInt(pos.getLine());
+                writer.writeVarInt(pos.getColumn());
+                return mlir::success();
+            }
+
+            return mlir::failure();
+        }
+
+        mlir_attr readAttribute(reader_t &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            if (attr_code(code) == attr_code::identifier_attr) {
+                identifier_t value;
+                if (mlir::failed(reader.readVarInt(value))) {
+                    return {};
+                }
+                return IdentifierAttr::get(getContext(), value);
+            }
+
+            if (attr_code(code) == attr_code::source_position_attr) {
+                std::uint64_t file, line, column;
+                if (mlir::failed(reader.readVarInt(file))
+                    || mlir::failed(reader.readVarInt(line))
+                    || mlir::failed(reader.readVarInt(column))
+                ) {
+                    return {};
+                }
+                return SourcePositionAttr::get(
+                    getContext(), unsigned(file), unsigned(line), unsigned(column)
+                );
+            }
+
+            reader.emitError() << "unknown meta attribute code: " << code;
+            return {};
+        }
+    };
+
+    void MetaDialect::registerBytecodeInterface() {
+        addInterfaces< MetaBytecodeDialectInterface >();
+    }
+
+} // namespace vast::meta
@@ -5,6 +5,9 @@
 
 #include "vast/Util/Symbols.hpp"
 
+#include <algorithm>
+#include <atomic>
+
 namespace vast::meta
 {
     void MetaDialect::initialize() {
@@ -15,10 +18,17 @@ namespace vast::meta
             #define GET_OP_LIST
             #include "vast/Dialect/Meta/Meta.cpp.inc"
         >();
+
+        registerBytecodeInterface();
     }
 
     static constexpr std::string_view identifier_name = "meta_identifier";
 
+    unit_identifier_t make_unit_identifier() {
+        static std::atomic< unit_identifier_t > next_unit = 0;
+        return next_unit.fetch_add(1, std::memory_order_relaxed);
+    }
+
     void add_identifier(mlir::Operation *op, identifier_t id) {
         auto ctx = op->getContext();
         auto attr = IdentifierAttr::get(ctx, id);
@@ -29,41 +39,170 @@ namespace vast::meta
         op->removeAttr(identifier_name);
     }
 
-    bool has_identifier(mlir::Operation *op, identifier_t id) {
-        if (auto attr = op->getAttr(identifier_name)) {
-            if (attr.cast< IdentifierAttr >().getValue() == id) {
-                return true;
+    std::optional< identifier_t > get_identifier(mlir::Operation *op) {
+        if (auto attr = op->getAttrOfType< IdentifierAttr >(identifier_name)) {
+            return attr.getValue();
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional< identifier_t > get_meta_location(mlir::Operation *op) {
+        if (auto loc = op->getLoc().dyn_cast< mlir::FusedLoc >()) {
+            if (auto id = loc.getMetadata().dyn_cast_or_null< IdentifierAttr >()) {
+                return id.getValue();
             }
         }
 
-        return false;
+        return std::nullopt;
     }
 
+    // One-off queries walk the scope just like building the index does.
     std::vector< mlir::Operation * > get_with_identifier(mlir::Operation *scope, identifier_t id) {
-        std::vector< mlir::Operation * > result;
-        util::symbols(scope, [&] (auto symbol) {
-            if (has_identifier(symbol, id)) {
-                result.push_back(symbol);
+        auto ops = identifier_index(scope).with_identifier(id);
+        return { ops.begin(), ops.end() };
+    }
+
+    std::vector< mlir::Operation * > get_with_meta_location(mlir::Operation *scope, identifier_t id) {
+        auto ops = identifier_index(scope).with_meta_location(id);
+        return { ops.begin(), ops.end() };
+    }
+
+    identifier_index::identifier_index(mlir::Operation *scope) {
+        auto is_symbol = [] (mlir::Operation *op) {
+            return mlir::isa< util::vast_symbol_interface, util::mlir_symbol_interface >(op);
+        };
+
+        scope->walk([&] (mlir::Operation *op) {
+            if (auto id = get_identifier(op); id && is_symbol(op)) {
+                identifiers[*id].push_back(op);
+            }
+
+            if (auto id = get_meta_location(op)) {
+                locations[*id].push_back(op);
             }
         });
-        return result;
     }
 
-    std::vector< mlir::Operation * > get_with_meta_location(mlir::Operation *scope, IdentifierAttr id) {
-        std::vector< mlir::Operation * > result;
-        scope->walk([&](mlir::Operation *op) {
-            if (auto loc = op->getLoc().dyn_cast< mlir::FusedLoc >()) {
-                if (id == loc.getMetadata()) {
-                    result.push_back(op);
+    llvm::ArrayRef< mlir::Operation * > identifier_index::with_identifier(identifier_t id) const {
+        if (auto it = identifiers.find(id); it != identifiers.end()) {
+            return it->second;
+        }
+        return {};
+    }
+
+    llvm::ArrayRef< mlir::Operation * > identifier_index::with_meta_location(identifier_t id) const {
+        if (auto it = locations.find(id); it != locations.end()) {
+            return it->second;
+        }
+        return {};
+    }
+
+    void identifier_index::add(mlir::Operation *symbol, identifier_t id) {
+        remove(symbol);
+        add_identifier(symbol, id);
+        identifiers[id].push_back(symbol);
+    }
+
+    void identifier_index::remove(mlir::Operation *symbol) {
+        if (auto id = get_identifier(symbol)) {
+            if (auto it = identifiers.find(*id); it != identifiers.end()) {
+                llvm::erase_value(it->second, symbol);
+            }
+            remove_identifier(symbol);
+        }
+    }
+
+    unsigned add_source_file(mlir::ModuleOp mod, llvm::StringRef file) {
+        auto ctx = mod.getContext();
+
+        llvm::SmallVector< mlir::Attribute > files;
+        if (auto table = mod->getAttrOfType< mlir::ArrayAttr >(source_files_name)) {
+            files.append(table.begin(), table.end());
+        }
+
+        files.push_back(mlir::StringAttr::get(ctx, file));
+        mod->setAttr(source_files_name, mlir::ArrayAttr::get(ctx, files));
+        return files.size() - 1;
+    }
+
+    std::optional< llvm::StringRef > get_source_file(mlir::ModuleOp mod, unsigned file) {
+        if (auto table = mod->getAttrOfType< mlir::ArrayAttr >(source_files_name)) {
+            if (file < table.size()) {
+                if (auto name = table[file].dyn_cast< mlir::StringAttr >()) {
+                    return name.getValue();
                 }
             }
+        }
+
+        return std::nullopt;
+    }
+
+    location_index::location_index(mlir::Operation *scope) {
+        auto mod = mlir::dyn_cast< mlir::ModuleOp >(scope);
+        if (!mod) {
+            mod = scope->getParentOfType< mlir::ModuleOp >();
+        }
+
+        scope->walk([&] (mlir::Operation *op) {
+            auto add = [&] (llvm::StringRef file, unsigned line, unsigned column) {
+                auto &entries = files[file];
+                if (entries.empty() || entries.back().op != op
+                    || entries.back().line != line || entries.back().column != column
+                ) {
+                    entries.push_back({ line, column, op });
+                }
+            };
+
+            op->getLoc()->walk([&] (mlir::Location loc) {
+                if (auto file_loc = loc.dyn_cast< mlir::FileLineColLoc >()) {
+                    add(file_loc.getFilename(), file_loc.getLine(), file_loc.getColumn());
+                } else if (auto fused = loc.dyn_cast< mlir::FusedLoc >()) {
+                    auto pos = fused.getMetadata().dyn_cast_or_null< SourcePositionAttr >();
+                    if (pos && mod) {
+                        if (auto file = get_source_file(mod, pos.getFile())) {
+                            add(*file, pos.getLine(), pos.getColumn());
+                        }
+                    }
+                }
+                return mlir::WalkResult::advance();
+            });
         });
-        return result;
+
+        auto position = [] (const entry &e) { return std::make_pair(e.line, e.column); };
+        for (auto &[_, entries] : files) {
+            std::stable_sort(entries.begin(), entries.end(), [&] (const auto &a, const auto &b) {
+                return position(a) < position(b);
+            });
+        }
     }
 
-    std::vector< mlir::Operation * > get_with_meta_location(mlir::Operation *scope, identifier_t id) {
-        auto ctx = scope->getContext();
-        return get_with_meta_location(scope, IdentifierAttr::get(ctx, id));
+    std::vector< mlir::Operation * > location_index::at(
+        llvm::StringRef file, unsigned line, unsigned column
+    ) const {
+        auto it = files.find(file);
+        if (it == files.end()) {
+            return {};
+        }
+
+        const auto &entries = it->second;
+        auto first = std::partition_point(entries.begin(), entries.end(), [&] (const auto &e) {
+            return e.line < line || (e.line == line && column != 0 && e.column < column);
+        });
+
+        std::vector< mlir::Operation * > result;
+        llvm::SmallPtrSet< mlir::Operation *, 8 > seen;
+        for (auto e = first; e != entries.end() && e->line == line; ++e) {
+            if (column != 0 && e->column != column) {
+                break;
+            }
+
+            if (seen.insert(e->op).second) {
+                result.push_back(e->op);
+            }
+        }
+
+        return result;
     }
 
 } // namespace vast::meta
@@ -17,7 +17,7 @@ namespace vast::cc {
 
     namespace opt {
         bool emit_only_mlir(const vast_args &vargs) {
-            for (auto arg : { emit_mlir }) {
+            for (auto arg : { emit_mlir, emit_mlir_bytecode }) {
                 if (vargs.has_option(arg)) {
                     return true;
                 }
@@ -36,8 +36,12 @@ namespace vast::cc {
                 return "s";
             case output_type::emit_mlir:
                 return "mlir";
+            case output_type::emit_mlir_bytecode:
+                return "mlirbc";
             case output_type::emit_llvm:
                 return "ll";
+            case output_type::emit_bc:
+                return "bc";
             case output_type::emit_obj:
                 return "o";
             case output_type::none:
@@ -54,7 +58,8 @@ namespace vast::cc {
             return nullptr;
         }
 
-        return ci.createDefaultOutputFile(false, in, get_output_stream_suffix(act));
+        bool binary = act == output_type::emit_mlir_bytecode || act == output_type::emit_bc;
+        return ci.createDefaultOutputFile(binary, in, get_output_stream_suffix(act));
     }
 
     vast_stream_action::vast_stream_action(output_type act, const vast_args &vargs)
@@ -62,6 +67,11 @@ namespace vast::cc {
     {}
 
     void vast_stream_action::ExecuteAction() {
+        // Neither the parser nor codegen run for cached outputs.
+        if (consumer && consumer->emit_cached_output()) {
+            return;
+        }
+
         // FIXME: if (getCurrentFileKind().getLanguage() != Language::CIR)
         frontend_action::ExecuteAction();
     }
@@ -69,13 +79,20 @@ namespace vast::cc {
     auto vast_stream_action::CreateASTConsumer(compiler_instance &ci, string_ref input)
         -> std::unique_ptr< clang::ASTConsumer >
     {
+        // Output is emitted after clang finalized its output files, hence
+        // it has to be written directly instead of through a temporary file.
+        if (vargs.has_option(opt::release_ast)) {
+            ci.getFrontendOpts().UseTemporary = false;
+        }
+
         auto out = ci.takeOutputStream();
         if (!out) {
             out = get_output_stream(ci, input, action);
         }
 
         auto result = std::make_unique< vast_stream_consumer >(
-            action, options(ci), vargs, std::move(out)
+            action, options(ci), vargs, std::move(out), make_output_cache(ci, action, vargs),
+            make_function_cache(ci, action, vargs)
         );
 
         consumer = result.get();
@@ -100,6 +117,36 @@ namespace vast::cc {
         // TODO: pass the module around
     }
 
+    void vast_stream_action::EndSourceFile() {
+        if (!vargs.has_option(opt::release_ast)) {
+            frontend_action::EndSourceFile();
+            return;
+        }
+
+        auto &ci = getCompilerInstance();
+
+        // Keep the consumer, which owns the generated module, alive while
+        // clang tears down the AST.
+        std::unique_ptr< clang::ASTConsumer > owned_consumer;
+        if (ci.hasASTConsumer()) {
+            owned_consumer = ci.takeASTConsumer();
+        }
+
+        // Force clang to free the AST instead of leaking it until exit.
+        auto &front = ci.getFrontendOpts();
+        auto disable_free = std::exchange(front.DisableFree, false);
+        frontend_action::EndSourceFile();
+        front.DisableFree = disable_free;
+
+        // Identifier tables are owned by the preprocessor, that is not needed
+        // once the source file is finished.
+        ci.setPreprocessor(nullptr);
+
+        if (owned_consumer && !ci.getDiagnostics().hasErrorOccurred()) {
+            consumer->emit_released_output();
+        }
+    }
+
     vast_module_action::vast_module_action(const vast_args &vargs)
         : vargs(vargs)
     {}
@@ -143,6 +190,13 @@ namespace vast::cc {
         : vast_stream_action(output_type::emit_llvm, vargs)
     {}
 
+    // emit_bc
+    void emit_bc_action::anchor() {}
+
+    emit_bc_action::emit_bc_action(const vast_args &vargs)
+        : vast_stream_action(output_type::emit_bc, vargs)
+    {}
+
     // emit_mlir
     void emit_mlir_action::anchor() {}
 
@@ -150,6 +204,13 @@ namespace vast::cc {
         : vast_stream_action(output_type::emit_mlir, vargs)
     {}
 
+    // emit_mlir_bytecode
+    void emit_mlir_bytecode_action::anchor() {}
+
+    emit_mlir_bytecode_action::emit_mlir_bytecode_action(const vast_args &vargs)
+        : vast_stream_action(output_type::emit_mlir_bytecode, vargs)
+    {}
+
     // emit_obj
     void emit_obj_action::anchor() {}
 
@@ -3,8 +3,15 @@
 #include "vast/Frontend/Consumer.hpp"
 
 VAST_RELAX_WARNINGS
+#include <clang/Basic/DiagnosticDriver.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/Signals.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/TimeProfiler.h>
 
+#include <mlir/Bytecode/BytecodeWriter.h>
 #include <mlir/Pass/PassManager.h>
 
 #include <mlir/Target/LLVMIR/Dialect/All.h>
@@ -18,12 +25,20 @@ VAST_UNRELAX_WARNINGS
 #include "vast/CodeGen/CodeGenDriver.hpp"
 
 #include "vast/Util/Common.hpp"
+#include "vast/Util/ModulePrinter.hpp"
 
+#include "vast/Frontend/Context.hpp"
+#include "vast/Frontend/ModuleShards.hpp"
+#include "vast/Frontend/ParallelBackend.hpp"
 #include "vast/Frontend/Pipelines.hpp"
 #include "vast/Frontend/Targets.hpp"
 
 #include "vast/Target/LLVMIR/Convert.hpp"
 
+#include <deque>
+#include <functional>
+#include <mutex>
+
 namespace vast::cc {
 
     [[nodiscard]] target_dialect parse_target_dialect(string_ref from);
@@ -34,7 +49,11 @@ namespace vast::cc {
 
     void vast_consumer::Initialize(acontext_t &actx) {
         VAST_CHECK(!mctx, "initialized multiple times");
-        mctx = std::make_unique< mcontext_t >();
+        mctx = shared_mcontext();
+        if (!mctx) {
+            mctx = make_mcontext();
+        }
+
         cgctx = std::make_unique< cg::codegen_context >(
             *mctx, actx, get_source_language(opts.lang)
         );
@@ -52,6 +71,14 @@ namespace vast::cc {
             return true;
         }
 
+        llvm::TimeTraceScope scope("VastCodegen", [&] {
+            auto decl = *decls.begin();
+            if (auto named = llvm::dyn_cast< clang::NamedDecl >(decl)) {
+                return named->getQualifiedNameAsString();
+            }
+            return std::string(decl->getDeclKindName());
+        });
+
         return codegen->handle_top_level_decl(decls), true;
     }
 
@@ -59,21 +86,38 @@ namespace vast::cc {
         VAST_UNIMPLEMENTED;
     }
 
-    void vast_consumer::HandleInlineFunctionDefinition(clang::FunctionDecl * /* decl */) {
-        VAST_UNIMPLEMENTED;
+    void vast_consumer::HandleInlineFunctionDefinition(clang::FunctionDecl *decl) {
+        if (opts.diags.hasErrorOccurred()) {
+            return;
+        }
+
+        codegen->handle_inline_function_definition(decl);
     }
 
-    void vast_consumer::HandleInterestingDecl(clang::DeclGroupRef /* decl */) {
-        VAST_UNIMPLEMENTED;
+    void vast_consumer::HandleInterestingDecl(clang::DeclGroupRef decls) {
+        // Declarations deserialized from a precompiled header are handled as
+        // if they were parsed.
+        if (opts.diags.hasErrorOccurred()) {
+            return;
+        }
+
+        HandleTopLevelDecl(decls);
     }
 
     void vast_consumer::HandleTranslationUnit(acontext_t &actx) {
         // Note that this method is called after `HandleTopLevelDecl` has already
         // ran all over the top level decls. Here clang mostly wraps defered and
         // global codegen, followed by running vast passes.
-        codegen->finalize();
+        {
+            llvm::TimeTraceScope scope("VastCodegenFinalize");
+            codegen->finalize();
+        }
+
+        // The module after codegen is the first checkpoint of the pipeline.
+        auto verify = !vargs.has_option(opt::disable_vast_verifier)
+            && get_verifier_mode(vargs) != verifier_mode::none;
 
-        if (!vargs.has_option(opt::disable_vast_verifier)) {
+        if (verify) {
             if (!codegen->verify_module()) {
                 VAST_FATAL("codegen: module verification error before running vast passes");
             }
@@ -131,14 +175,392 @@ namespace vast::cc {
         return std::move(cgctx->mod);
     }
 
+    //
+    // Runs tasks in the order of their submission, one at a time, on the
+    // workers of the pool. At most `capacity` tasks wait at a time, further
+    // submission waits for them to finish. A submitter that is a worker of
+    // the pool runs the waiting tasks itself, so that submitters blocked on
+    // every worker do not starve the tasks.
+    //
+    struct ordered_worker
+    {
+        ordered_worker(std::size_t capacity, llvm::ThreadPool &pool)
+            : capacity(capacity), group(pool)
+        {}
+
+        ~ordered_worker() { drain(); }
+
+        void submit(std::function< void() > task) {
+            if (waiting() >= capacity) {
+                drain();
+            }
+
+            std::scoped_lock lock(mutex);
+            tasks.push_back(std::move(task));
+            if (!running) {
+                running = true;
+                group.async([this] { run(); });
+            }
+        }
+
+        // Finishes the submitted tasks.
+        void drain() { group.wait(); }
+
+      private:
+        std::size_t waiting() {
+            std::scoped_lock lock(mutex);
+            return tasks.size();
+        }
+
+        void run() {
+            while (true) {
+                std::function< void() > task;
+                {
+                    std::scoped_lock lock(mutex);
+                    if (tasks.empty()) {
+                        running = false;
+                        return;
+                    }
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::size_t capacity;
+
+        std::mutex mutex;
+        std::deque< std::function< void() > > tasks;
+        bool running = false;
+
+        llvm::ThreadPoolTaskGroup group;
+    };
+
+    //
+    // function streamer
+    //
+    // Processes each function definition by the function-local pipeline as
+    // soon as its codegen finishes, prints it into a temporary file and
+    // releases its body. Only module-level symbols and declarations of the
+    // streamed functions stay resident, which bounds memory by the largest
+    // function instead of the whole translation unit.
+    //
+    // With a function cache, the pipeline runs only on functions whose
+    // fingerprint has no cached output, the others are written from the cache.
+    //
+    // Pipelined streaming (-vast-pipelined-functions) moves the body of every
+    // function to a detached copy and hands it to a worker, which runs the
+    // pipeline and prints it while codegen continues with the rest of the
+    // translation unit. The worker processes the functions in order, so the
+    // output is the same as without pipelining.
+    //
+    struct function_streamer
+    {
+        // Functions waiting for the worker, bounds the memory of their bodies.
+        static constexpr std::size_t max_waiting_functions = 64;
+
+        function_streamer(
+            target_dialect trg, mlir::OpPrintingFlags flags,
+            mcontext_t &mctx, const vast_args &vargs,
+            std::optional< function_cache > cache
+        )
+            : pipeline(setup_function_pipeline(trg, mctx, vargs)), flags(flags)
+            , cache(std::move(cache))
+        {
+            int fd;
+            auto ec = llvm::sys::fs::createTemporaryFile("vast-functions", "mlir", fd, path);
+            VAST_CHECK(!ec, "unable to create temporary file for streamed functions: {0}", ec.message());
+            out = std::make_unique< llvm::raw_fd_ostream >(fd, true /* should close */);
+
+            // The pipeline creates types and attributes concurrently with
+            // codegen, which requires a thread-safe context. The module
+            // pipeline setup disables threads of the context for these
+            // options, possibly while the worker runs.
+            auto threads = mctx.isMultithreadingEnabled()
+                && !vargs.has_option(opt::disable_multithreading)
+                && !vargs.has_option(opt::emit_crash_reproducer);
+            if (vargs.has_option(opt::pipelined_functions) && threads) {
+                worker = std::make_unique< ordered_worker >(max_waiting_functions, mctx.getThreadPool());
+            }
+        }
+
+        ~function_streamer() {
+            worker.reset();
+            out.reset();
+            llvm::sys::fs::remove(path);
+        }
+
+        void stream(hl::FuncOp fn) {
+            if (worker) {
+                return stream_pipelined(fn);
+            }
+
+            if (!cache) {
+                process(fn, *out);
+            } else {
+                auto fingerprint = cache->fingerprint(fn);
+                if (auto output = cache->lookup(fingerprint)) {
+                    *out << *output;
+                } else {
+                    std::string text;
+                    llvm::raw_string_ostream os(text);
+                    process(fn, os);
+                    cache->store(fingerprint, os.str());
+                    *out << text;
+                }
+            }
+
+            release_body(fn);
+        }
+
+        void stream_pipelined(hl::FuncOp fn) {
+            // Fingerprints look up the callees in the module, hence they are
+            // computed before the body is detached.
+            std::optional< std::string > fingerprint;
+            if (cache) {
+                fingerprint = cache->fingerprint(fn);
+                if (auto output = cache->lookup(*fingerprint)) {
+                    worker->submit([this, output = std::move(*output)] { *out << output; });
+                    release_body(fn);
+                    return;
+                }
+            }
+
+            // The declaration keeps its place for codegen symbol lookups, the
+            // body is owned by the worker from now on.
+            auto copy = mlir::cast< hl::FuncOp >(fn->cloneWithoutRegions());
+            copy.getBody().takeBody(fn.getBody());
+            streamed.insert(fn.getSymName());
+
+            worker->submit([this, copy, fingerprint = std::move(fingerprint)] () mutable {
+                // Detached functions are top-level operations, they would
+                // define their own aliases otherwise.
+                auto local = flags;
+                local.useLocalScope();
+
+                std::string text;
+                llvm::raw_string_ostream os(text);
+                process(copy, os, local);
+                copy->erase();
+
+                if (fingerprint) {
+                    cache->store(*fingerprint, os.str());
+                }
+                *out << text;
+            });
+        }
+
+        // keep declaration for remaining codegen symbol lookups
+        void release_body(hl::FuncOp fn) {
+            streamed.insert(fn.getSymName());
+            fn.getBody().dropAllReferences();
+            fn.getBody().getBlocks().clear();
+        }
+
+        // Functions nested in the module are printed in local scope as well,
+        // as aliases are defined only at the top-level of the module, which
+        // is not printed with them.
+        void process(hl::FuncOp fn, llvm::raw_ostream &os) {
+            auto local = flags;
+            local.useLocalScope();
+            process(fn, os, local);
+        }
+
+        void process(hl::FuncOp fn, llvm::raw_ostream &os, mlir::OpPrintingFlags print_flags) {
+            auto result = pipeline->run(fn);
+            VAST_CHECK(mlir::succeeded(result), "MLIR pass manager failed when running vast function passes");
+
+            fn->print(os, print_flags);
+            os << "\n";
+        }
+
+        // Prints the module with streamed function definitions spliced at its end.
+        void emit(vast_module mod, llvm::raw_ostream &os) {
+            for (auto fn : llvm::make_early_inc_range(mod.getOps< hl::FuncOp >())) {
+                if (streamed.contains(fn.getSymName())) {
+                    fn.erase();
+                }
+            }
+
+            if (worker) {
+                worker->drain();
+            }
+            out->close();
+
+            std::string module_text;
+            llvm::raw_string_ostream module_os(module_text);
+            mod->print(module_os, flags);
+
+            auto buffer = llvm::MemoryBuffer::getFile(path);
+            VAST_CHECK(buffer, "unable to read streamed functions: {0}", buffer.getError().message());
+
+            // splice functions before terminating brace of the module body
+            auto body_end = string_ref(module_text).rfind('}');
+            VAST_CHECK(body_end != string_ref::npos, "unexpected textual form of module");
+
+            os << string_ref(module_text).take_front(body_end);
+            os << buffer.get()->getBuffer();
+            os << string_ref(module_text).drop_front(body_end);
+        }
+
+        std::unique_ptr< pipeline_t > pipeline;
+        mlir::OpPrintingFlags flags;
+
+        llvm::SmallString< 128 > path;
+        std::unique_ptr< llvm::raw_fd_ostream > out;
+
+        llvm::StringSet<> streamed;
+
+        std::optional< function_cache > cache;
+
+        // Destroyed first, its tasks use the members above.
+        std::unique_ptr< ordered_worker > worker;
+    };
+
     //
     // vast stream consumer
     //
 
+    vast_stream_consumer::vast_stream_consumer(
+        output_type act, action_options opts, const vast_args &vargs, output_stream_ptr os,
+        std::optional< output_cache > cache, std::optional< function_cache > fn_cache
+    )
+        : base(std::move(opts), vargs), action(act), output_stream(std::move(os))
+        , cache(std::move(cache)), fn_cache(std::move(fn_cache))
+    {}
+
+    vast_stream_consumer::~vast_stream_consumer() = default;
+
+    void vast_stream_consumer::Initialize(acontext_t &actx) {
+        base::Initialize(actx);
+
+        if (!vargs.has_option(opt::stream_functions)) {
+            return;
+        }
+
+        // Conflicting options are reported as driver errors, the unit is then
+        // emitted without streaming and the compilation fails.
+        auto stream_functions = spelling(opt::stream_functions);
+
+        auto trg = vargs.get_option(opt::emit_mlir);
+        if (action != output_type::emit_mlir || !trg) {
+            opts.diags.Report(clang::diag::err_drv_argument_only_allowed_with)
+                << stream_functions << spelling(opt::emit_mlir);
+            return;
+        }
+
+        auto target = parse_target_dialect(trg.value());
+        if (!has_function_local_pipeline(target, vargs)) {
+            auto conflicting = spelling(opt::emit_mlir) + "=" + trg->str();
+            for (auto option : { opt::simplify, opt::hl_inline, opt::snapshot, opt::instrument_functions }) {
+                if (vargs.has_option(option)) {
+                    conflicting = spelling(option);
+                    break;
+                }
+            }
+
+            opts.diags.Report(clang::diag::err_drv_argument_not_allowed_with)
+                << stream_functions << conflicting;
+            return;
+        }
+
+        streamer = std::make_unique< function_streamer >(
+            target, printing_flags(), *mctx, vargs, std::exchange(fn_cache, std::nullopt)
+        );
+    }
+
+    bool vast_stream_consumer::HandleTopLevelDecl(clang::DeclGroupRef decls) {
+        auto result = base::HandleTopLevelDecl(decls);
+
+        // Deferred decls handling is already finished at this point, hence
+        // function definitions are complete.
+        if (streamer) {
+            for (auto fn : codegen->take_emitted_functions()) {
+                streamer->stream(fn);
+            }
+        }
+
+        return result;
+    }
+
+    mlir::OpPrintingFlags vast_stream_consumer::printing_flags() const {
+        // FIXME: we cannot roundtrip prettyForm=true right now.
+        mlir::OpPrintingFlags flags;
+        flags.enableDebugInfo(vargs.has_option(opt::show_locs), /* prettyForm */ true);
+        return flags;
+    }
+
     void vast_stream_consumer::HandleTranslationUnit(acontext_t &actx) {
         base::HandleTranslationUnit(actx);
-        auto mod = result();
 
+        auto &src_mgr    = actx.getSourceManager();
+        auto main_buffer = src_mgr.getBufferOrFake(src_mgr.getMainFileID());
+        data_layout      = actx.getTargetInfo().getDataLayoutString();
+
+        if (cache) {
+            cache->record_dependencies(src_mgr);
+        }
+
+        if (vargs.has_option(opt::release_ast)) {
+            // The output is emitted once clang releases the AST, hence keep
+            // copy of the main file for diagnostics of the vast pipeline.
+            main_file = llvm::MemoryBuffer::getMemBufferCopy(
+                main_buffer.getBuffer(), main_buffer.getBufferIdentifier()
+            );
+
+            released_module = result();
+            codegen.reset();
+            cgctx.reset();
+            return;
+        }
+
+        main_file = llvm::MemoryBuffer::getMemBuffer(main_buffer);
+        emit_and_store_output(result());
+    }
+
+    void vast_stream_consumer::emit_released_output() {
+        if (released_module) {
+            emit_and_store_output(std::move(released_module));
+        }
+    }
+
+    bool vast_stream_consumer::emit_cached_output() {
+        if (!cache || !output_stream) {
+            return false;
+        }
+
+        auto output = cache->lookup();
+        if (!output) {
+            return false;
+        }
+
+        *output_stream << *output;
+        return true;
+    }
+
+    void vast_stream_consumer::emit_and_store_output(owning_module_ref mod) {
+        if (!cache || !output_stream) {
+            return emit_output(std::move(mod));
+        }
+
+        // The output is buffered, so that it can be stored once complete.
+        llvm::SmallVector< char, 0 > buffer;
+        auto out = std::exchange(
+            output_stream, std::make_unique< llvm::raw_svector_ostream >(buffer)
+        );
+
+        emit_output(std::move(mod));
+
+        output_stream = std::move(out);
+        output_stream->write(buffer.data(), buffer.size());
+
+        if (!opts.diags.hasErrorOccurred()) {
+            cache->store(string_ref(buffer.data(), buffer.size()));
+        }
+    }
+
+    void vast_stream_consumer::emit_output(owning_module_ref mod) {
         switch (action) {
             case output_type::emit_assembly:
                 return emit_backend_output(
@@ -150,10 +572,20 @@ namespace vast::cc {
                 }
                 VAST_FATAL("no target dialect specified for MLIR output");
             }
+            case output_type::emit_mlir_bytecode: {
+                if (auto trg = vargs.get_option(opt::emit_mlir_bytecode)) {
+                    return emit_mlir_bytecode_output(parse_target_dialect(trg.value()), std::move(mod), mctx.get());
+                }
+                VAST_FATAL("no target dialect specified for MLIR bytecode output");
+            }
             case output_type::emit_llvm:
                 return emit_backend_output(
                     backend::Backend_EmitLL, std::move(mod), mctx.get()
                 );
+            case output_type::emit_bc:
+                return emit_backend_output(
+                    backend::Backend_EmitBC, std::move(mod), mctx.get()
+                );
             case output_type::emit_obj:
                 return emit_backend_output(
                     backend::Backend_EmitObj, std::move(mod), mctx.get()
@@ -170,50 +602,144 @@ namespace vast::cc {
 
         process_mlir_module(target_dialect::llvm, mlir_module.get(), mctx);
 
-        auto mod = target::llvmir::translate(mlir_module.get(), llvm_context);
-        auto dl  = cgctx->actx.getTargetInfo().getDataLayoutString();
+        auto translation = vargs.has_option(opt::parallel_translation)
+            ? target::llvmir::translation_mode::parallel
+            : target::llvmir::translation_mode::serial;
+
+        auto mod = [&] {
+            llvm::TimeTraceScope scope("VastTranslateToLLVMIR");
+            return target::llvmir::translate(mlir_module.get(), llvm_context, translation);
+        } ();
+        VAST_CHECK(mod, "failed to translate module to LLVM IR");
+
+        // The backend works on the translated module only, releasing the
+        // llvm dialect module keeps a single copy of the ir alive while llvm
+        // optimizes and generates code.
+        {
+            llvm::TimeTraceScope scope("VastReleaseModule");
+            mlir_module = owning_module_ref();
+        }
 
+        // With partitions, the optimization pipeline runs concurrently ahead
+        // of the backend, which then only generates code.
+        auto codegen = opts.codegen;
+        if (auto partitions = backend_partitions(); partitions > 1) {
+            if (codegen.OptimizationLevel > 0 && !codegen.DisableLLVMPasses) {
+                mod = optimize_in_partitions(std::move(mod), partitions, opts.codegen, opts.target);
+                codegen.DisableLLVMPasses = true;
+            }
+        }
+
+        llvm::TimeTraceScope scope("EmitBackendOutput");
         clang::EmitBackendOutput(
-            opts.diags, opts.headers, opts.codegen, opts.target, opts.lang, dl, mod.get(),
+            opts.diags, opts.headers, codegen, opts.target, opts.lang, data_layout, mod.get(),
             backend_action, &opts.vfs, std::move(output_stream)
         );
     }
 
+    unsigned vast_stream_consumer::backend_partitions() const {
+        auto value = vargs.get_option(opt::backend_partitions);
+        if (!value) {
+            return 1;
+        }
+
+        unsigned partitions = 0;
+        if (value->getAsInteger(10, partitions) || partitions == 0) {
+            VAST_FATAL("invalid -vast-backend-partitions value: {0}", *value);
+        }
+        return partitions;
+    }
+
+    unsigned vast_stream_consumer::module_shards() const {
+        auto value = vargs.get_option(opt::module_shards);
+        if (!value) {
+            return 1;
+        }
+
+        unsigned shards = 0;
+        if (value->getAsInteger(10, shards) || shards == 0) {
+            VAST_FATAL("invalid -vast-module-shards value: {0}", *value);
+        }
+
+        // Shards run their pipelines concurrently, hence diagnostics cannot be
+        // verified in order and statistics of the pipelines are not merged.
+        // The module is then processed whole and the compilation fails.
+        for (auto option : {
+            opt::stream_functions, opt::vast_verify_diags, opt::pipeline_stats,
+            opt::snapshot, opt::verify_determinism
+        }) {
+            if (vargs.has_option(option)) {
+                opts.diags.Report(clang::diag::err_drv_argument_not_allowed_with)
+                    << spelling(opt::module_shards) << spelling(option);
+                return 1;
+            }
+        }
+        return shards;
+    }
+
     void vast_stream_consumer::process_mlir_module(
         target_dialect target, mlir::ModuleOp mod, mcontext_t *mctx
     ) {
         // Handle source manager properly given that lifetime analysis
         // might emit warnings and remarks.
-        auto &src_mgr     = cgctx->actx.getSourceManager();
-        auto main_file_id = src_mgr.getMainFileID();
-
-        auto file_buff = llvm::MemoryBuffer::getMemBuffer(
-            src_mgr.getBufferOrFake(main_file_id)
-        );
+        auto file_buff = llvm::MemoryBuffer::getMemBuffer(main_file->getMemBufferRef());
 
         llvm::SourceMgr mlir_src_mgr;
         mlir_src_mgr.AddNewSourceBuffer(std::move(file_buff), llvm::SMLoc());
 
         bool verify_diagnostics = vargs.has_option(opt::vast_verify_diags);
 
-        mlir::SourceMgrDiagnosticVerifierHandler src_mgr_handler(mlir_src_mgr, mctx);
+        // Handlers of the shared context would receive diagnostics of all
+        // the units, so these are reported by its default handler.
+        bool shared = is_shared_mcontext(*mctx);
+        if (shared && verify_diagnostics) {
+            opts.diags.Report(clang::diag::err_drv_argument_not_allowed_with)
+                << spelling(opt::vast_verify_diags) << "--shared-context";
+            verify_diagnostics = false;
+        }
+
+        std::optional< mlir::SourceMgrDiagnosticVerifierHandler > src_mgr_handler;
+        if (!shared) {
+            src_mgr_handler.emplace(mlir_src_mgr, mctx);
+        }
 
-        if (vargs.has_option(opt::debug)) {
+        if (vargs.has_option(opt::debug) && !shared) {
             mctx->printOpOnDiagnostic(true);
             mctx->printStackTraceOnDiagnostic(true);
             llvm::DebugFlag = true;
         }
 
+        owning_module_ref reference;
+        if (vargs.has_option(opt::verify_determinism)) {
+            reference = mod.clone();
+        }
+
         // Setup and execute vast pipeline
-        auto pipeline = setup_pipeline(pipeline_source::ast, target, *mctx, vargs);
-        VAST_CHECK(pipeline, "failed to setup pipeline");
+        auto result = [&] {
+            llvm::TimeTraceScope scope("VastPipeline", [&] { return to_string(target); });
+            if (auto shards = module_shards(); shards > 1) {
+                return process_in_shards(mod, shards, target, *mctx, vargs);
+            }
 
-        auto result = pipeline->run(mod);
+            auto pipeline = setup_pipeline(pipeline_source::ast, target, *mctx, vargs);
+            VAST_CHECK(pipeline, "failed to setup pipeline");
+            return pipeline->run(mod);
+        } ();
         VAST_CHECK(mlir::succeeded(result), "MLIR pass manager failed when running vast passes");
 
+        if (reference) {
+            verify_determinism(target, mod, reference.get(), mctx);
+        }
+
+        // Remember how far the module got, so that later pipelines on emitted
+        // MLIR do not repeat already applied conversions.
+        if (target != target_dialect::high_level || vargs.has_option(opt::simplify)) {
+            mark_reached_dialect(mod, target);
+        }
+
         // Verify the diagnostic handler to make sure that each of the
         // diagnostics matched.
-        if (verify_diagnostics && src_mgr_handler.verify().failed()) {
+        if (verify_diagnostics && src_mgr_handler->verify().failed()) {
             llvm::sys::RunInterruptHandlers();
             VAST_FATAL("failed mlir codegen");
         }
@@ -224,6 +750,46 @@ namespace vast::cc {
         // }
     }
 
+    void vast_stream_consumer::verify_determinism(
+        target_dialect target, mlir::ModuleOp mod, mlir::ModuleOp reference, mcontext_t *mctx
+    ) {
+        // The rerun is serial, unless the context is shared by other units.
+        bool shared   = is_shared_mcontext(*mctx);
+        bool threaded = !shared && mctx->isMultithreadingEnabled();
+        if (!shared) {
+            mctx->disableMultithreading();
+        }
+
+        auto result = [&] {
+            llvm::TimeTraceScope scope("VastVerifyDeterminism");
+            auto pipeline = setup_pipeline(pipeline_source::ast, target, *mctx, vargs);
+            VAST_CHECK(pipeline, "failed to setup pipeline");
+            return pipeline->run(reference);
+        } ();
+
+        if (threaded) {
+            mctx->enableMultithreading();
+        }
+        VAST_CHECK(mlir::succeeded(result), "MLIR pass manager failed when verifying determinism");
+
+        auto print = [&] (mlir::ModuleOp module, bool parallel) {
+            std::string out;
+            llvm::raw_string_ostream os(out);
+            if (parallel) {
+                util::print_module(module, os, printing_flags());
+            } else {
+                module->print(os, printing_flags());
+            }
+            return out;
+        };
+
+        // The parallel printer has to match the serial one as well.
+        auto parallel = vargs.has_option(opt::parallel_printing);
+        if (print(mod, parallel) != print(reference, false)) {
+            VAST_FATAL("vast pipeline output differs between threaded and serial runs");
+        }
+    }
+
     void vast_stream_consumer::emit_mlir_output(
         target_dialect target, owning_module_ref mod, mcontext_t *mctx
     ) {
@@ -233,11 +799,48 @@ namespace vast::cc {
 
         process_mlir_module(target, mod.get(), mctx);
 
-        // FIXME: we cannot roundtrip prettyForm=true right now.
-        mlir::OpPrintingFlags flags;
-        flags.enableDebugInfo(vargs.has_option(opt::show_locs), /* prettyForm */ true);
+        if (streamer) {
+            return streamer->emit(mod.get(), *output_stream);
+        }
+
+        if (vargs.has_option(opt::parallel_printing)) {
+            return util::print_module(mod.get(), *output_stream, printing_flags());
+        }
+
+        mod->print(*output_stream, printing_flags());
+    }
+
+    void vast_stream_consumer::emit_mlir_bytecode_output(
+        target_dialect target, owning_module_ref mod, mcontext_t *mctx
+    ) {
+        if (!output_stream || !mod) {
+            return;
+        }
+
+        process_mlir_module(target, mod.get(), mctx);
+
+        // Bytecode keeps locations unconditionally and unlike the textual
+        // form roundtrips without loss.
+        mlir::BytecodeWriterConfig config("vast");
+
+        auto compression = get_bytecode_compression(vargs);
+        if (!compression.level) {
+            if (mlir::failed(mlir::writeBytecodeToFile(mod.get(), *output_stream, config))) {
+                VAST_FATAL("failed to write mlir bytecode");
+            }
+            return;
+        }
+
+        // The frame is written in one piece, so that readers know its size.
+        std::string bytecode;
+        {
+            llvm::raw_string_ostream os(bytecode);
+            if (mlir::failed(mlir::writeBytecodeToFile(mod.get(), os, config))) {
+                VAST_FATAL("failed to write mlir bytecode");
+            }
+        }
 
-        mod->print(*output_stream, flags);
+        *output_stream << compression.compress(std::move(bytecode));
     }
 
 } // namespace vast::cc
@@ -0,0 +1,66 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/Context.hpp"
+
+#include "vast/CodeGen/CodeGen.hpp"
+#include "vast/Target/LLVMIR/Convert.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace vast::cc {
+
+    static std::atomic< llvm::ThreadPool * > thread_pool = nullptr;
+
+    llvm::ThreadPool *shared_thread_pool() {
+        return thread_pool.load();
+    }
+
+    void set_shared_thread_pool(llvm::ThreadPool *pool) {
+        thread_pool.store(pool);
+    }
+
+    std::unique_ptr< mcontext_t > make_mcontext() {
+        auto mctx = [] {
+            auto pool = shared_thread_pool();
+            if (!pool) {
+                return std::make_unique< mcontext_t >();
+            }
+
+            // Context has to be created without its own threads to be able to
+            // adopt the external thread pool.
+            auto mctx = std::make_unique< mcontext_t >(mcontext_t::Threading::DISABLED);
+            mctx->setThreadPool(*pool);
+            return mctx;
+        }();
+
+        target::llvmir::register_vast_to_llvm_ir(*mctx);
+        return mctx;
+    }
+
+    static std::mutex shared_mctx_mutex;
+    static std::shared_ptr< mcontext_t > shared_mctx = nullptr;
+
+    std::shared_ptr< mcontext_t > shared_mcontext() {
+        std::scoped_lock lock(shared_mctx_mutex);
+        return shared_mctx;
+    }
+
+    std::shared_ptr< mcontext_t > make_shared_mcontext() {
+        std::shared_ptr< mcontext_t > mctx = make_mcontext();
+        cg::load_codegen_dialects(*mctx);
+        mctx->loadAllAvailableDialects();
+        return mctx;
+    }
+
+    void set_shared_mcontext(std::shared_ptr< mcontext_t > mctx) {
+        std::scoped_lock lock(shared_mctx_mutex);
+        shared_mctx = std::move(mctx);
+    }
+
+    bool is_shared_mcontext(const mcontext_t &mctx) {
+        std::scoped_lock lock(shared_mctx_mutex);
+        return shared_mctx.get() == &mctx;
+    }
+
+} // namespace vast::cc
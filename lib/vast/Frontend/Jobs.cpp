@@ -0,0 +1,231 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/Jobs.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Context.hpp"
+
+#include <cerrno>
+
+#ifdef LLVM_ON_UNIX
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #include <sched.h>
+    #include <fstream>
+#endif
+
+namespace vast::cc {
+
+    std::unique_ptr< jobserver_client > jobserver_client::from_environment() {
+    #ifdef LLVM_ON_UNIX
+        auto flags = llvm::sys::Process::GetEnv("MAKEFLAGS");
+        if (!flags) {
+            return nullptr;
+        }
+
+        // The last advertised jobserver is the one of the parent make.
+        string_ref auth;
+        for (auto arg : llvm::split(*flags, ' ')) {
+            if (arg.consume_front("--jobserver-auth=") || arg.consume_front("--jobserver-fds=")) {
+                auth = arg;
+            }
+        }
+
+        if (auth.empty()) {
+            return nullptr;
+        }
+
+        if (auth.consume_front("fifo:")) {
+            auto fd = ::open(auth.str().c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0) {
+                return nullptr;
+            }
+            return std::unique_ptr< jobserver_client >(new jobserver_client(fd, fd));
+        }
+
+        auto [read, write] = auth.split(',');
+        int read_fd = -1, write_fd = -1;
+        if (read.getAsInteger(10, read_fd) || write.getAsInteger(10, write_fd)) {
+            return nullptr;
+        }
+
+        // Make passes the descriptors only to the recipes it knows to run
+        // make, other recipes see them closed.
+        if (::fcntl(read_fd, F_GETFD) < 0 || ::fcntl(write_fd, F_GETFD) < 0) {
+            return nullptr;
+        }
+
+        // The descriptors of the pipe are blocking and shared with the other
+        // clients, a descriptor of its own open file reads without blocking.
+        auto path = "/proc/self/fd/" + std::to_string(read_fd);
+        auto fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        return std::unique_ptr< jobserver_client >(new jobserver_client(fd, write_fd));
+    #else
+        return nullptr;
+    #endif
+    }
+
+    jobserver_client::~jobserver_client() {
+    #ifdef LLVM_ON_UNIX
+        string_ref rest = tokens;
+        while (!rest.empty()) {
+            auto written = ::write(write_fd, rest.data(), rest.size());
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                llvm::errs() << "vast: unable to return " << rest.size() << " jobserver tokens\n";
+                break;
+            }
+            rest = rest.drop_front(std::size_t(written));
+        }
+        ::close(read_fd);
+    #endif
+    }
+
+    unsigned jobserver_client::acquire(unsigned count) {
+        unsigned acquired = 0;
+    #ifdef LLVM_ON_UNIX
+        while (acquired < count) {
+            char token;
+            auto size = ::read(read_fd, &token, 1);
+            if (size < 0 && errno == EINTR) {
+                continue;
+            }
+            if (size != 1) {
+                break;
+            }
+            tokens.push_back(token);
+            ++acquired;
+        }
+    #endif
+        return acquired;
+    }
+
+    std::optional< unsigned > bind_to_numa_node(unsigned node) {
+    #if defined(__linux__)
+        // Processors of the node are listed as ranges, e.g., `0-15,32-47`.
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+        if (!std::getline(in, list)) {
+            return std::nullopt;
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        unsigned count = 0;
+        for (auto range : llvm::split(string_ref(list).trim(), ',')) {
+            auto [first, last] = range.split('-');
+            unsigned lo = 0, hi = 0;
+            if (first.getAsInteger(10, lo)) {
+                return std::nullopt;
+            }
+            if (last.empty()) {
+                hi = lo;
+            } else if (last.getAsInteger(10, hi)) {
+                return std::nullopt;
+            }
+
+            for (auto cpu = lo; cpu <= hi && cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, &set);
+                ++count;
+            }
+        }
+
+        // Applies to the calling thread, whose placement is inherited by the
+        // threads it creates later.
+        if (count == 0 || ::sched_setaffinity(0, sizeof(set), &set) != 0) {
+            return std::nullopt;
+        }
+        return count;
+    #else
+        (void)node;
+        return std::nullopt;
+    #endif
+    }
+
+    std::optional< unsigned > current_numa_node() {
+    #if defined(__linux__)
+        auto cpu = ::sched_getcpu();
+        if (cpu < 0) {
+            return std::nullopt;
+        }
+
+        // The directory of the processor links its node as `node<N>`.
+        std::error_code ec;
+        auto dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        for (llvm::sys::fs::directory_iterator it(dir, ec), end; it != end && !ec; it.increment(ec)) {
+            auto name = llvm::sys::path::filename(it->path());
+            unsigned node = 0;
+            if (name.consume_front("node") && !name.getAsInteger(10, node)) {
+                return node;
+            }
+        }
+    #endif
+        return std::nullopt;
+    }
+
+    unsigned default_jobs(jobserver_client *jobserver) {
+        auto available = llvm::hardware_concurrency().compute_thread_count();
+        if (!jobserver) {
+            return available;
+        }
+
+        if (available > jobserver->slots()) {
+            jobserver->acquire(available - jobserver->slots());
+        }
+        return jobserver->slots();
+    }
+
+    execution_context::execution_context(const vast_args &vargs) {
+        if (vargs.has_option(opt::numa)) {
+            auto value = vargs.get_option(opt::numa);
+            std::optional< unsigned > node;
+            if (value == "auto") {
+                node = current_numa_node();
+            } else if (unsigned id = 0; value && !value->getAsInteger(10, id)) {
+                node = id;
+            } else {
+                VAST_FATAL("invalid -vast-numa value: {0}", value.value_or(""));
+            }
+
+            // Without the node, the workers run on all the processors.
+            if (!node || !bind_to_numa_node(*node)) {
+                llvm::errs() << "vast: unable to place workers on numa node "
+                             << value.value_or("") << "\n";
+            }
+        }
+
+        auto jobs = opt::jobs_count(vargs);
+        if (!jobs) {
+            jobserver = jobserver_client::from_environment();
+            jobs = default_jobs(jobserver.get());
+        }
+
+        pool = std::make_unique< llvm::ThreadPool >(llvm::hardware_concurrency(*jobs));
+        set_shared_thread_pool(pool.get());
+    }
+
+    execution_context::~execution_context() {
+        set_shared_thread_pool(nullptr);
+        // Workers are joined before the slots are returned to the jobserver.
+        pool.reset();
+        jobserver.reset();
+    }
+
+} // namespace vast::cc
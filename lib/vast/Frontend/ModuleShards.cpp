@@ -0,0 +1,278 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/ModuleShards.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/EquivalenceClasses.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Frontend/Context.hpp"
+#include "vast/Frontend/Pipelines.hpp"
+#include "vast/Linker/Linker.hpp"
+
+#include <optional>
+
+namespace vast::cc {
+
+    namespace {
+
+        bool is_internal(operation op) {
+            if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                return var.getStorageClass() == hl::StorageClass::sc_static;
+            }
+
+            auto attr = op->getAttrOfType< core::GlobalLinkageKindAttr >("linkage");
+            if (!attr) {
+                return false;
+            }
+
+            using enum core::GlobalLinkageKind;
+            return attr.getValue() == InternalLinkage || attr.getValue() == PrivateLinkage;
+        }
+
+        // Yields names of the symbols the operation refers to, by symbol
+        // references, e.g., of calls, and by global references.
+        void references(operation op, auto &&yield) {
+            op->walk([&] (operation nested) {
+                if (auto ref = mlir::dyn_cast< hl::GlobalRefOp >(nested)) {
+                    yield(ref.getGlobal());
+                }
+
+                nested->getAttrDictionary().walk([&] (mlir::SymbolRefAttr ref) {
+                    yield(ref.getRootReference().getValue());
+                });
+            });
+        }
+
+        std::size_t size_of(operation op) {
+            std::size_t size = 0;
+            op->walk([&] (operation) { ++size; });
+            return size;
+        }
+
+        // Declaration of a symbol that another shard owns.
+        operation make_declaration(operation op) {
+            auto decl = op->cloneWithoutRegions();
+            if (auto var = mlir::dyn_cast< hl::VarDeclOp >(decl)) {
+                var.setStorageClass(hl::StorageClass::sc_extern);
+            } else {
+                decl->setAttr("linkage", core::GlobalLinkageKindAttr::get(
+                    op->getContext(), core::GlobalLinkageKind::ExternalLinkage
+                ));
+            }
+            return decl;
+        }
+
+        struct shard_plan
+        {
+            // For every global, by its position in the module, the shard
+            // that owns it.
+            std::vector< unsigned > owner;
+
+            // For every shard, the globals it declares.
+            std::vector< llvm::BitVector > declared;
+        };
+
+        shard_plan make_plan(llvm::ArrayRef< operation > globals, unsigned shards) {
+            llvm::StringMap< unsigned > index;
+            for (auto [idx, op] : llvm::enumerate(globals)) {
+                index[link::name_of(op)] = idx;
+            }
+
+            // Symbols that refer to internal ones end up in the same cluster.
+            llvm::EquivalenceClasses< unsigned > clusters;
+            std::vector< llvm::SmallVector< unsigned > > refs(globals.size());
+            for (auto [idx, op] : llvm::enumerate(globals)) {
+                clusters.insert(idx);
+                references(op, [&, idx = idx] (string_ref name) {
+                    auto it = index.find(name);
+                    if (it == index.end() || it->second == idx) {
+                        return;
+                    }
+
+                    refs[idx].push_back(it->second);
+                    if (is_internal(globals[it->second])) {
+                        clusters.unionSets(idx, it->second);
+                    }
+                });
+            }
+
+            struct cluster_t
+            {
+                unsigned leader;
+                std::size_t size;
+            };
+
+            llvm::DenseMap< unsigned, unsigned > cluster_of;
+            std::vector< cluster_t > sized;
+            for (auto [idx, op] : llvm::enumerate(globals)) {
+                auto leader = clusters.getLeaderValue(idx);
+                auto [it, inserted] = cluster_of.try_emplace(leader, sized.size());
+                if (inserted) {
+                    sized.push_back({ leader, 0 });
+                }
+                sized[it->second].size += size_of(op);
+            }
+
+            // Largest clusters first, each to the least loaded shard,
+            // ties broken by the module order to stay deterministic.
+            auto ordered = sized;
+            std::stable_sort(ordered.begin(), ordered.end(), [] (const auto &a, const auto &b) {
+                return a.size > b.size;
+            });
+
+            shards = std::max(1u, std::min< unsigned >(shards, sized.size()));
+            std::vector< std::size_t > load(shards, 0);
+            llvm::DenseMap< unsigned, unsigned > shard_of;
+            for (const auto &cluster : ordered) {
+                auto lightest = std::min_element(load.begin(), load.end()) - load.begin();
+                load[lightest] += cluster.size;
+                shard_of[cluster.leader] = unsigned(lightest);
+            }
+
+            shard_plan plan;
+            plan.owner.resize(globals.size());
+            plan.declared.assign(shards, llvm::BitVector(globals.size()));
+            for (std::size_t idx = 0; idx < globals.size(); ++idx) {
+                plan.owner[idx] = shard_of[clusters.getLeaderValue(idx)];
+            }
+
+            for (std::size_t idx = 0; idx < globals.size(); ++idx) {
+                auto shard = plan.owner[idx];
+                for (auto ref : refs[idx]) {
+                    if (plan.owner[ref] != shard) {
+                        plan.declared[shard].set(ref);
+                    }
+                }
+            }
+
+            return plan;
+        }
+
+        std::vector< owning_module_ref > split(vast_module mod, unsigned shards) {
+            auto ops = llvm::to_vector(llvm::make_pointer_range(mod.getOps()));
+
+            std::vector< operation > globals;
+            for (auto op : ops) {
+                if (link::is_global(op)) {
+                    globals.push_back(op);
+                }
+            }
+
+            auto plan = make_plan(globals, shards);
+
+            std::vector< owning_module_ref > parts;
+            for (std::size_t idx = 0; idx < plan.declared.size(); ++idx) {
+                auto &part = parts.emplace_back(vast_module::create(mod.getLoc()));
+                part->getOperation()->setAttrs(mod->getAttrDictionary());
+            }
+
+            auto append = [&] (unsigned shard, operation op) {
+                auto body = parts[shard]->getBody();
+                op->moveBefore(body, body->end());
+            };
+
+            // Operations keep their relative order within every shard.
+            std::size_t global = 0;
+            for (auto op : ops) {
+                if (link::is_global(op)) {
+                    auto idx = global++;
+                    for (unsigned shard = 0; shard < parts.size(); ++shard) {
+                        if (plan.declared[shard].test(idx)) {
+                            parts[shard]->getBody()->push_back(make_declaration(op));
+                        }
+                    }
+                    append(plan.owner[idx], op);
+                    continue;
+                }
+
+                if (link::is_type_declaration(op)) {
+                    for (unsigned shard = 1; shard < parts.size(); ++shard) {
+                        parts[shard]->getBody()->push_back(op->clone());
+                    }
+                }
+
+                append(0, op);
+            }
+
+            return parts;
+        }
+
+    } // namespace
+
+    logical_result process_in_shards(
+        vast_module mod, unsigned shards, target_dialect trg,
+        mcontext_t &mctx, const vast_args &vargs
+    ) {
+        VAST_CHECK(
+            trg == target_dialect::high_level,
+            "module sharding is supported only for high-level mlir output"
+        );
+
+        auto parts = split(mod, shards);
+
+        // Pipelines are set up ahead, as the setup may disable multithreading.
+        std::vector< std::unique_ptr< pipeline_t > > pipelines;
+        for (std::size_t idx = 0; idx < parts.size(); ++idx) {
+            pipelines.push_back(setup_pipeline(pipeline_source::ast, trg, mctx, vargs));
+            VAST_CHECK(pipelines.back(), "failed to setup pipeline");
+        }
+
+        std::vector< logical_result > results(parts.size(), mlir::failure());
+        auto run = [&] (std::size_t idx) { results[idx] = pipelines[idx]->run(parts[idx].get()); };
+
+        if (mctx.isMultithreadingEnabled()) {
+            // Shards run on the workers of the process if it has them.
+            std::optional< llvm::ThreadPool > own;
+            auto pool = shared_thread_pool();
+            if (!pool) {
+                pool = &own.emplace(llvm::hardware_concurrency(unsigned(parts.size())));
+            }
+
+            llvm::ThreadPoolTaskGroup group(*pool);
+            for (std::size_t idx = 0; idx < parts.size(); ++idx) {
+                group.async(run, idx);
+            }
+            group.wait();
+        } else {
+            for (std::size_t idx = 0; idx < parts.size(); ++idx) {
+                run(idx);
+            }
+        }
+
+        if (llvm::any_of(results, [] (auto result) { return mlir::failed(result); })) {
+            return mlir::failure();
+        }
+
+        link::program_linker linker(mctx);
+        for (auto &part : parts) {
+            if (mlir::failed(linker.add(part.get()))) {
+                return mlir::failure();
+            }
+        }
+
+        auto linked = linker.finish();
+        if (!linked) {
+            return mlir::failure();
+        }
+
+        for (auto attr : linked->getOperation()->getAttrs()) {
+            mod->setAttr(attr.getName(), attr.getValue());
+        }
+
+        auto body = mod.getBody();
+        for (auto &op : llvm::make_early_inc_range(linked->getOps())) {
+            op.moveBefore(body, body->end());
+        }
+
+        return mlir::success();
+    }
+
+} // namespace vast::cc
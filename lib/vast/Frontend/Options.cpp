@@ -36,6 +36,48 @@ namespace vast::cc {
         llvm::Twine disable(string_ref name) {
             return "disable-" + name;
         }
+
+        std::optional< std::int64_t > memory_limit_kb(const vast_args &vargs) {
+            if (!vargs.has_option(memory_limit)) {
+                return std::nullopt;
+            }
+
+            std::int64_t limit_mb = 0;
+            auto value = vargs.get_option(memory_limit);
+            if (!value || value->getAsInteger(10, limit_mb) || limit_mb <= 0) {
+                VAST_FATAL("invalid -vast-memory-limit value: {0}", value.value_or(""));
+            }
+
+            return limit_mb * 1024;
+        }
+
+        std::optional< std::int64_t > function_budget_ms(const vast_args &vargs) {
+            if (!vargs.has_option(function_budget)) {
+                return std::nullopt;
+            }
+
+            std::int64_t budget_ms = 0;
+            auto value = vargs.get_option(function_budget);
+            if (!value || value->getAsInteger(10, budget_ms) || budget_ms <= 0) {
+                VAST_FATAL("invalid -vast-function-budget value: {0}", value.value_or(""));
+            }
+
+            return budget_ms;
+        }
+
+        std::optional< unsigned > jobs_count(const vast_args &vargs) {
+            if (!vargs.has_option(jobs)) {
+                return std::nullopt;
+            }
+
+            unsigned count = 0;
+            auto value = vargs.get_option(jobs);
+            if (!value || value->getAsInteger(10, count) || count == 0) {
+                VAST_FATAL("invalid -vast-jobs value: {0}", value.value_or(""));
+            }
+
+            return count;
+        }
     } // namespace opt
 
     bool vast_args::has_option(string_ref name) const {
@@ -108,5 +150,33 @@ namespace vast::cc {
         VAST_UNIMPLEMENTED_MSG("VAST does not yet support the given source language");
     }
 
+    util::bytecode_compression get_bytecode_compression(const vast_args &vargs) {
+        util::bytecode_compression compression;
+        if (vargs.has_option(opt::bytecode_zstd)) {
+            VAST_CHECK(util::has_zstd, "-vast-bytecode-zstd requires vast built with VAST_ENABLE_ZSTD");
+
+            int level = util::default_zstd_level;
+            if (auto value = vargs.get_option(opt::bytecode_zstd)) {
+                if (value->getAsInteger(10, level) || level < 1 || level > 22) {
+                    VAST_FATAL("invalid -vast-bytecode-zstd value: {0}", *value);
+                }
+            }
+            compression.level = level;
+        }
+
+        // Frames of the dictionary are decompressed even if nothing is
+        // compressed.
+        auto level = compression.level.value_or(util::default_zstd_level);
+        if (auto path = vargs.get_option(opt::zstd_dict)) {
+            compression.dict = util::zstd_dictionary::load(*path, level);
+            if (!compression.dict) {
+                VAST_FATAL("invalid -vast-zstd-dict dictionary: {0}", *path);
+            }
+        } else {
+            compression.dict = util::default_zstd_dictionary(level);
+        }
+
+        return compression;
+    }
 
 } // namespace vast::cc
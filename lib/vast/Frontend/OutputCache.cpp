@@ -0,0 +1,472 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/OutputCache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/FileManager.h>
+#include <clang/Frontend/CompilerInvocation.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/Summaries.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Frontend/RemoteCache.hpp"
+
+#include "vast/Util/ContentHash.hpp"
+#include "vast/Version.inc"
+
+#include <algorithm>
+
+namespace vast::cc
+{
+    namespace
+    {
+        // Bumped whenever the layout of the entries changes.
+        constexpr string_ref format = "vast-output-cache-1";
+
+        using dependency = output_cache::dependency;
+
+        std::string write_manifest(llvm::ArrayRef< dependency > deps) {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            for (const auto &dep : deps) {
+                os << dep.hash << ' ' << dep.path << '\n';
+            }
+            return text;
+        }
+
+        std::optional< std::vector< dependency > > read_manifest(string_ref text) {
+            std::vector< dependency > deps;
+            while (!text.empty()) {
+                auto [line, rest] = text.split('\n');
+                text = rest;
+
+                auto [hash, path] = line.split(' ');
+                if (hash.size() != 64 || path.empty()) {
+                    return std::nullopt;
+                }
+                deps.push_back({ path.str(), hash.str() });
+            }
+            return deps;
+        }
+
+        bool write_cache_file(string_ref path, string_ref data) {
+            llvm::SmallString< 256 > tmp;
+            int fd;
+            if (llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd, tmp)) {
+                return false;
+            }
+
+            bool written = [&] {
+                llvm::raw_fd_ostream os(fd, /* should close */ true);
+                os << data;
+                os.close();
+                return !os.has_error();
+            } ();
+
+            if (!written || llvm::sys::fs::rename(tmp, path)) {
+                llvm::sys::fs::remove(tmp);
+                return false;
+            }
+
+            return true;
+        }
+
+        std::optional< std::string > read_cache_file(const llvm::Twine &path) {
+            auto buffer = llvm::MemoryBuffer::getFile(
+                path, /* text */ false, /* null terminated */ false
+            );
+            if (!buffer) {
+                return std::nullopt;
+            }
+            return buffer.get()->getBuffer().str();
+        }
+
+        bool is_cache_option(string_ref arg) {
+            for (auto opt : {
+                opt::cache_dir, opt::cache_base_dir, opt::remote_cache,
+                opt::no_remote_cache_upload, opt::header_cache, opt::function_cache
+            }) {
+                if (arg.starts_with((vast_option_prefix + opt).str())) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        struct local_storage final : cache_storage
+        {
+            explicit local_storage(string_ref dir) : dir(dir.str()) {}
+
+            std::optional< std::string > get(entry_kind kind, string_ref key) override {
+                return read_cache_file(entry_path(kind, key));
+            }
+
+            void put(entry_kind kind, string_ref key, string_ref data) override {
+                if (!llvm::sys::fs::create_directories(dir)) {
+                    write_cache_file(entry_path(kind, key), data);
+                }
+            }
+
+            std::string entry_path(entry_kind kind, string_ref key) const {
+                auto ext = kind == entry_kind::manifest ? ".manifest" : ".out";
+                llvm::SmallString< 256 > path(dir);
+                llvm::sys::path::append(path, key + ext);
+                return path.str().str();
+            }
+
+            std::string dir;
+        };
+
+        // Placeholder of the base directory in hashed paths.
+        constexpr string_ref base_placeholder = "<base>";
+
+        bool is_under(string_ref path, string_ref base) {
+            return !base.empty() && path.starts_with(base)
+                && (path.size() == base.size() || llvm::sys::path::is_separator(path[base.size()]));
+        }
+
+        // Arguments may contain paths joined with options, e.g., `-I<path>`.
+        std::string relocate_arg(string_ref arg, string_ref base) {
+            if (base.empty()) {
+                return arg.str();
+            }
+
+            std::string result;
+            while (!arg.empty()) {
+                auto pos = arg.find(base);
+                if (pos == string_ref::npos) {
+                    result += arg;
+                    break;
+                }
+
+                result += arg.take_front(pos);
+                arg = arg.drop_front(pos);
+                if (is_under(arg, base)) {
+                    result += base_placeholder;
+                } else {
+                    result += base;
+                }
+                arg = arg.drop_front(base.size());
+            }
+            return result;
+        }
+
+    } // namespace
+
+    cache_storage_ptr make_local_storage(string_ref dir) {
+        return std::make_unique< local_storage >(dir);
+    }
+
+    output_cache::output_cache(
+        std::vector< cache_storage_ptr > storages, std::string invocation, std::string base_dir
+    )
+        : storages(std::move(storages)), invocation(std::move(invocation)), base_dir(std::move(base_dir))
+    {}
+
+    std::string output_cache::relocate(string_ref path) const {
+        if (!is_under(path, base_dir)) {
+            return path.str();
+        }
+        return (base_placeholder + path.drop_front(base_dir.size())).str();
+    }
+
+    std::string output_cache::resolve(string_ref path) const {
+        if (!path.starts_with(base_placeholder)) {
+            return path.str();
+        }
+        return (base_dir + path.drop_front(base_placeholder.size())).str();
+    }
+
+    std::string output_cache::result_hash(llvm::ArrayRef< dependency > deps) const {
+        content_hasher hash;
+        hash.add(invocation);
+        for (const auto &dep : deps) {
+            hash.add(dep.path);
+            hash.add(dep.hash);
+        }
+        return hash.finish();
+    }
+
+    std::optional< std::string > output_cache::lookup() const {
+        using entry_kind = cache_storage::entry_kind;
+
+        for (std::size_t idx = 0; idx < storages.size(); ++idx) {
+            auto manifest = storages[idx]->get(entry_kind::manifest, invocation);
+            if (!manifest) {
+                continue;
+            }
+
+            auto deps = read_manifest(*manifest);
+            if (!deps) {
+                continue;
+            }
+
+            bool unchanged = llvm::all_of(*deps, [&] (const dependency &dep) {
+                auto contents = read_cache_file(resolve(dep.path));
+                return contents && content_hash(*contents) == dep.hash;
+            });
+
+            if (!unchanged) {
+                continue;
+            }
+
+            auto result = result_hash(*deps);
+            auto output = storages[idx]->get(entry_kind::output, result);
+            if (!output) {
+                continue;
+            }
+
+            for (std::size_t prev = 0; prev < idx; ++prev) {
+                storages[prev]->put(entry_kind::output, result, *output);
+                storages[prev]->put(entry_kind::manifest, invocation, *manifest);
+            }
+
+            return output;
+        }
+
+        return std::nullopt;
+    }
+
+    void output_cache::record_dependencies(const clang::SourceManager &sm) {
+        dependencies.clear();
+
+        auto main_offset = sm.getSLocEntry(sm.getMainFileID()).getOffset();
+
+        llvm::StringSet<> seen;
+        for (unsigned idx = 0; idx < sm.local_sloc_entry_size(); ++idx) {
+            const auto &entry = sm.getLocalSLocEntry(idx);
+            if (!entry.isFile() || entry.getOffset() == main_offset) {
+                continue;
+            }
+
+            // Predefines and the command line are covered by the invocation.
+            const auto &file = entry.getFile();
+            auto name = file.getName();
+            if (name.empty() || name.starts_with("<")) {
+                continue;
+            }
+
+            llvm::SmallString< 256 > path(name);
+            sm.getFileManager().makeAbsolutePath(path);
+            if (!seen.insert(path).second) {
+                continue;
+            }
+
+            auto buffer = file.getContentCache().getBufferIfLoaded();
+            if (!buffer) {
+                continue;
+            }
+
+            dependencies.push_back({ relocate(path), content_hash(buffer->getBuffer()) });
+        }
+    }
+
+    void output_cache::store(string_ref output) const {
+        using entry_kind = cache_storage::entry_kind;
+
+        auto result   = result_hash(dependencies);
+        auto manifest = write_manifest(dependencies);
+
+        // The output is written first, so that a manifest rarely refers to
+        // a missing output.
+        for (const auto &storage : storages) {
+            storage->put(entry_kind::output, result, output);
+            storage->put(entry_kind::manifest, invocation, manifest);
+        }
+    }
+
+    namespace
+    {
+        std::string cache_base_dir(const vast_args &vargs) {
+            llvm::SmallString< 256 > base;
+            if (auto dir = vargs.get_option(opt::cache_base_dir); dir && !dir->empty()) {
+                base = dir.value();
+                llvm::sys::fs::make_absolute(base);
+                llvm::sys::path::remove_dots(base, /* remove dot dot */ true);
+                while (base.size() > 1 && llvm::sys::path::is_separator(base.back())) {
+                    base.pop_back();
+                }
+            }
+            return base.str().str();
+        }
+
+        // Outputs of a single input file can be cached.
+        std::optional< string_ref > cached_input(
+            compiler_instance &ci, output_type act, const vast_args &vargs
+        ) {
+            if (act != output_type::emit_mlir && act != output_type::emit_mlir_bytecode) {
+                return std::nullopt;
+            }
+
+            if (vargs.has_option(opt::vast_verify_diags) || vargs.has_option(opt::debug)) {
+                return std::nullopt;
+            }
+
+            const auto &inputs = ci.getFrontendOpts().Inputs;
+            if (inputs.size() != 1 || !inputs.front().isFile() || inputs.front().getFile() == "-") {
+                return std::nullopt;
+            }
+
+            return inputs.front().getFile();
+        }
+
+        // Hashes the invocation except the contents of the main file.
+        void hash_invocation(
+            content_hasher &hash, compiler_instance &ci, output_type act,
+            const vast_args &vargs, string_ref input, string_ref base
+        ) {
+            hash.add(format);
+            hash.add(VAST_VERSION_STRING);
+            hash.add(std::uint64_t(act));
+
+            // The output file does not affect the output.
+            auto args = ci.getInvocation().getCC1CommandLine();
+            for (std::size_t idx = 0; idx < args.size(); ++idx) {
+                if (args[idx] == "-o") {
+                    ++idx;
+                    continue;
+                }
+                hash.add(relocate_arg(args[idx], base));
+            }
+
+            for (auto arg : vargs.args) {
+                if (!is_cache_option(arg)) {
+                    hash.add(relocate_arg(arg, base));
+                }
+            }
+
+            llvm::SmallString< 256 > cwd(ci.getFileSystemOpts().WorkingDir);
+            if (cwd.empty()) {
+                llvm::sys::fs::current_path(cwd);
+            }
+            hash.add(relocate_arg(cwd, base));
+
+            hash.add(relocate_arg(input, base));
+        }
+
+    } // namespace
+
+    std::optional< output_cache > make_output_cache(
+        compiler_instance &ci, output_type act, const vast_args &vargs
+    ) {
+        std::vector< cache_storage_ptr > storages;
+        if (auto dir = vargs.get_option(opt::cache_dir); dir && !dir->empty()) {
+            storages.push_back(make_local_storage(dir.value()));
+        }
+
+        if (auto url = vargs.get_option(opt::remote_cache); url && !url->empty()) {
+            storages.push_back(make_remote_storage(url.value(), vargs.has_option(opt::no_remote_cache_upload)));
+        }
+
+        if (storages.empty()) {
+            return std::nullopt;
+        }
+
+        auto input = cached_input(ci, act, vargs);
+        if (!input) {
+            return std::nullopt;
+        }
+
+        auto main = ci.getFileManager().getBufferForFile(*input);
+        if (!main) {
+            return std::nullopt;
+        }
+
+        auto base = cache_base_dir(vargs);
+
+        content_hasher hash;
+        hash_invocation(hash, ci, act, vargs, *input, base);
+        hash.add(main.get()->getBuffer());
+
+        return output_cache(std::move(storages), hash.finish(), base);
+    }
+
+    function_cache::function_cache(cache_storage_ptr storage, std::string invocation, bool locs)
+        : storage(std::move(storage)), invocation(std::move(invocation)), locs(locs)
+    {}
+
+    std::string function_cache::fingerprint(operation fn) const {
+        content_hasher hash;
+        hash.add(invocation);
+        hash.add(mlir::SymbolTable::getSymbolName(fn).getValue());
+        hash.add(analysis::body_hash(mlir::cast< mlir::FunctionOpInterface >(fn)));
+
+        auto print = [] (auto &&entity) {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            entity.print(os);
+            return os.str();
+        };
+
+        // The pipeline may depend on the declarations of the callees, e.g.,
+        // their types and attributes, but not on their bodies.
+        std::vector< std::string > callees;
+        fn->walk([&] (hl::CallOp call) {
+            auto callee = mlir::SymbolTable::lookupNearestSymbolFrom(call, call.getCalleeAttr());
+            if (!callee) {
+                callees.push_back(call.getCallee().str());
+                return;
+            }
+
+            auto signature = call.getCallee().str();
+            for (auto attr : callee->getAttrs()) {
+                signature += ' ' + attr.getName().str() + '=' + print(attr.getValue());
+            }
+            callees.push_back(std::move(signature));
+        });
+
+        std::sort(callees.begin(), callees.end());
+        callees.erase(std::unique(callees.begin(), callees.end()), callees.end());
+
+        hash.add(std::uint64_t(callees.size()));
+        for (const auto &callee : callees) {
+            hash.add(callee);
+        }
+
+        if (locs) {
+            fn->walk([&] (operation op) { hash.add(print(op->getLoc())); });
+        }
+
+        return hash.finish();
+    }
+
+    std::optional< std::string > function_cache::lookup(string_ref fingerprint) {
+        auto output = storage->get(cache_storage::entry_kind::output, fingerprint);
+        ++(output ? _hits : _misses);
+        return output;
+    }
+
+    void function_cache::store(string_ref fingerprint, string_ref output) const {
+        storage->put(cache_storage::entry_kind::output, fingerprint, output);
+    }
+
+    std::optional< function_cache > make_function_cache(
+        compiler_instance &ci, output_type act, const vast_args &vargs
+    ) {
+        auto dir = vargs.get_option(opt::function_cache);
+        if (!dir || dir->empty() || !vargs.has_option(opt::stream_functions)) {
+            return std::nullopt;
+        }
+
+        auto input = cached_input(ci, act, vargs);
+        if (!input) {
+            return std::nullopt;
+        }
+
+        content_hasher hash;
+        hash.add("function");
+        hash_invocation(hash, ci, act, vargs, *input, cache_base_dir(vargs));
+
+        return function_cache(
+            make_local_storage(dir.value()), hash.finish(), vargs.has_option(opt::show_locs)
+        );
+    }
+
+} // namespace vast::cc
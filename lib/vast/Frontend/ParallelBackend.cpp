@@ -0,0 +1,158 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/ParallelBackend.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Context.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <optional>
+
+namespace vast::cc {
+
+    namespace {
+
+        using bitcode_t = llvm::SmallVector< char, 0 >;
+
+        bitcode_t write_bitcode(const llvm::Module &mod) {
+            bitcode_t buffer;
+            llvm::raw_svector_ostream os(buffer);
+            llvm::WriteBitcodeToFile(mod, os);
+            return buffer;
+        }
+
+        std::unique_ptr< llvm::Module > read_bitcode(const bitcode_t &bitcode, llvm::LLVMContext &ctx) {
+            auto buffer = llvm::MemoryBufferRef(
+                llvm::StringRef(bitcode.data(), bitcode.size()), "vast-partition"
+            );
+
+            auto mod = llvm::parseBitcodeFile(buffer, ctx);
+            if (!mod) {
+                VAST_FATAL("failed to read module partition: {0}", llvm::toString(mod.takeError()));
+            }
+            return std::move(*mod);
+        }
+
+        llvm::OptimizationLevel optimization_level(const codegen_options &codegen) {
+            switch (codegen.OptimizationLevel) {
+                case 0: return llvm::OptimizationLevel::O0;
+                case 1: return llvm::OptimizationLevel::O1;
+                case 2:
+                    switch (codegen.OptimizeSize) {
+                        case 0:  return llvm::OptimizationLevel::O2;
+                        case 1:  return llvm::OptimizationLevel::Os;
+                        default: return llvm::OptimizationLevel::Oz;
+                    }
+                default: return llvm::OptimizationLevel::O3;
+            }
+        }
+
+        // Target machine provides the target information to the optimization
+        // pipeline, code generation options do not matter here.
+        std::unique_ptr< llvm::TargetMachine > make_target_machine(const target_options &target) {
+            std::string error;
+            auto trg = llvm::TargetRegistry::lookupTarget(target.Triple, error);
+            if (!trg) {
+                VAST_FATAL("unknown target {0}: {1}", target.Triple, error);
+            }
+
+            return std::unique_ptr< llvm::TargetMachine >(trg->createTargetMachine(
+                target.Triple, target.CPU, llvm::join(target.Features, ","),
+                llvm::TargetOptions(), std::nullopt
+            ));
+        }
+
+        bitcode_t optimize_partition(
+            const bitcode_t &bitcode, const codegen_options &codegen, const target_options &target
+        ) {
+            llvm::LLVMContext ctx;
+            auto mod = read_bitcode(bitcode, ctx);
+            auto tm  = make_target_machine(target);
+
+            llvm::LoopAnalysisManager lam;
+            llvm::FunctionAnalysisManager fam;
+            llvm::CGSCCAnalysisManager cgam;
+            llvm::ModuleAnalysisManager mam;
+
+            llvm::PassBuilder pb(tm.get());
+            pb.registerModuleAnalyses(mam);
+            pb.registerCGSCCAnalyses(cgam);
+            pb.registerFunctionAnalyses(fam);
+            pb.registerLoopAnalyses(lam);
+            pb.crossRegisterProxies(lam, fam, cgam, mam);
+
+            auto mpm = pb.buildPerModuleDefaultPipeline(optimization_level(codegen));
+            mpm.run(*mod, mam);
+
+            return write_bitcode(*mod);
+        }
+
+    } // namespace
+
+    std::unique_ptr< llvm::Module > optimize_in_partitions(
+        std::unique_ptr< llvm::Module > mod, unsigned partitions,
+        const codegen_options &codegen, const target_options &target
+    ) {
+        llvm::StringMap< llvm::GlobalValue::LinkageTypes > locals;
+        for (const auto &gv : mod->global_values()) {
+            if (gv.hasLocalLinkage() && gv.hasName()) {
+                locals[gv.getName()] = gv.getLinkage();
+            }
+        }
+
+        std::vector< bitcode_t > parts;
+        llvm::SplitModule(*mod, partitions, [&] (std::unique_ptr< llvm::Module > part) {
+            parts.push_back(write_bitcode(*part));
+        }, false /* preserve locals */);
+
+        // Partitions run on the workers of the process if it has them.
+        {
+            std::optional< llvm::ThreadPool > own;
+            auto pool = shared_thread_pool();
+            if (!pool) {
+                pool = &own.emplace(llvm::hardware_concurrency(partitions));
+            }
+
+            llvm::ThreadPoolTaskGroup group(*pool);
+            for (auto &part : parts) {
+                group.async([&] { part = optimize_partition(part, codegen, target); });
+            }
+            group.wait();
+        }
+
+        auto &ctx   = mod->getContext();
+        auto linked = std::make_unique< llvm::Module >(mod->getModuleIdentifier(), ctx);
+        linked->setDataLayout(mod->getDataLayout());
+        linked->setTargetTriple(mod->getTargetTriple());
+        mod.reset();
+
+        llvm::Linker linker(*linked);
+        for (const auto &part : parts) {
+            if (linker.linkInModule(read_bitcode(part, ctx))) {
+                VAST_FATAL("failed to link optimized module partitions");
+            }
+        }
+
+        for (auto &gv : linked->global_values()) {
+            if (auto it = locals.find(gv.getName()); it != locals.end()) {
+                gv.setLinkage(it->second);
+                gv.setVisibility(llvm::GlobalValue::DefaultVisibility);
+            }
+        }
+
+        return linked;
+    }
+
+} // namespace vast::cc
@@ -2,9 +2,32 @@
 
 #include "vast/Frontend/Pipelines.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/CodeGenDriver.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/Passes.hpp"
 #include "vast/Conversion/Passes.hpp"
 
+#include "vast/Frontend/Context.hpp"
+
+#include "vast/Util/IRChurn.hpp"
+#include "vast/Util/MemoryLimit.hpp"
+#include "vast/Util/PatternStats.hpp"
+#include "vast/Util/PipelineStats.hpp"
+#include "vast/Util/TimeBudget.hpp"
+#include "vast/Util/Trace.hpp"
+
+#include <chrono>
+#include <mutex>
+
 namespace vast::cc {
 
     namespace pipeline {
@@ -64,8 +87,119 @@ namespace vast::cc {
             return vargs.has_option(disable_step_option);
         }
 
+        bool on_path(const conversion_path &path, target_dialect dialect) {
+            return llvm::any_of(path, [dialect] (const auto &entry) {
+                return entry.first == dialect;
+            });
+        }
+
+        std::size_t position(const conversion_path &path, target_dialect dialect) {
+            auto it = llvm::find_if(path, [dialect] (const auto &entry) {
+                return entry.first == dialect;
+            });
+            return std::size_t(std::distance(path.begin(), it));
+        }
+
+        //
+        // Writes the module as bytecode once the pipeline reaches a dialect
+        // requested by -vast-snapshot. If the dialect is marked, so is the
+        // snapshot, the module itself is left as is.
+        //
+        struct snapshot_pass
+            : mlir::PassWrapper< snapshot_pass, mlir::OperationPass< mlir::ModuleOp > >
+        {
+            MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(snapshot_pass)
+
+            snapshot_pass() = default;
+            snapshot_pass(const snapshot_pass &other) : PassWrapper(other) {}
+
+            string_ref getArgument() const final { return "vast-snapshot"; }
+
+            string_ref getDescription() const final {
+                return "Writes the module as bytecode at a point of the pipeline";
+            }
+
+            void runOnOperation() final {
+                auto mod = getOperation();
+
+                auto previous = mod->getAttr(reached_dialect_attr_name);
+                if (!dialect.empty()) {
+                    mark_reached_dialect(mod, parse_target_dialect(dialect));
+                }
+
+                std::error_code ec;
+                llvm::raw_fd_ostream os(path, ec, llvm::sys::fs::OF_None);
+                if (ec) {
+                    mod.emitError() << "unable to open snapshot '" << path << "': " << ec.message();
+                    return signalPassFailure();
+                }
+
+                mlir::BytecodeWriterConfig config("vast");
+                if (mlir::failed(mlir::writeBytecodeToFile(mod, os, config))) {
+                    mod.emitError() << "failed to write snapshot '" << path << "'";
+                    return signalPassFailure();
+                }
+
+                if (previous) {
+                    mod->setAttr(reached_dialect_attr_name, previous);
+                } else {
+                    mod->removeAttr(reached_dialect_attr_name);
+                }
+                markAllAnalysesPreserved();
+            }
+
+            Option< std::string > path{ *this, "path", llvm::cl::desc("File of the snapshot") };
+            Option< std::string > dialect{
+                *this, "dialect", llvm::cl::desc("Dialect the snapshot is marked by")
+            };
+        };
+
+        std::unique_ptr< mlir::Pass > snapshot(string_ref path, std::optional< target_dialect > reached) {
+            auto pass  = std::make_unique< snapshot_pass >();
+            pass->path = path.str();
+            if (reached) {
+                pass->dialect = to_string(*reached);
+            }
+            return pass;
+        }
+
+        using snapshot_list = std::vector< std::pair< target_dialect, std::string > >;
+
+        // Snapshots of -vast-snapshot in the order of the conversion path.
+        snapshot_list snapshots(target_dialect trg, const vast_args &vargs) {
+            snapshot_list result;
+            auto list = vargs.get_options_list(opt::snapshot);
+            if (!list) {
+                return result;
+            }
+
+            const auto &path = default_conversion_path;
+            for (auto entry : *list) {
+                auto [name, file] = entry.split('=');
+                VAST_CHECK(!file.empty(), "expected -vast-snapshot entry of form <dialect>=<file>: {0}", entry);
+
+                auto dialect = parse_target_dialect(name);
+                VAST_CHECK(
+                    on_path(path, dialect) && position(path, dialect) <= position(path, trg),
+                    "snapshot dialect {0} is not reached on the way to {1}", name, to_string(trg)
+                );
+                result.emplace_back(dialect, file.str());
+            }
+
+            llvm::stable_sort(result, [&] (const auto &a, const auto &b) {
+                return position(path, a.first) < position(path, b.first);
+            });
+            return result;
+        }
+
+        //
+        // Yields steps of the conversion path that lead from the `reached`
+        // dialect (exclusive) to the target `trg` (inclusive). If nothing was
+        // reached yet, the path is taken from its beginning.
+        //
         gap::generator< pipeline_step_ptr > conversion(
             pipeline_source src,
+            std::optional< target_dialect > reached,
             target_dialect trg,
             const vast_args &vargs
         ) {
@@ -79,7 +213,18 @@ namespace vast::cc {
                 co_return;
             }
 
+            bool skip = reached.has_value() && on_path(path, reached.value());
+
             for (const auto &[dialect, step_passes] : path) {
+                if (skip) {
+                    VAST_REPORT("Skipping conversion to already reached dialect: {0}", to_string(dialect));
+                    skip = dialect != reached.value();
+                    if (trg == dialect) {
+                        break;
+                    }
+                    continue;
+                }
+
                 for (auto &step : step_passes) {
                     auto pipeline_step = step();
                     if (is_disabled(pipeline_step, vargs)) {
@@ -96,15 +241,322 @@ namespace vast::cc {
             }
         }
 
+        static bool is_vast_dialect(mlir::Dialect *dialect) {
+            if (!dialect) {
+                return false;
+            }
+
+            auto ns = dialect->getNamespace();
+            return ns == hl::HighLevelDialect::getDialectNamespace()
+                || ns == ll::LowLevelDialect::getDialectNamespace()
+                || ns == core::CoreDialect::getDialectNamespace()
+                || ns == abi::ABIDialect::getDialectNamespace()
+                || ns == "unsup" || ns == "meta";
+        }
+
+        static bool is_high_level_type(mlir_type type) {
+            return type.getDialect().getNamespace() == hl::HighLevelDialect::getDialectNamespace();
+        }
+
+        //
+        // Conservatively infers reached dialect:
+        //  - module without vast operations were already lowered to llvm,
+        //  - module without high-level types were lowered to std,
+        //  - otherwise we cannot skip any step.
+        //
+        std::optional< target_dialect > infer_reached_dialect(vast_module mod) {
+            bool has_vast_ops = false;
+
+            auto result = mod->walk([&] (operation op) {
+                has_vast_ops |= is_vast_dialect(op->getDialect());
+
+                if (llvm::any_of(op->getResultTypes(), is_high_level_type)) {
+                    return mlir::WalkResult::interrupt();
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        if (llvm::any_of(block.getArgumentTypes(), is_high_level_type)) {
+                            return mlir::WalkResult::interrupt();
+                        }
+                    }
+                }
+
+                return mlir::WalkResult::advance();
+            });
+
+            if (result.wasInterrupted()) {
+                return std::nullopt;
+            }
+
+            return has_vast_ops ? target_dialect::std : target_dialect::llvm;
+        }
+
+        // Function instrumentation configured by -vast-instrument-*.
+        std::unique_ptr< mlir::Pass > instrument_functions(string_ref mode, const vast_args &vargs) {
+            auto options = ("mode=" + mode).str();
+            if (auto filter = vargs.get_option(opt::instrument_filter)) {
+                options += " filter=\"" + filter->str() + "\"";
+            }
+            if (auto roots = vargs.get_options_list(opt::instrument_roots)) {
+                options += " roots=" + llvm::join(*roots, ",");
+            }
+            if (auto period = vargs.get_option(opt::instrument_sample_period)) {
+                options += " sample-period=" + period->str();
+            }
+
+            auto pass = hl::createInstrumentFunctionsPass();
+            if (mlir::failed(pass->initializeOptions(options))) {
+                VAST_FATAL("invalid function instrumentation options: {0}", options);
+            }
+            return pass;
+        }
+
+        // Inlining of small functions configured by -vast-hl-inline.
+        std::unique_ptr< mlir::Pass > inline_functions(const vast_args &vargs) {
+            auto pass = hl::createInlineFunctionsPass();
+            if (auto threshold = vargs.get_option(opt::hl_inline)) {
+                auto options = ("threshold=" + *threshold).str();
+                if (mlir::failed(pass->initializeOptions(options))) {
+                    VAST_FATAL("invalid inlining options: {0}", options);
+                }
+            }
+            return pass;
+        }
+
+        std::unique_ptr< pipeline_t > setup_pipeline(
+            pipeline_source src,
+            std::optional< target_dialect > reached,
+            target_dialect trg,
+            mcontext_t &mctx,
+            const vast_args &vargs
+        );
+
     } // namespace pipeline
 
+    std::optional< target_dialect > reached_dialect(vast_module mod) {
+        if (auto attr = mod->getAttrOfType< mlir::StringAttr >(reached_dialect_attr_name)) {
+            return parse_target_dialect(attr.getValue());
+        }
+
+        return pipeline::infer_reached_dialect(mod);
+    }
+
+    void mark_reached_dialect(vast_module mod, target_dialect trg) {
+        mod->setAttr(
+            reached_dialect_attr_name,
+            mlir::StringAttr::get(mod.getContext(), to_string(trg))
+        );
+    }
+
+    std::unique_ptr< pipeline_t > setup_pipeline(
+        pipeline_source src,
+        target_dialect trg,
+        mcontext_t &mctx,
+        const vast_args &vargs
+    ) {
+        VAST_CHECK(src == pipeline_source::ast, "expected ast source, use module to setup mlir pipeline");
+        return pipeline::setup_pipeline(src, std::nullopt, trg, mctx, vargs);
+    }
+
     std::unique_ptr< pipeline_t > setup_pipeline(
+        vast_module mod,
+        target_dialect trg,
+        mcontext_t &mctx,
+        const vast_args &vargs
+    ) {
+        return pipeline::setup_pipeline(
+            pipeline_source::mlir, reached_dialect(mod), trg, mctx, vargs
+        );
+    }
+
+    verifier_mode get_verifier_mode(const vast_args &vargs) {
+        auto mode = vargs.get_option(opt::verifier).value_or("all");
+        if (mode == "none") {
+            return verifier_mode::none;
+        }
+        if (mode == "checkpoints") {
+            return verifier_mode::checkpoints;
+        }
+        if (mode == "all") {
+            return verifier_mode::all;
+        }
+        VAST_FATAL("unknown -vast-verifier mode: {0}", mode);
+    }
+
+    namespace pipeline {
+
+        // Schedules the step, followed by a checkpoint if the pipeline
+        // verifies only at step boundaries, and by the census of the IR if
+        // requested (-vast-ir-census).
+        void schedule_step(
+            pipeline_t &passes, pipeline_step_ptr step, verifier_mode mode, const vast_args &vargs
+        ) {
+            auto name = step->name().str();
+            passes << std::move(step);
+            if (mode == verifier_mode::checkpoints) {
+                passes.add_checkpoint();
+            }
+
+            if (vargs.has_option(opt::ir_census)) {
+                passes.add_census(name);
+            }
+        }
+
+        // Checks the memory budget at pass boundaries (-vast-memory-limit).
+        void limit_memory(pipeline_t &passes, const vast_args &vargs) {
+            if (auto limit_kb = opt::memory_limit_kb(vargs)) {
+                passes.addInstrumentation(std::make_unique< memory_limit_instrumentation >(
+                    passes, memory_limit(*limit_kb)
+                ));
+            }
+        }
+
+        //
+        // Accumulates the time of passes anchored on functions, which may run
+        // in parallel, and once a function exceeds the budget
+        // (-vast-function-budget), stubs its body before the next pass, so
+        // that the remaining passes run on the stub. Passes anchored on the
+        // module are not attributed to functions. Functions that are hot in
+        // the profile (-fprofile-instr-use) are never stubbed.
+        //
+        struct function_budget_instrumentation : mlir::PassInstrumentation
+        {
+            using clock = time_budget::clock;
+
+            explicit function_budget_instrumentation(std::chrono::milliseconds limit)
+                : limit(limit)
+            {}
+
+            void runBeforePass(mlir::Pass *, operation op) final {
+                auto fn = mlir::dyn_cast< hl::FuncOp >(op);
+                if (!fn || fn.isDeclaration()) {
+                    return;
+                }
+
+                if (fn->hasAttr(hl::HighLevelDialect::getProfileHotAttrName())) {
+                    return;
+                }
+
+                if (auto spent = take_exceeded(op)) {
+                    cg::stub_function_body(fn, "FunctionBudget");
+                    fn.emitRemark() << "passes of the function exceeded the function budget of "
+                                    << limit.count() << " ms (" << spent->count()
+                                    << " ms), its body is replaced by a stub";
+                }
+
+                std::scoped_lock lock(mutex);
+                functions[op].started = clock::now();
+            }
+
+            void runAfterPass(mlir::Pass *, operation op) final { finish(op); }
+            void runAfterPassFailed(mlir::Pass *, operation op) final { finish(op); }
+
+          private:
+            struct function_time
+            {
+                clock::time_point started;
+                clock::duration spent = {};
+                bool stubbed = false;
+            };
+
+            // Returns the time spent on the function the first time it
+            // exceeds the budget.
+            std::optional< std::chrono::milliseconds > take_exceeded(operation op) {
+                std::scoped_lock lock(mutex);
+                auto it = functions.find(op);
+                if (it == functions.end() || it->second.stubbed || it->second.spent < limit) {
+                    return std::nullopt;
+                }
+
+                it->second.stubbed = true;
+                return std::chrono::duration_cast< std::chrono::milliseconds >(it->second.spent);
+            }
+
+            void finish(operation op) {
+                if (!mlir::isa< hl::FuncOp >(op)) {
+                    return;
+                }
+
+                std::scoped_lock lock(mutex);
+                if (auto it = functions.find(op); it != functions.end()) {
+                    it->second.spent += clock::now() - it->second.started;
+                }
+            }
+
+            const std::chrono::milliseconds limit;
+
+            std::mutex mutex;
+            llvm::DenseMap< operation, function_time > functions;
+        };
+
+        // Stubs functions that take too long in the pipeline (-vast-function-budget).
+        void limit_function_time(pipeline_t &passes, const vast_args &vargs) {
+            if (auto budget_ms = opt::function_budget_ms(vargs)) {
+                passes.addInstrumentation(std::make_unique< function_budget_instrumentation >(
+                    std::chrono::milliseconds(*budget_ms)
+                ));
+            }
+        }
+
+        // Records passes into the trace of the translation unit (-vast-trace).
+        void trace_passes(pipeline_t &passes) {
+            if (auto recorder = trace_recorder::current()) {
+                passes.addInstrumentation(
+                    std::make_unique< trace_instrumentation >(passes, *recorder)
+                );
+            }
+        }
+
+    } // namespace pipeline
+
+    bool has_function_local_pipeline(target_dialect trg, const vast_args &vargs) {
+        // every step of the conversion path contains module-level passes,
+        // and so do the inlining, the function instrumentation and the
+        // snapshots
+        return trg == target_dialect::high_level
+            && !vargs.has_option(opt::simplify)
+            && !vargs.has_option(opt::hl_inline)
+            && !vargs.has_option(opt::snapshot)
+            && !vargs.has_option(opt::instrument_functions);
+    }
+
+    std::unique_ptr< pipeline_t > setup_function_pipeline(
+        target_dialect trg,
+        mcontext_t &mctx,
+        const vast_args &vargs
+    ) {
+        VAST_CHECK(
+            has_function_local_pipeline(trg, vargs),
+            "no function local pipeline to target: {0}", to_string(trg)
+        );
+
+        auto mode   = get_verifier_mode(vargs);
+        auto passes = std::make_unique< pipeline_t >(&mctx, hl::FuncOp::getOperationName());
+        passes->enableVerifier(mode == verifier_mode::all);
+        pipeline::schedule_step(*passes, pipeline::codegen(), mode, vargs);
+
+        if (vargs.has_option(opt::print_pipeline)) {
+            passes->dump();
+        }
+
+        pipeline::trace_passes(*passes);
+        pipeline::limit_memory(*passes, vargs);
+        pipeline::limit_function_time(*passes, vargs);
+
+        return passes;
+    }
+
+    std::unique_ptr< pipeline_t > pipeline::setup_pipeline(
         pipeline_source src,
+        std::optional< target_dialect > reached,
         target_dialect trg,
         mcontext_t &mctx,
         const vast_args &vargs
     ) {
+        auto mode   = get_verifier_mode(vargs);
         auto passes = std::make_unique< pipeline_t >(&mctx);
+        passes->enableVerifier(mode == verifier_mode::all);
 
         passes->enableIRPrinting(
             [](auto *, auto *) { return false; }, // before
@@ -117,22 +569,75 @@ namespace vast::cc {
 
         // generate high level MLIR in case of AST input
         if (pipeline_source::ast == src) {
-            *passes << pipeline::codegen();
+            pipeline::schedule_step(*passes, pipeline::codegen(), mode, vargs);
+        }
+
+        // Inlines before the instrumentation, so that only the functions
+        // that remain are instrumented.
+        if (vargs.has_option(opt::hl_inline)) {
+            passes->addPass(pipeline::inline_functions(vargs));
+        }
+
+        // Instruments the module before its conversions, so that the hooks
+        // are lowered together with the functions.
+        if (auto instrument = vargs.get_option(opt::instrument_functions)) {
+            passes->addPass(pipeline::instrument_functions(*instrument, vargs));
+        }
+
+        // Snapshots split the conversion at their dialects. A dialect counts
+        // as reached only if it is marked, so that the high level reduction
+        // still runs after a snapshot of unsimplified high level MLIR.
+        for (const auto &[dialect, file] : pipeline::snapshots(trg, vargs)) {
+            for (auto &&step : pipeline::conversion(src, reached, dialect, vargs)) {
+                pipeline::schedule_step(*passes, std::move(step), mode, vargs);
+            }
+
+            bool marked = dialect != target_dialect::high_level || vargs.has_option(opt::simplify);
+            passes->addPass(pipeline::snapshot(file, marked ? std::optional(dialect) : std::nullopt));
+            if (marked) {
+                reached = dialect;
+            }
         }
 
         // Apply desired conversion to target dialect, if target is llvm or
         // binary/assembly. We perform entire conversion to llvm dialect. Vargs
         // can specify how we want to convert to llvm dialect and allows to turn
         // off optional pipelines.
-        for (auto &&step : pipeline::conversion(src, trg, vargs)) {
-            *passes << std::move(step);
+        for (auto &&step : pipeline::conversion(src, reached, trg, vargs)) {
+            pipeline::schedule_step(*passes, std::move(step), mode, vargs);
         }
 
         if (vargs.has_option(opt::print_pipeline)) {
             passes->dump();
         }
 
-        if (vargs.has_option(opt::disable_multithreading) || vargs.has_option(opt::emit_crash_reproducer)) {
+        if (vargs.has_option(opt::pipeline_stats)) {
+            auto stats_path = vargs.get_option(opt::pipeline_stats);
+            VAST_CHECK(stats_path.has_value(), "expected path to pipeline statistics file");
+            passes->addInstrumentation(
+                std::make_unique< pipeline_stats_instrumentation >(*passes, stats_path->str())
+            );
+        }
+
+        if (vargs.has_option(opt::pattern_stats)) {
+            passes->addInstrumentation(std::make_unique< pattern_stats_instrumentation >());
+        }
+
+        if (vargs.has_option(opt::ir_churn)) {
+            passes->addInstrumentation(std::make_unique< ir_churn_instrumentation >());
+        }
+
+        pipeline::trace_passes(*passes);
+        pipeline::limit_memory(*passes, vargs);
+        pipeline::limit_function_time(*passes, vargs);
+
+        // Threading of the shared context is decided by the whole process.
+        if (is_shared_mcontext(mctx)) {
+            VAST_CHECK(
+                !vargs.has_option(opt::emit_crash_reproducer),
+                "-vast-emit-crash-reproducer requires a context per unit"
+            );
+        } else if (vargs.has_option(opt::disable_multithreading) || vargs.has_option(opt::emit_crash_reproducer)) {
             mctx.disableMultithreading();
         }
 
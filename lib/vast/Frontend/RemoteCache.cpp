@@ -0,0 +1,470 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/RemoteCache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#ifdef LLVM_ON_UNIX
+    #include <netdb.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+#endif
+
+namespace vast::cc
+{
+    namespace
+    {
+        using entry_kind = cache_storage::entry_kind;
+
+        string_ref output_name(entry_kind kind) {
+            return kind == entry_kind::manifest ? "manifest" : "output";
+        }
+
+        std::string cas_digest(string_ref data) {
+            auto bytes = llvm::arrayRefFromStringRef< std::uint8_t >(data);
+            return llvm::toHex(llvm::SHA256::hash(bytes), /* lower case */ true);
+        }
+
+        //
+        // Minimal encoding of the messages of the remote execution API:
+        //
+        //   message Digest       { string hash = 1; int64 size_bytes = 2; }
+        //   message OutputFile   { string path = 1; Digest digest = 2; }
+        //   message ActionResult { repeated OutputFile output_files = 2; }
+        //
+        namespace proto
+        {
+            enum wire_type : std::uint8_t { varint = 0, fixed64 = 1, length = 2, fixed32 = 5 };
+
+            void write_varint(std::string &out, std::uint64_t value) {
+                while (value >= 0x80) {
+                    out += char(std::uint8_t(value) | 0x80);
+                    value >>= 7;
+                }
+                out += char(value);
+            }
+
+            void write_tag(std::string &out, unsigned field, wire_type type) {
+                write_varint(out, (field << 3) | type);
+            }
+
+            void write_bytes(std::string &out, unsigned field, string_ref data) {
+                write_tag(out, field, length);
+                write_varint(out, data.size());
+                out += data;
+            }
+
+            std::string action_result(string_ref path, string_ref hash, std::uint64_t size) {
+                std::string digest;
+                write_bytes(digest, 1, hash);
+                write_tag(digest, 2, varint);
+                write_varint(digest, size);
+
+                std::string file;
+                write_bytes(file, 1, path);
+                write_bytes(file, 2, digest);
+
+                std::string result;
+                write_bytes(result, 2, file);
+                return result;
+            }
+
+            std::optional< std::uint64_t > read_varint(string_ref &in) {
+                std::uint64_t value = 0;
+                for (unsigned shift = 0; shift < 64 && !in.empty(); shift += 7) {
+                    auto byte = std::uint8_t(in.front());
+                    in = in.drop_front();
+                    value |= std::uint64_t(byte & 0x7f) << shift;
+                    if (!(byte & 0x80)) {
+                        return value;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            // Calls `yield(field, type, value, bytes)` for every field of the
+            // message, returns false if the message is malformed.
+            bool for_each_field(string_ref in, auto &&yield) {
+                while (!in.empty()) {
+                    auto tag = read_varint(in);
+                    if (!tag) {
+                        return false;
+                    }
+
+                    auto field = unsigned(*tag >> 3);
+                    auto type  = wire_type(*tag & 0x7);
+
+                    std::uint64_t value = 0;
+                    string_ref bytes;
+                    switch (type) {
+                        case varint: {
+                            auto val = read_varint(in);
+                            if (!val) {
+                                return false;
+                            }
+                            value = *val;
+                            break;
+                        }
+                        case fixed64:
+                        case fixed32: {
+                            auto size = type == fixed64 ? 8 : 4;
+                            if (in.size() < std::size_t(size)) {
+                                return false;
+                            }
+                            in = in.drop_front(size);
+                            break;
+                        }
+                        case length: {
+                            auto size = read_varint(in);
+                            if (!size || *size > in.size()) {
+                                return false;
+                            }
+                            bytes = in.take_front(*size);
+                            in    = in.drop_front(*size);
+                            break;
+                        }
+                        default:
+                            return false;
+                    }
+
+                    yield(field, type, value, bytes);
+                }
+                return true;
+            }
+
+            struct digest_t
+            {
+                std::string hash;
+                std::uint64_t size = 0;
+            };
+
+            // Digest of the output file of the given path.
+            std::optional< digest_t > find_output(string_ref result, string_ref path) {
+                std::optional< digest_t > found;
+                bool valid = for_each_field(result, [&] (unsigned field, wire_type type, auto, string_ref file) {
+                    if (field != 2 || type != length || found) {
+                        return;
+                    }
+
+                    string_ref file_path;
+                    digest_t digest;
+                    for_each_field(file, [&] (unsigned field, wire_type type, auto, string_ref bytes) {
+                        if (field == 1 && type == length) {
+                            file_path = bytes;
+                        } else if (field == 2 && type == length) {
+                            for_each_field(bytes, [&] (unsigned field, wire_type type, std::uint64_t value, string_ref bytes) {
+                                if (field == 1 && type == length) {
+                                    digest.hash = bytes.str();
+                                } else if (field == 2 && type == varint) {
+                                    digest.size = value;
+                                }
+                            });
+                        }
+                    });
+
+                    if (file_path == path && !digest.hash.empty()) {
+                        found = std::move(digest);
+                    }
+                });
+
+                return valid ? found : std::nullopt;
+            }
+
+        } // namespace proto
+
+        struct http_response
+        {
+            unsigned status = 0;
+            std::string body;
+        };
+
+        struct http_url
+        {
+            std::string host;
+            std::string port = "80";
+            std::string prefix;
+        };
+
+        std::optional< http_url > parse_url(string_ref url) {
+            if (!url.consume_front("http://")) {
+                return std::nullopt;
+            }
+
+            auto [authority, path] = url.split('/');
+            if (authority.empty()) {
+                return std::nullopt;
+            }
+
+            http_url result;
+            if (auto [host, port] = authority.rsplit(':'); !port.empty() && llvm::all_of(port, llvm::isDigit)) {
+                result.host = host.str();
+                result.port = port.str();
+            } else {
+                result.host = authority.str();
+            }
+
+            path = path.rtrim('/');
+            if (!path.empty()) {
+                result.prefix = ("/" + path).str();
+            }
+            return result;
+        }
+
+        // Decodes the body of a chunked response.
+        std::optional< std::string > dechunk(string_ref body) {
+            std::string result;
+            while (true) {
+                auto [line, rest] = body.split("\r\n");
+                unsigned long long size = 0;
+                if (llvm::getAsUnsignedInteger(line.split(';').first.trim(), 16, size) || size > rest.size()) {
+                    return std::nullopt;
+                }
+
+                if (size == 0) {
+                    return result;
+                }
+
+                result += rest.take_front(size);
+                body = rest.drop_front(size);
+                if (!body.consume_front("\r\n")) {
+                    return std::nullopt;
+                }
+            }
+        }
+
+#ifdef LLVM_ON_UNIX
+        struct connection
+        {
+            explicit connection(int fd) : fd(fd) {}
+
+            connection(const connection &) = delete;
+            connection &operator=(const connection &) = delete;
+
+            ~connection() {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+            }
+
+            bool write(string_ref data) const {
+                while (!data.empty()) {
+                    auto written = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+                    if (written <= 0) {
+                        return false;
+                    }
+                    data = data.drop_front(std::size_t(written));
+                }
+                return true;
+            }
+
+            bool read_all(std::string &out) const {
+                char buff[16 * 1024];
+                while (true) {
+                    auto received = ::recv(fd, buff, sizeof(buff), 0);
+                    if (received < 0) {
+                        return false;
+                    }
+                    if (received == 0) {
+                        return true;
+                    }
+                    out.append(buff, std::size_t(received));
+                }
+            }
+
+            int fd;
+        };
+
+        std::unique_ptr< connection > connect(const http_url &url) {
+            addrinfo hints = {};
+            hints.ai_family   = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+
+            addrinfo *addrs = nullptr;
+            if (::getaddrinfo(url.host.c_str(), url.port.c_str(), &hints, &addrs) != 0) {
+                return nullptr;
+            }
+
+            std::unique_ptr< connection > result;
+            for (auto addr = addrs; addr && !result; addr = addr->ai_next) {
+                auto conn = std::make_unique< connection >(
+                    ::socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol)
+                );
+                if (conn->fd < 0) {
+                    continue;
+                }
+
+                timeval timeout = { /* seconds */ 5, 0 };
+                ::setsockopt(conn->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                ::setsockopt(conn->fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+                if (::connect(conn->fd, addr->ai_addr, addr->ai_addrlen) == 0) {
+                    result = std::move(conn);
+                }
+            }
+
+            ::freeaddrinfo(addrs);
+            return result;
+        }
+
+        // One request per connection, the server closes it after the response.
+        std::optional< http_response > request(
+            const http_url &url, string_ref method, string_ref path, string_ref body
+        ) {
+            auto conn = connect(url);
+            if (!conn) {
+                return std::nullopt;
+            }
+
+            std::string head;
+            llvm::raw_string_ostream os(head);
+            os << method << ' ' << url.prefix << path << " HTTP/1.1\r\n"
+               << "Host: " << url.host << "\r\n"
+               << "Content-Length: " << body.size() << "\r\n"
+               << "Connection: close\r\n\r\n";
+
+            if (!conn->write(head) || !conn->write(body)) {
+                return std::nullopt;
+            }
+
+            std::string raw;
+            if (!conn->read_all(raw)) {
+                return std::nullopt;
+            }
+
+            auto [headers, payload] = string_ref(raw).split("\r\n\r\n");
+            auto [status_line, fields] = headers.split("\r\n");
+
+            // HTTP/1.1 <status> <reason>
+            http_response response;
+            auto status = status_line.split(' ').second.split(' ').first;
+            if (!status_line.starts_with("HTTP/") || status.getAsInteger(10, response.status)) {
+                return std::nullopt;
+            }
+
+            bool chunked = false;
+            std::optional< std::size_t > content_length;
+            while (!fields.empty()) {
+                auto [field, rest] = fields.split("\r\n");
+                fields = rest;
+
+                auto [name, value] = field.split(':');
+                value = value.trim();
+                if (name.equals_insensitive("transfer-encoding")) {
+                    chunked = value.contains_insensitive("chunked");
+                } else if (name.equals_insensitive("content-length")) {
+                    std::size_t size = 0;
+                    if (!value.getAsInteger(10, size)) {
+                        content_length = size;
+                    }
+                }
+            }
+
+            if (chunked) {
+                auto decoded = dechunk(payload);
+                if (!decoded) {
+                    return std::nullopt;
+                }
+                response.body = std::move(*decoded);
+            } else if (content_length) {
+                if (payload.size() < *content_length) {
+                    return std::nullopt;
+                }
+                response.body = payload.take_front(*content_length).str();
+            } else {
+                response.body = payload.str();
+            }
+
+            return response;
+        }
+#else
+        std::optional< http_response > request(
+            const http_url &, string_ref, string_ref, string_ref
+        ) {
+            return std::nullopt;
+        }
+#endif
+
+        struct remote_storage final : cache_storage
+        {
+            remote_storage(http_url url, bool no_upload)
+                : url(std::move(url)), no_upload(no_upload)
+            {}
+
+            std::optional< std::string > get(entry_kind kind, string_ref key) override {
+                auto result = fetch("/ac/" + key.str());
+                if (!result) {
+                    return std::nullopt;
+                }
+
+                auto digest = proto::find_output(*result, output_name(kind));
+                if (!digest) {
+                    return std::nullopt;
+                }
+
+                auto blob = fetch("/cas/" + digest->hash);
+                if (!blob || blob->size() != digest->size || cas_digest(*blob) != digest->hash) {
+                    return std::nullopt;
+                }
+
+                return blob;
+            }
+
+            void put(entry_kind kind, string_ref key, string_ref data) override {
+                if (no_upload || !available) {
+                    return;
+                }
+
+                auto hash = cas_digest(data);
+                if (upload("/cas/" + hash, data)) {
+                    upload("/ac/" + key.str(), proto::action_result(output_name(kind), hash, data.size()));
+                }
+            }
+
+            std::optional< std::string > fetch(const std::string &path) {
+                if (!available) {
+                    return std::nullopt;
+                }
+
+                auto response = request(url, "GET", path, {});
+                if (!response) {
+                    available = false;
+                    return std::nullopt;
+                }
+
+                if (response->status != 200) {
+                    return std::nullopt;
+                }
+                return std::move(response->body);
+            }
+
+            bool upload(const std::string &path, string_ref data) {
+                auto response = request(url, "PUT", path, data);
+                if (!response) {
+                    available = false;
+                    return false;
+                }
+                return response->status >= 200 && response->status < 300;
+            }
+
+            http_url url;
+            bool no_upload;
+
+            // Cleared by the first failed connection.
+            bool available = true;
+        };
+
+    } // namespace
+
+    cache_storage_ptr make_remote_storage(string_ref url, bool no_upload) {
+        auto parsed = parse_url(url);
+        VAST_CHECK(parsed, "invalid -vast-remote-cache url, expected http://<host>[:<port>][/<prefix>]: {0}", url);
+        return std::make_unique< remote_storage >(std::move(parsed.value()), no_upload);
+    }
+
+} // namespace vast::cc
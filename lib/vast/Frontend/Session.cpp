@@ -0,0 +1,458 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/Session.hpp"
+#include "vast/Frontend/Session.h"
+
+VAST_RELAX_WARNINGS
+#include <clang/CodeGen/BackendUtil.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/PCHContainerOperations.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <clang/Frontend/Utils.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/VirtualFileSystem.h>
+
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/IR/Diagnostics.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Config/config.h"
+
+#include "vast/CodeGen/CodeGen.hpp"
+#include "vast/CodeGen/CodeGenContext.hpp"
+#include "vast/CodeGen/CodeGenDriver.hpp"
+
+#include "vast/Frontend/Context.hpp"
+#include "vast/Frontend/Pipelines.hpp"
+
+#include "vast/Target/LLVMIR/Convert.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace vast::cc {
+
+    namespace {
+
+        // Targets are registered once per process, sessions may be created
+        // concurrently.
+        void initialize_targets() {
+            static std::once_flag initialized;
+            std::call_once(initialized, [] {
+                llvm::InitializeAllTargets();
+                llvm::InitializeAllTargetMCs();
+                llvm::InitializeAllAsmPrinters();
+                llvm::InitializeAllAsmParsers();
+            });
+        }
+
+        std::vector< const char * > command_line(const session_options &opts) {
+            std::vector< const char * > argv = { "vast" };
+            for (const auto &arg : opts.args) {
+                argv.push_back(arg.c_str());
+            }
+            argv.push_back("-fsyntax-only");
+            argv.push_back(opts.file.c_str());
+            return argv;
+        }
+
+        llvm::IntrusiveRefCntPtr< diagnostics_engine > make_diagnostics(llvm::raw_ostream &os) {
+            auto diag_opts = new clang::DiagnosticOptions();
+            return clang::CompilerInstance::createDiagnostics(
+                diag_opts, new clang::TextDiagnosticPrinter(os, diag_opts)
+            );
+        }
+
+        // Clang diagnostics of codegen and the backend are reported outside of
+        // the parse of the unit.
+        struct source_file_scope
+        {
+            source_file_scope(diagnostics_engine &engine, clang::ASTUnit &unit)
+                : client(engine.getClient())
+            {
+                client->BeginSourceFile(unit.getLangOpts(), &unit.getPreprocessor());
+            }
+
+            ~source_file_scope() { client->EndSourceFile(); }
+
+            clang::DiagnosticConsumer *client;
+        };
+
+    } // namespace
+
+    std::unique_ptr< session > make_session(session_options opts, std::string *diagnostics) {
+        auto report = [&] (string_ref errors) {
+            if (diagnostics) {
+                *diagnostics = errors.str();
+            }
+            return nullptr;
+        };
+
+        // Driver resolves the input in the file system, hence the placeholder
+        // of the source.
+        llvm::SmallString< 256 > file(opts.file);
+        if (auto ec = llvm::sys::fs::make_absolute(file)) {
+            return report("error: " + ec.message() + "\n");
+        }
+        opts.file = file.str().str();
+
+        auto memory = llvm::makeIntrusiveRefCnt< llvm::vfs::InMemoryFileSystem >();
+        memory->addFile(opts.file, 0, llvm::MemoryBuffer::getMemBuffer(""));
+
+        auto vfs = llvm::makeIntrusiveRefCnt< llvm::vfs::OverlayFileSystem >(llvm::vfs::getRealFileSystem());
+        vfs->pushOverlay(memory);
+
+        std::string errors;
+        llvm::raw_string_ostream os(errors);
+
+        auto args = command_line(opts);
+        std::shared_ptr< clang::CompilerInvocation > invocation = clang::createInvocation(
+            args, { .Diags = make_diagnostics(os), .VFS = vfs }
+        );
+
+        if (!invocation) {
+            return report(errors);
+        }
+
+        return std::unique_ptr< session >(
+            new session(std::move(opts), std::move(vfs), std::move(invocation))
+        );
+    }
+
+    session::session(
+        session_options opts, llvm::IntrusiveRefCntPtr< virtual_file_system > vfs,
+        std::shared_ptr< clang::CompilerInvocation > invocation
+    )
+        : opts(std::move(opts))
+        , vfs(std::move(vfs))
+        , invocation(std::move(invocation))
+        , mctx(make_mcontext())
+        , diags_os(diags)
+        , engine(make_diagnostics(diags_os))
+    {
+        for (const auto &opt : this->opts.vast_options) {
+            vargs.push_back(opt.c_str());
+        }
+
+        if (!this->opts.multithreaded) {
+            mctx->disableMultithreading();
+        }
+
+        // Dialects are loaded up front, so that no compilation pays for them.
+        cg::load_codegen_dialects(*mctx);
+        mctx->loadAllAvailableDialects();
+
+        initialize_targets();
+    }
+
+    session::~session() = default;
+
+    bool session::parse(string_ref source) {
+        diags.clear();
+
+        // The unit takes the ownership of the remapped buffer.
+        auto contents = llvm::MemoryBuffer::getMemBufferCopy(source, opts.file);
+        clang::ASTUnit::RemappedFile main_file = { opts.file, contents.release() };
+
+        auto pch = std::make_shared< clang::PCHContainerOperations >();
+
+        // Includes at the start of the source are precompiled into a
+        // preamble on the first parse, later parses reuse it unless they
+        // change.
+        if (unit) {
+            unit->getDiagnostics().Reset(/* soft */ true);
+            if (unit->Reparse(pch, main_file)) {
+                return false;
+            }
+        } else {
+            auto args = command_line(opts);
+            unit.reset(clang::ASTUnit::LoadFromCommandLine(
+                args.data(), args.data() + args.size(), pch, engine, CLANG_RESOURCE_DIR,
+                /* StorePreamblesInMemory */ true,
+                /* PreambleStoragePath */ {},
+                /* OnlyLocalDecls */ false,
+                clang::CaptureDiagsKind::None,
+                main_file,
+                /* RemappedFilesKeepOriginalName */ true,
+                /* PrecompilePreambleAfterNParses */ 1,
+                clang::TU_Complete,
+                /* CacheCodeCompletionResults */ false,
+                /* IncludeBriefCommentsInCodeCompletion */ false,
+                /* AllowPCHWithCompilerErrors */ false,
+                clang::SkipFunctionBodiesScope::None,
+                /* SingleFileParse */ false,
+                /* UserFilesAreVolatile */ true,
+                /* ForSerialization */ false,
+                /* RetainExcludedConditionalBlocks */ false,
+                /* ModuleFormat */ std::nullopt,
+                /* ErrAST */ nullptr,
+                vfs
+            ));
+
+            if (!unit) {
+                return false;
+            }
+        }
+
+        return !unit->getDiagnostics().hasErrorOccurred();
+    }
+
+    owning_module_ref session::generate() {
+        auto &actx = unit->getASTContext();
+
+        action_options options{
+            .headers = unit->getHeaderSearchOpts(),
+            .codegen = invocation->getCodeGenOpts(),
+            .target  = actx.getTargetInfo().getTargetOpts(),
+            .lang    = unit->getLangOpts(),
+            .front   = invocation->getFrontendOpts(),
+            .diags   = unit->getDiagnostics(),
+            .vfs     = unit->getFileManager().getVirtualFileSystem()
+        };
+
+        cg::codegen_context cgctx(*mctx, actx, get_source_language(options.lang));
+        cg::codegen_driver driver(cgctx, options, vargs);
+
+        for (auto decl : actx.getTranslationUnitDecl()->decls()) {
+            driver.handle_top_level_decl(decl);
+        }
+
+        driver.finalize();
+
+        if (options.diags.hasErrorOccurred()) {
+            return {};
+        }
+
+        if (!driver.verify_module()) {
+            diags_os << "error: codegen: module verification error\n";
+            return {};
+        }
+
+        return std::move(cgctx.mod);
+    }
+
+    bool session::lower(vast_module mod, target_dialect trg) {
+        // Pass managers can run repeatedly, so each target is scheduled once.
+        auto &pipeline = pipelines[trg];
+        if (!pipeline) {
+            pipeline = setup_pipeline(pipeline_source::ast, trg, *mctx, vargs);
+            if (!pipeline) {
+                diags_os << "error: failed to setup pipeline to " << to_string(trg) << "\n";
+                return false;
+            }
+        }
+
+        if (mlir::failed(pipeline->run(mod))) {
+            return false;
+        }
+
+        if (trg != target_dialect::high_level || vargs.has_option(opt::simplify)) {
+            mark_reached_dialect(mod, trg);
+        }
+
+        return true;
+    }
+
+    owning_module_ref session::compile(string_ref source, target_dialect trg) {
+        if (!parse(source)) {
+            return {};
+        }
+
+        mlir::ScopedDiagnosticHandler handler(mctx.get(), [&] (mlir::Diagnostic &diag) {
+            diags_os << diag.getLocation() << ": " << diag << "\n";
+            return mlir::success();
+        });
+
+        source_file_scope scope(*engine, *unit);
+
+        auto mod = generate();
+        if (!mod || !lower(mod.get(), trg)) {
+            return {};
+        }
+
+        return mod;
+    }
+
+    std::optional< std::string > session::compile_bytecode(string_ref source, target_dialect trg) {
+        auto mod = compile(source, trg);
+        if (!mod) {
+            return std::nullopt;
+        }
+
+        std::string bytecode;
+        llvm::raw_string_ostream os(bytecode);
+
+        mlir::BytecodeWriterConfig config("vast");
+        if (mlir::failed(mlir::writeBytecodeToFile(mod.get(), os, config))) {
+            diags_os << "error: failed to write mlir bytecode\n";
+            return std::nullopt;
+        }
+
+        return bytecode;
+    }
+
+    std::optional< std::string > session::compile_object(string_ref source) {
+        auto mod = compile(source, target_dialect::llvm);
+        if (!mod) {
+            return std::nullopt;
+        }
+
+        llvm::LLVMContext llvm_context;
+        auto llvm_module = [&] {
+            mlir::ScopedDiagnosticHandler handler(mctx.get(), [&] (mlir::Diagnostic &diag) {
+                diags_os << diag.getLocation() << ": " << diag << "\n";
+                return mlir::success();
+            });
+            return target::llvmir::translate(mod.get(), llvm_context);
+        } ();
+
+        if (!llvm_module) {
+            diags_os << "error: failed to translate module to LLVM IR\n";
+            return std::nullopt;
+        }
+
+        // Only the translated module is kept alive by the backend.
+        mod = owning_module_ref();
+
+        source_file_scope scope(*engine, *unit);
+
+        auto &target = unit->getASTContext().getTargetInfo();
+
+        llvm::SmallString< 0 > object;
+        clang::EmitBackendOutput(
+            *engine, unit->getHeaderSearchOpts(), invocation->getCodeGenOpts(),
+            target.getTargetOpts(), unit->getLangOpts(), target.getDataLayoutString(),
+            llvm_module.get(), clang::Backend_EmitObj, vfs,
+            std::make_unique< llvm::raw_svector_ostream >(object)
+        );
+
+        if (engine->hasErrorOccurred()) {
+            return std::nullopt;
+        }
+
+        return std::string(object.str());
+    }
+
+} // namespace vast::cc
+
+//
+// C interface
+//
+
+struct vast_session
+{
+    std::unique_ptr< vast::cc::session > session;
+};
+
+struct vast_result
+{
+    bool succeeded = false;
+    std::string data;
+    std::string diagnostics;
+};
+
+namespace {
+
+    vast::cc::target_dialect to_target_dialect(vast_target_dialect target) {
+        switch (target) {
+            case VAST_TARGET_HIGH_LEVEL: return vast::cc::target_dialect::high_level;
+            case VAST_TARGET_STD:        return vast::cc::target_dialect::std;
+            case VAST_TARGET_LLVM:       return vast::cc::target_dialect::llvm;
+            case VAST_TARGET_CIR:        return vast::cc::target_dialect::cir;
+        }
+        VAST_UNREACHABLE("unknown target dialect");
+    }
+
+    std::vector< std::string > to_strings(const char *const *strs, size_t size) {
+        return std::vector< std::string >(strs, strs + size);
+    }
+
+    char *duplicate(const std::string &str) {
+        auto copy = static_cast< char * >(std::malloc(str.size() + 1));
+        std::memcpy(copy, str.c_str(), str.size() + 1);
+        return copy;
+    }
+
+} // namespace
+
+extern "C" {
+
+vast_session *vast_session_create(const vast_session_options *options, char **diagnostics) {
+    vast::cc::session_options opts;
+    if (options->file) {
+        opts.file = options->file;
+    }
+    opts.args          = to_strings(options->args, options->num_args);
+    opts.vast_options  = to_strings(options->vast_options, options->num_vast_options);
+    opts.multithreaded = options->multithreaded != 0;
+
+    std::string errors;
+    auto session = vast::cc::make_session(std::move(opts), &errors);
+    if (!session) {
+        if (diagnostics) {
+            *diagnostics = duplicate(errors);
+        }
+        return nullptr;
+    }
+
+    return new vast_session{ std::move(session) };
+}
+
+void vast_session_destroy(vast_session *session) { delete session; }
+
+vast_result *vast_session_compile(
+    vast_session *session, const char *source, size_t size,
+    vast_target_dialect target, vast_output_kind output
+) {
+    auto result = new vast_result();
+    auto &compiler = *session->session;
+    auto code = vast::string_ref(source, size);
+
+    switch (output) {
+        case VAST_OUTPUT_MLIR: {
+            if (auto mod = compiler.compile(code, to_target_dialect(target))) {
+                llvm::raw_string_ostream os(result->data);
+                mod->print(os);
+                result->succeeded = true;
+            }
+            break;
+        }
+        case VAST_OUTPUT_MLIR_BYTECODE: {
+            if (auto bytecode = compiler.compile_bytecode(code, to_target_dialect(target))) {
+                result->data      = std::move(*bytecode);
+                result->succeeded = true;
+            }
+            break;
+        }
+        case VAST_OUTPUT_OBJECT: {
+            if (auto object = compiler.compile_object(code)) {
+                result->data      = std::move(*object);
+                result->succeeded = true;
+            }
+            break;
+        }
+    }
+
+    result->diagnostics = compiler.diagnostics().str();
+    return result;
+}
+
+int vast_result_succeeded(const vast_result *result) { return result->succeeded; }
+
+const char *vast_result_data(const vast_result *result) { return result->data.data(); }
+
+size_t vast_result_size(const vast_result *result) { return result->data.size(); }
+
+const char *vast_result_diagnostics(const vast_result *result) {
+    return result->diagnostics.c_str();
+}
+
+void vast_result_destroy(vast_result *result) { delete result; }
+
+} // extern "C"
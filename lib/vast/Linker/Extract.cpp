@@ -0,0 +1,260 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Linker/Extract.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/Verifier.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SetVector.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/CallGraph.hpp"
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Linker/Linker.hpp"
+
+#include <deque>
+
+namespace vast::link
+{
+    namespace
+    {
+        using operations = llvm::SmallVector< operation, 1 >;
+
+        //
+        // Collects the top-level operations the functions to be defined
+        // depend on. Operations are indexed by their names in the namespaces
+        // of C: ordinary identifiers, i.e., functions, variables and enum
+        // constants, tags and typedefs.
+        //
+        struct extractor
+        {
+            extractor(vast_module mod, llvm::StringSet<> defined)
+                : mod(mod), defined(std::move(defined))
+            {
+                for (auto &op : mod.getOps()) {
+                    auto name = name_of(&op);
+                    if (name.empty()) {
+                        continue;
+                    }
+
+                    if (is_global(&op)) {
+                        symbols[name].push_back(&op);
+                    } else if (mlir::isa< hl::TypeDefOp >(op)) {
+                        typedefs[name].push_back(&op);
+                    } else if (is_type_declaration(&op)) {
+                        tags[name].push_back(&op);
+                    }
+
+                    if (auto decl = mlir::dyn_cast< hl::EnumDeclOp >(op)) {
+                        decl.walk([&] (hl::EnumConstantOp constant) {
+                            symbols[constant.getName()].push_back(&op);
+                        });
+                    }
+                }
+            }
+
+            owning_module_ref extract() {
+                for (const auto &name : defined) {
+                    require_symbol(name.getKey());
+                }
+
+                while (!worklist.empty()) {
+                    auto op = worklist.front();
+                    worklist.pop_front();
+                    scan(op, !stubs.contains(op));
+                }
+
+                return build();
+            }
+
+          private:
+            void keep(operation op, bool stub = false) {
+                if (!kept.insert(op)) {
+                    return;
+                }
+
+                if (stub) {
+                    stubs.insert(op);
+                }
+                worklist.push_back(op);
+            }
+
+            void require(const llvm::StringMap< operations > &table, string_ref name) {
+                if (auto it = table.find(name); it != table.end()) {
+                    for (auto op : it->second) {
+                        keep(op);
+                    }
+                }
+            }
+
+            // Functions outside of the closure are represented by a single
+            // declaration of their name.
+            void require_symbol(string_ref name) {
+                auto it = symbols.find(name);
+                if (it == symbols.end()) {
+                    return;
+                }
+
+                auto is_function = mlir::isa< mlir::FunctionOpInterface >(it->second.front());
+                if (!is_function || defined.contains(name)) {
+                    return require(symbols, name);
+                }
+
+                if (!stubbed.insert(name).second) {
+                    return;
+                }
+
+                auto decl = llvm::find_if(it->second, [] (operation op) {
+                    return mlir::cast< mlir::FunctionOpInterface >(op).isExternal();
+                });
+                keep(decl != it->second.end() ? *decl : it->second.front(), true /* stub */);
+            }
+
+            // Requires the declarations of the names the operation refers
+            // to, and of the operations nested in it, unless it is a stub.
+            void scan(operation root, bool nested) {
+                mlir::AttrTypeWalker walker;
+                walker.addWalk([&] (hl::RecordType type) { require(tags, type.getName()); });
+                walker.addWalk([&] (hl::EnumType type) { require(tags, type.getName()); });
+                walker.addWalk([&] (hl::TypedefType type) { require(typedefs, type.getName()); });
+                walker.addWalk([&] (mlir::SymbolRefAttr ref) {
+                    require_symbol(ref.getRootReference());
+                });
+
+                auto visit = [&] (operation op) {
+                    walker.walk(op->getAttrDictionary());
+                    for (auto type : op->getResultTypes()) {
+                        walker.walk(type);
+                    }
+
+                    for (auto &region : op->getRegions()) {
+                        for (auto &block : region) {
+                            for (auto arg : block.getArguments()) {
+                                walker.walk(arg.getType());
+                            }
+                        }
+                    }
+
+                    if (auto ref = mlir::dyn_cast< hl::GlobalRefOp >(op)) {
+                        require_symbol(ref.getGlobal());
+                    } else if (auto ref = mlir::dyn_cast< hl::EnumRefOp >(op)) {
+                        require_symbol(ref.getValue());
+                    }
+                };
+
+                if (nested) {
+                    root->walk(visit);
+                } else {
+                    visit(root);
+                }
+            }
+
+            owning_module_ref build() {
+                auto out = owning_module_ref(vast_module::create(mod.getLoc()));
+                out->getOperation()->setAttrs(mod->getAttrDictionary());
+
+                auto bld = mlir::OpBuilder::atBlockEnd(out->getBody());
+                for (auto &op : mod.getOps()) {
+                    if (!kept.contains(&op)) {
+                        continue;
+                    }
+
+                    auto copy = bld.clone(op);
+                    if (stubs.contains(&op)) {
+                        stub(mlir::cast< mlir::FunctionOpInterface >(copy));
+                    }
+                }
+
+                if (failed(mlir::verify(out.get()))) {
+                    return {};
+                }
+                return out;
+            }
+
+            static void stub(mlir::FunctionOpInterface fn) {
+                if (fn.isExternal()) {
+                    return;
+                }
+
+                auto &body = fn.getFunctionBody();
+                body.dropAllReferences();
+                body.getBlocks().clear();
+
+                // Declarations of internal functions would never be defined.
+                if (fn->hasAttr("linkage")) {
+                    fn->setAttr("linkage", core::GlobalLinkageKindAttr::get(
+                        fn.getContext(), core::GlobalLinkageKind::ExternalLinkage
+                    ));
+                }
+            }
+
+            vast_module mod;
+
+            // functions copied with their bodies
+            llvm::StringSet<> defined;
+
+            llvm::StringMap< operations > symbols;
+            llvm::StringMap< operations > tags;
+            llvm::StringMap< operations > typedefs;
+
+            llvm::SetVector< operation > kept;
+            llvm::DenseSet< operation > stubs;
+            llvm::StringSet<> stubbed;
+
+            std::deque< operation > worklist;
+        };
+
+        // Names of the functions reachable from the node by at most `depth`
+        // direct calls.
+        llvm::StringSet<> callee_closure(
+            const analysis::call_graph &graph, analysis::call_graph::node_id root, unsigned depth
+        ) {
+            using node_id = analysis::call_graph::node_id;
+
+            llvm::StringSet<> names;
+            llvm::BitVector visited(graph.size());
+            std::vector< node_id > frontier = { root };
+            visited.set(root);
+
+            for (unsigned level = 0; !frontier.empty(); ++level) {
+                std::vector< node_id > next;
+                for (auto node : frontier) {
+                    names.insert(graph.function(node).getName());
+                    if (level == depth) {
+                        continue;
+                    }
+
+                    for (auto edge : graph.callees(node)) {
+                        if (edge.kind == analysis::call_graph::edge_kind::direct && !visited.test(edge.node)) {
+                            visited.set(edge.node);
+                            next.push_back(edge.node);
+                        }
+                    }
+                }
+                frontier = std::move(next);
+            }
+
+            return names;
+        }
+
+    } // namespace
+
+    owning_module_ref extract_function(vast_module mod, string_ref name, unsigned depth) {
+        analysis::call_graph graph(mod);
+        auto root = graph.node(name);
+        if (root == analysis::call_graph::no_node) {
+            return {};
+        }
+
+        return extractor(mod, callee_closure(graph, root, depth)).extract();
+    }
+
+} // namespace vast::link
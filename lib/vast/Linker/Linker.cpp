@@ -0,0 +1,752 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Linker/Linker.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <mlir/IR/Diagnostics.h>
+#include <mlir/IR/OperationSupport.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/IR/Verifier.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <mlir/Support/FileUtilities.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Util/ModuleParser.hpp"
+#include "vast/Util/Symbols.hpp"
+
+#include <deque>
+#include <future>
+#include <numeric>
+
+namespace vast::link
+{
+    string_ref name_of(operation op) {
+        if (auto symbol = mlir::dyn_cast< util::vast_symbol_interface >(op)) {
+            return util::symbol_name(symbol);
+        }
+        if (auto symbol = mlir::dyn_cast< util::mlir_symbol_interface >(op)) {
+            return util::symbol_name(symbol);
+        }
+        return {};
+    }
+
+    namespace
+    {
+        void set_name_of(operation op, string_ref name) {
+            if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+                var.setName(name);
+            } else if (auto symbol = mlir::dyn_cast< util::vast_symbol_interface >(op)) {
+                symbol.setSymbolName(name);
+            } else {
+                mlir::SymbolTable::setSymbolName(op, name);
+            }
+        }
+
+        //
+        // Renames the top-level symbols of the module and their uses: symbol
+        // references of functions and names of referenced globals.
+        //
+        void rename(vast_module mod, const llvm::StringMap< std::string > &renames) {
+            auto ctx = mod.getContext();
+
+            mlir::AttrTypeReplacer replacer;
+            replacer.addReplacement([&] (mlir::SymbolRefAttr ref) -> std::optional< Attribute > {
+                auto it = renames.find(ref.getRootReference());
+                if (it == renames.end()) {
+                    return std::nullopt;
+                }
+                auto root = mlir::StringAttr::get(ctx, it->second);
+                return mlir::SymbolRefAttr::get(root, ref.getNestedReferences());
+            });
+
+            mod->walk([&] (operation op) {
+                if (auto ref = mlir::dyn_cast< hl::GlobalRefOp >(op)) {
+                    if (auto it = renames.find(ref.getGlobal()); it != renames.end()) {
+                        ref.setGlobal(it->second);
+                    }
+                }
+                replacer.replaceElementsIn(op);
+            });
+
+            for (auto &op : mod.getOps()) {
+                if (auto it = renames.find(name_of(&op)); it != renames.end()) {
+                    set_name_of(&op, it->second);
+                }
+            }
+        }
+
+        //
+        // Renames the type declarations of the module and the types that refer
+        // to them, including the keys of the data layout of the module. Tags
+        // and typedefs live in separate namespaces.
+        //
+        void rename_types(
+            vast_module mod,
+            const llvm::StringMap< std::string > &tags,
+            const llvm::StringMap< std::string > &typedefs
+        ) {
+            auto ctx = mod.getContext();
+
+            auto renamed = [] (const auto &renames, string_ref name) -> std::optional< string_ref > {
+                if (auto it = renames.find(name); it != renames.end()) {
+                    return string_ref(it->second);
+                }
+                return std::nullopt;
+            };
+
+            mlir::AttrTypeReplacer replacer;
+            replacer.addReplacement([&] (hl::RecordType type) -> std::optional< mlir_type > {
+                if (auto name = renamed(tags, type.getName())) {
+                    return hl::RecordType::get(ctx, *name, type.getQuals());
+                }
+                return std::nullopt;
+            });
+            replacer.addReplacement([&] (hl::EnumType type) -> std::optional< mlir_type > {
+                if (auto name = renamed(tags, type.getName())) {
+                    return hl::EnumType::get(ctx, *name, type.getQuals());
+                }
+                return std::nullopt;
+            });
+            replacer.addReplacement([&] (hl::TypedefType type) -> std::optional< mlir_type > {
+                if (auto name = renamed(typedefs, type.getName())) {
+                    return hl::TypedefType::get(ctx, *name, type.getQuals());
+                }
+                return std::nullopt;
+            });
+
+            mod->walk([&] (operation op) {
+                replacer.replaceElementsIn(op, true /* attrs */, false /* locs */, true /* types */);
+            });
+
+            for (auto &op : mod.getOps()) {
+                if (!is_type_declaration(&op)) {
+                    continue;
+                }
+
+                auto &renames = mlir::isa< hl::TypeDefOp >(op) ? typedefs : tags;
+                if (auto name = renamed(renames, name_of(&op))) {
+                    set_name_of(&op, *name);
+                }
+            }
+        }
+
+        bool is_tag(operation op) {
+            return mlir::isa<
+                hl::StructDeclOp, hl::UnionDeclOp, hl::EnumDeclOp, hl::TypeDeclOp,
+                hl::ClassDeclOp, hl::CxxStructDeclOp
+            >(op);
+        }
+
+        bool is_forward_declaration(operation op) { return mlir::isa< hl::TypeDeclOp >(op); }
+
+        //
+        // Hash of the operation and its regions that does not depend on
+        // locations. Attributes and types are uniqued by the context, so
+        // declarations of the same fields, qualifiers and layout hash the
+        // same in every unit.
+        //
+        llvm::hash_code structural_hash(operation op) {
+            auto hash = llvm::hash_combine(op->getName(), op->getAttrDictionary());
+            for (auto type : op->getResultTypes()) {
+                hash = llvm::hash_combine(hash, type);
+            }
+
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    for (auto &child : block) {
+                        hash = llvm::hash_combine(hash, structural_hash(&child));
+                    }
+                }
+            }
+
+            return hash;
+        }
+
+    } // namespace
+
+    bool is_global(operation op) {
+        return mlir::isa< hl::VarDeclOp, mlir::FunctionOpInterface >(op);
+    }
+
+    bool is_type_declaration(operation op) {
+        return is_tag(op) || mlir::isa< hl::TypeDefOp >(op);
+    }
+
+    program_linker::program_linker(mcontext_t &mctx)
+        : _program(vast_module::create(mlir::UnknownLoc::get(&mctx)))
+    {}
+
+    auto program_linker::strength_of(operation op) -> strength {
+        if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op)) {
+            if (var.getStorageClass() == hl::StorageClass::sc_static) {
+                return strength::internal;
+            }
+            if (!var.getInitializer().empty()) {
+                return strength::strong;
+            }
+            // tentative definitions are common
+            return var.hasExternalStorage() ? strength::declaration : strength::weak;
+        }
+
+        auto linkage = core::GlobalLinkageKind::ExternalLinkage;
+        if (auto attr = op->getAttrOfType< core::GlobalLinkageKindAttr >("linkage")) {
+            linkage = attr.getValue();
+        }
+
+        using enum core::GlobalLinkageKind;
+        if (linkage == InternalLinkage || linkage == PrivateLinkage) {
+            return strength::internal;
+        }
+
+        if (mlir::cast< mlir::FunctionOpInterface >(op).isExternal()) {
+            return strength::declaration;
+        }
+
+        switch (linkage) {
+            case ExternalLinkage:
+            case AppendingLinkage:
+                return strength::strong;
+            case LinkOnceAnyLinkage:
+            case LinkOnceODRLinkage:
+            case WeakAnyLinkage:
+            case WeakODRLinkage:
+            case CommonLinkage:
+                return strength::weak;
+            case AvailableExternallyLinkage:
+                return strength::available_externally;
+            case ExternalWeakLinkage:
+                return strength::declaration;
+            default:
+                VAST_UNREACHABLE("unexpected linkage {0}", core::stringifyGlobalLinkageKind(linkage));
+        }
+    }
+
+    std::string program_linker::unique_name(string_ref name, unsigned unit) const {
+        auto candidate = (name + "." + llvm::Twine(unit)).str();
+        for (unsigned i = 1; _globals.count(candidate); ++i) {
+            candidate = (name + "." + llvm::Twine(unit) + "." + llvm::Twine(i)).str();
+        }
+        return candidate;
+    }
+
+    void program_linker::rename_internals(vast_module mod) {
+        llvm::StringMap< std::string > renames;
+
+        for (auto &op : mod.getOps()) {
+            if (!is_global(&op)) {
+                continue;
+            }
+
+            auto name = name_of(&op);
+            auto it   = _globals.find(name);
+            if (it == _globals.end()) {
+                continue;
+            }
+
+            if (strength_of(&op) == strength::internal) {
+                if (!renames.count(name)) {
+                    renames[name] = unique_name(name, _unit);
+                }
+                continue;
+            }
+
+            if (it->second.kind != strength::internal) {
+                continue;
+            }
+
+            // Any earlier unit referring to the name would have linked
+            // a symbol of the name, hence all uses of the internal symbol of
+            // the program are in its own unit.
+            auto entry   = it->second;
+            auto renamed = unique_name(name, entry.unit);
+
+            llvm::StringMap< std::string > program_renames;
+            program_renames[name] = renamed;
+            rename(_program.get(), program_renames);
+
+            _globals.erase(it);
+            _globals.try_emplace(renamed, entry);
+            ++_stats.renamed;
+        }
+
+        if (!renames.empty()) {
+            rename(mod, renames);
+            _stats.renamed += renames.size();
+        }
+    }
+
+    void program_linker::move_to_program(operation op) {
+        auto body = _program->getBody();
+        op->moveBefore(body, body->end());
+    }
+
+    void program_linker::link_global(operation op, string_ref name, strength kind) {
+        auto [it, inserted] = _globals.try_emplace(name, symbol_entry{ op, kind, _unit });
+        if (inserted) {
+            move_to_program(op);
+            return;
+        }
+
+        auto &entry = it->second;
+        VAST_ASSERT(kind != strength::internal && entry.kind != strength::internal);
+
+        auto replace = [&] {
+            entry.op->dropAllUses();
+            entry.op->erase();
+            entry = symbol_entry{ op, kind, _unit };
+            move_to_program(op);
+        };
+
+        if (mlir::isa< hl::VarDeclOp >(op) != mlir::isa< hl::VarDeclOp >(entry.op)) {
+            auto diag = mlir::emitError(op->getLoc()) << "symbol '" << name
+                << "' is declared both as a function and as a variable";
+            diag.attachNote(entry.op->getLoc()) << "previous declaration is here";
+            ++_stats.errors;
+            op->erase();
+            return;
+        }
+
+        if (kind == strength::declaration || entry.kind == strength::declaration) {
+            ++_stats.resolved;
+            if (kind == strength::declaration) {
+                op->erase();
+            } else {
+                replace();
+            }
+            return;
+        }
+
+        if (kind == strength::strong && entry.kind == strength::strong) {
+            auto diag = mlir::emitError(op->getLoc()) << "redefinition of symbol '" << name << "'";
+            diag.attachNote(entry.op->getLoc()) << "previous definition is here";
+            ++_stats.errors;
+            op->erase();
+            return;
+        }
+
+        ++_stats.overridden;
+        if (kind > entry.kind) {
+            replace();
+        } else {
+            op->erase();
+        }
+    }
+
+    std::string program_linker::unique_type_name(
+        const type_table &table, string_ref name, unsigned unit
+    ) const {
+        auto candidate = (name + "." + llvm::Twine(unit)).str();
+        for (unsigned i = 1; table.count(candidate); ++i) {
+            candidate = (name + "." + llvm::Twine(unit) + "." + llvm::Twine(i)).str();
+        }
+        return candidate;
+    }
+
+    bool program_linker::same_definition(const type_entry &entry, operation op) {
+        // Equal hashes are confirmed, so that collisions are not merged.
+        return structural_hash(op) == entry.hash && mlir::OperationEquivalence::isEquivalentTo(
+            entry.op, op, mlir::OperationEquivalence::IgnoreLocations
+        );
+    }
+
+    void program_linker::rename_conflicting_types(vast_module mod) {
+        // Renaming a type changes the declarations that refer to it, so these
+        // are compared again until no other definition conflicts. Renamed
+        // types are not in the program yet, hence compared only once.
+        while (true) {
+            llvm::StringMap< std::string > tags, typedefs;
+            for (auto &op : mod.getOps()) {
+                bool is_typedef = mlir::isa< hl::TypeDefOp >(op);
+                if (!is_typedef && (!is_tag(&op) || is_forward_declaration(&op))) {
+                    continue;
+                }
+
+                auto &table = is_typedef ? _typedefs : _tags;
+                auto it     = table.find(name_of(&op));
+                if (it == table.end() || is_forward_declaration(it->second.op)) {
+                    continue;
+                }
+
+                auto &entry = it->second;
+                if (same_definition(entry, &op)) {
+                    continue;
+                }
+
+                if (entry.conflicts.empty()) {
+                    _conflicting.push_back(&*it);
+                }
+
+                auto renamed = unique_type_name(table, it->getKey(), _unit);
+                entry.conflicts.emplace_back(renamed, op.getLoc());
+                ++_stats.type_conflicts;
+                (is_typedef ? typedefs : tags)[it->getKey()] = renamed;
+            }
+
+            if (tags.empty() && typedefs.empty()) {
+                return;
+            }
+
+            rename_types(mod, tags, typedefs);
+        }
+    }
+
+    logical_result program_linker::merge_data_layout(vast_module mod) {
+        auto name = mlir::DLTIDialect::kDataLayoutAttrName;
+        auto spec = mod->getAttrOfType< mlir::DataLayoutSpecAttr >(name);
+        if (!spec) {
+            return mlir::success();
+        }
+
+        auto program_spec = _program->getAttrOfType< mlir::DataLayoutSpecAttr >(name);
+        if (!program_spec) {
+            _program->setAttr(name, spec);
+            return mlir::success();
+        }
+
+        auto status  = mlir::success();
+        auto entries = llvm::to_vector(program_spec.getEntries());
+
+        llvm::DenseMap< mlir::DataLayoutEntryKey, mlir::DataLayoutEntryInterface > known;
+        for (auto entry : entries) {
+            known.try_emplace(entry.getKey(), entry);
+        }
+
+        for (auto entry : spec.getEntries()) {
+            auto [it, inserted] = known.try_emplace(entry.getKey(), entry);
+            if (inserted) {
+                entries.push_back(entry);
+                continue;
+            }
+
+            if (it->second.getValue() != entry.getValue()) {
+                mlir::emitError(mod.getLoc()) << "conflicting data layout entry " << entry
+                    << ", the program has " << it->second;
+                ++_stats.errors;
+                status = mlir::failure();
+            }
+        }
+
+        _program->setAttr(name, mlir::DataLayoutSpecAttr::get(_program->getContext(), entries));
+        return status;
+    }
+
+    void program_linker::link_type(type_table &table, operation op, string_ref name) {
+        auto hash = structural_hash(op);
+        auto [it, inserted] = table.try_emplace(name, type_entry{ op, hash, {} });
+        if (inserted) {
+            move_to_program(op);
+            return;
+        }
+
+        auto &entry = it->second;
+
+        if (is_forward_declaration(op)) {
+            ++_stats.deduplicated;
+            op->erase();
+            return;
+        }
+
+        if (is_forward_declaration(entry.op)) {
+            ++_stats.deduplicated;
+            entry.op->erase();
+            entry.op   = op;
+            entry.hash = hash;
+            move_to_program(op);
+            return;
+        }
+
+        if (same_definition(entry, op)) {
+            ++_stats.deduplicated;
+            op->erase();
+            return;
+        }
+
+        // Conflicting definitions were renamed before the unit was linked.
+        VAST_UNREACHABLE("conflicting definition of type {0} was not renamed", name);
+    }
+
+    void program_linker::report_conflicts() {
+        for (auto conflict : _conflicting) {
+            const auto &entry = conflict->getValue();
+            auto diag = mlir::emitWarning(entry.op->getLoc())
+                << "type '" << conflict->getKey() << "' has " << entry.conflicts.size() + 1
+                << " different definitions, the later ones are renamed";
+            for (const auto &[renamed, loc] : entry.conflicts) {
+                diag.attachNote(loc) << "different definition is renamed to '" << renamed << "'";
+            }
+        }
+
+        _stats.conflicting_types = _conflicting.size();
+        _conflicting.clear();
+    }
+
+    logical_result program_linker::add(vast_module mod) {
+        auto errors = _stats.errors;
+
+        // Types are renamed first, so that the layout entries of the unit
+        // refer to the renamed types.
+        rename_conflicting_types(mod);
+        std::ignore = merge_data_layout(mod);
+
+        // The program takes the other attributes of the first unit, e.g., its
+        // target.
+        for (auto attr : mod->getAttrs()) {
+            if (attr.getName() != mlir::SymbolTable::getSymbolAttrName() && !_program->hasAttr(attr.getName())) {
+                _program->setAttr(attr.getName(), attr.getValue());
+            }
+        }
+
+        rename_internals(mod);
+
+        auto ops = llvm::to_vector(llvm::make_pointer_range(mod.getOps()));
+        for (auto op : ops) {
+            if (is_global(op)) {
+                link_global(op, name_of(op), strength_of(op));
+            } else if (is_tag(op)) {
+                link_type(_tags, op, name_of(op));
+            } else if (mlir::isa< hl::TypeDefOp >(op)) {
+                link_type(_typedefs, op, name_of(op));
+            } else {
+                move_to_program(op);
+            }
+        }
+
+        ++_unit;
+        ++_stats.units;
+        return mlir::success(errors == _stats.errors);
+    }
+
+    owning_module_ref program_linker::finish() {
+        report_conflicts();
+
+        if (failed(mlir::verify(_program.get()))) {
+            return {};
+        }
+        return std::move(_program);
+    }
+
+    logical_result parse_files(
+        mcontext_t &mctx, llvm::ArrayRef< std::string > files, unsigned window,
+        llvm::function_ref< logical_result(std::size_t, vast_module) > process
+    ) {
+        // Slots of the parsed modules, each written by its own task and
+        // taken by the processing thread once the task finished.
+        std::vector< owning_module_ref > parsed(files.size());
+
+        auto status = mlir::success();
+
+        mlir::ParallelDiagnosticHandler diagnostics(&mctx);
+
+        auto parse = [&] (std::size_t i) {
+            diagnostics.setOrderIDForThread(i);
+
+            std::string err;
+            llvm::SourceMgr source_mgr;
+            if (auto input = mlir::openInputFile(files[i], &err)) {
+                source_mgr.AddNewSourceBuffer(std::move(input), llvm::SMLoc());
+                parsed[i] = util::parse_module(source_mgr, &mctx);
+            } else {
+                mlir::emitError(mlir::UnknownLoc::get(&mctx)) << err;
+            }
+
+            diagnostics.eraseOrderIDForThread();
+        };
+
+        window = std::max(window, 1u);
+        llvm::ThreadPool pool(llvm::hardware_concurrency(window));
+        std::deque< std::shared_future< void > > pending;
+
+        std::size_t scheduled = 0;
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            for (; scheduled < files.size() && scheduled < i + window; ++scheduled) {
+                pending.push_back(pool.async([&parse, scheduled] { parse(scheduled); }));
+            }
+
+            pending.front().wait();
+            pending.pop_front();
+
+            if (!parsed[i]) {
+                mlir::emitError(mlir::UnknownLoc::get(&mctx)) << "cannot parse module " << files[i];
+                status = mlir::failure();
+                continue;
+            }
+
+            if (failed(process(i, parsed[i].get()))) {
+                status = mlir::failure();
+            }
+
+            parsed[i] = nullptr;
+        }
+
+        return status;
+    }
+
+    owning_module_ref link_files(
+        mcontext_t &mctx, llvm::ArrayRef< std::string > files, unsigned window, link_stats *stats
+    ) {
+        program_linker linker(mctx);
+
+        auto status = parse_files(mctx, files, window, [&] (std::size_t, vast_module mod) {
+            return linker.add(mod);
+        });
+
+        auto program = linker.finish();
+
+        if (stats) {
+            *stats = linker.stats();
+        }
+
+        if (failed(status)) {
+            return {};
+        }
+
+        return program;
+    }
+
+    unit_symbols external_symbols(vast_module mod) {
+        using strength = program_linker::strength;
+
+        unit_symbols symbols;
+
+        // Internal symbols do not resolve references of other units, but they
+        // resolve the references of their own unit.
+        llvm::StringSet<> defined;
+        for (auto &op : mod.getOps()) {
+            if (!is_global(&op)) {
+                continue;
+            }
+
+            auto name = name_of(&op);
+            auto kind = program_linker::strength_of(&op);
+            if (kind == strength::declaration) {
+                continue;
+            }
+
+            defined.insert(name);
+            if (kind != strength::internal) {
+                symbols.defined.push_back(name.str());
+            }
+        }
+
+        llvm::StringSet<> referenced;
+        auto refer = [&] (string_ref name) {
+            if (!defined.contains(name) && referenced.insert(name).second) {
+                symbols.referenced.push_back(name.str());
+            }
+        };
+
+        if (auto uses = mlir::SymbolTable::getSymbolUses(&mod.getBodyRegion())) {
+            for (const auto &use : *uses) {
+                refer(use.getSymbolRef().getRootReference());
+            }
+        }
+
+        mod->walk([&] (hl::GlobalRefOp ref) { refer(ref.getGlobal()); });
+
+        return symbols;
+    }
+
+    std::vector< unsigned > partition_units(llvm::ArrayRef< unit_symbols > units, unsigned partitions) {
+        partitions = std::max(partitions, 1u);
+        std::vector< unsigned > result(units.size(), 0);
+
+        auto weight = [&] (std::size_t unit) { return units[unit].defined.size() + 1; };
+
+        std::size_t total = 0;
+        for (std::size_t unit = 0; unit < units.size(); ++unit) {
+            total += weight(unit);
+        }
+        auto capacity = total / partitions + total / (4 * partitions) + 1;
+
+        std::vector< std::size_t > order(units.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&] (auto a, auto b) {
+            return weight(a) > weight(b);
+        });
+
+        // symbols defined and referenced by the units of each partition
+        std::vector< llvm::StringSet<> > defines(partitions);
+        std::vector< llvm::StringMap< unsigned > > references(partitions);
+        std::vector< std::size_t > sizes(partitions, 0);
+
+        for (auto unit : order) {
+            const auto &symbols = units[unit];
+
+            auto connections = [&] (unsigned part) {
+                std::size_t count = 0;
+                for (const auto &name : symbols.referenced) {
+                    count += defines[part].contains(name);
+                }
+                for (const auto &name : symbols.defined) {
+                    count += references[part].lookup(name);
+                }
+                return count;
+            };
+
+            std::optional< unsigned > best;
+            std::size_t best_connections = 0;
+            for (unsigned part = 0; part < partitions; ++part) {
+                if (sizes[part] != 0 && sizes[part] + weight(unit) > capacity) {
+                    continue;
+                }
+
+                auto count = connections(part);
+                if (!best || count > best_connections
+                    || (count == best_connections && sizes[part] < sizes[*best])
+                ) {
+                    best = part;
+                    best_connections = count;
+                }
+            }
+
+            // Units that fit nowhere go to the smallest partition.
+            if (!best) {
+                best = unsigned(std::distance(sizes.begin(), std::min_element(sizes.begin(), sizes.end())));
+            }
+
+            result[unit] = *best;
+            sizes[*best] += weight(unit);
+            for (const auto &name : symbols.defined) {
+                defines[*best].insert(name);
+            }
+            for (const auto &name : symbols.referenced) {
+                ++references[*best][name];
+            }
+        }
+
+        return result;
+    }
+
+    std::size_t cross_partition_references(
+        llvm::ArrayRef< unit_symbols > units, llvm::ArrayRef< unsigned > partition
+    ) {
+        llvm::StringMap< llvm::SmallVector< unsigned, 1 > > definers;
+        for (auto [unit, symbols] : llvm::enumerate(units)) {
+            for (const auto &name : symbols.defined) {
+                definers[name].push_back(partition[unit]);
+            }
+        }
+
+        std::size_t count = 0;
+        for (auto [unit, symbols] : llvm::enumerate(units)) {
+            for (const auto &name : symbols.referenced) {
+                auto it = definers.find(name);
+                if (it != definers.end() && !llvm::is_contained(it->second, partition[unit])) {
+                    ++count;
+                }
+            }
+        }
+
+        return count;
+    }
+
+} // namespace vast::link
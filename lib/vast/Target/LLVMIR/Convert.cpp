@@ -12,16 +12,30 @@ VAST_RELAX_WARNINGS
 #include <mlir/Target/LLVMIR/Export.h>
 #include <mlir/Target/LLVMIR/Dialect/All.h>
 #include <mlir/Target/LLVMIR/LLVMTranslationInterface.h>
+#include <mlir/Target/LLVMIR/ModuleTranslation.h>
 #include <mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h>
 
+#include <mlir/IR/Threading.h>
 #include <mlir/Pass/PassManager.h>
 
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Metadata.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Operator.h>
 
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Linker/Linker.h>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSwitch.h>
 #include <llvm/ADT/TypeSwitch.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
@@ -47,6 +61,118 @@ namespace vast::target::llvmir
                     return mlir::failure();
                 });
         }
+
+        // Sets `nsw` of the instructions translated from arithmetic marked by
+        // the lowering of signed integer operations, the tail call kind of
+        // calls, and attaches branch hints of loop latches as `llvm.loop`
+        // metadata.
+        mlir::LogicalResult amendOperation(mlir::Operation *op, mlir::NamedAttribute attr,
+                                           mlir::LLVM::ModuleTranslation &state) const final
+        {
+            if (attr.getName() == hl::HighLevelDialect::getLoopHintsAttrName()) {
+                if (auto hints = mlir::dyn_cast< hl::LoopHintsAttr >(attr.getValue())) {
+                    attach_loop_hints(op, hints, state);
+                }
+                return mlir::success();
+            }
+
+            if (attr.getName() == hl::HighLevelDialect::getMustTailAttrName()
+                || attr.getName() == hl::HighLevelDialect::getTailAttrName()
+            ) {
+                if (auto call = state.lookupCall(op)) {
+                    call->setTailCallKind(attr.getName() == hl::HighLevelDialect::getMustTailAttrName()
+                        ? llvm::CallInst::TCK_MustTail
+                        : llvm::CallInst::TCK_Tail
+                    );
+                }
+                return mlir::success();
+            }
+
+            if (attr.getName() != hl::HighLevelDialect::getNoSignedWrapAttrName()) {
+                return mlir::success();
+            }
+
+            if (op->getNumResults() != 1) {
+                return mlir::success();
+            }
+
+            // Constant operands may be folded by the ir builder.
+            auto inst = llvm::dyn_cast_or_null< llvm::Instruction >(state.lookupValue(op->getResult(0)));
+            if (inst && llvm::isa< llvm::OverflowingBinaryOperator >(inst)) {
+                inst->setHasNoSignedWrap(true);
+            }
+
+            return mlir::success();
+        }
+
+      private:
+        static llvm::MDNode *make_loop_id(llvm::LLVMContext &ctx, hl::LoopHintsAttr hints) {
+            auto i1  = llvm::Type::getInt1Ty(ctx);
+            auto i32 = llvm::Type::getInt32Ty(ctx);
+
+            llvm::SmallVector< llvm::Metadata * > md;
+            auto tmp = llvm::MDNode::getTemporary(ctx, std::nullopt);
+            md.push_back(tmp.get());
+
+            auto flag = [&] (llvm::StringRef name) {
+                md.push_back(llvm::MDNode::get(ctx, { llvm::MDString::get(ctx, name) }));
+            };
+
+            auto value = [&] (llvm::StringRef name, llvm::Type *type, std::uint64_t v) {
+                md.push_back(llvm::MDNode::get(ctx, {
+                    llvm::MDString::get(ctx, name),
+                    llvm::ConstantAsMetadata::get(llvm::ConstantInt::get(type, v))
+                }));
+            };
+
+            if (auto vectorize = hints.getVectorize()) {
+                value("llvm.loop.vectorize.enable", i1, vectorize.getValue());
+            }
+            if (auto width = hints.getVectorizeWidth()) {
+                value("llvm.loop.vectorize.width", i32, width);
+            }
+            if (auto count = hints.getInterleaveCount()) {
+                value("llvm.loop.interleave.count", i32, count);
+            }
+            if (auto full = hints.getUnrollFull(); full && full.getValue()) {
+                flag("llvm.loop.unroll.full");
+            } else if (auto unroll = hints.getUnroll()) {
+                flag(unroll.getValue() ? "llvm.loop.unroll.enable" : "llvm.loop.unroll.disable");
+            }
+            if (auto count = hints.getUnrollCount()) {
+                value("llvm.loop.unroll.count", i32, count);
+            }
+            if (auto distribute = hints.getDistribute()) {
+                value("llvm.loop.distribute.enable", i1, distribute.getValue());
+            }
+
+            // Loop ids are distinct nodes that refer to themselves.
+            auto id = llvm::MDNode::getDistinct(ctx, md);
+            id->replaceOperandWith(0, id);
+            return id;
+        }
+
+        static void attach_loop_hints(
+            mlir::Operation *op, hl::LoopHintsAttr hints, mlir::LLVM::ModuleTranslation &state
+        ) {
+            auto br = state.lookupBranch(op);
+            if (!br || br->getNumSuccessors() != 1) {
+                return;
+            }
+
+            // Latches of the same loop share a single loop id.
+            auto header = br->getSuccessor(0);
+            for (auto pred : llvm::predecessors(header)) {
+                if (auto term = pred->getTerminator(); term && term != br) {
+                    if (auto id = term->getMetadata(llvm::LLVMContext::MD_loop)) {
+                        br->setMetadata(llvm::LLVMContext::MD_loop, id);
+                        return;
+                    }
+                }
+            }
+
+            br->setMetadata(llvm::LLVMContext::MD_loop, make_loop_id(br->getContext(), hints));
+        }
     };
 
     // TODO: move to translation passes that erase specific types from module
@@ -56,6 +182,9 @@ namespace vast::target::llvmir
         // will fail and no conversion translation happens, even in case these
         // entries are not used at all.
         auto dl = mlir_module.getDataLayoutSpec();
+        if (!dl) {
+            return;
+        }
 
         auto is_llvm_compatible_entry = [] (auto entry) {
             return mlir::LLVM::isCompatibleType(entry.getKey().template get< mlir_type >());
@@ -73,8 +202,238 @@ namespace vast::target::llvmir
         );
     }
 
+    namespace
+    {
+        bool has_local_linkage(mlir::LLVM::Linkage linkage) {
+            return linkage == mlir::LLVM::Linkage::Private
+                || linkage == mlir::LLVM::Linkage::Internal;
+        }
+
+        llvm::GlobalValue::LinkageTypes to_llvm_local_linkage(mlir::LLVM::Linkage linkage) {
+            return linkage == mlir::LLVM::Linkage::Private
+                ? llvm::GlobalValue::PrivateLinkage
+                : llvm::GlobalValue::InternalLinkage;
+        }
+
+        //
+        // Parallel translation splits the module into shards, each a copy of
+        // the module in which only some of the functions keep their bodies.
+        // The first shard keeps definitions of globals, the other shards only
+        // declare them. All symbols are made external, so the translated
+        // shards link back together, and local symbols get their linkage back
+        // in the linked module.
+        //
+        struct sharded_translation
+        {
+            using bitcode_t = llvm::SmallVector< char, 0 >;
+
+            explicit sharded_translation(vast_module mod) : mod(mod) {}
+
+            std::unique_ptr< llvm::Module > run(llvm::LLVMContext &llvm_ctx, std::size_t count) {
+                collect_locals();
+                assign_functions(count);
+
+                for (std::size_t idx = 0; idx < count; ++idx) {
+                    shards.push_back(make_shard(idx));
+                }
+
+                bitcodes.resize(shards.size());
+                auto result = mlir::failableParallelForEachN(
+                    mod.getContext(), 0, shards.size(), [&] (std::size_t idx) {
+                        return translate_shard(idx);
+                    }
+                );
+
+                shards.clear();
+                if (mlir::failed(result)) {
+                    return nullptr;
+                }
+
+                return link(llvm_ctx);
+            }
+
+          private:
+            void collect_locals() {
+                for (auto fn : mod.getOps< mlir::LLVM::LLVMFuncOp >()) {
+                    if (has_local_linkage(fn.getLinkage())) {
+                        locals[fn.getSymName()] = to_llvm_local_linkage(fn.getLinkage());
+                    }
+                }
+
+                for (auto global : mod.getOps< mlir::LLVM::GlobalOp >()) {
+                    if (has_local_linkage(global.getLinkage())) {
+                        locals[global.getSymName()] = to_llvm_local_linkage(global.getLinkage());
+                    }
+                }
+            }
+
+            // Greedily places the largest functions first, each to the shard
+            // with the fewest operations so far.
+            void assign_functions(std::size_t count) {
+                llvm::SmallVector< std::pair< std::size_t, string_ref > > sizes;
+                for (auto fn : mod.getOps< mlir::LLVM::LLVMFuncOp >()) {
+                    if (!fn.isExternal()) {
+                        std::size_t size = 0;
+                        fn.walk([&] (operation) { ++size; });
+                        sizes.emplace_back(size, fn.getSymName());
+                    }
+                }
+
+                llvm::stable_sort(sizes, [] (const auto &a, const auto &b) {
+                    return a.first > b.first;
+                });
+
+                llvm::SmallVector< std::size_t > loads(count, 0);
+                for (const auto &[size, name] : sizes) {
+                    auto lightest = std::distance(loads.begin(), llvm::min_element(loads));
+                    loads[lightest] += size;
+                    owners[name] = lightest;
+                }
+            }
+
+            // Definitions that stay in the shard only lose local linkage,
+            // dropped definitions become external declarations.
+            template< typename op_t >
+            static void externalize(op_t op, bool dropped) {
+                if (dropped || has_local_linkage(op.getLinkage())) {
+                    op.setLinkage(mlir::LLVM::Linkage::External);
+                }
+            }
+
+            owning_module_ref make_shard(std::size_t idx) {
+                owning_module_ref shard = mod.clone();
+
+                for (auto &op : llvm::make_early_inc_range(shard->getOps())) {
+                    if (auto fn = mlir::dyn_cast< mlir::LLVM::LLVMFuncOp >(op)) {
+                        if (fn.isExternal()) {
+                            continue;
+                        }
+
+                        bool dropped = owners.lookup(fn.getSymName()) != idx;
+                        if (dropped) {
+                            fn.eraseBody();
+                        }
+                        externalize(fn, dropped);
+                    } else if (auto global = mlir::dyn_cast< mlir::LLVM::GlobalOp >(op)) {
+                        if (idx == 0) {
+                            externalize(global, false);
+                        } else if (global.getLinkage() == mlir::LLVM::Linkage::Appending) {
+                            op.erase();
+                        } else if (global.getValueOrNull() || !global.getInitializerRegion().empty()) {
+                            global.getInitializerRegion().dropAllReferences();
+                            global.getInitializerRegion().getBlocks().clear();
+                            global.removeValueAttr();
+                            externalize(global, true);
+                        }
+                    } else if (idx != 0 && mlir::isa< mlir::LLVM::GlobalCtorsOp, mlir::LLVM::GlobalDtorsOp >(op)) {
+                        op.erase();
+                    }
+                }
+
+                return shard;
+            }
+
+            // Runs concurrently, every shard is translated in its own context.
+            logical_result translate_shard(std::size_t idx) {
+                llvm::LLVMContext ctx;
+                auto translated = mlir::translateModuleToLLVMIR(shards[idx].get(), ctx);
+                if (!translated) {
+                    return mlir::failure();
+                }
+
+                llvm::raw_svector_ostream os(bitcodes[idx]);
+                llvm::WriteBitcodeToFile(*translated, os);
+                return mlir::success();
+            }
+
+            std::unique_ptr< llvm::Module > read(const bitcode_t &bitcode, llvm::LLVMContext &llvm_ctx) {
+                auto buffer = llvm::MemoryBufferRef(
+                    llvm::StringRef(bitcode.data(), bitcode.size()), "vast-translation-shard"
+                );
+
+                auto result = llvm::parseBitcodeFile(buffer, llvm_ctx);
+                if (!result) {
+                    VAST_FATAL("failed to read translated shard: {0}", llvm::toString(result.takeError()));
+                }
+                return std::move(*result);
+            }
+
+            std::unique_ptr< llvm::Module > link(llvm::LLVMContext &llvm_ctx) {
+                auto linked = read(bitcodes.front(), llvm_ctx);
+
+                llvm::Linker linker(*linked);
+                for (const auto &bitcode : llvm::drop_begin(bitcodes)) {
+                    if (linker.linkInModule(read(bitcode, llvm_ctx))) {
+                        VAST_FATAL("failed to link translated shards");
+                    }
+                }
+
+                for (auto &gv : linked->global_values()) {
+                    if (auto it = locals.find(gv.getName()); it != locals.end()) {
+                        gv.setLinkage(it->second);
+                        gv.setVisibility(llvm::GlobalValue::DefaultVisibility);
+                    }
+                }
+
+                return linked;
+            }
+
+            vast_module mod;
+
+            llvm::StringMap< std::size_t > owners;
+            llvm::StringMap< llvm::GlobalValue::LinkageTypes > locals;
+
+            std::vector< owning_module_ref > shards;
+            std::vector< bitcode_t > bitcodes;
+        };
+
+        // Thread-local globals of llvm dialect have no model, the model the
+        // lowering recorded is set on the translated globals.
+        std::unique_ptr< llvm::Module > set_tls_models(
+            vast_module mod, std::unique_ptr< llvm::Module > translated
+        ) {
+            if (!translated) {
+                return translated;
+            }
+
+            for (auto global : mod.getOps< mlir::LLVM::GlobalOp >()) {
+                auto model = global->getAttrOfType< mlir::StringAttr >(
+                    hl::HighLevelDialect::getTLSModelAttrName()
+                );
+
+                auto gv = translated->getGlobalVariable(global.getSymName(), /* allow internal */ true);
+                if (!model || !gv || !gv->isThreadLocal()) {
+                    continue;
+                }
+
+                gv->setThreadLocalMode(llvm::StringSwitch< llvm::GlobalValue::ThreadLocalMode >(model.getValue())
+                    .Case("localdynamic", llvm::GlobalValue::LocalDynamicTLSModel)
+                    .Case("initialexec", llvm::GlobalValue::InitialExecTLSModel)
+                    .Case("localexec", llvm::GlobalValue::LocalExecTLSModel)
+                    .Default(llvm::GlobalValue::GeneralDynamicTLSModel)
+                );
+            }
+
+            return translated;
+        }
+
+        std::size_t translation_shards(vast_module mod) {
+            auto mctx = mod.getContext();
+            if (!mctx->isMultithreadingEnabled()) {
+                return 1;
+            }
+
+            auto definitions = llvm::count_if(
+                mod.getOps< mlir::LLVM::LLVMFuncOp >(), [] (auto fn) { return !fn.isExternal(); }
+            );
+
+            return std::min< std::size_t >(definitions, mctx->getNumThreads());
+        }
+
+    } // namespace
+
     std::unique_ptr< llvm::Module > translate(
-        vast_module mlir_module, llvm::LLVMContext &llvm_ctx
+        vast_module mlir_module, llvm::LLVMContext &llvm_ctx, translation_mode mode
     ) {
         clean_up_data_layout(mlir_module);
 
@@ -85,22 +444,49 @@ namespace vast::target::llvmir
             mlir_module->removeAttr(core::CoreDialect::getTargetTripleAttrName());
         }
 
-        mlir::registerBuiltinDialectTranslation(*mlir_module.getContext());
-        mlir::registerLLVMDialectTranslation(*mlir_module.getContext());
+        auto llvm_dialect = mlir_module.getContext()->getLoadedDialect< mlir::LLVM::LLVMDialect >();
+        VAST_CHECK(
+            llvm_dialect && llvm_dialect->getRegisteredInterface< mlir::LLVMTranslationDialectInterface >(),
+            "llvm translations are not registered, call register_vast_to_llvm_ir"
+        );
 
-        return mlir::translateModuleToLLVMIR(mlir_module, llvm_ctx);
+        // Marks of the lowering, e.g., `hl.nsw`, are translated by the
+        // interface of the high-level dialect only, without it these would
+        // be silently dropped.
+        auto hl_dialect = mlir_module.getContext()->getOrLoadDialect< hl::HighLevelDialect >();
+        VAST_CHECK(
+            hl_dialect->getRegisteredInterface< mlir::LLVMTranslationDialectInterface >(),
+            "high-level translations are not registered, call register_vast_to_llvm_ir"
+        );
+
+        if (mode == translation_mode::parallel) {
+            if (auto shards = translation_shards(mlir_module); shards > 1) {
+                return set_tls_models(
+                    mlir_module, sharded_translation(mlir_module).run(llvm_ctx, shards)
+                );
+            }
+        }
+
+        return set_tls_models(mlir_module, mlir::translateModuleToLLVMIR(mlir_module, llvm_ctx));
     }
 
     void register_vast_to_llvm_ir(mlir::DialectRegistry &registry)
     {
         registry.insert< hl::HighLevelDialect >();
+        registry.addExtension(+[] (mcontext_t *, hl::HighLevelDialect *dialect) {
+            dialect->addInterfaces< ToLLVMIR >();
+        });
         mlir::registerAllToLLVMIRTranslations(registry);
     }
 
     void register_vast_to_llvm_ir(mcontext_t &mctx)
     {
-        mlir::DialectRegistry registry;
-        register_vast_to_llvm_ir(registry);
+        static const mlir::DialectRegistry registry = [] {
+            mlir::DialectRegistry registry;
+            register_vast_to_llvm_ir(registry);
+            return registry;
+        }();
+
         mctx.appendDialectRegistry(registry);
     }
 
@@ -2,21 +2,265 @@
 
 #include "vast/Tower/Tower.hpp"
 
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/Parser/Parser.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
 namespace vast::tw {
-    auto default_loc_rewriter_t::insert(mlir::Operation *op) -> void {
-        auto ctx = op->getContext();
-        auto ol  = mlir::OpaqueLoc::get< mlir::Operation  *>(op, ctx);
-        op->setLoc(mlir::FusedLoc::get({ op->getLoc() }, ol, ctx));
+    op_numbering::op_numbering(vast_module mod) {
+        mod->walk< mlir::WalkOrder::PreOrder >([&] (mlir::Operation *op) {
+            positions[op] = static_cast< op_position >(ops.size());
+            ops.push_back(op);
+        });
+    }
+
+    clone_origins::clone_origins(const op_numbering &source, const mlir::IRMapping &mapping) {
+        for (auto [from, to] : mapping.getOperationMap()) {
+            auto pos = source.position(from);
+            clones.try_emplace(to, origin_t{ pos, from->getName(), from->getLoc() });
+            by_loc.try_emplace(from->getLoc(), pos);
+        }
+    }
+
+    default_provenance_t::default_provenance_t(const op_numbering &layer, const clone_origins &origins) {
+        // Entries of clones erased by the passes may dangle, or point to new
+        // operations at the same address, hence the name and location check.
+        ops.reserve(layer.size());
+        for (op_position pos = 0; pos < layer.size(); ++pos) {
+            auto op = layer.op(pos);
+            auto it = origins.clones.find(op);
+            if (it != origins.clones.end()
+                && it->second.name == op->getName() && it->second.loc == op->getLoc()
+            ) {
+                ops.push_back(it->second.pos);
+                continue;
+            }
+
+            auto loc = origins.by_loc.find(op->getLoc());
+            ops.push_back(loc != origins.by_loc.end() ? loc->second : no_position);
+        }
+
+        index();
+    }
+
+    default_provenance_t::default_provenance_t(std::vector< op_position > ops) : ops(std::move(ops)) {
+        index();
+    }
+
+    auto default_provenance_t::prev(op_position pos) const -> op_position {
+        return pos < ops.size() ? ops[pos] : no_position;
+    }
+
+    auto default_provenance_t::next(op_position pos) const -> llvm::ArrayRef< op_position > {
+        if (auto it = derived.find(pos); it != derived.end()) {
+            return it->second;
+        }
+        return {};
+    }
+
+    auto default_provenance_t::skip(const default_provenance_t &released) -> void {
+        for (auto &from : ops) {
+            if (from != no_position) {
+                from = released.prev(from);
+            }
+        }
+        index();
+    }
+
+    auto default_provenance_t::index() -> void {
+        derived.clear();
+        for (op_position pos = 0; pos < ops.size(); ++pos) {
+            if (ops[pos] != no_position) {
+                derived[ops[pos]].push_back(pos);
+            }
+        }
+    }
+
+    auto spill_module(vast_module mod) -> std::string {
+        int fd = 0;
+        llvm::SmallString< 128 > path;
+        if (auto ec = llvm::sys::fs::createTemporaryFile("vast-tower", "mlirbc", fd, path)) {
+            VAST_FATAL("unable to create a file for the tower layer: {0}", ec.message());
+        }
+
+        llvm::raw_fd_ostream os(fd, /* shouldClose */ true);
+        if (mlir::failed(mlir::writeBytecodeToFile(mod, os))) {
+            VAST_FATAL("unable to write the tower layer to {0}", path.str());
+        }
+
+        return path.str().str();
+    }
+
+    auto load_spilled_module(mcontext_t &ctx, const std::string &path) -> owning_module_ref {
+        auto mod = mlir::parseSourceFile< vast_module >(path, &ctx);
+        if (!mod) {
+            VAST_FATAL("unable to load the tower layer from {0}", path);
+        }
+
+        drop_spilled_module(path);
+        return mod;
+    }
+
+    auto drop_spilled_module(const std::string &path) -> void {
+        std::ignore = llvm::sys::fs::remove(path);
+    }
+
+    namespace {
+        constexpr string_ref manifest_header = "vast-tower 1";
+
+        auto file_in(const std::string &dir, string_ref name) -> std::string {
+            llvm::SmallString< 128 > path(dir);
+            llvm::sys::path::append(path, name);
+            return path.str().str();
+        }
+
+        auto create_parent(const std::string &path) -> logical_result {
+            auto dir = llvm::sys::path::parent_path(path);
+            return mlir::failure(!dir.empty() && llvm::sys::fs::create_directories(dir));
+        }
+
+    } // namespace
+
+    auto saved_layer_path(const std::string &dir, std::size_t id, string_ref kind) -> std::string {
+        return file_in(dir, ("layer-" + llvm::Twine(id) + "." + kind).str());
+    }
+
+    auto save_module(vast_module mod, const std::string &path) -> logical_result {
+        if (mlir::failed(create_parent(path))) {
+            return mlir::failure();
+        }
+
+        std::error_code ec;
+        llvm::raw_fd_ostream os(path, ec);
+        if (ec) {
+            return mlir::failure();
+        }
+        return mlir::writeBytecodeToFile(mod, os);
+    }
+
+    auto save_spilled_module(const std::string &spilled, const std::string &path) -> logical_result {
+        if (mlir::failed(create_parent(path))) {
+            return mlir::failure();
+        }
+        return mlir::failure(bool(llvm::sys::fs::copy_file(spilled, path)));
+    }
+
+    auto restore_spilled_module(const std::string &path) -> std::optional< std::string > {
+        llvm::SmallString< 128 > copy;
+        if (llvm::sys::fs::createTemporaryFile("vast-tower", "mlirbc", copy)) {
+            return std::nullopt;
+        }
+
+        if (llvm::sys::fs::copy_file(path, copy)) {
+            drop_spilled_module(copy.str().str());
+            return std::nullopt;
+        }
+        return copy.str().str();
+    }
+
+    // The number of the positions followed by the positions, little endian.
+    auto save_positions(llvm::ArrayRef< op_position > positions, const std::string &path)
+        -> logical_result
+    {
+        std::error_code ec;
+        llvm::raw_fd_ostream os(path, ec);
+        if (ec) {
+            return mlir::failure();
+        }
+
+        llvm::support::endian::Writer writer(os, llvm::support::little);
+        writer.write(std::uint64_t(positions.size()));
+        for (auto pos : positions) {
+            writer.write(pos);
+        }
+        return mlir::success();
+    }
+
+    auto restore_positions(const std::string &path) -> std::optional< std::vector< op_position > > {
+        auto file = llvm::MemoryBuffer::getFile(path);
+        if (!file) {
+            return std::nullopt;
+        }
+
+        auto bytes = file.get()->getBuffer();
+        if (bytes.size() < sizeof(std::uint64_t)) {
+            return std::nullopt;
+        }
+
+        auto data  = bytes.data();
+        auto count = llvm::support::endian::read64le(data);
+        if (bytes.size() != sizeof(std::uint64_t) + count * sizeof(op_position)) {
+            return std::nullopt;
+        }
+
+        std::vector< op_position > positions(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            positions[i] = llvm::support::endian::read32le(data + sizeof(std::uint64_t) + i * sizeof(op_position));
+        }
+        return positions;
+    }
+
+    // The header and a line per layer, `<id> live` or `<id> released`.
+    auto save_manifest(const std::string &dir, const std::vector< bool > &live) -> logical_result {
+        if (llvm::sys::fs::create_directories(dir)) {
+            return mlir::failure();
+        }
+
+        std::error_code ec;
+        llvm::raw_fd_ostream os(file_in(dir, "tower"), ec);
+        if (ec) {
+            return mlir::failure();
+        }
+
+        os << manifest_header << "\n";
+        for (std::size_t id = 0; id < live.size(); ++id) {
+            os << id << (live[id] ? " live" : " released") << "\n";
+        }
+        return mlir::success();
     }
 
-    auto default_loc_rewriter_t::remove(mlir::Operation *op) -> void {
-        auto fl = mlir::cast< mlir::FusedLoc >(op->getLoc());
-        op->setLoc(fl.getLocations().front());
+    auto restore_manifest(const std::string &dir) -> std::optional< std::vector< bool > > {
+        auto file = llvm::MemoryBuffer::getFile(file_in(dir, "tower"));
+        if (!file) {
+            return std::nullopt;
+        }
+
+        llvm::SmallVector< string_ref > lines;
+        file.get()->getBuffer().split(lines, '\n', /* max split */ -1, /* keep empty */ false);
+        if (lines.empty() || lines.front() != manifest_header) {
+            return std::nullopt;
+        }
+
+        std::vector< bool > live;
+        for (auto line : llvm::drop_begin(lines)) {
+            auto [id, kind] = line.split(' ');
+            std::size_t value = 0;
+            if (id.getAsInteger(10, value) || value != live.size()) {
+                return std::nullopt;
+            }
+
+            if (kind != "live" && kind != "released") {
+                return std::nullopt;
+            }
+            live.push_back(kind == "live");
+        }
+        return live;
     }
 
-    auto default_loc_rewriter_t::prev(mlir::Operation *op) -> mlir::Operation * {
-        auto fl = mlir::cast< mlir::FusedLoc >(op->getLoc());
-        auto ol = mlir::cast< mlir::OpaqueLoc >(fl.getMetadata());
-        return mlir::OpaqueLoc::getUnderlyingLocation< mlir::Operation * >(ol);
+    auto load_dependent_dialects(mlir::PassManager &pm) -> void {
+        mlir::DialectRegistry registry;
+        pm.getDependentDialects(registry);
+
+        auto ctx = pm.getContext();
+        ctx->appendDialectRegistry(registry);
+        for (auto name : registry.getDialectNames()) {
+            ctx->getOrLoadDialect(name);
+        }
     }
 } // namespace vast::tw
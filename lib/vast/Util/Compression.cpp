@@ -0,0 +1,180 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/Compression.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Process.h>
+VAST_UNRELAX_WARNINGS
+
+#ifdef VAST_ENABLE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <mutex>
+
+namespace vast::util
+{
+    bool is_zstd_frame(string_ref bytes) {
+        // magic number of zstd frames, little endian
+        return bytes.starts_with(string_ref("\x28\xb5\x2f\xfd", 4));
+    }
+
+#ifdef VAST_ENABLE_ZSTD
+    namespace
+    {
+        // Contexts keep their buffers between the frames of a thread.
+        ZSTD_CCtx *compression_context() {
+            thread_local std::unique_ptr< ZSTD_CCtx, decltype(&ZSTD_freeCCtx) > ctx(
+                ZSTD_createCCtx(), &ZSTD_freeCCtx
+            );
+            return ctx.get();
+        }
+
+        ZSTD_DCtx *decompression_context() {
+            thread_local std::unique_ptr< ZSTD_DCtx, decltype(&ZSTD_freeDCtx) > ctx(
+                ZSTD_createDCtx(), &ZSTD_freeDCtx
+            );
+            return ctx.get();
+        }
+    } // namespace
+#endif
+
+    zstd_dictionary::zstd_dictionary(std::string bytes, [[maybe_unused]] int level)
+        : bytes(std::move(bytes))
+    {
+#ifdef VAST_ENABLE_ZSTD
+        cdict   = ZSTD_createCDict(this->bytes.data(), this->bytes.size(), level);
+        ddict   = ZSTD_createDDict(this->bytes.data(), this->bytes.size());
+        dict_id = ZSTD_getDictID_fromDict(this->bytes.data(), this->bytes.size());
+#endif
+    }
+
+    zstd_dictionary::~zstd_dictionary() {
+#ifdef VAST_ENABLE_ZSTD
+        ZSTD_freeCDict(cdict);
+        ZSTD_freeDDict(ddict);
+#endif
+    }
+
+    zstd_dictionary_ptr zstd_dictionary::load(string_ref path, int level) {
+        if (!has_zstd) {
+            return nullptr;
+        }
+
+        static std::mutex mutex;
+        static llvm::StringMap< zstd_dictionary_ptr > loaded;
+
+        auto key = path.str() + '\0' + std::to_string(level);
+
+        std::scoped_lock lock(mutex);
+        if (auto it = loaded.find(key); it != loaded.end()) {
+            return it->second;
+        }
+
+        auto buffer = llvm::MemoryBuffer::getFile(path, /* text */ false, /* null terminated */ false);
+        if (!buffer) {
+            return nullptr;
+        }
+
+        zstd_dictionary_ptr dict(new zstd_dictionary(buffer.get()->getBuffer().str(), level));
+        if (!dict->cdict || !dict->ddict) {
+            return nullptr;
+        }
+
+        return loaded[key] = dict;
+    }
+
+    zstd_dictionary_ptr default_zstd_dictionary(int level) {
+        if (auto path = llvm::sys::Process::GetEnv("VAST_ZSTD_DICT"); path && !path->empty()) {
+            return zstd_dictionary::load(*path, level);
+        }
+        return nullptr;
+    }
+
+    std::optional< std::string > zstd_compress(
+        [[maybe_unused]] string_ref bytes, [[maybe_unused]] int level,
+        [[maybe_unused]] const zstd_dictionary *dict
+    ) {
+#ifdef VAST_ENABLE_ZSTD
+        std::string frame(ZSTD_compressBound(bytes.size()), '\0');
+        auto ctx  = compression_context();
+        auto size = dict
+            ? ZSTD_compress_usingCDict(
+                ctx, frame.data(), frame.size(), bytes.data(), bytes.size(), dict->compression_dict()
+            )
+            : ZSTD_compressCCtx(ctx, frame.data(), frame.size(), bytes.data(), bytes.size(), level);
+
+        if (ZSTD_isError(size)) {
+            return std::nullopt;
+        }
+
+        frame.resize(size);
+        return frame;
+#else
+        return std::nullopt;
+#endif
+    }
+
+    std::optional< std::string > zstd_decompress(
+        [[maybe_unused]] string_ref bytes, [[maybe_unused]] const zstd_dictionary *dict
+    ) {
+#ifdef VAST_ENABLE_ZSTD
+        if (!is_zstd_frame(bytes)) {
+            return std::nullopt;
+        }
+
+        // Raw content dictionaries have no id, as do frames without
+        // a dictionary.
+        auto id = ZSTD_getDictID_fromFrame(bytes.data(), bytes.size());
+        bool with_dict = dict && id == dict->id();
+        if (id != 0 && !with_dict) {
+            return std::nullopt;
+        }
+
+        // Frames are written in one piece, hence with their size.
+        auto size = ZSTD_getFrameContentSize(bytes.data(), bytes.size());
+        if (size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR) {
+            return std::nullopt;
+        }
+
+        std::string contents(size, '\0');
+        auto ctx     = decompression_context();
+        auto written = with_dict
+            ? ZSTD_decompress_usingDDict(
+                ctx, contents.data(), contents.size(), bytes.data(), bytes.size(), dict->decompression_dict()
+            )
+            : ZSTD_decompressDCtx(ctx, contents.data(), contents.size(), bytes.data(), bytes.size());
+
+        if (ZSTD_isError(written) || written != size) {
+            return std::nullopt;
+        }
+
+        return contents;
+#else
+        return std::nullopt;
+#endif
+    }
+
+    std::string bytecode_compression::compress(std::string bytes) const {
+        if (!level || is_zstd_frame(bytes)) {
+            return bytes;
+        }
+
+        if (auto frame = zstd_compress(bytes, *level, dict.get()); frame && frame->size() < bytes.size()) {
+            return std::move(*frame);
+        }
+
+        return bytes;
+    }
+
+    std::optional< std::string > bytecode_compression::decompress(std::string bytes) const {
+        if (!is_zstd_frame(bytes)) {
+            return bytes;
+        }
+
+        return zstd_decompress(bytes, dict.get());
+    }
+
+} // namespace vast::util
@@ -0,0 +1,174 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/IRCensus.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Support/Format.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <mlir/IR/Location.h>
+#include <mlir/IR/Operation.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+#include <vector>
+
+namespace vast {
+
+    namespace {
+
+        // Results keep their use list, type and index, block arguments
+        // additionally their owner and location.
+        constexpr std::size_t result_bytes   = 3 * sizeof(void *);
+        constexpr std::size_t argument_bytes = 5 * sizeof(void *);
+
+        struct location_kind
+        {
+            string_ref name;
+            std::size_t bytes;
+        };
+
+        // Estimates the parameters of the storage along with the base storage
+        // of the uniquer.
+        location_kind kind_of(mlir::LocationAttr loc) {
+            constexpr std::size_t base = sizeof(void *);
+            using kind = location_kind;
+            return llvm::TypeSwitch< mlir::LocationAttr, kind >(loc)
+                .Case([] (mlir::FileLineColLoc) {
+                    return kind{ "FileLineColLoc", base + sizeof(void *) + 2 * sizeof(unsigned) };
+                })
+                .Case([] (mlir::FusedLoc fused) {
+                    auto trailing = fused.getLocations().size() * sizeof(void *);
+                    return kind{ "FusedLoc", base + 3 * sizeof(void *) + trailing };
+                })
+                .Case([] (mlir::NameLoc) { return kind{ "NameLoc", base + 2 * sizeof(void *) }; })
+                .Case([] (mlir::CallSiteLoc) { return kind{ "CallSiteLoc", base + 2 * sizeof(void *) }; })
+                .Case([] (mlir::OpaqueLoc) { return kind{ "OpaqueLoc", base + 3 * sizeof(void *) }; })
+                .Case([] (mlir::UnknownLoc) { return kind{ "UnknownLoc", base }; })
+                .Default([] (auto) { return kind{ "other", base }; });
+        }
+
+        string_ref dialect_of(auto element) {
+            auto name = element.getDialect().getNamespace();
+            return name.empty() ? "builtin" : name;
+        }
+
+        std::vector< std::pair< string_ref, std::size_t > > by_count(
+            const llvm::StringMap< std::size_t > &counts
+        ) {
+            std::vector< std::pair< string_ref, std::size_t > > sorted;
+            for (const auto &entry : counts) {
+                sorted.emplace_back(entry.getKey(), entry.getValue());
+            }
+
+            std::sort(sorted.begin(), sorted.end(), [] (const auto &a, const auto &b) {
+                return a.second != b.second ? a.second > b.second : a.first < b.first;
+            });
+            return sorted;
+        }
+
+        double kilobytes(std::size_t bytes) { return double(bytes) / 1024; }
+
+    } // namespace
+
+    ir_census ir_census::of(operation root) {
+        ir_census census;
+
+        llvm::DenseSet< mlir_type > types;
+        llvm::DenseSet< mlir_attr > attrs;
+        llvm::DenseSet< mlir::LocationAttr > locs;
+
+        // The walker visits every nested element only once.
+        mlir::AttrTypeWalker walker;
+        walker.addWalk([&] (mlir_type type) { types.insert(type); });
+        walker.addWalk([&] (mlir_attr attr) {
+            if (auto loc = mlir::dyn_cast< mlir::LocationAttr >(attr)) {
+                locs.insert(loc);
+            } else {
+                attrs.insert(attr);
+            }
+        });
+
+        root->walk([&] (operation op) {
+            ++census.ops[op->getName().getStringRef()];
+
+            census.op_bytes += sizeof(mlir::Operation)
+                + op->getNumOperands() * sizeof(mlir::OpOperand)
+                + op->getNumResults() * result_bytes
+                + op->getNumRegions() * sizeof(mlir::Region)
+                + op->getNumSuccessors() * sizeof(mlir::BlockOperand);
+
+            walker.walk(mlir_attr(op->getLoc()));
+            walker.walk(mlir_attr(op->getAttrDictionary()));
+            for (auto type : op->getResultTypes()) {
+                walker.walk(type);
+            }
+
+            for (auto &region : op->getRegions()) {
+                ++census.regions;
+                for (auto &block : region) {
+                    ++census.blocks;
+                    census.op_bytes += sizeof(mlir::Block) + block.getNumArguments() * argument_bytes;
+                    for (auto arg : block.getArguments()) {
+                        walker.walk(arg.getType());
+                        walker.walk(mlir_attr(arg.getLoc()));
+                    }
+                }
+            }
+        });
+
+        for (auto type : types) {
+            ++census.types[dialect_of(type)];
+        }
+
+        for (auto attr : attrs) {
+            ++census.attrs[dialect_of(attr)];
+        }
+
+        for (auto loc : locs) {
+            auto kind = kind_of(loc);
+            ++census.locs[kind.name];
+            census.loc_bytes += kind.bytes;
+        }
+
+        return census;
+    }
+
+    void ir_census::print(llvm::raw_ostream &os, string_ref step) const {
+        std::size_t total = 0;
+        for (const auto &entry : ops) {
+            total += entry.getValue();
+        }
+
+        auto print_counts = [&] (string_ref title, const llvm::StringMap< std::size_t > &counts) {
+            os << "  " << title << ":\n";
+            for (const auto &[name, count] : by_count(counts)) {
+                os << llvm::format("    %10zu  ", count) << name << "\n";
+            }
+        };
+
+        os << "===- vast IR census after " << step << " -===\n";
+        os << llvm::format(
+            "  %zu operations, %zu regions, %zu blocks, ~%.1f KB of operation storage\n",
+            total, regions, blocks, kilobytes(op_bytes)
+        );
+
+        print_counts("operations", ops);
+        print_counts("types by dialect", types);
+        print_counts("attributes by dialect", attrs);
+
+        std::size_t total_locs = 0;
+        for (const auto &entry : locs) {
+            total_locs += entry.getValue();
+        }
+
+        os << llvm::format(
+            "  %zu locations, ~%.1f KB of location storage\n", total_locs, kilobytes(loc_bytes)
+        );
+        for (const auto &[name, count] : by_count(locs)) {
+            os << llvm::format("    %10zu  ", count) << name << "\n";
+        }
+    }
+
+} // namespace vast
@@ -0,0 +1,212 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/IRChurn.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <mlir/Pass/Pass.h>
+VAST_UNRELAX_WARNINGS
+
+#include <map>
+#include <memory>
+
+namespace vast {
+
+    namespace {
+
+        struct registry
+        {
+            std::atomic< bool > enabled = false;
+
+            std::mutex mutex;
+            std::map< std::string, std::unique_ptr< churn_counters > > counters;
+
+            static registry &get() {
+                static registry instance;
+                return instance;
+            }
+        };
+
+        std::uint64_t changes(const churn_counters &counters) {
+            return counters.created + counters.erased + counters.modified;
+        }
+
+    } // namespace
+
+    namespace ir_churn {
+
+        bool enabled() { return registry::get().enabled; }
+
+        void enable(bool value) { registry::get().enabled = value; }
+
+        churn_counters &counters(string_ref pass) {
+            auto &reg = registry::get();
+            std::lock_guard< std::mutex > lock(reg.mutex);
+            auto &entry = reg.counters[pass.str()];
+            if (!entry) {
+                entry = std::make_unique< churn_counters >();
+            }
+            return *entry;
+        }
+
+        void print(llvm::raw_ostream &os) {
+            auto &reg = registry::get();
+            std::lock_guard< std::mutex > lock(reg.mutex);
+
+            using entry_t = std::pair< string_ref, const churn_counters * >;
+
+            llvm::SmallVector< entry_t > passes;
+            for (const auto &[pass, counters] : reg.counters) {
+                if (changes(*counters) != 0 || counters->net_ops != 0 || counters->net_blocks != 0) {
+                    passes.emplace_back(pass, counters.get());
+                }
+            }
+
+            llvm::sort(passes, [] (const auto &a, const auto &b) {
+                return changes(*a.second) > changes(*b.second);
+            });
+
+            os << "IR churn:\n";
+            os << llvm::formatv(
+                "  {0,10} {1,10} {2,10} {3,10} {4,10} {5,10} {6,10}  {7}\n",
+                "created", "erased", "replaced", "modified", "blocks", "net ops", "net blocks", "pass"
+            );
+
+            for (const auto &[pass, counters] : passes) {
+                os << llvm::formatv(
+                    "  {0,10} {1,10} {2,10} {3,10} {4,10} {5,10} {6,10}  {7}\n",
+                    counters->created.load(), counters->erased.load(), counters->replaced.load(),
+                    counters->modified.load(), counters->blocks.load(), counters->net_ops.load(),
+                    counters->net_blocks.load(), pass
+                );
+            }
+        }
+
+        // Listeners of other pass managers may still refer to the counters,
+        // hence they are zeroed rather than released.
+        void reset() {
+            auto &reg = registry::get();
+            std::lock_guard< std::mutex > lock(reg.mutex);
+            for (auto &[_, counters] : reg.counters) {
+                counters->created    = 0;
+                counters->erased     = 0;
+                counters->replaced   = 0;
+                counters->modified   = 0;
+                counters->blocks     = 0;
+                counters->net_ops    = 0;
+                counters->net_blocks = 0;
+            }
+        }
+
+    } // namespace ir_churn
+
+    void churn_listener::notifyOperationInserted(operation op) {
+        counters.created++;
+        if (next) {
+            next->notifyOperationInserted(op);
+        }
+    }
+
+    void churn_listener::notifyBlockCreated(mlir::Block *block) {
+        counters.blocks++;
+        if (next) {
+            next->notifyBlockCreated(block);
+        }
+    }
+
+    void churn_listener::notifyOperationModified(operation op) {
+        counters.modified++;
+        if (auto listener = next_rewrite_listener()) {
+            listener->notifyOperationModified(op);
+        }
+    }
+
+    void churn_listener::notifyOperationReplaced(operation op, operation replacement) {
+        counters.replaced++;
+        if (auto listener = next_rewrite_listener()) {
+            listener->notifyOperationReplaced(op, replacement);
+        }
+    }
+
+    void churn_listener::notifyOperationReplaced(operation op, mlir::ValueRange replacement) {
+        counters.replaced++;
+        if (auto listener = next_rewrite_listener()) {
+            listener->notifyOperationReplaced(op, replacement);
+        }
+    }
+
+    void churn_listener::notifyOperationRemoved(operation op) {
+        counters.erased++;
+        if (auto listener = next_rewrite_listener()) {
+            listener->notifyOperationRemoved(op);
+        }
+    }
+
+    logical_result churn_listener::notifyMatchFailure(
+        mlir::Location loc, llvm::function_ref< void(mlir::Diagnostic &) > reason
+    ) {
+        if (auto listener = next_rewrite_listener()) {
+            return listener->notifyMatchFailure(loc, reason);
+        }
+        return mlir::failure();
+    }
+
+    ir_churn_instrumentation::~ir_churn_instrumentation() {
+        ir_churn::print(llvm::errs());
+        ir_churn::reset();
+        ir_churn::enable(false);
+    }
+
+    auto ir_churn_instrumentation::measure(operation root) -> ir_size {
+        ir_size size;
+        root->walk([&] (operation op) {
+            size.ops++;
+            for (auto &region : op->getRegions()) {
+                size.blocks += static_cast< std::int64_t >(region.getBlocks().size());
+            }
+        });
+        return size;
+    }
+
+    // Adaptors of nested pass managers have no argument, their passes are
+    // measured on their own.
+    void ir_churn_instrumentation::runBeforePass(mlir::Pass *pass, operation op) {
+        if (pass->getArgument().empty()) {
+            return;
+        }
+
+        auto size = measure(op);
+        std::lock_guard< std::mutex > lock(mutex);
+        before[{ pass, op }] = size;
+    }
+
+    void ir_churn_instrumentation::runAfterPass(mlir::Pass *pass, operation op) {
+        if (pass->getArgument().empty()) {
+            return;
+        }
+
+        auto after = measure(op);
+
+        ir_size previous;
+        {
+            std::lock_guard< std::mutex > lock(mutex);
+            auto it = before.find({ pass, op });
+            if (it == before.end()) {
+                return;
+            }
+            previous = it->second;
+            before.erase(it);
+        }
+
+        auto &counters = ir_churn::counters(pass->getArgument());
+        counters.net_ops    += after.ops - previous.ops;
+        counters.net_blocks += after.blocks - previous.blocks;
+    }
+
+    void ir_churn_instrumentation::runAfterPassFailed(mlir::Pass *pass, operation op) {
+        std::lock_guard< std::mutex > lock(mutex);
+        before.erase({ pass, op });
+    }
+
+} // namespace vast
@@ -0,0 +1,85 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/LazyModule.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::util
+{
+    namespace
+    {
+        const llvm::MemoryBuffer &main_buffer(const llvm::SourceMgr &source_mgr) {
+            return *source_mgr.getMemoryBuffer(source_mgr.getMainFileID());
+        }
+
+        // Lazy operations are not materialized when they are read.
+        bool keep_lazy(operation) { return false; }
+
+    } // namespace
+
+    lazy_module::lazy_module(std::shared_ptr< llvm::SourceMgr > source_mgr, mcontext_t *ctx)
+        : source_mgr(source_mgr)
+        , config(ctx)
+        , reader(main_buffer(*source_mgr).getMemBufferRef(), config, /* lazyLoad */ true, source_mgr)
+    {}
+
+    std::unique_ptr< lazy_module > lazy_module::open(
+        std::shared_ptr< llvm::SourceMgr > source_mgr, mcontext_t *ctx
+    ) {
+        if (!mlir::isBytecode(main_buffer(*source_mgr).getMemBufferRef())) {
+            return nullptr;
+        }
+
+        std::unique_ptr< lazy_module > result(new lazy_module(source_mgr, ctx));
+        if (failed(result->reader.readTopLevel(&result->top, keep_lazy))) {
+            return nullptr;
+        }
+
+        auto &top = result->top;
+        auto mod  = top.empty() ? nullptr : mlir::dyn_cast< vast_module >(top.front());
+        if (!mod || &top.front() != &top.back()) {
+            mlir::emitError(mlir::UnknownLoc::get(ctx), "expected a single module in the bytecode");
+            return nullptr;
+        }
+
+        mod->remove();
+        result->mod = owning_module_ref(mod);
+        return result;
+    }
+
+    logical_result lazy_module::materialize(llvm::function_ref< bool(operation) > should_materialize) {
+        if (finalized) {
+            return mlir::success();
+        }
+
+        llvm::SmallVector< operation > pending;
+        do {
+            pending.clear();
+            mod->walk([&] (operation op) {
+                if (reader.isMaterializable(op) && should_materialize(op)) {
+                    pending.push_back(op);
+                }
+            });
+
+            for (auto op : pending) {
+                if (failed(reader.materialize(op, keep_lazy))) {
+                    return mlir::failure();
+                }
+            }
+        } while (!pending.empty());
+
+        return mlir::success();
+    }
+
+    logical_result lazy_module::materialize_all() {
+        if (finalized) {
+            return mlir::success();
+        }
+
+        finalized = true;
+        return reader.finalize([] (operation) { return true; });
+    }
+
+} // namespace vast::util
@@ -0,0 +1,70 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/MemoryLimit.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Pass/Pass.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/PipelineStats.hpp"
+
+namespace vast {
+
+    namespace {
+
+        std::string describe(operation op) {
+            auto name = op->getName().getStringRef().str();
+            if (auto sym = op->getAttrOfType< mlir::StringAttr >(mlir::SymbolTable::getSymbolAttrName())) {
+                name += " @" + sym.getValue().str();
+            }
+            return name;
+        }
+
+        std::string name_of(mlir::Pass *pass) {
+            auto name = pass->getArgument();
+            return (name.empty() ? pass->getName() : name).str();
+        }
+
+    } // namespace
+
+    void memory_limit::check(llvm::function_ref< std::string() > where) const {
+        auto rss = current_rss_kb();
+        if (rss <= limit_kb) {
+            return;
+        }
+
+        auto scope = where();
+        auto msg = llvm::formatv(
+            "memory limit of {0} MB exceeded ({1} MB resident) {2}",
+            limit_kb / 1024, rss / 1024, scope.empty() ? "in vast" : scope
+        ).str();
+
+        // Fatal errors are reported as crashes, so that the driver captures
+        // the input, and recovered by the pass manager to emit a reproducer.
+        llvm::report_fatal_error(llvm::Twine(msg), true /* gen_crash_diag */);
+    }
+
+    void memory_limit_instrumentation::runBeforePass(mlir::Pass *pass, operation op) {
+        check(pass, op, "before");
+    }
+
+    void memory_limit_instrumentation::runAfterPass(mlir::Pass *pass, operation op) {
+        check(pass, op, "after");
+    }
+
+    void memory_limit_instrumentation::check(
+        mlir::Pass *pass, operation op, string_ref when
+    ) const {
+        limit.check([&] {
+            auto where = llvm::formatv("{0} pass '{1}'", when, name_of(pass)).str();
+            if (auto step = ppl.step_of(pass->getTypeID()); !step.empty()) {
+                where += llvm::formatv(" of step '{0}'", step).str();
+            }
+            return where + " on '" + describe(op) + "'";
+        });
+    }
+
+} // namespace vast
@@ -0,0 +1,367 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/ModuleParser.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeReader.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Diagnostics.h>
+#include <mlir/IR/Threading.h>
+#include <mlir/IR/Verifier.h>
+#include <mlir/Parser/Parser.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/MemoryBuffer.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Compression.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace vast::util
+{
+    namespace
+    {
+        //
+        // Layout of a module as printed by MLIR: definitions of aliases, the
+        // module holding top-level operations, each ending with a line break,
+        // and definitions of location aliases.
+        //
+        struct module_layout
+        {
+            string_ref prefix;
+            string_ref header;
+            std::vector< string_ref > ops;
+            // Rest of the line of the closing brace, e.g., the location.
+            string_ref trailer;
+            string_ref suffix;
+        };
+
+        // Tracks the nesting of brackets, skipping string literals and
+        // comments.
+        struct scanner
+        {
+            string_ref text;
+            std::size_t pos = 0;
+            int depth = 0;
+
+            bool done() const { return pos >= text.size(); }
+
+            char next() {
+                char c = text[pos++];
+                if (c == '"') {
+                    while (!done() && text[pos] != '"') {
+                        pos += text[pos] == '\\' ? 2 : 1;
+                    }
+                    pos = std::min(pos + 1, text.size());
+                } else if (c == '/' && !done() && text[pos] == '/') {
+                    while (!done() && text[pos] != '\n') {
+                        ++pos;
+                    }
+                } else if (c == '{' || c == '(' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ')' || c == ']') {
+                    --depth;
+                }
+                return c;
+            }
+
+            bool rest_of_line_is_blank() const {
+                auto line = text.substr(pos).take_until([] (char c) { return c == '\n'; }).trim();
+                return line.empty() || line.starts_with("//");
+            }
+        };
+
+        bool is_module_line(string_ref line) {
+            return line.consume_front("module") && (line.empty() || line.front() == ' ' || line.front() == '{');
+        }
+
+        std::optional< module_layout > scan_layout(string_ref text) {
+            module_layout layout;
+
+            // Aliases and comments before the module.
+            std::size_t module_start = string_ref::npos;
+            for (std::size_t line_start = 0; line_start < text.size();) {
+                auto line = text.substr(line_start).take_until([] (char c) { return c == '\n'; });
+                auto trimmed = line.ltrim();
+                if (is_module_line(trimmed)) {
+                    module_start = line_start;
+                    break;
+                }
+
+                if (!trimmed.empty() && !trimmed.starts_with("//")
+                    && !trimmed.starts_with("#") && !trimmed.starts_with("!")
+                ) {
+                    return std::nullopt;
+                }
+
+                line_start += line.size() + 1;
+            }
+
+            if (module_start == string_ref::npos) {
+                return std::nullopt;
+            }
+
+            layout.prefix = text.take_front(module_start);
+
+            // The body starts after the brace that ends its line.
+            scanner s{ text, module_start };
+            while (true) {
+                if (s.done()) {
+                    return std::nullopt;
+                }
+
+                if (s.next() == '{' && s.depth == 1 && s.rest_of_line_is_blank()) {
+                    break;
+                }
+            }
+
+            layout.header = text.slice(module_start, s.pos);
+            s.pos = text.find('\n', s.pos);
+            if (s.pos == string_ref::npos) {
+                return std::nullopt;
+            }
+            ++s.pos;
+
+            std::size_t line_start = s.pos;
+            std::size_t op_start   = string_ref::npos;
+            while (!s.done()) {
+                auto at = s.pos;
+                char c  = s.next();
+
+                if (s.depth == 0) {
+                    if (op_start != string_ref::npos) {
+                        return std::nullopt;
+                    }
+                    auto rest = text.substr(s.pos);
+                    layout.trailer = rest.take_until([] (char c) { return c == '\n'; });
+                    layout.suffix  = rest.drop_front(layout.trailer.size());
+                    return layout;
+                }
+
+                if (c == '\n') {
+                    if (s.depth == 1 && op_start != string_ref::npos) {
+                        layout.ops.push_back(text.slice(op_start, s.pos));
+                        op_start = string_ref::npos;
+                    }
+                    line_start = s.pos;
+                    continue;
+                }
+
+                bool is_comment = c == '/' && text.substr(at).starts_with("//");
+                if (op_start == string_ref::npos && !std::isspace(static_cast< unsigned char >(c)) && !is_comment) {
+                    op_start = line_start;
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        bool is_alias_char(char c) {
+            return std::isalnum(static_cast< unsigned char >(c)) || c == '_' || c == '$' || c == '.';
+        }
+
+        //
+        // Location aliases printed after the module, each chunk is parsed
+        // only with the ones it refers to.
+        //
+        struct location_aliases
+        {
+            static std::optional< location_aliases > scan(string_ref suffix) {
+                location_aliases aliases;
+
+                llvm::SmallVector< string_ref > lines;
+                suffix.split(lines, '\n');
+                for (auto line : lines) {
+                    auto trimmed = line.trim();
+                    if (trimmed.empty() || trimmed.starts_with("//")) {
+                        continue;
+                    }
+
+                    auto [name, definition] = trimmed.split('=');
+                    name = name.trim();
+                    if (!name.starts_with("#") || definition.empty()) {
+                        return std::nullopt;
+                    }
+
+                    aliases.indices[name] = aliases.lines.size();
+                    aliases.lines.push_back(trimmed);
+                }
+
+                return aliases;
+            }
+
+            // Definitions of aliases used by the text, transitively.
+            std::string used_by(string_ref text) const {
+                std::vector< bool > used(lines.size(), false);
+                llvm::SmallVector< std::size_t > worklist;
+
+                auto collect = [&] (string_ref str) {
+                    for (auto pos = str.find('#'); pos != string_ref::npos; pos = str.find('#', pos + 1)) {
+                        auto len = str.substr(pos + 1).take_while(is_alias_char).size();
+                        auto it  = indices.find(str.substr(pos, len + 1));
+                        if (it != indices.end() && !used[it->second]) {
+                            used[it->second] = true;
+                            worklist.push_back(it->second);
+                        }
+                    }
+                };
+
+                collect(text);
+                while (!worklist.empty()) {
+                    collect(lines[worklist.pop_back_val()].split('=').second);
+                }
+
+                std::string result;
+                for (std::size_t i = 0; i < lines.size(); ++i) {
+                    if (used[i]) {
+                        result.append(lines[i].begin(), lines[i].end());
+                        result.push_back('\n');
+                    }
+                }
+                return result;
+            }
+
+            std::vector< string_ref > lines;
+            llvm::StringMap< std::size_t > indices;
+        };
+
+        struct chunk_t
+        {
+            string_ref text;
+            std::string source;
+            std::unique_ptr< mlir::Block > block = std::make_unique< mlir::Block >();
+        };
+
+        owning_module_ref parse_sequential(llvm::SourceMgr &source_mgr, mcontext_t *ctx) {
+            // Disable multi-threading when parsing the input file. This removes the
+            // unnecessary/costly context synchronization when parsing.
+            bool was_threading_enabled = ctx->isMultithreadingEnabled();
+            ctx->disableMultithreading();
+            auto mod = mlir::parseSourceFile< vast_module >(source_mgr, ctx);
+            ctx->enableMultithreading(was_threading_enabled);
+            return mod;
+        }
+
+        owning_module_ref parse_parallel(string_ref text, string_ref name, mcontext_t *ctx) {
+            auto layout = scan_layout(text);
+            if (!layout || layout->ops.size() < 2) {
+                return nullptr;
+            }
+
+            auto aliases = location_aliases::scan(layout->suffix);
+            if (!aliases) {
+                return nullptr;
+            }
+
+            // Chunks of about the same size, one per thread.
+            auto threads = std::min< std::size_t >(ctx->getNumThreads(), layout->ops.size());
+            auto body    = layout->ops.back().end() - layout->ops.front().begin();
+            auto target  = body / threads + 1;
+
+            std::vector< chunk_t > chunks;
+            const char *begin = layout->ops.front().begin();
+            for (auto op : layout->ops) {
+                if (op.end() - begin >= std::ptrdiff_t(target) || op.end() == layout->ops.back().end()) {
+                    chunks.push_back({ string_ref(begin, op.end() - begin) });
+                    begin = op.end();
+                }
+            }
+
+            // The aliases of the prefix keep their lines, the chunk is moved
+            // to its line by padding.
+            auto lines_before = [prev = text.begin(), line = std::size_t(0)] (const char *pos) mutable {
+                line += std::count(prev, pos, '\n');
+                prev = pos;
+                return line;
+            };
+
+            auto module_line = lines_before(layout->header.begin());
+            for (auto &chunk : chunks) {
+                auto padding = lines_before(chunk.text.begin()) - module_line;
+                chunk.source.reserve(layout->prefix.size() + padding + chunk.text.size());
+                chunk.source.append(layout->prefix.begin(), layout->prefix.end());
+                chunk.source.append(padding, '\n');
+                chunk.source.append(chunk.text.begin(), chunk.text.end());
+                chunk.source.append(aliases->used_by(chunk.text));
+            }
+
+            mlir::ParserConfig config(ctx, /* verifyAfterParse */ false);
+
+            // Chunks that do not parse on their own are parsed again with the
+            // whole module, hence their diagnostics are dropped.
+            mlir::ScopedDiagnosticHandler drop(ctx, [] (mlir::Diagnostic &) { return mlir::success(); });
+
+            std::string header = (layout->prefix + layout->header + "\n}" + layout->trailer + "\n").str();
+            header += aliases->used_by((layout->header + layout->trailer).str());
+
+            mlir::Block header_block;
+            if (failed(mlir::parseSourceString(header, &header_block, config, name))) {
+                return nullptr;
+            }
+
+            auto mod = mlir::dyn_cast< vast_module >(header_block.front());
+            if (!mod || &header_block.front() != &header_block.back()) {
+                return nullptr;
+            }
+
+            auto parsed = mlir::failableParallelForEach(ctx, chunks, [&] (chunk_t &chunk) {
+                return mlir::parseSourceString(chunk.source, chunk.block.get(), config, name);
+            });
+
+            if (failed(parsed)) {
+                return nullptr;
+            }
+
+            mod->remove();
+            owning_module_ref result(mod);
+            for (auto &chunk : chunks) {
+                auto &ops = result->getBody()->getOperations();
+                ops.splice(ops.end(), chunk.block->getOperations());
+            }
+
+            return result;
+        }
+
+    } // namespace
+
+    owning_module_ref parse_module(llvm::SourceMgr &source_mgr, mcontext_t *ctx) {
+        const auto *buffer = source_mgr.getMemoryBuffer(source_mgr.getMainFileID());
+        auto text = buffer->getBuffer();
+
+        if (is_zstd_frame(text)) {
+            auto bytecode = zstd_decompress(text, default_zstd_dictionary().get());
+            if (!bytecode) {
+                mlir::emitError(mlir::UnknownLoc::get(ctx))
+                    << "cannot decompress '" << buffer->getBufferIdentifier() << "'";
+                return nullptr;
+            }
+
+            llvm::SourceMgr decompressed;
+            decompressed.AddNewSourceBuffer(
+                llvm::MemoryBuffer::getMemBufferCopy(*bytecode, buffer->getBufferIdentifier()),
+                llvm::SMLoc()
+            );
+            return parse_sequential(decompressed, ctx);
+        }
+
+        if (!ctx->isMultithreadingEnabled() || ctx->getNumThreads() < 2
+            || text.size() < parallel_parse_threshold
+            || mlir::isBytecode(buffer->getMemBufferRef())
+        ) {
+            return parse_sequential(source_mgr, ctx);
+        }
+
+        auto mod = parse_parallel(text, buffer->getBufferIdentifier(), ctx);
+        if (!mod) {
+            return parse_sequential(source_mgr, ctx);
+        }
+
+        if (failed(mlir::verify(mod.get()))) {
+            return nullptr;
+        }
+
+        return mod;
+    }
+
+} // namespace vast::util
@@ -0,0 +1,81 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/ModulePrinter.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/MLIRContext.h>
+#include <llvm/Support/ThreadPool.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+#include <vector>
+
+namespace vast::util
+{
+    void print_module(vast_module mod, llvm::raw_ostream &os, mlir::OpPrintingFlags flags) {
+        // The module is printed without its operations, which are spliced
+        // into its body.
+        std::string frame;
+        {
+            mlir::OwningOpRef< vast_module > shell(
+                mlir::cast< vast_module >(mod->cloneWithoutRegions())
+            );
+            shell->getBodyRegion().emplaceBlock();
+
+            llvm::raw_string_ostream frame_os(frame);
+            shell->print(frame_os, flags);
+        }
+
+        // Dictionaries of attributes are printed on a single line, hence this
+        // is the empty body.
+        auto body = string_ref(frame).find("{\n}");
+        VAST_CHECK(body != string_ref::npos, "unexpected textual form of module");
+
+        auto local = flags;
+        local.useLocalScope();
+
+        auto print = [local] (operation op) {
+            std::string text;
+            llvm::raw_string_ostream text_os(text);
+            op->print(text_os, local);
+            text_os << '\n';
+            return text;
+        };
+
+        os << string_ref(frame).take_front(body + 2);
+
+        auto ctx = mod.getContext();
+        if (!ctx->isMultithreadingEnabled()) {
+            for (auto &op : mod.getOps()) {
+                os << print(&op);
+            }
+        } else {
+            // Operations are printed in batches by task groups, which can be
+            // waited for on threads of the pool, e.g., in batch compilations
+            // sharing it.
+            auto &pool  = ctx->getThreadPool();
+            auto window = std::size_t(4) * pool.getThreadCount();
+
+            auto ops = llvm::to_vector(llvm::make_pointer_range(mod.getOps()));
+            std::vector< std::string > texts;
+            for (std::size_t begin = 0; begin < ops.size(); begin += window) {
+                auto end = std::min(ops.size(), begin + window);
+                texts.assign(end - begin, {});
+
+                llvm::ThreadPoolTaskGroup group(pool);
+                for (auto idx = begin; idx < end; ++idx) {
+                    group.async([&, idx] { texts[idx - begin] = print(ops[idx]); });
+                }
+                group.wait();
+
+                for (const auto &text : texts) {
+                    os << text;
+                }
+            }
+        }
+
+        os << string_ref(frame).drop_front(body + 2);
+    }
+
+} // namespace vast::util
@@ -0,0 +1,245 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/PatternStats.hpp"
+#include "vast/Util/IRChurn.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/FormatVariadic.h>
+VAST_UNRELAX_WARNINGS
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace vast {
+
+    namespace {
+
+        struct registry
+        {
+            std::atomic< bool > enabled = false;
+
+            std::mutex mutex;
+            // counters by pass and pattern
+            std::map< std::pair< std::string, std::string >, std::unique_ptr< pattern_counters > > counters;
+
+            static registry &get() {
+                static registry instance;
+                return instance;
+            }
+        };
+
+        //
+        // Forwards to the wrapped pattern and measures it. The wrapper has the
+        // same root, benefit and generated operations, so that the pattern is
+        // selected and ordered as before. Either of the statistics and the
+        // churn of the pattern may be measured.
+        //
+        struct counted_pattern : mlir::RewritePattern
+        {
+            template< typename... args_t >
+            counted_pattern(
+                std::unique_ptr< mlir::RewritePattern > wrapped, pattern_counters *counters,
+                churn_counters *churn, args_t &&...args
+            )
+                : mlir::RewritePattern(std::forward< args_t >(args)...)
+                , wrapped(std::move(wrapped))
+                , counters(counters)
+                , churn(churn)
+            {
+                setDebugName(this->wrapped->getDebugName());
+                addDebugLabels(this->wrapped->getDebugLabels());
+                setHasBoundedRewriteRecursion(this->wrapped->hasBoundedRewriteRecursion());
+            }
+
+            logical_result matchAndRewrite(operation op, mlir::PatternRewriter &rewriter) const override {
+                if (!counters) {
+                    return observe(op, rewriter);
+                }
+
+                auto start  = std::chrono::steady_clock::now();
+                auto result = observe(op, rewriter);
+                auto end    = std::chrono::steady_clock::now();
+
+                counters->attempts++;
+                if (mlir::succeeded(result)) {
+                    counters->successes++;
+                } else {
+                    counters->failures++;
+                }
+
+                auto elapsed = std::chrono::duration_cast< std::chrono::nanoseconds >(end - start);
+                counters->nanoseconds += static_cast< std::uint64_t >(elapsed.count());
+                return result;
+            }
+
+            // The listener of the driver is restored once the pattern
+            // finishes, it receives all the notifications in the meantime.
+            logical_result observe(operation op, mlir::PatternRewriter &rewriter) const {
+                if (!churn) {
+                    return wrapped->matchAndRewrite(op, rewriter);
+                }
+
+                auto driver = rewriter.getListener();
+                churn_listener listener(*churn, driver);
+                rewriter.setListener(&listener);
+                auto result = wrapped->matchAndRewrite(op, rewriter);
+                rewriter.setListener(driver);
+                return result;
+            }
+
+            static std::unique_ptr< mlir::RewritePattern > wrap(
+                std::unique_ptr< mlir::RewritePattern > pattern, pattern_counters *counters,
+                churn_counters *churn
+            ) {
+                auto benefit = pattern->getBenefit();
+                auto mctx    = pattern->getContext();
+
+                llvm::SmallVector< string_ref > generated;
+                for (auto name : pattern->getGeneratedOps()) {
+                    generated.push_back(name.getStringRef());
+                }
+
+                if (auto root = pattern->getRootKind()) {
+                    return std::make_unique< counted_pattern >(
+                        std::move(pattern), counters, churn, root->getStringRef(), benefit, mctx, generated
+                    );
+                }
+
+                if (auto id = pattern->getRootInterfaceID()) {
+                    return std::make_unique< counted_pattern >(
+                        std::move(pattern), counters, churn, MatchInterfaceOpTypeTag(), *id,
+                        benefit, mctx, generated
+                    );
+                }
+
+                if (auto id = pattern->getRootTraitID()) {
+                    return std::make_unique< counted_pattern >(
+                        std::move(pattern), counters, churn, MatchTraitOpTypeTag(), *id,
+                        benefit, mctx, generated
+                    );
+                }
+
+                return std::make_unique< counted_pattern >(
+                    std::move(pattern), counters, churn, MatchAnyOpTypeTag(), benefit, mctx,
+                    generated
+                );
+            }
+
+            std::unique_ptr< mlir::RewritePattern > wrapped;
+            pattern_counters *counters;
+            churn_counters *churn;
+        };
+
+        // Drops the namespaces of the class name, but keeps the template
+        // arguments intact, e.g., `vast::conv::subscript` becomes `subscript`.
+        string_ref short_name(string_ref name) {
+            auto qualified = name.take_until([] (char c) { return c == '<'; });
+            auto pos = qualified.rfind("::");
+            return pos == string_ref::npos ? name : name.drop_front(pos + 2);
+        }
+
+    } // namespace
+
+    namespace pattern_stats {
+
+        bool enabled() { return registry::get().enabled; }
+
+        void enable(bool value) { registry::get().enabled = value; }
+
+        pattern_counters &counters(string_ref pass, string_ref pattern) {
+            auto &reg = registry::get();
+            std::lock_guard< std::mutex > lock(reg.mutex);
+            auto &entry = reg.counters[{ pass.str(), pattern.str() }];
+            if (!entry) {
+                entry = std::make_unique< pattern_counters >();
+            }
+            return *entry;
+        }
+
+        void print(llvm::raw_ostream &os) {
+            auto &reg = registry::get();
+            std::lock_guard< std::mutex > lock(reg.mutex);
+
+            using entry_t = std::pair< string_ref, const pattern_counters * >;
+
+            auto print_pass = [&] (string_ref pass, llvm::SmallVectorImpl< entry_t > &patterns) {
+                llvm::sort(patterns, [] (const auto &a, const auto &b) {
+                    return a.second->nanoseconds > b.second->nanoseconds;
+                });
+
+                os << "pattern statistics of " << pass << ":\n";
+                os << llvm::formatv(
+                    "  {0,10} {1,10} {2,10} {3,12}  {4}\n",
+                    "attempts", "succeeded", "failed", "time (ms)", "pattern"
+                );
+
+                for (const auto &[name, counters] : patterns) {
+                    os << llvm::formatv(
+                        "  {0,10} {1,10} {2,10} {3,12:F3}  {4}\n",
+                        counters->attempts.load(), counters->successes.load(),
+                        counters->failures.load(), double(counters->nanoseconds) / 1e6, name
+                    );
+                }
+            };
+
+            string_ref current;
+            llvm::SmallVector< entry_t > patterns;
+            for (const auto &[key, counters] : reg.counters) {
+                const auto &[pass, pattern] = key;
+                if (pass != current && !patterns.empty()) {
+                    print_pass(current, patterns);
+                    patterns.clear();
+                }
+                current = pass;
+
+                // patterns that were never tried are not interesting
+                if (counters->attempts != 0) {
+                    patterns.emplace_back(pattern, counters.get());
+                }
+            }
+
+            if (!patterns.empty()) {
+                print_pass(current, patterns);
+            }
+        }
+
+        // Wrapped patterns of other pass managers may still refer to the
+        // counters, hence they are zeroed rather than released.
+        void reset() {
+            auto &reg = registry::get();
+            std::lock_guard< std::mutex > lock(reg.mutex);
+            for (auto &[_, counters] : reg.counters) {
+                counters->attempts    = 0;
+                counters->successes   = 0;
+                counters->failures    = 0;
+                counters->nanoseconds = 0;
+            }
+        }
+
+    } // namespace pattern_stats
+
+    void count_pattern_applications(mlir::RewritePatternSet &patterns, string_ref pass) {
+        bool stats = pattern_stats::enabled();
+        bool churn = ir_churn::enabled();
+        if (!stats && !churn) {
+            return;
+        }
+
+        auto churn_of_pass = churn ? &ir_churn::counters(pass) : nullptr;
+        for (auto &pattern : patterns.getNativePatterns()) {
+            auto name = short_name(pattern->getDebugName()).str();
+            auto counters = stats ? &pattern_stats::counters(pass, name) : nullptr;
+            pattern = counted_pattern::wrap(std::move(pattern), counters, churn_of_pass);
+        }
+    }
+
+    pattern_stats_instrumentation::~pattern_stats_instrumentation() {
+        pattern_stats::print(llvm::errs());
+        pattern_stats::reset();
+        pattern_stats::enable(false);
+    }
+
+} // namespace vast
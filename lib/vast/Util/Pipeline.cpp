@@ -2,29 +2,164 @@
 // Copyright (c) 2023, Trail of Bits, Inc.
 
 #include "vast/Util/Pipeline.hpp"
+#include "vast/Util/IRCensus.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Verifier.h>
+VAST_UNRELAX_WARNINGS
 
 namespace vast {
 
+    namespace {
+
+        // Verifies the anchor of the pass manager. Nested isolated operations,
+        // e.g., functions, are verified in parallel.
+        struct checkpoint_pass
+            : mlir::PassWrapper< checkpoint_pass, mlir::OperationPass<> >
+        {
+            MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(checkpoint_pass)
+
+            string_ref getArgument() const final { return "vast-checkpoint"; }
+
+            string_ref getDescription() const final {
+                return "Verifies the operation at a checkpoint of the pipeline";
+            }
+
+            void runOnOperation() final {
+                if (mlir::failed(mlir::verify(getOperation()))) {
+                    signalPassFailure();
+                }
+            }
+        };
+
+        // Prints the census of the anchor of the pass manager after the
+        // pipeline step.
+        struct census_pass
+            : mlir::PassWrapper< census_pass, mlir::OperationPass<> >
+        {
+            MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(census_pass)
+
+            explicit census_pass(string_ref step) : step(step.str()) {}
+
+            string_ref getArgument() const final { return "vast-ir-census"; }
+
+            string_ref getDescription() const final {
+                return "Prints operations, types and attributes after a pipeline step";
+            }
+
+            void runOnOperation() final {
+                // print at once, so that the census is not interleaved with
+                // other output
+                std::string out;
+                llvm::raw_string_ostream os(out);
+                ir_census::of(getOperation()).print(os, step);
+                llvm::errs() << os.str();
+                markAllAnalysesPreserved();
+            }
+
+            std::string step;
+        };
+
+    } // namespace
+
+    bool pipeline_t::mark_seen(string_ref anchor, mlir::Pass &pass) {
+        std::string key;
+        llvm::raw_string_ostream os(key);
+        os << anchor << "::";
+        pass.printAsTextualPipeline(os);
+
+        if (!seen.insert(os.str()).second) {
+            return false;
+        }
+
+        step_of_pass.try_emplace(pass.getTypeID(), scheduled_step);
+        return true;
+    }
+
     void pipeline_t::addPass(std::unique_ptr<mlir::Pass> pass) {
-        auto id = pass->getTypeID();
-        if (seen.count(id)) {
+        if (!mark_seen("", *pass)) {
             return;
         }
 
-        seen.insert(id);
         base::addPass(std::move(pass));
     }
 
+    void pipeline_t::schedule(const pipeline_step_builder &builder) {
+        pipeline_step_ptr owned;
+        auto step = pipeline_planner::instance().resolve(builder, owned);
+
+        if (scheduled.contains(step)) {
+            return;
+        }
+
+        VAST_CHECK(!scheduling.contains(step),
+            "cyclic dependency in pipeline step: {0}", step->name()
+        );
+
+        scheduling.insert(step);
+        step->schedule_on(*this);
+        scheduling.erase(step);
+
+        // unmemoized steps do not outlive this call, so their address
+        // cannot identify them
+        if (!owned) {
+            scheduled.insert(step);
+        }
+    }
+
+    void pipeline_t::add_checkpoint() {
+        // Checkpoints are not deduplicated, every one of them verifies the IR
+        // at its own point.
+        base::addPass(std::make_unique< checkpoint_pass >());
+    }
+
+    void pipeline_t::add_census(string_ref step) {
+        // Likewise, every census reports the IR after its own step.
+        base::addPass(std::make_unique< census_pass >(step));
+    }
+
+    string_ref pipeline_t::step_of(pass_id_t id) const {
+        if (auto it = step_of_pass.find(id); it != step_of_pass.end()) {
+            return it->second;
+        }
+        return {};
+    }
+
     pipeline_t &operator<<(pipeline_t &ppl, pipeline_step_ptr pass) {
+        ppl.scheduled_step = pass->name().str();
         pass->schedule_on(ppl);
+        ppl.scheduled_step.clear();
         return ppl;
     }
 
     void pipeline_step::schedule_on(pipeline_t &) const {}
 
+    pipeline_planner &pipeline_planner::instance() {
+        static pipeline_planner planner;
+        return planner;
+    }
+
+    const pipeline_step *pipeline_planner::resolve(
+        const pipeline_step_builder &builder, pipeline_step_ptr &owned
+    ) {
+        auto fn = builder.target< step_builder_fn >();
+        if (!fn) {
+            owned = builder();
+            return owned.get();
+        }
+
+        std::lock_guard< std::mutex > lock(mutex);
+        auto &step = steps[*fn];
+        if (!step) {
+            step = builder();
+        }
+
+        return step.get();
+    }
+
     void pipeline_step::schedule_dependencies(pipeline_t &ppl) const {
         for (const auto &dep : dependencies) {
-            dep()->schedule_on(ppl);
+            ppl.schedule(dep);
         }
     }
 
@@ -34,13 +169,13 @@ namespace vast {
     }
 
     string_ref pass_pipeline_step::name() const {
-        return pass_builder()->getName();
+        return pass_name;
     }
 
     void compound_pipeline_step::schedule_on(pipeline_t &ppl) const {
         schedule_dependencies(ppl);
         for (const auto &step : steps) {
-            step()->schedule_on(ppl);
+            ppl.schedule(step);
         }
     }
 
@@ -0,0 +1,222 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/PipelineStats.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/Pass/Pass.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+    #include <fstream>
+#endif
+
+namespace vast {
+
+    std::int64_t current_peak_rss_kb() {
+    #if defined(__unix__) || defined(__APPLE__)
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        #if defined(__APPLE__)
+            // macOS reports the peak resident set size in bytes
+            return usage.ru_maxrss / 1024;
+        #else
+            return usage.ru_maxrss;
+        #endif
+        }
+    #endif
+        return 0;
+    }
+
+    std::int64_t current_rss_kb() {
+    #if defined(__linux__)
+        // resident pages are the second field of statm
+        std::ifstream statm("/proc/self/statm");
+        std::int64_t size = 0, resident = 0;
+        if (statm >> size >> resident) {
+            return resident * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+    #endif
+        return current_peak_rss_kb();
+    }
+
+    double current_thread_cpu_seconds(const llvm::TimeRecord &fallback) {
+    #if defined(CLOCK_THREAD_CPUTIME_ID)
+        struct timespec ts;
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+            return double(ts.tv_sec) + double(ts.tv_nsec) / 1e9;
+        }
+    #endif
+        // without a per-thread clock, the cpu time of the whole process is used
+        return fallback.getProcessTime();
+    }
+
+    ir_counts ir_counts::of(operation root) {
+        ir_counts counts;
+        llvm::DenseSet< mlir_type > types;
+        llvm::DenseSet< mlir_attr > attrs;
+
+        root->walk([&] (operation op) {
+            ++counts.ops;
+
+            for (auto type : op->getResultTypes()) {
+                types.insert(type);
+            }
+
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    for (auto arg : block.getArguments()) {
+                        types.insert(arg.getType());
+                    }
+                }
+            }
+
+            for (const auto &attr : op->getAttrs()) {
+                attrs.insert(attr.getValue());
+            }
+        });
+
+        counts.types = static_cast< std::int64_t >(types.size());
+        counts.attrs = static_cast< std::int64_t >(attrs.size());
+        return counts;
+    }
+
+    llvm::json::Object pass_stats::to_json() const {
+        return llvm::json::Object{
+            { "name", name },
+            { "runs", runs },
+            { "wall_seconds", wall_seconds },
+            { "cpu_seconds", cpu_seconds },
+            { "ops_delta", delta.ops },
+            { "types_delta", delta.types },
+            { "attrs_delta", delta.attrs },
+            { "peak_rss_kb", peak_rss_kb },
+            { "peak_rss_delta_kb", peak_rss_delta_kb }
+        };
+    }
+
+    void pipeline_stats_instrumentation::runBeforePass(mlir::Pass *pass, operation op) {
+        auto counts = ir_counts::of(op);
+        auto rss    = current_peak_rss_kb();
+        auto time   = llvm::TimeRecord::getCurrentTime(true /* start */);
+        auto cpu    = current_thread_cpu_seconds(time);
+
+        std::lock_guard< std::mutex > lock(mutex);
+        running[{ pass, op }] = snapshot{ time, cpu, counts, rss };
+    }
+
+    void pipeline_stats_instrumentation::runAfterPass(mlir::Pass *pass, operation op) {
+        record(pass, op);
+    }
+
+    void pipeline_stats_instrumentation::runAfterPassFailed(mlir::Pass *pass, operation op) {
+        record(pass, op);
+    }
+
+    void pipeline_stats_instrumentation::record(mlir::Pass *pass, operation op) {
+        auto time   = llvm::TimeRecord::getCurrentTime(false /* start */);
+        auto cpu    = current_thread_cpu_seconds(time);
+        auto rss    = current_peak_rss_kb();
+        auto counts = ir_counts::of(op);
+
+        std::lock_guard< std::mutex > lock(mutex);
+        auto it = running.find({ pass, op });
+        if (it == running.end()) {
+            return;
+        }
+
+        auto before = it->second;
+        running.erase(it);
+
+        auto id = pass->getTypeID();
+        auto [idx, inserted] = pass_index.try_emplace(id, passes.size());
+        if (inserted) {
+            auto name = pass->getArgument();
+            passes.push_back(pass_stats{
+                .name = (name.empty() ? pass->getName() : name).str(),
+                .step = ppl.step_of(id).str()
+            });
+        }
+
+        auto &stats = passes[idx->second];
+        stats.runs++;
+
+        time -= before.time;
+        stats.wall_seconds += time.getWallTime();
+        // A pass runs on a single thread, so the thread cpu time excludes
+        // passes that run concurrently on other functions.
+        stats.cpu_seconds  += cpu - before.cpu_seconds;
+
+        stats.delta.ops   += counts.ops - before.counts.ops;
+        stats.delta.types += counts.types - before.counts.types;
+        stats.delta.attrs += counts.attrs - before.counts.attrs;
+
+        stats.peak_rss_kb        = std::max(stats.peak_rss_kb, rss);
+        stats.peak_rss_delta_kb += rss - before.peak_rss_kb;
+    }
+
+    llvm::json::Value pipeline_stats_instrumentation::report() const {
+        struct step_stats
+        {
+            pass_stats total;
+            llvm::json::Array passes;
+        };
+
+        // steps in order of their first pass execution
+        llvm::MapVector< std::string, step_stats > steps;
+
+        for (const auto &pass : passes) {
+            auto step_name = pass.step.empty() ? pass.name : pass.step;
+            auto &step = steps[step_name];
+
+            step.total.name = step_name;
+            step.total.runs += pass.runs;
+            step.total.wall_seconds += pass.wall_seconds;
+            step.total.cpu_seconds  += pass.cpu_seconds;
+            step.total.delta.ops    += pass.delta.ops;
+            step.total.delta.types  += pass.delta.types;
+            step.total.delta.attrs  += pass.delta.attrs;
+            step.total.peak_rss_kb = std::max(step.total.peak_rss_kb, pass.peak_rss_kb);
+            step.total.peak_rss_delta_kb += pass.peak_rss_delta_kb;
+
+            step.passes.push_back(pass.to_json());
+        }
+
+        llvm::json::Array result;
+        for (auto &[_, step] : steps) {
+            auto entry = step.total.to_json();
+            entry["passes"] = std::move(step.passes);
+            result.push_back(std::move(entry));
+        }
+
+        return llvm::json::Object{
+            { "steps", std::move(result) },
+            { "peak_rss_kb", current_peak_rss_kb() }
+        };
+    }
+
+    pipeline_stats_instrumentation::~pipeline_stats_instrumentation() {
+        std::error_code ec;
+        llvm::raw_fd_ostream out(path, ec, llvm::sys::fs::OF_Text);
+        if (ec) {
+            llvm::errs() << "vast: unable to write pipeline statistics to '"
+                         << path << "': " << ec.message() << "\n";
+            return;
+        }
+
+        out << llvm::formatv("{0:2}", report()) << "\n";
+    }
+
+} // namespace vast
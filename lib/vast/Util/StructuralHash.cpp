@@ -0,0 +1,194 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/StructuralHash.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Block.h>
+#include <mlir/IR/SymbolTable.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::util
+{
+    namespace
+    {
+        std::uint64_t printed_hash(const auto &entity) {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            entity.print(os);
+            return llvm::xxh3_64bits(llvm::arrayRefFromStringRef(os.str()));
+        }
+
+        hash128 finish(llvm::ArrayRef< std::uint8_t > bytes) {
+            return { llvm::xxh3_64bits(bytes), llvm::xxHash64(bytes) };
+        }
+
+    } // namespace
+
+    std::string hash128::str() const {
+        std::string text;
+        llvm::raw_string_ostream os(text);
+        os << llvm::format_hex_no_prefix(high, 16) << llvm::format_hex_no_prefix(low, 16);
+        return os.str();
+    }
+
+    //
+    // Serializes a single operation or region into bytes, nested regions
+    // contribute their cached hashes and their captured values.
+    //
+    struct structural_hasher::encoder
+    {
+        explicit encoder(structural_hasher &self) : self(self) {}
+
+        void add(std::uint64_t value) {
+            for (unsigned i = 0; i < sizeof(value); ++i) {
+                bytes.push_back(std::uint8_t(value));
+                value >>= 8;
+            }
+        }
+
+        void add(string_ref data) {
+            add(std::uint64_t(data.size()));
+            bytes.append(data.begin(), data.end());
+        }
+
+        void define(mlir_value value) {
+            locals.try_emplace(value, locals.size());
+            add(self.type_hash(value.getType()));
+        }
+
+        void use(mlir_value value) {
+            if (auto it = locals.find(value); it != locals.end()) {
+                add(std::uint64_t(0));
+                add(it->second);
+                return;
+            }
+
+            auto [it, inserted] = capture_ids.try_emplace(value, captures.size());
+            if (inserted) {
+                captures.push_back(value);
+            }
+            add(std::uint64_t(1));
+            add(it->second);
+        }
+
+        void add(operation op, bool ignore_symbol_name, const llvm::DenseMap< mlir::Block *, std::uint64_t > *blocks) {
+            add(op->getName().getStringRef());
+
+            add(std::uint64_t(op->getNumOperands()));
+            for (auto operand : op->getOperands()) {
+                use(operand);
+            }
+
+            auto symbol = mlir::SymbolTable::getSymbolAttrName();
+            for (auto attr : op->getAttrs()) {
+                auto value = attr.getValue();
+                if (value.getDialect().getNamespace() == "meta") {
+                    continue;
+                }
+
+                if (ignore_symbol_name && attr.getName() == symbol) {
+                    continue;
+                }
+
+                add(attr.getName().getValue());
+                add(self.attr_hash(value));
+            }
+
+            add(std::uint64_t(op->getNumResults()));
+            for (auto result : op->getResults()) {
+                define(result);
+            }
+
+            add(std::uint64_t(op->getNumRegions()));
+            for (auto &region : op->getRegions()) {
+                // copied, hashing of later regions may grow the cache
+                auto entry = self.region(region);
+                add(entry.hash.low);
+                add(entry.hash.high);
+                add(std::uint64_t(entry.captures.size()));
+                for (auto value : entry.captures) {
+                    use(value);
+                }
+            }
+
+            add(std::uint64_t(op->getNumSuccessors()));
+            for (auto succ : op->getSuccessors()) {
+                add(blocks ? blocks->lookup(succ) : ~std::uint64_t(0));
+            }
+        }
+
+        void add(mlir::Region &region) {
+            // Blocks are numbered before their bodies, as successors may
+            // refer to the blocks that follow.
+            llvm::DenseMap< mlir::Block *, std::uint64_t > blocks;
+            for (auto &block : region) {
+                blocks.try_emplace(&block, blocks.size());
+            }
+
+            add(std::uint64_t(blocks.size()));
+            for (auto &block : region) {
+                add(std::uint64_t(block.getNumArguments()));
+                for (auto arg : block.getArguments()) {
+                    define(arg);
+                }
+
+                add(std::uint64_t(block.getOperations().size()));
+                for (auto &op : block) {
+                    add(&op, /* ignore symbol name */ false, &blocks);
+                }
+            }
+        }
+
+        structural_hasher &self;
+
+        llvm::SmallVector< std::uint8_t, 256 > bytes;
+
+        llvm::DenseMap< mlir_value, std::uint64_t > locals;
+        llvm::DenseMap< mlir_value, std::uint64_t > capture_ids;
+        llvm::SmallVector< mlir_value, 4 > captures;
+    };
+
+    std::uint64_t structural_hasher::type_hash(mlir_type type) {
+        if (auto it = types.find(type); it != types.end()) {
+            return it->second;
+        }
+        return types[type] = printed_hash(type);
+    }
+
+    std::uint64_t structural_hasher::attr_hash(mlir_attr attr) {
+        if (auto it = attrs.find(attr); it != attrs.end()) {
+            return it->second;
+        }
+        return attrs[attr] = printed_hash(attr);
+    }
+
+    const structural_hasher::region_entry &structural_hasher::region(mlir::Region &region) {
+        if (auto it = regions.find(&region); it != regions.end()) {
+            return it->second;
+        }
+
+        encoder enc(*this);
+        enc.add(region);
+        return regions[&region] = region_entry{ finish(enc.bytes), std::move(enc.captures) };
+    }
+
+    hash128 structural_hasher::hash(operation op, bool ignore_symbol_name) {
+        encoder enc(*this);
+        enc.add(op, ignore_symbol_name, /* blocks */ nullptr);
+        return finish(enc.bytes);
+    }
+
+    hash128 structural_hasher::hash(mlir::Region &region) {
+        return this->region(region).hash;
+    }
+
+    hash128 structural_hash(operation op, bool ignore_symbol_name) {
+        structural_hasher hasher;
+        return hasher.hash(op, ignore_symbol_name);
+    }
+
+} // namespace vast::util
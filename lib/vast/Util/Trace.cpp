@@ -0,0 +1,188 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/Trace.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Pass/Pass.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast {
+
+    namespace {
+
+        thread_local trace_recorder *current_recorder = nullptr;
+
+        std::string describe(operation op) {
+            auto name = op->getName().getStringRef().str();
+            if (auto sym = op->getAttrOfType< mlir::StringAttr >(mlir::SymbolTable::getSymbolAttrName())) {
+                name += " @" + sym.getValue().str();
+            }
+            return name;
+        }
+
+        std::string name_of(mlir::Pass *pass) {
+            auto name = pass->getArgument();
+            return (name.empty() ? pass->getName() : name).str();
+        }
+
+        std::int64_t microseconds(auto duration) {
+            return std::chrono::duration_cast< std::chrono::microseconds >(duration).count();
+        }
+
+    } // namespace
+
+    void trace_recorder::record(
+        std::string name, std::string category, std::string detail,
+        std::uint64_t tid, clock::time_point start, clock::time_point end
+    ) {
+        if (end - start < granularity) {
+            return;
+        }
+
+        std::lock_guard< std::mutex > lock(mutex);
+        events.push_back({
+            std::move(name), std::move(category), std::move(detail), tid, start, end
+        });
+    }
+
+    void trace_recorder::write(llvm::raw_ostream &os) const {
+        llvm::SmallString< 0 > buffer;
+        llvm::raw_svector_ostream profile(buffer);
+        llvm::timeTraceProfilerWrite(profile);
+
+        auto parsed = llvm::json::parse(buffer);
+        if (!parsed || !parsed->getAsObject()) {
+            llvm::consumeError(parsed.takeError());
+            VAST_FATAL("unexpected output of the llvm time trace profiler");
+        }
+
+        auto &trace = *parsed->getAsObject();
+        auto *trace_events = trace.getArray("traceEvents");
+        VAST_CHECK(trace_events, "unexpected output of the llvm time trace profiler");
+
+        // Events are attributed to the process and threads of the profiler.
+        std::int64_t pid = llvm::sys::Process::getProcessId();
+        llvm::DenseSet< std::int64_t > named_threads;
+        for (const auto &value : *trace_events) {
+            if (auto *entry = value.getAsObject()) {
+                if (auto id = entry->getInteger("pid")) {
+                    pid = *id;
+                }
+
+                if (entry->getString("ph") == "M" && entry->getString("name") == "thread_name") {
+                    if (auto tid = entry->getInteger("tid")) {
+                        named_threads.insert(*tid);
+                    }
+                }
+            }
+        }
+
+        std::lock_guard< std::mutex > lock(mutex);
+        for (const auto &event : events) {
+            llvm::json::Object entry{
+                { "pid", pid },
+                { "tid", std::int64_t(event.tid) },
+                { "ph", "X" },
+                { "ts", microseconds(event.start - origin) },
+                { "dur", microseconds(event.end - event.start) },
+                { "name", event.name },
+                { "cat", event.category }
+            };
+
+            if (!event.detail.empty()) {
+                entry["args"] = llvm::json::Object{ { "detail", event.detail } };
+            }
+
+            trace_events->push_back(std::move(entry));
+
+            if (named_threads.insert(std::int64_t(event.tid)).second) {
+                trace_events->push_back(llvm::json::Object{
+                    { "pid", pid },
+                    { "tid", std::int64_t(event.tid) },
+                    { "ph", "M" },
+                    { "name", "thread_name" },
+                    { "args", llvm::json::Object{ { "name", "vast worker" } } }
+                });
+            }
+        }
+
+        os << llvm::json::Value(std::move(trace)) << "\n";
+    }
+
+    trace_recorder *trace_recorder::current() { return current_recorder; }
+
+    trace_recorder_scope::trace_recorder_scope(trace_recorder *recorder)
+        : previous(std::exchange(current_recorder, recorder))
+    {}
+
+    trace_recorder_scope::~trace_recorder_scope() { current_recorder = previous; }
+
+    trace_instrumentation::trace_instrumentation(const pipeline_t &ppl, trace_recorder &recorder)
+        : ppl(ppl), recorder(recorder), owner(llvm::get_threadid())
+    {}
+
+    trace_instrumentation::~trace_instrumentation() {
+        close_step();
+    }
+
+    void trace_instrumentation::runBeforePass(mlir::Pass *pass, operation op) {
+        auto start = clock::now();
+
+        std::lock_guard< std::mutex > lock(mutex);
+        running[llvm::get_threadid()].push_back({ pass, op, start });
+    }
+
+    void trace_instrumentation::runAfterPass(mlir::Pass *pass, operation op) {
+        finish(pass, op);
+    }
+
+    void trace_instrumentation::runAfterPassFailed(mlir::Pass *pass, operation op) {
+        finish(pass, op);
+    }
+
+    void trace_instrumentation::finish(mlir::Pass *pass, operation op) {
+        auto end = clock::now();
+        auto tid = llvm::get_threadid();
+
+        std::lock_guard< std::mutex > lock(mutex);
+        auto &stack = running[tid];
+        if (stack.empty() || stack.back().pass != pass || stack.back().op != op) {
+            return;
+        }
+
+        auto start = stack.back().start;
+        stack.pop_back();
+
+        auto step_name = ppl.step_of(pass->getTypeID()).str();
+        recorder.record(name_of(pass), "vast-pass", describe(op), tid, start, end);
+
+        if (tid != owner || !stack.empty() || step_name.empty()) {
+            return;
+        }
+
+        if (step.name != step_name || step.op != op) {
+            close_step();
+            step = { step_name, describe(op), op, start, end };
+        }
+
+        step.end = end;
+    }
+
+    void trace_instrumentation::close_step() {
+        if (step.name.empty()) {
+            return;
+        }
+
+        recorder.record(
+            std::exchange(step.name, {}), "vast-step", step.detail, owner, step.start, step.end
+        );
+    }
+
+} // namespace vast
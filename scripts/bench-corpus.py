@@ -0,0 +1,320 @@
+#!/usr/bin/env python3
+
+#
+# Compiles a fixed corpus of C projects with vast-front to each target
+# dialect and records wall time, peak RSS and per-step statistics of the
+# vast pipeline (-vast-pipeline-stats) into a JSON results file. Results can
+# be compared against a baseline, regressions over the threshold make the
+# script fail.
+#
+# See docs/Tools/vast-bench.md.
+#
+
+from typing import Any, Dict, List, Optional
+
+import argparse
+import fnmatch
+import glob
+import hashlib
+import json
+import os
+import shlex
+import subprocess
+import sys
+import tarfile
+import tempfile
+import time
+import urllib.request
+import zipfile
+
+Json = Dict[str, Any]
+
+script_dir = os.path.dirname(os.path.abspath(sys.argv[0]))
+
+default_targets = ["hl", "std", "llvm"]
+
+# Times below the floor are too noisy to be compared.
+wall_floor_seconds = 0.05
+
+
+#
+# Corpus
+#
+
+def sha256_of(path: str) -> str:
+    digest = hashlib.sha256()
+    with open(path, "rb") as file:
+        for chunk in iter(lambda: file.read(1 << 20), b""):
+            digest.update(chunk)
+    return digest.hexdigest()
+
+
+def fetch(project: Json, work_dir: str) -> str:
+    downloads = os.path.join(work_dir, "downloads")
+    os.makedirs(downloads, exist_ok=True)
+
+    url = project["url"]
+    archive = os.path.join(downloads, os.path.basename(url))
+    if not os.path.exists(archive):
+        print(f"fetching {url}", file=sys.stderr)
+        partial = archive + ".part"
+        urllib.request.urlretrieve(url, partial)
+        os.replace(partial, archive)
+
+    if expected := project.get("sha256"):
+        if (actual := sha256_of(archive)) != expected:
+            sys.exit(f"{archive}: sha256 {actual} does not match {expected}")
+
+    sources = os.path.join(work_dir, "src", project["name"])
+    if not os.path.isdir(sources):
+        partial = sources + ".part"
+        if archive.endswith(".zip"):
+            with zipfile.ZipFile(archive) as zip:
+                zip.extractall(partial)
+        else:
+            with tarfile.open(archive) as tar:
+                tar.extractall(partial)
+        os.replace(partial, sources)
+
+    return os.path.join(sources, project["root"])
+
+
+class Unit:
+    def __init__(self, source: str, args: List[str], directory: str):
+        self.source = source
+        self.args = args
+        self.directory = directory
+
+
+def archive_units(project: Json, work_dir: str) -> List[Unit]:
+    root = fetch(project, work_dir)
+    excluded = project.get("exclude", [])
+
+    units = []
+    for pattern in project["sources"]:
+        for source in sorted(glob.glob(os.path.join(root, pattern))):
+            if any(fnmatch.fnmatch(os.path.basename(source), ex) for ex in excluded):
+                continue
+            units.append(Unit(source, project.get("flags", []) + ["-I", root], root))
+    return units
+
+
+# Drops the compiler, the input, the output and the compile-only flag of the
+# compile command, vast-front adds its own.
+def command_args(entry: Json) -> List[str]:
+    args = entry["arguments"] if "arguments" in entry else shlex.split(entry["command"])
+
+    result = []
+    skip = False
+    for arg in args[1:]:
+        if skip:
+            skip = False
+            continue
+        if arg == "-o":
+            skip = True
+            continue
+        if arg == "-c" or arg.startswith("-o") or arg == entry["file"]:
+            continue
+        result.append(arg)
+    return result
+
+
+def compile_commands_units(project: Json) -> Optional[List[Unit]]:
+    path = os.path.expandvars(project["compile_commands"])
+    if not os.path.isfile(path):
+        print(f"skipping {project['name']}: no compile commands at {path}", file=sys.stderr)
+        return None
+
+    with open(path) as file:
+        commands = json.load(file)
+
+    filters = project.get("filter", [])
+
+    units = []
+    for entry in commands:
+        source = os.path.join(entry["directory"], entry["file"])
+        if filters and not any(part in source for part in filters):
+            continue
+        units.append(Unit(source, command_args(entry), entry["directory"]))
+    return units
+
+
+def corpus_units(project: Json, work_dir: str) -> Optional[List[Unit]]:
+    if "compile_commands" in project:
+        return compile_commands_units(project)
+    return archive_units(project, work_dir)
+
+
+#
+# Measurements
+#
+
+def compile_unit(vast_front: str, unit: Unit, target: str, scratch: str) -> Optional[Json]:
+    stats = os.path.join(scratch, "stats.json")
+    output = os.path.join(scratch, "output.mlir")
+    if os.path.exists(stats):
+        os.remove(stats)
+
+    cmd = [
+        vast_front,
+        f"-vast-emit-mlir={target}",
+        f"-vast-pipeline-stats={stats}",
+        *unit.args,
+        unit.source,
+        "-o", output,
+    ]
+
+    start = time.perf_counter()
+    process = subprocess.Popen(cmd, cwd=unit.directory, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    stderr = process.stderr.read()
+    _, status, usage = os.wait4(process.pid, 0)
+    wall = time.perf_counter() - start
+    process.returncode = os.waitstatus_to_exitcode(status)
+
+    if process.returncode != 0 or not os.path.exists(stats):
+        print(f"failed: {shlex.join(cmd)}\n{stderr.decode(errors='replace')}", file=sys.stderr)
+        return None
+
+    with open(stats) as file:
+        steps = json.load(file)["steps"]
+
+    return {
+        "wall_seconds": wall,
+        # kilobytes on linux
+        "peak_rss_kb": usage.ru_maxrss,
+        "steps": steps,
+    }
+
+
+def empty_step() -> Json:
+    return {"wall_seconds": 0.0, "cpu_seconds": 0.0, "ops_delta": 0, "peak_rss_kb": 0}
+
+
+def measure(vast_front: str, units: List[Unit], target: str) -> Json:
+    result = {"units": len(units), "failed": 0, "wall_seconds": 0.0, "peak_rss_kb": 0, "steps": {}}
+
+    with tempfile.TemporaryDirectory() as scratch:
+        for unit in units:
+            measured = compile_unit(vast_front, unit, target, scratch)
+            if measured is None:
+                result["failed"] += 1
+                continue
+
+            result["wall_seconds"] += measured["wall_seconds"]
+            result["peak_rss_kb"] = max(result["peak_rss_kb"], measured["peak_rss_kb"])
+
+            for step in measured["steps"]:
+                total = result["steps"].setdefault(step["name"], empty_step())
+                total["wall_seconds"] += step["wall_seconds"]
+                total["cpu_seconds"] += step["cpu_seconds"]
+                total["ops_delta"] += step["ops_delta"]
+                total["peak_rss_kb"] = max(total["peak_rss_kb"], step["peak_rss_kb"])
+
+    return result
+
+
+def vast_version(vast_front: str) -> str:
+    try:
+        out = subprocess.run([vast_front, "--version"], capture_output=True, text=True, check=True)
+        return out.stdout.strip().splitlines()[0]
+    except (OSError, subprocess.CalledProcessError, IndexError):
+        return "unknown"
+
+
+#
+# Comparison
+#
+
+def regressed(old: float, new: float, threshold: float, floor: float = 0) -> bool:
+    return old > floor and new > old * (1 + threshold)
+
+
+def compare(baseline: Json, results: Json, threshold: float) -> int:
+    regressions = 0
+
+    def report(where: str, metric: str, old: float, new: float):
+        nonlocal regressions
+        regressions += 1
+        change = f" (+{(new / old - 1) * 100:.1f}%)" if old else ""
+        print(f"regression: {where}: {metric} {old:.3f} -> {new:.3f}{change}")
+
+    for project, targets in results["projects"].items():
+        for target, new in targets.items():
+            old = baseline.get("projects", {}).get(project, {}).get(target)
+            if old is None:
+                continue
+
+            where = f"{project}/{target}"
+            if new["failed"] > old["failed"]:
+                report(where, "failed units", old["failed"], new["failed"])
+
+            if regressed(old["wall_seconds"], new["wall_seconds"], threshold, wall_floor_seconds):
+                report(where, "wall seconds", old["wall_seconds"], new["wall_seconds"])
+
+            if regressed(old["peak_rss_kb"], new["peak_rss_kb"], threshold):
+                report(where, "peak rss kb", old["peak_rss_kb"], new["peak_rss_kb"])
+
+            for step, stats in new["steps"].items():
+                old_step = old["steps"].get(step)
+                if old_step is None:
+                    continue
+
+                if regressed(old_step["wall_seconds"], stats["wall_seconds"], threshold, wall_floor_seconds):
+                    report(f"{where}/{step}", "wall seconds", old_step["wall_seconds"], stats["wall_seconds"])
+
+    return regressions
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Benchmarks vast-front on a corpus of C projects.")
+    parser.add_argument("--vast-front", default="vast-front", help="vast-front executable")
+    parser.add_argument("--corpus", default=os.path.join(script_dir, "bench-corpus.json"),
+                        help="corpus description")
+    parser.add_argument("--work-dir", default="bench-corpus", help="directory of downloaded sources")
+    parser.add_argument("--projects", nargs="*", help="benchmarked projects, all by default")
+    parser.add_argument("--targets", nargs="*", default=default_targets, help="target dialects")
+    parser.add_argument("-o", "--output", default="bench-results.json", help="results file")
+    parser.add_argument("--baseline", help="results to compare with")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative increase reported as a regression")
+    args = parser.parse_args()
+
+    with open(args.corpus) as file:
+        corpus = json.load(file)
+
+    results = {
+        "vast_version": vast_version(args.vast_front),
+        "targets": args.targets,
+        "projects": {},
+    }
+
+    for project in corpus["projects"]:
+        name = project["name"]
+        if args.projects and name not in args.projects:
+            continue
+
+        units = corpus_units(project, args.work_dir)
+        if not units:
+            continue
+
+        for target in args.targets:
+            print(f"{name}: {len(units)} units to {target}", file=sys.stderr)
+            results["projects"].setdefault(name, {})[target] = measure(args.vast_front, units, target)
+
+    with open(args.output, "w") as file:
+        json.dump(results, file, indent=2)
+        file.write("\n")
+
+    if args.baseline:
+        with open(args.baseline) as file:
+            baseline = json.load(file)
+
+        if regressions := compare(baseline, results, args.threshold):
+            print(f"{regressions} regressions over {args.threshold:.0%}", file=sys.stderr)
+            return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+
+#
+# Compiles compute kernels with vast-front and with clang at the same
+# optimization level, runs both binaries and reports the ratio of their
+# runtimes per kernel. Outputs of the binaries have to match. Results can be
+# compared against a baseline, ratios that grow over the threshold make the
+# script fail.
+#
+# See docs/Tools/vast-bench.md.
+#
+
+from typing import Any, Dict, List, Optional
+
+import argparse
+import glob
+import json
+import math
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+import time
+
+Json = Dict[str, Any]
+
+script_dir = os.path.dirname(os.path.abspath(sys.argv[0]))
+
+# Runtimes below the floor are too noisy to be compared.
+runtime_floor_seconds = 0.05
+
+
+#
+# Builds
+#
+
+def build(compiler: str, flags: List[str], source: str, output: str) -> bool:
+    cmd = [compiler, *flags, source, "-o", output]
+    process = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    if process.returncode != 0:
+        print(f"failed: {shlex.join(cmd)}\n{process.stderr.decode(errors='replace')}", file=sys.stderr)
+        return False
+    return True
+
+
+class Run:
+    def __init__(self, seconds: float, output: bytes):
+        self.seconds = seconds
+        self.output = output
+
+
+# Takes the fastest of the repetitions, the others are slowed down by the
+# rest of the machine.
+def run(binary: str, repeat: int) -> Optional[Run]:
+    best = None
+    for _ in range(repeat):
+        start = time.perf_counter()
+        process = subprocess.run([binary], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        seconds = time.perf_counter() - start
+
+        if process.returncode != 0:
+            print(f"failed: {binary} exited with {process.returncode}\n"
+                  f"{process.stderr.decode(errors='replace')}", file=sys.stderr)
+            return None
+
+        if best is None or seconds < best.seconds:
+            best = Run(seconds, process.stdout)
+    return best
+
+
+def measure(kernel: str, args: argparse.Namespace, scratch: str) -> Json:
+    name = os.path.splitext(os.path.basename(kernel))[0]
+    flags = [args.opt, *args.flags]
+
+    result: Json = {"status": "ok"}
+
+    binaries = {}
+    for compiler, path in (("clang", args.clang), ("vast", args.vast_front)):
+        binary = os.path.join(scratch, f"{name}.{compiler}")
+        if not build(path, flags, kernel, binary):
+            result["status"] = f"{compiler} build failed"
+            return result
+        binaries[compiler] = binary
+
+    runs = {}
+    for compiler, binary in binaries.items():
+        measured = run(binary, args.repeat)
+        if measured is None:
+            result["status"] = f"{compiler} run failed"
+            return result
+        runs[compiler] = measured
+        result[f"{compiler}_seconds"] = measured.seconds
+
+    if runs["clang"].output != runs["vast"].output:
+        result["status"] = "output mismatch"
+        return result
+
+    result["ratio"] = runs["vast"].seconds / runs["clang"].seconds
+    return result
+
+
+#
+# Reports
+#
+
+def geomean(values: List[float]) -> float:
+    return math.exp(sum(math.log(value) for value in values) / len(values)) if values else 0.0
+
+
+def print_table(kernels: Json):
+    print(f"{'kernel':<16} {'clang (s)':>10} {'vast (s)':>10} {'ratio':>8}")
+    for name, result in kernels.items():
+        if result["status"] != "ok":
+            print(f"{name:<16} {result['status']}")
+            continue
+        print(f"{name:<16} {result['clang_seconds']:>10.3f} {result['vast_seconds']:>10.3f} {result['ratio']:>8.3f}")
+
+
+def compare(baseline: Json, results: Json, threshold: float) -> int:
+    regressions = 0
+
+    for name, new in results["kernels"].items():
+        old = baseline.get("kernels", {}).get(name)
+        if old is None:
+            continue
+
+        if old["status"] == "ok" and new["status"] != "ok":
+            regressions += 1
+            print(f"regression: {name}: {new['status']}")
+            continue
+
+        if new["status"] != "ok" or old["status"] != "ok":
+            continue
+
+        if old["clang_seconds"] < runtime_floor_seconds:
+            continue
+
+        if new["ratio"] > old["ratio"] * (1 + threshold):
+            regressions += 1
+            change = (new["ratio"] / old["ratio"] - 1) * 100
+            print(f"regression: {name}: ratio {old['ratio']:.3f} -> {new['ratio']:.3f} (+{change:.1f}%)")
+
+    return regressions
+
+
+def version(compiler: str) -> str:
+    try:
+        out = subprocess.run([compiler, "--version"], capture_output=True, text=True, check=True)
+        return out.stdout.strip().splitlines()[0]
+    except (OSError, subprocess.CalledProcessError, IndexError):
+        return "unknown"
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(
+        description="Compares runtimes of kernels built by vast-front and by clang."
+    )
+    parser.add_argument("--vast-front", default="vast-front", help="vast-front executable")
+    parser.add_argument("--clang", default="clang-17", help="clang executable")
+    parser.add_argument("--kernels", default=os.path.join(script_dir, "bench-runtime"),
+                        help="directory of the kernel sources")
+    parser.add_argument("--filter", nargs="*", help="benchmarked kernels, all by default")
+    parser.add_argument("--opt", default="-O2", help="optimization level of both compilers")
+    parser.add_argument("--flags", nargs="*", default=[], help="additional flags of both compilers")
+    parser.add_argument("--repeat", type=int, default=5, help="runs of every binary")
+    parser.add_argument("-o", "--output", default="bench-runtime.json", help="results file")
+    parser.add_argument("--baseline", help="results to compare with")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative increase of the ratio reported as a regression")
+    args = parser.parse_args()
+
+    kernels = sorted(glob.glob(os.path.join(args.kernels, "*.c")))
+    if args.filter:
+        kernels = [k for k in kernels if os.path.splitext(os.path.basename(k))[0] in args.filter]
+
+    results: Json = {
+        "vast_version": version(args.vast_front),
+        "clang_version": version(args.clang),
+        "opt": args.opt,
+        "flags": args.flags,
+        "kernels": {},
+    }
+
+    with tempfile.TemporaryDirectory() as scratch:
+        for kernel in kernels:
+            name = os.path.splitext(os.path.basename(kernel))[0]
+            print(f"{name}", file=sys.stderr)
+            results["kernels"][name] = measure(kernel, args, scratch)
+
+    ratios = [r["ratio"] for r in results["kernels"].values() if r["status"] == "ok"]
+    results["geomean_ratio"] = geomean(ratios)
+
+    print_table(results["kernels"])
+    print(f"geometric mean of ratios: {results['geomean_ratio']:.3f}")
+
+    with open(args.output, "w") as file:
+        json.dump(results, file, indent=2)
+        file.write("\n")
+
+    failures = sum(1 for r in results["kernels"].values() if r["status"] != "ok")
+
+    if args.baseline:
+        with open(args.baseline) as file:
+            baseline = json.load(file)
+
+        if regressions := compare(baseline, results, args.threshold):
+            print(f"{regressions} regressions over {args.threshold:.0%}", file=sys.stderr)
+            return 1
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
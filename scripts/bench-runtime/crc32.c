@@ -0,0 +1,47 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+// Table driven CRC-32 of a generated buffer, dominated by loads and shifts.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SIZE (1 << 22)
+
+static unsigned char buffer[SIZE];
+static unsigned table[256];
+
+static void init_table(void) {
+    for (unsigned i = 0; i < 256; ++i) {
+        unsigned crc = i;
+        for (int k = 0; k < 8; ++k) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320u : crc >> 1;
+        }
+        table[i] = crc;
+    }
+}
+
+static unsigned crc32(const unsigned char *data, long size) {
+    unsigned crc = 0xffffffffu;
+    for (long i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 24;
+
+    init_table();
+    for (long i = 0; i < SIZE; ++i) {
+        buffer[i] = (unsigned char)(i * 31 + (i >> 7));
+    }
+
+    unsigned check = 0;
+    for (int r = 0; r < rounds; ++r) {
+        buffer[r] ^= (unsigned char)check;
+        check ^= crc32(buffer, SIZE);
+    }
+
+    printf("%08x\n", check);
+    return 0;
+}
@@ -0,0 +1,19 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+// Naive recursive Fibonacci, dominated by calls.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int fib(int x) {
+    if (x < 2) {
+        return x;
+    }
+    return fib(x - 1) + fib(x - 2);
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 38;
+    printf("%d\n", fib(n));
+    return 0;
+}
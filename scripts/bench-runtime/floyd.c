@@ -0,0 +1,50 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+// Floyd-Warshall shortest paths of a dense graph.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 384
+#define INF 1000000000
+
+static int dist[N][N];
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 3;
+
+    long check = 0;
+    for (int r = 0; r < rounds; ++r) {
+        unsigned state = 7u + r;
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) {
+                state = state * 1103515245u + 12345u;
+                dist[i][j] = i == j ? 0 : (state >> 16) % 8 == 0 ? (int)((state >> 8) % 1000) + 1 : INF;
+            }
+        }
+
+        for (int k = 0; k < N; ++k) {
+            for (int i = 0; i < N; ++i) {
+                int dik = dist[i][k];
+                if (dik == INF) {
+                    continue;
+                }
+                for (int j = 0; j < N; ++j) {
+                    int through = dik + dist[k][j];
+                    if (dist[k][j] != INF && through < dist[i][j]) {
+                        dist[i][j] = through;
+                    }
+                }
+            }
+        }
+
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) {
+                check += dist[i][j] == INF ? -1 : dist[i][j];
+            }
+        }
+    }
+
+    printf("%ld\n", check);
+    return 0;
+}
@@ -0,0 +1,38 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+// Escape counts of the Mandelbrot set, dominated by floating point
+// arithmetic and branches.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WIDTH  768
+#define HEIGHT 512
+#define ITERATIONS 256
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 4;
+
+    long total = 0;
+    for (int r = 0; r < rounds; ++r) {
+        double zoom = 1.0 + r * 0.25;
+        for (int y = 0; y < HEIGHT; ++y) {
+            for (int x = 0; x < WIDTH; ++x) {
+                double cr = (x - WIDTH * 0.66) / (WIDTH * 0.33 * zoom);
+                double ci = (y - HEIGHT * 0.5) / (HEIGHT * 0.5 * zoom);
+                double zr = 0, zi = 0;
+                int n = 0;
+                while (n < ITERATIONS && zr * zr + zi * zi <= 4.0) {
+                    double t = zr * zr - zi * zi + cr;
+                    zi = 2.0 * zr * zi + ci;
+                    zr = t;
+                    ++n;
+                }
+                total += n;
+            }
+        }
+    }
+
+    printf("%ld\n", total);
+    return 0;
+}
@@ -0,0 +1,41 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+// Multiplication of dense matrices of doubles.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 256
+
+static double a[N][N], b[N][N], c[N][N];
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 8;
+
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            a[i][j] = (double)(i + j) / N;
+            b[i][j] = (double)(i - j) / N;
+        }
+    }
+
+    double sum = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) {
+                c[i][j] = 0;
+            }
+            for (int k = 0; k < N; ++k) {
+                double aik = a[i][k];
+                for (int j = 0; j < N; ++j) {
+                    c[i][j] += aik * b[k][j];
+                }
+            }
+        }
+        sum += c[r % N][(r * 7) % N];
+        a[r % N][r % N] += 1.0;
+    }
+
+    printf("%.6f\n", sum);
+    return 0;
+}
@@ -0,0 +1,27 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+// Counts solutions of the N queens problem by backtracking on bit masks.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static long solve(unsigned all, unsigned cols, unsigned left, unsigned right) {
+    if (cols == all) {
+        return 1;
+    }
+
+    long count = 0;
+    unsigned free = all & ~(cols | left | right);
+    while (free) {
+        unsigned bit = free & -free;
+        free ^= bit;
+        count += solve(all, cols | bit, (left | bit) << 1, (right | bit) >> 1);
+    }
+    return count;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 14;
+    printf("%ld\n", solve((1u << n) - 1, 0, 0, 0));
+    return 0;
+}
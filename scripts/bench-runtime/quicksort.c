@@ -0,0 +1,71 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+// Quicksort of pseudo-random integers.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 1000000
+
+static unsigned values[N];
+
+static unsigned next(unsigned *state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state;
+}
+
+static void sort(unsigned *data, long lo, long hi) {
+    while (lo < hi) {
+        unsigned pivot = data[lo + (hi - lo) / 2];
+        long i = lo, j = hi;
+        while (i <= j) {
+            while (data[i] < pivot) {
+                ++i;
+            }
+            while (data[j] > pivot) {
+                --j;
+            }
+            if (i <= j) {
+                unsigned tmp = data[i];
+                data[i] = data[j];
+                data[j] = tmp;
+                ++i;
+                --j;
+            }
+        }
+
+        // recurses into the smaller part
+        if (j - lo < hi - i) {
+            sort(data, lo, j);
+            lo = i;
+        } else {
+            sort(data, i, hi);
+            hi = j;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 6;
+
+    unsigned state = 42;
+    unsigned long check = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (long i = 0; i < N; ++i) {
+            values[i] = next(&state);
+        }
+
+        sort(values, 0, N - 1);
+
+        for (long i = 1; i < N; ++i) {
+            if (values[i - 1] > values[i]) {
+                printf("unsorted\n");
+                return 1;
+            }
+        }
+        check += values[N / 2];
+    }
+
+    printf("%lu\n", check);
+    return 0;
+}
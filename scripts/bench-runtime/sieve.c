@@ -0,0 +1,36 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+// Sieve of Eratosthenes, repeated.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LIMIT 1000000
+
+static char composite[LIMIT + 1];
+
+int main(int argc, char **argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 40;
+
+    long count = 0;
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i <= LIMIT; ++i) {
+            composite[i] = 0;
+        }
+
+        for (long i = 2; i * i <= LIMIT; ++i) {
+            if (!composite[i]) {
+                for (long j = i * i; j <= LIMIT; j += i) {
+                    composite[j] = 1;
+                }
+            }
+        }
+
+        for (int i = 2; i <= LIMIT; ++i) {
+            count += !composite[i];
+        }
+    }
+
+    printf("%ld\n", count);
+    return 0;
+}
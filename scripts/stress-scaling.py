@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+
+#
+# Generates C programs that stress a single dimension of the input (number
+# of functions, nesting depth, struct fields, initializer list size, switch
+# cases, typedef chain length) and measures how the time and peak memory of
+# vast-front scale with the size. Dimensions whose cost grows faster than
+# the allowed exponent are reported, e.g., because of linear lookups done
+# for every element.
+#
+# See docs/Tools/vast-bench.md.
+#
+
+from typing import Callable, Dict, List, Tuple
+
+import argparse
+import math
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+
+#
+# Generators
+#
+
+def functions(size: int) -> str:
+    lines = ["int f0(int x) { return x; }"]
+    for idx in range(1, size):
+        lines.append(f"int f{idx}(int x) {{ return f{idx - 1}(x) + {idx}; }}")
+    return "\n".join(lines) + "\n"
+
+
+def nesting(size: int) -> str:
+    body = "return x;"
+    for idx in range(size):
+        body = f"if (x > {idx}) {{ int v{idx} = x - {idx}; {body} }}"
+    return f"int nesting(int x) {{ {body} return 0; }}\n"
+
+
+def struct_fields(size: int) -> str:
+    fields = "".join(f"    int f{idx};\n" for idx in range(size))
+    reads = "".join(f"    sum += s->f{idx};\n" for idx in range(size))
+    return (
+        f"struct big {{\n{fields}}};\n\n"
+        f"int struct_fields(struct big *s) {{\n    int sum = 0;\n{reads}    return sum;\n}}\n"
+    )
+
+
+def init_list(size: int) -> str:
+    values = ", ".join(str(idx) for idx in range(size))
+    return (
+        f"int table[{size}] = {{ {values} }};\n\n"
+        f"int init_list(void) {{\n    int local[{size}] = {{ {values} }};\n"
+        f"    return local[0] + table[0];\n}}\n"
+    )
+
+
+def switch_cases(size: int) -> str:
+    cases = "".join(f"        case {idx}: return x * {idx};\n" for idx in range(size))
+    return (
+        f"int switch_cases(int x) {{\n    switch (x) {{\n{cases}"
+        f"        default: return -1;\n    }}\n}}\n"
+    )
+
+
+def typedef_chain(size: int) -> str:
+    lines = ["typedef int t0;"]
+    for idx in range(1, size):
+        lines.append(f"typedef t{idx - 1} t{idx};")
+    lines.append(f"t{size - 1} typedef_chain(t{size - 1} x) {{ return x; }}")
+    return "\n".join(lines) + "\n"
+
+
+Generator = Callable[[int], str]
+
+dimensions: Dict[str, Tuple[Generator, List[int]]] = {
+    "functions":     (functions,     [1000, 2000, 4000, 8000]),
+    "nesting":       (nesting,       [64, 128, 256, 512]),
+    "struct-fields": (struct_fields, [500, 1000, 2000, 4000]),
+    "init-list":     (init_list,     [2000, 4000, 8000, 16000]),
+    "switch-cases":  (switch_cases,  [1000, 2000, 4000, 8000]),
+    "typedef-chain": (typedef_chain, [250, 500, 1000, 2000]),
+}
+
+
+#
+# Measurements
+#
+
+# Measurements below the floor are too noisy to estimate the growth.
+wall_floor_seconds = 0.05
+
+
+def measure(vast_front: str, source: str, target: str, size: int) -> Tuple[float, int]:
+    with tempfile.TemporaryDirectory() as scratch:
+        path = os.path.join(scratch, "stress.c")
+        with open(path, "w") as file:
+            file.write(source)
+
+        cmd = [
+            vast_front, f"-vast-emit-mlir={target}", "-w",
+            # clang limits the nesting of brackets and braces
+            f"-fbracket-depth={max(256, 2 * size + 16)}",
+            path, "-o", os.path.join(scratch, "stress.mlir"),
+        ]
+
+        start = time.perf_counter()
+        process = subprocess.Popen(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        stderr = process.stderr.read()
+        _, status, usage = os.wait4(process.pid, 0)
+        wall = time.perf_counter() - start
+        process.returncode = os.waitstatus_to_exitcode(status)
+
+        if process.returncode != 0:
+            raise RuntimeError(stderr.decode(errors="replace"))
+
+        # kilobytes on linux
+        return wall, usage.ru_maxrss
+
+
+# Slope of the least squares fit of log(value) by log(size), i.e., the
+# exponent of the growth.
+def growth(points: List[Tuple[int, float]]) -> float:
+    xs = [math.log(size) for size, _ in points]
+    ys = [math.log(value) for _, value in points]
+    mx, my = sum(xs) / len(xs), sum(ys) / len(ys)
+    num = sum((x - mx) * (y - my) for x, y in zip(xs, ys))
+    den = sum((x - mx) ** 2 for x in xs)
+    return num / den if den else 0.0
+
+
+def scale(args: argparse.Namespace) -> int:
+    flagged = 0
+    for name in args.dimensions:
+        generator, sizes = dimensions[name]
+        sizes = args.sizes or sizes
+
+        times, memory = [], []
+        for size in sizes:
+            try:
+                wall, rss = measure(args.vast_front, generator(size), args.target, size)
+            except RuntimeError as err:
+                print(f"{name}/{size}: failed\n{err}", file=sys.stderr)
+                break
+
+            print(f"{name}/{size}: {wall:.3f} s, {rss / 1024:.1f} MB")
+            if wall >= wall_floor_seconds:
+                times.append((size, wall))
+            memory.append((size, rss))
+
+        for metric, points in (("time", times), ("memory", memory)):
+            if len(points) < 2:
+                continue
+
+            exponent = growth(points)
+            verdict = "super-linear" if exponent > args.max_exponent else "ok"
+            print(f"{name}: {metric} grows as size^{exponent:.2f} ({verdict})")
+            flagged += exponent > args.max_exponent
+
+    return 1 if flagged else 0
+
+
+def generate(args: argparse.Namespace) -> int:
+    generator, _ = dimensions[args.dimension]
+    sys.stdout.write(generator(args.size))
+    return 0
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Scaling tests of vast-front on synthetic inputs.")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    gen = commands.add_parser("generate", help="print the program of the dimension and size")
+    gen.add_argument("dimension", choices=dimensions)
+    gen.add_argument("size", type=int)
+    gen.set_defaults(run=generate)
+
+    run = commands.add_parser("scale", help="measure vast-front across the sizes of dimensions")
+    run.add_argument("--vast-front", default="vast-front", help="vast-front executable")
+    run.add_argument("--target", default="hl", help="target dialect")
+    run.add_argument("--dimensions", nargs="*", choices=dimensions, default=list(dimensions))
+    run.add_argument("--sizes", nargs="*", type=int, help="sizes instead of the defaults")
+    run.add_argument("--max-exponent", type=float, default=1.25,
+                     help="largest exponent of the growth that is not reported")
+    run.set_defaults(run=scale)
+
+    args = parser.parse_args()
+    return args.run(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
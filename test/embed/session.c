@@ -0,0 +1,21 @@
+// RUN: %vast-embed %s | %file-check %s
+// RUN: %vast-embed --repeat=3 --target=llvm %s | %file-check %s -check-prefix=LLVM
+// RUN: %vast-embed --repeat=2 --vast-option=-vast-simplify %s -- -DVALUE=7 | %file-check %s -check-prefix=ARGS
+// RUN: %vast-embed --emit=bytecode %s > %t.mlirbc && %vast-opt %t.mlirbc | %file-check %s
+// RUN: not %vast-embed %S/Inputs/error.c 2>&1 | %file-check %s -check-prefix=ERROR
+
+// Repeated compilations of one session give the same output.
+// CHECK:      hl.func @twice
+// CHECK:      hl.mul
+// LLVM:       llvm.func @twice
+// LLVM:       llvm.mul
+// ARGS:       hl.const #core.integer<7>
+
+#ifndef VALUE
+#define VALUE 2
+#endif
+
+int twice(int v) { return v * VALUE; }
+
+// ERROR:      error: use of undeclared identifier 'missing'
+// ERROR:      error: compilation 0 failed
@@ -0,0 +1,11 @@
+struct point { int x; int y; };
+
+static int scale = 2;
+
+static int twice(int v) { return scale * v; }
+
+int counter;
+
+int shift(struct point *p) { return twice(p->x) + p->y + counter; }
+
+__attribute__((weak)) int fallback(void) { return 1; }
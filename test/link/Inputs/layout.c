@@ -0,0 +1,3 @@
+int count(void);
+
+double ratio(int n) { return (double)n / count(); }
@@ -0,0 +1,5 @@
+typedef unsigned long size;
+
+struct buffer { const char *data; size length; };
+
+static struct buffer empty(void) { struct buffer b = { 0, 0 }; return b; }
@@ -0,0 +1,13 @@
+// Helpers of partitions.c, referenced by the first unit only.
+
+static int digit(char c) { return c - '0'; }
+
+int parse(const char *input)
+{
+    int value = 0;
+    while (*input)
+        value = value * 10 + digit(*input++);
+    return value;
+}
+
+int check(int value) { return value > 0 && value < 1000; }
@@ -0,0 +1,11 @@
+// Second group of partitions.c, refers only to the fourth unit.
+
+int hash(int seed, int value);
+int mix(int value);
+
+int digest(int seed, int a, int b)
+{
+    int h = hash(seed, a);
+    h = hash(h, b);
+    return mix(h) ^ mix(a + b);
+}
@@ -0,0 +1,11 @@
+// Helpers of the second group of partitions.c.
+
+int hash(int seed, int value) { return seed * 31 + value; }
+
+int mix(int value)
+{
+    value ^= value >> 16;
+    value *= 0x45d9f3b;
+    value ^= value >> 16;
+    return value;
+}
@@ -0,0 +1,14 @@
+// RUN: rm -rf %t && mkdir -p %t && \
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o %t/a.mlir && \
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %S/Inputs/layout.c -o %t/b.mlir && \
+// RUN: %vast-link --stats %t/a.mlir %t/b.mlir -o %t/program.mlir 2>&1 | %file-check %s && \
+// RUN: %file-check %s -check-prefix=PROGRAM < %t/program.mlir
+
+// Only the second unit uses double, its layout is kept in the program.
+
+// CHECK: errors: 0
+
+// PROGRAM-DAG: #dlti.dl_entry<!hl.int, #core.dl<32, 32>>
+// PROGRAM-DAG: #dlti.dl_entry<!hl.double, #core.dl<64, 64>>
+
+int count(void) { return 0; }
@@ -0,0 +1,33 @@
+// RUN: rm -rf %t && mkdir -p %t && \
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t/a.mlir && \
+// RUN: %vast-cc1 -vast-emit-mlir=hl %S/Inputs/odr.c -o %t/b.mlir && \
+// RUN: %vast-cc1 -vast-emit-mlir=hl %S/Inputs/odr.c -o %t/c.mlir && \
+// RUN: %vast-link --stats %t/a.mlir %t/b.mlir %t/c.mlir -o %t/program.mlir 2>&1 | %file-check %s && \
+// RUN: %file-check %s -check-prefix=PROGRAM < %t/program.mlir
+
+// The field of the record differs in its qualifiers, so the record of each
+// of the other two units is renamed together with the types referring to it,
+// and the copies of the typedef are merged.
+
+// CHECK: warning: type 'buffer' has 3 different definitions, the later ones are renamed
+// CHECK: note: different definition is renamed to 'buffer.1'
+// CHECK: note: different definition is renamed to 'buffer.2'
+// CHECK: deduplicated types: 2
+// CHECK: conflicting types: 1
+// CHECK: conflicting type definitions: 2
+// CHECK: errors: 0
+
+// PROGRAM-COUNT-1: hl.typedef "size"
+// PROGRAM-NOT: hl.typedef "size"
+
+// PROGRAM-DAG: hl.struct "buffer"
+// PROGRAM-DAG: hl.struct "buffer.1"
+// PROGRAM-DAG: hl.struct "buffer.2"
+// PROGRAM-DAG: hl.func @empty {{.*}} -> !hl.elaborated<!hl.record<"buffer.1">>
+// PROGRAM-DAG: hl.func @empty.2 {{.*}} -> !hl.elaborated<!hl.record<"buffer.2">>
+
+typedef unsigned long size;
+
+struct buffer { char *data; size length; };
+
+size length(struct buffer *b) { return b->length; }
@@ -0,0 +1,29 @@
+// RUN: rm -rf %t && mkdir -p %t && \
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t/a.mlir && \
+// RUN: %vast-cc1 -vast-emit-mlir=hl %S/Inputs/partition-b.c -o %t/b.mlir && \
+// RUN: %vast-cc1 -vast-emit-mlir=hl %S/Inputs/partition-c.c -o %t/c.mlir && \
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %S/Inputs/partition-d.c -o %t/d.mlirbc && \
+// RUN: %vast-link --partitions=2 --stats %t/a.mlir %t/c.mlir %t/b.mlir %t/d.mlirbc 2> %t/stats | %file-check %s && \
+// RUN: %file-check %s -check-prefix=STATS < %t/stats
+
+// Units that refer to each other share a partition, so no reference crosses
+// partitions.
+
+// CHECK: [[AB:[0-9]+]] {{.*}}a.mlir
+// CHECK: [[CD:[0-9]+]] {{.*}}c.mlir
+// CHECK: [[AB]] {{.*}}b.mlir
+// CHECK: [[CD]] {{.*}}d.mlirbc
+
+// STATS: partitions: 2
+// STATS: cross-partition references: 0
+
+int parse(const char *input);
+int check(int value);
+
+int run(const char *input)
+{
+    int value = parse(input);
+    if (check(value))
+        return value;
+    return parse(input + 1) + check(value + 1);
+}
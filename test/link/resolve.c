@@ -0,0 +1,41 @@
+// RUN: rm -rf %t && mkdir -p %t && \
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t/main.mlir && \
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %S/Inputs/helpers.c -o %t/helpers.mlirbc && \
+// RUN: %vast-link --stats %t/main.mlir %t/helpers.mlirbc 2> %t/stats | %file-check %s && \
+// RUN: %file-check %s -check-prefix=STATS < %t/stats
+
+// The declarations of the main unit resolve against the definitions of the
+// helpers, internal symbols of the helpers are renamed once they collide.
+
+// CHECK: hl.struct "point"
+// CHECK-DAG: hl.var "counter"
+// CHECK-DAG: hl.var "scale"
+// CHECK-DAG: hl.var "scale.1"
+// CHECK-DAG: hl.func @twice
+// CHECK-DAG: hl.func @twice.1
+// CHECK-DAG: hl.func @shift
+// CHECK-DAG: hl.func @fallback
+// CHECK-DAG: hl.globref "scale.1"
+// CHECK-DAG: hl.call @twice.1
+
+// STATS: units: 2
+// STATS: renamed internal symbols: 2
+// STATS: deduplicated types: 1
+// STATS: errors: 0
+
+struct point { int x; int y; };
+
+static int scale = 3;
+
+static int twice(int v) { return scale * v * 2; }
+
+extern int counter;
+
+int shift(struct point *p);
+
+int fallback(void) { return twice(0); }
+
+int main(void) {
+    struct point p = { 1, 2 };
+    return shift(&p) + fallback() + counter;
+}
@@ -21,7 +21,7 @@ config.name = 'VAST'
 config.test_format = lit.formats.ShTest(not llvm_config.use_lit_shell)
 
 # suffixes: A list of file extensions to treat as test files.
-config.suffixes = ['.mlir', '.c', '.cpp', '.ll']
+config.suffixes = ['.mlir', '.c', '.cpp', '.ll', '.test']
 
 # test_source_root: The root path where tests are located.
 config.test_source_root = os.path.dirname(__file__)
@@ -59,8 +59,11 @@ tools = [
     ),
     ToolSubst('%vast-cc', command = 'vast-cc'),
     ToolSubst('%vast-query', command = 'vast-query'),
+    ToolSubst('%vast-link', command = 'vast-link'),
+    ToolSubst('%vast-embed', command = 'vast-embed'),
     ToolSubst('%vast-front', command = 'vast-front'),
     ToolSubst('%vast-repl', command = 'vast-repl'),
+    ToolSubst('%vast-lsp-server', command = 'vast-lsp-server'),
     ToolSubst('%vast-cc1', command = 'vast-front',
         extra_args=[
             "-cc1",
@@ -69,7 +72,8 @@ tools = [
         ]
     ),
     ToolSubst('%file-check', command = 'FileCheck'),
-    ToolSubst('%clang', command = 'clang-17')
+    ToolSubst('%clang', command = 'clang-17'),
+    ToolSubst('%llvm-profdata', command = 'llvm-profdata-17')
 ]
 
 if 'BUILD_TYPE' in lit_config.params:
@@ -82,3 +86,7 @@ for tool in tools:
         path = [config.vast_tools_dir, tool.command, config.vast_build_type]
         tool.command = os.path.join(*path, tool.command)
     llvm_config.add_tool_substitutions([tool])
+
+# Optional components of the build.
+if lit.util.pythonize_bool(config.vast_enable_zstd):
+    config.available_features.add('zstd')
@@ -0,0 +1,12 @@
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %s -o %t && \
+// RUN: %vast-query --at=%s:11:12 %t | \
+// RUN: %file-check %s -check-prefix=COL
+// RUN: %vast-query --at=%s:11 %t | \
+// RUN: %file-check %s -check-prefix=LINE
+
+// COL-NOT: hl.return
+// COL: hl.ref
+// LINE: hl.return
+int foo(int a) {
+    return a + 1;
+}
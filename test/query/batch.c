@@ -0,0 +1,18 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: printf "show-symbols=functions\n\n# users in foo\nsymbol-users=a scope=foo\nbogus=1\n" | \
+// RUN: not %vast-query --batch=- --json %t | \
+// RUN: %file-check %s
+
+// CHECK-DAG: {"kind":"hl.func",{{.*}}"query":"show-symbols=functions","symbol":"foo"}
+// CHECK-DAG: {"kind":"hl.func",{{.*}}"query":"show-symbols=functions","symbol":"main"}
+// CHECK-DAG: {{.*}}"operation":"{{.*}}hl.ref{{.*}}"query":"symbol-users=a scope=foo"}
+// CHECK-DAG: {"error":"unknown query: bogus=1","query":"bogus=1"}
+int foo() {
+    int a;
+    return a;
+}
+
+int main() {
+    int a = 1;
+    return foo() + a;
+}
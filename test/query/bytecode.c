@@ -0,0 +1,9 @@
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %s -o %t && \
+// RUN: %vast-query --show-symbols=functions %t | \
+// RUN: %file-check %s
+
+// CHECK-DAG: func : foo
+int foo(int a) { return a; }
+
+// CHECK-DAG: func : main
+int main() { return foo(0); }
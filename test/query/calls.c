@@ -0,0 +1,21 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --callees=dispatch %t | %file-check %s -check-prefix=CALLEES && \
+// RUN: %vast-query --callers=inc %t | %file-check %s -check-prefix=CALLERS
+
+// The indirect call may reach the functions of one argument whose address is
+// taken, `twice` is called only directly.
+
+// CALLEES-DAG: hl.func : inc {{.*}} (indirect)
+// CALLEES-DAG: hl.func : dec {{.*}} (indirect)
+// CALLEES-DAG: hl.func : twice
+// CALLEES-NOT: hl.func : main
+
+// CALLERS: hl.func : dispatch
+// CALLERS-NEXT: hl.func : main
+int inc(int v) { return v + 1; }
+int dec(int v) { return v - 1; }
+int twice(int v) { return v * 2; }
+
+int dispatch(int (*op)(int), int v) { return twice(op(v)); }
+
+int main(void) { return dispatch(inc, 1) + dispatch(dec, 2) + inc(0); }
@@ -0,0 +1,43 @@
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %s -o %t && \
+// RUN: %vast-query --extract=top %t | %file-check %s -check-prefix=ALL && \
+// RUN: %vast-query --extract=top --extract-depth=1 %t | %file-check %s -check-prefix=DEPTH
+
+// The closure holds the types and globals the kept bodies use, in the order
+// of the module, and nothing else.
+// ALL-NOT:   hl.func @unrelated
+// ALL:       hl.typedef "score_t"
+// ALL:       hl.struct "point"
+// ALL:       hl.var "table"
+// ALL:       hl.func @leaf {{.*}}{
+// ALL:       hl.globref "table"
+// ALL:       hl.func @middle {{.*}}{
+// ALL:       hl.func @top {{.*}}{
+// ALL-NOT:   hl.func @unrelated
+
+// Callees beyond the depth are declarations, so the globals only they use
+// are not kept.
+// DEPTH-NOT: hl.var "table"
+// DEPTH:     hl.typedef "score_t"
+// DEPTH:     hl.struct "point"
+// DEPTH-NOT: hl.var "table"
+// DEPTH:     hl.func @leaf
+// DEPTH-NOT: hl.globref
+// DEPTH:     hl.func @middle {{.*}}{
+// DEPTH:     hl.call @leaf
+// DEPTH:     hl.func @top {{.*}}{
+// DEPTH:     hl.call @middle
+// DEPTH-NOT: hl.func @unrelated
+
+typedef int score_t;
+
+struct point { int x; int y; };
+
+int table[4] = { 1, 2, 3, 4 };
+
+int unrelated(void) { return 7; }
+
+int leaf(int v) { return table[v & 3]; }
+
+int middle(struct point p) { return leaf(p.x) + leaf(p.y); }
+
+score_t top(struct point p) { return middle(p); }
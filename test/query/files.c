@@ -0,0 +1,18 @@
+// RUN: rm -rf %t && mkdir -p %t/b && \
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t/a.mlir && \
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %s -o %t/b/b.mlirbc && \
+// RUN: %vast-query --show-symbols=functions %t | %file-check %s && \
+// RUN: %vast-query --json --symbol-users=a --scope=foo %t/b/b.mlirbc %t/a.mlir | \
+// RUN: %file-check %s -check-prefix=JSON
+
+// CHECK: // {{.*}}a.mlir
+// CHECK: func : foo
+// CHECK: // {{.*}}b.mlirbc
+// CHECK: func : foo
+
+// JSON: "file":"{{.*}}b.mlirbc"
+// JSON: "file":"{{.*}}a.mlir"
+int foo() {
+    int a;
+    return a;
+}
@@ -0,0 +1,24 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --flat=add %t | %file-check %s && \
+// RUN: %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll-cf %t -o %t.llcf && \
+// RUN: %vast-query --flat=count %t.llcf | %file-check %s -check-prefix=BRANCHES && \
+// RUN: not %vast-query --flat=missing %t 2>&1 | %file-check %s -check-prefix=MISSING
+
+// The function is the operation zero, its arguments are the first values.
+// CHECK:      add : ops {{[0-9]+}} : blocks 1 : regions 1 : values {{[0-9]+}} ({{[0-9]+}} own) : kinds {{[0-9]+}}
+// CHECK-NEXT: 0 hl.func{{$}}
+// CHECK:      hl.add : block 0 : operands %{{[0-9]+}} %{{[0-9]+}} : results %[[SUM:[0-9]+]]
+// CHECK:      hl.return : block 0 : operands %[[SUM]]{{$}}
+int add(int a, int b) { return a + b; }
+
+// Branches of lowered loops refer to the blocks of the function.
+// BRANCHES:   count : ops {{[0-9]+}} : blocks {{[2-9]|[1-9][0-9]+}} :
+// BRANCHES:   : block {{[0-9]+}} : {{.*}}successors ^{{[0-9]+}} ^{{[0-9]+}}
+int count(int n) {
+    int s = 0;
+    while (n--)
+        ++s;
+    return s;
+}
+
+// MISSING: error: cannot find function missing
@@ -0,0 +1,48 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.a.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -DPAD %s -o %t.b.mlir
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %s -o %t.mlirbc
+// RUN: %vast-query --hash=add %t.a.mlir > %t.hashes
+// RUN: %vast-query --hash=plus %t.a.mlir >> %t.hashes
+// RUN: %vast-query --hash=add %t.b.mlir >> %t.hashes
+// RUN: %vast-query --hash=add %t.mlirbc >> %t.hashes
+// RUN: %vast-query --hash=sub %t.a.mlir >> %t.hashes
+// RUN: %vast-query --hash=add_one %t.a.mlir >> %t.hashes
+// RUN: %vast-query --hash=add_two %t.a.mlir >> %t.hashes
+// RUN: %file-check --input-file=%t.hashes %s
+// RUN: %vast-query --hash=add_one %t.a.mlir > %t.constants
+// RUN: %vast-query --hash=add_two %t.a.mlir >> %t.constants
+// RUN: %file-check --input-file=%t.constants %s -check-prefix=CONST
+// RUN: not %vast-query --hash=missing %t.a.mlir 2>&1 | %file-check %s -check-prefix=MISSING
+
+// Names of the symbol and its values, and locations, do not change the hash,
+// neither does the format of the module.
+// CHECK:      [[ADD:[0-9a-f]{32}]] add{{$}}
+// CHECK-NEXT: [[ADD]] plus{{$}}
+// CHECK-NEXT: [[ADD]] add{{$}}
+// CHECK-NEXT: [[ADD]] add{{$}}
+
+// Operations and constants do.
+// CHECK-NOT:  [[ADD]]
+// CHECK:      add_two{{$}}
+
+// CONST:      [[ONE:[0-9a-f]{32}]] add_one{{$}}
+// CONST-NOT:  [[ONE]]
+// CONST:      add_two{{$}}
+
+// MISSING: error: cannot find symbol missing
+
+#ifdef PAD
+typedef int padding_t;
+
+
+#endif
+
+int add(int a, int b) { return a + b; }
+
+int plus(int lhs, int rhs) { return lhs + rhs; }
+
+int sub(int a, int b) { return a - b; }
+
+int add_one(int a) { return a + 1; }
+
+int add_two(int a) { return a + 2; }
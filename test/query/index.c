@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.mlir && \
+// RUN: %vast-query --build-index=%t.idx %t.mlir && \
+// RUN: %vast-query --index=%t.idx --symbol-users=a --scope=foo | %file-check %s -check-prefix=USERS && \
+// RUN: %vast-query --index=%t.idx --show-symbols=functions | %file-check %s -check-prefix=FUNCS
+
+// USERS: hl.ref in foo
+// USERS-NOT: in main
+
+// FUNCS-DAG: hl.func : foo
+// FUNCS-DAG: hl.func : main
+int foo() {
+    int a;
+    return a;
+}
+
+int main() {
+    int a = 1;
+    return foo() + a;
+}
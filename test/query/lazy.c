@@ -0,0 +1,18 @@
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %s -o %t.mlirbc && \
+// RUN: %vast-query --symbol-users=a --scope=foo %t.mlirbc | %file-check %s && \
+// RUN: printf "symbol-users=a scope=foo\nsymbol-users=a\n" | \
+// RUN: %vast-query --batch=- %t.mlirbc | %file-check %s -check-prefix=BATCH
+
+// CHECK: hl.ref
+// CHECK-NOT: hl.ref
+
+// BATCH-COUNT-3: hl.ref
+int foo() {
+    int a;
+    return a;
+}
+
+int main() {
+    int a = 1;
+    return foo() + a;
+}
@@ -0,0 +1,41 @@
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %s -o %t && \
+// RUN: %vast-query --loops %t | %file-check %s && \
+// RUN: %vast-query --loops --scope=search %t | %file-check %s -check-prefix=SCOPE && \
+// RUN: %vast-query --loops --scope=nest --json %t | %file-check %s -check-prefix=JSON
+
+// Nested loops follow the loop they are in, trip counts of canonical loops
+// are known from their constant bounds and strides.
+// CHECK:      hl.for : depth 0 : trips 10 : exits 0 : {{.*}}loops.c:[[@LINE+13]]
+// CHECK-NEXT: hl.for : depth 1 : trips 4 : exits 0 : {{.*}}loops.c:[[@LINE+13]]
+// CHECK-NEXT: hl.while : depth 0 : exits 1 : {{.*}}loops.c:[[@LINE+21]]
+// CHECK-NEXT: hl.do : depth 0 : exits 0 : {{.*}}loops.c:[[@LINE+26]]
+
+// SCOPE-NOT:  hl.for
+// SCOPE:      hl.while : depth 0 : exits 1
+// SCOPE-NEXT: hl.do : depth 0 : exits 0
+
+// JSON: {"depth":0,"exits":0,"kind":"hl.for",{{.*}}"trip_count":10}
+// JSON: {"depth":1,"exits":0,"kind":"hl.for",{{.*}}"trip_count":4}
+int nest(int *a) {
+    int s = 0;
+    for (int i = 0; i < 10; ++i) {
+        for (int j = 8; j > 0; j -= 2)
+            s += a[i] + j;
+    }
+    return s;
+}
+
+// The return leaves the loop other than by its condition.
+int search(int *a, int n) {
+    int i = 0;
+    while (i < n) {
+        if (a[i] == 0)
+            return i;
+        ++i;
+    }
+
+    do {
+        --n;
+    } while (n > 0);
+    return -1;
+}
@@ -0,0 +1,27 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --match='hl.call(callee=memcpy,operand2!~const)' %t | %file-check %s -check-prefix=DYNAMIC && \
+// RUN: %vast-query --match='hl.call(callee=memcpy,operand2~const)' %t | %file-check %s -check-prefix=FIXED && \
+// RUN: %vast-query --match='hl.assign(operand1~hl.deref(operand0~param))' %t | %file-check %s -check-prefix=STORE && \
+// RUN: %vast-query --match='hl.call(callee=memcpy)' --scope=copy_fixed %t | %file-check %s -check-prefix=SCOPE
+
+void *memcpy(void *dst, const void *src, unsigned long size);
+
+// FIXED:      hl.call @memcpy
+// FIXED-SAME: match.c:[[@LINE+3]]
+// FIXED-NOT:  hl.call
+// SCOPE:      hl.call @memcpy
+// SCOPE-NOT:  hl.call
+void copy_fixed(char *d, const char *s) { memcpy(d, s, 16); }
+
+// DYNAMIC:      hl.call @memcpy
+// DYNAMIC-SAME: match.c:[[@LINE+2]]
+// DYNAMIC-NOT:  hl.call
+void copy_dynamic(char *d, const char *s, unsigned long n) { memcpy(d, s, n); }
+
+// Only the assignment through the pointer parameter matches.
+// STORE:      hl.assign
+// STORE-SAME: match.c:[[@LINE+2]]
+// STORE-NOT:  hl.assign
+void store(int *p, int v) { *p = v; }
+
+void store_local(int v) { int x; x = v; }
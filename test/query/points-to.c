@@ -0,0 +1,70 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --points-to=p --scope=locals %t | %file-check %s -check-prefix=LOCALS && \
+// RUN: %vast-query --points-to=q --scope=locals %t | %file-check %s -check-prefix=RESULT && \
+// RUN: %vast-query --points-to=r --scope=fields %t | %file-check %s -check-prefix=FIELD && \
+// RUN: %vast-query --points-to=t --scope=unions %t | %file-check %s -check-prefix=UNION && \
+// RUN: %vast-query --points-to=z --scope=indirect %t | %file-check %s -check-prefix=INDIRECT && \
+// RUN: %vast-query --points-to=fp --json %t | %file-check %s -check-prefix=JSON && \
+// RUN: not %vast-query --points-to=missing %t 2>&1 | %file-check %s -check-prefix=MISSING
+
+void *malloc(unsigned long size);
+
+// LOCALS-NOT: variable {{a|b}}
+// LOCALS-DAG: variable g : {{.*}}points-to.c:[[@LINE+1]]:
+int g;
+int a, b;
+
+int *pick(int c) { return c ? &a : &b; }
+
+// The address of `g` initializes `p`, and the allocation is stored to `p`
+// through `pp`.
+// LOCALS-DAG: heap malloc : {{.*}}points-to.c:[[@LINE+8]]:
+// LOCALS-NOT: variable {{a|b}}
+// RESULT-DAG: variable a
+// RESULT-DAG: variable b
+// RESULT-NOT: variable g
+void locals(void) {
+    int *p = &g;
+    int *q = pick(1);
+    int *h = malloc(sizeof(int));
+    int **pp = &p;
+    *pp = h;
+}
+
+// Fields of a structure are kept apart.
+// FIELD:     variable b
+// FIELD-NOT: variable a
+struct pair { int *x; int *y; };
+
+void fields(void) {
+    struct pair s;
+    s.x = &a;
+    s.y = &b;
+    int *r = s.y;
+}
+
+// Members of a union share the object of the union.
+// UNION: variable a
+union either { int *x; int *y; };
+
+void unions(void) {
+    union either u;
+    u.x = &a;
+    int *t = u.y;
+}
+
+// The call through the pointer binds the parameter of `same`.
+// INDIRECT:     variable b
+// INDIRECT-NOT: variable a
+int *same(int *x) { return x; }
+
+void indirect(void) {
+    int *(*fn)(int *) = same;
+    int *z = fn(&b);
+}
+
+// JSON: "kind":"function"
+// JSON-SAME: "object":"locals"
+void (*fp)(void) = locals;
+
+// MISSING: error: unknown variable missing
@@ -0,0 +1,27 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --sccs %t | %file-check %s && \
+// RUN: %vast-query --sccs --json %t | %file-check %s -check-prefix=JSON
+
+// Components follow the components they call, and the height is the longest
+// chain of calls into other components.
+
+// CHECK-DAG: scc [[LEAF:[0-9]+]] : height 0 : leaf{{$}}
+// CHECK-DAG: scc {{[0-9]+}} : height 0 : {{odd, even|even, odd}} (recursive)
+// CHECK-DAG: scc {{[0-9]+}} : height 0 : fact (recursive)
+// CHECK:     scc {{[0-9]+}} : height 1 : mid{{$}}
+// CHECK:     scc {{[0-9]+}} : height 2 : top{{$}}
+// CHECK-NOT: scc
+
+// JSON: "functions":["top"],"height":2,"query":"","recursive":false,"scc":
+
+int leaf(int x) { return x + 1; }
+
+int even(int n);
+int odd(int n) { return n ? even(n - 1) : 0; }
+int even(int n) { return n ? odd(n - 1) : 1; }
+
+int fact(int n) { return n ? n * fact(n - 1) : 1; }
+
+int mid(int n) { return leaf(n) * 2; }
+
+int top(int n) { return mid(n) + even(n) + fact(n); }
@@ -0,0 +1,34 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && \
+// RUN: %vast-query --show-symbols=vars --scope=helper %t | %file-check %s && \
+// RUN: %vast-query --show-symbols=vars --scope=main %t | %file-check %s -check-prefix=MAIN && \
+// RUN: %file-check --input-file=%t %s -check-prefix=CALLS
+
+// The scope is the function of the name, not the local variable of main
+// that has the same name.
+// CHECK:     hl.var : helper_local
+// CHECK-NOT: hl.var : local
+
+// MAIN-DAG:  hl.var : helper
+// MAIN-DAG:  hl.var : local
+// MAIN-NOT:  hl.var : helper_local
+
+// Calls of functions declared before and after their use refer to the
+// functions codegen declared.
+// CALLS-LABEL: hl.func @helper
+// CALLS:       hl.call @later
+// CALLS-LABEL: hl.func @main
+// CALLS:       hl.call @later
+int later(int);
+
+int helper(int v) {
+    int helper_local = v;
+    return later(helper_local);
+}
+
+int later(int v) { return v; }
+
+int main(void) {
+    int helper = 1;
+    int local = helper;
+    return later(local);
+}
@@ -0,0 +1,36 @@
+// RUN: rm -rf %t.tables
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-query --export-tables=%t.tables %t
+// RUN: cat %t.tables/functions.csv %t.tables/calls.csv %t.tables/symbol_uses.csv | %file-check %s
+// RUN: %file-check --input-file=%t.tables/ops.csv %s -check-prefix=OPS
+// RUN: %file-check --input-file=%t.tables/types.csv %s -check-prefix=TYPES
+
+// CHECK:     function,name,op,definition,ops
+// CHECK-DAG: [[EXTERN:[0-9]+]],external,[[EXTERN_OP:[0-9]+]],0,1{{$}}
+// CHECK-DAG: [[CALLEE:[0-9]+]],callee,[[CALLEE_OP:[0-9]+]],1,{{[0-9]+}}
+// CHECK-DAG: [[CALLER:[0-9]+]],caller,{{[0-9]+}},1,{{[0-9]+}}
+
+// CHECK:     caller,callee,indirect
+// CHECK-DAG: [[CALLER]],[[CALLEE]],0
+// CHECK-DAG: [[CALLER]],[[EXTERN]],0
+
+// CHECK:     symbol,kind,op,user
+// CHECK-DAG: callee,hl.func,[[CALLEE_OP]],{{[0-9]+}}
+// CHECK-DAG: external,hl.func,[[EXTERN_OP]],{{[0-9]+}}
+
+// The module is the first operation, operations of functions refer to them.
+// OPS:      op,function,parent,kind,file,line,column
+// OPS-NEXT: 0,,,builtin.module,
+// OPS:      {{[0-9]+}},{{[0-9]+}},{{[0-9]+}},hl.call,{{.*}}tables.c,[[@LINE+11]],
+// OPS:      {{[0-9]+}},{{[0-9]+}},{{[0-9]+}},hl.call,{{.*}}tables.c,[[@LINE+11]],
+
+// TYPES:    type,size_bits,align_bits
+// TYPES:    !hl.int,32,32
+
+int external(int);
+
+int callee(int v) { return v + 1; }
+
+int caller(int v) {
+    return callee(v)
+        + external(v);
+}
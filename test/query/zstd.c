@@ -0,0 +1,17 @@
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl -vast-bytecode-zstd %s -o %t.zst
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl -vast-bytecode-zstd=19 %s -o %t.19.zst
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %s -o %t.mlirbc
+// RUN: %vast-query --show-symbols=functions %t.zst | %file-check %s
+// RUN: %vast-query --show-symbols=functions %t.19.zst | %file-check %s
+// RUN: %vast-query --show-symbols=functions %t.mlirbc | %file-check %s
+// RUN: not %vast-opt %t.zst -o /dev/null
+// REQUIRES: zstd
+
+// Compressed modules are read as plain bytecode ones, vast-opt reads only
+// plain modules.
+// CHECK-DAG: func : first
+// CHECK-DAG: func : second
+
+int first(int v) { return v + 1; }
+
+int second(int v) { return first(v) * 2; }
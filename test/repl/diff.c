@@ -0,0 +1,26 @@
+// RUN: printf "load %s\n raise vast-hl-lower-typedefs\n diff\n diff 0 1\n diff 1 1\n exit" | %vast-repl | %file-check %s
+// RUN: printf "load %s\n diff 0 7\n exit" | %vast-repl 2>&1 | %file-check %s -check-prefix=MISSING
+// REQUIRES: repl
+
+// Only the function using the typedef changes when typedefs are lowered.
+// CHECK:     changed: twice
+// CHECK-DAG: {{^  - .*}}num_t
+// CHECK-DAG: {{^  \+ }}
+// CHECK-NOT: changed: plain
+// CHECK:     1 unchanged functions
+
+// Explicit layers give the same diff.
+// CHECK:     changed: twice
+// CHECK-NOT: changed: plain
+// CHECK:     1 unchanged functions
+
+// CHECK-NOT: changed:
+// CHECK:     2 unchanged functions
+
+// MISSING:   error: no live layer 7
+
+typedef int num_t;
+
+num_t twice(num_t v) { return v * 2; }
+
+int plain(int v) { return v + 1; }
@@ -0,0 +1,9 @@
+// RUN: printf "load %s\n materialize add\n exit" | %vast-repl | %file-check %s
+// CHECK: hl.func @add
+// CHECK: hl.add
+// CHECK-NOT: hl.func @main
+// REQUIRES: repl
+
+int add(int a, int b) { return a + b; }
+
+int main(void) { return add(1, 2); }
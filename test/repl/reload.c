@@ -0,0 +1,10 @@
+// RUN: printf "load %s\n show module\n reload\n show module\n exit" | %vast-repl | %file-check %s
+// CHECK: hl.func @add
+// CHECK: reused 2 functions, generated 0
+// CHECK: hl.func @add
+// CHECK: hl.add
+// REQUIRES: repl
+
+int add(int a, int b) { return a + b; }
+
+int main(void) { return add(1, 2); }
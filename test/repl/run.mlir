@@ -0,0 +1,18 @@
+// RUN: printf "load %s\n run add 2 3\n run neg 7\n run add -1 1\n exit" | %vast-repl | %file-check %s
+// CHECK: 5
+// CHECK-NEXT: -7
+// CHECK-NEXT: 0
+// REQUIRES: repl
+
+module {
+  llvm.func @add(%arg0: i32, %arg1: i32) -> i32 {
+    %0 = llvm.add %arg0, %arg1 : i32
+    llvm.return %0 : i32
+  }
+
+  llvm.func @neg(%arg0: i32) -> i32 {
+    %0 = llvm.mlir.constant(0 : i32) : i32
+    %1 = llvm.sub %0, %arg0 : i32
+    llvm.return %1 : i32
+  }
+}
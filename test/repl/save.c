@@ -0,0 +1,25 @@
+// RUN: rm -rf %t.session
+// RUN: printf "load %s\n raise vast-hl-to-ll-cf\n save %t.session\n exit" | %vast-repl | %file-check %s -check-prefix=SAVE
+// RUN: printf "restore %t.session\n show module\n diff\n reload\n show module\n exit" | %vast-repl | %file-check %s -check-prefix=RESTORE
+// RUN: printf "restore %t.session\n exit" | %vast-repl | %file-check %s -check-prefix=AGAIN
+// RUN: printf "restore %t.missing\n exit" | %vast-repl 2>&1 | %file-check %s -check-prefix=MISSING
+// REQUIRES: repl
+
+// SAVE: saved 2 layers to {{.*}}.session
+
+// The top layer is restored with its id, the base layer is loaded once the
+// diff uses it, and the source is parsed again by reload.
+// RESTORE:      restored 2 layers, top layer 1
+// RESTORE:      ll.return
+// RESTORE:      changed: main
+// RESTORE:      0 unchanged functions
+// RESTORE:      reused 0 functions, generated 1
+// RESTORE:      hl.func @main
+// RESTORE:      hl.return
+
+// Restoring leaves the saved session intact.
+// AGAIN: restored 2 layers, top layer 1
+
+// MISSING: error: no saved session in {{.*}}.missing
+
+int main(void) { return 0; }
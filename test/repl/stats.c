@@ -0,0 +1,11 @@
+// RUN: printf "load %s\n time raise vast-hl-to-ll-cf\n stats\n exit" | %vast-repl | %file-check %s
+// CHECK: wall {{[0-9.]+}}s, cpu {{[0-9.]+}}s
+// CHECK: Execution time report
+// CHECK: top layer 1: {{[0-9]+}} ops
+// CHECK: ll {{[0-9]+}}
+// CHECK: layer 0: {{[0-9]+}} ops
+// CHECK: layer 1: {{[0-9]+}} ops
+// CHECK: rss {{[0-9]+}} kB
+// REQUIRES: repl
+
+int main(void) { return 0; }
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t && mkdir %t && cd %t
+// RUN: %vast-front --batch --shared-context -j 2 -c %s -xc %s.driver
+// RUN: %clang batch-shared-a.o batch-shared-a.c.o -o %t/program && (%t/program; test $? -eq 0)
+
+// Both units are compiled by vast within one MLIR context, the types they
+// have in common are uniqued only once.
+struct point { int x, y; };
+
+int dot(struct point a, struct point b) { return a.x * b.x + a.y * b.y; }
+
+struct point scale(struct point p, int k)
+{
+    struct point r = { p.x * k, p.y * k };
+    return r;
+}
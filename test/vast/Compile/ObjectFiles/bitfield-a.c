@@ -0,0 +1,34 @@
+// RUN: %vast-front -c -o %t.vast.o %s && %clang -c -xc %s.driver -o %t.clang.o  && %clang %t.vast.o %t.clang.o -o %t && (%t; test $? -eq 0)
+
+// Layout and accesses of bitfields agree with clang.
+struct flags {
+    unsigned a : 3;
+    unsigned b : 5;
+    int c : 4;
+    int other;
+    unsigned long wide : 40;
+    unsigned char tail : 2;
+};
+
+unsigned get_b(struct flags *f) { return f->b; }
+int get_c(struct flags *f) { return f->c; }
+unsigned long get_wide(struct flags *f) { return f->wide; }
+
+void set_all(struct flags *f, int v) {
+    f->a = v;
+    f->b = v + 1;
+    f->c = -v;
+    f->other = v * 2;
+    f->wide = (unsigned long)v << 32;
+    f->tail = 3;
+}
+
+int increment(struct flags *f) {
+    f->b += 2;
+    return ++f->c;
+}
+
+struct flags make(int v) {
+    struct flags f = { 1, 2, -3, v, 5, 1 };
+    return f;
+}
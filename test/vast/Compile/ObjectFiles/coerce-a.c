@@ -0,0 +1,17 @@
+// RUN: %vast-front -c -o %t.vast.o %s && %clang -c -xc %s.driver -o %t.clang.o  && %clang %t.vast.o %t.clang.o -o %t && (%t; test $? -eq 0)
+
+struct mixed { long a; double d; };
+struct floats { float x, y; };
+struct pointer { int *p; };
+struct packed { char c; short s; int i; };
+
+double take_mixed(struct mixed m) { return m.a + m.d; }
+float take_floats(struct floats f) { return f.x - f.y; }
+int take_pointer(struct pointer p) { return *p.p; }
+int take_packed(struct packed p) { return p.c + p.s + p.i; }
+
+struct mixed make_mixed(long a, double d) { struct mixed m = { a, d }; return m; }
+struct floats make_floats(float x, float y) { struct floats f = { x, y }; return f; }
+struct packed make_packed(int v) { struct packed p = { 1, 2, v }; return p; }
+
+double pass_mixed(struct mixed *m) { return take_mixed(*m); }
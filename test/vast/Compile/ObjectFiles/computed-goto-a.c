@@ -0,0 +1,38 @@
+// RUN: %vast-front -c -o %t.vast.o %s && %clang -c -xc %s.driver -o %t.clang.o  && %clang %t.vast.o %t.clang.o -o %t && (%t; test $? -eq 0)
+
+// A threaded interpreter of a small stack machine.
+int run(const unsigned char *code)
+{
+    static void *ops[] = { &&push, &&add, &&mul, &&dup, &&halt };
+    int stack[16];
+    int sp = 0;
+    goto *ops[*code++];
+
+push:
+    stack[sp++] = *code++;
+    goto *ops[*code++];
+add:
+    sp--;
+    stack[sp - 1] += stack[sp];
+    goto *ops[*code++];
+mul:
+    sp--;
+    stack[sp - 1] *= stack[sp];
+    goto *ops[*code++];
+dup:
+    stack[sp] = stack[sp - 1];
+    sp++;
+    goto *ops[*code++];
+halt:
+    return stack[sp - 1];
+}
+
+int pick(int i)
+{
+    void *target = i ? &&yes : &&no;
+    goto *target;
+yes:
+    return 1;
+no:
+    return 0;
+}
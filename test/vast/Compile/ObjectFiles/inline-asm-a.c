@@ -0,0 +1,23 @@
+// RUN: %vast-front -c -o %t.vast.o %s && %clang -c -xc %s.driver -o %t.clang.o  && %clang %t.vast.o %t.clang.o -o %t && (%t; test $? -eq 0)
+
+int add(int x, int y)
+{
+    asm("addl %1, %0" : "+r"(x) : "r"(y));
+    return x;
+}
+
+unsigned char high(unsigned short in)
+{
+    unsigned char out;
+    asm("movb %h[v], %b0" : "=q"(out) : [v] "q"(in));
+    return out;
+}
+
+void set(int *p) { asm volatile("movl $1, %0" : "=m"(*p)); }
+
+int swap_sub(int x, int y)
+{
+    int a, b;
+    asm("movl %3, %0\n\tmovl %2, %1" : "=&r"(a), "=&r"(b) : "r"(x), "r"(y));
+    return a - b;
+}
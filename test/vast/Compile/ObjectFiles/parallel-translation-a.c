@@ -0,0 +1,17 @@
+// RUN: %vast-front -c -vast-parallel-translation -o %t.vast.o %s && %clang -c -xc %s.driver -o %t.clang.o  && %clang %t.vast.o %t.clang.o -o %t && (%t; test $? -eq 0)
+
+static int square(int a) { return a * a; }
+
+static int twice(int a) { return a + a; }
+
+int identity(int a) { return a; }
+
+int sum_of_squares(int a, int b) { return square(a) + square(b); }
+
+int quadruple(int a) { return twice(twice(a)); }
+
+static int counter = 0;
+
+const char *hello(void) { return "hello"; }
+
+int next(void) { return ++counter; }
@@ -0,0 +1,14 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %vast-front -c -vast-snapshot="hl=%t/a.hl.mlirbc;llvm=%t/a.llvm.mlirbc" %s -o %t/a.o
+// RUN: %vast-opt %t/a.hl.mlirbc | %file-check %s -check-prefix=HL
+// RUN: %vast-opt %t/a.llvm.mlirbc | %file-check %s -check-prefix=LLVM
+// RUN: %clang %t/a.o -o %t/a && (%t/a; test $? -eq 7)
+
+// One run yields the object file and both snapshots.
+// HL:   hl.func @add
+// HL:   hl.add
+// LLVM: llvm.func @add
+// LLVM: llvm.add
+int add(int a, int b) { return a + b; }
+
+int main(void) { return add(3, 4); }
@@ -0,0 +1,22 @@
+// RUN: %vast-front -c -o %t.vast.o %s && %clang -c -xc %s.driver -o %t.clang.o  && %clang %t.vast.o %t.clang.o -o %t && (%t; test $? -eq 0)
+
+struct big { long a, b, c; };
+
+struct big swap(struct big);
+
+struct big make(long x)
+{
+    struct big b = { x, x + 1, x + 2 };
+    return b;
+}
+
+struct big pick(int c, struct big l, struct big r)
+{
+    if (c)
+        return l;
+    return r;
+}
+
+long sum(struct big b) { return b.a + b.b + b.c; }
+
+long round_trip(long x) { return sum(swap(make(x))); }
@@ -0,0 +1,56 @@
+// RUN: %vast-front -c -o %t.vast.o %s && %clang -c -xc %s.driver -o %t.clang.o  && %clang %t.vast.o %t.clang.o -o %t && (%t; test $? -eq 0)
+
+int dense(int num)
+{
+    switch (num) {
+        case 0: return 11;
+        case 1: return 13;
+        case 2: return 17;
+        case 3: return 19;
+        case 4: return 23;
+        case 5: return 29;
+        case 6: return 31;
+        case 7: return 37;
+        case 8: return 41;
+        case 9: return 43;
+        case 10: return 47;
+        case 11: return 53;
+        case 12: return 59;
+        case 13: return 61;
+        case 14: return 67;
+        case 15: return 71;
+        default: return -1;
+    }
+}
+
+int middle(int num)
+{
+    int r = 0;
+    switch (num) {
+        case 1: r += 1;
+        case 2: r += 2;
+        default: r += 4;
+        case 3: r += 8; break;
+        case 4: r += 16;
+    }
+    return r;
+}
+
+int machine(const char *input)
+{
+    int even = 0, odd = 0;
+start:
+    if (*input == 0)
+        goto done;
+    goto even;
+even:
+    even += *input++;
+    if (*input == 0)
+        goto done;
+    goto odd;
+odd:
+    odd += *input++;
+    goto start;
+done:
+    return even - odd;
+}
@@ -0,0 +1,25 @@
+// RUN: %vast-front -c -o %t.vast.o %s && %clang -c -xc %s.driver -o %t.clang.o  && %clang %t.vast.o %t.clang.o -o %t && (%t; test $? -eq 0)
+
+typedef int v4si __attribute__((vector_size(16)));
+typedef float float4 __attribute__((ext_vector_type(4)));
+
+int dot(int a, int b) {
+    v4si x = { a, a + 1, a + 2, a + 3 };
+    v4si y = { b, b + 1, b + 2, b + 3 };
+    v4si p = x * y;
+    return p[0] + p[1] + p[2] + p[3];
+}
+
+int reversed(int i) {
+    v4si x = { 1, 2, 3 };
+    x[3] = 4;
+    v4si r = __builtin_shufflevector(x, x, 3, 2, 1, 0);
+    return r[i];
+}
+
+int scaled(int a, int s) {
+    float4 v = { 1.0f, 2.0f, 3.0f, 4.0f };
+    v = v * (float)s;
+    v += (float)a;
+    return (int)(v[0] + v[3]);
+}
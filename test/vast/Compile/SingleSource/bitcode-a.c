@@ -0,0 +1,13 @@
+// RUN: %vast-front -vast-emit-llvm-bc %s -o %t.bc
+// RUN: %clang -S -emit-llvm %t.bc -o - | %file-check %s
+// RUN: %clang %t.bc -o %t && (%t; test $? -eq 42)
+// RUN: %vast-front -c -emit-llvm %s -o %t.emit.bc
+// RUN: %clang -S -emit-llvm %t.emit.bc -o - | %file-check %s
+// RUN: %vast-front -vast-emit-llvm-bc -flto=thin %s -o %t.thin.bc
+// RUN: %clang -S -emit-llvm %t.thin.bc -o - | %file-check %s
+
+// CHECK: define {{.*}}i32 @answer()
+// CHECK: define {{.*}}i32 @main()
+int answer(void) { return 42; }
+
+int main(void) { return answer(); }
@@ -0,0 +1,23 @@
+// RUN: %vast-front -vast-emit-mlir=llvm -vast-verify-determinism %s -o %t.mlir
+// RUN: %file-check %s -check-prefix=GLOBALS < %t.mlir
+// RUN: %file-check %s -check-prefix=FUNCS < %t.mlir
+// RUN: %vast-front -vast-emit-mlir=llvm -vast-verify-determinism -vast-parallel-printing %s -o %t.parallel.mlir
+// RUN: diff %t.mlir %t.parallel.mlir
+
+// Many functions with string literals, whose globals the pipeline creates
+// while it processes functions in parallel. Both follow the order of the
+// source.
+// GLOBALS: llvm.mlir.global {{.*}}"first\00"
+// GLOBALS: llvm.mlir.global {{.*}}"second\00"
+// GLOBALS: llvm.mlir.global {{.*}}"third\00"
+// GLOBALS: llvm.mlir.global {{.*}}"fourth\00"
+// FUNCS:   llvm.func @one
+// FUNCS:   llvm.func @two
+// FUNCS:   llvm.func @three
+// FUNCS:   llvm.func @four
+const char *one(void) { return "first"; }
+const char *two(void) { return "second"; }
+const char *three(void) { return "third"; }
+const char *four(void) { return "fourth"; }
+
+int main(void) { return one()[0] + two()[0] + three()[0] + four()[0] != 0; }
@@ -0,0 +1,22 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-ir-churn %s -o %t.ll 2> %t.churn
+// RUN: %file-check --input-file=%t.churn %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.plain.ll 2> %t.none
+// RUN: %file-check --input-file=%t.none %s -check-prefix=NONE --allow-empty
+// RUN: diff %t.ll %t.plain.ll
+
+// Passes with patterns report their rewrites, every pass that changed the
+// number of operations reports its net change.
+// CHECK:     IR churn:
+// CHECK-NEXT: {{ +}}created{{ +}}erased{{ +}}replaced{{ +}}modified{{ +}}blocks{{ +}}net ops{{ +}}net blocks  pass
+// CHECK-DAG: {{^ +[1-9][0-9]* +[0-9]+ +[0-9]+ +[0-9]+ +[0-9]+ +-?[0-9]+ +-?[0-9]+}}  vast-irs-to-llvm{{$}}
+// CHECK-DAG: {{^ +[0-9]+ +[0-9]+ +[0-9]+ +[0-9]+ +[0-9]+ +-?[0-9]+ +-?[0-9]+}}  vast-hl-lower-types{{$}}
+
+// NONE-NOT: IR churn
+
+// Counting does not change the output.
+int sum(int *xs, int n) {
+    int acc = 0;
+    for (int i = 0; i < n; ++i)
+        acc += xs[i];
+    return acc;
+}
@@ -0,0 +1,27 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-pattern-stats %s -o %t.ll 2> %t.stats
+// RUN: %file-check --input-file=%t.stats %s
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.plain.ll 2> %t.none
+// RUN: %file-check --input-file=%t.none %s -check-prefix=NONE --allow-empty
+// RUN: diff %t.ll %t.plain.ll
+
+// Passes are reported in the order of their names, each with the patterns
+// that were tried at least once.
+// CHECK:      pattern statistics of vast-hl-lower-types:
+// CHECK-NEXT: {{ +}}attempts{{ +}}succeeded{{ +}}failed{{ +}}time (ms)  pattern
+// CHECK-NEXT: {{ +[1-9][0-9]* +[0-9]+ +[0-9]+ +[0-9]+\.[0-9]{3}  [A-Za-z_]}}
+// CHECK:      pattern statistics of vast-irs-to-llvm:
+// CHECK-NEXT: {{ +}}attempts{{ +}}succeeded{{ +}}failed
+// CHECK-NEXT: {{ +[1-9][0-9]* +[0-9]+ +[0-9]+ +[0-9]+\.[0-9]{3}  [A-Za-z_]}}
+// CHECK-NOT:  {{^ +0 }}
+
+// NONE-NOT: pattern statistics
+
+// Counting does not change the output.
+// LLVM: define {{.*}}i32 @sum
+int sum(int *xs, int n) {
+    int acc = 0;
+    for (int i = 0; i < n; ++i)
+        acc += xs[i];
+    return acc;
+}
@@ -0,0 +1,52 @@
+// RUN: %vast-front -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-emit-abi | %file-check %s -check-prefix=ABI
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// Records larger than two eightbytes are classified as memory.
+struct big { long a, b, c; };
+
+// The return slot is passed before the other arguments.
+// ABI:      abi.func {{.*}} @make(%arg0: !hl.ptr<{{.*}}> {hl.sret}, %arg1: i64) -> ()
+// ABI:      abi.epilogue {
+// ABI-NEXT:   {{.*}} = abi.indirect {{.*}} -> !hl.ptr<{{.*}}>
+// LLVM-LABEL: define {{.*}}void @make(ptr {{.*}}sret(%{{.*}}) {{.*}}%0, i64
+// Every return returns `b`, hence it is constructed in the slot directly.
+// LLVM-NOT:   alloca %
+// LLVM-NOT:   call void @llvm.memcpy
+// LLVM:       ret void
+struct big make(long x)
+{
+    struct big b = { x, x + 1, x + 2 };
+    return b;
+}
+
+// Different values are returned, so each is copied to the slot.
+// LLVM-LABEL: define {{.*}}void @pick(ptr {{.*}}sret(%{{.*}}) {{.*}}%0, i32
+// LLVM:       call void @llvm.memcpy
+// LLVM:       ret void
+struct big pick(int c)
+{
+    struct big l = { 1, 2, 3 };
+    struct big r = { 4, 5, 6 };
+    if (c)
+        return l;
+    return r;
+}
+
+// Arguments in memory are passed `byval`.
+// ABI:      abi.func {{.*}} @sum(%arg0: !hl.ptr<{{.*}}> {hl.byval = {{.*}}}) -> i64
+// LLVM-LABEL: define {{.*}}i64 @sum(ptr {{.*}}byval(%{{.*}}) {{.*}}%0)
+long sum(struct big b) { return b.a + b.b + b.c; }
+
+// The caller allocates the slot, and passes the argument loaded from memory by
+// its address, since `byval` already makes the copy.
+// ABI-LABEL: abi.func {{.*}} @call
+// ABI:       abi.ret_slot : !hl.ptr<{{.*}}>
+// LLVM-LABEL: define {{.*}}i64 @call(
+// LLVM:       call void @make(ptr {{.*}}sret(%{{.*}}) {{.*}}, i64
+// LLVM:       call i64 @sum(ptr {{.*}}byval(%{{.*}})
+long call(long x)
+{
+    struct big b = make(x);
+    return sum(b);
+}
@@ -1,13 +1,31 @@
 // RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-hl-to-lazy-regions --vast-irs-to-llvm --vast-core-to-llvm | %file-check %s
 
+// Loads of parameters are evaluated eagerly, without branches.
+// CHECK-LABEL: llvm.func @fun(
 int fun(int arg1, int arg2) {
     int res = arg1 && arg2;
     // CHECK: [[LHS:%[0-9]+]] = llvm.load [[V1:%[0-9]+]]
+    // CHECK: [[RHS:%[0-9]+]] = llvm.load [[V2:%[0-9]+]]
+    // CHECK-NOT: llvm.cond_br
+    // CHECK: [[LR:%[0-9]+]] = llvm.icmp "ne" [[LHS]], {{%[0-9]+}} : i32
+    // CHECK: [[RR:%[0-9]+]] = llvm.icmp "ne" [[RHS]], {{%[0-9]+}} : i32
+    // CHECK: [[R:%[0-9]+]] = llvm.select [[LR]], [[RR]], {{%[0-9]+}} : i1, i1
+    // CHECK: llvm.zext [[R]] : i1 to i32
+    return res;
+}
+
+// Calls are not evaluated eagerly, hence the operation keeps its branches.
+int g(int);
+
+// CHECK-LABEL: llvm.func @fun_call
+int fun_call(int arg1, int arg2) {
+    int res = arg1 && g(arg2);
+    // CHECK: [[LHS:%[0-9]+]] = llvm.load [[V1:%[0-9]+]]
     // CHECK: [[Z:%[0-9]+]] = llvm.mlir.constant(0 : i32) : i32
     // CHECK: [[LR:%[0-9]+]] = llvm.icmp "ne" [[LHS]], [[Z]] : i32
     // CHECK: llvm.cond_br [[LR]], ^[[TBLOCK:bb[0-9]+]], ^[[RBLOCK:bb[0-9]+]]([[LR]] : i1)
     // CHECK: ^[[TBLOCK]]: // pred: ^[[PRED:bb[0-9]+]]
-    // CHECK: [[RHS:%[0-9]+]] = llvm.load [[V2:%[0-9]+]]
+    // CHECK: [[RHS:%[0-9]+]] = llvm.call @g(
     // CHECK: [[RR:%[0-9]+]] = llvm.icmp "ne" [[RHS]], [[Z]]
     // CHECK: llvm.br ^[[RBLOCK]]([[RR]] : i1)
     // CHECK: ^[[RBLOCK]]([[V3:%[0-9]+]]: i1): // 2 preds: ^[[PRED]], ^[[TBLOCK]]
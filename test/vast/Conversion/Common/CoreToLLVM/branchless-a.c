@@ -0,0 +1,37 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-hl-to-lazy-regions --vast-irs-to-llvm --vast-core-to-llvm | %file-check %s
+
+// CHECK-LABEL: llvm.func @land
+int land(int a, int b) {
+    // CHECK-NOT: llvm.cond_br
+    // CHECK: [[L:%[0-9]+]] = llvm.icmp "ne"
+    // CHECK: [[R:%[0-9]+]] = llvm.icmp "ne"
+    // CHECK: [[F:%[0-9]+]] = llvm.mlir.constant(false) : i1
+    // CHECK: llvm.select [[L]], [[R]], [[F]] : i1, i1
+    return a < b && b < 10;
+}
+
+// CHECK-LABEL: llvm.func @lor
+int lor(int a, int b) {
+    // CHECK-NOT: llvm.cond_br
+    // CHECK: [[T:%[0-9]+]] = llvm.mlir.constant(true) : i1
+    // CHECK: llvm.select {{%[0-9]+}}, [[T]], {{%[0-9]+}} : i1, i1
+    return a || b;
+}
+
+// The shift is poison once it is not smaller than the width, its result is
+// not selected then.
+// CHECK-LABEL: llvm.func @shift
+int shift(unsigned n) {
+    // CHECK-NOT: llvm.cond_br
+    // CHECK:     [[L:%[0-9]+]] = llvm.icmp "ne"
+    // CHECK:     [[R:%[0-9]+]] = llvm.icmp "ne"
+    // CHECK:     llvm.select [[L]], [[R]], {{%[0-9]+}} : i1, i1
+    // CHECK-NOT: llvm.and {{.*}} : i1
+    return n < 32 && (1u << n);
+}
+
+// CHECK-LABEL: llvm.func @div
+int div(int a, int b) {
+    // CHECK: llvm.cond_br
+    return b && a / b;
+}
@@ -1,10 +1,17 @@
 // RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -fwrapv -vast-emit-llvm %s -o %t.wrapv.ll
+// RUN: %file-check --input-file=%t.wrapv.ll %s -check-prefix=WRAPV
 
 // CHECK: llvm.func @fn(%arg0: i32, %arg1: i32) -> i32 {
 int fn(int arg0, int arg1)
 {
-    // CHECK: [[R:%[0-9]+]] = llvm.add [[V1:%[0-9]+]], [[V2:%[0-9]+]] : i32
+    // CHECK: [[R:%[0-9]+]] = llvm.add [[V1:%[0-9]+]], [[V2:%[0-9]+]] {hl.nsw} : i32
     // CHECK: llvm.return [[R]] : i32
+    // LLVM:  add nsw i32
+    // WRAPV: add i32
+    // WRAPV-NOT: nsw
     return arg0 + arg1;
 }
 // CHECK : }
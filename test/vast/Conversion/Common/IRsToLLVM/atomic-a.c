@@ -0,0 +1,50 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK-LABEL: llvm.func @load
+int load(int *p) {
+    // CHECK: llvm.load {{.*}} atomic acquire {alignment = 4 : i64} : !llvm.ptr -> i32
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+// Release loads are undefined, they are weakened to monotonic.
+// CHECK-LABEL: llvm.func @load_release
+int load_release(int *p) {
+    // CHECK: llvm.load {{.*}} atomic monotonic
+    return __atomic_load_n(p, __ATOMIC_RELEASE);
+}
+
+// CHECK-LABEL: llvm.func @store
+void store(_Atomic int *p, int v) {
+    // CHECK: llvm.store {{.*}} atomic release {alignment = 4 : i64} : i32, !llvm.ptr
+    __c11_atomic_store(p, v, __ATOMIC_RELEASE);
+}
+
+// CHECK-LABEL: llvm.func @rmw
+int rmw(int *p, unsigned *u, int v) {
+    // CHECK: llvm.atomicrmw add {{.*}} seq_cst
+    // CHECK: llvm.atomicrmw max {{.*}} acq_rel
+    // CHECK: llvm.atomicrmw umin {{.*}} monotonic
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST)
+         + __atomic_fetch_max(p, v, __ATOMIC_ACQ_REL)
+         + __atomic_fetch_min(u, 1u, __ATOMIC_RELAXED);
+}
+
+// The observed value is stored to `expected` on the failure edge only.
+// CHECK-LABEL: llvm.func @cmpxchg
+_Bool cmpxchg(int *p, int *expected, int desired) {
+    // CHECK: [[X:%[0-9]+]] = llvm.cmpxchg {{.*}} seq_cst acquire
+    // CHECK: [[OLD:%[0-9]+]] = llvm.extractvalue [[X]][0]
+    // CHECK: [[OK:%[0-9]+]] = llvm.extractvalue [[X]][1]
+    // CHECK-NOT: llvm.store
+    // CHECK: llvm.cond_br {{%[0-9]+}}, ^[[FAIL:bb[0-9]+]], ^[[DONE:bb[0-9]+]]
+    // CHECK: ^[[FAIL]]:
+    // CHECK: llvm.store [[OLD]], {{%[0-9]+}}
+    // CHECK: llvm.br ^[[DONE]]
+    return __atomic_compare_exchange_n(p, expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE);
+}
+
+// CHECK-LABEL: llvm.func @cmpxchg_weak
+_Bool cmpxchg_weak(_Atomic int *p, int *expected, int desired) {
+    // CHECK: llvm.cmpxchg weak {{.*}} acq_rel monotonic
+    return __c11_atomic_compare_exchange_weak(p, expected, desired, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,41 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s
+
+// `a`, `b` and `c` share a 16-bit storage unit, as in clang.
+struct flags {
+    unsigned a : 3;
+    unsigned b : 5;
+    int c : 4;
+    int other;
+};
+
+// CHECK-LABEL: define {{.*}}i32 @get_b(ptr
+// CHECK: [[UNIT:%[0-9]+]] = load i16, ptr
+// CHECK: [[SHR:%[0-9]+]] = lshr i16 [[UNIT]], 3
+// CHECK: [[FIELD:%[0-9]+]] = and i16 [[SHR]], 31
+// CHECK: zext i16 [[FIELD]] to i32
+unsigned get_b(struct flags *f) { return f->b; }
+
+// Signed bitfields are extracted by a pair of shifts.
+// CHECK-LABEL: define {{.*}}i32 @get_c(ptr
+// CHECK: [[UNIT:%[0-9]+]] = load i16, ptr
+// CHECK: [[SHL:%[0-9]+]] = shl i16 [[UNIT]], 4
+// CHECK: [[SHR:%[0-9]+]] = ashr i16 [[SHL]], 12
+// CHECK: sext i16 [[SHR]] to i32
+int get_c(struct flags *f) { return f->c; }
+
+// Writes merge the field into the unit by a single read-modify-write.
+// CHECK-LABEL: define {{.*}}void @set_b(ptr
+// CHECK: [[VALUE:%[0-9]+]] = and i16 {{%[0-9]+}}, 31
+// CHECK: [[SHIFTED:%[0-9]+]] = shl i16 [[VALUE]], 3
+// CHECK: [[OLD:%[0-9]+]] = load i16, ptr
+// CHECK: [[CLEARED:%[0-9]+]] = and i16 [[OLD]], -249
+// CHECK: [[NEW:%[0-9]+]] = or i16 [[CLEARED]], [[SHIFTED]]
+// CHECK: store i16 [[NEW]], ptr
+void set_b(struct flags *f, unsigned v) { f->b = v; }
+
+// Fields other than bitfields are addressed by their member.
+// CHECK-LABEL: define {{.*}}i32 @get_other(ptr
+// CHECK: getelementptr inbounds {{.*}}, i32 0, i32 {{[0-9]+}}
+// CHECK: load i32, ptr
+int get_other(struct flags *f) { return f->other; }
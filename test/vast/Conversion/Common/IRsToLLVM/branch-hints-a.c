@@ -0,0 +1,49 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// HL-LABEL: hl.func @expect
+// HL:       hl.branch_weights = #hl.branch_weights<1, 2000>
+// LLVM-LABEL: define {{.*}}i32 @expect(
+// LLVM:       br i1 {{%[0-9]+}}, label %{{[0-9]+}}, label %{{[0-9]+}}, !prof ![[UNLIKELY:[0-9]+]]
+int expect(int x)
+{
+    if (__builtin_expect(x == 0, 0))
+        return -1;
+    return x;
+}
+
+// HL-LABEL: hl.func @unroll
+// HL:       hl.loop_hints = #hl.loop_hints<unroll_count = 4>
+// LLVM-LABEL: define {{.*}}i32 @unroll(
+// LLVM:       br label %{{[0-9]+}}, !llvm.loop ![[UNROLL:[0-9]+]]
+int unroll(int n)
+{
+    int s = 0;
+    #pragma unroll 4
+    for (int i = 0; i < n; ++i)
+        s += i;
+    return s;
+}
+
+// HL-LABEL: hl.func @vectorize
+// HL:       hl.loop_hints = #hl.loop_hints<vectorize = true, vectorize_width = 8>
+// LLVM-LABEL: define {{.*}}void @vectorize(
+// LLVM:       br label %{{[0-9]+}}, !llvm.loop ![[VECTORIZE:[0-9]+]]
+void vectorize(float *a, int n)
+{
+    int i = 0;
+    #pragma clang loop vectorize(enable) vectorize_width(8)
+    while (i < n) {
+        a[i] *= 2;
+        ++i;
+        continue;
+    }
+}
+
+// LLVM-DAG: ![[UNLIKELY]] = !{!"branch_weights", i32 1, i32 2000}
+// LLVM-DAG: ![[UNROLL]] = distinct !{![[UNROLL]], ![[COUNT:[0-9]+]]}
+// LLVM-DAG: ![[COUNT]] = !{!"llvm.loop.unroll.count", i32 4}
+// LLVM-DAG: ![[VECTORIZE]] = distinct !{![[VECTORIZE]], ![[ENABLE:[0-9]+]], ![[WIDTH:[0-9]+]]}
+// LLVM-DAG: ![[ENABLE]] = !{!"llvm.loop.vectorize.enable", i1 true}
+// LLVM-DAG: ![[WIDTH]] = !{!"llvm.loop.vectorize.width", i32 8}
@@ -19,11 +19,11 @@ void ptr_decay_test() {
 // MLIR: llvm.func @ptr_decay_test() {
 // MLIR:   [[A:%[0-9]+]] = llvm.alloca {{.*}} !llvm.array<2 x i32>
 // MLIR:   llvm.alloca {{.*}} !llvm.ptr<i32>
-// MLIR:   llvm.getelementptr [[A]][0] : (!llvm.ptr<array<2 x i32>>) -> !llvm.ptr<i32>
+// MLIR:   llvm.getelementptr inbounds [[A]][0] : (!llvm.ptr<array<2 x i32>>) -> !llvm.ptr<i32>
 // MLIR: }
 
 // LLVM: define void @ptr_decay_test()
 // LLVM:    %1 = alloca [2 x i32]
 // LLVM:    %2 = alloca ptr
-// LLVM:    %3 = getelementptr [2 x i32], ptr %1, i32 0
+// LLVM:    %3 = getelementptr inbounds [2 x i32], ptr %1, i32 0
 // LLVM: }
@@ -0,0 +1,31 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s
+
+// Each eightbyte of the record is a register of its own.
+struct mixed { long a; double d; };
+
+double take(struct mixed m) { return m.d; }
+
+// Pieces of an argument in memory are loaded at their offsets, rather than
+// shifted out of a load of the whole record.
+// CHECK-LABEL: define {{.*}}double @pass(
+// CHECK:       load i64, ptr {{%[0-9]+}}, align 1
+// CHECK:       [[HIGH:%[0-9]+]] = getelementptr inbounds i8, ptr {{%[0-9]+}}, i32 8
+// CHECK:       load double, ptr [[HIGH]], align 1
+// CHECK-NOT:   lshr
+// CHECK:       call double @take(i64 {{%[0-9]+}}, double {{%[0-9]+}})
+double pass(struct mixed *p) { return take(*p); }
+
+// A record of a single pointer is passed in one register.
+struct pointer { int *p; };
+
+int deref(struct pointer p) { return *p.p; }
+
+// A single piece of the register size needs no shifts, truncations or
+// extensions.
+// CHECK-LABEL: define {{.*}}i32 @call_deref(
+// CHECK-NOT:   lshr
+// CHECK-NOT:   trunc
+// CHECK-NOT:   zext
+// CHECK:       call i32 @deref(
+int call_deref(struct pointer *p) { return deref(*p); }
@@ -0,0 +1,40 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s
+
+// Label addresses are their indices counting from one.
+// CHECK-LABEL: define {{.*}}i32 @run(
+// CHECK:       store ptr inttoptr (i64 1 to ptr)
+// CHECK:       store ptr inttoptr (i64 2 to ptr)
+// CHECK:       store ptr inttoptr (i64 3 to ptr)
+
+// Every computed goto dispatches through its own switch, the default is
+// unreachable. Variables are allocated in the entry block, before any label.
+// CHECK:       [[FIRST:%[0-9]+]] = ptrtoint ptr {{%[0-9]+}} to i64
+// CHECK-NEXT:  switch i64 [[FIRST]], label %[[INVALID:[0-9]+]] [
+// CHECK-NEXT:    i64 1, label %[[INC:[0-9]+]]
+// CHECK-NEXT:    i64 2, label %[[DEC:[0-9]+]]
+// CHECK-NEXT:    i64 3, label %[[HALT:[0-9]+]]
+// CHECK-NEXT:  ]
+// CHECK-NOT:   alloca
+// CHECK:       [[SECOND:%[0-9]+]] = ptrtoint ptr {{%[0-9]+}} to i64
+// CHECK-NEXT:  switch i64 [[SECOND]], label %[[INVALID]] [
+// CHECK-NOT:   alloca
+// CHECK:       [[THIRD:%[0-9]+]] = ptrtoint ptr {{%[0-9]+}} to i64
+// CHECK-NEXT:  switch i64 [[THIRD]], label %[[INVALID]] [
+// CHECK:       [[INVALID]]:
+// CHECK-NEXT:  unreachable
+int run(const unsigned char *code)
+{
+    void *ops[] = { &&inc, &&dec, &&halt };
+    int acc = 0;
+    goto *ops[*code++];
+
+inc:
+    acc++;
+    goto *ops[*code++];
+dec:
+    acc--;
+    goto *ops[*code++];
+halt:
+    return acc;
+}
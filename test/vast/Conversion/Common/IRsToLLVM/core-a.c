@@ -0,0 +1,26 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-hl-to-lazy-regions --vast-irs-to-llvm | %file-check %s
+
+// The core operations are lowered by irs-to-llvm itself, without a separate
+// core-to-llvm pass.
+
+int g(int);
+
+// CHECK-LABEL: llvm.func @land
+int land(int a, int b) {
+    // CHECK-NOT: llvm.cond_br
+    // CHECK: llvm.and {{.*}} : i1
+    return a < b && b < 10;
+}
+
+// CHECK-LABEL: llvm.func @lor_call
+int lor_call(int a) {
+    // CHECK: llvm.cond_br
+    // CHECK: llvm.call @g
+    return a || g(a);
+}
+
+// CHECK-LABEL: llvm.func @select
+int select(int c, int a, int b) {
+    // CHECK: llvm.select {{.*}} : i1, i32
+    return c ? a : b;
+}
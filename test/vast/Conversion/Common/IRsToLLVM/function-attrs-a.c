@@ -0,0 +1,40 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s
+
+// CHECK: define {{.*}}void @warm() [[HOT:#[0-9]+]]
+__attribute__((hot)) void warm(void) {}
+
+// CHECK: define {{.*}}void @chill() [[COLD:#[0-9]+]]
+__attribute__((cold, noinline)) void chill(void) {}
+
+// CHECK: define {{.*}}i32 @inlined(i32 {{.*}}) [[ALWAYS:#[0-9]+]]
+__attribute__((always_inline)) static inline int inlined(int x) { return x; }
+
+// CHECK: define {{.*}}i32 @square(i32 {{.*}}) [[NONE:#[0-9]+]]
+__attribute__((const)) int square(int x) { return x * x; }
+
+// CHECK: define {{.*}}i32 @first(ptr {{.*}}) [[READ:#[0-9]+]]
+__attribute__((pure)) int first(const int *p) { return *p; }
+
+static char arena[64];
+
+// CHECK: define {{.*}}noalias ptr @allocate(
+__attribute__((malloc)) void *allocate(void) { return arena; }
+
+// CHECK: define {{.*}}nonnull ptr @base(
+__attribute__((returns_nonnull)) char *base(void) { return arena; }
+
+// Only the listed parameters are nonnull.
+// CHECK: define {{.*}}i32 @second(ptr {{.*}}%0, ptr nonnull {{.*}}%1)
+__attribute__((nonnull(2))) int second(int *a, int *b) { return *b; }
+
+// CHECK: define {{.*}}i32 @both(ptr nonnull {{.*}}%0, ptr nonnull {{.*}}%1)
+__attribute__((nonnull)) int both(int *a, int *b) { return *a + *b; }
+
+int use(int x) { return inlined(x); }
+
+// CHECK-DAG: attributes [[HOT]] = { {{.*}}hot{{.*}} }
+// CHECK-DAG: attributes [[COLD]] = { {{.*}}cold{{.*}}noinline{{.*}} }
+// CHECK-DAG: attributes [[ALWAYS]] = { {{.*}}alwaysinline{{.*}} }
+// CHECK-DAG: attributes [[NONE]] = { {{.*}}memory(none){{.*}} }
+// CHECK-DAG: attributes [[READ]] = { {{.*}}memory(read){{.*}} }
@@ -0,0 +1,30 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-irs-to-llvm | %file-check %s
+
+// CHECK: llvm.mlir.global external @scalar(42 : i32)
+int scalar = 42;
+
+// CHECK: llvm.mlir.global external @sbox(dense<[99, 124, 119, 123, 0, 0, 0, 0]> : tensor<8xi8>)
+unsigned char sbox[8] = { 0x63, 0x7c, 0x77, 0x7b };
+
+// CHECK: llvm.mlir.global external @matrix(dense<{{\[\[}}1, 2], [3, 0]]> : tensor<2x2xi32>)
+int matrix[2][2] = { { 1, 2 }, { 3 } };
+
+// CHECK: llvm.mlir.global external @weights(dense<[5.000000e-01, 2.500000e-01]> : tensor<2xf32>)
+float weights[2] = { 0.5f, 0.25f };
+
+// CHECK: llvm.mlir.global internal @counter(0 : i32)
+static int counter;
+
+// CHECK: llvm.mlir.global external constant @limit(16 : i32)
+const int limit = 16;
+
+// CHECK: llvm.mlir.global internal unnamed_addr constant @table(dense<[1, 2, 4, 8]> : tensor<4xi32>)
+static const int table[4] = { 1, 2, 4, 8 };
+
+// CHECK: llvm.mlir.global internal constant @escaping(7 : i32)
+// CHECK-NOT: unnamed_addr
+static const int escaping = 7;
+
+int lookup(int i) { return table[i] + counter; }
+
+const int *address() { return &escaping; }
@@ -0,0 +1,34 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-irs-to-llvm | %file-check %s
+
+// CHECK-DAG: llvm.mlir.global external @plain(1 : i32)
+int plain = 1;
+
+// CHECK-DAG: llvm.mlir.global internal @hidden(2 : i32)
+static int hidden = 2;
+
+// CHECK-DAG: llvm.mlir.global external constant @shared(3 : i32)
+const int shared = 3;
+
+// Internal constants that are only loaded can be merged with other
+// read-only data.
+// CHECK-DAG: llvm.mlir.global internal unnamed_addr constant @merged(4 : i32)
+static const int merged = 4;
+
+// CHECK-DAG: llvm.mlir.global internal unnamed_addr constant @lut(dense<[1, 2]> : tensor<2xi32>)
+static const int lut[2] = { 1, 2 };
+
+// CHECK-DAG: llvm.mlir.global internal constant @escapes(5 : i32)
+static const int escapes = 5;
+
+// Declarations have neither a value nor an initializer region.
+// CHECK-DAG: llvm.mlir.global external @declared() {{.*}}: i32{{$}}
+extern int declared;
+
+// CHECK-DAG: llvm.mlir.global external constant @declared_constant() {{.*}}: i32{{$}}
+extern const int declared_constant;
+
+int read(int i) {
+    return plain + hidden + shared + merged + lut[i] + declared + declared_constant;
+}
+
+const int *address() { return &escapes; }
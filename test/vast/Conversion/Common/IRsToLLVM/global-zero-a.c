@@ -0,0 +1,48 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-irs-to-llvm | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+struct pair { int a; long b; };
+
+// Tentative definitions are zero.
+// CHECK-DAG: llvm.mlir.global external @tentative(0 : i32)
+// LLVM-DAG:  @tentative = global i32 0
+int tentative;
+
+// Zero initializers are detected before the initializer is folded, hence an
+// initializer list of zeros gets a splat rather than every element.
+// CHECK-DAG: llvm.mlir.global external @zeros(dense<0> : tensor<4xi32>)
+// LLVM-DAG:  @zeros = global [4 x i32] zeroinitializer
+int zeros[4] = { 0, 0, 0, 0 };
+
+// CHECK-DAG: llvm.mlir.global external @partial(dense<0> : tensor<8xi8>)
+char partial[8] = { 0 };
+
+// CHECK-DAG: llvm.mlir.global external @real(0.000000e+00 : f64)
+double real = 0;
+
+// Negative zero is not all zero bits, it is folded instead.
+// CHECK-DAG: llvm.mlir.global external @negative(-0.000000e+00 : f64)
+double negative = -0.0;
+
+// Initializers with other values are still folded.
+// CHECK-DAG: llvm.mlir.global external @mixed(dense<[0, 1]> : tensor<2xi32>)
+int mixed[2] = { 0, 1 };
+
+// Records and arrays of records are zeroed bytes with the alignment of the
+// record.
+// CHECK-DAG: llvm.mlir.global external @record(dense<0> : tensor<16xi8>) {{.*}}alignment = 8 : i64{{.*}} : !llvm.array<16 x i8>
+// LLVM-DAG:  @record = global [16 x i8] zeroinitializer, align 8
+struct pair record;
+
+// CHECK-DAG: llvm.mlir.global internal @records(dense<0> : tensor<48xi8>) {{.*}}alignment = 8 : i64{{.*}} : !llvm.array<48 x i8>
+// LLVM-DAG:  @records = internal global [48 x i8] zeroinitializer, align 8
+static struct pair records[3] = { { 0, 0 } };
+
+// References to the bytes are cast to the record.
+// CHECK-LABEL: llvm.func @read
+// CHECK:       [[BYTES:%[0-9]+]] = llvm.mlir.addressof @record : !llvm.ptr<array<16 x i8>>
+// CHECK:       llvm.bitcast [[BYTES]] : !llvm.ptr<array<16 x i8>> to !llvm.ptr<struct<"pair"
+// CHECK:       [[ARRAY:%[0-9]+]] = llvm.mlir.addressof @records : !llvm.ptr<array<48 x i8>>
+// CHECK:       llvm.bitcast [[ARRAY]] : !llvm.ptr<array<48 x i8>> to !llvm.ptr<array<3 x struct<"pair"
+long read(int i) { return record.b + records[i].a; }
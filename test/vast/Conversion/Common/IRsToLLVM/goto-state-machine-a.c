@@ -0,0 +1,30 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// Blocks of the labels stay in the order of the source: the entry branches to
+// the first label, the loop back to it comes from the last state, and the
+// return is in the block of the last label.
+// CHECK-LABEL: llvm.func @machine
+// CHECK:       llvm.br ^[[START:bb[0-9]+]]
+// CHECK:       ^[[START]]:
+// CHECK:       llvm.br ^[[START]]
+// CHECK:       llvm.return
+// CHECK-NOT:   llvm.br
+// CHECK:       }
+int machine(const char *input)
+{
+    int even = 0, odd = 0;
+start:
+    if (*input == 0)
+        goto done;
+    goto even;
+even:
+    even += *input++;
+    if (*input == 0)
+        goto done;
+    goto odd;
+odd:
+    odd += *input++;
+    goto start;
+done:
+    return even - odd;
+}
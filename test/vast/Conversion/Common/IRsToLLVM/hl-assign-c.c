@@ -1,4 +1,6 @@
 // RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
 
 void count()
 {
@@ -9,13 +11,15 @@ void count()
     int x = 1;
     // CHECK: [[V3:%[0-9]+]] = llvm.mlir.constant(2 : i32) : i32
     // CHECK: [[V4:%[0-9]+]] = llvm.load [[V1]] : !llvm.ptr<i32>
-    // CHECK: [[V5:%[0-9]+]] = llvm.sub [[V4]], [[V3]]  : i32
+    // CHECK: [[V5:%[0-9]+]] = llvm.sub [[V4]], [[V3]] {hl.nsw} : i32
     // CHECK: llvm.store [[V5]], [[V1]] : !llvm.ptr<i32>
+    // LLVM:  sub nsw i32 {{%[0-9]+}}, 2
     x -= 2;
     // CHECK: [[V6:%[0-9]+]] = llvm.load [[V1]] : !llvm.ptr<i32>
     // CHECK: [[V7:%[0-9]+]] = llvm.load [[V1]] : !llvm.ptr<i32>
-    // CHECK: [[V8:%[0-9]+]] = llvm.sub [[V7]], [[V6]]  : i32
+    // CHECK: [[V8:%[0-9]+]] = llvm.sub [[V7]], [[V6]] {hl.nsw} : i32
     // CHECK: llvm.store [[V8]], [[V1]] : !llvm.ptr<i32>
+    // LLVM:  sub nsw i32
     x -= x;
 
     // CHECK: llvm.return
@@ -0,0 +1,28 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK: llvm.mlir.global internal constant @vast.init.constant_1(dense<{{.*}}> : tensor<20xi32>)
+
+struct pair { int a; int b; };
+
+void tables()
+{
+    // CHECK: "llvm.intr.memset"
+    // CHECK-NOT: llvm.store
+    int zeroes[1024] = { 0 };
+
+    // CHECK: [[G:%[0-9]+]] = llvm.mlir.addressof @vast.init.constant_1
+    // CHECK: "llvm.intr.memcpy"({{.*}}, [[G]]
+    int values[20] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 };
+}
+
+void copy(struct pair *dst, struct pair *src)
+{
+    // CHECK: "llvm.intr.memcpy"
+    *dst = *src;
+}
+
+int aligned(int *p)
+{
+    // CHECK: llvm.load {{.*}} {alignment = 4 : i64} : !llvm.ptr<i32>
+    return *p;
+}
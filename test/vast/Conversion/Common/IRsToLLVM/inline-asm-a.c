@@ -0,0 +1,48 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s
+
+// Basic asm is volatile, its template has no operands to rewrite.
+// CHECK-LABEL: define {{.*}}void @trap(
+// CHECK: call void asm sideeffect "int $$3", "~{dirflag},~{fpsr},~{flags}"()
+void trap(void) { asm("int $3"); }
+
+// Read-write outputs are read by inputs tied to them, after the other inputs.
+// CHECK-LABEL: define {{.*}}i32 @add(
+// CHECK: [[RES:%[0-9]+]] = call i32 asm "addl $1, $0", "=r,r,0,~{dirflag},~{fpsr},~{flags}"(i32 {{%[0-9]+}}, i32 {{%[0-9]+}})
+// CHECK: store i32 [[RES]], ptr
+int add(int x, int y)
+{
+    asm("addl %1, %0" : "+r"(x) : "r"(y));
+    return x;
+}
+
+// Named operands are numbered, modifiers are kept.
+// CHECK-LABEL: define {{.*}}i8 @high(
+// CHECK: call i8 asm "movb ${1:h}, ${0:b}", "=q,q,~{dirflag},~{fpsr},~{flags}"(i16 {{%[0-9]+}})
+unsigned char high(unsigned short in)
+{
+    unsigned char out;
+    asm("movb %h[v], %b0" : "=q"(out) : [v] "q"(in));
+    return out;
+}
+
+// Outputs that can be in memory are passed by address, with their type.
+// CHECK-LABEL: define {{.*}}void @set(
+// CHECK: call void asm sideeffect "movl $$1, $0", "=*m,~{dirflag},~{fpsr},~{flags}"(ptr elementtype(i32) {{%[0-9]+}})
+void set(int *p) { asm volatile("movl $1, %0" : "=m"(*p)); }
+
+// CHECK-LABEL: define {{.*}}void @fence(
+// CHECK: call void asm sideeffect "", "~{memory},~{eax},~{dirflag},~{fpsr},~{flags}"()
+void fence(void) { asm volatile("" ::: "memory", "%eax"); }
+
+// Several register outputs are returned as a literal struct.
+// CHECK-LABEL: define {{.*}}i32 @both(
+// CHECK: [[PAIR:%[0-9]+]] = call { i32, i32 } asm "movl $2, $0\0Amovl $3, $1", "=r,=r,r,r,~{dirflag},~{fpsr},~{flags}"
+// CHECK: extractvalue { i32, i32 } [[PAIR]], 0
+// CHECK: extractvalue { i32, i32 } [[PAIR]], 1
+int both(int x, int y)
+{
+    int a, b;
+    asm("movl %2, %0\nmovl %3, %1" : "=r"(a), "=r"(b) : "r"(x), "r"(y));
+    return a - b;
+}
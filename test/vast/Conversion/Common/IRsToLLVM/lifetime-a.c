@@ -0,0 +1,24 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+void use(int *);
+
+// CHECK: llvm.func @loop
+void loop(int n)
+{
+    // CHECK: [[A:%[0-9]+]] = llvm.alloca {{.*}} x i32
+    // CHECK: [[B:%[0-9]+]] = llvm.alloca {{.*}} x i32
+    // CHECK: llvm.br
+    // CHECK: llvm.intr.lifetime.start 4, [[A]]
+    // CHECK: llvm.intr.lifetime.end 4, [[A]]
+    // CHECK: llvm.intr.lifetime.start 4, [[B]]
+    // CHECK: llvm.intr.lifetime.end 4, [[B]]
+    while (n--) {
+        int a = n;
+        use(&a);
+    }
+
+    while (n++) {
+        int b = n;
+        use(&b);
+    }
+}
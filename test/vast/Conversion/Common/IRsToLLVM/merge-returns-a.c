@@ -0,0 +1,22 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="merge-returns=true" | %file-check %s
+
+// CHECK-LABEL: llvm.func @sign
+int sign(int x) {
+    // CHECK-NOT: llvm.return
+    // CHECK: llvm.br ^[[EXIT:bb[0-9]+]]
+    // CHECK-NOT: llvm.return
+    // CHECK: ^[[EXIT]]([[V:%[0-9]+]]: i32):
+    // CHECK-NEXT: llvm.return [[V]] : i32
+    if (x < 0)
+        return -1;
+    if (x > 0)
+        return 1;
+    return 0;
+}
+
+// CHECK-LABEL: llvm.func @single
+int single(int x) {
+    // CHECK-NOT: llvm.br
+    // CHECK: llvm.return
+    return x;
+}
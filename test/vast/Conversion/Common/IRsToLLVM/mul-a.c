@@ -3,7 +3,7 @@
 // CHECK: llvm.func @fn(%arg0: i32, %arg1: i32) -> i32 {
 int fn(int arg0, int arg1)
 {
-    // CHECK: [[R:%[0-9]+]] = llvm.mul [[V1:%[0-9]+]], [[V2:%[0-9]+]] : i32
+    // CHECK: [[R:%[0-9]+]] = llvm.mul [[V1:%[0-9]+]], [[V2:%[0-9]+]] {hl.nsw} : i32
     // CHECK: llvm.return [[R]] : i32
     return arg0 * arg1;
 }
@@ -0,0 +1,36 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+int step(int n, int acc);
+
+// Only the call of the return is marked, not the calls of its arguments.
+// HL-LABEL: hl.func @count
+// HL:       hl.call @step({{.*}}) : {{.*}}{{$}}
+// HL:       hl.call @step({{.*}}) {hl.musttail} :
+// LLVM-LABEL: define {{.*}}i32 @count(
+// LLVM:       [[ARG:%[0-9]+]] = call i32 @step(
+// LLVM:       [[RES:%[0-9]+]] = musttail call i32 @step(i32 {{%[0-9]+}}, i32 [[ARG]])
+// LLVM-NEXT:  ret i32 [[RES]]
+int count(int n, int acc)
+{
+    if (n == 0)
+        return acc;
+    __attribute__((musttail)) return step(n - 1, step(0, acc + 1));
+}
+
+// LLVM-LABEL: define {{.*}}void @dispatch(
+// LLVM:       musttail call void @finish(i32
+// LLVM-NEXT:  ret void
+void finish(int);
+void dispatch(int op) { __attribute__((musttail)) return finish(op); }
+
+// A call returning in memory is passed the return slot of its caller.
+struct big { long a, b, c; };
+struct big build(long);
+
+// LLVM-LABEL: define {{.*}}void @forward(ptr {{.*}}sret(%{{.*}}) {{.*}}[[SLOT:%[0-9]+]], i64
+// LLVM-NOT:   alloca %
+// LLVM:       musttail call void @build(ptr {{.*}}sret(%{{.*}}) {{.*}}[[SLOT]], i64
+// LLVM-NEXT:  ret void
+struct big forward(long x) { __attribute__((musttail)) return build(x); }
@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK: llvm.func @copy(%arg0: !llvm.ptr<i32> {llvm.noalias}, %arg1: !llvm.ptr<i32> {llvm.noalias, llvm.readonly})
+void copy(int * restrict dst, const int * restrict src)
+{
+    *dst = *src;
+}
+
+// CHECK: llvm.func @sum(%arg0: !llvm.ptr<i32> {llvm.readonly}, %arg1: i32) -> i32
+int sum(const int *a, int n)
+{
+    return a[0] + a[n];
+}
+
+// CHECK: llvm.func @store(%arg0: !llvm.ptr<i32>)
+void store(int *p)
+{
+    *p = 0;
+}
@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+// CHECK-DAG: llvm.mlir.global private unnamed_addr constant @vast.strlit.constant_1("first\00")
+// CHECK-DAG: llvm.mlir.global private unnamed_addr constant @vast.strlit.constant_2("second\00")
+// CHECK-NOT: @vast.strlit.constant_3
+
+const char *log(int i)
+{
+    const char *a = "first";
+    const char *b = "second";
+    const char *c = "first";
+    return i ? a : c;
+}
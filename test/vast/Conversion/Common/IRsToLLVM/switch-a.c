@@ -0,0 +1,14 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s
+
+int fn(int num)
+{
+    // CHECK: llvm.switch [[V:%[0-9]+]] : i32, ^[[DEFAULT:bb[0-9]+]] [
+    // CHECK-NEXT: 1: ^[[ONE:bb[0-9]+]],
+    // CHECK-NEXT: 2: ^[[TWO:bb[0-9]+]]
+    // CHECK-NEXT: ]
+    switch (num) {
+        case 1: return 10;
+        case 2: return 20;
+        default: return 0;
+    }
+}
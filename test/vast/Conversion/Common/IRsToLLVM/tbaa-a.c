@@ -0,0 +1,21 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm="emit-tbaa=true" | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-cf --vast-hl-to-ll-vars --vast-irs-to-llvm | %file-check %s --check-prefix=NOTBAA
+
+// CHECK-DAG: #[[ROOT:tbaa_root[0-9]*]] = #llvm.tbaa_root<id = "vast tbaa">
+// CHECK-DAG: #[[CHAR:tbaa_type_desc[0-9]*]] = #llvm.tbaa_type_desc<id = "omnipotent char", members = {<#[[ROOT]], 0>}>
+// CHECK-DAG: #[[INT:tbaa_type_desc[0-9]*]] = #llvm.tbaa_type_desc<id = "int32", members = {<#[[CHAR]], 0>}>
+// CHECK-DAG: #[[FLOAT:tbaa_type_desc[0-9]*]] = #llvm.tbaa_type_desc<id = "float32", members = {<#[[CHAR]], 0>}>
+// CHECK-DAG: #[[INT_TAG:tbaa_tag[0-9]*]] = #llvm.tbaa_tag<base_type = #[[INT]], access_type = #[[INT]], offset = 0>
+// CHECK-DAG: #[[FLOAT_TAG:tbaa_tag[0-9]*]] = #llvm.tbaa_tag<base_type = #[[FLOAT]], access_type = #[[FLOAT]], offset = 0>
+
+// NOTBAA-NOT: tbaa
+
+void fn(int *i, float *f)
+{
+    // CHECK: llvm.store {{.*}} {tbaa = [#[[INT_TAG]]]} : i32
+    *i = 1;
+    // CHECK: llvm.store {{.*}} {tbaa = [#[[FLOAT_TAG]]]} : f32
+    *f = 2.0f;
+    // CHECK: llvm.store {{.*}} {tbaa = [#[[INT_TAG]]]} : i32
+    int v = 3;
+}
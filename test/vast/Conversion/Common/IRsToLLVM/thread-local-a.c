@@ -0,0 +1,44 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=EXE
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -pic-level 2 -pic-is-pie -vast-emit-llvm %s -o %t.pie.ll
+// RUN: %file-check --input-file=%t.pie.ll %s -check-prefix=EXE
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -pic-level 2 -vast-emit-llvm %s -o %t.pic.ll
+// RUN: %file-check --input-file=%t.pic.ll %s -check-prefix=PIC
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -pic-level 2 -ftls-model=initial-exec -vast-emit-llvm %s -o %t.ie.ll
+// RUN: %file-check --input-file=%t.ie.ll %s -check-prefix=IE
+
+// HL:  hl.var "defined" {{.*}}hl.tls_model = "localexec"
+// EXE: @defined = thread_local(localexec) global i32 1
+// PIC: @defined = thread_local global i32 1
+// IE:  @defined = thread_local(initialexec) global i32 1
+_Thread_local int defined = 1;
+
+// EXE: @internal = internal thread_local(localexec) global i32 0
+// PIC: @internal = internal thread_local(localdynamic) global i32 0
+// IE:  @internal = internal thread_local(initialexec) global i32 0
+static __thread int internal;
+
+// EXE: @hidden = {{.*}}thread_local(localexec) global i32 2
+// PIC: @hidden = {{.*}}thread_local(localdynamic) global i32 2
+__attribute__((visibility("hidden"))) __thread int hidden = 2;
+
+// Variables defined elsewhere are reached through the got in executables.
+// EXE: @external = external thread_local(initialexec) global i32
+// PIC: @external = external thread_local global i32
+// IE:  @external = external thread_local(initialexec) global i32
+extern _Thread_local int external;
+
+// The attribute can only make the model more specific.
+// EXE: @strengthened = thread_local(localexec) global i32 3
+// PIC: @strengthened = thread_local(initialexec) global i32 3
+__thread int strengthened __attribute__((tls_model("initial-exec"))) = 3;
+
+// EXE: @kept = thread_local(localexec) global i32 4
+// PIC: @kept = thread_local(localdynamic) global i32 4
+__thread int kept __attribute__((tls_model("local-dynamic"))) = 4;
+
+// PIC: @exec = thread_local(localexec) global i32 0
+__thread int exec __attribute__((tls_model("local-exec")));
+
+int sum(void) { return defined + internal + hidden + external + strengthened + kept + exec; }
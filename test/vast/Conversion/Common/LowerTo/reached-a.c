@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=std %s -o %t.std.mlir
+// RUN: %vast-opt --lower-to=llvm --lower-option=-vast-print-pipeline %t.std.mlir -o %t.llvm.mlir 2> %t.pipeline
+// RUN: %file-check --input-file=%t.pipeline %s -check-prefix=PIPELINE
+// RUN: %file-check --input-file=%t.llvm.mlir %s
+// RUN: %vast-opt --lower-to=std --lower-option=-vast-print-pipeline %t.std.mlir -o /dev/null 2>&1 | %file-check --allow-empty %s -check-prefix=REACHED
+
+// The std module is lowered without the reduction of the high-level dialect
+// and the standard types.
+// PIPELINE-NOT: vast-hl-dead-decls
+// PIPELINE-NOT: vast-hl-lower-types
+// PIPELINE:     vast-irs-to-llvm
+
+// REACHED-NOT:  vast-hl-lower-types
+// REACHED-NOT:  vast-irs-to-llvm
+
+// CHECK:     vast.reached_dialect = "llvm"
+// CHECK:     llvm.func @sum
+// CHECK-NOT: hl.func
+int sum(int a, int b) { return a + b; }
@@ -0,0 +1,15 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.mlir
+// RUN: %vast-opt --vast-hl-to-func-pdll %t.mlir | %file-check %s
+// RUN: %vast-opt --vast-hl-to-func-pdll --vast-hl-to-func-pdll %t.mlir | %file-check %s
+// REQUIRES: pdll
+
+// One sweep converts every function, a second instance of the pass in the
+// same context reuses the compiled patterns and finds nothing to convert.
+// CHECK-NOT: hl.func
+// CHECK:     func.func
+// CHECK:     func.func
+// CHECK-NOT: hl.func
+
+int first(int v) { return v; }
+
+int second(int v) { return first(v); }
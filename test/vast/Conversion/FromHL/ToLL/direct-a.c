@@ -0,0 +1,15 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll="direct-simple-functions=true" | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll="direct-simple-functions=true" --vast-irs-to-llvm | %file-check %s --check-prefix=LLVM
+
+// CHECK: hl.func @add
+// CHECK: hl.return
+// LLVM: llvm.func @add
+int add(int a, int b) { return a + b; }
+
+// CHECK: ll.func @scale
+// CHECK: ll.uninitialized_var
+// LLVM: llvm.func @scale
+int scale(int *p, int n) {
+    int r = *p * n;
+    return r;
+}
@@ -0,0 +1,25 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types > %t
+// RUN: %vast-opt %t --vast-hl-to-ll-func --vast-hl-to-ll-vars --vast-hl-to-ll-cf --vast-hl-to-lazy-regions --vast-hl-to-ll-geps > %t.staged
+// RUN: %vast-opt %t --vast-hl-to-ll | diff -B %t.staged -
+// RUN: %vast-opt %t --vast-hl-to-ll | %file-check %s
+
+struct point { int x, y; };
+
+int flag = 1 && 2;
+
+// CHECK: ll.func @sum
+int sum(struct point *p, int n) {
+    // CHECK: ll.uninitialized_var
+    int acc = 0;
+    // CHECK: ll.scope
+    for (int i = 0; i < n; ++i) {
+        // CHECK: core.bin.lor
+        if (p[i].x > 0 || p[i].y > 0)
+            // CHECK: ll.gep
+            acc += p[i].x;
+        else
+            break;
+    }
+    // CHECK: ll.return
+    return acc;
+}
@@ -0,0 +1,26 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types > %t
+// RUN: %vast-opt %t --vast-hl-to-ll-func --vast-hl-to-ll-vars --vast-hl-to-ll-cf --vast-hl-to-lazy-regions --vast-hl-to-ll-geps --vast-irs-to-llvm -mlir-timing -mlir-timing-display=tree -o %t.llvm.mlir 2> %t.timing
+// RUN: %file-check --input-file=%t.timing %s
+
+// The data layout is computed by the first pass that asks for it and the
+// record layouts by the member access pass, later passes reuse them.
+// CHECK:     HLToLLVars
+// CHECK:     (A) mlir::DataLayoutAnalysis
+// CHECK-NOT: (A) mlir::DataLayoutAnalysis
+// CHECK:     HLToLLGEPs
+// CHECK:     (A) vast::hl::record_layout_cache
+// CHECK-NOT: (A) mlir::DataLayoutAnalysis
+// CHECK:     IRsToLLVM
+// CHECK-NOT: (A) mlir::DataLayoutAnalysis
+// CHECK-NOT: (A) vast::hl::record_layout_cache
+
+struct point { int x, y; };
+
+int sum(struct point *p, int n) {
+    int acc = 0;
+    for (int i = 0; i < n; ++i) {
+        if (p[i].x > 0 || p[i].y > 0)
+            acc += p[i].x;
+    }
+    return acc;
+}
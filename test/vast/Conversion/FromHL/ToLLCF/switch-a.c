@@ -0,0 +1,24 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll-cf | %file-check %s
+
+int fn(int num)
+{
+    int r = 0;
+    // CHECK: ll.switch [[V:%[0-9]+]] : si32, ^[[DEFAULT:bb[0-9]+]] [1 : i32, 2 : i32, 3 : i32] : [^[[ONE:bb[0-9]+]], ^[[TWO:bb[0-9]+]], ^[[THREE:bb[0-9]+]]]
+    switch (num) {
+        // CHECK: ^[[ONE]]:
+        // CHECK: ll.br ^[[TWO]]
+        case 1:
+        // CHECK: ^[[TWO]]:
+        // CHECK: ll.br ^[[TAIL:bb[0-9]+]]
+        case 2: r = 2; break;
+        // CHECK: ^[[THREE]]:
+        // CHECK: ll.br ^[[DEFAULT]]
+        case 3: r = 3;
+        // CHECK: ^[[DEFAULT]]:
+        // CHECK: ll.br ^[[TAIL]]
+        default: r += 1;
+    }
+    // CHECK: ^[[TAIL]]:
+    // CHECK: ll.return
+    return r;
+}
@@ -0,0 +1,65 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll-cf | %file-check %s
+
+// Cases of a large dense switch keep their values, and their blocks stay in
+// the order of the source.
+int dense(int num)
+{
+    int r = 0;
+    // CHECK: ll.switch [[V:%[0-9]+]] : si32, ^[[DEFAULT:bb[0-9]+]] [0 : i32, 1 : i32, 2 : i32, 3 : i32, 4 : i32, 5 : i32, 6 : i32, 7 : i32, 8 : i32, 9 : i32, 10 : i32, 11 : i32, 12 : i32, 13 : i32, 14 : i32, 15 : i32] : [^[[C0:bb[0-9]+]], ^[[C1:bb[0-9]+]], ^[[C2:bb[0-9]+]], ^[[C3:bb[0-9]+]], ^[[C4:bb[0-9]+]], ^[[C5:bb[0-9]+]], ^[[C6:bb[0-9]+]], ^[[C7:bb[0-9]+]], ^[[C8:bb[0-9]+]], ^[[C9:bb[0-9]+]], ^[[C10:bb[0-9]+]], ^[[C11:bb[0-9]+]], ^[[C12:bb[0-9]+]], ^[[C13:bb[0-9]+]], ^[[C14:bb[0-9]+]], ^[[C15:bb[0-9]+]]]
+    switch (num) {
+        // CHECK: ^[[C0]]:
+        // CHECK: ll.br ^[[TAIL:bb[0-9]+]]
+        case 0: r = 1; break;
+        // CHECK: ^[[C1]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 1: r = 4; break;
+        // CHECK: ^[[C2]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 2: r = 7; break;
+        // CHECK: ^[[C3]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 3: r = 10; break;
+        // CHECK: ^[[C4]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 4: r = 13; break;
+        // CHECK: ^[[C5]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 5: r = 16; break;
+        // CHECK: ^[[C6]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 6: r = 19; break;
+        // CHECK: ^[[C7]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 7: r = 22; break;
+        // CHECK: ^[[C8]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 8: r = 25; break;
+        // CHECK: ^[[C9]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 9: r = 28; break;
+        // CHECK: ^[[C10]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 10: r = 31; break;
+        // CHECK: ^[[C11]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 11: r = 34; break;
+        // CHECK: ^[[C12]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 12: r = 37; break;
+        // CHECK: ^[[C13]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 13: r = 40; break;
+        // CHECK: ^[[C14]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 14: r = 43; break;
+        // CHECK: ^[[C15]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 15: r = 46; break;
+        // CHECK: ^[[DEFAULT]]:
+        // CHECK: ll.br ^[[TAIL]]
+        default: r = -1;
+    }
+    // CHECK: ^[[TAIL]]:
+    // CHECK: ll.return
+    return r;
+}
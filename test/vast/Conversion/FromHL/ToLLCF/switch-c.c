@@ -0,0 +1,29 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll-cf | %file-check %s
+
+// The default label in the middle of the switch keeps its position, cases
+// before it fall through to it and it falls through to the case after it.
+int middle(int num)
+{
+    int r = 0;
+    // CHECK: ll.switch [[V:%[0-9]+]] : si32, ^[[DEFAULT:bb[0-9]+]] [1 : i32, 2 : i32, 3 : i32, 4 : i32] : [^[[ONE:bb[0-9]+]], ^[[TWO:bb[0-9]+]], ^[[THREE:bb[0-9]+]], ^[[FOUR:bb[0-9]+]]]
+    switch (num) {
+        // CHECK: ^[[ONE]]:
+        // CHECK: ll.br ^[[TWO]]
+        case 1: r += 1;
+        // CHECK: ^[[TWO]]:
+        // CHECK: ll.br ^[[DEFAULT]]
+        case 2: r += 2;
+        // CHECK: ^[[DEFAULT]]:
+        // CHECK: ll.br ^[[THREE]]
+        default: r += 4;
+        // CHECK: ^[[THREE]]:
+        // CHECK: ll.br ^[[TAIL:bb[0-9]+]]
+        case 3: r += 8; break;
+        // CHECK: ^[[FOUR]]:
+        // CHECK: ll.br ^[[TAIL]]
+        case 4: r += 16;
+    }
+    // CHECK: ^[[TAIL]]:
+    // CHECK: ll.return
+    return r;
+}
@@ -0,0 +1,43 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-lower-types --vast-hl-to-ll-cf | %file-check %s
+
+// Only the lower bound of a case range is represented, hence the switch is
+// not lowered.
+// HL:            hl.case
+// HL:            hl.case_range
+// CHECK-LABEL:   hl.func @range
+// CHECK:         hl.switch
+// CHECK-NOT:     ll.switch
+int range(int num)
+{
+    switch (num) {
+        case 1 ... 3: return 1;
+        case 4: return 2;
+    }
+    return 0;
+}
+
+// The declaration before the first label would not dominate its uses in the
+// cases, hence the switch is not lowered.
+// CHECK-LABEL:   hl.func @decl
+// CHECK:         hl.switch
+// CHECK:         hl.var "y"
+// CHECK-NOT:     ll.switch
+int decl(int num)
+{
+    switch (num) {
+        int y;
+        case 1: y = 1; return y;
+        default: return 0;
+    }
+}
+
+// CHECK-LABEL:   hl.func @plain
+// CHECK:         ll.switch
+int plain(int num)
+{
+    switch (num) {
+        case 1: return 1;
+        default: return 0;
+    }
+}
@@ -0,0 +1,40 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types --vast-hl-to-ll-vars | %file-check %s
+
+void use(int *);
+
+// CHECK: hl.func @scoped
+void scoped(int n)
+{
+    while (n--) {
+        // CHECK: [[V:%[0-9]+]] = ll.uninitialized_var : !hl.lvalue<si32>
+        // CHECK-NEXT: ll.lifetime.start [[V]] : !hl.lvalue<si32>
+        // CHECK: hl.call @use
+        // CHECK-NEXT: ll.lifetime.end [[V]] : !hl.lvalue<si32>
+        int v = n;
+        use(&v);
+    }
+}
+
+// CHECK: hl.func @early_exit
+int early_exit(int n)
+{
+    // CHECK: [[V:%[0-9]+]] = ll.uninitialized_var : !hl.lvalue<si32>
+    // CHECK-NEXT: ll.lifetime.start [[V]]
+    // CHECK: ll.lifetime.end [[V]]
+    // CHECK-NEXT: hl.return
+    int v = n;
+    use(&v);
+    return v;
+}
+
+// CHECK: hl.func @bypassed
+void bypassed(int n)
+{
+    // CHECK-NOT: ll.lifetime.start
+    switch (n) {
+        int v;
+    case 1:
+        v = 1;
+        use(&v);
+    }
+}
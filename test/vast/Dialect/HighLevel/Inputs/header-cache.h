@@ -0,0 +1,11 @@
+typedef unsigned long size_type;
+
+struct point { int x; int y; };
+
+enum color { red, green };
+
+extern int counter;
+
+int twice(int v);
+
+static inline int add(int a, int b) { return a + b; }
@@ -0,0 +1,10 @@
+// Instantiates the template of instantiation-cache-a.cpp at other lines.
+
+
+
+template< typename T >
+T twice(T v) { return v + v; }
+
+int use(int x) { return twice(x); }
+
+long other(long x) { return twice(x); }
@@ -0,0 +1,49 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+
+// CHECK-LABEL: hl.func @load
+int load(int *p) {
+    // CHECK: hl.atomic.load acquire {{%[0-9a-z]+}} : !hl.ptr<!hl.int> -> !hl.int
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+// CHECK-LABEL: hl.func @store
+void store(_Atomic int *p, int v) {
+    // CHECK: hl.atomic.store release {{%[0-9]+}}, {{%[0-9a-z]+}} : !hl.int
+    __c11_atomic_store(p, v, __ATOMIC_RELEASE);
+}
+
+// CHECK-LABEL: hl.func @rmw
+int rmw(int *p, int v) {
+    // CHECK: hl.atomic.rmw add seq_cst
+    // CHECK: hl.atomic.rmw xchg relaxed
+    return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST) + __atomic_exchange_n(p, v, __ATOMIC_RELAXED);
+}
+
+// Accesses of atomic lvalues are sequentially consistent.
+// CHECK-LABEL: hl.func @lvalue
+int lvalue(_Atomic int *p) {
+    // CHECK: hl.atomic.rmw add seq_cst
+    *p += 2;
+    // CHECK: hl.atomic.load seq_cst
+    return *p;
+}
+
+// `expected` receives the observed value only if the exchange fails.
+// CHECK-LABEL: hl.func @cmpxchg
+_Bool cmpxchg(int *p, int *expected, int desired) {
+    // CHECK: [[X:%[0-9]+]]:2 = hl.atomic.cmpxchg seq_cst acquire
+    // CHECK-NOT: hl.assign
+    // CHECK: hl.if {
+    // CHECK:   [[F:%[0-9]+]] = hl.lnot [[X]]#0 : !hl.bool -> !hl.bool
+    // CHECK:   hl.cond.yield [[F]]
+    // CHECK: } then {
+    // CHECK:   hl.assign [[X]]#1 to
+    // CHECK: }
+    return __atomic_compare_exchange_n(p, expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE);
+}
+
+// CHECK-LABEL: hl.func @cmpxchg_weak
+_Bool cmpxchg_weak(_Atomic int *p, int *expected, int desired) {
+    // CHECK: hl.atomic.cmpxchg acq_rel relaxed {{.*}} {weak}
+    return __c11_atomic_compare_exchange_weak(p, expected, desired, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
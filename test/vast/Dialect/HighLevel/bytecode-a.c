@@ -0,0 +1,16 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.mlir
+// RUN: %vast-cc1 -vast-emit-mlir-bytecode=hl %s -o %t.mlirbc
+// RUN: %vast-opt %t.mlirbc | diff -B %t.mlir -
+
+struct pair { unsigned int first; const volatile long second; };
+
+typedef struct pair pair_t;
+
+enum color { red, green };
+
+_Bool flag = 1;
+
+int sum(const pair_t *p, char *restrict c, double d, enum color e) {
+    float f = (float)d;
+    return p->first + p->second + *c + e + (int)f;
+}
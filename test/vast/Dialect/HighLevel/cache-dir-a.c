@@ -0,0 +1,24 @@
+// RUN: rm -rf %t && mkdir -p %t/inc
+// RUN: echo "int header_value(void);" > %t/inc/cache-dep.h
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-cache-dir=%t/cache -I %t/inc %s -o %t/first.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-cache-dir=%t/cache -I %t/inc %s -o %t/second.mlir
+// RUN: diff %t/first.mlir %t/second.mlir
+// RUN: ls %t/cache | %file-check %s --check-prefix=ONE
+// RUN: echo "int changed_value(void);" > %t/inc/cache-dep.h
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-cache-dir=%t/cache -I %t/inc %s -o %t/third.mlir
+// RUN: %file-check %s --check-prefix=CHANGED < %t/third.mlir
+// RUN: ls %t/cache | %file-check %s --check-prefix=TWO
+
+// A changed header is a miss, the second output is stored next to the first.
+
+// ONE-COUNT-1: .manifest
+// ONE-COUNT-1: .out
+// ONE-NOT: .out
+
+// CHANGED: hl.func @changed_value
+
+// TWO-COUNT-2: .out
+
+#include <cache-dep.h>
+
+int main(void) { return 0; }
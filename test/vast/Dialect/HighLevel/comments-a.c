@@ -0,0 +1,17 @@
+// RUN: %vast-front -vast-emit-mlir=hl -vast-emit-comments -o - %s | %file-check %s
+// RUN: %vast-front -vast-emit-mlir=hl -o - %s | %file-check %s -check-prefix=NONE
+// RUN: %vast-front -vast-emit-mlir=hl -vast-emit-comments -o - %s > %t && %vast-opt %t | diff -B %t -
+
+// NONE-NOT: comment =
+
+// CHECK: hl.var "limit" {{.*}}comment = "/// Upper bound of the counter."
+/// Upper bound of the counter.
+int limit = 10;
+
+// CHECK: hl.func @one {{.*}} attributes {comment = "/** Returns one. */"}
+/** Returns one. */
+int one(void) { return 1; }
+
+// CHECK: hl.func @plain
+// CHECK-NOT: comment =
+int plain(void) { return 2; }
@@ -0,0 +1,23 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o %t
+// RUN: %file-check --input-file=%t %s
+// RUN: %file-check --input-file=%t %s -check-prefix=DROPPED
+
+// Inline definitions are emitted only once the module refers to them, inline
+// members of a class are recorded after the class is complete.
+// CHECK-DAG: hl.func @main
+// CHECK-DAG: hl.func @_Z4kepti
+// DROPPED-NOT: dropped
+// DROPPED-NOT: counter3get
+// DROPPED-NOT: counter4zero
+
+inline int kept(int v) { return v + 1; }
+
+inline int dropped(int v) { return v - 1; }
+
+struct counter {
+    int get() { return value; }
+    static int zero() { return 0; }
+    int value;
+};
+
+int main() { return kept(1); }
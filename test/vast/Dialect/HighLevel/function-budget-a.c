@@ -0,0 +1,31 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-function-budget=1 %s -o %t.mlir 2> %t.err
+// RUN: %file-check --input-file=%t.mlir %s
+// RUN: %file-check --input-file=%t.err %s -check-prefix=REMARK
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=FULL
+
+// Tens of thousands of statements take longer than a millisecond to emit,
+// the body is replaced by a stub once the budget is exceeded.
+#define S1 x = x * 3 + 1;
+#define S8 S1 S1 S1 S1 S1 S1 S1 S1
+#define S64 S8 S8 S8 S8 S8 S8 S8 S8
+#define S512 S64 S64 S64 S64 S64 S64 S64 S64
+#define S4096 S512 S512 S512 S512 S512 S512 S512 S512
+#define S32768 S4096 S4096 S4096 S4096 S4096 S4096 S4096 S4096
+
+// CHECK:      hl.func @huge
+// CHECK-NEXT: unsup.stmt "FunctionBudget"
+// CHECK-NEXT: hl.unreachable
+// CHECK-NEXT: }
+// REMARK:     remark: codegen of 'huge' exceeded the function budget of 1 ms, its body is replaced by a stub
+// REMARK-NOT: codegen of 'tiny'
+// FULL:       hl.func @huge
+// FULL-NOT:   unsup.stmt
+int huge(int x) {
+    S32768
+    return x;
+}
+
+// CHECK:     hl.func @tiny
+// CHECK-NOT: unsup.stmt
+// CHECK:     hl.return
+int tiny(int x) { return x + 1; }
@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
+
+int computed(int i) {
+    // CHECK: [[ONE:%[0-9]+]] = hl.label.decl "one" : !hl.label
+    // CHECK: [[TWO:%[0-9]+]] = hl.label.decl "two" : !hl.label
+
+    // CHECK: hl.labeladdr [[ONE]] : !hl.ptr<!hl.void>
+    // CHECK: hl.labeladdr [[TWO]] : !hl.ptr<!hl.void>
+    static void *targets[] = { &&one, &&two };
+
+    // CHECK: hl.indirect_goto {{%[0-9]+}} : !hl.ptr<!hl.void>
+    goto *targets[i];
+
+    // CHECK: hl.label [[ONE]]
+    one: return 1;
+    // CHECK: hl.label [[TWO]]
+    two: return 2;
+}
@@ -0,0 +1,30 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-header-cache=%t/cache %s -o %t/miss.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-header-cache=%t/cache %s -o %t/hit.mlir
+// RUN: %file-check %s < %t/miss.mlir
+// RUN: %file-check %s < %t/hit.mlir
+
+#include "Inputs/header-cache.h"
+
+// CHECK: hl.typedef "size_type" : !hl.long< unsigned >
+// CHECK: hl.struct "point"
+// CHECK: hl.enum "color"
+// CHECK: hl.var "counter"
+// CHECK: hl.func @twice
+// CHECK: hl.func @add
+
+// CHECK: hl.var "counter"
+int counter = 1;
+
+// CHECK: hl.func @main
+// CHECK: hl.enumref "red"
+// CHECK: hl.enumref "green"
+// CHECK: hl.call @twice
+// CHECK: hl.call @add
+// CHECK: hl.globref "counter"
+int main(void) {
+    struct point p = { red, green };
+    size_type size = sizeof(p);
+    counter = add(p.x, twice(p.y)) + (int)size;
+    return counter;
+}
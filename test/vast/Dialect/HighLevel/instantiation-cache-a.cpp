@@ -0,0 +1,27 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-instantiation-cache=%t/cache %s -o %t/miss.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-instantiation-cache=%t/cache %s -o %t/hit.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-instantiation-cache=%t/cache %S/Inputs/instantiation-cache.cpp -o %t/other.mlir
+// RUN: %file-check %s < %t/miss.mlir
+// RUN: %file-check %s < %t/hit.mlir
+// RUN: %file-check %s -check-prefix=OTHER < %t/other.mlir
+
+// A hit gives the same body as the miss that stored it.
+// CHECK-LABEL: hl.func @_Z3useii
+// CHECK:       hl.call @_Z5twiceIiET_S0_
+// CHECK-LABEL: hl.func {{.*}}@_Z5twiceIiET_S0_
+// CHECK:       hl.add {{.*}}instantiation-cache-a.cpp:[[@LINE+2]]
+template< typename T >
+T twice(T v) { return v + v; }
+
+int use(int x) { return twice(x); }
+
+// Another unit that instantiates the same template receives the stored body,
+// which keeps the locations of the unit that generated it. Its other
+// instantiations are generated.
+// OTHER-LABEL: hl.func @_Z5otherl
+// OTHER:       hl.call @_Z5twiceIlET_S0_
+// OTHER-LABEL: hl.func {{.*}}@_Z5twiceIiET_S0_
+// OTHER:       hl.add {{.*}}instantiation-cache-a.cpp:
+// OTHER-LABEL: hl.func {{.*}}@_Z5twiceIlET_S0_
+// OTHER:       hl.add {{.*}}Inputs/instantiation-cache.cpp:6
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t && mkdir %t
+// RUN: %vast-cc1 -vast-emit-mlir=hl -DSTEP=1 -vast-instantiation-cache=%t/cache %s -o - | %file-check %s -check-prefix=ONE
+// RUN: %vast-cc1 -vast-emit-mlir=hl -DSTEP=2 -vast-instantiation-cache=%t/cache %s -o - | %file-check %s -check-prefix=TWO
+// RUN: %vast-cc1 -vast-emit-mlir=hl -DSTEP=1 -vast-instantiation-cache=%t/cache %s -o - | %file-check %s -check-prefix=ONE
+
+// Edits of the template invalidate the entries of its instantiations, even
+// though their mangled names do not change.
+// ONE-LABEL: hl.func {{.*}}@_Z4stepIiET_S0_
+// ONE:       hl.const #core.integer<1> : !hl.int
+// TWO-LABEL: hl.func {{.*}}@_Z4stepIiET_S0_
+// TWO:       hl.const #core.integer<2> : !hl.int
+template< typename T >
+T step(T v) { return v + STEP; }
+
+int use(int x) { return step(x); }
@@ -0,0 +1,26 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-module-shards=3 -vast-jobs=1 %s -o %t.one.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-module-shards=3 -vast-jobs=4 %s -o %t.four.mlir
+// RUN: diff %t.one.mlir %t.four.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-stream-functions -vast-pipelined-functions -vast-jobs=1 %s -o %t.pipelined.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-stream-functions %s -o %t.streamed.mlir
+// RUN: diff %t.streamed.mlir %t.pipelined.mlir
+// RUN: %file-check %s < %t.four.mlir
+// RUN: env MAKEFLAGS="-j4 --jobserver-auth=fifo:%t.missing" %vast-cc1 -vast-emit-mlir=hl %s -o %t.fallback.mlir
+// RUN: %file-check %s < %t.fallback.mlir
+// RUN: not --crash %vast-cc1 -vast-emit-mlir=hl -vast-jobs=0 %s -o %t.zero.mlir 2>&1 | %file-check %s -check-prefix=ZERO
+
+// A single worker runs shards and the pipelined functions as well, nested
+// work waits on the pool instead of on threads of its own. An unavailable
+// jobserver falls back to the hardware threads.
+
+// CHECK-DAG: hl.func @first
+// CHECK-DAG: hl.func @second
+// CHECK-DAG: hl.func @third
+// CHECK-DAG: hl.func @fourth
+
+// ZERO: invalid -vast-jobs value: 0
+
+int first(int v) { return v + 1; }
+int second(int v) { return first(v) * 2; }
+int third(int v) { return second(v) - 3; }
+int fourth(int v) { return third(v) / 4; }
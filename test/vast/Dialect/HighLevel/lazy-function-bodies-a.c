@@ -0,0 +1,9 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-lazy-function-bodies %s -o - | %file-check %s
+
+// CHECK: hl.func @add
+// CHECK-NOT: hl.return
+int add(int a, int b) { return a + b; }
+
+// CHECK: hl.func @main
+// CHECK-NOT: hl.call
+int main(void) { return add(1, 2); }
@@ -0,0 +1,11 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-locs=compact %s -o - | %file-check %s -check-prefix=COMPACT
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-locs=none %s -o - | %file-check %s -check-prefix=NONE
+
+int main() {}
+
+// COMPACT: meta.files = ["{{.*}}locs-a.c"]
+// COMPACT: hl.func @main () -> !hl.int {
+// COMPACT: } <#meta.pos<0, 4, 5>>
+
+// NONE: hl.func @main () -> !hl.int {
+// NONE: } [unknown]
@@ -0,0 +1,14 @@
+// RUN: not %vast-cc1 -vast-emit-mlir=hl -vast-memory-limit=1 %s -o /dev/null 2>&1 | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-memory-limit=65536 %s -o - | %file-check %s -check-prefix=WITHIN
+
+// No process fits in a megabyte, the budget is exceeded by the first
+// declaration that is generated.
+
+// CHECK: memory limit of 1 MB exceeded ({{[0-9]+}} MB resident) during codegen of '{{[a-z]+}}' ({{.*}}memory-limit-a.c:{{[0-9]+}}:{{[0-9]+}})
+
+// WITHIN: hl.func @first
+// WITHIN: hl.func @second
+
+int first(void) { return 1; }
+
+int second(void) { return first() + 1; }
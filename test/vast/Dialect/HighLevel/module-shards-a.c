@@ -0,0 +1,27 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-simplify -vast-module-shards=3 %s -o %t.sharded.mlir
+// RUN: %file-check %s < %t.sharded.mlir
+// RUN: %file-check %s --check-prefix=ONCE < %t.sharded.mlir
+
+// Every symbol is defined once and the copies of the record are merged.
+
+// CHECK-DAG: hl.var "counter"
+// CHECK-DAG: hl.func @helper internal
+// CHECK-DAG: hl.func @next
+// CHECK-DAG: hl.func @first
+// CHECK-DAG: hl.func @second
+
+// ONCE-COUNT-1: hl.struct "point"
+// ONCE-COUNT-1: hl.func @next
+// ONCE-NOT: hl.func @next
+
+struct point { int x, y; };
+
+int counter = 0;
+
+static int helper(struct point p) { return p.x + p.y; }
+
+int next(void) { return ++counter; }
+
+int first(struct point p) { return helper(p) + next(); }
+
+int second(struct point p) { return helper(p) * next(); }
@@ -0,0 +1,14 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-parallel-printing %s -o %t && %vast-opt %t | %file-check %s
+
+// CHECK: hl.struct "point"
+struct point { int x, y; };
+
+// CHECK: hl.var "origin"
+struct point origin = { 0, 0 };
+
+// CHECK: hl.func @norm
+int norm(struct point p) { return p.x * p.x + p.y * p.y; }
+
+// CHECK: hl.func @main
+// CHECK: hl.call @norm
+int main(void) { return norm(origin); }
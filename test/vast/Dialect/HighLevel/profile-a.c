@@ -0,0 +1,41 @@
+// RUN: %llvm-profdata merge -o %t.profdata %S/Inputs/profile-a.proftext
+// RUN: %vast-cc1 -vast-emit-mlir=hl -fprofile-instr-use=%t.profdata %s -o - | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -fprofile-instr-use=%t.profdata %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// The branch is taken 90 of 100 times, weights are the counts plus one.
+// CHECK-LABEL: hl.func @pick
+// CHECK-SAME:  hl.entry_count = 100 : i64
+// CHECK:       hl.if
+// CHECK:       hl.branch_weights = #hl.branch_weights<91, 11>
+// LLVM-LABEL:  define {{.*}}i32 @pick({{.*}}) {{.*}}!prof ![[PICK:[0-9]+]]
+// LLVM:        br i1 {{%[0-9]+}}, label %{{[0-9]+}}, label %{{[0-9]+}}, !prof ![[PICK_BRANCH:[0-9]+]]
+int pick(int v) {
+    if (v > 0)
+        return 1;
+    return 0;
+}
+
+// The condition holds once per iteration and fails once per entry.
+// CHECK-LABEL: hl.func @loop
+// CHECK-SAME:  hl.entry_count = 10 : i64
+// CHECK:       hl.while
+// CHECK:       hl.branch_weights = #hl.branch_weights<41, 11>
+// LLVM-LABEL:  define {{.*}}i32 @loop({{.*}}) {{.*}}!prof ![[LOOP:[0-9]+]]
+int loop(int n) {
+    int s = 0;
+    while (n--)
+        s += n;
+    return s;
+}
+
+// A record with another number of counters is out of date.
+// CHECK-LABEL: hl.func @stale
+// CHECK-NOT:   hl.entry_count
+// CHECK-NOT:   hl.branch_weights
+// CHECK:       hl.return
+int stale(int v) { return v + 1; }
+
+// LLVM-DAG: ![[PICK]] = !{!"function_entry_count", i64 100}
+// LLVM-DAG: ![[PICK_BRANCH]] = !{!"branch_weights", i32 91, i32 11}
+// LLVM-DAG: ![[LOOP]] = !{!"function_entry_count", i64 10}
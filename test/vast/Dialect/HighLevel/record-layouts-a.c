@@ -0,0 +1,25 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-record-layouts %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-record-layouts %s -o %t && %vast-opt %t | diff -B %t -
+
+// CHECK: hl.struct "empty" : {
+struct empty {};
+
+// CHECK: hl.struct "mixed" {layout = #hl.layout<96, 32, [0, 32, 64]>} : {
+struct mixed {
+  char c;
+  int i;
+  short s;
+};
+
+// CHECK: hl.struct "bits" {layout = #hl.layout<32, 32, [0, 3, 8]>} : {
+struct bits {
+  unsigned a : 3;
+  unsigned b : 5;
+  unsigned char c;
+};
+
+// CHECK: hl.union "either" {layout = #hl.layout<64, 64, [0, 0]>} : {
+union either {
+  int i;
+  double d;
+};
@@ -0,0 +1,28 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm %s -o %t.ll
+// RUN: %file-check --input-file=%t.ll %s -check-prefix=LLVM
+
+// The declaration of an array of unknown bound is replaced by the definition,
+// uses of the declaration refer to the definition.
+// CHECK-NOT: hl.var "table" sc_extern
+// CHECK:     hl.var "count" sc_extern : !hl.lvalue<!hl.int>
+extern int table[];
+extern int count;
+
+// CHECK:     hl.func @first
+// CHECK:     hl.globref "table"
+int first(void) { return table[0] + count; }
+
+// CHECK:     hl.var "table" : !hl.lvalue<!hl.array<4, !hl.int>>
+// CHECK-NOT: hl.var "table"
+int table[4] = { 1, 2, 3, 4 };
+
+// Redeclarations of the same type are kept.
+// CHECK:     hl.var "count" : !hl.lvalue<!hl.int>
+int count = 3;
+
+// LLVM:     @table = global [4 x i32] [i32 1, i32 2, i32 3, i32 4]
+// LLVM-NOT: @table = external
+// LLVM:     define {{.*}}i32 @first()
+// LLVM:     ptr @table
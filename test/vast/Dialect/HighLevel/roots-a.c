@@ -0,0 +1,17 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-roots="main" %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-roots="main" %s -o - | %file-check %s -check-prefix=PRUNED
+
+// PRUNED-NOT: @unused
+// CHECK-DAG: hl.func @helper {{.*}} {
+// CHECK-DAG: hl.func @declared {{.*}} {
+// CHECK-DAG: hl.func @main {{.*}} {
+
+static inline int unused(void) { return 0; }
+
+static inline int helper(void) { return 2; }
+
+int declared(void);
+
+int main(void) { return declared() + helper(); }
+
+int declared(void) { return 1; }
@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-stream-functions %s -o %t && %vast-opt %t | %file-check %s
+
+// CHECK-DAG: hl.var "counter"
+int counter = 0;
+
+int inc(int v);
+
+// CHECK-DAG: hl.func @inc
+int inc(int v) { return v + 1; }
+
+// CHECK-DAG: hl.func @main
+// CHECK-DAG: hl.call @inc
+int main(void) { counter = inc(counter); return counter; }
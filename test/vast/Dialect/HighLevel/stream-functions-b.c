@@ -0,0 +1,33 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-stream-functions %s -o %t.streamed.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-stream-functions -vast-pipelined-functions %s -o %t.pipelined.mlir
+// RUN: diff %t.streamed.mlir %t.pipelined.mlir
+// RUN: %vast-opt %t.pipelined.mlir | %file-check %s
+// RUN: rm -rf %t.cache
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-stream-functions -vast-pipelined-functions -vast-function-cache=%t.cache %s -o %t.cold.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-stream-functions -vast-pipelined-functions -vast-function-cache=%t.cache %s -o %t.warm.mlir
+// RUN: diff %t.streamed.mlir %t.cold.mlir
+// RUN: diff %t.streamed.mlir %t.warm.mlir
+
+// Pipelined functions are written in the order of the translation unit,
+// more of them than may wait for the worker at once.
+
+#define STEP(n) int step##n(int v) { return v * n + (v >> 1); }
+#define STEP8(n) STEP(n##0) STEP(n##1) STEP(n##2) STEP(n##3) \
+                 STEP(n##4) STEP(n##5) STEP(n##6) STEP(n##7)
+
+// CHECK:     hl.var "total"
+int total = 0;
+
+// CHECK:     hl.func @step10
+// CHECK:     hl.func @step17
+// CHECK:     hl.func @step80
+// CHECK:     hl.func @step97
+STEP8(1) STEP8(2) STEP8(3) STEP8(4) STEP8(5) STEP8(6) STEP8(7) STEP8(8) STEP8(9)
+
+// CHECK:     hl.func @main
+// CHECK:     hl.call @step97
+// CHECK-NOT: hl.func
+int main(void) {
+    total = step10(total) + step55(total) + step97(total);
+    return total;
+}
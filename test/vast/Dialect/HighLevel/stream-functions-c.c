@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-stream-functions -mlir-print-debuginfo %s -o %t && %vast-opt %t | %file-check %s
+// RUN: not %vast-cc1 -vast-emit-mlir=hl -vast-stream-functions -vast-simplify %s -o /dev/null 2>&1 | %file-check %s -check-prefix=SIMPLIFY
+// RUN: not %vast-cc1 -vast-emit-mlir=llvm -vast-stream-functions %s -o /dev/null 2>&1 | %file-check %s -check-prefix=TARGET
+// RUN: not %vast-cc1 -vast-emit-llvm -vast-stream-functions %s -o /dev/null 2>&1 | %file-check %s -check-prefix=OUTPUT
+// RUN: not %vast-cc1 -vast-emit-mlir=hl -vast-module-shards=2 -vast-stream-functions %s -o /dev/null 2>&1 | %file-check %s -check-prefix=SHARDS
+
+// Streamed functions are printed in local scope, so their locations and
+// types parse without the aliases of the module.
+// CHECK: hl.func @area
+// CHECK: hl.member
+
+// SIMPLIFY: error: invalid argument '-vast-stream-functions' not allowed with '-vast-simplify'
+// TARGET:   error: invalid argument '-vast-stream-functions' not allowed with '-vast-emit-mlir=llvm'
+// OUTPUT:   error: invalid argument '-vast-stream-functions' only allowed with '-vast-emit-mlir'
+// SHARDS:   error: invalid argument '-vast-module-shards' not allowed with '-vast-stream-functions'
+
+struct rect { int width, height; };
+
+int area(struct rect r) { return r.width * r.height; }
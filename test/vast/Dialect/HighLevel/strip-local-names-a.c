@@ -0,0 +1,30 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-strip-local-names %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-strip-local-names %s -o %t && %vast-opt %t | diff -B %t -
+// RUN: %vast-front -vast-strip-local-names -o %t.exe %s && (%t.exe; test $? -eq 9)
+
+int counter = 1;
+
+// Locals are named by their index in their function, statics keep their
+// names.
+// CHECK-LABEL: hl.func @sum
+// CHECK:       hl.var "{{[0-9]+}}" : !hl.lvalue<!hl.int>
+// CHECK-NOT:   hl.var "total"
+// CHECK:       hl.var "{{[0-9]+}}" : !hl.lvalue<!hl.int>
+// CHECK:       hl.var "calls" {{.*}}sc_static
+int sum(int a, int b)
+{
+    int total = a + b;
+    int twice = total * 2;
+    static int calls;
+    ++calls;
+    return twice - total + counter;
+}
+
+// The indices start over in every function.
+// CHECK-LABEL: hl.func @main
+// CHECK:       hl.var "0" : !hl.lvalue<!hl.int>
+int main(void)
+{
+    int result = sum(3, 5);
+    return result;
+}
@@ -0,0 +1,12 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-system-headers-decls-only %s -o - | %file-check %s
+
+// The line marker makes the following definitions come from a system header.
+# 1 "system.h" 1 3
+static inline int sys_unused(void) { return 0; }
+static inline int sys_used(void) { return 1; }
+# 8 "system-headers-decls-only-a.c" 2
+
+// CHECK: hl.func @sys_unused {{.*}}-> !hl.int{{$}}
+// CHECK: hl.func @sys_used {{.*}} {
+// CHECK: hl.func @main {{.*}} {
+int main(void) { return sys_used(); }
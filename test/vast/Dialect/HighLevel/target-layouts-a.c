@@ -0,0 +1,38 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefixes=LP64,X86
+// RUN: %vast-cc1 -triple aarch64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefixes=LP64,AARCH64
+// RUN: %vast-cc1 -triple x86_64-pc-windows-msvc -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=WIN
+// RUN: %vast-cc1 -triple arm64-apple-macosx -vast-emit-mlir=hl %s -o - | %file-check %s -check-prefix=DARWIN
+
+// Builtins and pointers of x86_64 SysV and AAPCS64 come from the tables,
+// other targets are asked from clang.
+
+// LP64-DAG: #dlti.dl_entry<!hl.short, #core.dl<16, 16>>
+// LP64-DAG: #dlti.dl_entry<!hl.int, #core.dl<32, 32>>
+// LP64-DAG: #dlti.dl_entry<!hl.long, #core.dl<64, 64>>
+// LP64-DAG: #dlti.dl_entry<!hl.longlong< unsigned >, #core.dl<64, 64>>
+// LP64-DAG: #dlti.dl_entry<!hl.int128, #core.dl<128, 128>>
+// LP64-DAG: #dlti.dl_entry<!hl.double, #core.dl<64, 64>>
+// LP64-DAG: #dlti.dl_entry<!hl.longdouble, #core.dl<128, 128>>
+// LP64-DAG: #dlti.dl_entry<!hl.ptr<!hl.char>, #core.dl<64, 64>>
+
+// WIN-DAG: #dlti.dl_entry<!hl.long, #core.dl<32, 32>>
+// WIN-DAG: #dlti.dl_entry<!hl.longdouble, #core.dl<64, 64>>
+// WIN-DAG: #dlti.dl_entry<!hl.ptr<!hl.char>, #core.dl<64, 64>>
+
+// DARWIN-DAG: #dlti.dl_entry<!hl.long, #core.dl<64, 64>>
+// DARWIN-DAG: #dlti.dl_entry<!hl.longdouble, #core.dl<64, 64>>
+
+short s;
+int i;
+long l;
+unsigned long long ull;
+__int128 i128;
+double d;
+long double ld;
+char *p;
+
+// X86-DAG: #dlti.dl_entry<!hl.float128, #core.dl<128, 128>>
+// AARCH64-NOT: !hl.float128
+#ifdef __x86_64__
+__float128 f128;
+#endif
@@ -0,0 +1,27 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t && %vast-opt %t | diff -B %t -
+
+typedef int v4si __attribute__((vector_size(16)));
+typedef float float4 __attribute__((ext_vector_type(4)));
+typedef float m128 __attribute__((vector_size(16), aligned(16)));
+
+// CHECK: hl.typedef "v4si" : !hl.vector<4, !hl.int>
+// CHECK: hl.typedef "float4" : !hl.vector<4, !hl.float>
+// CHECK: hl.typedef "m128" : !hl.vector<4, !hl.float>
+
+v4si add(v4si a, v4si b) {
+    // CHECK: hl.add {{.*}} : (!hl.elaborated<!hl.typedef<"v4si">>, !hl.elaborated<!hl.typedef<"v4si">>) -> !hl.elaborated<!hl.typedef<"v4si">>
+    return a + b;
+}
+
+void ops(v4si a, float4 f, int i) {
+    // CHECK: hl.mul {{.*}} -> !hl.elaborated<!hl.typedef<"v4si">>
+    a = a * a;
+    // CHECK: hl.implicit_cast {{.*}} VectorSplat : !hl.float -> !hl.elaborated<!hl.typedef<"float4">>
+    // CHECK: hl.assign.fmul
+    f *= 2.0f;
+    // CHECK: hl.subscript {{.*}} at [{{.*}} : !hl.int] : !hl.lvalue<!hl.elaborated<!hl.typedef<"v4si">>> -> !hl.lvalue<!hl.int>
+    a[i] = 1;
+    // CHECK: hl.shufflevector {{.*}} array<i32: 3, 2, 1, 0>
+    a = __builtin_shufflevector(a, a, 3, 2, 1, 0);
+}
@@ -0,0 +1,10 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-simplify -vast-verifier=checkpoints -vast-print-pipeline %s -o %t.mlir 2>&1 | %file-check %s --check-prefix=PIPELINE
+// RUN: %file-check %s < %t.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-simplify -vast-verifier=none %s -o - | %file-check %s
+
+// Checkpoints follow the codegen and the reduce-hl steps.
+// PIPELINE: vast-checkpoint
+// PIPELINE-SAME: vast-checkpoint
+
+// CHECK: hl.func @sum
+int sum(int a, int b) { return a + b; }
@@ -0,0 +1,16 @@
+// RUN: %vast-front %s -vast-emit-mlir=hl -vast-unsupported=summary -o - | %file-check %s -check-prefix=SUMMARY
+// RUN: %vast-front %s -vast-emit-mlir=hl -vast-unsupported=drop -o - | %file-check %s -check-prefix=DROP
+// RUN: %vast-front %s -vast-emit-mlir=hl -vast-unsupported=summary -o - > %t && %vast-opt %t | diff -B %t -
+
+// SUMMARY: unsup.decl "StaticAssert" {range = "{{.*}}summary.cpp:{{.*}}"}
+// DROP:    unsup.decl "StaticAssert" :
+static_assert(1, "Test static assert 1");
+
+int load(int* p) {
+    // SUMMARY:     unsup.stmt "AtomicExpr" {range = "{{.*}}", referenced = [!hl.ptr<!hl.int>]} : !hl.int
+    // SUMMARY-NOT: hl.const #core.integer<5>
+    // DROP:        unsup.stmt "AtomicExpr" : !hl.int
+    // DROP-NOT:    hl.const #core.integer<5>
+    int q = __atomic_load_n (p, __ATOMIC_SEQ_CST);
+    return q;
+}
@@ -0,0 +1,38 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --cse | %file-check %s
+
+// CHECK-LABEL: hl.func @sizes
+// CHECK:       hl.sizeof.type !hl.int
+// CHECK-NOT:   hl.sizeof.type
+// CHECK:       hl.alignof.type !hl.long
+// CHECK-NOT:   hl.alignof.type
+// CHECK:       hl.return
+unsigned long sizes(void) {
+    return sizeof(int) + sizeof(int) + _Alignof(long) * _Alignof(long);
+}
+
+// Casts of the same constant are merged with the constant.
+// CHECK-LABEL: hl.func @casts
+// CHECK:       [[C:%[0-9]+]] = hl.const #core.integer<3> : !hl.int
+// CHECK:       [[L:%[0-9]+]] = hl.cstyle_cast [[C]] IntegralCast : !hl.int -> !hl.long
+// CHECK:       hl.add [[L]], [[L]]
+long casts(void) {
+    return (long)3 + (long)3;
+}
+
+// Every read of a variable stays a separate load.
+// CHECK-LABEL: hl.func @loads
+// CHECK:       hl.implicit_cast {{%[0-9]+}} LValueToRValue
+// CHECK:       hl.implicit_cast {{%[0-9]+}} LValueToRValue
+// CHECK:       hl.return
+int loads(int x) {
+    return x + x;
+}
+
+// CHECK-LABEL: hl.func @volatile_loads
+// CHECK:       hl.implicit_cast {{%[0-9]+}} LValueToRValue
+// CHECK:       hl.implicit_cast {{%[0-9]+}} LValueToRValue
+// CHECK:       hl.return
+int volatile_loads(volatile int *p) {
+    *p;
+    return *p;
+}
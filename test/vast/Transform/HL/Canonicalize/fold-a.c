@@ -0,0 +1,43 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --canonicalize | %file-check %s
+
+// CHECK-LABEL: hl.func @arith
+int arith() {
+    // CHECK-NOT: hl.mul
+    // CHECK-NOT: hl.add
+    // CHECK: hl.const #core.integer<14> : !hl.int
+    return 2 + 3 * 4;
+}
+
+// CHECK-LABEL: hl.func @shifts
+unsigned shifts() {
+    // CHECK-NOT: hl.bin.shl
+    // CHECK: hl.const #core.integer<48> : !hl.int< unsigned >
+    return 3u << 4u;
+}
+
+// CHECK-LABEL: hl.func @division_by_zero
+int division_by_zero() {
+    // CHECK: hl.sdiv
+    return 1 / 0;
+}
+
+// CHECK-LABEL: hl.func @neutral
+int neutral(int x) {
+    // CHECK-NOT: hl.add
+    // CHECK-NOT: hl.mul
+    return (x + 0) * 1;
+}
+
+// CHECK-LABEL: hl.func @size
+unsigned long size(int *p) {
+    // CHECK-NOT: hl.sizeof
+    // CHECK: hl.const #core.integer<4> : !hl.long< unsigned >
+    return sizeof(*p);
+}
+
+// CHECK-LABEL: hl.func @cast
+long cast() {
+    // CHECK-NOT: hl.implicit_cast
+    // CHECK: hl.const #core.integer<-1> : !hl.long
+    return -1;
+}
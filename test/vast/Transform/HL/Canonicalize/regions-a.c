@@ -0,0 +1,32 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --canonicalize | %file-check %s
+
+// Constants stay in the regions that use them, they are not hoisted to the
+// entry of the function.
+
+// CHECK-LABEL: hl.func @loop
+// CHECK-NOT:   hl.const
+// CHECK:       hl.while {
+// CHECK:         hl.const #core.integer<10> : !hl.int
+// CHECK:         hl.cond.yield
+// CHECK:       } do {
+// CHECK:         hl.const #core.integer<2> : !hl.int
+// CHECK:       }
+void loop(int n) {
+    while (n < 10) {
+        n = n + 2;
+    }
+}
+
+// CHECK-LABEL: hl.func @scope
+// CHECK-NOT:   hl.const
+// CHECK:       core.scope {
+// CHECK:         hl.var "y"
+// CHECK:         hl.const #core.integer<7> : !hl.int
+// CHECK:       }
+void scope(int x) {
+    {
+        int y = x;
+        y = 3 + 4;
+    }
+    ++x;
+}
@@ -0,0 +1,31 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --canonicalize | %file-check %s
+
+// CHECK-LABEL: hl.func @nested
+void nested(int x) {
+    // CHECK-NOT: core.scope
+    // CHECK: hl.pre.inc
+    // CHECK-NOT: core.scope
+    // CHECK: hl.pre.dec
+    { { ++x; } }
+    { --x; }
+}
+
+// CHECK-LABEL: hl.func @declares
+void declares(int x) {
+    // CHECK: core.scope {
+    // CHECK:   hl.var "y"
+    // CHECK: }
+    { int y = x; }
+    ++x;
+}
+
+// CHECK-LABEL: hl.func @returns
+int returns(int x) {
+    // CHECK: core.scope {
+    // CHECK:   hl.return
+    // CHECK: }
+    // CHECK: hl.pre.inc
+    { return x; }
+    ++x;
+    return x;
+}
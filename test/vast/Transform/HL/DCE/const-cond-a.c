@@ -0,0 +1,33 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce | %file-check %s
+
+// CHECK-LABEL: hl.func @then_taken
+void then_taken()
+{
+    int x = 0;
+    // CHECK-NOT: hl.if
+    // CHECK: core.scope {
+    // CHECK:   hl.pre.inc
+    // CHECK: }
+    // CHECK-NOT: hl.pre.dec
+    if (1) {
+        ++x;
+    } else {
+        --x;
+    }
+}
+
+// CHECK-LABEL: hl.func @never_taken
+void never_taken()
+{
+    int x = 0;
+    // CHECK-NOT: hl.if
+    // CHECK-NOT: hl.while
+    // CHECK-NOT: hl.pre.inc
+    if (0) {
+        ++x;
+    }
+
+    while (0) {
+        ++x;
+    }
+}
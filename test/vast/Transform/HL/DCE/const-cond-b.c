@@ -0,0 +1,46 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce | %file-check %s
+
+// The branch is never entered, but its label is the target of a goto.
+// CHECK-LABEL: hl.func @goto_into
+int goto_into(int x)
+{
+    // CHECK: hl.goto
+    // CHECK: hl.if
+    // CHECK: hl.label
+    // CHECK: hl.pre.inc
+    goto inside;
+    if (0) {
+    inside:
+        ++x;
+    }
+    return x;
+}
+
+// Cases in a loop that is never repeated are reached by the switch.
+// CHECK-LABEL: hl.func @duff
+int duff(int n)
+{
+    int x = 0;
+    // CHECK: hl.switch
+    // CHECK: hl.while
+    // CHECK: hl.case
+    // CHECK: hl.case
+    switch (n) {
+        while (0) {
+        case 0: ++x;
+        case 1: ++x;
+        }
+    }
+    return x;
+}
+
+// CHECK-LABEL: hl.func @dropped
+int dropped(int x)
+{
+    // CHECK-NOT: hl.if
+    // CHECK:     hl.return
+    if (0) {
+        ++x;
+    }
+    return x;
+}
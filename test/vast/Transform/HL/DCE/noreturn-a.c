@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce | %file-check %s
+
+_Noreturn void stop(void);
+
+// CHECK-LABEL: hl.func @fn
+void fn()
+{
+    int x = 0;
+    // CHECK: hl.call @stop
+    // CHECK-NOT: hl.pre.inc
+    stop();
+    ++x;
+}
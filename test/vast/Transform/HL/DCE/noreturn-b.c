@@ -0,0 +1,22 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --mlir-disable-threading --pass-pipeline="builtin.module(hl.func(vast-hl-dce))" | %file-check %s
+
+// One instance of the nested pass looks up callees of all the functions.
+_Noreturn void stop(void);
+
+// CHECK-LABEL: hl.func @first
+void first(int x)
+{
+    // CHECK: hl.call @stop
+    // CHECK-NOT: hl.pre.inc
+    stop();
+    ++x;
+}
+
+// CHECK-LABEL: hl.func @second
+void second(int x)
+{
+    // CHECK: hl.call @stop
+    // CHECK-NOT: hl.pre.dec
+    stop();
+    --x;
+}
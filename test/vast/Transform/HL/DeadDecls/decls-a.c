@@ -0,0 +1,42 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dead-decls | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-simplify %s -o - | %file-check %s -check-prefix=SIMPLIFY
+
+// CHECK-NOT: hl.struct "unused"
+// SIMPLIFY-NOT: hl.struct "unused"
+struct unused { int a; };
+
+// CHECK: hl.struct "inner"
+struct inner { int a; };
+
+// CHECK: hl.struct "outer"
+struct outer { struct inner i; };
+
+// CHECK-NOT: hl.typedef "unused_t"
+typedef struct unused unused_t;
+
+// CHECK: hl.typedef "outer_t"
+typedef struct outer outer_t;
+
+// CHECK-NOT: hl.enum "unused_kind"
+enum unused_kind { first, second };
+
+// CHECK: hl.enum "color"
+enum color { red, green };
+
+// CHECK-NOT: hl.func @unused_decl
+int unused_decl(int);
+
+// CHECK-NOT: hl.func @unused_static
+static int unused_static(void) { return unused_decl(0); }
+
+// CHECK: hl.func @used_decl
+int used_decl(outer_t *);
+
+// CHECK: hl.func @used_static
+static int used_static(void) { return green; }
+
+// SIMPLIFY: hl.func @main
+int main(void) {
+    outer_t o;
+    return used_decl(&o) + used_static();
+}
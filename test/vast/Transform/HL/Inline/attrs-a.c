@@ -0,0 +1,30 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-inline="threshold=4" | %file-check %s
+
+// Inlined regardless of the threshold.
+static __attribute__((always_inline)) int big(int x) {
+    int a = x * 2;
+    int b = a + 3;
+    return b * a - x;
+}
+
+// Never inlined.
+static __attribute__((noinline)) int tiny(int x) {
+    return x;
+}
+
+// Above the threshold.
+static int medium(int x) {
+    int a = x * 2;
+    int b = a + 3;
+    return b;
+}
+
+// CHECK-LABEL: hl.func @caller
+int caller(int x) {
+    // CHECK-NOT: hl.call @big
+    // CHECK: hl.var "big.arg0.0"
+    // CHECK: hl.var "big.a.0"
+    // CHECK: hl.call @tiny
+    // CHECK: hl.call @medium
+    return big(x) + tiny(x) + medium(x);
+}
@@ -0,0 +1,24 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-inline | %file-check %s
+
+// Inlined functions that are not referenced anymore are erased, functions
+// whose address is taken are kept.
+
+// CHECK-NOT: hl.func @helper
+// CHECK: hl.func @kept
+// CHECK-NOT: hl.func @helper
+// CHECK-LABEL: hl.func @caller
+// CHECK-NOT: hl.call
+
+static int helper(int x) {
+    return x + 1;
+}
+
+static int kept(int x) {
+    return x * 2;
+}
+
+int (*pointer)(int) = kept;
+
+int caller(int x) {
+    return helper(x) + kept(x);
+}
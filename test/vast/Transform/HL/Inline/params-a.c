@@ -0,0 +1,28 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-inline | %file-check %s
+
+// CHECK-NOT: hl.func @add
+static int add(int a, int b) {
+    int sum = a + b;
+    return sum;
+}
+
+// Variables of inlined bodies are named after the callee and the call, so
+// they clash neither with the variables of the caller nor with each other.
+
+// CHECK-LABEL: hl.func @caller
+int caller(int x) {
+    // CHECK: hl.var "sum" : !hl.lvalue<!hl.int>
+    int sum = 1;
+    // CHECK-NOT: hl.call @add
+    // CHECK: hl.stmt.expr : !hl.int
+    // CHECK: hl.var "add.arg0.0" : !hl.lvalue<!hl.int>
+    // CHECK: hl.var "add.arg1.0" : !hl.lvalue<!hl.int>
+    // CHECK: hl.var "add.sum.0" : !hl.lvalue<!hl.int>
+    // CHECK: hl.value.yield
+    // CHECK: hl.stmt.expr : !hl.int
+    // CHECK: hl.var "add.arg0.1" : !hl.lvalue<!hl.int>
+    // CHECK: hl.var "add.arg1.1" : !hl.lvalue<!hl.int>
+    // CHECK: hl.var "add.sum.1" : !hl.lvalue<!hl.int>
+    // CHECK-NOT: hl.call @add
+    return add(x, sum) + add(sum, 2);
+}
@@ -0,0 +1,31 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-inline | %file-check %s
+
+// CHECK-LABEL: hl.func @fact
+// CHECK: hl.call @fact
+static int fact(int n) {
+    return n <= 1 ? 1 : n * fact(n - 1);
+}
+
+static int even(int n);
+
+// CHECK-LABEL: hl.func @odd
+// CHECK: hl.call @even
+static int odd(int n) {
+    return n == 0 ? 0 : even(n - 1);
+}
+
+// CHECK-LABEL: hl.func @even
+// CHECK: hl.call @odd
+static int even(int n) {
+    return n == 0 ? 1 : odd(n - 1);
+}
+
+// Recursive functions are never inlined.
+
+// CHECK-LABEL: hl.func @caller
+int caller(int n) {
+    // CHECK-NOT: hl.stmt.expr
+    // CHECK: hl.call @fact
+    // CHECK: hl.call @even
+    return fact(n) + even(n);
+}
@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-inline | %file-check %s
+
+static void bump(int *p) {
+    ++*p;
+}
+
+// Calls of functions that return nothing are replaced by a scope, there
+// is no value to yield.
+
+// CHECK-LABEL: hl.func @use
+void use(int *p) {
+    // CHECK-NOT: hl.stmt.expr
+    // CHECK-NOT: hl.call @bump
+    // CHECK: core.scope {
+    // CHECK:   hl.var "bump.arg0.0" : !hl.lvalue<!hl.ptr<!hl.int>>
+    // CHECK:   hl.pre.inc
+    // CHECK-NOT: hl.value.yield
+    // CHECK: }
+    bump(p);
+}
@@ -0,0 +1,29 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-instrument-coverage | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-instrument-coverage="per-thread=true counters=hits" | %file-check %s -check-prefix=THREAD
+
+// CHECK: hl.var "__vast_coverage" : !hl.lvalue<!hl.array<6, !hl.longlong< unsigned >>>
+// THREAD: hl.var "hits" tsc_c_thread : !hl.lvalue<!hl.array<6, !hl.longlong< unsigned >>>
+
+// Function entry, then the then and else branches.
+// CHECK-LABEL: hl.func @branch
+// CHECK-SAME:  vast.coverage = array<i64: 0>
+// CHECK:       hl.globref "__vast_coverage"
+// CHECK:       hl.const #core.integer<0>
+// CHECK:       hl.pre.inc
+// CHECK:       vast.coverage = array<i64: 1, 2>
+// THREAD:      hl.globref "hits"
+void branch(int x) {
+    if (x)
+        ++x;
+    else
+        --x;
+}
+
+// Function entry, then the loop body and the loop exit.
+// CHECK-LABEL: hl.func @loop
+// CHECK-SAME:  vast.coverage = array<i64: 3>
+// CHECK:       vast.coverage = array<i64: 4, 5>
+void loop(int n) {
+    while (n)
+        --n;
+}
@@ -0,0 +1,37 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-instrument-coverage="minimal=true" | %file-check %s
+
+// The else branch is derived from the entry of the function.
+// CHECK: hl.var "__vast_coverage" : !hl.lvalue<!hl.array<8, !hl.longlong< unsigned >>>
+
+// CHECK-LABEL: hl.func @branch
+// CHECK-SAME:  vast.coverage = array<i64: 0>
+// CHECK:       vast.coverage = array<i64: 1, -1>
+void branch(int x) {
+    if (x)
+        ++x;
+    else
+        --x;
+}
+
+// The exit of a loop that nothing escapes is its entry count.
+// CHECK-LABEL: hl.func @loop
+// CHECK-SAME:  vast.coverage = array<i64: 2>
+// CHECK:       vast.coverage = array<i64: 3, -1>
+void loop(int n) {
+    while (n)
+        --n;
+}
+
+// A return escapes the loop, so its exit is counted.
+// CHECK-LABEL: hl.func @search
+// CHECK-SAME:  vast.coverage = array<i64: 4>
+// CHECK-DAG:   vast.coverage = array<i64: 5, 7>
+// CHECK-DAG:   vast.coverage = array<i64: 6, -1>
+int search(int n) {
+    while (n) {
+        if (n == 3)
+            return 1;
+        --n;
+    }
+    return 0;
+}
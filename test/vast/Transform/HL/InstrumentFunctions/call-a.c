@@ -0,0 +1,25 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-instrument-functions=call %s -o - | %file-check %s
+
+// CHECK: module {{.*}}vast.instrumented_functions = ["clamp", "twice"]
+
+// CHECK-LABEL: hl.func @clamp
+// CHECK:       [[ID:%[0-9]+]] = hl.const #core.integer<0> : !hl.int< unsigned >
+// CHECK:       hl.call @__vast_func_enter([[ID]])
+// CHECK:       hl.call @__vast_func_exit
+// CHECK:       hl.return
+// CHECK:       hl.call @__vast_func_exit
+// CHECK:       hl.return
+int clamp(int x) {
+    if (x > 10)
+        return 10;
+    return x;
+}
+
+// CHECK-LABEL: hl.func @twice
+// CHECK:       [[ID:%[0-9]+]] = hl.const #core.integer<1> : !hl.int< unsigned >
+// CHECK:       hl.call @__vast_func_enter([[ID]])
+int twice(int x) { return clamp(x) * 2; }
+
+// The module does not declare the hooks, so the pass does.
+// CHECK-DAG: hl.func @__vast_func_enter (!hl.int< unsigned >)
+// CHECK-DAG: hl.func @__vast_func_exit (!hl.int< unsigned >)
@@ -0,0 +1,12 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-instrument-functions=call -vast-instrument-filter="^api_" %s -o - | %file-check %s
+
+// CHECK: module {{.*}}vast.instrumented_functions = ["api_get"]
+
+// CHECK-LABEL: hl.func @helper
+// CHECK-NOT:   hl.call @__vast_func_enter
+// CHECK:       hl.return
+static int helper(int x) { return x + 1; }
+
+// CHECK-LABEL: hl.func @api_get
+// CHECK:       hl.call @__vast_func_enter
+int api_get(int x) { return helper(x); }
@@ -0,0 +1,21 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-instrument-functions=call -vast-instrument-roots="run" %s -o - | %file-check %s
+
+// Only the root and the functions it reaches are instrumented.
+// CHECK: module {{.*}}vast.instrumented_functions = ["step", "run"]
+
+// CHECK-LABEL: hl.func @step
+// CHECK:       hl.call @__vast_func_enter
+int step(int x) { return x - 1; }
+
+// CHECK-LABEL: hl.func @run
+// CHECK:       hl.call @__vast_func_enter
+int run(int x) {
+    while (x)
+        x = step(x);
+    return x;
+}
+
+// CHECK-LABEL: hl.func @unused
+// CHECK-NOT:   hl.call @__vast_func_enter
+// CHECK:       hl.return
+int unused(void) { return 0; }
@@ -0,0 +1,21 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-instrument-functions=sampled -vast-instrument-sample-period=16 %s -o - | %file-check %s
+// RUN: not %vast-cc1 -vast-emit-mlir=hl -vast-instrument-functions=sampled -vast-instrument-sample-period=10 %s -o /dev/null 2>&1 | %file-check %s -check-prefix=PERIOD
+
+// PERIOD: sample period has to be a power of two, got 10
+
+// CHECK: hl.var "__vast_func_enter_samples" : !hl.lvalue<!hl.array<1, !hl.int< unsigned >>>
+
+// Every 16th entry calls the hook, exits are not sampled.
+// CHECK-LABEL: hl.func @work
+// CHECK:       hl.if {
+// CHECK:         hl.globref "__vast_func_enter_samples"
+// CHECK:         [[COUNT:%[0-9]+]] = hl.pre.inc
+// CHECK:         [[MASK:%[0-9]+]] = hl.const #core.integer<15> : !hl.int< unsigned >
+// CHECK:         hl.bin.and [[COUNT]], [[MASK]]
+// CHECK:         hl.cmp eq
+// CHECK:       } then {
+// CHECK:         hl.call @__vast_func_enter
+// CHECK:       }
+// CHECK-NOT:   hl.call @__vast_func_exit
+// CHECK:       hl.return
+int work(int x) { return x * x; }
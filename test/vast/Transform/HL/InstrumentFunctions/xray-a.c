@@ -0,0 +1,11 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-instrument-functions=xray %s -o - | %file-check %s
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-llvm -vast-instrument-functions=xray %s -o - | %file-check %s -check-prefix=LLVM
+
+// No hooks are called, the functions only ask llvm for XRay sleds.
+// CHECK-LABEL: hl.func @traced
+// CHECK-SAME:  passthrough = {{\[}}["function-instrument", "xray-always"]]
+// CHECK-NOT:   hl.call @__vast_func_enter
+
+// LLVM: define {{.*}}@traced({{.*}}) #[[ATTRS:[0-9]+]]
+// LLVM: attributes #[[ATTRS]] = {{{.*}}"function-instrument"="xray-always"
+int traced(int x) { return x + 1; }
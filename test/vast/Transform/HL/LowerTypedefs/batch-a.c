@@ -0,0 +1,21 @@
+// RUN: rm -rf %t && mkdir -p %t/out && \
+// RUN: %vast-front -vast-emit-mlir=hl %s -o %t/a.mlir && \
+// RUN: %vast-front -vast-emit-mlir=hl %s -o %t/b.mlir && \
+// RUN: printf "# input output\n%t/a.mlir %t/out/a.mlir\n\n%t/b.mlir\n" > %t/list && \
+// RUN: %vast-opt --batch=%t/list --batch-jobs=2 --vast-hl-lower-typedefs 2> %t/summary && \
+// RUN: %file-check %s -check-prefix=SUMMARY < %t/summary && \
+// RUN: %file-check %s < %t/out/a.mlir && \
+// RUN: %file-check %s < %t/b.opt.mlir
+
+// Modules without an output are written next to their input.
+
+// SUMMARY: ===- vast-opt batch summary -===
+// SUMMARY-DAG: ms  ok {{.*}}a.mlir -> {{.*}}out{{/|\\}}a.mlir
+// SUMMARY-DAG: ms  ok {{.*}}b.mlir -> {{.*}}b.opt.mlir
+// SUMMARY: 2 modules, 0 failed
+
+// CHECK-NOT: hl.typedef
+// CHECK: hl.func @fn ({{%arg[0-9]+}}: !hl.lvalue<!hl.int>) -> !hl.int
+typedef int INT;
+
+int fn(INT x) { return x; }
@@ -3,13 +3,13 @@
 // CHECK: hl.var "ai" : !hl.lvalue<memref<10xsi32>>
 int ai[10];
 
-// CHECK: hl.var "aci" : !hl.lvalue<memref<5xsi32>>
+// CHECK: hl.var "aci" {is_constant} : !hl.lvalue<memref<5xsi32>>
 const int aci[5];
 
 // CHECK: hl.var "avi" : !hl.lvalue<memref<5xsi32>>
 volatile int avi[5];
 
-// CHECK: hl.var "acvi" : !hl.lvalue<memref<5xsi32>>
+// CHECK: hl.var "acvi" {is_constant} : !hl.lvalue<memref<5xsi32>>
 const volatile int acvi[5];
 
 // CHECK: hl.var "acvui" : !hl.lvalue<memref<5xui32>>
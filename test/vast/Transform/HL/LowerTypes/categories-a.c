@@ -0,0 +1,44 @@
+// RUN: %vast-cc1 -triple x86_64-unknown-linux-gnu -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-types | %file-check %s
+
+// Every integer and floating point type is lowered by its category, with the
+// signedness of its qualifiers and the width of the data layout.
+// CHECK-LABEL: hl.func @types
+void types(void)
+{
+    // CHECK: hl.var "c" : !hl.lvalue<si8>
+    char c;
+    // CHECK: hl.var "sc" : !hl.lvalue<si8>
+    signed char sc;
+    // CHECK: hl.var "uc" : !hl.lvalue<ui8>
+    unsigned char uc;
+    // CHECK: hl.var "s" : !hl.lvalue<si16>
+    short s;
+    // CHECK: hl.var "us" : !hl.lvalue<ui16>
+    unsigned short us;
+    // CHECK: hl.var "i" : !hl.lvalue<si32>
+    int i;
+    // CHECK: hl.var "ui" : !hl.lvalue<ui32>
+    unsigned ui;
+    // CHECK: hl.var "l" : !hl.lvalue<si64>
+    long l;
+    // CHECK: hl.var "ul" : !hl.lvalue<ui64>
+    unsigned long ul;
+    // CHECK: hl.var "ll" : !hl.lvalue<si64>
+    long long ll;
+    // CHECK: hl.var "ull" : !hl.lvalue<ui64>
+    unsigned long long ull;
+    // CHECK: hl.var "wide" : !hl.lvalue<si128>
+    __int128 wide;
+    // CHECK: hl.var "uwide" : !hl.lvalue<ui128>
+    unsigned __int128 uwide;
+    // CHECK: hl.var "b" : !hl.lvalue<ui8>
+    _Bool b;
+    // CHECK: hl.var "f" : !hl.lvalue<f32>
+    float f;
+    // CHECK: hl.var "d" : !hl.lvalue<f64>
+    double d;
+    // CHECK: hl.var "ld" : !hl.lvalue<f128>
+    long double ld;
+    // CHECK: hl.var "cvi" : !hl.lvalue<si32>
+    const volatile int cvi;
+}
@@ -0,0 +1,22 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --mlir-disable-threading --pass-pipeline="builtin.module(hl.func(vast-hl-splice-trailing-scopes))" | %file-check %s
+
+// One instance of the nested pass splices the trailing scopes of all the
+// functions.
+
+// CHECK-LABEL: hl.func @first
+// CHECK-NOT:   core.scope
+// CHECK:       hl.pre.inc
+void first(int x) {
+    {
+        ++x;
+    }
+}
+
+// CHECK-LABEL: hl.func @second
+// CHECK-NOT:   core.scope
+// CHECK:       hl.pre.dec
+void second(int x) {
+    {
+        --x;
+    }
+}
@@ -0,0 +1,326 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <benchmark/benchmark.h>
+#include <clang/Basic/CodeGenOptions.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/FrontendOptions.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/CodeGenContext.hpp"
+#include "vast/CodeGen/CodeGenDriver.hpp"
+#include "vast/Conversion/Passes.hpp"
+#include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Frontend/Context.hpp"
+#include "vast/Frontend/Options.hpp"
+#include "vast/Target/LLVMIR/Convert.hpp"
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Pipeline.hpp"
+
+#include <string>
+#include <vector>
+
+//
+// Micro-benchmarks of the stages of vast on synthetic C sources: codegen,
+// every step of the pipeline down to the LLVM dialect, and translation to
+// LLVM IR. Every stage is timed on the output of the preceding ones, which
+// are prepared outside of the timed region, and reports its time per
+// operation of its input module (`per_op`).
+//
+// The MLIR context runs single-threaded, so that the numbers do not depend
+// on the number of cores of the machine.
+//
+
+namespace vast::bench {
+
+    //
+    // Synthetic sources, parametrized by their size.
+    //
+
+    // A single expression of `size` binary operators. The expression is not
+    // parenthesized, as clang limits the nesting of brackets.
+    std::string deep_expression(unsigned size) {
+        std::string src = "int deep_expression(int a, int b) {\n    return a";
+        const char *ops[] = { " + ", " * ", " - ", " ^ " };
+        for (unsigned idx = 0; idx < size; ++idx) {
+            src += ops[idx % 4];
+            src += idx % 2 ? "b" : std::to_string(idx);
+        }
+        return src + ";\n}\n";
+    }
+
+    std::string many_locals(unsigned size) {
+        std::string src = "int many_locals(int a) {\n    int v0 = a;\n";
+        for (unsigned idx = 1; idx < size; ++idx) {
+            src += "    int v" + std::to_string(idx) + " = v" + std::to_string(idx - 1)
+                 + " + " + std::to_string(idx) + ";\n";
+        }
+        return src + "    return v" + std::to_string(size - 1) + ";\n}\n";
+    }
+
+    std::string big_struct(unsigned size) {
+        std::string src = "struct big {\n";
+        for (unsigned idx = 0; idx < size; ++idx) {
+            src += "    int f" + std::to_string(idx) + ";\n";
+        }
+        src += "};\n\nint big_struct(struct big *s) {\n    int sum = 0;\n";
+        for (unsigned idx = 0; idx < size; ++idx) {
+            src += "    sum += s->f" + std::to_string(idx) + ";\n";
+        }
+        return src + "    return sum;\n}\n";
+    }
+
+    std::string long_switch(unsigned size) {
+        std::string src = "int long_switch(int x) {\n    switch (x) {\n";
+        for (unsigned idx = 0; idx < size; ++idx) {
+            src += "        case " + std::to_string(idx) + ": return x * "
+                 + std::to_string(idx) + ";\n";
+        }
+        return src + "        default: return -1;\n    }\n}\n";
+    }
+
+    std::string many_functions(unsigned size) {
+        std::string src = "int f0(int x) { return x; }\n";
+        for (unsigned idx = 1; idx < size; ++idx) {
+            src += "int f" + std::to_string(idx) + "(int x) { return f"
+                 + std::to_string(idx - 1) + "(x) + " + std::to_string(idx) + "; }\n";
+        }
+        return src;
+    }
+
+    struct fixture {
+        const char *name;
+        std::string (*source)(unsigned size);
+    };
+
+    const fixture fixtures[] = {
+        { "deep-expression", deep_expression },
+        { "many-locals",     many_locals },
+        { "big-struct",      big_struct },
+        { "long-switch",     long_switch },
+        { "many-functions",  many_functions },
+    };
+
+    const std::vector< std::int64_t > sizes = { 32, 256, 1024 };
+
+    //
+    // Pipeline steps in the order of the default conversion path.
+    //
+    struct step {
+        const char *name;
+        pipeline_step_ptr (*build)();
+    };
+
+    const step steps[] = {
+        { "hl-canonicalize", hl::pipeline::canonicalize },
+        { "hl-desugar",      hl::pipeline::desugar },
+        { "hl-simplify",     hl::pipeline::simplify },
+        { "hl-stdtypes",     hl::pipeline::stdtypes },
+        { "abi",             conv::pipeline::abi },
+        { "irs-to-llvm",     conv::pipeline::irs_to_llvm },
+    };
+
+    constexpr std::size_t steps_count = std::size(steps);
+
+    std::unique_ptr< clang::ASTUnit > parse(const fixture &fix, unsigned size) {
+        auto unit = clang::tooling::buildASTFromCodeWithArgs(
+            fix.source(size), { "-std=c17", "-w" }, "vast-bench.c"
+        );
+        VAST_CHECK(
+            unit && !unit->getDiagnostics().hasErrorOccurred(),
+            "failed to parse benchmark source: {0}", fix.name
+        );
+        return unit;
+    }
+
+    std::unique_ptr< mcontext_t > make_context() {
+        auto mctx = cc::make_mcontext();
+        mctx->disableMultithreading();
+        return mctx;
+    }
+
+    std::size_t count_ops(vast_module mod) {
+        std::size_t ops = 0;
+        mod->walk([&] (operation) { ++ops; });
+        return ops;
+    }
+
+    //
+    // Codegen of the whole translation unit, as in vast-front.
+    //
+    struct codegen_session {
+        codegen_session(clang::ASTUnit &unit, mcontext_t &mctx)
+            : unit(unit)
+            , opts{
+                .headers = unit.getHeaderSearchOpts(),
+                .codegen = codegen_opts,
+                .target  = unit.getASTContext().getTargetInfo().getTargetOpts(),
+                .lang    = unit.getLangOpts(),
+                .front   = front_opts,
+                .diags   = unit.getDiagnostics(),
+                .vfs     = unit.getFileManager().getVirtualFileSystem()
+            }
+            , cgctx(mctx, unit.getASTContext(), cc::get_source_language(opts.lang))
+            , driver(cgctx, opts, vargs)
+        {}
+
+        owning_module_ref run() {
+            for (auto decl : unit.getASTContext().getTranslationUnitDecl()->decls()) {
+                driver.handle_top_level_decl(decl);
+            }
+
+            driver.finalize();
+            return std::move(cgctx.mod);
+        }
+
+      private:
+        clang::ASTUnit &unit;
+
+        cc::codegen_options codegen_opts;
+        cc::frontend_options front_opts;
+        cc::action_options opts;
+        cc::vast_args vargs;
+
+        cg::codegen_context cgctx;
+        cg::codegen_driver driver;
+    };
+
+    owning_module_ref generate(clang::ASTUnit &unit, mcontext_t &mctx) {
+        return codegen_session(unit, mctx).run();
+    }
+
+    // Runs steps [0, count) on the module, returns the pipeline that ran
+    // them, so that its passes are not scheduled again.
+    std::unique_ptr< pipeline_t > run_steps(vast_module mod, std::size_t count, mcontext_t &mctx) {
+        auto passes = std::make_unique< pipeline_t >(&mctx);
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            *passes << steps[idx].build();
+        }
+
+        VAST_CHECK(mlir::succeeded(passes->run(mod)), "failed to prepare benchmark module");
+        return passes;
+    }
+
+    void report(benchmark::State &state, std::size_t ops) {
+        state.SetItemsProcessed(std::int64_t(state.iterations() * ops));
+        state.counters["ops"] = benchmark::Counter(double(ops));
+        state.counters["per_op"] = benchmark::Counter(
+            double(ops), benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert
+        );
+    }
+
+    void bench_codegen(benchmark::State &state, const fixture &fix) {
+        auto unit = parse(fix, unsigned(state.range(0)));
+        auto mctx = make_context();
+
+        std::size_t ops = 0;
+        for (auto _ : state) {
+            auto mod = generate(*unit, *mctx);
+
+            state.PauseTiming();
+            ops = count_ops(mod.get());
+            mod = nullptr;
+            state.ResumeTiming();
+        }
+
+        report(state, ops);
+    }
+
+    void bench_step(benchmark::State &state, const fixture &fix, std::size_t idx) {
+        auto unit = parse(fix, unsigned(state.range(0)));
+        auto mctx = make_context();
+
+        auto input  = generate(*unit, *mctx);
+        auto before = run_steps(input.get(), idx, *mctx);
+
+        // Only the passes the step adds to the preceding ones are timed.
+        pipeline_t passes(mctx.get());
+        passes.seen      = before->seen;
+        passes.scheduled = before->scheduled;
+        passes << steps[idx].build();
+
+        auto ops = count_ops(input.get());
+        for (auto _ : state) {
+            state.PauseTiming();
+            owning_module_ref mod = input->clone();
+            state.ResumeTiming();
+
+            if (mlir::failed(passes.run(mod.get()))) {
+                state.SkipWithError("pipeline step failed");
+                break;
+            }
+
+            state.PauseTiming();
+            mod = nullptr;
+            state.ResumeTiming();
+        }
+
+        report(state, ops);
+    }
+
+    void bench_translate(benchmark::State &state, const fixture &fix) {
+        auto unit = parse(fix, unsigned(state.range(0)));
+        auto mctx = make_context();
+
+        auto input = generate(*unit, *mctx);
+        run_steps(input.get(), steps_count, *mctx);
+
+        auto ops = count_ops(input.get());
+        for (auto _ : state) {
+            llvm::LLVMContext llvm_ctx;
+            auto mod = target::llvmir::translate(input.get(), llvm_ctx);
+            if (!mod) {
+                state.SkipWithError("translation to LLVM IR failed");
+                break;
+            }
+
+            state.PauseTiming();
+            mod = nullptr;
+            state.ResumeTiming();
+        }
+
+        report(state, ops);
+    }
+
+    void register_benchmarks() {
+        for (const auto &fix : fixtures) {
+            auto add = [&] (const char *stage, auto &&run) {
+                auto name  = (llvm::Twine(stage) + "/" + fix.name).str();
+                auto bench = benchmark::RegisterBenchmark(name.c_str(), std::forward< decltype(run) >(run));
+                for (auto size : sizes) {
+                    bench->Arg(size);
+                }
+                bench->Unit(benchmark::kMicrosecond);
+            };
+
+            add("codegen", [&fix] (benchmark::State &state) { bench_codegen(state, fix); });
+
+            for (std::size_t idx = 0; idx < steps_count; ++idx) {
+                add(steps[idx].name, [&fix, idx] (benchmark::State &state) {
+                    bench_step(state, fix, idx);
+                });
+            }
+
+            add("translate", [&fix] (benchmark::State &state) { bench_translate(state, fix); });
+        }
+    }
+
+} // namespace vast::bench
+
+int main(int argc, char **argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    vast::bench::register_benchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
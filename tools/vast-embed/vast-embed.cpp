@@ -0,0 +1,196 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Session.h"
+
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <vector>
+
+//
+// Compiles a source through the C interface of an embedded session, as a
+// service would, e.g., to check that repeated compilations of a session
+// give the same output.
+//
+namespace vast::cl
+{
+    namespace cl = llvm::cl;
+
+    // clang-format off
+    cl::OptionCategory generic("Vast Generic Options");
+
+    struct vast_embed_options {
+        cl::opt< std::string > input_file{
+            cl::desc("<input file>"),
+            cl::Positional,
+            cl::Required,
+            cl::cat(generic)
+        };
+        cl::list< std::string > compiler_args{
+            cl::desc("<compiler arguments>"),
+            cl::ConsumeAfter,
+            cl::cat(generic)
+        };
+        cl::opt< std::string > target{ "target",
+            cl::desc("Target dialect: hl, std, llvm or cir"),
+            cl::value_desc("dialect"),
+            cl::init("hl"),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > emit{ "emit",
+            cl::desc("Output: mlir, bytecode or object"),
+            cl::value_desc("kind"),
+            cl::init("mlir"),
+            cl::cat(generic)
+        };
+        cl::list< std::string > vast_options{ "vast-option",
+            cl::desc("Option of vast passed to the session, e.g., -vast-simplify"),
+            cl::value_desc("option"),
+            cl::cat(generic)
+        };
+        cl::opt< unsigned > repeat{ "repeat",
+            cl::desc("Compile the source this many times in the session, the outputs must not differ"),
+            cl::init(1),
+            cl::cat(generic)
+        };
+        cl::opt< bool > multithreaded{ "multithreaded",
+            cl::desc("Let the session run passes on its own threads"),
+            cl::init(false),
+            cl::cat(generic)
+        };
+    };
+    // clang-format on
+
+    static llvm::ManagedStatic< vast_embed_options > options;
+
+    void register_options() { *options; }
+} // namespace vast::cl
+
+namespace vast
+{
+    std::optional< vast_target_dialect > parse_target(llvm::StringRef name) {
+        return llvm::StringSwitch< std::optional< vast_target_dialect > >(name)
+            .Case("hl", VAST_TARGET_HIGH_LEVEL)
+            .Case("std", VAST_TARGET_STD)
+            .Case("llvm", VAST_TARGET_LLVM)
+            .Case("cir", VAST_TARGET_CIR)
+            .Default(std::nullopt);
+    }
+
+    std::optional< vast_output_kind > parse_output(llvm::StringRef name) {
+        return llvm::StringSwitch< std::optional< vast_output_kind > >(name)
+            .Case("mlir", VAST_OUTPUT_MLIR)
+            .Case("bytecode", VAST_OUTPUT_MLIR_BYTECODE)
+            .Case("object", VAST_OUTPUT_OBJECT)
+            .Default(std::nullopt);
+    }
+
+    std::vector< const char * > pointers(const std::vector< std::string > &strings) {
+        std::vector< const char * > result;
+        for (const auto &str : strings) {
+            result.push_back(str.c_str());
+        }
+        return result;
+    }
+
+    bool run() {
+        if (cl::options->repeat == 0) {
+            llvm::errs() << "error: the source is compiled at least once\n";
+            return false;
+        }
+
+        auto target = parse_target(cl::options->target);
+        if (!target) {
+            llvm::errs() << "error: unknown target dialect " << cl::options->target << "\n";
+            return false;
+        }
+
+        auto output = parse_output(cl::options->emit);
+        if (!output) {
+            llvm::errs() << "error: unknown output " << cl::options->emit << "\n";
+            return false;
+        }
+
+        auto buffer = llvm::MemoryBuffer::getFileOrSTDIN(cl::options->input_file);
+        if (auto ec = buffer.getError()) {
+            llvm::errs() << "error: cannot read " << cl::options->input_file << ": " << ec.message() << "\n";
+            return false;
+        }
+
+        std::vector< std::string > args(cl::options->compiler_args.begin(), cl::options->compiler_args.end());
+        std::vector< std::string > vast_opts(cl::options->vast_options.begin(), cl::options->vast_options.end());
+        auto arg_ptrs  = pointers(args);
+        auto vast_ptrs = pointers(vast_opts);
+
+        vast_session_options opts = {
+            cl::options->input_file.c_str(),
+            arg_ptrs.data(), arg_ptrs.size(),
+            vast_ptrs.data(), vast_ptrs.size(),
+            cl::options->multithreaded ? 1 : 0
+        };
+
+        char *errors = nullptr;
+        auto session = vast_session_create(&opts, &errors);
+        if (!session) {
+            llvm::errs() << "error: cannot create the session";
+            if (errors) {
+                llvm::errs() << ": " << errors;
+                std::free(errors);
+            }
+            llvm::errs() << "\n";
+            return false;
+        }
+
+        auto source = (*buffer)->getBuffer();
+
+        bool succeeded = true;
+        std::optional< std::string > first;
+        for (unsigned i = 0; i < cl::options->repeat; ++i) {
+            auto result = vast_session_compile(session, source.data(), source.size(), *target, *output);
+            llvm::errs() << vast_result_diagnostics(result);
+
+            if (!vast_result_succeeded(result)) {
+                llvm::errs() << "error: compilation " << i << " failed\n";
+                vast_result_destroy(result);
+                succeeded = false;
+                break;
+            }
+
+            std::string data(vast_result_data(result), vast_result_size(result));
+            vast_result_destroy(result);
+
+            if (!first) {
+                first = std::move(data);
+            } else if (data != *first) {
+                llvm::errs() << "error: compilation " << i << " differs from the first\n";
+                succeeded = false;
+                break;
+            }
+        }
+
+        vast_session_destroy(session);
+
+        if (succeeded) {
+            llvm::outs() << *first;
+        }
+        return succeeded;
+    }
+
+} // namespace vast
+
+int main(int argc, char **argv) {
+    llvm::cl::HideUnrelatedOptions({ &vast::cl::generic });
+    vast::cl::register_options();
+    llvm::cl::ParseCommandLineOptions(argc, argv, "VAST embedded session driver\n");
+
+    std::exit(vast::run() ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,267 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+//===----------------------------------------------------------------------===//
+//
+// Batch mode of vast-front compiles many translation units in a single
+// process. Translation units are compiled concurrently on a thread pool that
+// is shared with MLIR contexts of all units:
+//
+//   vast-front --batch [-j <jobs>] [-p <compile_commands.json>] [--shared-context] [args...]
+//
+// Without compilation database the arguments form a single driver command
+// line with multiple inputs, where each input is compiled as a separate
+// translation unit. With compilation database the arguments are appended to
+// each compile command of the database. With `--shared-context` all units
+// are compiled in a single MLIR context.
+//
+//===----------------------------------------------------------------------===//
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Tooling/JSONCompilationDatabase.h>
+#include <llvm/Support/StringSaver.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/Timer.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Context.hpp"
+#include "vast/Frontend/Driver.hpp"
+#include "vast/Frontend/Jobs.hpp"
+#include "vast/Frontend/Options.hpp"
+
+#include <atomic>
+#include <optional>
+
+// Lives inside driver.cpp
+void preprocess_vast_arguments(vast::cc::argv_storage &args);
+
+namespace vast::cc {
+
+    // Lives inside cc1.cpp
+    int batch_cc1(
+        const vast_args &vargs, argv_t argv, arg_t tool, void *main_addr, llvm::raw_ostream *diag_os
+    );
+    void initialize_targets();
+
+    namespace {
+
+        struct batch_options
+        {
+            std::optional< std::string > compile_commands;
+            // zero means to use the jobserver slots or all available hardware
+            // threads
+            unsigned jobs = 0;
+            // compile all units in one MLIR context
+            bool shared_context = false;
+            argv_storage args;
+        };
+
+        std::optional< batch_options > parse_batch_options(argv_t argv) {
+            batch_options opts;
+
+            for (auto it = argv.begin(); it != argv.end(); ++it) {
+                auto arg = string_ref(*it);
+
+                auto value = [&] () -> std::optional< string_ref > {
+                    if (std::next(it) == argv.end()) {
+                        llvm::errs() << "error: missing value of batch option '" << arg << "'\n";
+                        return std::nullopt;
+                    }
+                    return string_ref(*++it);
+                };
+
+                if (arg == "-p") {
+                    auto path = value();
+                    if (!path) {
+                        return std::nullopt;
+                    }
+                    opts.compile_commands = path->str();
+                } else if (arg == "-j") {
+                    auto jobs = value();
+                    if (!jobs || jobs->getAsInteger(10, opts.jobs)) {
+                        llvm::errs() << "error: invalid number of batch jobs\n";
+                        return std::nullopt;
+                    }
+                } else if (arg == "--shared-context") {
+                    opts.shared_context = true;
+                } else {
+                    opts.args.push_back(*it);
+                }
+            }
+
+            return opts;
+        }
+
+        //
+        // Driver compilation of a single command line. Jobs of the
+        // compilation refer to argument strings owned by the compilation,
+        // hence the unit has to outlive the execution of its jobs.
+        //
+        struct batch_unit
+        {
+            argv_storage args;
+            std::unique_ptr< driver > drv;
+            driver::compilation_ptr comp;
+        };
+
+        // jobs are never executed through the driver in the batch mode
+        int unreachable_cc1(argv_storage_base &) {
+            VAST_UNREACHABLE("batch mode does not execute jobs through the driver");
+        }
+
+    } // namespace
+
+    //
+    // Without `diagnostics`, units print their diagnostics to the standard
+    // error as they go. Otherwise, diagnostics of every job are buffered and
+    // appended to `diagnostics` in the order of the jobs.
+    //
+    unsigned compile_units(
+        std::vector< argv_storage > command_lines,
+        const std::string &driver_path,
+        bool canonical_prefixes,
+        void *main_addr,
+        llvm::ThreadPool &pool,
+        llvm::raw_ostream *diagnostics
+    ) {
+        std::atomic< unsigned > failures = 0;
+        auto &diag_os = diagnostics ? *diagnostics : llvm::errs();
+
+        std::vector< std::unique_ptr< batch_unit > > units;
+        std::vector< const clang_command * > jobs;
+
+        for (auto &line : command_lines) {
+            auto unit = std::make_unique< batch_unit >();
+            unit->args = std::move(line);
+            preprocess_vast_arguments(unit->args);
+
+            unit->drv = std::make_unique< driver >(
+                driver_path, unit->args, &unreachable_cc1, canonical_prefixes, diag_os
+            );
+
+            unit->comp = unit->drv->make_compilation();
+            if (!unit->comp || unit->comp->containsError()) {
+                ++failures;
+                continue;
+            }
+
+            for (const auto &job : unit->comp->getJobs()) {
+                const auto &args = job.getArguments();
+                if (args.empty() || string_ref(args.front()) != "-cc1") {
+                    diag_os << "error: batch mode supports only compile jobs, skipping: "
+                                 << job.getExecutable() << "\n";
+                    ++failures;
+                    continue;
+                }
+
+                jobs.push_back(&job);
+            }
+
+            units.push_back(std::move(unit));
+        }
+
+        std::vector< std::string > job_diagnostics(diagnostics ? jobs.size() : 0);
+
+        llvm::ThreadPoolTaskGroup group(pool);
+        for (std::size_t idx = 0; idx < jobs.size(); ++idx) {
+            group.async([&, idx] {
+                const auto *job = jobs[idx];
+
+                argv_storage cmd_args;
+                cmd_args.push_back(driver_path.c_str());
+                cmd_args.append(job->getArguments().begin(), job->getArguments().end());
+
+                std::optional< llvm::raw_string_ostream > job_os;
+                if (diagnostics) {
+                    job_os.emplace(job_diagnostics[idx]);
+                }
+
+                auto [vargs, ccargs] = filter_args(cmd_args);
+                auto ccargs_ref = llvm::ArrayRef(ccargs).slice(2);
+                if (batch_cc1(vargs, ccargs_ref, cmd_args[0], main_addr, job_os ? &job_os.value() : nullptr)) {
+                    ++failures;
+                }
+            });
+        }
+
+        group.wait();
+
+        for (const auto &text : job_diagnostics) {
+            *diagnostics << text;
+        }
+
+        return failures;
+    }
+
+    int batch(argv_t argv, const std::string &driver_path, bool canonical_prefixes, void *main_addr) {
+        auto opts = parse_batch_options(argv);
+        if (!opts) {
+            return 1;
+        }
+
+        llvm::BumpPtrAllocator allocator;
+        llvm::StringSaver saver(allocator);
+
+        std::vector< argv_storage > command_lines;
+
+        if (opts->compile_commands) {
+            std::string error;
+            auto db = clang::tooling::JSONCompilationDatabase::loadFromFile(
+                opts->compile_commands.value(), error,
+                clang::tooling::JSONCommandLineSyntax::AutoDetect
+            );
+
+            if (!db) {
+                llvm::errs() << "error: " << error << "\n";
+                return 1;
+            }
+
+            for (const auto &cmd : db->getAllCompileCommands()) {
+                auto &line = command_lines.emplace_back();
+                line.push_back(saver.save(driver_path).data());
+                // The process cannot change directory per unit, so let the
+                // driver resolve paths relative to the unit directory.
+                line.push_back("-working-directory");
+                line.push_back(saver.save(cmd.Directory).data());
+                for (const auto &arg : llvm::drop_begin(cmd.CommandLine)) {
+                    line.push_back(saver.save(arg).data());
+                }
+                line.append(opts->args.begin(), opts->args.end());
+            }
+        } else {
+            auto &line = command_lines.emplace_back();
+            line.push_back(saver.save(driver_path).data());
+            line.append(opts->args.begin(), opts->args.end());
+        }
+
+        initialize_targets();
+
+        // Without `-j`, the batch takes the slots of the jobserver of the
+        // build system, if there is one.
+        auto jobserver = opts->jobs ? nullptr : jobserver_client::from_environment();
+        auto jobs = opts->jobs ? opts->jobs : default_jobs(jobserver.get());
+
+        llvm::ThreadPool pool(llvm::hardware_concurrency(jobs));
+        set_shared_thread_pool(&pool);
+
+        if (opts->shared_context) {
+            set_shared_mcontext(make_shared_mcontext());
+        }
+
+        auto failures = compile_units(
+            std::move(command_lines), driver_path, canonical_prefixes, main_addr, pool,
+            /* diagnostics */ nullptr
+        );
+
+        set_shared_mcontext(nullptr);
+        set_shared_thread_pool(nullptr);
+
+        llvm::TimerGroup::printAll(llvm::errs());
+        llvm::TimerGroup::clearAll();
+
+        return failures ? 1 : 0;
+    }
+
+} // namespace vast::cc
@@ -24,6 +24,7 @@ VAST_RELAX_WARNINGS
 #include <llvm/Option/Arg.h>
 #include <llvm/Option/ArgList.h>
 #include <llvm/Option/OptTable.h>
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Process.h>
 #include <llvm/Support/Signals.h>
 #include <llvm/Support/TargetSelect.h>
@@ -34,6 +35,12 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Frontend/CompilerInvocation.hpp"
 #include "vast/Frontend/CompilerInstance.hpp"
 #include "vast/Frontend/Diagnostics.hpp"
+#include "vast/Frontend/Jobs.hpp"
+#include "vast/Frontend/Options.hpp"
+
+#include "vast/Util/Trace.hpp"
+
+#include <optional>
 
 using namespace vast::cc;
 
@@ -56,17 +63,43 @@ namespace vast::cc {
 
     bool execute_compiler_invocation(compiler_instance *ci, const vast_args &vargs);
 
-    int cc1(const vast_args &vargs, argv_t ccargs, arg_t tool, void *main_addr) {
-        // FIXME: ensureSufficientStack
+    static void write_trace(const trace_recorder &recorder, string_ref path) {
+        std::error_code ec;
+        llvm::raw_fd_ostream out(path, ec, llvm::sys::fs::OF_Text);
+        if (ec) {
+            llvm::errs() << "vast: unable to write trace to '" << path << "': " << ec.message() << "\n";
+            return;
+        }
 
-        auto comp = std::make_unique< compiler_instance >();
-        // FIXME: register the support for object-file-wrapped Clang modules.
+        recorder.write(out);
+    }
 
-        // Initialize targets first, so that --version shows registered targets.
+    void initialize_targets() {
         llvm::InitializeAllTargets();
         llvm::InitializeAllTargetMCs();
         llvm::InitializeAllAsmPrinters();
         llvm::InitializeAllAsmParsers();
+    }
+
+    //
+    // Standalone invocation owns process-wide state (fatal error handler,
+    // timers, target registration). Batch invocations run concurrently and
+    // leave the process-wide state to the batch driver. Their diagnostics are
+    // printed to `diag_os` if given, instead of the standard error.
+    //
+    static int run_cc1(
+        const vast_args &vargs, argv_t ccargs, arg_t tool, void *main_addr, bool standalone,
+        llvm::raw_ostream *diag_os = nullptr
+    ) {
+        // FIXME: ensureSufficientStack
+
+        auto comp = std::make_unique< compiler_instance >();
+        // FIXME: register the support for object-file-wrapped Clang modules.
+
+        // Initialize targets first, so that --version shows registered targets.
+        if (standalone) {
+            initialize_targets();
+        }
 
         vast::cc::buffered_diagnostics diags(ccargs);
 
@@ -81,10 +114,23 @@ namespace vast::cc {
         // auto &target_opts   = comp->getFrontendOpts();
         auto &header_opts   = comp->getHeaderSearchOpts();
 
-        if (!frontend_opts.TimeTracePath.empty()) {
+        // The profiler and the recorder of -vast-trace are thread-local, hence
+        // translation units of a batch get separate timelines.
+        auto trace_path = vargs.get_option(opt::trace);
+        VAST_CHECK(
+            trace_path || !vargs.has_option(opt::trace), "expected path to the trace file"
+        );
+
+        if (!frontend_opts.TimeTracePath.empty() || trace_path) {
             llvm::timeTraceProfilerInitialize(frontend_opts.TimeTraceGranularity, tool);
         }
 
+        std::optional< trace_recorder > recorder;
+        if (trace_path) {
+            recorder.emplace(frontend_opts.TimeTraceGranularity);
+        }
+        trace_recorder_scope trace_scope(recorder ? &recorder.value() : nullptr);
+
         // --print-supported-cpus takes priority over the actual compilation.
         // if (opts.PrintSupportedCPUs) {
         //     return PrintSupportedCPUs(target_opts.Triple);
@@ -96,13 +142,21 @@ namespace vast::cc {
         }
 
         // Create the actual diagnostics engine.
-        if (comp->createDiagnostics(); !comp->hasDiagnostics()) {
+        if (diag_os) {
+            comp->createDiagnostics(new clang::TextDiagnosticPrinter(*diag_os, &comp->getDiagnosticOpts()));
+        } else {
+            comp->createDiagnostics();
+        }
+
+        if (!comp->hasDiagnostics()) {
             return 1;
         }
 
         // Set an error handler, so that any LLVM backend diagnostics go through our
         // error handler.
-        llvm::install_fatal_error_handler(error_handler, static_cast<void*>(&comp->getDiagnostics()));
+        if (standalone) {
+            llvm::install_fatal_error_handler(error_handler, static_cast<void*>(&comp->getDiagnostics()));
+        }
 
         diags.flush();
         if (!success) {
@@ -110,6 +164,12 @@ namespace vast::cc {
             return 1;
         }
 
+        // Batch invocations share the workers of the batch driver.
+        std::optional< execution_context > execution;
+        if (standalone) {
+            execution.emplace(vargs);
+        }
+
         // Execute the frontend actions.
         try {
             llvm::TimeTraceScope TimeScope("ExecuteCompiler");
@@ -125,10 +185,16 @@ namespace vast::cc {
 
         // If any timers were active but haven't been destroyed yet, print their
         // results now.  This happens in -disable-free mode.
-        llvm::TimerGroup::printAll(llvm::errs());
-        llvm::TimerGroup::clearAll();
+        if (standalone) {
+            llvm::TimerGroup::printAll(llvm::errs());
+            llvm::TimerGroup::clearAll();
+        }
 
-        if (llvm::timeTraceProfilerEnabled()) {
+        if (recorder) {
+            write_trace(*recorder, *trace_path);
+        }
+
+        if (llvm::timeTraceProfilerEnabled() && !frontend_opts.TimeTracePath.empty()) {
             // It is possible that the compiler instance doesn't own a file manager here
             // if we're compiling a module unit. Since the file manager are owned by AST
             // when we're compiling a module unit. So the file manager may be invalid
@@ -156,10 +222,16 @@ namespace vast::cc {
             }
         }
 
+        if (llvm::timeTraceProfilerEnabled()) {
+            llvm::timeTraceProfilerCleanup();
+        }
+
         // Our error handler depends on the Diagnostics object, which we're
         // potentially about to delete. Uninstall the handler now so that any
         // later errors use the default handling behavior instead.
-        llvm::remove_fatal_error_handler();
+        if (standalone) {
+            llvm::remove_fatal_error_handler();
+        }
 
         // When running with -disable-free, don't do any destruction or shutdown.
         if (frontend_opts.DisableFree) {
@@ -170,4 +242,14 @@ namespace vast::cc {
         return !success;
     }
 
+    int cc1(const vast_args &vargs, argv_t ccargs, arg_t tool, void *main_addr) {
+        return run_cc1(vargs, ccargs, tool, main_addr, true /* standalone */);
+    }
+
+    int batch_cc1(
+        const vast_args &vargs, argv_t ccargs, arg_t tool, void *main_addr, llvm::raw_ostream *diag_os
+    ) {
+        return run_cc1(vargs, ccargs, tool, main_addr, false /* standalone */, diag_os);
+    }
+
 } // namespace vast::cc
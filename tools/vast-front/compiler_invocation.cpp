@@ -22,6 +22,15 @@ namespace vast::cc
             return std::make_unique< vast::cc::emit_mlir_action >(vargs);
         }
 
+        if (vargs.has_option(opt::emit_mlir_bytecode)) {
+            return std::make_unique< vast::cc::emit_mlir_bytecode_action >(vargs);
+        }
+
+        // Checked ahead of `emit_llvm`, which is its prefix.
+        if (vargs.has_option(opt::emit_llvm_bc)) {
+            return std::make_unique< vast::cc::emit_bc_action >(vargs);
+        }
+
         if (vargs.has_option(opt::emit_llvm)) {
             return std::make_unique< vast::cc::emit_llvm_action >(vargs);
         }
@@ -50,6 +59,7 @@ namespace vast::cc
             case ASTDump:  return std::make_unique< clang::ASTDumpAction >();
             case EmitAssembly: return std::make_unique< vast::cc::emit_assembly_action >(vargs);
             case EmitLLVM: return std::make_unique< vast::cc::emit_llvm_action >(vargs);
+            case EmitBC: return std::make_unique< vast::cc::emit_bc_action >(vargs);
             case EmitObj: return std::make_unique< vast::cc::emit_obj_action >(vargs);
             default: VAST_UNIMPLEMENTED_MSG("unsupported frontend action");
         }
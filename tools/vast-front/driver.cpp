@@ -22,6 +22,13 @@ VAST_UNRELAX_WARNINGS
 // main frontend method. Lives inside cc1_main.cpp
 namespace vast::cc {
     extern int cc1(const vast_args & vargs, argv_t argv, arg_t tool, void *main_addr);
+
+    // batch mode entry point. Lives inside batch.cpp
+    extern int batch(argv_t argv, const std::string &driver_path, bool canonical_prefixes, void *main_addr);
+
+    // compile server entry points. Live inside serve.cpp
+    extern int serve(argv_t argv, const std::string &driver_path, bool canonical_prefixes, void *main_addr);
+    extern int connect_to_server(argv_t argv);
 } // namespace vast::cc
 
 VAST_RELAX_WARNINGS
@@ -151,6 +158,33 @@ int main(int argc, char **argv) try {
     // Driver::BuildCompilation()
     bool canonical_prefixes = has_canonical_prefixes_option(cmd_args);
 
+    // Compile multiple translation units in a single process or serve
+    // compile requests from a persistent process.
+    if (first_arg != cmd_args.end()) {
+        auto mode = vast::string_ref(*first_arg);
+        auto mode_args = llvm::ArrayRef(cmd_args).drop_front(
+            std::distance(cmd_args.begin(), first_arg) + 1
+        );
+
+        VAST_RELAX_WARNINGS
+        void *main_addr = (void *) (intptr_t) get_executable_path;
+        VAST_UNRELAX_WARNINGS
+
+        if (mode == "--batch") {
+            std::string driver_path = get_executable_path(cmd_args[0], canonical_prefixes);
+            return vast::cc::batch(mode_args, driver_path, canonical_prefixes, main_addr);
+        }
+
+        if (mode == "--serve") {
+            std::string driver_path = get_executable_path(cmd_args[0], canonical_prefixes);
+            return vast::cc::serve(mode_args, driver_path, canonical_prefixes, main_addr);
+        }
+
+        if (mode == "--connect") {
+            return vast::cc::connect_to_server(mode_args);
+        }
+    }
+
     preprocess_vast_arguments(cmd_args);
 
     // FIXME: handle options that need handling before the real command line parsing
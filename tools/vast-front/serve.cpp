@@ -0,0 +1,427 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+//===----------------------------------------------------------------------===//
+//
+// Compile server mode of vast-front keeps process-wide state (registered
+// targets, memoized pipeline steps, shared thread pool) warm between compile
+// requests:
+//
+//   vast-front --serve <socket> [-j <jobs>]
+//   vast-front --connect <socket> [args...]
+//
+// The client sends its working directory and driver arguments over a local
+// socket, prints the output and the diagnostics the server sends back and
+// exits with the status of the compilation. Sending `--shutdown` as the only
+// argument stops the server. Every accepted connection is served by a task
+// of the shared thread pool, so requests compile concurrently.
+//
+// Message format: number of strings followed by length-prefixed strings,
+// everything encoded as 32-bit little endian integers. The response is a
+// 32-bit exit status followed by a message of the standard output, i.e.,
+// the output of `-o -`, and of the diagnostics of the compilation.
+// Messages over the size limit of their receiver are rejected.
+//
+//===----------------------------------------------------------------------===//
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/StringSaver.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Context.hpp"
+#include "vast/Frontend/Options.hpp"
+
+#include <atomic>
+
+#ifdef LLVM_ON_UNIX
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+namespace vast::cc {
+
+    // Lives inside batch.cpp
+    unsigned compile_units(
+        std::vector< argv_storage > command_lines,
+        const std::string &driver_path,
+        bool canonical_prefixes,
+        void *main_addr,
+        llvm::ThreadPool &pool,
+        llvm::raw_ostream *diagnostics
+    );
+
+    // Lives inside cc1.cpp
+    void initialize_targets();
+
+    constexpr string_ref shutdown_request = "--shutdown";
+
+#ifdef LLVM_ON_UNIX
+    namespace {
+
+        using message_t = std::vector< std::string >;
+
+        // Requests hold only a directory and arguments, responses hold the
+        // output of the compilation as well.
+        constexpr std::size_t max_request_size  = std::size_t(16) << 20;
+        constexpr std::size_t max_response_size = std::size_t(1) << 30;
+
+        struct socket_t
+        {
+            explicit socket_t(int fd) : fd(fd) {}
+
+            socket_t(const socket_t &) = delete;
+            socket_t &operator=(const socket_t &) = delete;
+
+            ~socket_t() {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+            }
+
+            explicit operator bool() const { return fd >= 0; }
+
+            bool write(const void *data, std::size_t size) const {
+                auto bytes = static_cast< const char * >(data);
+                while (size) {
+                    auto written = ::write(fd, bytes, size);
+                    if (written <= 0) {
+                        return false;
+                    }
+                    bytes += written;
+                    size  -= static_cast< std::size_t >(written);
+                }
+                return true;
+            }
+
+            bool read(void *data, std::size_t size) const {
+                auto bytes = static_cast< char * >(data);
+                while (size) {
+                    auto received = ::read(fd, bytes, size);
+                    if (received <= 0) {
+                        return false;
+                    }
+                    bytes += received;
+                    size  -= static_cast< std::size_t >(received);
+                }
+                return true;
+            }
+
+            bool write_u32(std::uint32_t value) const {
+                char buff[sizeof(value)];
+                llvm::support::endian::write32le(buff, value);
+                return write(buff, sizeof(buff));
+            }
+
+            std::optional< std::uint32_t > read_u32() const {
+                char buff[sizeof(std::uint32_t)];
+                if (!read(buff, sizeof(buff))) {
+                    return std::nullopt;
+                }
+                return llvm::support::endian::read32le(buff);
+            }
+
+            bool write_message(const message_t &msg) const {
+                if (!write_u32(static_cast< std::uint32_t >(msg.size()))) {
+                    return false;
+                }
+
+                for (const auto &str : msg) {
+                    if (!write_u32(static_cast< std::uint32_t >(str.size())) || !write(str.data(), str.size())) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            // Fails on messages of more than `limit` bytes, before their
+            // strings are allocated.
+            std::optional< message_t > read_message(std::size_t limit) const {
+                auto count = read_u32();
+                if (!count) {
+                    return std::nullopt;
+                }
+
+                std::size_t total = sizeof(std::uint32_t) * (std::size_t(count.value()) + 1);
+                if (total > limit) {
+                    return std::nullopt;
+                }
+
+                message_t msg(count.value());
+                for (auto &str : msg) {
+                    auto size = read_u32();
+                    if (!size) {
+                        return std::nullopt;
+                    }
+
+                    total += size.value();
+                    if (total > limit) {
+                        return std::nullopt;
+                    }
+
+                    str.resize(size.value());
+                    if (!read(str.data(), str.size())) {
+                        return std::nullopt;
+                    }
+                }
+
+                return msg;
+            }
+
+            int fd;
+        };
+
+        std::optional< sockaddr_un > make_address(string_ref path) {
+            sockaddr_un addr = {};
+            addr.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(addr.sun_path)) {
+                llvm::errs() << "error: socket path is too long: " << path << "\n";
+                return std::nullopt;
+            }
+
+            std::copy(path.begin(), path.end(), addr.sun_path);
+            return addr;
+        }
+
+        struct response_t
+        {
+            int status = 1;
+            std::string output;
+            std::string diagnostics;
+        };
+
+        bool send_response(const socket_t &client, const response_t &response) {
+            return client.write_u32(static_cast< std::uint32_t >(response.status))
+                && client.write_message({ response.output, response.diagnostics });
+        }
+
+        response_t serve_request(
+            const message_t &request,
+            const std::string &driver_path,
+            bool canonical_prefixes,
+            void *main_addr,
+            llvm::ThreadPool &pool
+        ) {
+            response_t response;
+
+            // request contains working directory followed by driver arguments
+            if (request.empty()) {
+                response.diagnostics = "error: empty compile request\n";
+                return response;
+            }
+
+            llvm::BumpPtrAllocator allocator;
+            llvm::StringSaver saver(allocator);
+
+            // Output to the standard output of the client is written to a
+            // temporary file of the request, as units of concurrent requests
+            // share the standard output of the server.
+            llvm::SmallString< 128 > stdout_path;
+            auto redirect_stdout = [&] () -> const char * {
+                if (stdout_path.empty()) {
+                    if (auto ec = llvm::sys::fs::createTemporaryFile("vast-serve", "out", stdout_path)) {
+                        response.diagnostics = "error: unable to create temporary output: " + ec.message() + "\n";
+                        return nullptr;
+                    }
+                }
+                return stdout_path.c_str();
+            };
+
+            argv_storage line;
+            line.push_back(saver.save(driver_path).data());
+            line.push_back("-working-directory");
+            line.push_back(saver.save(request.front()).data());
+            for (auto it = std::next(request.begin()); it != request.end(); ++it) {
+                if (*it == "-o-" || (*it == "-o" && std::next(it) != request.end() && *std::next(it) == "-")) {
+                    auto path = redirect_stdout();
+                    if (!path) {
+                        return response;
+                    }
+
+                    line.push_back("-o");
+                    line.push_back(path);
+                    if (*it == "-o") {
+                        ++it;
+                    }
+                    continue;
+                }
+
+                line.push_back(saver.save(*it).data());
+            }
+
+            std::vector< argv_storage > command_lines;
+            command_lines.push_back(std::move(line));
+
+            llvm::raw_string_ostream diagnostics(response.diagnostics);
+            auto failures = compile_units(
+                std::move(command_lines), driver_path, canonical_prefixes, main_addr, pool,
+                &diagnostics
+            );
+            diagnostics.flush();
+
+            response.status = failures ? 1 : 0;
+
+            if (!stdout_path.empty()) {
+                if (auto output = llvm::MemoryBuffer::getFile(stdout_path)) {
+                    response.output = output.get()->getBuffer().str();
+                }
+                llvm::sys::fs::remove(stdout_path);
+            }
+
+            return response;
+        }
+
+    } // namespace
+#endif
+
+    int serve(argv_t argv, const std::string &driver_path, bool canonical_prefixes, void *main_addr) {
+#ifdef LLVM_ON_UNIX
+        if (argv.empty()) {
+            llvm::errs() << "error: expected path to the server socket\n";
+            return 1;
+        }
+
+        string_ref path = argv.front();
+
+        unsigned jobs = 0;
+        if (argv.size() == 3 && string_ref(argv[1]) == "-j") {
+            if (string_ref(argv[2]).getAsInteger(10, jobs)) {
+                llvm::errs() << "error: invalid number of server jobs\n";
+                return 1;
+            }
+        } else if (argv.size() != 1) {
+            llvm::errs() << "error: unexpected arguments of the server mode\n";
+            return 1;
+        }
+
+        auto addr = make_address(path);
+        if (!addr) {
+            return 1;
+        }
+
+        socket_t server(::socket(AF_UNIX, SOCK_STREAM, 0));
+        if (!server) {
+            llvm::errs() << "error: unable to create server socket\n";
+            return 1;
+        }
+
+        // remove stale socket of a previous server
+        llvm::sys::fs::remove(path);
+
+        auto sock_addr = reinterpret_cast< sockaddr * >(&addr.value());
+        if (::bind(server.fd, sock_addr, sizeof(sockaddr_un)) != 0 || ::listen(server.fd, SOMAXCONN) != 0) {
+            llvm::errs() << "error: unable to listen on socket: " << path << "\n";
+            return 1;
+        }
+
+        initialize_targets();
+
+        llvm::ThreadPool pool(llvm::hardware_concurrency(jobs));
+        set_shared_thread_pool(&pool);
+
+        // The shutdown request stops accepting connections, requests that are
+        // already accepted are finished.
+        std::atomic< bool > stopping = false;
+
+        llvm::ThreadPoolTaskGroup connections(pool);
+        while (!stopping) {
+            auto fd = ::accept(server.fd, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+
+            connections.async([&, fd] {
+                socket_t client(fd);
+
+                auto request = client.read_message(max_request_size);
+                if (!request) {
+                    response_t rejected;
+                    rejected.diagnostics = "error: malformed compile request or larger than "
+                        + std::to_string(max_request_size) + " bytes\n";
+                    send_response(client, rejected);
+                    return;
+                }
+
+                if (request->size() == 2 && string_ref(request->back()) == shutdown_request) {
+                    stopping = true;
+                    // Wakes up the accepting loop.
+                    ::shutdown(server.fd, SHUT_RDWR);
+                    response_t stopped;
+                    stopped.status = 0;
+                    send_response(client, stopped);
+                    return;
+                }
+
+                send_response(client, serve_request(*request, driver_path, canonical_prefixes, main_addr, pool));
+            });
+        }
+
+        connections.wait();
+        set_shared_thread_pool(nullptr);
+        llvm::sys::fs::remove(path);
+        return 0;
+#else
+        llvm::errs() << "error: server mode is supported only on unix platforms\n";
+        return 1;
+#endif
+    }
+
+    int connect_to_server(argv_t argv) {
+#ifdef LLVM_ON_UNIX
+        if (argv.empty()) {
+            llvm::errs() << "error: expected path to the server socket\n";
+            return 1;
+        }
+
+        auto addr = make_address(argv.front());
+        if (!addr) {
+            return 1;
+        }
+
+        socket_t server(::socket(AF_UNIX, SOCK_STREAM, 0));
+        auto sock_addr = reinterpret_cast< sockaddr * >(&addr.value());
+        if (!server || ::connect(server.fd, sock_addr, sizeof(sockaddr_un)) != 0) {
+            llvm::errs() << "error: unable to connect to server: " << argv.front() << "\n";
+            return 1;
+        }
+
+        llvm::SmallString< 128 > cwd;
+        if (llvm::sys::fs::current_path(cwd)) {
+            llvm::errs() << "error: unable to get current working directory\n";
+            return 1;
+        }
+
+        message_t request = { cwd.str().str() };
+        for (auto arg : llvm::drop_begin(argv)) {
+            request.emplace_back(arg);
+        }
+
+        if (!server.write_message(request)) {
+            llvm::errs() << "error: unable to send compile request\n";
+            return 1;
+        }
+
+        auto status = server.read_u32();
+        auto streams = status ? server.read_message(max_response_size) : std::nullopt;
+        if (!streams || streams->size() != 2) {
+            llvm::errs() << "error: server did not respond\n";
+            return 1;
+        }
+
+        llvm::outs() << streams->front();
+        llvm::errs() << streams->back();
+        return static_cast< int >(status.value());
+#else
+        llvm::errs() << "error: server mode is supported only on unix platforms\n";
+        return 1;
+#endif
+    }
+
+} // namespace vast::cc
@@ -0,0 +1,226 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/Dialect.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/InitAllDialects.h"
+#include "mlir/Support/FileUtilities.h"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ToolOutputFile.h"
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Linker/Linker.hpp"
+#include "vast/Util/Common.hpp"
+
+namespace vast::cl
+{
+    namespace cl = llvm::cl;
+
+    // clang-format off
+    cl::OptionCategory generic("Vast Generic Options");
+
+    struct vast_link_options {
+        cl::list< std::string > input_files{
+            cl::desc("<input files or directories>"),
+            cl::Positional,
+            cl::OneOrMore,
+            cl::cat(generic)
+        };
+        cl::opt< std::string > output{ "o",
+            cl::desc("Output file of the linked module"),
+            cl::value_desc("file"),
+            cl::init("-"),
+            cl::cat(generic)
+        };
+        cl::opt< bool > emit_bytecode{ "emit-bytecode",
+            cl::desc("Write the linked module as bytecode"),
+            cl::init(false),
+            cl::cat(generic)
+        };
+        cl::opt< unsigned > jobs{ "j",
+            cl::desc("Number of modules parsed ahead of the linked one, the hardware threads by default"),
+            cl::init(0),
+            cl::cat(generic)
+        };
+        cl::opt< unsigned > partitions{ "partitions",
+            cl::desc("Assign the modules to partitions for distributed analysis instead of linking them"),
+            cl::value_desc("count"),
+            cl::init(0),
+            cl::cat(generic)
+        };
+        cl::opt< bool > stats{ "stats",
+            cl::desc("Print statistics of the symbol resolution to stderr"),
+            cl::init(false),
+            cl::cat(generic)
+        };
+    };
+    // clang-format on
+
+    static llvm::ManagedStatic< vast_link_options > options;
+
+    void register_options() { *options; }
+} // namespace vast::cl
+
+namespace vast
+{
+    bool is_module_file(string_ref path) {
+        auto ext = llvm::sys::path::extension(path);
+        return ext == ".mlir" || ext == ".mlirbc";
+    }
+
+    // Directories are searched recursively for `.mlir` and `.mlirbc` files,
+    // in sorted order, so the program does not depend on the file system.
+    logical_result collect_inputs(std::vector< std::string > &files) {
+        for (const auto &input : cl::options->input_files) {
+            if (!llvm::sys::fs::is_directory(input)) {
+                files.push_back(input);
+                continue;
+            }
+
+            std::vector< std::string > found;
+            std::error_code ec;
+            for (llvm::sys::fs::recursive_directory_iterator it(input, ec), end; it != end && !ec; it.increment(ec)) {
+                if (it->type() != llvm::sys::fs::file_type::directory_file && is_module_file(it->path())) {
+                    found.push_back(it->path());
+                }
+            }
+
+            if (ec) {
+                llvm::errs() << "error: cannot read directory " << input << ": " << ec.message() << "\n";
+                return mlir::failure();
+            }
+
+            llvm::sort(found);
+            files.insert(files.end(), found.begin(), found.end());
+        }
+
+        return mlir::success();
+    }
+
+    void print_stats(const link::link_stats &stats) {
+        llvm::errs() << "units: " << stats.units << "\n"
+                     << "resolved declarations: " << stats.resolved << "\n"
+                     << "overridden definitions: " << stats.overridden << "\n"
+                     << "renamed internal symbols: " << stats.renamed << "\n"
+                     << "deduplicated types: " << stats.deduplicated << "\n"
+                     << "conflicting types: " << stats.conflicting_types << "\n"
+                     << "conflicting type definitions: " << stats.type_conflicts << "\n"
+                     << "errors: " << stats.errors << "\n";
+    }
+
+    //
+    // Prints `<partition> <file>` for every input. Only the external symbol
+    // tables of the modules are kept, so the inputs do not have to fit in
+    // memory together.
+    //
+    logical_result partition(mcontext_t &ctx, llvm::ArrayRef< std::string > files, unsigned window) {
+        std::vector< link::unit_symbols > units(files.size());
+        auto status = link::parse_files(ctx, files, window, [&] (std::size_t i, vast_module mod) {
+            units[i] = link::external_symbols(mod);
+            return mlir::success();
+        });
+
+        if (failed(status)) {
+            return mlir::failure();
+        }
+
+        auto assignment = link::partition_units(units, cl::options->partitions);
+
+        if (cl::options->stats) {
+            llvm::errs() << "units: " << files.size() << "\n"
+                         << "partitions: " << cl::options->partitions.getValue() << "\n"
+                         << "cross-partition references: "
+                         << link::cross_partition_references(units, assignment) << "\n";
+        }
+
+        std::string err;
+        auto out = mlir::openOutputFile(cl::options->output, &err);
+        if (!out) {
+            llvm::errs() << "error: " << err << "\n";
+            return mlir::failure();
+        }
+
+        for (auto [i, file] : llvm::enumerate(files)) {
+            out->os() << assignment[i] << " " << file << "\n";
+        }
+
+        out->keep();
+        return mlir::success();
+    }
+
+    logical_result run(mcontext_t &ctx) {
+        std::vector< std::string > files;
+        if (failed(collect_inputs(files))) {
+            return mlir::failure();
+        }
+
+        if (files.empty()) {
+            llvm::errs() << "error: no modules to link\n";
+            return mlir::failure();
+        }
+
+        unsigned window = cl::options->jobs;
+        if (window == 0) {
+            window = llvm::hardware_concurrency().compute_thread_count();
+        }
+
+        if (cl::options->partitions != 0) {
+            return partition(ctx, files, window);
+        }
+
+        link::link_stats stats;
+        auto program = link::link_files(ctx, files, window, &stats);
+
+        if (cl::options->stats) {
+            print_stats(stats);
+        }
+
+        if (!program) {
+            llvm::errs() << "error: cannot link modules\n";
+            return mlir::failure();
+        }
+
+        std::string err;
+        auto out = mlir::openOutputFile(cl::options->output, &err);
+        if (!out) {
+            llvm::errs() << "error: " << err << "\n";
+            return mlir::failure();
+        }
+
+        if (cl::options->emit_bytecode) {
+            if (failed(mlir::writeBytecodeToFile(program.get(), out->os()))) {
+                llvm::errs() << "error: cannot write bytecode\n";
+                return mlir::failure();
+            }
+        } else {
+            program->print(out->os());
+        }
+
+        out->keep();
+        return mlir::success();
+    }
+
+} // namespace vast
+
+int main(int argc, char **argv) {
+    llvm::cl::HideUnrelatedOptions({ &vast::cl::generic });
+    vast::cl::register_options();
+    llvm::cl::ParseCommandLineOptions(argc, argv, "VAST module linker\n");
+
+    mlir::DialectRegistry registry;
+    vast::registerAllDialects(registry);
+    mlir::registerAllDialects(registry);
+
+    vast::mcontext_t ctx(registry);
+    ctx.loadAllAvailableDialects();
+
+    std::exit(failed(vast::run(ctx)));
+}
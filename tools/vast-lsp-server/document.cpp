@@ -0,0 +1,266 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/lsp/document.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Util/Symbols.hpp"
+
+#include <algorithm>
+
+namespace vast::lsp
+{
+    namespace
+    {
+        std::optional< mlir::lsp::Location > to_lsp_location(mlir::Location loc) {
+            auto file_loc = loc->findInstanceOf< mlir::FileLineColLoc >();
+            if (!file_loc) {
+                return std::nullopt;
+            }
+
+            auto uri = mlir::lsp::URIForFile::fromFile(file_loc.getFilename().getValue());
+            if (!uri) {
+                llvm::consumeError(uri.takeError());
+                return std::nullopt;
+            }
+
+            mlir::lsp::Position pos(int(file_loc.getLine()) - 1, int(file_loc.getColumn()) - 1);
+
+            mlir::lsp::Location result;
+            result.uri   = *uri;
+            result.range = mlir::lsp::Range(pos, pos);
+            return result;
+        }
+
+        string_ref file_of(operation op) {
+            if (auto file_loc = op->getLoc()->findInstanceOf< mlir::FileLineColLoc >()) {
+                return file_loc.getFilename().getValue();
+            }
+            return {};
+        }
+
+    } // namespace
+
+    c_document::c_document(std::filesystem::path path, mcontext_t &mctx)
+        : _path(std::move(path)), _mctx(mctx)
+        , _bodies(mlir::ModuleOp::create(mlir::UnknownLoc::get(&mctx)))
+    {}
+
+    bool c_document::update(std::string contents, std::int64_t version) {
+        namespace cg = repl::codegen;
+
+        _contents = std::move(contents);
+        _version  = version;
+
+        if (_session) {
+            _unit = cg::lazy_session::take_unit(std::move(_session));
+        }
+
+        // The preamble of the unit is reused as long as the includes do not
+        // change.
+        if (_unit) {
+            if (!cg::reparse_source(*_unit, _path, _contents)) {
+                _unit.reset();
+            }
+        } else {
+            _unit = cg::parse_source(_path, _contents);
+        }
+
+        _session = cg::make_lazy_session(_unit, _mctx);
+        if (!_session) {
+            return false;
+        }
+
+        auto print = cg::fingerprint(_session->ast());
+        carry_over_bodies(print);
+
+        _functions.clear();
+        for (const auto &entry : print.functions) {
+            _functions.push_back({ entry.getKey().str(), entry.getValue().line, entry.getValue().last_line });
+        }
+
+        llvm::sort(_functions, [] (const auto &a, const auto &b) { return a.first < b.first; });
+
+        _definitions.clear();
+        for (auto &op : _session->module().getBody()->getOperations()) {
+            if (auto symbol = mlir::dyn_cast< util::vast_symbol_interface >(op)) {
+                _definitions.try_emplace(util::symbol_name(symbol), op.getLoc());
+            } else if (auto symbol = mlir::dyn_cast< util::mlir_symbol_interface >(op)) {
+                _definitions.try_emplace(util::symbol_name(symbol), op.getLoc());
+            }
+        }
+
+        _print = std::move(print);
+        return true;
+    }
+
+    void c_document::carry_over_bodies(const repl::codegen::source_fingerprint &print) {
+        llvm::SmallVector< std::string > stale;
+        for (auto &entry : _generated) {
+            auto name = entry.getKey();
+            auto &body = entry.getValue();
+
+            if (!_print || !print.matches(*_print, name)) {
+                stale.push_back(name.str());
+                continue;
+            }
+
+            auto line = print.functions.lookup(name).line;
+            if (line != body.line) {
+                repl::codegen::shift_locations(body.fn, file_of(body.fn), int(line) - int(body.line));
+                body.line = line;
+                body.index.reset();
+            }
+        }
+
+        for (const auto &name : stale) {
+            _generated[name].fn->erase();
+            _generated.erase(name);
+        }
+    }
+
+    auto c_document::body_of(string_ref name) -> function_body * {
+        if (auto it = _generated.find(name); it != _generated.end()) {
+            return &it->second;
+        }
+
+        if (!_session || !_session->has_lazy_body(name)) {
+            return nullptr;
+        }
+
+        auto fn = _session->materialize(name);
+        if (!fn) {
+            return nullptr;
+        }
+
+        // The body is copied out of the module of the session, which is
+        // replaced by the next version.
+        auto bld  = mlir::OpBuilder::atBlockEnd(_bodies->getBody());
+        auto copy = mlir::cast< hl::FuncOp >(bld.clone(*fn));
+
+        auto &body = _generated[name];
+        body.line  = _print->functions.lookup(name).line;
+        body.fn    = copy;
+        return &body;
+    }
+
+    hl::FuncOp c_document::function_at(const mlir::lsp::Position &pos) {
+        unsigned line = pos.line + 1;
+        auto it = std::upper_bound(_functions.begin(), _functions.end(), line, [] (unsigned line, const auto &fn) {
+            return line < fn.first;
+        });
+
+        if (it == _functions.begin() || std::prev(it)->last < line) {
+            return {};
+        }
+
+        auto body = body_of(std::prev(it)->name);
+        return body ? body->fn : hl::FuncOp();
+    }
+
+    operation c_document::op_at(const mlir::lsp::Position &pos) {
+        auto fn = function_at(pos);
+        if (!fn) {
+            return nullptr;
+        }
+
+        auto &body = _generated[fn.getSymName()];
+        if (!body.index) {
+            body.index.emplace(fn);
+        }
+
+        // The innermost operation starting at the column or before it.
+        unsigned line = pos.line + 1, column = pos.character + 1;
+        auto file = file_of(fn);
+
+        operation result = nullptr;
+        body.index->positions([&] (string_ref op_file, unsigned op_line, unsigned op_column, operation op) {
+            if (op_file == file && op_line == line && op_column <= column) {
+                result = op;
+            }
+        });
+        return result;
+    }
+
+    std::optional< mlir::Location > c_document::definition_of(string_ref symbol) {
+        if (auto it = _generated.find(symbol); it != _generated.end()) {
+            return it->second.fn.getLoc();
+        }
+
+        if (auto it = _definitions.find(symbol); it != _definitions.end()) {
+            return it->second;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional< std::string > c_document::symbol_at(const mlir::lsp::Position &pos) {
+        auto op = op_at(pos);
+        if (!op) {
+            return std::nullopt;
+        }
+
+        return llvm::TypeSwitch< operation, std::optional< std::string > >(op)
+            .Case< hl::CallOp >([&] (auto call) { return call.getCallee().str(); })
+            .Case< hl::FuncRefOp >([&] (auto ref) { return ref.getFunction().str(); })
+            .Case< hl::GlobalRefOp >([&] (auto ref) { return ref.getGlobal().str(); })
+            .Case< hl::FuncOp >([&] (auto fn) { return fn.getSymName().str(); })
+            .Default([] (auto) { return std::nullopt; });
+    }
+
+    std::optional< mlir::lsp::Hover > c_document::hover(const mlir::lsp::Position &pos) {
+        auto op = op_at(pos);
+        if (!op) {
+            return std::nullopt;
+        }
+
+        std::string buff;
+        llvm::raw_string_ostream ss(buff);
+        op->print(ss, mlir::OpPrintingFlags().skipRegions());
+
+        mlir::lsp::Hover hover(mlir::lsp::Range(pos, pos));
+        if (auto loc = to_lsp_location(op->getLoc())) {
+            hover.range = loc->range;
+        }
+
+        hover.contents.kind  = mlir::lsp::MarkupKind::Markdown;
+        hover.contents.value = "```mlir\n" + ss.str() + "\n```";
+        return hover;
+    }
+
+    std::vector< mlir::lsp::Location > c_document::definition(const mlir::lsp::Position &pos) {
+        auto op = op_at(pos);
+        if (!op) {
+            return {};
+        }
+
+        auto def = llvm::TypeSwitch< operation, std::optional< mlir::Location > >(op)
+            .Case< hl::CallOp >([&] (auto call) { return definition_of(call.getCallee()); })
+            .Case< hl::FuncRefOp >([&] (auto ref) { return definition_of(ref.getFunction()); })
+            .Case< hl::GlobalRefOp >([&] (auto ref) { return definition_of(ref.getGlobal()); })
+            .Case< hl::DeclRefOp >([&] (auto ref) -> std::optional< mlir::Location > {
+                auto decl = ref.getDecl();
+                if (auto def = decl.getDefiningOp()) {
+                    return def->getLoc();
+                }
+                return decl.getLoc();
+            })
+            .Default([] (auto) { return std::nullopt; });
+
+        if (!def) {
+            return {};
+        }
+
+        if (auto loc = to_lsp_location(*def)) {
+            return { *loc };
+        }
+        return {};
+    }
+
+} // namespace vast::lsp
@@ -0,0 +1,143 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/lsp/indexer.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Tooling/JSONCompilationDatabase.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/Tools/lsp-server-support/Logging.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Threading.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/repl/codegen.hpp"
+
+namespace vast::lsp
+{
+    using mlir::lsp::Logger;
+
+    project_indexer::project_indexer(mlir::DialectRegistry &registry, std::string cache, unsigned threads)
+        : registry(registry), cache(std::move(cache)), pool(llvm::hardware_concurrency(threads))
+    {}
+
+    project_indexer::~project_indexer() {
+        cancelled = true;
+        pool.wait();
+    }
+
+    logical_result project_indexer::index(string_ref path, std::string &error) {
+        if (llvm::sys::fs::is_directory(path)) {
+            database = clang::tooling::CompilationDatabase::loadFromDirectory(path, error);
+        } else {
+            database = clang::tooling::JSONCompilationDatabase::loadFromFile(
+                path, error, clang::tooling::JSONCommandLineSyntax::AutoDetect
+            );
+        }
+
+        if (!database) {
+            return mlir::failure();
+        }
+
+        if (auto ec = llvm::sys::fs::create_directories(cache)) {
+            error = "cannot create " + cache + ": " + ec.message();
+            return mlir::failure();
+        }
+
+        auto commands = database->getAllCompileCommands();
+        total = commands.size();
+        for (auto &cmd : commands) {
+            pool.async([this, cmd = std::move(cmd)] { index_unit(cmd); });
+        }
+
+        return mlir::success();
+    }
+
+    std::string project_indexer::cache_path(
+        const clang::tooling::CompileCommand &cmd, string_ref contents
+    ) const {
+        llvm::MD5 hash;
+        hash.update(contents);
+        for (const auto &arg : cmd.CommandLine) {
+            hash.update(arg);
+            hash.update(llvm::ArrayRef< std::uint8_t >{ 0 });
+        }
+        hash.update(cmd.Directory);
+
+        llvm::MD5::MD5Result digest;
+        hash.final(digest);
+
+        llvm::SmallString< 128 > path(cache);
+        auto stem = llvm::sys::path::stem(cmd.Filename);
+        llvm::sys::path::append(path, (stem + "." + digest.digest() + ".qidx").str());
+        return path.str().str();
+    }
+
+    void project_indexer::index_unit(const clang::tooling::CompileCommand &cmd) {
+        if (cancelled) {
+            return;
+        }
+
+        // Indexing does not slow down the requests of the editor.
+        llvm::set_thread_priority(llvm::ThreadPriority::Background);
+
+        llvm::SmallString< 128 > file(cmd.Filename);
+        llvm::sys::fs::make_absolute(cmd.Directory, file);
+
+        auto source = llvm::MemoryBuffer::getFile(file);
+        if (!source) {
+            Logger::error("cannot read {0}: {1}", file, source.getError().message());
+            return;
+        }
+
+        auto path = cache_path(cmd, (*source)->getBuffer());
+
+        auto add = [&] {
+            std::string error;
+            auto index = query::index_file::open(path, error);
+            if (!index) {
+                return false;
+            }
+
+            std::lock_guard guard(lock);
+            units[file] = std::move(index);
+            Logger::debug("indexed {0} ({1} of {2})", file, units.size(), total);
+            return true;
+        };
+
+        // Unchanged units are loaded from the cache.
+        if (add()) {
+            return;
+        }
+
+        mcontext_t mctx(registry, mcontext_t::Threading::DISABLED);
+        mctx.loadAllAvailableDialects();
+
+        auto unit = repl::codegen::parse_command_line(cmd.CommandLine, cmd.Directory);
+        auto session = repl::codegen::make_lazy_session(unit, mctx);
+        if (!session) {
+            Logger::error("cannot compile {0}", file);
+            return;
+        }
+
+        session->materialize_all();
+
+        // Readers do not see partially written indices, nor do units of the
+        // same command overwrite each other.
+        auto partial = llvm::formatv("{0}.{1}.tmp", path, llvm::get_threadid()).str();
+        if (failed(query::build_index(session->module(), partial))) {
+            return;
+        }
+
+        if (auto ec = llvm::sys::fs::rename(partial, path)) {
+            Logger::error("cannot write {0}: {1}", path, ec.message());
+            return;
+        }
+
+        add();
+    }
+
+} // namespace vast::lsp
@@ -0,0 +1,304 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/lsp/server.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/Tools/lsp-server-support/Logging.h>
+#include <mlir/Tools/lsp-server-support/Protocol.h>
+#include <mlir/Tools/lsp-server-support/Transport.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/lsp/document.hpp"
+#include "vast/lsp/indexer.hpp"
+
+namespace vast::lsp
+{
+    using namespace mlir::lsp;
+
+    namespace
+    {
+        // Location printed by the index as `file:line:column`.
+        std::optional< Location > parse_location(string_ref loc) {
+            auto [rest, column_str] = loc.rsplit(':');
+            auto [file, line_str]   = rest.rsplit(':');
+
+            int line = 0, column = 0;
+            if (file.empty() || line_str.getAsInteger(10, line) || column_str.getAsInteger(10, column)) {
+                return std::nullopt;
+            }
+
+            auto uri = URIForFile::fromFile(file);
+            if (!uri) {
+                llvm::consumeError(uri.takeError());
+                return std::nullopt;
+            }
+
+            Position pos(line - 1, column - 1);
+
+            Location result;
+            result.uri   = *uri;
+            result.range = Range(pos, pos);
+            return result;
+        }
+
+        //
+        // Requests are answered one after another, each of them generates at
+        // most the body of the function it refers to, hence the latency does
+        // not depend on the number of functions of the document.
+        //
+        struct c_server
+        {
+            c_server(mcontext_t &mctx, project_indexer *indexer) : mctx(mctx), indexer(indexer) {}
+
+            llvm::Error run(JSONTransport &transport) {
+                MessageHandler handler(transport);
+                handler.method("initialize", this, &c_server::on_initialize);
+                handler.notification("initialized", this, &c_server::on_initialized);
+                handler.method("shutdown", this, &c_server::on_shutdown);
+
+                handler.notification("textDocument/didOpen", this, &c_server::on_open);
+                handler.notification("textDocument/didChange", this, &c_server::on_change);
+                handler.notification("textDocument/didClose", this, &c_server::on_close);
+
+                handler.method("textDocument/hover", this, &c_server::on_hover);
+                handler.method("textDocument/definition", this, &c_server::on_definition);
+                handler.method("textDocument/references", this, &c_server::on_references);
+                handler.method("vast/functionHL", this, &c_server::on_function_hl);
+
+                return transport.run(handler);
+            }
+
+            void on_initialize(const InitializeParams &, Callback< llvm::json::Value > reply) {
+                llvm::json::Object sync{
+                    { "openClose", true },
+                    { "change", int(TextDocumentSyncKind::Incremental) },
+                    { "save", true }
+                };
+
+                llvm::json::Object capabilities{
+                    { "textDocumentSync", std::move(sync) },
+                    { "hoverProvider", true },
+                    { "definitionProvider", true },
+                    { "referencesProvider", indexer != nullptr }
+                };
+
+                reply(llvm::json::Object{
+                    { "serverInfo", llvm::json::Object{ { "name", "vast-lsp-server" } } },
+                    { "capabilities", std::move(capabilities) }
+                });
+            }
+
+            void on_initialized(const InitializedParams &) {}
+
+            void on_shutdown(const NoParams &, Callback< std::nullptr_t > reply) {
+                shutdown = true;
+                reply(nullptr);
+            }
+
+            void on_open(const DidOpenTextDocumentParams &params) {
+                const auto &item = params.textDocument;
+                auto &doc = documents[item.uri.file()];
+                doc = std::make_unique< c_document >(item.uri.file().str(), mctx);
+                if (!doc->update(item.text, item.version)) {
+                    Logger::info("{0} does not compile", item.uri.file());
+                }
+            }
+
+            void on_change(const DidChangeTextDocumentParams &params) {
+                auto it = documents.find(params.textDocument.uri.file());
+                if (it == documents.end()) {
+                    return;
+                }
+
+                auto &doc = it->second;
+                auto contents = doc->contents();
+                if (failed(TextDocumentContentChangeEvent::applyTo(params.contentChanges, contents))) {
+                    Logger::error("failed to apply changes to {0}", params.textDocument.uri.file());
+                    return;
+                }
+
+                if (!doc->update(std::move(contents), params.textDocument.version)) {
+                    Logger::info("{0} does not compile", params.textDocument.uri.file());
+                }
+            }
+
+            void on_close(const DidCloseTextDocumentParams &params) {
+                documents.erase(params.textDocument.uri.file());
+            }
+
+            c_document *document(const TextDocumentPositionParams &params) {
+                auto it = documents.find(params.textDocument.uri.file());
+                return it != documents.end() ? it->second.get() : nullptr;
+            }
+
+            void on_hover(const TextDocumentPositionParams &params, Callback< std::optional< Hover > > reply) {
+                auto doc = document(params);
+                reply(doc ? doc->hover(params.position) : std::nullopt);
+            }
+
+            void on_definition(
+                const TextDocumentPositionParams &params, Callback< std::vector< Location > > reply
+            ) {
+                auto doc = document(params);
+                reply(doc ? doc->definition(params.position) : std::vector< Location >());
+            }
+
+            // Users of the symbol at the position in all units of the project,
+            // answered from the index without compiling the units.
+            void on_references(const ReferenceParams &params, Callback< std::vector< Location > > reply) {
+                auto doc  = document(params);
+                auto name = doc ? doc->symbol_at(params.position) : std::nullopt;
+                if (!name || !indexer) {
+                    return reply(std::vector< Location >());
+                }
+
+                std::vector< Location > result;
+                if (params.context.includeDeclaration) {
+                    result = doc->definition(params.position);
+                }
+
+                indexer->users(*name, [&] (const query::index_operation &user) {
+                    if (auto loc = parse_location(user.location)) {
+                        result.push_back(std::move(*loc));
+                    }
+                });
+
+                reply(std::move(result));
+            }
+
+            // The high-level module of the function around the position, null
+            // if there is none.
+            void on_function_hl(const TextDocumentPositionParams &params, Callback< llvm::json::Value > reply) {
+                auto doc = document(params);
+                auto fn  = doc ? doc->function_at(params.position) : hl::FuncOp();
+                if (!fn) {
+                    return reply(nullptr);
+                }
+
+                std::string buff;
+                llvm::raw_string_ostream ss(buff);
+                fn->print(ss);
+
+                reply(llvm::json::Object{
+                    { "name", fn.getSymName() },
+                    { "hl", ss.str() }
+                });
+            }
+
+            mcontext_t &mctx;
+            llvm::StringMap< std::unique_ptr< c_document > > documents;
+
+            // null if the server runs without a compilation database
+            project_indexer *indexer;
+
+            bool shutdown = false;
+        };
+
+    } // namespace
+
+    logical_result c_server_main(int argc, char **argv, mlir::DialectRegistry &registry) {
+        llvm::cl::opt< bool > c_sources{
+            "c-sources", llvm::cl::desc("Serve C sources instead of MLIR modules")
+        };
+
+        llvm::cl::opt< Logger::Level > log_level{
+            "log",
+            llvm::cl::desc("Verbosity of log messages written to stderr"),
+            llvm::cl::values(
+                clEnumValN(Logger::Level::Error, "error", "Error messages only"),
+                clEnumValN(Logger::Level::Info, "info", "High level execution tracing"),
+                clEnumValN(Logger::Level::Debug, "verbose", "Low level details")
+            ),
+            llvm::cl::init(Logger::Level::Info),
+        };
+
+        llvm::cl::opt< bool > pretty{
+            "pretty", llvm::cl::desc("Pretty-print JSON output"), llvm::cl::init(false)
+        };
+
+        llvm::cl::opt< bool > lit_test{
+            "lit-test",
+            llvm::cl::desc("Read delimited messages, pretty-print the output and log verbosely, "
+                           "intended to simplify lit tests"),
+            llvm::cl::init(false),
+        };
+
+        llvm::cl::opt< std::string > compile_commands{
+            "compile-commands",
+            llvm::cl::desc("Compilation database, or its directory, of the project to index in the background"),
+            llvm::cl::value_desc("path")
+        };
+
+        llvm::cl::opt< std::string > index_cache{
+            "index-cache",
+            llvm::cl::desc("Directory of the index files, `.vast-index` next to the database by default"),
+            llvm::cl::value_desc("directory")
+        };
+
+        llvm::cl::opt< unsigned > index_threads{
+            "index-threads",
+            llvm::cl::desc("Number of threads indexing the project, half of the hardware threads by default"),
+            llvm::cl::init(0)
+        };
+
+        llvm::cl::ParseCommandLineOptions(argc, argv, "VAST C language server");
+
+        if (lit_test) {
+            pretty    = true;
+            log_level = Logger::Level::Debug;
+        }
+
+        Logger::setLogLevel(log_level);
+
+        // Workaround for the transport being unable to read binary input.
+        llvm::sys::ChangeStdinToBinary();
+
+        auto style = lit_test ? JSONStreamStyle::Delimited : JSONStreamStyle::Standard;
+        JSONTransport transport(stdin, llvm::outs(), style, pretty);
+
+        mcontext_t mctx(registry);
+        mctx.loadAllAvailableDialects();
+
+        std::unique_ptr< project_indexer > indexer;
+        if (!compile_commands.empty()) {
+            std::string cache = index_cache;
+            if (cache.empty()) {
+                llvm::SmallString< 128 > dir(compile_commands.getValue());
+                if (!llvm::sys::fs::is_directory(dir)) {
+                    llvm::sys::path::remove_filename(dir);
+                }
+                llvm::sys::path::append(dir, ".vast-index");
+                cache = dir.str().str();
+            }
+
+            unsigned threads = index_threads;
+            if (threads == 0) {
+                threads = std::max(1u, llvm::hardware_concurrency().compute_thread_count() / 2);
+            }
+
+            indexer = std::make_unique< project_indexer >(registry, cache, threads);
+
+            std::string error;
+            if (failed(indexer->index(compile_commands, error))) {
+                Logger::error("cannot index {0}: {1}", compile_commands.getValue(), error);
+                indexer.reset();
+            }
+        }
+
+        c_server server(mctx, indexer.get());
+        if (auto error = server.run(transport)) {
+            Logger::error("transport error: {0}", llvm::toString(std::move(error)));
+            return mlir::failure();
+        }
+
+        return mlir::success(server.shutdown);
+    }
+
+} // namespace vast::lsp
@@ -10,10 +10,21 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Dialects.hpp"
+#include "vast/lsp/server.hpp"
+
+#include <string_view>
 
 int main(int argc, char **argv) {
     mlir::DialectRegistry registry;
     mlir::registerAllDialects(registry);
     vast::registerAllDialects(registry);
+
+    // C sources are served by VAST itself, modules by the MLIR server.
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "--c-sources" || std::string_view(argv[i]) == "-c-sources") {
+            return failed(vast::lsp::c_server_main(argc, argv, registry));
+        }
+    }
+
     return failed(MlirLspServerMain(argc, argv, registry));
 }
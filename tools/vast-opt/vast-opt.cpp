@@ -3,18 +3,26 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/InitAllPasses.h"
+#include "mlir/Parser/Parser.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Target/LLVMIR/Dialect/All.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 VAST_UNRELAX_WARNINGS
 
@@ -23,6 +31,234 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/Passes.hpp"
 #include "vast/Conversion/Passes.hpp"
 #include "vast/Dialect/Dialects.hpp"
+#include "vast/Frontend/Pipelines.hpp"
+#include "vast/Target/LLVMIR/Convert.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <vector>
+
+//
+// Batch mode (--batch=<list>) runs the pipeline given on the command line
+// over many modules in one process, so that the startup and the registration
+// of dialects and passes are paid once. Modules are processed in parallel,
+// each in its own MLIR context.
+//
+namespace vast::opt {
+
+    namespace cl = llvm::cl;
+
+    static cl::opt< std::string > batch(
+        "batch",
+        cl::desc("Process the modules listed in the file, one '<input> [<output>]' per line"),
+        cl::value_desc("list"), cl::init("")
+    );
+
+    static cl::opt< unsigned > batch_jobs(
+        "batch-jobs",
+        cl::desc("Number of modules processed in parallel in the batch mode (0 = all cores)"),
+        cl::init(0)
+    );
+
+    struct batch_entry
+    {
+        std::string input;
+        std::string output;
+    };
+
+    struct batch_result
+    {
+        bool ok = false;
+        double ms = 0;
+    };
+
+    // Modules without an explicit output are written next to their input.
+    std::string default_output(llvm::StringRef input) {
+        llvm::SmallString< 128 > output(input);
+        llvm::sys::path::replace_extension(output, "opt.mlir");
+        return output.str().str();
+    }
+
+    std::optional< std::vector< batch_entry > > read_batch_list(llvm::StringRef path) {
+        auto buffer = llvm::MemoryBuffer::getFileOrSTDIN(path, /* is_text */ true);
+        if (!buffer) {
+            llvm::errs() << "error: cannot read batch list '" << path << "': "
+                         << buffer.getError().message() << "\n";
+            return std::nullopt;
+        }
+
+        std::vector< batch_entry > entries;
+        for (llvm::line_iterator line(**buffer, /* skip_blanks */ true, '#'); !line.is_at_eof(); ++line) {
+            auto [input, output] = llvm::getToken(line->trim());
+            entries.push_back({
+                input.str(), output.empty() ? default_output(input) : output.trim().str()
+            });
+        }
+
+        return entries;
+    }
+
+    bool process(
+        const batch_entry &entry,
+        mlir::DialectRegistry &registry,
+        const mlir::MlirOptMainConfig &config,
+        std::mutex &diagnostics
+    ) {
+        auto error = [&] (llvm::StringRef msg) {
+            std::scoped_lock lock(diagnostics);
+            llvm::errs() << entry.input << ": " << msg << "\n";
+            return false;
+        };
+
+        std::string msg;
+        auto input = mlir::openInputFile(entry.input, &msg);
+        if (!input) {
+            return error(msg);
+        }
+
+        auto output = mlir::openOutputFile(entry.output, &msg);
+        if (!output) {
+            return error(msg);
+        }
+
+        if (mlir::failed(mlir::MlirOptMain(output->os(), std::move(input), registry, config))) {
+            return error("pipeline failed");
+        }
+
+        output->keep();
+        return true;
+    }
+
+    void print_summary(
+        llvm::raw_ostream &os,
+        const std::vector< batch_entry > &entries,
+        const std::vector< batch_result > &results,
+        double wall_ms
+    ) {
+        std::vector< std::size_t > order(entries.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&] (auto a, auto b) {
+            return results[a].ms > results[b].ms;
+        });
+
+        std::size_t failed = 0;
+        double cumulative  = 0;
+
+        os << "===- vast-opt batch summary -===\n";
+        for (auto idx : order) {
+            const auto &[ok, ms] = results[idx];
+            failed     += !ok;
+            cumulative += ms;
+            os << llvm::format("  %10.1f ms  %-6s  ", ms, ok ? "ok" : "failed")
+               << entries[idx].input << " -> " << entries[idx].output << "\n";
+        }
+
+        os << llvm::format(
+            "  %zu modules, %zu failed, %.1f ms wall, %.1f ms cumulative\n",
+            entries.size(), failed, wall_ms, cumulative
+        );
+    }
+
+    int run_batch(mlir::DialectRegistry &registry) {
+        using clock = std::chrono::steady_clock;
+        using milliseconds = std::chrono::duration< double, std::milli >;
+
+        auto entries = read_batch_list(batch);
+        if (!entries) {
+            return 1;
+        }
+
+        auto config = mlir::MlirOptMainConfig::createFromCLOptions();
+
+        std::vector< batch_result > results(entries->size());
+        std::mutex diagnostics;
+
+        auto start = clock::now();
+        llvm::ThreadPool pool(llvm::hardware_concurrency(batch_jobs));
+        for (std::size_t idx = 0; idx < entries->size(); ++idx) {
+            pool.async([&, idx] {
+                auto file_start = clock::now();
+                results[idx].ok = process((*entries)[idx], registry, config, diagnostics);
+                results[idx].ms = milliseconds(clock::now() - file_start).count();
+            });
+        }
+        pool.wait();
+
+        print_summary(llvm::errs(), *entries, results, milliseconds(clock::now() - start).count());
+
+        auto ok = std::all_of(results.begin(), results.end(), [] (const auto &r) { return r.ok; });
+        return ok ? 0 : 1;
+    }
+
+} // namespace vast::opt
+
+//
+// Lowering mode (--lower-to=<dialect>) continues the conversion path of
+// vast-front on an already emitted module, e.g., a cached std module is
+// lowered to llvm without repeating the reduction of the high-level dialect.
+// Only the steps between the dialect the module reached and the target run.
+//
+namespace vast::opt {
+
+    static cl::opt< std::string > lower_to(
+        "lower-to",
+        cl::desc("Lower the module by the vast-front conversion path to the dialect (hl, std, llvm)"),
+        cl::value_desc("dialect"), cl::init("")
+    );
+
+    static cl::list< std::string > lower_options(
+        "lower-option",
+        cl::desc("Option of the vast-front pipeline used by --lower-to, e.g., -vast-print-pipeline"),
+        cl::value_desc("option")
+    );
+
+    int run_lower_to(mlir::DialectRegistry &registry, llvm::StringRef input, llvm::StringRef output) {
+        std::string msg;
+        auto in = mlir::openInputFile(input, &msg);
+        if (!in) {
+            llvm::errs() << "error: " << msg << "\n";
+            return 1;
+        }
+
+        auto out = mlir::openOutputFile(output, &msg);
+        if (!out) {
+            llvm::errs() << "error: " << msg << "\n";
+            return 1;
+        }
+
+        mcontext_t mctx(registry);
+        llvm::SourceMgr smgr;
+        smgr.AddNewSourceBuffer(std::move(in), llvm::SMLoc());
+        mlir::SourceMgrDiagnosticHandler handler(smgr, &mctx);
+
+        auto mod = mlir::parseSourceFile< mlir::ModuleOp >(smgr, &mctx);
+        if (!mod) {
+            return 1;
+        }
+
+        cc::vast_args vargs;
+        for (const auto &option : lower_options) {
+            vargs.push_back(option.c_str());
+        }
+
+        auto trg = cc::parse_target_dialect(lower_to);
+        auto pipeline = cc::setup_pipeline(mod.get(), trg, mctx, vargs);
+        if (mlir::failed(pipeline->run(mod.get()))) {
+            return 1;
+        }
+
+        cc::mark_reached_dialect(mod.get(), trg);
+        mod->print(out->os());
+        out->os() << "\n";
+        out->keep();
+        return 0;
+    }
+
+} // namespace vast::opt
 
 int main(int argc, char **argv)
 {
@@ -36,10 +272,21 @@ int main(int argc, char **argv)
     vast::registerAllDialects(registry);
     mlir::registerAllDialects(registry);
 
-    // register conversions
-    mlir::registerAllToLLVMIRTranslations(registry);
+    // register conversions, including the translation of marks of the
+    // high-level dialect left on llvm operations
+    vast::target::llvmir::register_vast_to_llvm_ir(registry);
 
-    return failed(
-        mlir::MlirOptMain(argc, argv, "VAST Optimizer driver\n", registry)
+    auto [input, output] = mlir::registerAndParseCLIOptions(
+        argc, argv, "VAST Optimizer driver\n", registry
     );
+
+    if (!vast::opt::batch.empty()) {
+        return vast::opt::run_batch(registry);
+    }
+
+    if (!vast::opt::lower_to.empty()) {
+        return vast::opt::run_lower_to(registry, input, output);
+    }
+
+    return failed(mlir::MlirOptMain(argc, argv, input, output, registry));
 }
@@ -0,0 +1,241 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/query/index.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/EndianStream.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/Meta/MetaDialect.hpp"
+#include "vast/Util/Symbols.hpp"
+
+#include <algorithm>
+
+namespace vast::query
+{
+    namespace
+    {
+        constexpr std::uint32_t magic   = 0x58444951; // "QIDX"
+        constexpr std::uint32_t version = 1;
+
+        struct strings_t
+        {
+            strings_t() { add(""); }
+
+            std::uint32_t add(string_ref str) {
+                auto [it, inserted] = offsets.try_emplace(str, std::uint32_t(blob.size()));
+                if (inserted) {
+                    blob.append(str.begin(), str.end());
+                    blob.push_back('\0');
+                }
+                return it->second;
+            }
+
+            llvm::StringMap< std::uint32_t > offsets;
+            std::string blob;
+        };
+
+        std::string location_of(mlir::Operation *op) {
+            std::string buff;
+            llvm::raw_string_ostream ss(buff);
+            auto loc = op->getLoc();
+            if (auto file_loc = loc.dyn_cast< mlir::FileLineColLoc >()) {
+                ss << file_loc.getFilename().getValue() << ":" << file_loc.getLine()
+                   << ":" << file_loc.getColumn();
+            } else {
+                ss << loc;
+            }
+            return ss.str();
+        }
+
+        string_ref function_of(mlir::Operation *op) {
+            if (auto fn = op->getParentOfType< mlir::FunctionOpInterface >()) {
+                return fn.getName();
+            }
+            return {};
+        }
+
+        bool is_global(mlir::Operation *op) {
+            return mlir::isa_and_nonnull< mlir::ModuleOp, hl::TranslationUnitOp >(op->getParentOp());
+        }
+
+        struct symbol_record
+        {
+            std::string name;
+            mlir::Operation *op;
+        };
+
+    } // namespace
+
+    logical_result build_index(vast_module mod, string_ref path) {
+        strings_t strings;
+        util::symbol_index symbols(mod);
+
+        llvm::SmallVector< symbol_record > records;
+        symbols.symbols([&] (auto symbol) {
+            records.push_back({ util::symbol_name(symbol).str(), symbol.getOperation() });
+        });
+
+        std::stable_sort(records.begin(), records.end(), [] (const auto &a, const auto &b) {
+            return a.name < b.name;
+        });
+
+        std::vector< std::uint32_t > symbol_words, use_words, position_words;
+        for (const auto &record : records) {
+            auto op = record.op;
+            auto first_use = std::uint32_t(use_words.size() / 3);
+
+            std::uint32_t uses = 0;
+            symbols.users(op, [&] (mlir::Operation *user) {
+                use_words.push_back(strings.add(user->getName().getStringRef()));
+                use_words.push_back(strings.add(location_of(user)));
+                use_words.push_back(strings.add(function_of(user)));
+                ++uses;
+            });
+
+            symbol_words.push_back(strings.add(record.name));
+            symbol_words.push_back(strings.add(op->getName().getStringRef()));
+            symbol_words.push_back(strings.add(location_of(op)));
+            symbol_words.push_back(strings.add(function_of(op)));
+            symbol_words.push_back(is_global(op) ? 1 : 0);
+            symbol_words.push_back(first_use);
+            symbol_words.push_back(uses);
+        }
+
+        struct position_record
+        {
+            std::string file;
+            unsigned line;
+            unsigned column;
+            mlir::Operation *op;
+        };
+
+        llvm::SmallVector< position_record > positions;
+        meta::location_index(mod).positions([&] (string_ref file, unsigned line, unsigned column, auto op) {
+            positions.push_back({ file.str(), line, column, op });
+        });
+
+        std::stable_sort(positions.begin(), positions.end(), [] (const auto &a, const auto &b) {
+            return std::tie(a.file, a.line, a.column) < std::tie(b.file, b.line, b.column);
+        });
+
+        for (const auto &pos : positions) {
+            position_words.push_back(strings.add(pos.file));
+            position_words.push_back(pos.line);
+            position_words.push_back(pos.column);
+            position_words.push_back(strings.add(pos.op->getName().getStringRef()));
+            position_words.push_back(strings.add(location_of(pos.op)));
+            position_words.push_back(strings.add(function_of(pos.op)));
+        }
+
+        std::error_code ec;
+        llvm::raw_fd_ostream os(path, ec);
+        if (ec) {
+            llvm::errs() << "error: cannot write index " << path << ": " << ec.message() << "\n";
+            return mlir::failure();
+        }
+
+        auto write = [&] (std::uint32_t value) {
+            llvm::support::endian::write< std::uint32_t >(os, value, llvm::support::little);
+        };
+
+        write(magic);
+        write(version);
+        write(std::uint32_t(records.size()));
+        write(std::uint32_t(use_words.size() / 3));
+        write(std::uint32_t(positions.size()));
+        write(std::uint32_t(strings.blob.size()));
+
+        for (const auto *section : { &symbol_words, &use_words, &position_words }) {
+            for (auto value : *section) {
+                write(value);
+            }
+        }
+
+        os << strings.blob;
+        return mlir::success();
+    }
+
+    std::unique_ptr< index_file > index_file::open(string_ref path, std::string &error) {
+        auto buffer = llvm::MemoryBuffer::getFile(path, /* IsText */ false, /* RequiresNullTerminator */ false);
+        if (!buffer) {
+            error = buffer.getError().message();
+            return nullptr;
+        }
+
+        auto size = (*buffer)->getBufferSize();
+        const auto *header = reinterpret_cast< const word * >((*buffer)->getBufferStart());
+        if (size < 6 * sizeof(word) || header[0] != magic || header[1] != version) {
+            error = "not a vast-query index";
+            return nullptr;
+        }
+
+        std::uint64_t expected = (6
+            + std::uint64_t(header[2]) * symbol_words
+            + std::uint64_t(header[3]) * use_words
+            + std::uint64_t(header[4]) * position_words) * sizeof(word) + header[5];
+        if (size != expected) {
+            error = "truncated vast-query index";
+            return nullptr;
+        }
+
+        return std::unique_ptr< index_file >(new index_file(std::move(*buffer)));
+    }
+
+    index_symbol index_file::symbol(std::uint32_t i) const {
+        return {
+            string(symbol_word(i, 0)), string(symbol_word(i, 1)), string(symbol_word(i, 2)),
+            string(symbol_word(i, 3)), symbol_word(i, 4) != 0
+        };
+    }
+
+    index_operation index_file::use(std::uint32_t i) const {
+        return { string(use_word(i, 0)), string(use_word(i, 1)), string(use_word(i, 2)) };
+    }
+
+    index_operation index_file::position(std::uint32_t i) const {
+        return { string(position_word(i, 3)), string(position_word(i, 4)), string(position_word(i, 5)) };
+    }
+
+    std::uint32_t index_file::lower_bound(string_ref name) const {
+        std::uint32_t first = 0, count = num_symbols();
+        while (count > 0) {
+            auto step = count / 2;
+            if (string(symbol_word(first + step, 0)) < name) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+    std::uint32_t index_file::lower_bound(string_ref file, unsigned line, unsigned column) const {
+        auto less = [&] (std::uint32_t i) {
+            auto pos_file = string(position_word(i, 0));
+            if (pos_file != file) {
+                return pos_file < file;
+            }
+            return std::make_pair(position_word(i, 1), position_word(i, 2))
+                < std::make_pair(std::uint32_t(line), std::uint32_t(column));
+        };
+
+        std::uint32_t first = 0, count = num_positions();
+        while (count > 0) {
+            auto step = count / 2;
+            if (less(first + step)) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        return first;
+    }
+
+} // namespace vast::query
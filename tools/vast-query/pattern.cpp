@@ -0,0 +1,279 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/query/pattern.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/OpDefinition.h>
+#include <mlir/IR/Threading.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::query
+{
+    op_index::op_index(operation root) : mctx(root->getContext()) {
+        // The first lists hold the operations outside of functions.
+        std::vector< operation > functions = { nullptr };
+        root->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+            if (mlir::isa< mlir::FunctionOpInterface >(op)) {
+                functions.push_back(op);
+                return mlir::WalkResult::skip();
+            }
+            return mlir::WalkResult::advance();
+        });
+
+        postings.resize(functions.size());
+        all.resize(functions.size());
+
+        auto index = [&] (operation scope, std::size_t i) {
+            scope->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+                if (op != scope && mlir::isa< mlir::FunctionOpInterface >(op)) {
+                    return mlir::WalkResult::skip();
+                }
+                postings[i][op->getName().getStringRef()].push_back(op);
+                all[i].push_back(op);
+                return mlir::WalkResult::advance();
+            });
+        };
+
+        mlir::parallelFor(mctx, 0, functions.size(), [&] (std::size_t i) {
+            if (functions[i]) {
+                index(functions[i], i);
+            }
+        });
+
+        if (!mlir::isa< mlir::FunctionOpInterface >(root)) {
+            index(root, 0);
+        }
+    }
+
+    namespace
+    {
+        struct pattern_parser
+        {
+            string_ref text;
+            std::string &error;
+
+            string_ref take_until(string_ref separators) {
+                auto size = std::min(text.find_first_of(separators), text.size());
+                auto token = text.take_front(size);
+                text = text.drop_front(size);
+                return token;
+            }
+
+            std::nullopt_t fail(const llvm::Twine &message) {
+                error = message.str();
+                return std::nullopt;
+            }
+
+            std::optional< pattern > parse_pattern() {
+                pattern pat;
+
+                auto root = take_until("(,)");
+                if (root.empty()) {
+                    return fail("expected a pattern at '" + text + "'");
+                }
+
+                if (root == "*") {
+                    pat.root = pattern::root_kind::any;
+                } else if (root == "const") {
+                    pat.root = pattern::root_kind::constant;
+                } else if (root == "param") {
+                    pat.root = pattern::root_kind::param;
+                } else {
+                    pat.root = pattern::root_kind::operation;
+                    pat.name = root.str();
+                }
+
+                if (!text.consume_front("(")) {
+                    return pat;
+                }
+
+                do {
+                    auto constraint = parse_constraint();
+                    if (!constraint) {
+                        return std::nullopt;
+                    }
+                    pat.constraints.push_back(std::move(*constraint));
+                } while (text.consume_front(","));
+
+                if (!text.consume_front(")")) {
+                    return fail("expected ')' at '" + text + "'");
+                }
+
+                return pat;
+            }
+
+            std::optional< pattern::constraint > parse_constraint() {
+                pattern::constraint constraint;
+
+                auto key = take_until("=!~,()");
+                if (key.empty()) {
+                    return fail("expected a constraint at '" + text + "'");
+                }
+
+                constraint.negated = text.consume_front("!");
+                if (text.consume_front("~")) {
+                    constraint.derived = true;
+                } else if (!text.consume_front("=")) {
+                    return fail("expected '=', '!=', '~' or '!~' after '" + key + "'");
+                }
+
+                unsigned operand = 0;
+                if (key.starts_with("operand") && !key.drop_front(7).getAsInteger(10, operand)) {
+                    auto nested = parse_pattern();
+                    if (!nested) {
+                        return std::nullopt;
+                    }
+                    constraint.operand = operand;
+                    constraint.nested  = std::make_unique< pattern >(std::move(*nested));
+                    return constraint;
+                }
+
+                if (constraint.derived) {
+                    return fail("attribute '" + key + "' is matched by '=' or '!='");
+                }
+
+                constraint.attribute = key.str();
+                constraint.value     = take_until(",)").str();
+                return constraint;
+            }
+        };
+
+        std::string attribute_value(mlir::Attribute attr) {
+            if (auto str = mlir::dyn_cast< mlir::StringAttr >(attr)) {
+                return str.getValue().str();
+            }
+
+            if (auto ref = mlir::dyn_cast< mlir::SymbolRefAttr >(attr)) {
+                return ref.getRootReference().getValue().str();
+            }
+
+            if (auto num = mlir::dyn_cast< mlir::IntegerAttr >(attr)) {
+                llvm::SmallString< 16 > str;
+                num.getValue().toString(str, 10, !num.getType().isUnsignedInteger());
+                return str.str().str();
+            }
+
+            std::string str;
+            llvm::raw_string_ostream os(str);
+            attr.print(os);
+            return os.str();
+        }
+
+        bool holds(operation op, const pattern::constraint &constraint) {
+            auto result = [&] {
+                if (constraint.operand) {
+                    if (*constraint.operand >= op->getNumOperands()) {
+                        return false;
+                    }
+
+                    auto value = op->getOperand(*constraint.operand);
+                    return constraint.derived
+                        ? constraint.nested->matches_derived(value)
+                        : constraint.nested->matches(value);
+                }
+
+                auto attr = op->getAttr(constraint.attribute);
+                return attr && attribute_value(attr) == constraint.value;
+            } ();
+
+            return result != constraint.negated;
+        }
+
+    } // namespace
+
+    std::optional< pattern > pattern::parse(string_ref text, std::string &error) {
+        pattern_parser parser{ text, error };
+        auto pat = parser.parse_pattern();
+        if (pat && !parser.text.empty()) {
+            return parser.fail("unexpected '" + parser.text + "' after the pattern");
+        }
+        return pat;
+    }
+
+    bool pattern::matches(operation op) const {
+        switch (root) {
+            case root_kind::operation:
+                if (op->getName().getStringRef() != name) {
+                    return false;
+                }
+                break;
+            case root_kind::constant:
+                if (!op->hasTrait< mlir::OpTrait::ConstantLike >()) {
+                    return false;
+                }
+                break;
+            case root_kind::param:
+                return false;
+            case root_kind::any:
+                break;
+        }
+
+        return llvm::all_of(constraints, [&] (const auto &constraint) {
+            return holds(op, constraint);
+        });
+    }
+
+    bool pattern::matches(mlir_value value) const {
+        if (root == root_kind::param) {
+            auto arg = mlir::dyn_cast< mlir::BlockArgument >(value);
+            if (!arg || !arg.getOwner()->isEntryBlock()) {
+                return false;
+            }
+            return mlir::isa< mlir::FunctionOpInterface >(arg.getOwner()->getParentOp());
+        }
+
+        auto op = value.getDefiningOp();
+        return op && matches(op);
+    }
+
+    bool pattern::matches_derived(mlir_value value) const {
+        llvm::SmallVector< mlir_value > worklist = { value };
+        llvm::DenseSet< mlir_value > seen = { value };
+
+        while (!worklist.empty()) {
+            auto current = worklist.pop_back_val();
+            if (matches(current)) {
+                return true;
+            }
+
+            if (auto op = current.getDefiningOp()) {
+                for (auto operand : op->getOperands()) {
+                    if (seen.insert(operand).second) {
+                        worklist.push_back(operand);
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    std::vector< operation > match(const op_index &index, const pattern &pat) {
+        std::vector< std::vector< operation > > found(index.functions());
+
+        mlir::parallelFor(index.context(), 0, index.functions(), [&] (std::size_t i) {
+            auto candidates = pat.root == pattern::root_kind::operation
+                ? index.operations(i, pat.name)
+                : index.operations(i);
+
+            for (auto op : candidates) {
+                if (pat.matches(op)) {
+                    found[i].push_back(op);
+                }
+            }
+        });
+
+        std::vector< operation > result;
+        for (auto &ops : found) {
+            result.insert(result.end(), ops.begin(), ops.end());
+        }
+        return result;
+    }
+
+} // namespace vast::query
@@ -0,0 +1,252 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/query/tables.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/IR/Threading.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+#include <mlir/Interfaces/FunctionInterfaces.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/CallGraph.hpp"
+#include "vast/Util/DataLayout.hpp"
+#include "vast/Util/Symbols.hpp"
+
+#include <vector>
+
+namespace vast::query
+{
+    namespace
+    {
+        // Operations formatted by a single task.
+        constexpr std::size_t ops_per_chunk = 1 << 14;
+
+        struct table_file
+        {
+            table_file(string_ref dir, string_ref name, string_ref header) {
+                llvm::SmallString< 128 > path(dir);
+                llvm::sys::path::append(path, name + ".csv");
+                file = path.str().str();
+                os.emplace(path, ec);
+                if (!ec) {
+                    *os << header << "\n";
+                }
+            }
+
+            logical_result status() const {
+                if (ec) {
+                    llvm::errs() << "error: cannot write table " << file << ": " << ec.message() << "\n";
+                }
+                return mlir::failure(bool(ec));
+            }
+
+            std::string file;
+            std::error_code ec;
+            std::optional< llvm::raw_fd_ostream > os;
+        };
+
+        // Quoted if the field holds a separator, a quote or a line break.
+        void field(llvm::raw_ostream &os, string_ref value) {
+            if (value.find_first_of(",\"\n\r") == string_ref::npos) {
+                os << value;
+                return;
+            }
+
+            os << '"';
+            for (auto c : value) {
+                if (c == '"') {
+                    os << '"';
+                }
+                os << c;
+            }
+            os << '"';
+        }
+
+        std::string printed(const auto &entity) {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            os << entity;
+            return os.str();
+        }
+
+        mlir::FileLineColLoc file_location(mlir::Location loc) {
+            mlir::FileLineColLoc found;
+            loc->walk([&] (mlir::Location nested) {
+                if (auto file_loc = mlir::dyn_cast< mlir::FileLineColLoc >(nested)) {
+                    found = file_loc;
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            });
+            return found;
+        }
+
+        struct numbering_t
+        {
+            explicit numbering_t(vast_module mod) {
+                mod->walk< mlir::WalkOrder::PreOrder >([&] (operation op) {
+                    ids.try_emplace(op, ops.size());
+                    ops.push_back(op);
+                });
+            }
+
+            std::vector< operation > ops;
+            llvm::DenseMap< operation, std::size_t > ids;
+        };
+
+    } // namespace
+
+    logical_result export_tables(vast_module mod, string_ref dir) {
+        if (auto ec = llvm::sys::fs::create_directories(dir)) {
+            llvm::errs() << "error: cannot create directory " << dir << ": " << ec.message() << "\n";
+            return mlir::failure();
+        }
+
+        auto ctx = mod.getContext();
+
+        numbering_t numbering(mod);
+        analysis::call_graph graph(mod);
+
+        llvm::DenseMap< operation, analysis::call_graph::node_id > nodes;
+        for (analysis::call_graph::node_id node = 0; node < graph.size(); ++node) {
+            nodes.try_emplace(graph.function(node), node);
+        }
+
+        auto function_of = [&] (operation op) -> std::optional< analysis::call_graph::node_id > {
+            for (auto parent = op; parent; parent = parent->getParentOp()) {
+                if (auto it = nodes.find(parent); it != nodes.end()) {
+                    return it->second;
+                }
+            }
+            return std::nullopt;
+        };
+
+        //
+        // functions
+        //
+        table_file functions(dir, "functions", "function,name,op,definition,ops");
+        if (mlir::failed(functions.status())) {
+            return mlir::failure();
+        }
+
+        std::vector< std::size_t > sizes(graph.size());
+        mlir::parallelFor(ctx, 0, graph.size(), [&] (std::size_t node) {
+            std::size_t ops = 0;
+            graph.function(node)->walk([&] (operation) { ++ops; });
+            sizes[node] = ops;
+        });
+
+        for (analysis::call_graph::node_id node = 0; node < graph.size(); ++node) {
+            auto fn = graph.function(node);
+            auto &os = *functions.os;
+            os << node << ",";
+            field(os, mlir::SymbolTable::getSymbolName(fn).getValue());
+            os << "," << numbering.ids.lookup(fn) << "," << (fn.isExternal() ? 0 : 1)
+               << "," << sizes[node] << "\n";
+        }
+
+        //
+        // ops
+        //
+        table_file ops(dir, "ops", "op,function,parent,kind,file,line,column");
+        if (mlir::failed(ops.status())) {
+            return mlir::failure();
+        }
+
+        auto chunks = (numbering.ops.size() + ops_per_chunk - 1) / ops_per_chunk;
+        std::vector< std::string > rows(chunks);
+        mlir::parallelFor(ctx, 0, chunks, [&] (std::size_t chunk) {
+            llvm::raw_string_ostream os(rows[chunk]);
+
+            auto first = chunk * ops_per_chunk;
+            auto last  = std::min(first + ops_per_chunk, numbering.ops.size());
+            for (auto id = first; id < last; ++id) {
+                auto op = numbering.ops[id];
+                os << id << ",";
+                if (auto fn = function_of(op)) {
+                    os << *fn;
+                }
+                os << ",";
+                if (auto parent = op->getParentOp()) {
+                    os << numbering.ids.lookup(parent);
+                }
+                os << "," << op->getName().getStringRef() << ",";
+                if (auto loc = file_location(op->getLoc())) {
+                    field(os, loc.getFilename().getValue());
+                    os << "," << loc.getLine() << "," << loc.getColumn();
+                } else {
+                    os << ",,";
+                }
+                os << "\n";
+            }
+        });
+
+        for (const auto &chunk : rows) {
+            *ops.os << chunk;
+        }
+
+        //
+        // calls
+        //
+        table_file calls(dir, "calls", "caller,callee,indirect");
+        if (mlir::failed(calls.status())) {
+            return mlir::failure();
+        }
+
+        for (analysis::call_graph::node_id node = 0; node < graph.size(); ++node) {
+            for (auto edge : graph.callees(node)) {
+                bool indirect = edge.kind == analysis::call_graph::edge_kind::indirect;
+                *calls.os << node << "," << edge.node << "," << (indirect ? 1 : 0) << "\n";
+            }
+        }
+
+        //
+        // symbol uses
+        //
+        table_file uses(dir, "symbol_uses", "symbol,kind,op,user");
+        if (mlir::failed(uses.status())) {
+            return mlir::failure();
+        }
+
+        util::symbol_index symbols(mod);
+        symbols.symbols([&] (auto symbol) {
+            auto op = symbol.getOperation();
+            auto id = numbering.ids.lookup(op);
+            symbols.users(op, [&] (operation user) {
+                auto &os = *uses.os;
+                field(os, util::symbol_name(symbol));
+                os << "," << op->getName().getStringRef() << "," << id
+                   << "," << numbering.ids.lookup(user) << "\n";
+            });
+        });
+
+        //
+        // types
+        //
+        table_file types(dir, "types", "type,size_bits,align_bits");
+        if (mlir::failed(types.status())) {
+            return mlir::failure();
+        }
+
+        if (auto spec = mod.getDataLayoutSpec()) {
+            for (auto entry : spec.getEntries()) {
+                if (!mlir::isa< mlir_type >(entry.getKey())) {
+                    continue;
+                }
+
+                auto layout = dl::DLEntry(entry);
+                auto &os = *types.os;
+                field(os, printed(layout.type));
+                os << "," << layout.bw << "," << layout.abi_align << "\n";
+            }
+        }
+
+        return mlir::success();
+    }
+
+} // namespace vast::query
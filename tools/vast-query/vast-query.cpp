@@ -3,6 +3,8 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/InitAllDialects.h"
@@ -10,22 +12,42 @@ VAST_RELAX_WARNINGS
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Support/FileUtilities.h"
+#include "mlir/IR/Threading.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
 #include "mlir/Parser/Parser.h"
 
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ToolOutputFile.h"
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Analysis/CallGraph.hpp"
+#include "vast/Analysis/FlatFunction.hpp"
+#include "vast/Analysis/LoopNest.hpp"
+#include "vast/Analysis/PointsTo.hpp"
+#include "vast/Analysis/SCCSchedule.hpp"
 #include "vast/Dialect/Dialects.hpp"
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Dialect/Meta/MetaDialect.hpp"
+#include "vast/Linker/Extract.hpp"
 #include "vast/Util/Common.hpp"
+#include "vast/Util/LazyModule.hpp"
+#include "vast/Util/ModuleParser.hpp"
+#include "vast/Util/StructuralHash.hpp"
 #include "vast/Util/Symbols.hpp"
+#include "vast/query/index.hpp"
+#include "vast/query/pattern.hpp"
+#include "vast/query/tables.hpp"
 
 using memory_buffer  = std::unique_ptr< llvm::MemoryBuffer >;
 
@@ -42,10 +64,9 @@ namespace vast::cl
     cl::OptionCategory queries("Vast Queries Options");
 
     struct vast_query_options {
-        cl::opt< std::string > input_file{
-            cl::desc("<input file>"),
+        cl::list< std::string > input_files{
+            cl::desc("<input files or directories>"),
             cl::Positional,
-            cl::init("-"),
             cl::cat(generic)
         };
         cl::opt< show_symbol_type > show_symbols{ "show-symbols",
@@ -67,12 +88,105 @@ namespace vast::cl
             cl::init(""),
             cl::cat(queries)
         };
+        cl::opt< std::string > show_callees{ "callees",
+            cl::desc("Show functions called by a given function, indirect calls resolved by signature"),
+            cl::value_desc("function name"),
+            cl::init(""),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > show_callers{ "callers",
+            cl::desc("Show functions calling a given function, directly or indirectly"),
+            cl::value_desc("function name"),
+            cl::init(""),
+            cl::cat(queries)
+        };
+        cl::opt< bool > show_sccs{ "sccs",
+            cl::desc("Show strongly connected components of the call graph bottom-up, with their longest chain of calls"),
+            cl::init(false),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > show_at{ "at",
+            cl::desc("Show operations at a source position, the whole line without a column"),
+            cl::value_desc("file:line[:column]"),
+            cl::init(""),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > match{ "match",
+            cl::desc("Show operations matching a structural pattern, e.g., 'hl.call(callee=memcpy,operand2!=const)'"),
+            cl::value_desc("pattern"),
+            cl::init(""),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > points_to{ "points-to",
+            cl::desc("Show objects the variables of a given name may point to"),
+            cl::value_desc("variable name"),
+            cl::init(""),
+            cl::cat(queries)
+        };
+        cl::opt< bool > show_loops{ "loops",
+            cl::desc("Show loops with their depth, constant trip count and exits"),
+            cl::init(false),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > batch{ "batch",
+            cl::desc("Answer queries read from the file, one per line, '-' reads stdin"),
+            cl::value_desc("file"),
+            cl::init(""),
+            cl::cat(queries)
+        };
+        cl::opt< bool > json{ "json",
+            cl::desc("Print results as JSON objects, one per line"),
+            cl::init(false),
+            cl::cat(queries)
+        };
         cl::opt< std::string > scope_name{ "scope",
             cl::desc("Show values from scope of a given function"),
             cl::value_desc("function name"),
             cl::init(""),
             cl::cat(queries)
         };
+        cl::opt< std::string > build_index{ "build-index",
+            cl::desc("Write the query index of the module to the file and exit"),
+            cl::value_desc("file"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > export_tables{ "export-tables",
+            cl::desc("Write functions, operations, calls, symbol uses and types of the module as CSV tables to the directory and exit"),
+            cl::value_desc("directory"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > extract{ "extract",
+            cl::desc("Print a standalone module of the function and its dependencies and exit"),
+            cl::value_desc("function name"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< unsigned > extract_depth{ "extract-depth",
+            cl::desc("Depth of the calls whose callees are extracted with their bodies, unlimited by default"),
+            cl::value_desc("calls"),
+            cl::init(std::numeric_limits< unsigned >::max()),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > flat{ "flat",
+            cl::desc("Print the flat snapshot of the function and exit"),
+            cl::value_desc("function name"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > hash{ "hash",
+            cl::desc("Print the structural hash of the symbol and exit"),
+            cl::value_desc("symbol name"),
+            cl::init(""),
+            cl::cat(generic)
+        };
+        cl::opt< std::string > index{ "index",
+            cl::desc("Answer queries from the index instead of the module"),
+            cl::value_desc("file"),
+            cl::init(""),
+            cl::cat(generic)
+        };
     };
     // clang-format on
 
@@ -83,11 +197,326 @@ namespace vast::cl
 
 namespace vast::query
 {
-    bool show_symbols() { return cl::options->show_symbols != cl::show_symbol_type::none; }
+    //
+    // A single query, either given by the command line options, or by a line
+    // of the batch in the same syntax without the leading dashes, e.g.,
+    // `symbol-users=a scope=main`.
+    //
+    struct query_t
+    {
+        cl::show_symbol_type show_symbols = cl::show_symbol_type::none;
+        std::string symbol_users;
+        std::string at;
+        std::string scope;
+        std::string callees;
+        std::string callers;
+        std::string match;
+        std::string points_to;
+        bool sccs = false;
+        bool loops = false;
+
+        static query_t from_options() {
+            return {
+                cl::options->show_symbols, cl::options->show_symbol_users,
+                cl::options->show_at, cl::options->scope_name,
+                cl::options->show_callees, cl::options->show_callers,
+                cl::options->match, cl::options->points_to,
+                cl::options->show_sccs, cl::options->show_loops
+            };
+        }
+
+        bool is_call_query() const { return !callees.empty() || !callers.empty() || sccs; }
+
+        // Queries answered from an analysis of the whole module.
+        bool is_module_query() const { return is_call_query() || !points_to.empty(); }
+
+        static std::optional< query_t > parse(string_ref line, std::string &error) {
+            query_t query;
+
+            llvm::SmallVector< string_ref > tokens;
+            llvm::SplitString(line, tokens);
+            for (auto token : tokens) {
+                auto [key, value] = token.split('=');
+                if (key == "show-symbols") {
+                    auto kind = llvm::StringSwitch< std::optional< cl::show_symbol_type > >(value)
+                        .Case("functions", cl::show_symbol_type::function)
+                        .Case("types", cl::show_symbol_type::type)
+                        .Case("records", cl::show_symbol_type::record)
+                        .Case("vars", cl::show_symbol_type::var)
+                        .Case("globs", cl::show_symbol_type::global)
+                        .Case("all", cl::show_symbol_type::all)
+                        .Default(std::nullopt);
+                    if (!kind) {
+                        error = ("unknown kind of symbols: " + value).str();
+                        return std::nullopt;
+                    }
+                    query.show_symbols = *kind;
+                } else if (key == "symbol-users") {
+                    query.symbol_users = value.str();
+                } else if (key == "at") {
+                    query.at = value.str();
+                } else if (key == "scope") {
+                    query.scope = value.str();
+                } else if (key == "callees") {
+                    query.callees = value.str();
+                } else if (key == "callers") {
+                    query.callers = value.str();
+                } else if (key == "match") {
+                    query.match = value.str();
+                } else if (key == "points-to") {
+                    query.points_to = value.str();
+                } else if (key == "sccs") {
+                    query.sccs = true;
+                } else if (key == "loops") {
+                    query.loops = true;
+                } else {
+                    error = ("unknown query: " + token).str();
+                    return std::nullopt;
+                }
+            }
+
+            return query;
+        }
+    };
+
+    std::string show_operation(mlir::Operation *op) {
+        std::string buff;
+        llvm::raw_string_ostream ss(buff);
+        op->print(ss);
+        return ss.str();
+    }
+
+    std::string show_location(mlir::Location loc) {
+        std::string buff;
+        llvm::raw_string_ostream ss(buff);
+        if (auto file_loc = loc.dyn_cast< mlir::FileLineColLoc >()) {
+            ss << file_loc.getFilename().getValue() << ":" << file_loc.getLine()
+               << ":" << file_loc.getColumn();
+        } else {
+            ss << loc;
+        }
+        return ss.str();
+    }
+
+    //
+    // Results are either printed as text, or as JSON objects, one per line,
+    // each with the query it answers.
+    //
+    struct output_t
+    {
+        bool json;
+        string_ref query;
+        // Set when more than one module is queried.
+        string_ref file = {};
+        llvm::raw_ostream *os = &llvm::outs();
+        llvm::raw_ostream *es = &llvm::errs();
+
+        output_t with_query(string_ref line) const {
+            auto copy = *this;
+            copy.query = line;
+            return copy;
+        }
+
+        void symbol(auto symbol) const {
+            if (!json) {
+                *os << util::show_symbol_value(symbol) << "\n";
+                return;
+            }
+
+            emit({
+                { "query", query },
+                { "kind", symbol->getName().getStringRef() },
+                { "symbol", util::symbol_name(symbol) },
+                { "location", show_location(symbol.getLoc()) }
+            });
+        }
+
+        void operation(mlir::Operation *op) const {
+            if (!json) {
+                op->print(*os);
+                *os << util::show_location(*op) << "\n";
+                return;
+            }
+
+            emit({
+                { "query", query },
+                { "operation", show_operation(op) },
+                { "location", show_location(op->getLoc()) }
+            });
+        }
+
+        void call(mlir::FunctionOpInterface fn, analysis::call_graph::edge_kind kind) const {
+            auto symbol   = mlir::cast< util::mlir_symbol_interface >(fn.getOperation());
+            bool indirect = kind == analysis::call_graph::edge_kind::indirect;
+            if (!json) {
+                *os << util::show_symbol_value(symbol) << (indirect ? " (indirect)" : "") << "\n";
+                return;
+            }
+
+            emit({
+                { "query", query },
+                { "kind", symbol->getName().getStringRef() },
+                { "symbol", util::symbol_name(symbol) },
+                { "indirect", indirect },
+                { "location", show_location(symbol.getLoc()) }
+            });
+        }
+
+        void object(string_ref kind, string_ref name, mlir::Location loc) const {
+            if (!json) {
+                *os << kind << " " << name << " : " << show_location(loc) << "\n";
+                return;
+            }
+
+            emit({
+                { "query", query },
+                { "kind", kind },
+                { "object", name },
+                { "location", show_location(loc) }
+            });
+        }
+
+        void scc(unsigned id, llvm::ArrayRef< std::string > functions, bool recursive, std::size_t height) const {
+            if (!json) {
+                *os << "scc " << id << " : height " << height << " : " << llvm::join(functions, ", ")
+                    << (recursive ? " (recursive)" : "") << "\n";
+                return;
+            }
+
+            emit({
+                { "query", query },
+                { "scc", id },
+                { "functions", llvm::json::Array(functions) },
+                { "recursive", recursive },
+                { "height", height }
+            });
+        }
+
+        void loop(const analysis::loop &loop) const {
+            auto kind = loop.op->getName().getStringRef();
+            if (!json) {
+                *os << kind << " : depth " << loop.depth;
+                if (loop.trip_count) {
+                    *os << " : trips " << *loop.trip_count;
+                }
+                *os << " : exits " << loop.exits.size() << " : " << show_location(loop.op->getLoc()) << "\n";
+                return;
+            }
+
+            llvm::json::Object object{
+                { "query", query },
+                { "kind", kind },
+                { "depth", loop.depth },
+                { "exits", loop.exits.size() },
+                { "location", show_location(loop.op->getLoc()) }
+            };
+            if (loop.trip_count) {
+                object["trip_count"] = *loop.trip_count;
+            }
+            emit(std::move(object));
+        }
+
+        void symbol(const index_symbol &symbol) const {
+            if (!json) {
+                *os << symbol.kind << " : " << symbol.name << "  : " << symbol.location << "\n";
+                return;
+            }
+
+            emit({
+                { "query", query },
+                { "kind", symbol.kind },
+                { "symbol", symbol.name },
+                { "location", symbol.location }
+            });
+        }
+
+        // Operations of the index are described only by their name.
+        void operation(const index_operation &op) const {
+            if (!json) {
+                *os << op.kind;
+                if (!op.function.empty()) {
+                    *os << " in " << op.function;
+                }
+                *os << " : " << op.location << "\n";
+                return;
+            }
+
+            emit({
+                { "query", query },
+                { "kind", op.kind },
+                { "function", op.function },
+                { "location", op.location }
+            });
+        }
+
+        void error(const llvm::Twine &message) const {
+            if (!json) {
+                *es << "error: " << message << "\n";
+                return;
+            }
 
-    bool show_symbol_users() { return !cl::options->show_symbol_users.empty(); }
+            emit({ { "query", query }, { "error", message.str() } });
+        }
+
+      private:
+        void emit(llvm::json::Object object) const {
+            *os << llvm::json::Value(std::move(object)) << "\n";
+        }
+    };
+
+    //
+    // Indices of queried scopes, built on the first query of the scope and
+    // shared by all queries of a batch.
+    //
+    struct indices_t
+    {
+        const util::symbol_index &symbols(mlir::Operation *scope) {
+            auto &index = symbol_indices[scope];
+            if (!index) {
+                index = std::make_unique< util::symbol_index >(scope);
+            }
+            return *index;
+        }
 
-    bool constrained_scope() { return !cl::options->scope_name.empty(); }
+        const meta::location_index &locations(mlir::Operation *scope) {
+            auto &index = location_indices[scope];
+            if (!index) {
+                index = std::make_unique< meta::location_index >(scope);
+            }
+            return *index;
+        }
+
+        const op_index &ops(mlir::Operation *scope) {
+            auto &index = op_indices[scope];
+            if (!index) {
+                index = std::make_unique< op_index >(scope);
+            }
+            return *index;
+        }
+
+        const analysis::call_graph &calls(mlir::Operation *scope) {
+            auto &graph = call_graphs[scope];
+            if (!graph) {
+                graph = std::make_unique< analysis::call_graph >(scope);
+            }
+            return *graph;
+        }
+
+        const analysis::points_to &pointers(mlir::Operation *mod) {
+            auto &analysis = points_to_analyses[mod];
+            if (!analysis) {
+                analysis = std::make_unique< analysis::points_to >(mod);
+            }
+            return *analysis;
+        }
+
+      private:
+        llvm::DenseMap< mlir::Operation *, std::unique_ptr< util::symbol_index > > symbol_indices;
+        llvm::DenseMap< mlir::Operation *, std::unique_ptr< meta::location_index > > location_indices;
+        llvm::DenseMap< mlir::Operation *, std::unique_ptr< analysis::call_graph > > call_graphs;
+        llvm::DenseMap< mlir::Operation *, std::unique_ptr< op_index > > op_indices;
+        llvm::DenseMap< mlir::Operation *, std::unique_ptr< analysis::points_to > > points_to_analyses;
+    };
 
     template< typename... Ts >
     auto is_one_of() {
@@ -102,22 +531,18 @@ namespace vast::query
         };
     }
 
-    void show_value(auto value) {
-        llvm::outs() << util::show_symbol_value(value) << "\n";
-    }
-
-    logical_result do_show_symbols(auto scope) {
-        auto &show_kind = cl::options->show_symbols;
-
-        auto show_if = [=](auto symbol, auto pred) {
+    logical_result do_show_symbols(
+        mlir::Operation *scope, const query_t &query, indices_t &indices, const output_t &out
+    ) {
+        auto show_if = [&](auto symbol, auto pred) {
             if (pred(symbol))
-                show_value(symbol);
+                out.symbol(symbol);
         };
 
-        auto filter_kind = [=](cl::show_symbol_type kind) {
-            return [=](auto symbol) {
+        auto filter_kind = [&](cl::show_symbol_type kind) {
+            return [&, kind](auto symbol) {
                 switch (kind) {
-                    case cl::show_symbol_type::all: show_value(symbol); break;
+                    case cl::show_symbol_type::all: out.symbol(symbol); break;
                     case cl::show_symbol_type::type:
                         show_if(symbol, is_one_of< hl::TypeDefOp, hl::TypeDeclOp >());
                         break;
@@ -138,76 +563,808 @@ namespace vast::query
             };
         };
 
-        util::symbols(scope, filter_kind(show_kind));
+        indices.symbols(scope).symbols(filter_kind(query.show_symbols));
         return mlir::success();
     }
 
-    logical_result do_show_users(auto scope) {
-        auto &name = cl::options->show_symbol_users;
-        util::yield_users(name.getValue(), scope, [](auto user) {
-            user->print(llvm::outs());
-            llvm::outs() << util::show_location(*user) << "\n";
+    logical_result do_show_users(
+        mlir::Operation *scope, const query_t &query, indices_t &indices, const output_t &out
+    ) {
+        indices.symbols(scope).users(query.symbol_users, [&](auto user) {
+            out.operation(user);
         });
 
         return mlir::success();
     }
+
+    struct source_position
+    {
+        string_ref file;
+        unsigned line = 0;
+        unsigned column = 0;
+    };
+
+    std::optional< source_position > parse_position(string_ref position, const output_t &out) {
+        source_position result;
+
+        // File names can contain colons, hence the position is split from
+        // the right.
+        auto [rest, last] = position.rsplit(':');
+        if (auto [file, line_str] = rest.rsplit(':'); !line_str.empty() && !line_str.getAsInteger(10, result.line)) {
+            if (last.getAsInteger(10, result.column)) {
+                out.error("invalid column in " + position);
+                return std::nullopt;
+            }
+            rest = file;
+        } else if (last.getAsInteger(10, result.line)) {
+            out.error("invalid source position " + position);
+            return std::nullopt;
+        }
+
+        result.file = rest;
+        return result;
+    }
+
+    logical_result do_show_at(
+        mlir::Operation *scope, const query_t &query, indices_t &indices, const output_t &out
+    ) {
+        auto position = parse_position(query.at, out);
+        if (!position) {
+            return mlir::failure();
+        }
+
+        for (auto op : indices.locations(scope).at(position->file, position->line, position->column)) {
+            out.operation(op);
+        }
+
+        return mlir::success();
+    }
+
+    // Patterns are matched against the posting lists of the index of the
+    // scope, in parallel across its functions.
+    logical_result do_match(
+        mlir::Operation *scope, const query_t &query, indices_t &indices, const output_t &out
+    ) {
+        std::string error;
+        auto pat = pattern::parse(query.match, error);
+        if (!pat) {
+            out.error("invalid pattern: " + error);
+            return mlir::failure();
+        }
+
+        if (pat->root == pattern::root_kind::param) {
+            out.error("the root of a pattern has to match operations");
+            return mlir::failure();
+        }
+
+        for (auto op : match(indices.ops(scope), *pat)) {
+            out.operation(op);
+        }
+
+        return mlir::success();
+    }
+
+    // Components are listed callees first. The height of a component, the
+    // longest chain of calls into other components, is computed by the
+    // bottom-up schedule of the components.
+    logical_result do_show_sccs(vast_module mod, indices_t &indices, const output_t &out) {
+        analysis::call_graph_sccs sccs(indices.calls(mod));
+
+        auto heights = analysis::bottom_up_results< std::size_t >(
+            sccs, mod.getContext(), [&] (analysis::scc_id scc, auto &&height_of) {
+                std::size_t height = 0;
+                for (auto callee : sccs.callees(scc)) {
+                    height = std::max(height, height_of(callee) + 1);
+                }
+                return std::optional< std::size_t >(height);
+            }
+        );
+
+        if (!heights) {
+            out.error("cannot schedule the call graph");
+            return mlir::failure();
+        }
+
+        for (analysis::scc_id scc = 0; scc < sccs.size(); ++scc) {
+            std::vector< std::string > functions;
+            for (auto node : sccs.members(scc)) {
+                functions.push_back(sccs.graph().function(node).getName().str());
+            }
+            out.scc(scc, functions, sccs.recursive(scc), (*heights)[scc]);
+        }
+
+        return mlir::success();
+    }
+
+    // Loops are listed in pre-order, nested loops after the loop they are in.
+    logical_result do_show_loops(mlir::Operation *scope, const output_t &out) {
+        analysis::loop_nest_analysis nest(scope);
+        for (auto loop : nest.loops()) {
+            out.loop(*loop);
+        }
+        return mlir::success();
+    }
+
+    // Calls are looked up in the call graph of the whole module, the scope
+    // does not restrict them.
+    logical_result do_show_calls(
+        vast_module mod, const query_t &query, indices_t &indices, const output_t &out
+    ) {
+        if (query.sccs) {
+            return do_show_sccs(mod, indices, out);
+        }
+
+        const auto &graph = indices.calls(mod);
+
+        auto show = [&] (string_ref name, auto &&edges_of) {
+            auto node = graph.node(name);
+            if (node == analysis::call_graph::no_node) {
+                out.error("unknown function " + name);
+                return mlir::failure();
+            }
+
+            for (const auto &edge : edges_of(node)) {
+                out.call(graph.function(edge.node), edge.kind);
+            }
+            return mlir::success();
+        };
+
+        if (!query.callees.empty()) {
+            return show(query.callees, [&] (auto node) { return graph.callees(node); });
+        }
+        return show(query.callers, [&] (auto node) { return graph.callers(node); });
+    }
+
+    // Objects are named by their variable or function, parameters by their
+    // function and position, fields by their record and index, and heap
+    // objects by the allocating function.
+    std::string object_name(const analysis::points_to &pt, analysis::points_to::object_id id) {
+        using object_kind = analysis::points_to::object_kind;
+
+        const auto &object = pt.object_of(id);
+        switch (object.kind) {
+            case object_kind::variable:
+                return mlir::cast< hl::VarDeclOp >(object.op).getName().str();
+            case object_kind::function:
+                return mlir::cast< mlir::FunctionOpInterface >(object.op).getName().str();
+            case object_kind::parameter:
+                return (mlir::cast< mlir::FunctionOpInterface >(object.op).getName()
+                    + "#" + llvm::Twine(object.index)).str();
+            case object_kind::heap:
+                return mlir::cast< hl::CallOp >(object.op).getCallee().str();
+            case object_kind::field:
+                return (object_name(pt, object.parent) + "." + llvm::Twine(object.index)).str();
+        }
+        return "";
+    }
+
+    string_ref object_kind_name(analysis::points_to::object_kind kind) {
+        using object_kind = analysis::points_to::object_kind;
+        switch (kind) {
+            case object_kind::variable:  return "variable";
+            case object_kind::parameter: return "parameter";
+            case object_kind::heap:      return "heap";
+            case object_kind::function:  return "function";
+            case object_kind::field:     return "field";
+        }
+        return "";
+    }
+
+    // The points-to analysis covers the whole module, the scope restricts
+    // the queried variables to the locals of the function of that name.
+    logical_result do_show_points_to(
+        vast_module mod, const query_t &query, indices_t &indices, const output_t &out
+    ) {
+        const auto &pt = indices.pointers(mod);
+
+        bool found = false;
+        for (analysis::points_to::object_id id = 0; id < pt.size(); ++id) {
+            const auto &object = pt.object_of(id);
+            if (object.kind != analysis::points_to::object_kind::variable) {
+                continue;
+            }
+
+            auto var = mlir::cast< hl::VarDeclOp >(object.op);
+            if (var.getName() != query.points_to) {
+                continue;
+            }
+
+            if (!query.scope.empty()) {
+                auto fn = var->getParentOfType< mlir::FunctionOpInterface >();
+                if (!fn || fn.getName() != query.scope) {
+                    continue;
+                }
+            }
+
+            found = true;
+            for (auto pointee : pt.contents(id)) {
+                const auto &target = pt.object_of(pointee);
+                out.object(object_kind_name(target.kind), object_name(pt, pointee), target.op->getLoc());
+            }
+        }
+
+        if (!found) {
+            out.error("unknown variable " + query.points_to);
+            return mlir::failure();
+        }
+
+        return mlir::success();
+    }
+
+    logical_result process_scope(
+        mlir::Operation *scope, const query_t &query, indices_t &indices, const output_t &out
+    ) {
+        if (query.show_symbols != cl::show_symbol_type::none) {
+            return do_show_symbols(scope, query, indices, out);
+        }
+
+        if (!query.symbol_users.empty()) {
+            return do_show_users(scope, query, indices, out);
+        }
+
+        if (!query.at.empty()) {
+            return do_show_at(scope, query, indices, out);
+        }
+
+        if (!query.match.empty()) {
+            return do_match(scope, query, indices, out);
+        }
+
+        if (query.loops) {
+            return do_show_loops(scope, out);
+        }
+
+        return mlir::success();
+    }
+
+    bool has_kind(const index_symbol &symbol, cl::show_symbol_type kind) {
+        auto is = [&] (auto name) { return symbol.kind == name; };
+        switch (kind) {
+            case cl::show_symbol_type::all: return true;
+            case cl::show_symbol_type::type:
+                return is(hl::TypeDefOp::getOperationName()) || is(hl::TypeDeclOp::getOperationName());
+            case cl::show_symbol_type::record: return is(hl::StructDeclOp::getOperationName());
+            case cl::show_symbol_type::var: return is(hl::VarDeclOp::getOperationName());
+            case cl::show_symbol_type::global:
+                return is(hl::VarDeclOp::getOperationName()) && symbol.is_global;
+            case cl::show_symbol_type::function: return is(hl::FuncOp::getOperationName());
+            case cl::show_symbol_type::none: return false;
+        }
+        return false;
+    }
+
+    //
+    // Answers the query from the index, without the module. The scope
+    // restricts results to the operations of the function of that name.
+    //
+    logical_result answer_from_index(const index_file &index, const query_t &query, const output_t &out) {
+        if (query.is_call_query()) {
+            out.error("calls cannot be answered from the index");
+            return mlir::failure();
+        }
+
+        if (!query.match.empty()) {
+            out.error("patterns cannot be answered from the index");
+            return mlir::failure();
+        }
+
+        if (!query.points_to.empty()) {
+            out.error("points-to sets cannot be answered from the index");
+            return mlir::failure();
+        }
+
+        if (query.loops) {
+            out.error("loops cannot be answered from the index");
+            return mlir::failure();
+        }
+
+        auto in_scope = [&] (const auto &entry) {
+            return query.scope.empty() || entry.function == query.scope;
+        };
+
+        if (query.show_symbols != cl::show_symbol_type::none) {
+            index.symbols([&] (const index_symbol &symbol) {
+                if (in_scope(symbol) && has_kind(symbol, query.show_symbols)) {
+                    out.symbol(symbol);
+                }
+            });
+            return mlir::success();
+        }
+
+        if (!query.symbol_users.empty()) {
+            index.users(query.symbol_users, [&] (const index_operation &user) {
+                if (in_scope(user)) {
+                    out.operation(user);
+                }
+            });
+            return mlir::success();
+        }
+
+        if (!query.at.empty()) {
+            auto position = parse_position(query.at, out);
+            if (!position) {
+                return mlir::failure();
+            }
+
+            index.at(position->file, position->line, position->column, [&] (const index_operation &op) {
+                if (in_scope(op)) {
+                    out.operation(op);
+                }
+            });
+        }
+
+        return mlir::success();
+    }
 } // namespace vast::query
 
 namespace vast
 {
-    logical_result get_scope_operation(auto parent, std::string_view scope_name, auto yield) {
-        auto result =mlir::success();
-        util::symbol_tables(parent, [&](mlir::Operation *op) {
-            if (failed(yield(mlir::SymbolTable::lookupSymbolIn(op, scope_name)))) {
+    // Symbols of the name defined directly by any symbol table of the parent,
+    // found by the index of the parent instead of a lookup in every table.
+    logical_result get_scope_operation(const util::symbol_index &symbols, string_ref scope_name, auto yield) {
+        auto result = mlir::success();
+        for (auto scope : symbols.lookup(scope_name)) {
+            auto parent = scope->getParentOp();
+            if (!mlir::isa< util::mlir_symbol_interface >(scope) || !parent
+                || !parent->hasTrait< mlir::OpTrait::SymbolTable >()
+            ) {
+                continue;
+            }
+
+            if (failed(yield(scope))) {
                 result = mlir::failure();
             }
-        });
+        }
+
+        return result;
+    }
+
+    logical_result answer(
+        vast_module mod, const query::query_t &query, query::indices_t &indices, const query::output_t &out
+    ) {
+        auto process_scope = [&] (mlir::Operation *scope) {
+            return query::process_scope(scope, query, indices, out);
+        };
+
+        if (query.is_call_query()) {
+            return query::do_show_calls(mod, query, indices, out);
+        }
+
+        if (!query.points_to.empty()) {
+            return query::do_show_points_to(mod, query, indices, out);
+        }
+
+        mlir::Operation *scope = mod;
+        if (!query.scope.empty()) {
+            return get_scope_operation(indices.symbols(scope), query.scope, process_scope);
+        } else {
+            return process_scope(scope);
+        }
+    }
+
+    // Answers queries of the batch, one per line, by the same answering
+    // function. Empty lines and lines starting with `#` are skipped. A failing
+    // query does not stop the batch.
+    logical_result answer_batch(string_ref batch, const query::output_t &base, auto &&answer_one) {
+        auto result = mlir::success();
+
+        llvm::SmallVector< string_ref > lines;
+        batch.split(lines, '\n');
+        for (auto line : lines) {
+            line = line.trim();
+            if (line.empty() || line.starts_with("#")) {
+                continue;
+            }
+
+            auto out = base.with_query(line);
+
+            std::string error;
+            auto query = query::query_t::parse(line, error);
+            if (!query) {
+                out.error(error);
+                result = mlir::failure();
+                continue;
+            }
+
+            if (failed(answer_one(*query, out))) {
+                result = mlir::failure();
+            }
+
+            out.os->flush();
+        }
 
         return result;
     }
 
-    logical_result do_query(mcontext_t &ctx, memory_buffer buffer) {
-        llvm::SourceMgr source_mgr;
-        source_mgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+    // Without a batch, the query is given by the command line options.
+    logical_result answer_queries(
+        const llvm::MemoryBuffer *batch, const query::output_t &base, auto &&answer_one
+    ) {
+        if (batch) {
+            return answer_batch(batch->getBuffer(), base, answer_one);
+        }
+
+        return answer_one(query::query_t::from_options(), base);
+    }
+
+    logical_result query_index(string_ref path, const llvm::MemoryBuffer *batch) {
+        std::string err;
+        auto index = query::index_file::open(path, err);
+        if (!index) {
+            llvm::errs() << "error: cannot open index " << path << ": " << err << "\n";
+            return mlir::failure();
+        }
+
+        query::output_t base{ cl::options->json, "" };
+        return answer_queries(batch, base, [&] (const query::query_t &query, const query::output_t &out) {
+            return query::answer_from_index(*index, query, out);
+        });
+    }
+
+    // Materializes what the query looks into, functions of other names stay
+    // unmaterialized for queries of a scope.
+    logical_result materialize_for(util::lazy_module &lazy, const query::query_t &query) {
+        if (query.scope.empty() || query.is_module_query()) {
+            return lazy.materialize_all();
+        }
+
+        return lazy.materialize([&] (operation op) {
+            if (!mlir::isa< mlir::FunctionOpInterface >(op)) {
+                return true;
+            }
+            return mlir::cast< mlir::FunctionOpInterface >(op).getName() == query.scope;
+        });
+    }
+
+    logical_result extract_function(vast_module mod) {
+        auto extracted = link::extract_function(mod, cl::options->extract, cl::options->extract_depth);
+        if (!extracted) {
+            llvm::errs() << "error: cannot extract function " << cl::options->extract << "\n";
+            return mlir::failure();
+        }
 
-        mlir::SourceMgrDiagnosticHandler manager_handler(source_mgr, &ctx);
+        extracted->print(llvm::outs());
+        return mlir::success();
+    }
 
-        // Disable multi-threading when parsing the input file. This removes the
-        // unnecessary/costly context synchronization when parsing.
-        bool wasThreadingEnabled = ctx.isMultithreadingEnabled();
-        ctx.disableMultithreading();
+    logical_result print_hash(vast_module mod) {
+        const auto &name = cl::options->hash;
+        auto symbol = mlir::SymbolTable::lookupSymbolIn(mod, name);
+        if (!symbol) {
+            llvm::errs() << "error: cannot find symbol " << name << "\n";
+            return mlir::failure();
+        }
 
-        owning_module_ref mod(mlir::parseSourceFile< vast_module >(source_mgr, &ctx));
-        ctx.enableMultithreading(wasThreadingEnabled);
+        // The name is not hashed, so that renamed copies hash equally.
+        auto hash = util::structural_hash(symbol, /* ignore symbol name */ true);
+        llvm::outs() << hash.str() << " " << name << "\n";
+        return mlir::success();
+    }
+
+    // Operations are listed by their snapshot ids, with the block they are in
+    // and the ids of their operands, results and successors.
+    logical_result print_flat(vast_module mod) {
+        const auto &name = cl::options->flat;
+        auto fn = mlir::dyn_cast_if_present< mlir::FunctionOpInterface >(
+            mlir::SymbolTable::lookupSymbolIn(mod, name)
+        );
+        if (!fn) {
+            llvm::errs() << "error: cannot find function " << name << "\n";
+            return mlir::failure();
+        }
+
+        analysis::flat_function flat(fn);
+
+        auto &os = llvm::outs();
+        os << name << " : ops " << flat.num_ops() << " : blocks " << flat.num_blocks()
+           << " : regions " << flat.num_regions() << " : values " << flat.num_values()
+           << " (" << flat.num_own_values() << " own) : kinds " << flat.num_kinds() << "\n";
+
+        auto print_ids = [&] (string_ref label, string_ref prefix, auto &&ids) {
+            if (ids.empty()) {
+                return;
+            }
+            os << " : " << label;
+            for (auto id : ids) {
+                os << " " << prefix << id;
+            }
+        };
+
+        for (analysis::flat_function::op_id id = 0; id < flat.num_ops(); ++id) {
+            os << id << " " << flat.name(flat.kind(id)).getStringRef();
+            if (auto block = flat.parent(id); block != analysis::flat_function::none) {
+                os << " : block " << block;
+            }
+            print_ids("operands", "%", flat.operands(id));
+            print_ids("results", "%", flat.results(id));
+            print_ids("successors", "^", flat.successors(id));
+            os << "\n";
+        }
+
+        return mlir::success();
+    }
+
+    logical_result query_module(
+        vast_module mod, const llvm::MemoryBuffer *batch, const query::output_t &base,
+        util::lazy_module *lazy = nullptr
+    ) {
+        query::indices_t indices;
+        return answer_queries(batch, base, [&] (const query::query_t &query, const query::output_t &out) {
+            if (lazy && failed(materialize_for(*lazy, query))) {
+                out.error("cannot materialize the module");
+                return mlir::failure();
+            }
+            return answer(mod, query, indices, out);
+        });
+    }
+
+    // Bytecode modules are read lazily, function bodies are materialized only
+    // when a query looks into them.
+    logical_result do_query_lazy(
+        mcontext_t &ctx, std::shared_ptr< llvm::SourceMgr > source_mgr, const llvm::MemoryBuffer *batch
+    ) {
+        auto lazy = util::lazy_module::open(source_mgr, &ctx);
+        if (!lazy) {
+            llvm::errs() << "error: cannot read module\n";
+            return mlir::failure();
+        }
+
+        if (!cl::options->build_index.empty()) {
+            if (failed(lazy->materialize_all())) {
+                return mlir::failure();
+            }
+            return query::build_index(lazy->get(), cl::options->build_index);
+        }
+
+        if (!cl::options->export_tables.empty()) {
+            if (failed(lazy->materialize_all())) {
+                return mlir::failure();
+            }
+            return query::export_tables(lazy->get(), cl::options->export_tables);
+        }
+
+        if (!cl::options->extract.empty()) {
+            if (failed(lazy->materialize_all())) {
+                return mlir::failure();
+            }
+            return extract_function(lazy->get());
+        }
+
+        if (!cl::options->hash.empty()) {
+            auto only_symbol = [] (operation op) {
+                auto symbol = mlir::dyn_cast< mlir::SymbolOpInterface >(op);
+                return !symbol || symbol.getName() == cl::options->hash;
+            };
+
+            if (failed(lazy->materialize(only_symbol))) {
+                return mlir::failure();
+            }
+            return print_hash(lazy->get());
+        }
+
+        if (!cl::options->flat.empty()) {
+            auto only_function = [] (operation op) {
+                auto symbol = mlir::dyn_cast< mlir::SymbolOpInterface >(op);
+                return !symbol || symbol.getName() == cl::options->flat;
+            };
+
+            if (failed(lazy->materialize(only_function))) {
+                return mlir::failure();
+            }
+            return print_flat(lazy->get());
+        }
+
+        return query_module(lazy->get(), batch, { cl::options->json, "" }, lazy.get());
+    }
+
+    logical_result do_query(mcontext_t &ctx, memory_buffer buffer, const llvm::MemoryBuffer *batch) {
+        auto source_mgr = std::make_shared< llvm::SourceMgr >();
+        bool is_bytecode = mlir::isBytecode(buffer->getMemBufferRef());
+        source_mgr->AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+
+        mlir::SourceMgrDiagnosticHandler manager_handler(*source_mgr, &ctx);
+
+        if (is_bytecode) {
+            return do_query_lazy(ctx, source_mgr, batch);
+        }
+
+        auto mod = util::parse_module(*source_mgr, &ctx);
         if (!mod) {
             llvm::errs() << "error: cannot parse module\n";
             return mlir::failure();
         }
 
-        auto process_scope = [&] (auto scope) {
-            if (query::show_symbols()) {
-                return query::do_show_symbols(scope);
-            }
+        if (!cl::options->build_index.empty()) {
+            return query::build_index(mod.get(), cl::options->build_index);
+        }
+
+        if (!cl::options->export_tables.empty()) {
+            return query::export_tables(mod.get(), cl::options->export_tables);
+        }
+
+        if (!cl::options->extract.empty()) {
+            return extract_function(mod.get());
+        }
+
+        if (!cl::options->hash.empty()) {
+            return print_hash(mod.get());
+        }
+
+        if (!cl::options->flat.empty()) {
+            return print_flat(mod.get());
+        }
+
+        return query_module(mod.get(), batch, { cl::options->json, "" });
+    }
+
+    //
+    // Modules are parsed and queried in parallel in the shared context, each
+    // into its own buffers. Results are printed in the order of the inputs,
+    // in text mode after a `// <file>` header, in JSON mode with the file in
+    // every object. Diagnostics are ordered by the inputs as well.
+    //
+    logical_result do_query_files(
+        mcontext_t &ctx, llvm::ArrayRef< std::string > files, const llvm::MemoryBuffer *batch
+    ) {
+        struct result_t
+        {
+            std::string out;
+            std::string err;
+            logical_result status = mlir::success();
+        };
+
+        std::vector< result_t > results(files.size());
+
+        {
+            mlir::ParallelDiagnosticHandler diagnostics(&ctx);
+            mlir::parallelFor(&ctx, 0, files.size(), [&] (size_t i) {
+                diagnostics.setOrderIDForThread(i);
+
+                auto &result = results[i];
+                llvm::raw_string_ostream os(result.out), es(result.err);
 
-            if (query::show_symbol_users()) {
-                return query::do_show_users(scope);
+                std::string err;
+                llvm::SourceMgr source_mgr;
+                if (auto input = mlir::openInputFile(files[i], &err)) {
+                    source_mgr.AddNewSourceBuffer(std::move(input), llvm::SMLoc());
+                }
+
+                if (!err.empty()) {
+                    es << "error: " << err << "\n";
+                    result.status = mlir::failure();
+                } else if (auto mod = mlir::parseSourceFile< vast_module >(source_mgr, &ctx)) {
+                    query::output_t out{ cl::options->json, "", files[i], &os, &es };
+                    result.status = query_module(mod.get(), batch, out);
+                } else {
+                    es << "error: cannot parse module " << files[i] << "\n";
+                    result.status = mlir::failure();
+                }
+
+                diagnostics.eraseOrderIDForThread();
+            });
+        }
+
+        auto status = mlir::success();
+        for (auto [file, result] : llvm::zip(files, results)) {
+            if (!cl::options->json && !result.out.empty()) {
+                llvm::outs() << "// " << file << "\n";
+            }
+            llvm::outs() << result.out;
+            llvm::errs() << result.err;
+            if (failed(result.status)) {
+                status = mlir::failure();
             }
+        }
+
+        return status;
+    }
 
+    bool is_module_file(string_ref path) {
+        auto ext = llvm::sys::path::extension(path);
+        return ext == ".mlir" || ext == ".mlirbc";
+    }
+
+    // Directories are searched recursively for `.mlir` and `.mlirbc` files,
+    // in sorted order, so the results do not depend on the file system.
+    logical_result collect_inputs(std::vector< std::string > &files) {
+        if (cl::options->input_files.empty()) {
+            files.push_back("-");
             return mlir::success();
-        };
+        }
 
-        mlir::Operation *scope = mod.get();
-        if (query::constrained_scope()) {
-            return get_scope_operation(scope, cl::options->scope_name, process_scope);
-        } else {
-            return process_scope(scope);
+        for (const auto &input : cl::options->input_files) {
+            if (!llvm::sys::fs::is_directory(input)) {
+                files.push_back(input);
+                continue;
+            }
+
+            std::vector< std::string > found;
+            std::error_code ec;
+            for (llvm::sys::fs::recursive_directory_iterator it(input, ec), end; it != end && !ec; it.increment(ec)) {
+                if (it->type() != llvm::sys::fs::file_type::directory_file && is_module_file(it->path())) {
+                    found.push_back(it->path());
+                }
+            }
+
+            if (ec) {
+                llvm::errs() << "error: cannot read directory " << input << ": " << ec.message() << "\n";
+                return mlir::failure();
+            }
+
+            llvm::sort(found);
+            files.insert(files.end(), found.begin(), found.end());
         }
+
+        return mlir::success();
     }
 
     logical_result run(mcontext_t &ctx) {
+        memory_buffer batch;
+        if (!cl::options->batch.empty()) {
+            std::string err;
+            batch = mlir::openInputFile(cl::options->batch, &err);
+            if (!batch) {
+                llvm::errs() << "error: " << err << "\n";
+                return mlir::failure();
+            }
+        }
+
+        if (!cl::options->index.empty()) {
+            return query_index(cl::options->index, batch.get());
+        }
+
+        std::vector< std::string > files;
+        if (failed(collect_inputs(files))) {
+            return mlir::failure();
+        }
+
+        if (files.empty()) {
+            llvm::errs() << "error: no modules to query\n";
+            return mlir::failure();
+        }
+
+        if (cl::options->batch == "-" && llvm::is_contained(files, "-")) {
+            llvm::errs() << "error: the module and the batch cannot both be read from stdin\n";
+            return mlir::failure();
+        }
+
+        if (files.size() != 1) {
+            if (!cl::options->build_index.empty()) {
+                llvm::errs() << "error: an index is built from a single module\n";
+                return mlir::failure();
+            }
+
+            if (!cl::options->export_tables.empty()) {
+                llvm::errs() << "error: tables are exported from a single module\n";
+                return mlir::failure();
+            }
+
+            if (!cl::options->extract.empty()) {
+                llvm::errs() << "error: functions are extracted from a single module\n";
+                return mlir::failure();
+            }
+
+            if (!cl::options->hash.empty()) {
+                llvm::errs() << "error: symbols are hashed in a single module\n";
+                return mlir::failure();
+            }
+
+            if (!cl::options->flat.empty()) {
+                llvm::errs() << "error: functions are flattened in a single module\n";
+                return mlir::failure();
+            }
+
+            if (llvm::is_contained(files, "-")) {
+                llvm::errs() << "error: stdin cannot be queried together with other modules\n";
+                return mlir::failure();
+            }
+
+            return do_query_files(ctx, files, batch.get());
+        }
+
         std::string err;
-        if (auto input = mlir::openInputFile(cl::options->input_file, &err))
-            return do_query(ctx, std::move(input));
+        if (auto input = mlir::openInputFile(files.front(), &err))
+            return do_query(ctx, std::move(input), batch.get());
         llvm::errs() << "error: " << err << "\n";
         return mlir::failure();
     }
@@ -3,10 +3,11 @@
 #include "vast/repl/codegen.hpp"
 #include "vast/repl/common.hpp"
 
-#include "vast/repl/state.hpp"
-
-#include <llvm/Support/Signals.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/PCHContainerOperations.h>
+#include <clang/Lex/Lexer.h>
 
+#include "vast/Config/config.h"
 #include "vast/CodeGen/CodeGen.hpp"
 #include "vast/Frontend/Action.hpp"
 #include "vast/Frontend/CompilerInstance.hpp"
@@ -15,71 +16,325 @@
 
 #include <fstream>
 
-namespace vast::cc {
-    bool execute_compiler_invocation(cc::compiler_instance *ci, const cc::vast_args &vargs);
-} // namespace vast::cc
-
 namespace vast::repl::codegen {
 
     std::unique_ptr< clang::ASTUnit > ast_from_source(string_ref source) {
         return clang::tooling::buildASTFromCode(source);
     }
 
-    static void error_handler(void *user_data, const char *msg, bool get_crash_diag) {
-        auto &diags = *static_cast< clang::DiagnosticsEngine* >(user_data);
+    static std::unique_ptr< clang::ASTUnit > load_from_command_line(
+        std::vector< const char * > &args,
+        llvm::ArrayRef< clang::ASTUnit::RemappedFile > remapped,
+        unsigned preamble_after_parses
+    ) {
+        auto diags = clang::CompilerInstance::createDiagnostics(new clang::DiagnosticOptions());
+        return std::unique_ptr< clang::ASTUnit >(clang::ASTUnit::LoadFromCommandLine(
+            args.data(), args.data() + args.size(),
+            std::make_shared< clang::PCHContainerOperations >(), diags, CLANG_RESOURCE_DIR,
+            /* StorePreamblesInMemory */ true,
+            /* PreambleStoragePath */ {},
+            /* OnlyLocalDecls */ false,
+            clang::CaptureDiagsKind::None,
+            remapped,
+            /* RemappedFilesKeepOriginalName */ true,
+            preamble_after_parses,
+            clang::TU_Complete,
+            /* CacheCodeCompletionResults */ false,
+            /* IncludeBriefCommentsInCodeCompletion */ false,
+            /* AllowPCHWithCompilerErrors */ false,
+            clang::SkipFunctionBodiesScope::None,
+            /* SingleFileParse */ false,
+            /* UserFilesAreVolatile */ true
+        ));
+    }
+
+    static std::unique_ptr< llvm::MemoryBuffer > read_source(const std::filesystem::path &source) {
+        auto buff = llvm::MemoryBuffer::getFile(source.c_str(), /* IsText */ true, /* RequiresNullTerminator */ true, /* IsVolatile */ true);
+        return buff ? std::move(buff.get()) : nullptr;
+    }
+
+    static std::unique_ptr< clang::ASTUnit > parse_source(
+        const std::filesystem::path &source, std::unique_ptr< llvm::MemoryBuffer > contents
+    ) {
+        auto path = source.string();
+        std::vector< const char * > args = { "vast-repl", "-fsyntax-only", path.c_str() };
+
+        // The unit takes the ownership of the remapped buffer.
+        std::vector< clang::ASTUnit::RemappedFile > remapped;
+        if (contents) {
+            remapped.push_back({ path, contents.release() });
+        }
+
+        return load_from_command_line(args, remapped, /* preamble_after_parses */ 1);
+    }
 
-        diags.Report(clang::diag::err_fe_error_backend) << msg;
+    std::unique_ptr< clang::ASTUnit > parse_source(const std::filesystem::path &source) {
+        return parse_source(source, nullptr);
+    }
 
-        // Run the interrupt handlers to make sure any special cleanups get done, in
-        // particular that we remove files registered with RemoveFileOnSignal.
-        llvm::sys::RunInterruptHandlers();
+    std::unique_ptr< clang::ASTUnit > parse_source(const std::filesystem::path &source, string_ref contents) {
+        return parse_source(source, llvm::MemoryBuffer::getMemBufferCopy(contents, source.string()));
     }
 
-    owning_module_ref emit_module(const std::filesystem::path &source, mcontext_t */* mctx */) {
-        // TODO setup args from repl state
-        std::vector< const char * > ccargs = { source.c_str() };
-        vast::cc::buffered_diagnostics diags(ccargs);
+    std::unique_ptr< clang::ASTUnit > parse_command_line(
+        llvm::ArrayRef< std::string > args, string_ref directory
+    ) {
+        auto working_directory = ("-working-directory=" + directory).str();
 
-        auto comp = std::make_unique< cc::compiler_instance >();
+        std::vector< const char * > argv;
+        for (const auto &arg : args) {
+            argv.push_back(arg.c_str());
+        }
+        argv.push_back("-fsyntax-only");
+        argv.push_back(working_directory.c_str());
 
-        auto success = cc::compiler_invocation::create_from_args(
-            comp->getInvocation(), diags.engine, ccargs, "vast-repl"
-        );
+        return load_from_command_line(argv, {}, /* preamble_after_parses */ 0);
+    }
 
-        // Create the actual diagnostics engine.
-        if (comp->createDiagnostics(); !comp->hasDiagnostics()) {
-            return {};
+    static bool reparse_source(
+        clang::ASTUnit &unit, const std::filesystem::path &source, std::unique_ptr< llvm::MemoryBuffer > contents
+    ) {
+        if (!contents) {
+            return false;
         }
 
-        // Set an error handler, so that any LLVM backend diagnostics go through our
-        // error handler.
-        llvm::install_fatal_error_handler(
-            error_handler, static_cast<void*>(&comp->getDiagnostics())
-        );
+        // The unit takes the ownership of the remapped buffer.
+        clang::ASTUnit::RemappedFile main_file = { source.string(), contents.release() };
 
-        diags.flush();
-        if (!success) {
-            comp->getDiagnosticClient().finish();
-            return {};
+        unit.getDiagnostics().Reset(/* soft */ true);
+        return !unit.Reparse(std::make_shared< clang::PCHContainerOperations >(), main_file);
+    }
+
+    bool reparse_source(clang::ASTUnit &unit, const std::filesystem::path &source) {
+        return reparse_source(unit, source, read_source(source));
+    }
+
+    bool reparse_source(clang::ASTUnit &unit, const std::filesystem::path &source, string_ref contents) {
+        return reparse_source(unit, source, llvm::MemoryBuffer::getMemBufferCopy(contents, source.string()));
+    }
+
+    bool source_fingerprint::matches(const source_fingerprint &other, string_ref function) const {
+        if (context != other.context) {
+            return false;
+        }
+
+        auto self = functions.find(function);
+        auto that = other.functions.find(function);
+        return self != functions.end() && that != other.functions.end()
+            && self->second.tokens == that->second.tokens;
+    }
+
+    source_fingerprint fingerprint(const clang::ASTUnit &unit) {
+        const auto &sm   = unit.getSourceManager();
+        const auto &opts = unit.getLangOpts();
+        auto main        = sm.getMainFileID();
+
+        struct function_range {
+            std::string name;
+            unsigned begin, end;
+        };
+
+        std::vector< function_range > ranges;
+        for (auto decl : unit.getASTContext().getTranslationUnitDecl()->decls()) {
+            auto fn = clang::dyn_cast< clang::FunctionDecl >(decl);
+            if (!fn || !fn->doesThisDeclarationHaveABody()) {
+                continue;
+            }
+
+            auto range = sm.getExpansionRange(fn->getSourceRange());
+            if (sm.getFileID(range.getBegin()) != main) {
+                continue;
+            }
+
+            auto end = clang::Lexer::getLocForEndOfToken(range.getEnd(), 0, sm, opts);
+            ranges.push_back({ fn->getNameAsString(), sm.getFileOffset(range.getBegin()), sm.getFileOffset(end) });
+        }
+
+        llvm::sort(ranges, [] (const auto &a, const auto &b) { return a.begin < b.begin; });
+
+        source_fingerprint result;
+        result.context = llvm::hash_value(0);
+
+        auto main_buffer = sm.getBufferOrFake(main);
+        clang::Lexer lexer(main, main_buffer, sm, opts);
+
+        auto range = ranges.begin();
+        std::optional< std::pair< unsigned, unsigned > > first;
+        unsigned last_line = 0;
+        llvm::hash_code tokens = llvm::hash_value(0);
+
+        auto finish_function = [&] {
+            if (first) {
+                result.functions[range->name] = { tokens, first->first, last_line };
+                first.reset();
+                tokens = llvm::hash_value(0);
+            }
+            ++range;
+        };
+
+        clang::Token tok;
+        while (true) {
+            lexer.LexFromRawLexer(tok);
+            if (tok.is(clang::tok::eof)) {
+                break;
+            }
+
+            auto loc      = tok.getLocation();
+            auto offset   = sm.getFileOffset(loc);
+            auto spelling = string_ref(sm.getCharacterData(loc), tok.getLength());
+
+            while (range != ranges.end() && offset >= range->end) {
+                finish_function();
+            }
+
+            if (range != ranges.end() && offset >= range->begin) {
+                auto line   = sm.getSpellingLineNumber(loc);
+                auto column = sm.getSpellingColumnNumber(loc);
+                if (!first) {
+                    first = { line, column };
+                }
+                tokens    = llvm::hash_combine(tokens, spelling, line - first->first, column);
+                last_line = line;
+            } else {
+                result.context = llvm::hash_combine(result.context, spelling);
+            }
+        }
+
+        while (range != ranges.end()) {
+            finish_function();
+        }
+
+        // Files are not kept in any particular order.
+        std::vector< std::size_t > included;
+        for (auto it = sm.fileinfo_begin(); it != sm.fileinfo_end(); ++it) {
+            auto buffer = it->second->getBufferIfLoaded();
+            if (!buffer || buffer->getBufferStart() == main_buffer.getBufferStart()) {
+                continue;
+            }
+            included.push_back(llvm::hash_value(buffer->getBuffer()));
+        }
+
+        llvm::sort(included);
+        for (auto hash : included) {
+            result.context = llvm::hash_combine(result.context, hash);
         }
 
-        // TODO setup args from repl state
-        cc::vast_args vargs = {};
+        return result;
+    }
 
-        comp->LoadRequestedPlugins();
+    void shift_locations(operation root, string_ref file, int lines) {
+        if (lines == 0) {
+            return;
+        }
 
-        // If there were errors in processing arguments, don't do anything else.
-        if (comp->getDiagnostics().hasErrorOccurred()) {
+        auto shift = [&] (mlir::Location loc) {
+            auto moved = mlir::Attribute(loc).replace([&] (mlir::FileLineColLoc file_loc) -> mlir::Attribute {
+                if (file_loc.getFilename() != file) {
+                    return file_loc;
+                }
+                return mlir::FileLineColLoc::get(
+                    file_loc.getFilename(), file_loc.getLine() + lines, file_loc.getColumn()
+                );
+            });
+            return mlir::Location(mlir::cast< mlir::LocationAttr >(moved));
+        };
+
+        root->walk([&] (operation op) {
+            op->setLoc(shift(op->getLoc()));
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    for (auto arg : block.getArguments()) {
+                        arg.setLoc(shift(arg.getLoc()));
+                    }
+                }
+            }
+        });
+    }
+
+    static cc::vast_args lazy_session_args() {
+        cc::vast_args vargs;
+        vargs.push_back("-vast-lazy-function-bodies");
+        return vargs;
+    }
+
+    lazy_session::lazy_session(std::unique_ptr< clang::ASTUnit > unit, mcontext_t &mctx)
+        : unit(std::move(unit))
+        , opts{
+            .headers = this->unit->getHeaderSearchOpts(),
+            .codegen = codegen_opts,
+            .target  = this->unit->getASTContext().getTargetInfo().getTargetOpts(),
+            .lang    = this->unit->getLangOpts(),
+            .front   = front_opts,
+            .diags   = this->unit->getDiagnostics(),
+            .vfs     = this->unit->getFileManager().getVirtualFileSystem()
+        }
+        , vargs(lazy_session_args())
+        , cgctx(mctx, this->unit->getASTContext(), cc::get_source_language(opts.lang))
+        , driver(cgctx, opts, vargs)
+    {
+        for (auto decl : this->unit->getASTContext().getTranslationUnitDecl()->decls()) {
+            driver.handle_top_level_decl(decl);
+        }
+
+        driver.finalize();
+    }
+
+    hl::FuncOp lazy_session::materialize(string_ref name) {
+        if (!driver.has_lazy_body(name)) {
             return {};
         }
 
-        if (auto action = std::make_unique< vast::cc::emit_mlir_module >(vargs); !action) {
-            comp->ExecuteAction(*action);
-            llvm::remove_fatal_error_handler();
-            return action->result();
+        return driver.materialize_function(name);
+    }
+
+    std::size_t lazy_session::materialize_all() {
+        // Bodies can emit further top-level operations.
+        llvm::SmallVector< std::string > pending;
+        for (auto fn : module().getOps< hl::FuncOp >()) {
+            if (has_lazy_body(fn.getSymName())) {
+                pending.push_back(fn.getSymName().str());
+            }
+        }
+
+        std::size_t generated = 0;
+        for (const auto &name : pending) {
+            if (materialize(name)) {
+                ++generated;
+            }
+        }
+        return generated;
+    }
+
+    std::unique_ptr< clang::ASTUnit > lazy_session::take_unit(std::unique_ptr< lazy_session > session) {
+        auto unit = std::move(session->unit);
+        session.reset();
+        return unit;
+    }
+
+    std::unique_ptr< lazy_session > make_lazy_session(
+        const std::filesystem::path &source, mcontext_t &mctx, std::unique_ptr< lazy_session > previous
+    ) {
+        std::unique_ptr< clang::ASTUnit > unit;
+        if (previous) {
+            unit = lazy_session::take_unit(std::move(previous));
+            if (!reparse_source(*unit, source)) {
+                return nullptr;
+            }
+        } else {
+            unit = parse_source(source);
+        }
+
+        return make_lazy_session(unit, mctx);
+    }
+
+    std::unique_ptr< lazy_session > make_lazy_session(
+        std::unique_ptr< clang::ASTUnit > &unit, mcontext_t &mctx
+    ) {
+        if (!unit || unit->getDiagnostics().hasErrorOccurred()) {
+            return nullptr;
         }
 
-        return {};
+        return std::make_unique< lazy_session >(std::move(unit), mctx);
     }
 
 } // namespace vast::repl::codegen
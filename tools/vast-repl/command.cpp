@@ -2,9 +2,26 @@
 
 #include "vast/repl/command.hpp"
 
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Bytecode/BytecodeReader.h>
+#include <mlir/IR/SymbolTable.h>
+#include <mlir/Parser/Parser.h>
+#include <llvm/ADT/ScopeExit.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Timer.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Analysis/StructuralDiff.hpp"
 #include "vast/Conversion/Passes.hpp"
 #include "vast/Tower/Tower.hpp"
+#include "vast/Util/ModuleParser.hpp"
+#include "vast/Util/PipelineStats.hpp"
 #include "vast/repl/common.hpp"
+
+#include <map>
 #include <optional>
 
 namespace vast::repl::cmd {
@@ -29,10 +46,138 @@ namespace vast::repl::cmd {
         return file_buffer;
     }
 
+    // textual or bytecode mlir module that does not need to be generated
+    bool is_mlir_source(const state_t &state) {
+        if (state.source->extension() == ".mlir") {
+            return true;
+        }
+
+        auto buff = get_source_buffer(state);
+        return mlir::isBytecode(buff.get()->getMemBufferRef());
+    }
+
+    owning_module_ref load_module(state_t &state) {
+        llvm::SourceMgr source_mgr;
+        source_mgr.AddNewSourceBuffer(std::move(get_source_buffer(state).get()), llvm::SMLoc());
+        return util::parse_module(source_mgr, &state.ctx);
+    }
+
+    struct emission_stats {
+        std::size_t reused = 0;
+        std::size_t generated = 0;
+    };
+
+    // Copies symbols used by the function that are defined only in the
+    // module it comes from.
+    void carry_over_symbols(hl::FuncOp fn, vast_module from, vast_module to) {
+        auto uses = mlir::SymbolTable::getSymbolUses(fn);
+        if (!uses) {
+            return;
+        }
+
+        for (auto use : *uses) {
+            auto name = use.getSymbolRef().getRootReference();
+            if (mlir::SymbolTable::lookupSymbolIn(to, name)) {
+                continue;
+            }
+
+            if (auto def = mlir::SymbolTable::lookupSymbolIn(from, name)) {
+                mlir::OpBuilder bld(fn);
+                bld.clone(*def);
+            }
+        }
+    }
+
+    //
+    // Emits the module of the C source as the base of a new tower. Functions
+    // that match the fingerprint of the base layer of the previous tower are
+    // carried over from that layer, only the other ones are generated again.
+    //
+    std::optional< emission_stats > emit_incremental(state_t &state) {
+        // The AST unit of the previous session is parsed again with its
+        // preamble.
+        auto session = codegen::make_lazy_session(state.source.value(), state.ctx, std::move(state.lazy));
+        if (!session) {
+            VAST_ERROR("error: unable to parse {}", state.source->string());
+            return std::nullopt;
+        }
+
+        auto print = codegen::fingerprint(session->ast());
+
+        vast_module previous;
+        if (state.tower && state.fingerprint) {
+            previous = state.tower->module(state.tower->layers().front());
+        }
+
+        auto reusable = [&] (string_ref name) -> hl::FuncOp {
+            if (!previous || !state.fingerprint->matches(print, name)) {
+                return {};
+            }
+
+            auto fn = mlir::dyn_cast_or_null< hl::FuncOp >(mlir::SymbolTable::lookupSymbolIn(previous, name));
+            return fn && !fn.isDeclaration() ? fn : hl::FuncOp();
+        };
+
+        llvm::SmallVector< std::string > lazy;
+        for (auto fn : session->module().getOps< hl::FuncOp >()) {
+            if (session->has_lazy_body(fn.getSymName())) {
+                lazy.push_back(fn.getSymName().str());
+            }
+        }
+
+        // Bodies are generated before the module is copied, since they can
+        // emit further top-level operations.
+        emission_stats stats;
+        llvm::StringMap< hl::FuncOp > reused;
+        for (const auto &name : lazy) {
+            if (auto fn = reusable(name)) {
+                reused[name] = fn;
+                ++stats.reused;
+            } else if (session->materialize(name)) {
+                ++stats.generated;
+            }
+        }
+
+        owning_module_ref mod(session->module().clone());
+        for (const auto &entry : reused) {
+            auto name = entry.getKey();
+            auto decl = mlir::SymbolTable::lookupSymbolIn(mod.get(), name);
+
+            mlir::OpBuilder bld(decl);
+            auto fn = mlir::cast< hl::FuncOp >(bld.clone(*entry.getValue()));
+            decl->erase();
+
+            if (auto file_loc = fn.getLoc().dyn_cast< mlir::FileLineColLoc >()) {
+                int lines = int(print.functions.lookup(name).line)
+                    - int(state.fingerprint->functions.lookup(name).line);
+                codegen::shift_locations(fn, file_loc.getFilename(), lines);
+            }
+
+            carry_over_symbols(fn, previous, mod.get());
+        }
+
+        state.meta_index.reset();
+        state.jit_sessions.clear();
+
+        auto [t, _] = tw::default_tower::get(state.ctx, std::move(mod));
+        state.tower       = std::move(t);
+        state.fingerprint = std::move(print);
+        state.lazy        = std::move(session);
+        return stats;
+    }
+
     void check_and_emit_module(state_t &state) {
         if (!state.tower) {
             check_source(state);
-            auto mod    = codegen::emit_module(state.source.value(), &state.ctx);
+            if (!is_mlir_source(state)) {
+                emit_incremental(state);
+                return;
+            }
+
+            auto mod    = load_module(state);
+            if (!mod) {
+                VAST_ERROR("error: unable to load module from {}", state.source->string());
+            }
             auto [t, _] = tw::default_tower::get(state.ctx, std::move(mod));
             state.tower = std::move(t);
         }
@@ -57,8 +202,33 @@ namespace vast::repl::cmd {
     //
     void load::run(state_t &state) const {
         state.source = get_param< source_param >(params).path;
+        state.lazy.reset();
+        state.tower.reset();
+        state.fingerprint.reset();
+        state.meta_index.reset();
+        state.jit_sessions.clear();
     };
 
+    //
+    // reload command
+    //
+    void reload::run(state_t &state) const {
+        check_source(state);
+
+        if (is_mlir_source(state) || !state.tower) {
+            state.tower.reset();
+            state.meta_index.reset();
+            state.jit_sessions.clear();
+            check_and_emit_module(state);
+            return;
+        }
+
+        if (auto stats = emit_incremental(state)) {
+            llvm::outs() << "reused " << stats->reused << " functions, generated "
+                         << stats->generated << "\n";
+        }
+    }
+
     //
     // show command
     //
@@ -68,10 +238,18 @@ namespace vast::repl::cmd {
     }
 
     void show_ast(const state_t &state) {
+        auto dump = [] (const clang::ASTUnit &unit) {
+            unit.getASTContext().getTranslationUnitDecl()->dump(llvm::outs());
+            llvm::outs() << "\n";
+        };
+
+        // The AST of the emitted module, if the source was emitted.
+        if (state.lazy) {
+            return dump(state.lazy->ast());
+        }
+
         auto buff = get_source_buffer(state);
-        auto unit = codegen::ast_from_source(buff.get()->getBuffer());
-        unit->getASTContext().getTranslationUnitDecl()->dump(llvm::outs());
-        llvm::outs() << "\n";
+        dump(*codegen::ast_from_source(buff.get()->getBuffer()));
     }
 
     void show_module(state_t &state) {
@@ -82,11 +260,39 @@ namespace vast::repl::cmd {
     void show_symbols(state_t &state) {
         check_and_emit_module(state);
 
-        util::symbols(state.tower->top().mod, [&] (auto symbol) {
+        util::symbol_index(state.tower->top().mod).symbols([&] (auto symbol) {
             llvm::outs() << util::show_symbol_value(symbol) << "\n";
         });
     }
 
+    // Operations of the following layers derived from the operations of the
+    // oldest layer with the given meta identifier.
+    void show_provenance(state_t &state, integer_param id) {
+        using ::vast::meta::get_with_identifier;
+        check_and_emit_module(state);
+
+        auto &tower = state.tower.value();
+        auto layers = tower.layers();
+        for (auto [idx, from] : llvm::enumerate(layers)) {
+            auto ops = get_with_identifier(tower.module(from), id.value);
+            if (ops.empty()) {
+                continue;
+            }
+
+            for (auto op : ops) {
+                for (auto to : llvm::drop_begin(layers, idx)) {
+                    llvm::outs() << "layer " << to.id << ":\n";
+                    for (auto derived : tower.descendants(from, op, to)) {
+                        llvm::outs() << *derived << "\n";
+                    }
+                }
+            }
+            return;
+        }
+
+        VAST_ERROR("error: no operation with meta identifier {0}", id.value);
+    }
+
     void show::run(state_t &state) const {
         auto what = get_param< kind_param >(params);
         switch (what) {
@@ -94,29 +300,39 @@ namespace vast::repl::cmd {
             case show_kind::ast:     return show_ast(state);
             case show_kind::module:  return show_module(state);
             case show_kind::symbols: return show_symbols(state);
+            case show_kind::provenance:
+                return show_provenance(state, get_param< identifier_param >(params));
         }
     };
 
     //
     // meta command
     //
-    void meta::add(state_t &state) const {
-        using ::vast::meta::add_identifier;
 
+    // Index of the top layer, rebuilt once the top layer changes.
+    ::vast::meta::identifier_index &meta_index(state_t &state) {
+        auto top = state.tower->top();
+        if (!state.meta_index || state.meta_index->first != top.id) {
+            state.meta_index.emplace(top.id, ::vast::meta::identifier_index(top.mod));
+        }
+        return state.meta_index->second;
+    }
+
+    void meta::add(state_t &state) const {
+        auto &index = meta_index(state);
         auto name_param = get_param< symbol_param >(params);
         util::symbols(state.tower->top().mod, [&] (auto symbol) {
             if (util::symbol_name(symbol) == name_param.value) {
                 auto id = get_param< identifier_param >(params);
-                add_identifier(symbol, id.value);
+                index.add(symbol, id.value);
                 llvm::outs() << symbol << "\n";
             }
         });
     }
 
     void meta::get(state_t &state) const {
-        using ::vast::meta::get_with_identifier;
         auto id = get_param< identifier_param >(params);
-        for (auto op : get_with_identifier(state.tower->top().mod, id.value)) {
+        for (auto op : meta_index(state).with_identifier(id.value)) {
             llvm::outs() << *op << "\n";
         }
     }
@@ -134,6 +350,59 @@ namespace vast::repl::cmd {
     //
     // raise command
     //
+
+    // Passes of the job run on clones of the layers outside of the lock, only
+    // forking and committing the layers holds it.
+    void raise_pipeline(state_t &state, job_t &job) {
+        auto start = [&] {
+            std::lock_guard guard(state.lock);
+            return state.tower->top();
+        }();
+
+        // Passes of all steps are reported together by `time`.
+        std::optional< mlir::TimingScope > timing;
+        if (state.timing) {
+            state.timing->setEnabled(true);
+            timing = state.timing->getRootScope();
+        }
+
+        auto th = start;
+        for (const auto &pass : job.steps) {
+            if (job.cancelled) {
+                job.status = llvm::formatv("cancelled after {0} of {1} passes", job.done.load(), job.steps.size());
+                return;
+            }
+
+            mlir::PassManager pm(&state.ctx);
+            std::ignore = mlir::parsePassPipeline(pass, pm);
+            if (timing) {
+                pm.enableTiming(*timing);
+            }
+
+            auto pending = [&] {
+                std::lock_guard guard(state.lock);
+                tw::load_dependent_dialects(pm);
+                return state.tower->fork(th);
+            }();
+
+            if (mlir::failed(pm.run(pending.mod.get()))) {
+                job.status = llvm::formatv("pass {0} failed", pass);
+                return;
+            }
+
+            std::lock_guard guard(state.lock);
+            auto next = state.tower->commit(std::move(pending));
+            // Only the result of the whole pipeline is kept.
+            if (th.id != start.id) {
+                state.tower->release(th);
+            }
+            th = next;
+            ++job.done;
+        }
+
+        job.status = llvm::formatv("finished, top layer {0}", th.id);
+    }
+
     void raise::run(state_t &state) const {
         check_and_emit_module(state);
 
@@ -141,14 +410,333 @@ namespace vast::repl::cmd {
         llvm::SmallVector< llvm::StringRef, 2 > passes;
         llvm::StringRef(pipeline).split(passes, ',');
 
-        mlir::PassManager pm(&state.ctx);
-        auto th = state.tower->top();
+        auto job  = std::make_unique< job_t >();
+        job->name = "raise";
         for (auto pass : passes) {
+            mlir::PassManager pm(&state.ctx);
             if (mlir::failed(mlir::parsePassPipeline(pass, pm))) {
                 VAST_FATAL("failed to parse pass pipeline");
             }
-            th = state.tower->apply(th, pm);
+            job->steps.push_back(pass.str());
+        }
+
+        // Outcome of the previous job was not reported yet.
+        finish_job(state);
+
+        if (!state.background) {
+            raise_pipeline(state, *job);
+            if (job->done != job->steps.size()) {
+                VAST_ERROR("error: raise {0}", job->status);
+            }
+            return;
+        }
+
+        state.job = std::move(job);
+        state.job->worker = std::thread([&state, &job = *state.job] {
+            raise_pipeline(state, job);
+            job.finished = true;
+        });
+
+        llvm::outs() << "raise runs in the background, see `jobs`\n";
+    }
+
+    //
+    // materialize command
+    //
+    void materialize::run(state_t &state) const {
+        check_source(state);
+
+        if (!state.lazy) {
+            state.lazy = codegen::make_lazy_session(state.source.value(), state.ctx);
+            if (!state.lazy) {
+                VAST_ERROR("error: unable to parse {}", state.source->string());
+                return;
+            }
         }
+
+        auto name = get_param< symbol_param >(params).value;
+        if (auto fn = state.lazy->materialize(name)) {
+            llvm::outs() << fn << "\n";
+        } else {
+            VAST_ERROR("error: no pending body of function {}", name);
+        }
+    }
+
+    //
+    // run command
+    //
+    void execute::run(state_t &state) const {
+        check_and_emit_module(state);
+
+        auto top = state.tower->top();
+        auto &session = state.jit_sessions[top.id];
+        if (!session) {
+            session = jit::session::make(top.mod);
+            if (!session) {
+                return;
+            }
+        }
+
+        auto name = get_param< symbol_param >(params).value;
+        auto args = get_param< args_param >(params).values;
+        std::ignore = session->call(name, args, llvm::outs());
+    }
+
+    //
+    // budget command
+    //
+    void budget::run(state_t &state) const {
+        check_and_emit_module(state);
+
+        auto ops = get_param< ops_param >(params).value;
+        if (ops == 0) {
+            state.tower->set_budget(std::nullopt);
+        } else {
+            state.tower->set_budget(ops);
+        }
+    }
+
+    //
+    // job control commands
+    //
+    void finish_job(state_t &state) {
+        if (!state.job) {
+            return;
+        }
+
+        state.job->worker.join();
+        llvm::outs() << state.job->name << ": " << state.job->status << "\n";
+        state.job.reset();
+    }
+
+    void jobs::run(state_t &state) const {
+        if (!state.job) {
+            llvm::outs() << "no job\n";
+            return;
+        }
+
+        auto &job = *state.job;
+        if (job.finished) {
+            return finish_job(state);
+        }
+
+        std::size_t done = job.done;
+        llvm::outs() << job.name << ": " << done << " of " << job.steps.size() << " done";
+        if (done < job.steps.size()) {
+            llvm::outs() << ", running " << job.steps[done];
+        }
+        if (job.cancelled) {
+            llvm::outs() << ", cancelling";
+        }
+        llvm::outs() << "\n";
+    }
+
+    void wait::run(state_t &state) const {
+        finish_job(state);
+    }
+
+    void cancel::run(state_t &state) const {
+        if (!state.has_running_job()) {
+            llvm::outs() << "no running job\n";
+            return;
+        }
+
+        state.job->cancelled = true;
+        llvm::outs() << "cancelling " << state.job->name << " after the running step\n";
+    }
+
+    //
+    // time command
+    //
+    time::time(const params_storage &params) : params(params) {
+        const auto &words = get_param< command_param >(params).values;
+        if (words.empty()) {
+            VAST_FATAL("missing command to time");
+        }
+
+        command_tokens tokens(words.begin(), words.end());
+        timed = parse_command(tokens);
+    }
+
+    void time::run(state_t &state) const {
+        // The timed command runs to completion, passes it runs are reported
+        // once it finishes.
+        mlir::DefaultTimingManager timing;
+        timing.setOutput(llvm::outs());
+
+        auto background = std::exchange(state.background, false);
+        state.timing    = &timing;
+        auto restore = llvm::make_scope_exit([&] {
+            state.background = background;
+            state.timing     = nullptr;
+        });
+
+        auto start = llvm::TimeRecord::getCurrentTime(true /* start */);
+        timed->run(state);
+        auto elapsed = llvm::TimeRecord::getCurrentTime(false /* start */);
+        elapsed -= start;
+
+        llvm::outs() << llvm::formatv(
+            "wall {0:f3}s, cpu {1:f3}s (user {2:f3}s, system {3:f3}s)\n",
+            elapsed.getWallTime(), elapsed.getProcessTime(),
+            elapsed.getUserTime(), elapsed.getSystemTime()
+        );
+
+        if (timing.isEnabled()) {
+            timing.print();
+            // The report is not printed again once the manager is destroyed.
+            timing.setEnabled(false);
+        }
+    }
+
+    //
+    // stats command
+    //
+    void stats::run(state_t &state) const {
+        check_and_emit_module(state);
+
+        auto &tower = state.tower.value();
+        auto top    = tower.top();
+
+        std::map< std::string, std::size_t > ops_by_dialect;
+        top.mod->walk([&] (operation op) {
+            ++ops_by_dialect[op->getName().getDialectNamespace().str()];
+        });
+
+        auto counts = ir_counts::of(top.mod);
+        llvm::outs() << "top layer " << top.id << ": " << counts.ops << " ops, "
+                     << counts.types << " types, " << counts.attrs << " attributes\n";
+        for (const auto &[dialect, ops] : ops_by_dialect) {
+            llvm::outs() << "  " << (dialect.empty() ? "<unregistered>" : dialect) << " " << ops << "\n";
+        }
+
+        llvm::outs() << "context: " << state.ctx.getLoadedDialects().size() << " loaded dialects, "
+                     << state.ctx.getRegisteredOperations().size() << " registered operations\n";
+
+        for (auto layer : tower.layers()) {
+            llvm::outs() << "layer " << layer.id << ": ";
+            if (auto size = tower.size(layer)) {
+                llvm::outs() << *size << " ops\n";
+            } else {
+                llvm::outs() << "spilled\n";
+            }
+        }
+
+        llvm::outs() << "rss " << current_rss_kb() << " kB, peak " << current_peak_rss_kb() << " kB\n";
+    }
+
+    //
+    // diff command
+    //
+    void diff::run(state_t &state) const {
+        check_and_emit_module(state);
+
+        auto &tower = state.tower.value();
+        auto layers = tower.layers();
+
+        auto from = get_param< from_param >(params).value;
+        auto to   = get_param< to_param >(params).value;
+
+        // Without layers, the top layer is compared with the previous one.
+        if (from == 0 && to == 0) {
+            if (layers.size() < 2) {
+                VAST_ERROR("error: the tower has a single layer");
+                return;
+            }
+            from = layers[layers.size() - 2].id;
+            to   = layers.back().id;
+        }
+
+        auto live = [&] (std::uint64_t id) -> std::optional< tw::default_tower::handle_t > {
+            for (auto layer : layers) {
+                if (layer.id == id) {
+                    return layer;
+                }
+            }
+            VAST_ERROR("error: no live layer {0}", id);
+            return std::nullopt;
+        };
+
+        auto a = live(from);
+        auto b = live(to);
+        if (!a || !b) {
+            return;
+        }
+
+        // Both layers stay in memory while they are compared.
+        auto budget = tower.budget();
+        tower.set_budget(std::nullopt);
+        auto restore = llvm::make_scope_exit([&] { tower.set_budget(budget); });
+
+        auto before = tower.module(*a);
+        auto after  = tower.module(*b);
+        analysis::structural_diff(before, after).print(llvm::outs());
+    }
+
+    //
+    // save and restore commands
+    //
+    std::string session_file(const std::filesystem::path &dir) {
+        return (dir / "session").string();
+    }
+
+    // The tower is saved with the source it was emitted from, other state,
+    // e.g., the fingerprint of the source, is rebuilt on demand.
+    void save::run(state_t &state) const {
+        check_and_emit_module(state);
+
+        auto dir = get_param< dir_param >(params).path;
+        if (mlir::failed(state.tower->save(dir.string()))) {
+            VAST_ERROR("error: unable to save the tower to {0}", dir.string());
+            return;
+        }
+
+        std::error_code ec;
+        llvm::raw_fd_ostream os(session_file(dir), ec);
+        if (ec) {
+            VAST_ERROR("error: unable to save the session to {0}: {1}", dir.string(), ec.message());
+            return;
+        }
+
+        if (state.source) {
+            os << "source " << state.source->string() << "\n";
+        }
+
+        llvm::outs() << "saved " << state.tower->layers().size() << " layers to " << dir.string() << "\n";
+    }
+
+    void restore::run(state_t &state) const {
+        auto dir = get_param< dir_param >(params).path;
+
+        auto session = llvm::MemoryBuffer::getFile(session_file(dir));
+        if (!session) {
+            VAST_ERROR("error: no saved session in {0}", dir.string());
+            return;
+        }
+
+        auto tower = tw::default_tower::restore(state.ctx, dir.string());
+        if (!tower) {
+            VAST_ERROR("error: unable to restore the tower from {0}", dir.string());
+            return;
+        }
+
+        state.source.reset();
+        llvm::SmallVector< string_ref > lines;
+        session.get()->getBuffer().split(lines, '\n', /* max split */ -1, /* keep empty */ false);
+        for (auto line : lines) {
+            if (auto [key, value] = line.split(' '); key == "source") {
+                state.source = value.str();
+            }
+        }
+
+        state.lazy.reset();
+        state.fingerprint.reset();
+        state.meta_index.reset();
+        state.jit_sessions.clear();
+        state.tower = std::move(tower);
+
+        llvm::outs() << "restored " << state.tower->layers().size() << " layers, top layer "
+                     << state.tower->top().id << "\n";
     }
 
 } // namespace vast::repl::cmd
@@ -0,0 +1,169 @@
+// Copyright (c) 2023-present, Trail of Bits, Inc.
+
+#include "vast/repl/jit.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/TargetSelect.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Target/LLVMIR/Convert.hpp"
+
+#include <mutex>
+#include <utility>
+
+namespace vast::repl::jit {
+
+    namespace {
+
+        using word = std::int64_t;
+
+        // Integer arguments are passed in registers of the width of `word`,
+        // which covers all narrower integer parameters as well.
+        constexpr std::size_t max_args = 6;
+
+        template< std::size_t ... idx >
+        word invoke(std::uint64_t addr, llvm::ArrayRef< word > args, std::index_sequence< idx... >) {
+            using fn_t = word (*)(decltype(idx, word{})...);
+            return reinterpret_cast< fn_t >(addr)(args[idx]...);
+        }
+
+        template< std::size_t arity = 0 >
+        word invoke(std::uint64_t addr, llvm::ArrayRef< word > args) {
+            if constexpr (arity > max_args) {
+                VAST_UNREACHABLE("unsupported number of arguments");
+            } else {
+                if (args.size() == arity) {
+                    return invoke(addr, args, std::make_index_sequence< arity >{});
+                }
+                return invoke< arity + 1 >(addr, args);
+            }
+        }
+
+        bool is_lowered(vast_module mod) {
+            auto result = mod.walk([&] (operation op) {
+                if (op != mod.getOperation() && !mlir::isa_and_nonnull< mlir::LLVM::LLVMDialect >(op->getDialect())) {
+                    return mlir::WalkResult::interrupt();
+                }
+                return mlir::WalkResult::advance();
+            });
+            return !result.wasInterrupted();
+        }
+
+        bool is_word_compatible(mlir_type type) {
+            auto int_type = mlir::dyn_cast< mlir::IntegerType >(type);
+            return int_type && int_type.getWidth() <= 64;
+        }
+
+        void initialize_native_target() {
+            static std::once_flag flag;
+            std::call_once(flag, [] {
+                llvm::InitializeNativeTarget();
+                llvm::InitializeNativeTargetAsmPrinter();
+            });
+        }
+
+    } // namespace
+
+    std::unique_ptr< session > session::make(vast_module mod) {
+        if (!is_lowered(mod)) {
+            VAST_ERROR("error: top module is not lowered to the llvm dialect");
+            return nullptr;
+        }
+
+        llvm::StringMap< signature > signatures;
+        for (auto fn : mod.getOps< mlir::LLVM::LLVMFuncOp >()) {
+            auto fty = fn.getFunctionType();
+            auto result = fty.getReturnType();
+
+            bool is_void = mlir::isa< mlir::LLVM::LLVMVoidType >(result);
+            if (fn.isExternal() || fty.isVarArg() || fty.getNumParams() > max_args) {
+                continue;
+            }
+
+            if (!llvm::all_of(fty.getParams(), is_word_compatible) || !(is_void || is_word_compatible(result))) {
+                continue;
+            }
+
+            auto width = is_void ? 0 : mlir::cast< mlir::IntegerType >(result).getWidth();
+            signatures[fn.getName()] = { fty.getNumParams(), width };
+        }
+
+        initialize_native_target();
+
+        // Translation adjusts module attributes, keep the tower layer intact.
+        owning_module_ref copy = mod.clone();
+        auto llvm_ctx = std::make_unique< llvm::LLVMContext >();
+        auto llvm_mod = target::llvmir::translate(copy.get(), *llvm_ctx);
+        if (!llvm_mod) {
+            VAST_ERROR("error: failed to translate module to LLVM IR");
+            return nullptr;
+        }
+
+        auto report = [] (llvm::Error err) {
+            VAST_ERROR("error: {0}", llvm::toString(std::move(err)));
+            return nullptr;
+        };
+
+        auto lljit = llvm::orc::LLJITBuilder().create();
+        if (!lljit) {
+            return report(lljit.takeError());
+        }
+
+        // Resolve calls of library functions from the repl process.
+        auto &jit = *lljit;
+        auto process = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+            jit->getDataLayout().getGlobalPrefix()
+        );
+        if (!process) {
+            return report(process.takeError());
+        }
+        jit->getMainJITDylib().addGenerator(std::move(*process));
+
+        llvm::orc::ThreadSafeModule tsm(std::move(llvm_mod), std::move(llvm_ctx));
+        if (auto err = jit->addIRModule(std::move(tsm))) {
+            return report(std::move(err));
+        }
+
+        return std::unique_ptr< session >(new session(std::move(jit), std::move(signatures)));
+    }
+
+    logical_result session::call(string_ref name, llvm::ArrayRef< std::int64_t > args, llvm::raw_ostream &os) {
+        auto it = signatures.find(name);
+        if (it == signatures.end()) {
+            VAST_ERROR("error: no callable function {0}, only functions with integer parameters and result are supported", name);
+            return mlir::failure();
+        }
+
+        const auto &sig = it->second;
+        if (sig.arity != args.size()) {
+            VAST_ERROR("error: function {0} expects {1} arguments", name, sig.arity);
+            return mlir::failure();
+        }
+
+        auto addr = lljit->lookup(name);
+        if (!addr) {
+            VAST_ERROR("error: {0}", llvm::toString(addr.takeError()));
+            return mlir::failure();
+        }
+
+        auto result = invoke(addr->getValue(), args);
+        if (sig.result_width != 0) {
+            // Bits above the result width are unspecified.
+            llvm::APInt value(64, static_cast< std::uint64_t >(result));
+            value = value.trunc(sig.result_width);
+            if (sig.result_width == 1) {
+                os << value.getZExtValue() << "\n";
+            } else {
+                os << value.getSExtValue() << "\n";
+            }
+        }
+
+        return mlir::success();
+    }
+
+} // namespace vast::repl::jit
@@ -12,12 +12,14 @@ VAST_RELAX_WARNINGS
 #include "mlir/Support/FileUtilities.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 #include "mlir/Target/LLVMIR/Dialect/All.h"
+#include "llvm/Support/Process.h"
 #include "vast/repl/linenoise.hpp"
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Dialects.hpp"
 #include "vast/Dialect/HighLevel/Passes.hpp"
 #include "vast/Conversion/Passes.hpp"
+#include "vast/Target/LLVMIR/Convert.hpp"
 #include "vast/Util/Common.hpp"
 #include "vast/repl/cli.hpp"
 #include "vast/repl/command.hpp"
@@ -57,9 +59,16 @@ namespace vast::repl
             llvm::outs() << "Welcome to 'vast-repl', an interactive MLIR modifier. Type 'help' to "
                             "get started.\n";
 
+            // Scripted sessions run commands one after another.
+            cli.set_background(llvm::sys::Process::StandardInIsUserInput());
+
             while (!cli.exit()) {
                 std::string cmd;
                 if (auto quit = linenoise::Readline("> ", cmd)) {
+                    // Ctrl-C cancels the running job first.
+                    if (cli.cancel_job()) {
+                        continue;
+                    }
                     break;
                 }
 
@@ -89,8 +98,9 @@ int main(int argc, char **argv) try {
     vast::registerAllDialects(registry);
     mlir::registerAllDialects(registry);
 
-    // register conversions
-    mlir::registerAllToLLVMIRTranslations(registry);
+    // register conversions, including the translation of marks of the
+    // high-level dialect left on llvm operations
+    vast::target::llvmir::register_vast_to_llvm_ir(registry);
 
     args_t args = load_args(argc, argv);
 